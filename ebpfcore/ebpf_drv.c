@@ -9,6 +9,7 @@
  */
 
 #include "ebpf_core.h"
+#include "ebpf_handle.h"
 #include "ebpf_tracelog.h"
 #include "ebpf_version.h"
 #include "git_commit_id.h"
@@ -44,6 +45,7 @@ const char ebpf_core_version[] = EBPF_VERSION " " GIT_COMMIT_ID;
 //
 // Pre-Declarations
 //
+static EVT_WDF_FILE_CLEANUP _ebpf_driver_file_cleanup;
 static EVT_WDF_FILE_CLOSE _ebpf_driver_file_close;
 static EVT_WDF_IO_QUEUE_IO_DEVICE_CONTROL _ebpf_driver_io_device_control;
 static EVT_WDFDEVICE_WDM_IRP_PREPROCESS _ebpf_driver_query_volume_information;
@@ -103,7 +105,7 @@ _ebpf_driver_initialize_device(WDFDRIVER driver_handle, _Out_ WDFDEVICE* device)
 
     WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
     attributes.SynchronizationScope = WdfSynchronizationScopeNone;
-    WDF_FILEOBJECT_CONFIG_INIT(&file_object_config, NULL, _ebpf_driver_file_close, WDF_NO_EVENT_CALLBACK);
+    WDF_FILEOBJECT_CONFIG_INIT(&file_object_config, NULL, _ebpf_driver_file_close, _ebpf_driver_file_cleanup);
     WdfDeviceInitSetFileObjectConfig(device_initialize, &file_object_config, &attributes);
 
     // WDF framework doesn't handle IRP_MJ_QUERY_VOLUME_INFORMATION so register a handler for this IRP.
@@ -209,6 +211,14 @@ Exit:
     return status;
 }
 
+static void
+_ebpf_driver_file_cleanup(WDFFILEOBJECT wdf_file_object)
+{
+    // Invoked in the context of the closing process when the last handle to the file object is closed.
+    FILE_OBJECT* file_object = WdfFileObjectWdmGetFileObject(wdf_file_object);
+    ebpf_handle_cleanup(file_object->FsContext2, file_object);
+}
+
 static void
 _ebpf_driver_file_close(WDFFILEOBJECT wdf_file_object)
 {
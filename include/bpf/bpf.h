@@ -177,7 +177,8 @@ bpf_map_lookup_elem(int fd, const void* key, void* value);
  * @param[in] fd File descriptor of map.
  * @param[in] key Pointer to key.
  * @param[in] value Pointer to value.
- * @param[in] flags Flags (currently 0).
+ * @param[in] flags One of BPF_ANY, BPF_NOEXIST or BPF_EXIST, optionally combined with
+ * BPF_F_LOCK to overwrite the value of an existing hash map element in place.
  *
  * @exception EINVAL An invalid argument was provided.
  * @exception EBADF The file descriptor was not found.
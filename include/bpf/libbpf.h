@@ -143,6 +143,18 @@ bpf_map__key_size(const struct bpf_map* map);
 __u32
 bpf_map__max_entries(const struct bpf_map* map);
 
+/**
+ * @brief Get the address at which the values of a map created with
+ * BPF_F_MMAPABLE are mapped into the calling process. Reads and writes
+ * through this address do not require a system call.
+ *
+ * @param[in] map Map to map.
+ *
+ * @returns Address of the first value, or NULL on failure with errno set.
+ */
+void*
+bpf_map__mmap(struct bpf_map* map);
+
 /**
  * @brief Get the name of an eBPF map.
  *
@@ -913,6 +925,83 @@ ring_buffer__new(int map_fd, ring_buffer_sample_fn sample_cb, void* ctx, const s
  */
 void
 ring_buffer__free(struct ring_buffer* rb);
+
+/**
+ * @brief Deliver the records that are available in the ring buffer on the
+ * calling thread, waiting for records if none are available. Records are read
+ * through memory shared with the ring buffer map, so a busy ring buffer is
+ * drained without a system call.
+ *
+ * @param[in] rb Pointer to ring buffer.
+ * @param[in] timeout_ms Time to wait in milliseconds, or a negative value to wait forever.
+ *
+ * @returns Number of records delivered, or a negative error code.
+ */
+int
+ring_buffer__poll(struct ring_buffer* rb, int timeout_ms);
+
+/**
+ * @brief Deliver the records that are available in the ring buffer without waiting.
+ *
+ * @param[in] rb Pointer to ring buffer.
+ *
+ * @returns Number of records delivered, or a negative error code.
+ */
+int
+ring_buffer__consume(struct ring_buffer* rb);
+
+/* Perf buffer APIs */
+
+/**
+ * @brief Creates a new perf buffer manager for a BPF_MAP_TYPE_PERF_EVENT_ARRAY map.
+ *
+ * @param[in] map_fd File descriptor to perf event array map.
+ * @param[in] page_cnt Ignored. The size of each per-CPU buffer is the max_entries of the map.
+ * @param[in] sample_cb Pointer to function called for each record.
+ * @param[in] lost_cb Optional pointer to function called with the number of records dropped by a CPU.
+ * @param[in] ctx Pointer passed to sample_cb and lost_cb.
+ * @param[in] opts Perf buffer options.
+ *
+ * @returns Pointer to perf buffer manager, or NULL on failure with errno set.
+ */
+struct perf_buffer*
+perf_buffer__new(
+    int map_fd,
+    size_t page_cnt,
+    perf_buffer_sample_fn sample_cb,
+    perf_buffer_lost_fn lost_cb,
+    void* ctx,
+    const struct perf_buffer_opts* opts);
+
+/**
+ * @brief Frees a perf buffer manager.
+ *
+ * @param[in] pb Pointer to perf buffer to be freed.
+ */
+void
+perf_buffer__free(struct perf_buffer* pb);
+
+/**
+ * @brief Deliver the records of all CPUs in one call, waiting for records if
+ * none are available.
+ *
+ * @param[in] pb Pointer to perf buffer.
+ * @param[in] timeout_ms Time to wait in milliseconds, or a negative value to wait forever.
+ *
+ * @returns Number of records delivered, or a negative error code.
+ */
+int
+perf_buffer__poll(struct perf_buffer* pb, int timeout_ms);
+
+/**
+ * @brief Deliver the records that are available on all CPUs without waiting.
+ *
+ * @param[in] pb Pointer to perf buffer.
+ *
+ * @returns Number of records delivered, or a negative error code.
+ */
+int
+perf_buffer__consume(struct perf_buffer* pb);
 /** @} */
 
 #else
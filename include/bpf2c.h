@@ -71,6 +71,18 @@ extern "C"
         const char* name;
     } map_entry_t;
 
+    /**
+     * @brief Map data entry.
+     * This structure contains the address of the values of a map, so that generated code can look up array map values
+     * without calling a helper function. Entries are indexed like the map entries. The address is written into the
+     * entry during load time for BPF_MAP_TYPE_ARRAY maps and is left NULL for all other maps, in which case the
+     * generated code calls the helper function.
+     */
+    typedef struct _map_data_entry
+    {
+        void* address;
+    } map_data_entry_t;
+
     /**
      * @brief Map initial values.
      * This structure contains the initial values for a map. The values are used to initialize the map when the
@@ -84,6 +96,21 @@ extern "C"
         const char** values; // Array of strings containing the initial values.
     } map_initial_values_t;
 
+    /**
+     * @brief Global variable section.
+     * This structure describes a .data, .bss or .rodata section of the ELF file. Each section is backed by a single
+     * entry BPF_MAP_TYPE_ARRAY map of the same name, which is initialized from initial_data when the program is
+     * loaded. Generated code reads and writes global variables directly through the map data entry of that map.
+     * Generated code may fold loads from a read-only section into constants, so its map is frozen once initialized.
+     */
+    typedef struct _global_variable_section_info
+    {
+        const char* name;         // Name of the section and of the map backing it.
+        size_t size;              // Size of the section in bytes.
+        const void* initial_data; // Initial contents of the section, or NULL if the section is zero filled.
+        bool read_only;           // True for .rodata sections.
+    } global_variable_section_info_t;
+
     /**
      * @brief Program entry.
      * This structure contains the address of the program and additional information about the program.
@@ -144,6 +171,12 @@ extern "C"
         void (*map_initial_values)(
             _Outptr_result_buffer_maybenull_(*count) map_initial_values_t** map_initial_values,
             _Out_ size_t* count); ///< Returns the list of initial values for maps in this module.
+        void (*map_data)(
+            _Outptr_result_buffer_maybenull_(*count) map_data_entry_t** map_data,
+            _Out_ size_t* count); ///< Returns the list of map data entries in this module.
+        void (*global_variable_sections)(
+            _Outptr_result_buffer_maybenull_(*count) global_variable_section_info_t** global_variable_sections,
+            _Out_ size_t* count); ///< Returns the list of global variable sections in this module.
     } metadata_table_t;
 
     /**
@@ -419,6 +419,22 @@ EBPF_HELPER(int64_t, bpf_get_socket_cookie, (const void* ctx));
 #define bpf_get_socket_cookie ((bpf_get_socket_cookie_t)BPF_FUNC_get_socket_cookie)
 #endif
 
+/**
+ * @brief Copy data into the perf event array buffer of the current CPU.
+ *
+ * @param[in] ctx Context passed to the eBPF program.
+ * @param[in, out] map Pointer to perf event array map.
+ * @param[in] flags CPU index of the buffer to write to, which must be
+ * BPF_F_CURRENT_CPU or the index of the current CPU.
+ * @param[in] data Data to copy into the buffer.
+ * @param[in] size Length of data.
+ * @returns 0 on success and a negative value on error.
+ */
+EBPF_HELPER(long, bpf_perf_event_output, (void* ctx, void* map, uint64_t flags, void* data, uint64_t size));
+#ifndef __doxygen
+#define bpf_perf_event_output ((bpf_perf_event_output_t)BPF_FUNC_perf_event_output)
+#endif
+
 #if __clang__
 #define memcpy(dest, src, dest_size) bpf_memcpy(dest, dest_size, src, dest_size)
 #define memcmp(mem1, mem2, mem1_size) bpf_memcmp(mem1, mem1_size, mem2, mem1_size)
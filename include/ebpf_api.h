@@ -564,6 +564,160 @@ extern "C"
     _Must_inspect_result_ ebpf_result_t
     ebpf_program_test_run(fd_t program_fd, _Inout_ ebpf_test_run_options_t* options) EBPF_NO_EXCEPT;
 
+    /**
+     * @brief Enable or disable the collection of runtime statistics for all
+     * programs. While enabled, the run_cnt, run_time_ns and tail_call_cnt
+     * fields of bpf_prog_info are updated on every invocation. Statistics
+     * collected earlier are kept when collection is disabled.
+     *
+     * @param[in] enabled True to collect statistics, false to stop.
+     * @retval EBPF_SUCCESS The operation was successful.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_program_set_statistics(bool enabled) EBPF_NO_EXCEPT;
+
+    /**
+     * @brief Map the values of an array map created with BPF_F_MMAPABLE
+     * read/write into the calling process. Values are laid out back to back
+     * in index order and stay mapped for the lifetime of the process.
+     *
+     * @param[in] map_fd File descriptor of the map.
+     * @param[out] address Address of the first value.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_INVALID_FD The map file descriptor is invalid.
+     * @retval EBPF_OPERATION_NOT_SUPPORTED The map was not created with BPF_F_MMAPABLE.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_map_mmap(fd_t map_fd, _Outptr_ void** address) EBPF_NO_EXCEPT;
+
+    typedef struct _ebpf_map_ring ebpf_map_ring_t;
+
+    /**
+     * @brief Create a ring that queues map operations in memory shared with
+     * the execution context and submits them in bulk. All operations in a
+     * submission are processed by a single call into the execution context.
+     *
+     * @param[in] entry_count Number of submission and completion entries,
+     * which must be a power of two.
+     * @param[in] data_size Size in bytes of the area that holds the keys and
+     * values of queued operations.
+     * @param[out] ring Pointer to memory that will contain the ring on
+     * success. Release it with ebpf_map_ring_destroy.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_INVALID_ARGUMENT The entry count or data size is invalid.
+     * @retval EBPF_NO_MEMORY Out of memory.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_map_ring_create(uint32_t entry_count, uint32_t data_size, _Outptr_ ebpf_map_ring_t** ring) EBPF_NO_EXCEPT;
+
+    /**
+     * @brief Release a ring created via ebpf_map_ring_create. Operations that
+     * haven't been submitted are discarded.
+     *
+     * @param[in] ring Ring to release.
+     */
+    void
+    ebpf_map_ring_destroy(_In_opt_ _Post_invalid_ ebpf_map_ring_t* ring) EBPF_NO_EXCEPT;
+
+    /**
+     * @brief Queue a lookup of a map entry. The value is written to the
+     * caller's buffer when the lookup is processed by ebpf_map_ring_submit,
+     * so the buffer must remain valid until then.
+     *
+     * @param[in, out] ring Ring to queue the operation in.
+     * @param[in] map_fd File descriptor of the map, which must stay open until
+     * the operation completes.
+     * @param[in] key Key to look up, or NULL for maps without keys.
+     * @param[out] value Buffer that receives the value.
+     * @param[in] user_data Value returned with the completion.
+     * @retval EBPF_SUCCESS The operation was queued.
+     * @retval EBPF_INVALID_ARGUMENT An invalid argument was supplied.
+     * @retval EBPF_INVALID_FD The map file descriptor is invalid.
+     * @retval EBPF_OPERATION_NOT_SUPPORTED The map doesn't support this operation in a ring.
+     * @retval EBPF_INSUFFICIENT_BUFFER The ring is full. Submit the queued
+     * operations and reap their completions, then try again.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_map_ring_queue_lookup(
+        _Inout_ ebpf_map_ring_t* ring,
+        fd_t map_fd,
+        _In_opt_ const void* key,
+        _Out_ void* value,
+        uint64_t user_data) EBPF_NO_EXCEPT;
+
+    /**
+     * @brief Queue an update of a map entry. The key and value are copied
+     * into the ring.
+     *
+     * @param[in, out] ring Ring to queue the operation in.
+     * @param[in] map_fd File descriptor of the map, which must stay open until
+     * the operation completes.
+     * @param[in] key Key to update, or NULL for maps without keys.
+     * @param[in] value Value to store.
+     * @param[in] flags Flags as in ebpf_map_update_element.
+     * @param[in] user_data Value returned with the completion.
+     * @retval EBPF_SUCCESS The operation was queued.
+     * @retval EBPF_INVALID_ARGUMENT An invalid argument was supplied.
+     * @retval EBPF_INVALID_FD The map file descriptor is invalid.
+     * @retval EBPF_OPERATION_NOT_SUPPORTED The map doesn't support this operation in a ring.
+     * @retval EBPF_INSUFFICIENT_BUFFER The ring is full. Submit the queued
+     * operations and reap their completions, then try again.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_map_ring_queue_update(
+        _Inout_ ebpf_map_ring_t* ring,
+        fd_t map_fd,
+        _In_opt_ const void* key,
+        _In_ const void* value,
+        uint64_t flags,
+        uint64_t user_data) EBPF_NO_EXCEPT;
+
+    /**
+     * @brief Queue a deletion of a map entry. The key is copied into the ring.
+     *
+     * @param[in, out] ring Ring to queue the operation in.
+     * @param[in] map_fd File descriptor of the map, which must stay open until
+     * the operation completes.
+     * @param[in] key Key to delete.
+     * @param[in] user_data Value returned with the completion.
+     * @retval EBPF_SUCCESS The operation was queued.
+     * @retval EBPF_INVALID_ARGUMENT An invalid argument was supplied.
+     * @retval EBPF_INVALID_FD The map file descriptor is invalid.
+     * @retval EBPF_INSUFFICIENT_BUFFER The ring is full. Submit the queued
+     * operations and reap their completions, then try again.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_map_ring_queue_delete(
+        _Inout_ ebpf_map_ring_t* ring, fd_t map_fd, _In_ const void* key, uint64_t user_data) EBPF_NO_EXCEPT;
+
+    /**
+     * @brief Submit the queued operations to the execution context. Each
+     * processed operation posts a completion. Processing stops early if the
+     * completion queue is full or the execution context reaches its limit of
+     * operations per call, in which case the remaining operations stay queued
+     * and the ring must be submitted again.
+     *
+     * @param[in, out] ring Ring to submit.
+     * @param[out] count Optionally receives the number of operations processed.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_INVALID_ARGUMENT The ring was rejected by the execution context.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_map_ring_submit(_Inout_ ebpf_map_ring_t* ring, _Out_opt_ uint32_t* count) EBPF_NO_EXCEPT;
+
+    /**
+     * @brief Reap the oldest completion from the ring.
+     *
+     * @param[in, out] ring Ring to reap the completion from.
+     * @param[out] user_data Value that was passed when the operation was queued.
+     * @param[out] result Result of the operation.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_NO_MORE_KEYS No completions are pending.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_map_ring_get_completion(
+        _Inout_ ebpf_map_ring_t* ring, _Out_ uint64_t* user_data, _Out_ ebpf_result_t* result) EBPF_NO_EXCEPT;
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,3 +31,10 @@ typedef struct _ebpf_ring_buffer_map_async_query_result
     size_t producer;
     size_t consumer;
 } ebpf_ring_buffer_map_async_query_result_t;
+
+typedef struct _ebpf_perf_event_array_map_async_query_result
+{
+    ebpf_ring_buffer_map_async_query_result_t ring_buffer;
+    // Number of records dropped so far because the buffer was full.
+    uint64_t lost_count;
+} ebpf_perf_event_array_map_async_query_result_t;
@@ -70,16 +70,39 @@ typedef ebpf_result_t (*ebpf_program_batch_invoke_function_t)(
  */
 typedef ebpf_result_t (*ebpf_program_batch_end_invoke_function_t)(_Inout_ void* state);
 
+/**
+ * @brief Invoke the eBPF program on a vector of contexts. The epoch is entered
+ * and the program is resolved once for the whole vector, which lets hook
+ * providers amortize the per-invocation cost across a chain of packets.
+ *
+ * @param[in] extension_client_binding_context The context provided by the extension client when the binding was
+ * created.
+ * @param[in,out] program_contexts The contexts for each invocation of the eBPF program.
+ * @param[out] results The result of the eBPF program for each context.
+ * @param[in] count The number of contexts.
+ *
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_NO_MEMORY The operation failed due to lack of memory.
+ * @retval EBPF_EXTENSION_FAILED_TO_LOAD The required extension is not loaded.
+ */
+typedef ebpf_result_t (*ebpf_program_invoke_vector_function_t)(
+    _In_ const void* extension_client_binding_context,
+    _Inout_updates_(count) void** program_contexts,
+    _Out_writes_(count) uint32_t* results,
+    size_t count);
+
 typedef enum _ebpf_link_dispatch_table_version
 {
     EBPF_LINK_DISPATCH_TABLE_VERSION_1 = 1, ///< Initial version of the dispatch table.
+    EBPF_LINK_DISPATCH_TABLE_VERSION_2 = 2, ///< Adds ebpf_program_invoke_vector_function.
     EBPF_LINK_DISPATCH_TABLE_VERSION_CURRENT =
-        EBPF_LINK_DISPATCH_TABLE_VERSION_1, ///< Current version of the dispatch table.
+        EBPF_LINK_DISPATCH_TABLE_VERSION_2, ///< Current version of the dispatch table.
 } ebpf_link_dispatch_table_version_t;
 
 #define EBPF_LINK_DISPATCH_TABLE_FUNCTION_COUNT_1 4
+#define EBPF_LINK_DISPATCH_TABLE_FUNCTION_COUNT_2 5
 #define EBPF_LINK_DISPATCH_TABLE_FUNCTION_COUNT_CURRENT \
-    EBPF_LINK_DISPATCH_TABLE_FUNCTION_COUNT_1 ///< Current number of functions in the dispatch table.
+    EBPF_LINK_DISPATCH_TABLE_FUNCTION_COUNT_2 ///< Current number of functions in the dispatch table.
 
 typedef struct _ebpf_extension_program_dispatch_table
 {
@@ -89,6 +112,7 @@ typedef struct _ebpf_extension_program_dispatch_table
     ebpf_program_batch_begin_invoke_function_t ebpf_program_batch_begin_invoke_function;
     ebpf_program_batch_invoke_function_t ebpf_program_batch_invoke_function;
     ebpf_program_batch_end_invoke_function_t ebpf_program_batch_end_invoke_function;
+    ebpf_program_invoke_vector_function_t ebpf_program_invoke_vector_function; ///< Present from version 2.
 } ebpf_extension_program_dispatch_table_t;
 
 typedef struct _ebpf_extension_data
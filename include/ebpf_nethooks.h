@@ -25,6 +25,13 @@ typedef enum _xdp_action
     XDP_TX        ///< Bounce the received packet back out the same NIC it arrived on.
 } xdp_action_t;
 
+// XDP_TEST attach parameters. Clients may instead pass only the uint32_t interface index.
+typedef struct _xdp_attach_parameters
+{
+    uint32_t if_index;          ///< Interface index to attach to, or 0 for all interfaces.
+    uint32_t max_header_length; ///< Bytes at the start of each packet the program reads, or 0 for the whole packet.
+} xdp_attach_parameters_t;
+
 /**
  * @brief Handle an incoming packet as early as possible.
  *
@@ -21,16 +21,18 @@ typedef enum bpf_map_type
     BPF_MAP_TYPE_ARRAY = 2,  ///< Array, where the map key is the array index.
     BPF_MAP_TYPE_PROG_ARRAY =
         3, ///< Array of program fds usable with bpf_tail_call, where the map key is the array index.
-    BPF_MAP_TYPE_PERCPU_HASH = 4,      ///< Per-CPU hash table.
-    BPF_MAP_TYPE_PERCPU_ARRAY = 5,     ///< Per-CPU array.
-    BPF_MAP_TYPE_HASH_OF_MAPS = 6,     ///< Hash table, where the map value is another map.
-    BPF_MAP_TYPE_ARRAY_OF_MAPS = 7,    ///< Array, where the map value is another map.
-    BPF_MAP_TYPE_LRU_HASH = 8,         ///< Least-recently-used hash table.
-    BPF_MAP_TYPE_LPM_TRIE = 9,         ///< Longest prefix match trie.
-    BPF_MAP_TYPE_QUEUE = 10,           ///< Queue.
-    BPF_MAP_TYPE_LRU_PERCPU_HASH = 11, ///< Per-CPU least-recently-used hash table.
-    BPF_MAP_TYPE_STACK = 12,           ///< Stack.
-    BPF_MAP_TYPE_RINGBUF = 13          ///< Ring buffer.
+    BPF_MAP_TYPE_PERCPU_HASH = 4,       ///< Per-CPU hash table.
+    BPF_MAP_TYPE_PERCPU_ARRAY = 5,      ///< Per-CPU array.
+    BPF_MAP_TYPE_HASH_OF_MAPS = 6,      ///< Hash table, where the map value is another map.
+    BPF_MAP_TYPE_ARRAY_OF_MAPS = 7,     ///< Array, where the map value is another map.
+    BPF_MAP_TYPE_LRU_HASH = 8,          ///< Least-recently-used hash table.
+    BPF_MAP_TYPE_LPM_TRIE = 9,          ///< Longest prefix match trie.
+    BPF_MAP_TYPE_QUEUE = 10,            ///< Queue.
+    BPF_MAP_TYPE_LRU_PERCPU_HASH = 11,  ///< Per-CPU least-recently-used hash table.
+    BPF_MAP_TYPE_STACK = 12,            ///< Stack.
+    BPF_MAP_TYPE_RINGBUF = 13,          ///< Ring buffer.
+    BPF_MAP_TYPE_PERF_EVENT_ARRAY = 14, ///< Per-CPU ring buffers written with bpf_perf_event_output.
+    BPF_MAP_TYPE_BLOOM_FILTER = 15      ///< Bloom filter, where push adds a value and peek tests for it.
 } ebpf_map_type_t;
 
 #define BPF_MAP_TYPE_PER_CPU(X) \
@@ -51,6 +53,8 @@ static const char* const _ebpf_map_type_names[] = {
     BPF_ENUM_TO_STRING(BPF_MAP_TYPE_LRU_PERCPU_HASH),
     BPF_ENUM_TO_STRING(BPF_MAP_TYPE_STACK),
     BPF_ENUM_TO_STRING(BPF_MAP_TYPE_RINGBUF),
+    BPF_ENUM_TO_STRING(BPF_MAP_TYPE_PERF_EVENT_ARRAY),
+    BPF_ENUM_TO_STRING(BPF_MAP_TYPE_BLOOM_FILTER),
 };
 
 static const char* const _ebpf_map_display_names[] = {
@@ -68,6 +72,8 @@ static const char* const _ebpf_map_display_names[] = {
     "lru_percpu_hash",
     "stack",
     "ringbuf",
+    "perf_event_array",
+    "bloom_filter",
 };
 
 typedef enum ebpf_map_option
@@ -106,6 +112,8 @@ typedef struct _ebpf_map_definition_in_memory
     uint32_t max_entries; ///< Maximum number of entries allowed in the map.
     ebpf_id_t inner_map_id;
     ebpf_pin_type_t pinning;
+    uint32_t map_flags; ///< Flags used to create the map (BPF_F_*).
+    uint64_t map_extra; ///< Type-specific data. Number of hash functions for BPF_MAP_TYPE_BLOOM_FILTER.
 } ebpf_map_definition_in_memory_t;
 
 /**
@@ -161,6 +169,7 @@ typedef enum
     BPF_FUNC_memset = 24,                    ///< \ref bpf_memset
     BPF_FUNC_memmove = 25,                   ///< \ref bpf_memmove
     BPF_FUNC_get_socket_cookie = 26,         ///< \ref bpf_get_socket_cookie
+    BPF_FUNC_perf_event_output = 27,         ///< \ref bpf_perf_event_output
 } ebpf_helper_id_t;
 
 // Cross-platform BPF program types.
@@ -378,11 +387,25 @@ struct bpf_map_info
     // Windows-specific fields.
     ebpf_id_t inner_map_id;     ///< ID of inner map template.
     uint32_t pinned_path_count; ///< Number of pinned paths.
+
+    // Cross-platform fields added later, appended to keep the layout of the fields above.
+    uint64_t map_extra; ///< Type-specific data the map was created with.
 };
 
 #define BPF_ANY 0x0
 #define BPF_NOEXIST 0x1
 #define BPF_EXIST 0x2
+#define BPF_F_LOCK 0x4 ///< Update the value of an existing element in place.
+
+// bpf_perf_event_output flags.
+#define BPF_F_INDEX_MASK 0xffffffffULL     ///< Mask of the CPU index in the flags.
+#define BPF_F_CURRENT_CPU BPF_F_INDEX_MASK ///< Write to the buffer of the current CPU.
+
+// Map creation flags.
+#define BPF_F_NO_PREALLOC 0x1 ///< Allocate hash map storage on demand rather than when the map is created.
+#define BPF_F_MMAPABLE 0x400  ///< Allow the values of an array map to be mapped into user mode with bpf_map__mmap.
+// Windows-specific: give the slot of each CPU in a per-CPU map value its own cache line.
+#define BPF_F_PERCPU_CACHE_ALIGN 0x80000000
 
 /**
  * @brief eBPF program information.  This structure can be retrieved by calling
@@ -402,4 +425,9 @@ struct bpf_prog_info
     ebpf_attach_type_t attach_type_uuid; ///< Attach type UUID.
     uint32_t pinned_path_count;          ///< Number of pinned paths.
     uint32_t link_count;                 ///< Number of attached links.
+
+    // Runtime statistics, collected while enabled by ebpf_program_set_statistics().
+    uint64_t run_time_ns;   ///< Total time spent running the program and its tail calls, in nanoseconds.
+    uint64_t run_cnt;       ///< Number of times the program was invoked.
+    uint64_t tail_call_cnt; ///< Number of tail calls made from the program.
 };
@@ -14,6 +14,7 @@
 struct bpf_object;
 
 typedef struct _ebpf_ring_buffer_subscription ring_buffer_subscription_t;
+typedef struct _ebpf_perf_buffer_subscription perf_buffer_subscription_t;
 
 typedef struct bpf_program
 {
@@ -60,6 +61,9 @@ typedef struct bpf_map
     // Whether this map is newly created or reused
     // from an existing map.
     bool reused;
+    // User-mode address of the values of a BPF_F_MMAPABLE map,
+    // once mapped by bpf_map__mmap.
+    void* mmaped;
 } ebpf_map_t;
 
 typedef struct bpf_link
@@ -335,8 +339,9 @@ ebpf_map_lookup_element(fd_t map_fd, _In_opt_ const void* key, _Out_ void* value
  *  For a per-cpu map, return aggregate value across all CPUs.
  *
  * @param[in] map_fd File descriptor for the eBPF map.
- * @param[in] in_batch Pointer to buffer containing keys.
- * @param[out] out_batch Pointer to buffer that contains values on success.
+ * @param[in] in_batch Batch token returned in out_batch by the previous call, or NULL to start from the beginning of
+ * the map.
+ * @param[out] out_batch Pointer to a buffer of at least one key that receives the batch token to resume from.
  * @param[out] keys Pointer to buffer that contains keys on success.
  * @param[out] values Pointer to buffer that contains values on success.
  * @param[in, out] count On input, contains the maximum number of elements to
@@ -379,8 +384,9 @@ ebpf_map_lookup_and_delete_element(fd_t map_fd, _In_opt_ const void* key, _Out_
  *  For a per-cpu map, return aggregate value across all CPUs.
  *
  * @param[in] map_fd File descriptor for the eBPF map.
- * @param[in] in_batch Pointer to buffer containing keys.
- * @param[out] out_batch Pointer to buffer that contains values on success.
+ * @param[in] in_batch Batch token returned in out_batch by the previous call, or NULL to start from the beginning of
+ * the map.
+ * @param[out] out_batch Pointer to a buffer of at least one key that receives the batch token to resume from.
  * @param[out] keys Pointer to buffer that contains keys on success.
  * @param[out] values Pointer to buffer that contains values on success.
  * @param[in, out] count On input, contains the maximum number of elements to
@@ -656,6 +662,74 @@ ebpf_ring_buffer_map_subscribe(
 bool
 ebpf_ring_buffer_map_unsubscribe(_In_ _Post_invalid_ ring_buffer_subscription_t* subscription) noexcept;
 
+/**
+ * @brief Deliver the records that are ready in a ring buffer subscription on
+ * the calling thread. Records are read and returned through the mapped offset
+ * pages, so no IOCTL is issued unless the ring buffer is empty and the caller
+ * waits for new records. Must not be called concurrently with
+ * ebpf_ring_buffer_map_unsubscribe.
+ *
+ * @param[in, out] subscription Ring buffer subscription to poll.
+ * @param[in] timeout_ms Time to wait for records if none are ready, 0 to not
+ * wait or a negative value to wait indefinitely.
+ * @param[out] count Number of records delivered to the sample callback.
+ *
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_NO_MEMORY Out of memory.
+ */
+_Must_inspect_result_ ebpf_result_t
+ebpf_ring_buffer_map_poll(
+    _Inout_ ring_buffer_subscription_t* subscription, int32_t timeout_ms, _Out_ uint32_t* count) noexcept;
+
+typedef void (*perf_buffer_sample_fn)(void* ctx, int cpu, void* data, uint32_t size);
+typedef void (*perf_buffer_lost_fn)(void* ctx, int cpu, uint64_t cnt);
+
+/**
+ * @brief Subscribe to the per-CPU buffers of a perf event array map. Records
+ * are delivered by ebpf_perf_event_array_map_poll on the calling thread.
+ *
+ * @param[in] perf_event_array_map_fd File descriptor to the perf event array map.
+ * @param[in, out] callback_context Pointer to supplied context to be passed in callbacks.
+ * @param[in] sample_callback Function pointer to record handler.
+ * @param[in] lost_callback Optional function pointer to handler for records dropped because a buffer was full.
+ * @param[out] subscription Opaque pointer to perf buffer subscription object.
+ *
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_INVALID_ARGUMENT The map is not a perf event array map.
+ * @retval EBPF_NO_MEMORY Out of memory.
+ */
+_Must_inspect_result_ ebpf_result_t
+ebpf_perf_event_array_map_subscribe(
+    fd_t perf_event_array_map_fd,
+    _Inout_opt_ void* callback_context,
+    perf_buffer_sample_fn sample_callback,
+    _In_opt_ perf_buffer_lost_fn lost_callback,
+    _Outptr_ perf_buffer_subscription_t** subscription) noexcept;
+
+/**
+ * @brief Deliver the available records of all CPUs, waiting for records if
+ * none are available.
+ *
+ * @param[in, out] subscription Perf buffer subscription to poll.
+ * @param[in] timeout_ms Time to wait for records in milliseconds, 0 to not
+ * wait, or a negative value to wait forever.
+ * @param[out] count Number of records delivered.
+ *
+ * @retval EBPF_SUCCESS The operation was successful.
+ */
+_Must_inspect_result_ ebpf_result_t
+ebpf_perf_event_array_map_poll(
+    _Inout_ perf_buffer_subscription_t* subscription, int32_t timeout_ms, _Out_ uint32_t* count) noexcept;
+
+/**
+ * @brief Unsubscribe from a perf event array map. Waits for outstanding
+ * queries to be canceled.
+ *
+ * @param[in] subscription Pointer to perf buffer subscription to be freed.
+ */
+void
+ebpf_perf_event_array_map_unsubscribe(_In_opt_ _Post_invalid_ perf_buffer_subscription_t* subscription) noexcept;
+
 /**
  * @brief Get list of programs and stats in an ELF eBPF file.
  * @param[in] file Name of ELF file containing eBPF program.
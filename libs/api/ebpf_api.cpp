@@ -37,6 +37,7 @@ typedef unsigned char boolean;
 
 #include <algorithm>
 #include <codecvt>
+#include <condition_variable>
 #include <fcntl.h>
 #include <io.h>
 #include <mutex>
@@ -313,7 +314,7 @@ ebpf_map_create(
 
     ebpf_assert(map_fd);
 
-    if (opts && opts->map_flags != 0) {
+    if (opts && (opts->map_flags & ~(BPF_F_NO_PREALLOC | BPF_F_MMAPABLE | BPF_F_PERCPU_CACHE_ALIGN)) != 0) {
         result = EBPF_INVALID_ARGUMENT;
         goto Exit;
     }
@@ -324,6 +325,8 @@ ebpf_map_create(
         map_definition.key_size = key_size;
         map_definition.value_size = value_size;
         map_definition.max_entries = max_entries;
+        map_definition.map_flags = opts ? opts->map_flags : 0;
+        map_definition.map_extra = opts ? opts->map_extra : 0;
 
         // bpf_map_create_opts has inner_map_fd defined as __u32, so it cannot be set to
         // ebpf_fd_invalid (-1). Hence treat inner_map_fd = 0 as ebpf_fd_invalid.
@@ -465,7 +468,6 @@ _ebpf_map_lookup_element_helper(fd_t map_fd, bool find_and_delete, _In_opt_ cons
         result = EBPF_INVALID_ARGUMENT;
         goto Exit;
     }
-    *((uint8_t*)value) = 0;
 
     map_handle = _get_handle_from_file_descriptor(map_fd);
     if (map_handle == ebpf_handle_invalid) {
@@ -478,6 +480,17 @@ _ebpf_map_lookup_element_helper(fd_t map_fd, bool find_and_delete, _In_opt_ cons
     if (result != EBPF_SUCCESS) {
         goto Exit;
     }
+    if (type == BPF_MAP_TYPE_BLOOM_FILTER) {
+        // A bloom filter lookup tests for the value the caller passed in, so send it as the key.
+        if (key != nullptr || find_and_delete) {
+            result = EBPF_INVALID_ARGUMENT;
+            goto Exit;
+        }
+        key = value;
+        key_size = value_size;
+    } else {
+        *((uint8_t*)value) = 0;
+    }
     if ((key == nullptr) != (key_size == 0)) {
         result = EBPF_INVALID_ARGUMENT;
         goto Exit;
@@ -497,6 +510,129 @@ Exit:
 }
 CATCH_NO_MEMORY_EBPF_RESULT
 
+/**
+ * @brief Check whether a batch lookup on a map resumes from a cursor rather than from the last key returned. The
+ * cursor is kept in the caller's batch token, which must be able to hold a key, so maps with keys smaller than a
+ * cursor resume from the last key.
+ *
+ * @param[in] type Type of the map.
+ * @param[in] key_size Size of a key of the map.
+ * @retval true The map is walked with a cursor.
+ * @retval false The map is walked from the last key returned.
+ */
+static bool
+_ebpf_map_batch_uses_cursor(uint32_t type, size_t key_size)
+{
+    if (key_size < sizeof(uint32_t)) {
+        return false;
+    }
+
+    switch (type) {
+    case BPF_MAP_TYPE_HASH:
+    case BPF_MAP_TYPE_PERCPU_HASH:
+    case BPF_MAP_TYPE_HASH_OF_MAPS:
+    case BPF_MAP_TYPE_LRU_HASH:
+    case BPF_MAP_TYPE_LRU_PERCPU_HASH:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Fetch the next run of key/value pairs from a map. Runs that don't fit in a single protocol message are
+ * written directly to the caller's buffer by the execution context.
+ *
+ * @param[in] map_handle Handle of the map.
+ * @param[in] find_and_delete Delete each returned entry.
+ * @param[in] use_cursor Walk the map with a cursor instead of previous_key.
+ * @param[in, out] cursor Cursor to start from, updated to the position after the run.
+ * @param[in] previous_key Key to start after or nullptr to start at the first key.
+ * @param[in] key_size Size of a key in bytes.
+ * @param[out] data Buffer that receives the interleaved key/value pairs.
+ * @param[in] data_size Size of the buffer in bytes.
+ * @param[out] data_length Number of bytes written to data.
+ * @returns EBPF_SUCCESS on success, or the error returned by the execution context.
+ */
+static _Must_inspect_result_ ebpf_result_t
+_ebpf_map_get_next_key_value_batch(
+    ebpf_handle_t map_handle,
+    bool find_and_delete,
+    bool use_cursor,
+    _Inout_ uint64_t* cursor,
+    _In_reads_opt_(key_size) const uint8_t* previous_key,
+    size_t key_size,
+    _Out_writes_bytes_to_(data_size, *data_length) uint8_t* data,
+    size_t data_size,
+    _Out_ size_t* data_length)
+{
+    ebpf_result_t result;
+    *data_length = 0;
+
+    if (data_size <= UINT16_MAX - EBPF_OFFSET_OF(ebpf_operation_map_get_next_key_value_batch_reply_t, data)) {
+        ebpf_protocol_buffer_t request_buffer(
+            EBPF_OFFSET_OF(ebpf_operation_map_get_next_key_value_batch_request_t, previous_key) +
+            (previous_key ? key_size : 0));
+        auto request = reinterpret_cast<ebpf_operation_map_get_next_key_value_batch_request_t*>(request_buffer.data());
+        ebpf_protocol_buffer_t reply_buffer(
+            EBPF_OFFSET_OF(ebpf_operation_map_get_next_key_value_batch_reply_t, data) + data_size);
+        auto reply = reinterpret_cast<ebpf_operation_map_get_next_key_value_batch_reply_t*>(reply_buffer.data());
+
+        request->header.length = static_cast<uint16_t>(request_buffer.size());
+        request->header.id = ebpf_operation_id_t::EBPF_OPERATION_MAP_GET_NEXT_KEY_VALUE_BATCH;
+        request->handle = map_handle;
+        request->find_and_delete = find_and_delete;
+        request->use_cursor = use_cursor;
+        request->cursor = *cursor;
+        if (previous_key) {
+            std::copy(previous_key, previous_key + key_size, request->previous_key);
+        }
+
+        result = win32_error_code_to_ebpf_result(invoke_ioctl(request_buffer, reply_buffer));
+        if (result != EBPF_SUCCESS) {
+            return result;
+        }
+
+        *data_length = reply->header.length - EBPF_OFFSET_OF(ebpf_operation_map_get_next_key_value_batch_reply_t, data);
+        std::copy(reply->data, reply->data + *data_length, data);
+        *cursor = reply->cursor;
+    } else {
+        // The execution context writes the run directly to the caller's buffer.
+        ebpf_protocol_buffer_t request_buffer(
+            EBPF_OFFSET_OF(ebpf_operation_map_get_next_key_value_batch_buffer_request_t, previous_key) +
+            (previous_key ? key_size : 0));
+        auto request =
+            reinterpret_cast<ebpf_operation_map_get_next_key_value_batch_buffer_request_t*>(request_buffer.data());
+        ebpf_operation_map_get_next_key_value_batch_buffer_reply_t reply;
+
+        request->header.length = static_cast<uint16_t>(request_buffer.size());
+        request->header.id = ebpf_operation_id_t::EBPF_OPERATION_MAP_GET_NEXT_KEY_VALUE_BATCH_BUFFER;
+        request->handle = map_handle;
+        request->find_and_delete = find_and_delete;
+        request->use_cursor = use_cursor;
+        request->cursor = *cursor;
+        request->data.address = reinterpret_cast<uint64_t>(data);
+        request->data.length = data_size;
+        if (previous_key) {
+            std::copy(previous_key, previous_key + key_size, request->previous_key);
+        }
+
+        result = win32_error_code_to_ebpf_result(invoke_ioctl(request_buffer, reply));
+        if (result != EBPF_SUCCESS) {
+            return result;
+        }
+
+        if (reply.data_length > data_size) {
+            return EBPF_INVALID_ARGUMENT;
+        }
+
+        *data_length = static_cast<size_t>(reply.data_length);
+        *cursor = reply.cursor;
+    }
+
+    return EBPF_SUCCESS;
+}
+
 static _Must_inspect_result_ ebpf_result_t
 _ebpf_map_lookup_element_batch_helper(
     fd_t map_fd,
@@ -520,6 +656,9 @@ _ebpf_map_lookup_element_batch_helper(
     size_t max_entries_per_batch;
     size_t key_size;
     size_t value_size;
+    bool use_cursor;
+    uint64_t cursor = 0;
+    std::vector<uint8_t> data;
 
     const uint8_t* previous_key = reinterpret_cast<const uint8_t*>(in_batch);
 
@@ -557,39 +696,51 @@ _ebpf_map_lookup_element_batch_helper(
         goto Exit;
     }
 
-    // Compute the maximum number of entries that can be updated in a single batch.
-    max_entries_per_batch = UINT16_MAX - EBPF_OFFSET_OF(_ebpf_operation_map_get_next_key_value_batch_reply, data);
+    // Hash table cursors are in [1, 2^32] once a batch has been returned, so the batch token holds the cursor - 1.
+    use_cursor = _ebpf_map_batch_uses_cursor(type, key_size);
+    if (use_cursor && in_batch) {
+        uint32_t token;
+        memcpy(&token, in_batch, sizeof(token));
+        cursor = static_cast<uint64_t>(token) + 1;
+        previous_key = nullptr;
+    }
+
+    // Compute the maximum number of entries that can be fetched in a single batch. Batches that don't fit in a protocol
+    // message are written directly to the caller's buffer, which is limited to 4 GB.
+    max_entries_per_batch = UINT16_MAX - EBPF_OFFSET_OF(ebpf_operation_map_get_next_key_value_batch_reply_t, data);
     max_entries_per_batch /= (key_size + value_size);
+    if (input_count > max_entries_per_batch) {
+        max_entries_per_batch = UINT32_MAX / (key_size + value_size);
+    }
+
+    data.resize(min(input_count, max_entries_per_batch) * (key_size + value_size));
 
     while (count_returned < input_count) {
         // Fetch the next batch of entries.
         size_t entries_to_fetch = min(input_count - count_returned, max_entries_per_batch);
-
-        ebpf_protocol_buffer_t request_buffer(
-            EBPF_OFFSET_OF(_ebpf_operation_map_get_next_key_value_batch_request, previous_key) +
-            (previous_key ? key_size : 0));
-        auto request = reinterpret_cast<_ebpf_operation_map_get_next_key_value_batch_request*>(request_buffer.data());
-        ebpf_protocol_buffer_t reply_buffer(
-            EBPF_OFFSET_OF(_ebpf_operation_map_get_next_key_value_batch_reply, data) +
-            entries_to_fetch * (key_size + value_size));
-        auto reply = reinterpret_cast<_ebpf_operation_map_get_next_key_value_batch_reply*>(reply_buffer.data());
-
-        request->header.length = static_cast<uint16_t>(request_buffer.size());
-        request->header.id = ebpf_operation_id_t::EBPF_OPERATION_MAP_GET_NEXT_KEY_VALUE_BATCH;
-        request->handle = map_handle;
-        request->find_and_delete = find_and_delete;
-        if (previous_key) {
-            std::copy(previous_key, previous_key + key_size, request->previous_key);
+        size_t data_length;
+
+        result = _ebpf_map_get_next_key_value_batch(
+            map_handle,
+            find_and_delete,
+            use_cursor,
+            &cursor,
+            previous_key,
+            key_size,
+            data.data(),
+            entries_to_fetch * (key_size + value_size),
+            &data_length);
+        if (count_returned != 0 &&
+            (result == EBPF_NO_MORE_KEYS || (use_cursor && result == EBPF_INSUFFICIENT_BUFFER))) {
+            // The end of the map or a bucket that doesn't fit in the rest of the caller's buffer ends the batch.
+            result = EBPF_SUCCESS;
+            break;
         }
-
-        result = win32_error_code_to_ebpf_result(invoke_ioctl(request_buffer, reply_buffer));
         if (result != EBPF_SUCCESS) {
             goto Exit;
         }
 
-        size_t entries_returned =
-            reply->header.length - EBPF_OFFSET_OF(_ebpf_operation_map_get_next_key_value_batch_reply, data);
-        entries_returned /= (key_size + value_size);
+        size_t entries_returned = data_length / (key_size + value_size);
 
         // Add this check to make the static analyzer happy.
         if (entries_returned == 0) {
@@ -597,14 +748,19 @@ _ebpf_map_lookup_element_batch_helper(
             goto Exit;
         }
 
-        for (uint32_t index = 0; index < entries_returned; index++) {
-            uint8_t* key_data = reply->data + index * (key_size + value_size);
-            uint8_t* value_data = reply->data + index * (key_size + value_size) + key_size;
+        for (size_t index = 0; index < entries_returned; index++) {
+            uint8_t* key_data = data.data() + index * (key_size + value_size);
+            uint8_t* value_data = data.data() + index * (key_size + value_size) + key_size;
             std::copy(key_data, key_data + key_size, (uint8_t*)keys + (count_returned + index) * key_size);
             std::copy(value_data, value_data + value_size, (uint8_t*)values + (count_returned + index) * value_size);
         }
         count_returned += entries_returned;
 
+        if (use_cursor) {
+            // Cursor walks return whole buckets, so a partial return only means the next bucket didn't fit.
+            continue;
+        }
+
         // Point previous_key to the last key in the batch.
         previous_key = (uint8_t*)keys + (count_returned - 1) * key_size;
 
@@ -614,8 +770,14 @@ _ebpf_map_lookup_element_batch_helper(
         }
     }
 
-    // Copy previous key into out_batch.
-    std::copy(previous_key, previous_key + key_size, (uint8_t*)out_batch);
+    if (use_cursor) {
+        // Copy the cursor into out_batch.
+        uint32_t token = static_cast<uint32_t>(cursor - 1);
+        memcpy(out_batch, &token, sizeof(token));
+    } else {
+        // Copy previous key into out_batch.
+        std::copy(previous_key, previous_key + key_size, (uint8_t*)out_batch);
+    }
 
     *count = static_cast<uint32_t>(count_returned);
 
@@ -727,6 +889,79 @@ Exit:
 }
 CATCH_NO_MEMORY_EBPF_RESULT
 
+static ebpf_result_t
+_update_map_element_batch_buffer(
+    ebpf_handle_t map_handle,
+    _In_opt_ const void* key,
+    size_t key_size,
+    _In_ const void* value,
+    size_t value_size,
+    _Inout_ uint32_t* count,
+    uint64_t flags) NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+    ebpf_result_t result = EBPF_SUCCESS;
+    ebpf_operation_map_update_element_batch_buffer_request_t request;
+    ebpf_operation_map_update_element_batch_buffer_reply_t reply;
+    std::vector<uint8_t> data;
+    size_t input_count = *count;
+    size_t max_entries_per_batch;
+
+    // Each batch is described by a single buffer descriptor, which is limited to 4 GB.
+    max_entries_per_batch = UINT32_MAX / (key_size + value_size);
+    data.resize(min(input_count, max_entries_per_batch) * (key_size + value_size));
+
+    for (size_t key_index = 0; key_index < input_count;) {
+        // Compute the number of entries to update in this batch.
+        size_t entries_to_update = min(input_count - key_index, max_entries_per_batch);
+
+        for (size_t index = 0; index < entries_to_update; index++) {
+            uint8_t* source_key = (uint8_t*)key + (key_index + index) * key_size;
+            uint8_t* source_value = (uint8_t*)value + (key_index + index) * value_size;
+            uint8_t* destination_key = data.data() + index * (key_size + value_size);
+            uint8_t* destination_value = data.data() + index * (key_size + value_size) + key_size;
+            if (key_size > 0) {
+                std::copy(source_key, source_key + key_size, destination_key);
+            }
+            std::copy(source_value, source_value + value_size, destination_value);
+        }
+
+        request.header.length = static_cast<uint16_t>(sizeof(request));
+        request.header.id = ebpf_operation_id_t::EBPF_OPERATION_MAP_UPDATE_ELEMENT_BATCH_BUFFER;
+        request.handle = (uint64_t)map_handle;
+        request.option = static_cast<ebpf_map_option_t>(flags);
+        request.data.address = reinterpret_cast<uint64_t>(data.data());
+        request.data.length = entries_to_update * (key_size + value_size);
+        reply.count_of_elements_processed = 0;
+        reply.result = EBPF_SUCCESS;
+
+        result = win32_error_code_to_ebpf_result(invoke_ioctl(request, reply));
+        if (result != EBPF_SUCCESS) {
+            *count = static_cast<uint32_t>(key_index);
+            goto Exit;
+        }
+
+        if (reply.result != EBPF_SUCCESS) {
+            // Report the entries updated before the failing one.
+            *count = static_cast<uint32_t>(key_index + min(reply.count_of_elements_processed, entries_to_update));
+            result = static_cast<ebpf_result_t>(reply.result);
+            goto Exit;
+        }
+
+        // Check number of entries updated in this batch.
+        if (reply.count_of_elements_processed != entries_to_update) {
+            result = EBPF_INVALID_ARGUMENT;
+            goto Exit;
+        }
+
+        key_index += entries_to_update;
+    }
+
+Exit:
+    EBPF_RETURN_RESULT(result);
+}
+CATCH_NO_MEMORY_EBPF_RESULT
+
 static ebpf_result_t
 _update_map_element_batch(
     ebpf_handle_t map_handle,
@@ -756,6 +991,10 @@ _update_map_element_batch(
     // Compute the maximum number of entries that can be updated in a single batch.
     max_entries_per_batch = UINT16_MAX - EBPF_OFFSET_OF(ebpf_operation_map_update_element_batch_request_t, data);
     max_entries_per_batch /= (key_size + value_size);
+    if (input_count > max_entries_per_batch) {
+        result = _update_map_element_batch_buffer(map_handle, key, key_size, value, value_size, count, flags);
+        goto Exit;
+    }
 
     try {
         for (size_t key_index = 0; key_index < input_count;) {
@@ -848,7 +1087,7 @@ ebpf_map_update_element(fd_t map_fd, _In_opt_ const void* key, _In_ const void*
         EBPF_RETURN_RESULT(EBPF_INVALID_ARGUMENT);
     }
 
-    switch (flags) {
+    switch (flags & ~BPF_F_LOCK) {
     case EBPF_ANY:
     case EBPF_NOEXIST:
     case EBPF_EXIST:
@@ -920,7 +1159,7 @@ ebpf_map_update_element_batch(
         EBPF_RETURN_RESULT(EBPF_INVALID_ARGUMENT);
     }
 
-    switch (flags) {
+    switch (flags & ~BPF_F_LOCK) {
     case EBPF_ANY:
     case EBPF_NOEXIST:
     case EBPF_EXIST:
@@ -4158,12 +4397,19 @@ ebpf_program_bind_map(fd_t program_fd, fd_t map_fd) NO_EXCEPT_TRY
 }
 CATCH_NO_MEMORY_EBPF_RESULT
 
+// Bounds on the number of times the completion callback checks the producer page for new records before it waits for
+// the next async query to complete. The count doubles each time spinning finds records and halves when it doesn't.
+#define EBPF_RING_BUFFER_SUBSCRIPTION_MINIMUM_SPIN_COUNT 16
+#define EBPF_RING_BUFFER_SUBSCRIPTION_MAXIMUM_SPIN_COUNT 4096
+
 typedef struct _ebpf_ring_buffer_subscription
 {
     _ebpf_ring_buffer_subscription()
         : unsubscribed(false), ring_buffer_map_handle(ebpf_handle_invalid), sample_callback_context(nullptr),
-          sample_callback(nullptr), buffer(nullptr), reply({}), async_ioctl_completion(nullptr),
-          async_ioctl_failed(false)
+          sample_callback(nullptr), buffer(nullptr), ring_buffer_size(0), producer_page(nullptr),
+          consumer_page(nullptr), consumer(0), spin_count(EBPF_RING_BUFFER_SUBSCRIPTION_MINIMUM_SPIN_COUNT),
+          wakeup_event(nullptr), reply({}), async_ioctl_completion(nullptr), async_ioctl_pending(false),
+          async_ioctl_failed(false), poll_waiter_count(0)
     {}
     ~_ebpf_ring_buffer_subscription()
     {
@@ -4171,6 +4417,9 @@ typedef struct _ebpf_ring_buffer_subscription
         if (async_ioctl_completion != nullptr) {
             clean_up_async_ioctl_completion(async_ioctl_completion);
         }
+        if (wakeup_event != nullptr) {
+            ::CloseHandle(wakeup_event);
+        }
         if (ring_buffer_map_handle != ebpf_handle_invalid) {
             Platform::CloseHandle(ring_buffer_map_handle);
         }
@@ -4181,13 +4430,116 @@ typedef struct _ebpf_ring_buffer_subscription
     void* sample_callback_context;
     ring_buffer_sample_fn sample_callback;
     uint8_t* buffer;
+    size_t ring_buffer_size;
+    const ebpf_ring_buffer_producer_page_t* producer_page;
+    ebpf_ring_buffer_consumer_page_t* consumer_page;
+    // Serializes delivery of records between the completion callback and callers of ebpf_ring_buffer_map_poll.
+    std::mutex consume_lock;
+    _Guarded_by_(consume_lock) size_t consumer;
+    _Guarded_by_(consume_lock) uint32_t spin_count;
+    // Auto-reset event that is signaled when an async query completes while a caller is polling.
+    HANDLE wakeup_event;
     ebpf_operation_ring_buffer_map_async_query_reply_t reply;
     _Write_guarded_by_(lock) async_ioctl_completion_t* async_ioctl_completion;
+    _Write_guarded_by_(lock) bool async_ioctl_pending;
     _Write_guarded_by_(lock) bool async_ioctl_failed;
+    _Write_guarded_by_(lock) uint32_t poll_waiter_count;
 } ebpf_ring_buffer_subscription_t;
 
 typedef std::unique_ptr<ebpf_ring_buffer_subscription_t> ebpf_ring_buffer_subscription_ptr;
 
+/**
+ * @brief Check whether the record at the consumer offset is ready to be read.
+ */
+static bool
+_ebpf_ring_buffer_subscription_has_records(_In_ const ebpf_ring_buffer_subscription_t* subscription)
+{
+    auto record = ebpf_ring_buffer_next_record(
+        subscription->buffer,
+        subscription->ring_buffer_size,
+        subscription->consumer,
+        subscription->producer_page->producer_offset);
+    return record != nullptr && !ebpf_ring_buffer_record_is_locked(record);
+}
+
+/**
+ * @brief Deliver the records that are ready and publish the new consumer
+ * offset, which returns the space to producers without an IOCTL.
+ */
+static void
+_ebpf_ring_buffer_subscription_consume(
+    _Inout_ ebpf_ring_buffer_subscription_t* subscription, _Inout_ uint32_t* count)
+{
+    size_t consumer = subscription->consumer;
+    size_t producer = subscription->producer_page->producer_offset;
+    for (;;) {
+        auto record =
+            ebpf_ring_buffer_next_record(subscription->buffer, subscription->ring_buffer_size, consumer, producer);
+
+        if (record == nullptr) {
+            // No more records.
+            break;
+        }
+
+        if (ebpf_ring_buffer_record_is_locked(record)) {
+            // The producer is still writing this record. It will be delivered on a later notification.
+            break;
+        }
+
+        if (!record->header.discarded) {
+            int callback_result = subscription->sample_callback(
+                subscription->sample_callback_context,
+                const_cast<void*>(reinterpret_cast<const void*>(record->data)),
+                record->header.length - EBPF_OFFSET_OF(ebpf_ring_buffer_record_t, data));
+            if (callback_result != 0) {
+                break;
+            }
+            (*count)++;
+        }
+
+        consumer += record->header.length;
+    }
+
+    if (consumer != subscription->consumer) {
+        subscription->consumer = consumer;
+        subscription->consumer_page->consumer_offset = consumer;
+    }
+}
+
+static _Requires_lock_held_(subscription->lock) ebpf_result_t
+    _ebpf_ring_buffer_subscription_post_async_query(_Inout_ ebpf_ring_buffer_subscription_t* subscription)
+{
+    // First, register wait for the new async IOCTL operation completion.
+    ebpf_result_t result = register_wait_async_ioctl_operation(subscription->async_ioctl_completion);
+    if (result != EBPF_SUCCESS) {
+        subscription->async_ioctl_failed = true;
+        return result;
+    }
+
+    // Then, post the async IOCTL. The consumer offset is also published in the consumer page, so it is only read
+    // here and not under the consume lock.
+    ebpf_operation_ring_buffer_map_async_query_request_t async_query_request{
+        sizeof(async_query_request),
+        ebpf_operation_id_t::EBPF_OPERATION_RING_BUFFER_MAP_ASYNC_QUERY,
+        subscription->ring_buffer_map_handle,
+        subscription->consumer_page->consumer_offset};
+    memset(&subscription->reply, 0, sizeof(ebpf_operation_ring_buffer_map_async_query_reply_t));
+    subscription->async_ioctl_pending = true;
+    result = win32_error_code_to_ebpf_result(invoke_ioctl(
+        async_query_request,
+        subscription->reply,
+        get_async_ioctl_operation_overlapped(subscription->async_ioctl_completion)));
+    if (result != EBPF_SUCCESS) {
+        if (result == EBPF_PENDING) {
+            result = EBPF_SUCCESS;
+        } else {
+            subscription->async_ioctl_pending = false;
+            subscription->async_ioctl_failed = true;
+        }
+    }
+    return result;
+}
+
 static ebpf_result_t
 _ebpf_ring_buffer_map_async_query_completion(_Inout_ void* completion_context) NO_EXCEPT_TRY
 {
@@ -4197,9 +4549,6 @@ _ebpf_ring_buffer_map_async_query_completion(_Inout_ void* completion_context) N
     ebpf_ring_buffer_subscription_t* subscription =
         reinterpret_cast<ebpf_ring_buffer_subscription_t*>(completion_context);
 
-    size_t consumer = 0;
-    size_t producer = 0;
-
     ebpf_result_t result = EBPF_SUCCESS;
     // Check the result of the completed async IOCTL call.
     result = get_async_ioctl_result(subscription->async_ioctl_completion);
@@ -4209,6 +4558,7 @@ _ebpf_ring_buffer_map_async_query_completion(_Inout_ void* completion_context) N
             // The async IOCTL was not canceled, but completed with a failure status. Mark the subscription object as
             // such, so that it gets freed when the user eventually unsubscribes.
             std::scoped_lock lock{subscription->lock};
+            subscription->async_ioctl_pending = false;
             subscription->async_ioctl_failed = true;
             EBPF_RETURN_RESULT(result);
         } else {
@@ -4224,43 +4574,41 @@ _ebpf_ring_buffer_map_async_query_completion(_Inout_ void* completion_context) N
             subscription->sample_callback(subscription->sample_callback_context, nullptr, 0);
         }
     } else {
-        // Async IOCTL operation returned with success status. Read the ring buffer records and indicate it to the
-        // subscriber.
-
-        size_t ring_buffer_size = 0;
-        uint32_t dummy;
-
-        result = _get_map_descriptor_properties(
-            subscription->ring_buffer_map_handle,
-            &dummy,
-            &dummy,
-            &dummy,
-            reinterpret_cast<uint32_t*>(&ring_buffer_size));
-        if (result != EBPF_SUCCESS) {
-            EBPF_RETURN_RESULT(result);
+        {
+            std::scoped_lock lock{subscription->lock};
+            subscription->async_ioctl_pending = false;
+            if (subscription->poll_waiter_count != 0) {
+                // A caller is polling. It delivers the records and posts the next async IOCTL.
+                SetEvent(subscription->wakeup_event);
+                EBPF_RETURN_RESULT(EBPF_SUCCESS);
+            }
         }
 
-        ebpf_operation_ring_buffer_map_async_query_reply_t* reply = &subscription->reply;
-        ebpf_ring_buffer_map_async_query_result_t* async_query_result = &reply->async_query_result;
-        consumer = async_query_result->consumer;
-        producer = async_query_result->producer;
-        for (;;) {
-            auto record = ebpf_ring_buffer_next_record(subscription->buffer, ring_buffer_size, consumer, producer);
-
-            if (record == nullptr) {
-                // No more records.
-                break;
+        // Async IOCTL operation returned with success status. Read the ring buffer records and indicate them to the
+        // subscriber. Keep reading while records arrive within the spin window, so that a busy ring buffer is
+        // drained without an IOCTL per batch.
+        std::scoped_lock consume_lock{subscription->consume_lock};
+        while (!subscription->unsubscribed) {
+            uint32_t count = 0;
+            _ebpf_ring_buffer_subscription_consume(subscription, &count);
+
+            bool has_records = false;
+            for (uint32_t i = 0; i < subscription->spin_count; i++) {
+                if (_ebpf_ring_buffer_subscription_has_records(subscription)) {
+                    has_records = true;
+                    break;
+                }
+                YieldProcessor();
             }
-
-            int callback_result = subscription->sample_callback(
-                subscription->sample_callback_context,
-                const_cast<void*>(reinterpret_cast<const void*>(record->data)),
-                record->header.length - EBPF_OFFSET_OF(ebpf_ring_buffer_record_t, data));
-            if (callback_result != 0) {
+            if (!has_records) {
+                if (subscription->spin_count > EBPF_RING_BUFFER_SUBSCRIPTION_MINIMUM_SPIN_COUNT) {
+                    subscription->spin_count /= 2;
+                }
                 break;
             }
-
-            consumer += record->header.length;
+            if (subscription->spin_count < EBPF_RING_BUFFER_SUBSCRIPTION_MAXIMUM_SPIN_COUNT) {
+                subscription->spin_count *= 2;
+            }
         }
     }
 
@@ -4276,31 +4624,7 @@ _ebpf_ring_buffer_map_async_query_completion(_Inout_ void* completion_context) N
         } else {
             // If still subscribed, post the next async IOCTL call while holding the lock. It is safe to do so as the
             // async call is not blocking.
-
-            // First, register wait for the new async IOCTL operation completion.
-            result = register_wait_async_ioctl_operation(subscription->async_ioctl_completion);
-            if (result != EBPF_SUCCESS) {
-                EBPF_RETURN_RESULT(result);
-            }
-
-            // Then, post the async IOCTL.
-            ebpf_operation_ring_buffer_map_async_query_request_t async_query_request{
-                sizeof(async_query_request),
-                ebpf_operation_id_t::EBPF_OPERATION_RING_BUFFER_MAP_ASYNC_QUERY,
-                subscription->ring_buffer_map_handle,
-                consumer};
-            memset(&subscription->reply, 0, sizeof(ebpf_operation_ring_buffer_map_async_query_reply_t));
-            result = win32_error_code_to_ebpf_result(invoke_ioctl(
-                async_query_request,
-                subscription->reply,
-                get_async_ioctl_operation_overlapped(subscription->async_ioctl_completion)));
-            if (result != EBPF_SUCCESS) {
-                if (result == EBPF_PENDING) {
-                    result = EBPF_SUCCESS;
-                } else {
-                    subscription->async_ioctl_failed = true;
-                }
-            }
+            result = _ebpf_ring_buffer_subscription_post_async_query(subscription);
         }
     }
     if (free_subscription) {
@@ -4354,7 +4678,17 @@ ebpf_ring_buffer_map_subscribe(
             EBPF_RETURN_RESULT(result);
         }
 
-        // Get user-mode address to ring buffer shared data.
+        // The size of the ring buffer doesn't change, so look it up once.
+        uint32_t dummy;
+        uint32_t ring_buffer_size;
+        result = _get_map_descriptor_properties(
+            local_subscription->ring_buffer_map_handle, &dummy, &dummy, &dummy, &ring_buffer_size);
+        if (result != EBPF_SUCCESS) {
+            EBPF_RETURN_RESULT(result);
+        }
+        local_subscription->ring_buffer_size = ring_buffer_size;
+
+        // Get user-mode address to ring buffer shared data and offsets.
         ebpf_operation_ring_buffer_map_query_buffer_request_t query_buffer_request{
             sizeof(query_buffer_request),
             ebpf_operation_id_t::EBPF_OPERATION_RING_BUFFER_MAP_QUERY_BUFFER,
@@ -4367,11 +4701,24 @@ ebpf_ring_buffer_map_subscribe(
         ebpf_assert(query_buffer_reply.header.id == ebpf_operation_id_t::EBPF_OPERATION_RING_BUFFER_MAP_QUERY_BUFFER);
         local_subscription->buffer =
             reinterpret_cast<uint8_t*>(static_cast<uintptr_t>(query_buffer_reply.buffer_address));
+        local_subscription->producer_page = reinterpret_cast<const ebpf_ring_buffer_producer_page_t*>(
+            static_cast<uintptr_t>(query_buffer_reply.producer_page_address));
+        local_subscription->consumer_page = reinterpret_cast<ebpf_ring_buffer_consumer_page_t*>(
+            static_cast<uintptr_t>(query_buffer_reply.consumer_page_address));
+        local_subscription->consumer = query_buffer_reply.consumer_offset;
+        local_subscription->consumer_page->consumer_offset = query_buffer_reply.consumer_offset;
+
+        local_subscription->wakeup_event = CreateEvent(nullptr, false, false, nullptr);
+        if (local_subscription->wakeup_event == nullptr) {
+            result = win32_error_code_to_ebpf_result(GetLastError());
+            _Analysis_assume_(result != EBPF_SUCCESS);
+            EBPF_LOG_WIN32_API_FAILURE(EBPF_TRACELOG_KEYWORD_API, CreateEvent);
+            EBPF_RETURN_RESULT(result);
+        }
 
         // Initialize the async IOCTL operation.
         local_subscription->sample_callback_context = sample_callback_context;
         local_subscription->sample_callback = sample_callback;
-        memset(&local_subscription->reply, 0, sizeof(ebpf_operation_ring_buffer_map_async_query_reply_t));
         result = initialize_async_ioctl_operation(
             local_subscription.get(),
             _ebpf_ring_buffer_map_async_query_completion,
@@ -4381,21 +4728,9 @@ ebpf_ring_buffer_map_subscribe(
         }
 
         // Issue the async query IOCTL.
-        ebpf_operation_ring_buffer_map_async_query_request_t async_query_request{
-            sizeof(async_query_request),
-            ebpf_operation_id_t::EBPF_OPERATION_RING_BUFFER_MAP_ASYNC_QUERY,
-            local_subscription->ring_buffer_map_handle,
-            query_buffer_reply.consumer_offset};
-        result = win32_error_code_to_ebpf_result(invoke_ioctl(
-            async_query_request,
-            local_subscription->reply,
-            get_async_ioctl_operation_overlapped(local_subscription->async_ioctl_completion)));
-        if (result != EBPF_SUCCESS) {
-            if (result == EBPF_PENDING) {
-                result = EBPF_SUCCESS;
-            } else {
-                local_subscription->async_ioctl_failed = true;
-            }
+        {
+            std::scoped_lock lock{local_subscription->lock};
+            result = _ebpf_ring_buffer_subscription_post_async_query(local_subscription.get());
         }
 
         // If the async IOCTL failed, then free the subscription object.
@@ -4410,6 +4745,55 @@ ebpf_ring_buffer_map_subscribe(
 }
 CATCH_NO_MEMORY_EBPF_RESULT
 
+_Must_inspect_result_ ebpf_result_t
+ebpf_ring_buffer_map_poll(
+    _Inout_ ring_buffer_subscription_t* subscription, int32_t timeout_ms, _Out_ uint32_t* count) NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+    ebpf_assert(subscription);
+    ebpf_result_t result = EBPF_SUCCESS;
+    *count = 0;
+
+    {
+        // While a caller is polling, completions of the async IOCTL only wake the caller.
+        std::scoped_lock lock{subscription->lock};
+        subscription->poll_waiter_count++;
+    }
+
+    {
+        std::scoped_lock consume_lock{subscription->consume_lock};
+        _ebpf_ring_buffer_subscription_consume(subscription, count);
+    }
+
+    if (*count == 0 && timeout_ms != 0) {
+        // The ring buffer is empty, so wait for the async IOCTL to report new records.
+        uint32_t wait_result = WaitForSingleObject(
+            subscription->wakeup_event, timeout_ms < 0 ? INFINITE : static_cast<uint32_t>(timeout_ms));
+        if (wait_result == WAIT_OBJECT_0) {
+            std::scoped_lock consume_lock{subscription->consume_lock};
+            _ebpf_ring_buffer_subscription_consume(subscription, count);
+        } else if (wait_result != WAIT_TIMEOUT) {
+            result = win32_error_code_to_ebpf_result(GetLastError());
+            EBPF_LOG_WIN32_API_FAILURE(EBPF_TRACELOG_KEYWORD_API, WaitForSingleObject);
+        }
+    }
+
+    {
+        // Post the next async IOCTL if a completion was handed to this caller.
+        std::scoped_lock lock{subscription->lock};
+        subscription->poll_waiter_count--;
+        if (!subscription->unsubscribed && !subscription->async_ioctl_pending && !subscription->async_ioctl_failed) {
+            ebpf_result_t post_result = _ebpf_ring_buffer_subscription_post_async_query(subscription);
+            if (result == EBPF_SUCCESS) {
+                result = post_result;
+            }
+        }
+    }
+
+    EBPF_RETURN_RESULT(result);
+}
+CATCH_NO_MEMORY_EBPF_RESULT
+
 bool
 ebpf_ring_buffer_map_unsubscribe(_In_ _Post_invalid_ ring_buffer_subscription_t* subscription) NO_EXCEPT_TRY
 {
@@ -4453,24 +4837,370 @@ ebpf_ring_buffer_map_unsubscribe(_In_ _Post_invalid_ ring_buffer_subscription_t*
 }
 CATCH_NO_MEMORY_BOOL
 
-_Must_inspect_result_ ebpf_result_t
-ebpf_program_test_run(fd_t program_fd, _Inout_ ebpf_test_run_options_t* options) NO_EXCEPT_TRY
-{
-    EBPF_LOG_ENTRY();
-
-    ebpf_result_t result;
-
-    size_t input_buffer_size = EBPF_OFFSET_OF(ebpf_operation_program_test_run_request_t, data);
-    size_t output_buffer_size = EBPF_OFFSET_OF(ebpf_operation_program_test_run_reply_t, data);
-    ebpf_signal_t completion_event;
-    OVERLAPPED overlapped;
-    memset(&overlapped, 0, sizeof(overlapped));
-    overlapped.hEvent = completion_event.get();
+typedef struct _ebpf_perf_buffer_subscription ebpf_perf_buffer_subscription_t;
 
-    if ((options->context_size_in + options->data_size_in) >
-        MAXUINT16 - EBPF_OFFSET_OF(ebpf_operation_program_test_run_request_t, data)) {
-        return EBPF_INVALID_ARGUMENT;
-    }
+typedef struct _ebpf_perf_buffer_cpu
+{
+    _ebpf_perf_buffer_cpu()
+        : subscription(nullptr), cpu_id(0), buffer(nullptr), consumer(0), lost_count(0), reply({}),
+          async_ioctl_completion(nullptr), async_ioctl_pending(false), ready(false), async_ioctl_result(EBPF_SUCCESS)
+    {}
+    ~_ebpf_perf_buffer_cpu()
+    {
+        if (async_ioctl_completion != nullptr) {
+            clean_up_async_ioctl_completion(async_ioctl_completion);
+        }
+    }
+    ebpf_perf_buffer_subscription_t* subscription;
+    uint32_t cpu_id;
+    uint8_t* buffer;
+    size_t consumer;
+    uint64_t lost_count;
+    ebpf_operation_perf_event_array_map_async_query_reply_t reply;
+    async_ioctl_completion_t* async_ioctl_completion;
+    bool async_ioctl_pending;
+    bool ready;
+    ebpf_result_t async_ioctl_result;
+} ebpf_perf_buffer_cpu_t;
+
+typedef struct _ebpf_perf_buffer_subscription
+{
+    _ebpf_perf_buffer_subscription()
+        : unsubscribed(false), perf_event_array_map_handle(ebpf_handle_invalid), buffer_size(0),
+          callback_context(nullptr), sample_callback(nullptr), lost_callback(nullptr), wakeup_event(nullptr),
+          pending_async_ioctl_count(0)
+    {}
+    ~_ebpf_perf_buffer_subscription()
+    {
+        EBPF_LOG_ENTRY();
+        cpus.clear();
+        if (wakeup_event != nullptr) {
+            ::CloseHandle(wakeup_event);
+        }
+        if (perf_event_array_map_handle != ebpf_handle_invalid) {
+            Platform::CloseHandle(perf_event_array_map_handle);
+        }
+    }
+    std::mutex lock;
+    std::condition_variable async_ioctl_completed;
+    _Write_guarded_by_(lock) bool unsubscribed;
+    ebpf_handle_t perf_event_array_map_handle;
+    size_t buffer_size;
+    void* callback_context;
+    perf_buffer_sample_fn sample_callback;
+    perf_buffer_lost_fn lost_callback;
+    // Auto-reset event that is signaled when an async query completes on any CPU.
+    HANDLE wakeup_event;
+    _Write_guarded_by_(lock) uint32_t pending_async_ioctl_count;
+    std::vector<std::unique_ptr<ebpf_perf_buffer_cpu_t>> cpus;
+} ebpf_perf_buffer_subscription_t;
+
+typedef std::unique_ptr<ebpf_perf_buffer_subscription_t> ebpf_perf_buffer_subscription_ptr;
+
+static ebpf_result_t
+_ebpf_perf_event_array_map_async_query_completion(_Inout_ void* completion_context) NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+    ebpf_assert(completion_context);
+
+    // Records are consumed by the thread that polls the subscription. Only mark the CPU as ready and wake the poller.
+    ebpf_perf_buffer_cpu_t* cpu = reinterpret_cast<ebpf_perf_buffer_cpu_t*>(completion_context);
+    ebpf_perf_buffer_subscription_t* subscription = cpu->subscription;
+    ebpf_result_t result = get_async_ioctl_result(cpu->async_ioctl_completion);
+
+    std::scoped_lock lock{subscription->lock};
+    cpu->async_ioctl_result = result;
+    cpu->async_ioctl_pending = false;
+    cpu->ready = true;
+    subscription->pending_async_ioctl_count--;
+    SetEvent(subscription->wakeup_event);
+    subscription->async_ioctl_completed.notify_all();
+
+    EBPF_RETURN_RESULT(result);
+}
+CATCH_NO_MEMORY_EBPF_RESULT
+
+static _Requires_lock_held_(cpu->subscription->lock) ebpf_result_t
+    _ebpf_perf_event_array_map_post_async_query(_Inout_ ebpf_perf_buffer_cpu_t* cpu)
+{
+    ebpf_perf_buffer_subscription_t* subscription = cpu->subscription;
+
+    ebpf_result_t result = register_wait_async_ioctl_operation(cpu->async_ioctl_completion);
+    if (result != EBPF_SUCCESS) {
+        return result;
+    }
+
+    ebpf_operation_perf_event_array_map_async_query_request_t async_query_request{
+        sizeof(async_query_request),
+        ebpf_operation_id_t::EBPF_OPERATION_PERF_EVENT_ARRAY_MAP_ASYNC_QUERY,
+        subscription->perf_event_array_map_handle,
+        cpu->cpu_id,
+        cpu->consumer};
+    memset(&cpu->reply, 0, sizeof(cpu->reply));
+    cpu->async_ioctl_pending = true;
+    subscription->pending_async_ioctl_count++;
+    result = win32_error_code_to_ebpf_result(invoke_ioctl(
+        async_query_request, cpu->reply, get_async_ioctl_operation_overlapped(cpu->async_ioctl_completion)));
+    if (result == EBPF_PENDING || result == EBPF_SUCCESS) {
+        // The completion callback runs in either case.
+        result = EBPF_SUCCESS;
+    } else {
+        cpu->async_ioctl_pending = false;
+        subscription->pending_async_ioctl_count--;
+    }
+    return result;
+}
+
+/**
+ * @brief Deliver the records of every CPU whose async query has completed and
+ * post the next async query for those CPUs.
+ */
+static ebpf_result_t
+_ebpf_perf_event_array_map_consume(_Inout_ ebpf_perf_buffer_subscription_t* subscription, _Out_ uint32_t* count)
+{
+    ebpf_result_t result = EBPF_SUCCESS;
+    *count = 0;
+
+    for (auto& cpu : subscription->cpus) {
+        ebpf_result_t async_ioctl_result;
+        {
+            std::scoped_lock lock{subscription->lock};
+            if (!cpu->ready) {
+                continue;
+            }
+            cpu->ready = false;
+            async_ioctl_result = cpu->async_ioctl_result;
+        }
+        if (async_ioctl_result != EBPF_SUCCESS) {
+            // Don't re-post a query that failed, but keep draining the remaining CPUs.
+            result = async_ioctl_result;
+            continue;
+        }
+
+        ebpf_perf_event_array_map_async_query_result_t* async_query_result = &cpu->reply.async_query_result;
+        size_t consumer = async_query_result->ring_buffer.consumer;
+        size_t producer = async_query_result->ring_buffer.producer;
+        for (;;) {
+            auto record = ebpf_ring_buffer_next_record(cpu->buffer, subscription->buffer_size, consumer, producer);
+            if (record == nullptr) {
+                break;
+            }
+            if (ebpf_ring_buffer_record_is_locked(record)) {
+                // The producer is still writing this record. It will be delivered on a later poll.
+                break;
+            }
+            if (!record->header.discarded) {
+                subscription->sample_callback(
+                    subscription->callback_context,
+                    static_cast<int>(cpu->cpu_id),
+                    const_cast<void*>(reinterpret_cast<const void*>(record->data)),
+                    static_cast<uint32_t>(record->header.length - EBPF_OFFSET_OF(ebpf_ring_buffer_record_t, data)));
+                (*count)++;
+            }
+            consumer += record->header.length;
+        }
+        cpu->consumer = consumer;
+
+        if (async_query_result->lost_count > cpu->lost_count) {
+            if (subscription->lost_callback) {
+                subscription->lost_callback(
+                    subscription->callback_context,
+                    static_cast<int>(cpu->cpu_id),
+                    async_query_result->lost_count - cpu->lost_count);
+            }
+            cpu->lost_count = async_query_result->lost_count;
+        }
+
+        std::scoped_lock lock{subscription->lock};
+        if (!subscription->unsubscribed) {
+            ebpf_result_t post_result = _ebpf_perf_event_array_map_post_async_query(cpu.get());
+            if (post_result != EBPF_SUCCESS) {
+                result = post_result;
+            }
+        }
+    }
+
+    return result;
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_perf_event_array_map_subscribe(
+    fd_t perf_event_array_map_fd,
+    _Inout_opt_ void* callback_context,
+    perf_buffer_sample_fn sample_callback,
+    _In_opt_ perf_buffer_lost_fn lost_callback,
+    _Outptr_ perf_buffer_subscription_t** subscription) NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+    ebpf_assert(sample_callback);
+    ebpf_assert(subscription);
+
+    *subscription = nullptr;
+
+    ebpf_perf_buffer_subscription_ptr local_subscription = std::make_unique<ebpf_perf_buffer_subscription_t>();
+
+    ebpf_handle_t perf_event_array_map_handle = _get_handle_from_file_descriptor(perf_event_array_map_fd);
+    if (perf_event_array_map_handle == ebpf_handle_invalid) {
+        EBPF_RETURN_RESULT(EBPF_INVALID_FD);
+    }
+
+    if (!Platform::DuplicateHandle(
+            reinterpret_cast<ebpf_handle_t>(GetCurrentProcess()),
+            perf_event_array_map_handle,
+            reinterpret_cast<ebpf_handle_t>(GetCurrentProcess()),
+            &local_subscription->perf_event_array_map_handle,
+            0,
+            FALSE,
+            DUPLICATE_SAME_ACCESS)) {
+        ebpf_result_t result = win32_error_code_to_ebpf_result(GetLastError());
+        _Analysis_assume_(result != EBPF_SUCCESS);
+        EBPF_LOG_WIN32_API_FAILURE(EBPF_TRACELOG_KEYWORD_API, DuplicateHandle);
+        EBPF_RETURN_RESULT(result);
+    }
+
+    uint32_t type;
+    uint32_t dummy;
+    uint32_t buffer_size;
+    ebpf_result_t result = _get_map_descriptor_properties(
+        local_subscription->perf_event_array_map_handle, &type, &dummy, &dummy, &buffer_size);
+    if (result != EBPF_SUCCESS) {
+        EBPF_RETURN_RESULT(result);
+    }
+    if (type != BPF_MAP_TYPE_PERF_EVENT_ARRAY) {
+        EBPF_RETURN_RESULT(EBPF_INVALID_ARGUMENT);
+    }
+    local_subscription->buffer_size = buffer_size;
+    local_subscription->callback_context = callback_context;
+    local_subscription->sample_callback = sample_callback;
+    local_subscription->lost_callback = lost_callback;
+
+    local_subscription->wakeup_event = CreateEvent(nullptr, false, false, nullptr);
+    if (local_subscription->wakeup_event == nullptr) {
+        result = win32_error_code_to_ebpf_result(GetLastError());
+        _Analysis_assume_(result != EBPF_SUCCESS);
+        EBPF_LOG_WIN32_API_FAILURE(EBPF_TRACELOG_KEYWORD_API, CreateEvent);
+        EBPF_RETURN_RESULT(result);
+    }
+
+    // Allocate the state of every CPU before posting any async query, so that nothing below can throw.
+    uint32_t cpu_count = static_cast<uint32_t>(libbpf_num_possible_cpus());
+    for (uint32_t cpu_id = 0; cpu_id < cpu_count; cpu_id++) {
+        local_subscription->cpus.emplace_back(std::make_unique<ebpf_perf_buffer_cpu_t>());
+        local_subscription->cpus.back()->subscription = local_subscription.get();
+        local_subscription->cpus.back()->cpu_id = cpu_id;
+    }
+
+    // Map the buffer of each CPU and start an async query on it.
+    for (auto& cpu_state : local_subscription->cpus) {
+        ebpf_perf_buffer_cpu_t* cpu = cpu_state.get();
+        ebpf_operation_perf_event_array_map_query_buffer_request_t query_buffer_request{
+            sizeof(query_buffer_request),
+            ebpf_operation_id_t::EBPF_OPERATION_PERF_EVENT_ARRAY_MAP_QUERY_BUFFER,
+            local_subscription->perf_event_array_map_handle,
+            cpu->cpu_id};
+        ebpf_operation_perf_event_array_map_query_buffer_reply_t query_buffer_reply{};
+        result = win32_error_code_to_ebpf_result(invoke_ioctl(query_buffer_request, query_buffer_reply));
+        if (result != EBPF_SUCCESS) {
+            break;
+        }
+        cpu->buffer = reinterpret_cast<uint8_t*>(static_cast<uintptr_t>(query_buffer_reply.buffer_address));
+        cpu->consumer = query_buffer_reply.consumer_offset;
+
+        result = initialize_async_ioctl_operation(
+            cpu, _ebpf_perf_event_array_map_async_query_completion, &cpu->async_ioctl_completion);
+        if (result != EBPF_SUCCESS) {
+            break;
+        }
+
+        std::scoped_lock lock{local_subscription->lock};
+        result = _ebpf_perf_event_array_map_post_async_query(cpu);
+        if (result != EBPF_SUCCESS) {
+            break;
+        }
+    }
+
+    if (result == EBPF_SUCCESS) {
+        *subscription = local_subscription.release();
+    } else {
+        ebpf_perf_event_array_map_unsubscribe(local_subscription.release());
+    }
+
+    EBPF_RETURN_RESULT(result);
+}
+CATCH_NO_MEMORY_EBPF_RESULT
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_perf_event_array_map_poll(
+    _Inout_ perf_buffer_subscription_t* subscription, int32_t timeout_ms, _Out_ uint32_t* count) NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+    ebpf_assert(subscription);
+
+    ebpf_result_t result = _ebpf_perf_event_array_map_consume(subscription, count);
+    if (result != EBPF_SUCCESS || *count != 0 || timeout_ms == 0) {
+        EBPF_RETURN_RESULT(result);
+    }
+
+    // Nothing was ready, so wait for any CPU to complete its async query.
+    uint32_t wait_result =
+        WaitForSingleObject(subscription->wakeup_event, timeout_ms < 0 ? INFINITE : static_cast<uint32_t>(timeout_ms));
+    if (wait_result == WAIT_TIMEOUT) {
+        EBPF_RETURN_RESULT(EBPF_SUCCESS);
+    }
+    if (wait_result != WAIT_OBJECT_0) {
+        result = win32_error_code_to_ebpf_result(GetLastError());
+        EBPF_LOG_WIN32_API_FAILURE(EBPF_TRACELOG_KEYWORD_API, WaitForSingleObject);
+        EBPF_RETURN_RESULT(result);
+    }
+
+    result = _ebpf_perf_event_array_map_consume(subscription, count);
+    EBPF_RETURN_RESULT(result);
+}
+CATCH_NO_MEMORY_EBPF_RESULT
+
+void
+ebpf_perf_event_array_map_unsubscribe(_In_opt_ _Post_invalid_ perf_buffer_subscription_t* subscription) noexcept
+{
+    EBPF_LOG_ENTRY();
+    if (subscription == nullptr) {
+        EBPF_RETURN_VOID();
+    }
+
+    {
+        // Stop re-posting async queries, cancel the outstanding ones, and wait for their completion callbacks, as the
+        // callbacks reference the subscription.
+        std::unique_lock lock{subscription->lock};
+        subscription->unsubscribed = true;
+        for (auto& cpu : subscription->cpus) {
+            if (cpu->async_ioctl_pending) {
+                (void)cancel_async_ioctl(get_async_ioctl_operation_overlapped(cpu->async_ioctl_completion));
+            }
+        }
+        subscription->async_ioctl_completed.wait(lock, [&] { return subscription->pending_async_ioctl_count == 0; });
+    }
+
+    delete subscription;
+    EBPF_RETURN_VOID();
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_program_test_run(fd_t program_fd, _Inout_ ebpf_test_run_options_t* options) NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+
+    ebpf_result_t result;
+
+    size_t input_buffer_size = EBPF_OFFSET_OF(ebpf_operation_program_test_run_request_t, data);
+    size_t output_buffer_size = EBPF_OFFSET_OF(ebpf_operation_program_test_run_reply_t, data);
+    ebpf_signal_t completion_event;
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(overlapped));
+    overlapped.hEvent = completion_event.get();
+
+    if ((options->context_size_in + options->data_size_in) >
+        MAXUINT16 - EBPF_OFFSET_OF(ebpf_operation_program_test_run_request_t, data)) {
+        return EBPF_INVALID_ARGUMENT;
+    }
 
     if ((options->context_size_out + options->data_size_out) >
         MAXUINT16 - EBPF_OFFSET_OF(ebpf_operation_program_test_run_reply_t, data)) {
@@ -4564,6 +5294,332 @@ ebpf_program_test_run(fd_t program_fd, _Inout_ ebpf_test_run_options_t* options)
 }
 CATCH_NO_MEMORY_EBPF_RESULT
 
+_Must_inspect_result_ ebpf_result_t
+ebpf_program_set_statistics(bool enabled) NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+    ebpf_operation_set_program_statistics_request_t request = {
+        sizeof(request), ebpf_operation_id_t::EBPF_OPERATION_SET_PROGRAM_STATISTICS, enabled ? 1u : 0u};
+
+    EBPF_RETURN_RESULT(win32_error_code_to_ebpf_result(invoke_ioctl(request)));
+}
+CATCH_NO_MEMORY_EBPF_RESULT
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_map_mmap(fd_t map_fd, _Outptr_ void** address) NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+    ebpf_assert(address);
+    *address = nullptr;
+
+    ebpf_handle_t map_handle = _get_handle_from_file_descriptor(map_fd);
+    if (map_handle == ebpf_handle_invalid) {
+        EBPF_RETURN_RESULT(EBPF_INVALID_FD);
+    }
+
+    ebpf_operation_map_mmap_request_t request{
+        sizeof(request), ebpf_operation_id_t::EBPF_OPERATION_MAP_MMAP, map_handle};
+    ebpf_operation_map_mmap_reply_t reply{};
+    ebpf_result_t result = win32_error_code_to_ebpf_result(invoke_ioctl(request, reply));
+    if (result != EBPF_SUCCESS) {
+        EBPF_RETURN_RESULT(result);
+    }
+    ebpf_assert(reply.header.id == ebpf_operation_id_t::EBPF_OPERATION_MAP_MMAP);
+    *address = reinterpret_cast<void*>(static_cast<uintptr_t>(reply.address));
+
+    EBPF_RETURN_RESULT(EBPF_SUCCESS);
+}
+CATCH_NO_MEMORY_EBPF_RESULT
+
+typedef struct _ebpf_map_ring
+{
+    _ebpf_map_ring()
+        : header(nullptr), submissions(nullptr), completions(nullptr), data(nullptr), data_size(0), data_used(0),
+          map_handle(ebpf_handle_invalid), map_type(BPF_MAP_TYPE_UNSPEC), key_size(0), value_size(0)
+    {}
+    std::mutex lock;
+    // Memory shared with the execution context, laid out as described by ebpf_map_ring_header_t.
+    std::vector<uint64_t> memory;
+    ebpf_map_ring_header_t* header;
+    ebpf_map_ring_submission_t* submissions;
+    ebpf_map_ring_completion_t* completions;
+    uint8_t* data;
+    size_t data_size;
+    // Bytes of the data area used by queued operations. Reset once every queued operation has been processed.
+    _Guarded_by_(lock) size_t data_used;
+    // Caller's buffer for the value of each queued lookup, indexed by submission slot.
+    _Guarded_by_(lock) std::vector<void*> lookup_values;
+    // Properties of the last map an operation was queued for. Cleared on submit, as the handle may be closed and
+    // reused once its operations complete.
+    _Guarded_by_(lock) ebpf_handle_t map_handle;
+    _Guarded_by_(lock) uint32_t map_type;
+    _Guarded_by_(lock) uint32_t key_size;
+    _Guarded_by_(lock) uint32_t value_size;
+} ebpf_map_ring_t;
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_map_ring_create(uint32_t entry_count, uint32_t data_size, _Outptr_ ebpf_map_ring_t** ring) NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+    ebpf_assert(ring);
+    *ring = nullptr;
+
+    if (entry_count == 0 || (entry_count & (entry_count - 1)) != 0 || data_size == 0) {
+        EBPF_RETURN_RESULT(EBPF_INVALID_ARGUMENT);
+    }
+
+    // The execution context accesses the ring through a single buffer descriptor, which is limited to 4 GB.
+    uint64_t length = sizeof(ebpf_map_ring_header_t) +
+                      static_cast<uint64_t>(entry_count) *
+                          (sizeof(ebpf_map_ring_submission_t) + sizeof(ebpf_map_ring_completion_t)) +
+                      EBPF_PAD_8(static_cast<uint64_t>(data_size));
+    if (length > UINT32_MAX) {
+        EBPF_RETURN_RESULT(EBPF_INVALID_ARGUMENT);
+    }
+
+    std::unique_ptr<ebpf_map_ring_t> new_ring(new (std::nothrow) ebpf_map_ring_t());
+    if (new_ring == nullptr) {
+        EBPF_RETURN_RESULT(EBPF_NO_MEMORY);
+    }
+
+    new_ring->memory.resize(static_cast<size_t>(length) / sizeof(uint64_t));
+    new_ring->lookup_values.resize(entry_count);
+    new_ring->header = reinterpret_cast<ebpf_map_ring_header_t*>(new_ring->memory.data());
+    new_ring->header->entry_count = entry_count;
+    new_ring->submissions = reinterpret_cast<ebpf_map_ring_submission_t*>(new_ring->header + 1);
+    new_ring->completions = reinterpret_cast<ebpf_map_ring_completion_t*>(new_ring->submissions + entry_count);
+    new_ring->data = reinterpret_cast<uint8_t*>(new_ring->completions + entry_count);
+    new_ring->data_size = EBPF_PAD_8(static_cast<size_t>(data_size));
+
+    *ring = new_ring.release();
+    EBPF_RETURN_RESULT(EBPF_SUCCESS);
+}
+CATCH_NO_MEMORY_EBPF_RESULT
+
+void
+ebpf_map_ring_destroy(_In_opt_ _Post_invalid_ ebpf_map_ring_t* ring) noexcept
+{
+    EBPF_LOG_ENTRY();
+    delete ring;
+    EBPF_LOG_EXIT();
+}
+
+static ebpf_result_t
+_ebpf_map_ring_queue(
+    _Inout_ ebpf_map_ring_t* ring,
+    fd_t map_fd,
+    ebpf_map_ring_operation_t operation,
+    _In_opt_ const void* key,
+    _In_opt_ const void* value,
+    _Out_opt_ void* lookup_value,
+    uint64_t flags,
+    uint64_t user_data)
+{
+    ebpf_result_t result;
+
+    if (map_fd <= 0) {
+        return EBPF_INVALID_ARGUMENT;
+    }
+
+    ebpf_handle_t map_handle = _get_handle_from_file_descriptor(map_fd);
+    if (map_handle == ebpf_handle_invalid) {
+        return EBPF_INVALID_FD;
+    }
+
+    std::unique_lock lock(ring->lock);
+
+    // Get map properties, either from the ring, the local cache or the execution context.
+    if (map_handle != ring->map_handle) {
+        uint32_t max_entries;
+        result = _get_map_descriptor_properties(
+            map_handle, &ring->map_type, &ring->key_size, &ring->value_size, &max_entries);
+        if (result != EBPF_SUCCESS) {
+            ring->map_handle = ebpf_handle_invalid;
+            return result;
+        }
+        ring->map_handle = map_handle;
+    }
+
+    // Bloom filter lookups and updates of maps that hold file descriptors need translation that is only done by the
+    // synchronous APIs.
+    uint32_t type = ring->map_type;
+    if (type == BPF_MAP_TYPE_BLOOM_FILTER) {
+        return EBPF_OPERATION_NOT_SUPPORTED;
+    }
+    if (operation == EBPF_MAP_RING_OPERATION_UPDATE &&
+        (type == BPF_MAP_TYPE_PROG_ARRAY || type == BPF_MAP_TYPE_HASH_OF_MAPS || type == BPF_MAP_TYPE_ARRAY_OF_MAPS)) {
+        return EBPF_OPERATION_NOT_SUPPORTED;
+    }
+
+    size_t key_size = ring->key_size;
+    size_t value_size = (operation == EBPF_MAP_RING_OPERATION_DELETE) ? 0 : ring->value_size;
+    if ((key == nullptr) != (key_size == 0) || key_size + value_size == 0) {
+        return EBPF_INVALID_ARGUMENT;
+    }
+    if (BPF_MAP_TYPE_PER_CPU(type)) {
+        value_size = EBPF_PAD_8(value_size) * libbpf_num_possible_cpus();
+    }
+
+    size_t key_offset = ring->data_used;
+    size_t value_offset = key_offset + EBPF_PAD_8(key_size);
+    size_t data_used = value_offset + EBPF_PAD_8(value_size);
+    ebpf_map_ring_header_t* header = ring->header;
+    if (header->submission_tail - header->submission_head == header->entry_count || data_used > ring->data_size) {
+        return EBPF_INSUFFICIENT_BUFFER;
+    }
+
+    uint32_t slot = header->submission_tail & (header->entry_count - 1);
+    ebpf_map_ring_submission_t* submission = &ring->submissions[slot];
+    submission->user_data = user_data;
+    submission->map_handle = map_handle;
+    submission->operation = operation;
+    submission->option = static_cast<uint32_t>(flags);
+    submission->key_offset = static_cast<uint32_t>(key_offset);
+    submission->value_offset = static_cast<uint32_t>(value_offset);
+    submission->value_length = static_cast<uint32_t>(value_size);
+    submission->reserved = 0;
+
+    if (key_size > 0) {
+        memcpy(ring->data + key_offset, key, key_size);
+    }
+    if (operation == EBPF_MAP_RING_OPERATION_UPDATE) {
+        memcpy(ring->data + value_offset, value, value_size);
+    }
+    ring->lookup_values[slot] = lookup_value;
+    ring->data_used = data_used;
+    header->submission_tail++;
+
+    return EBPF_SUCCESS;
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_map_ring_queue_lookup(
+    _Inout_ ebpf_map_ring_t* ring, fd_t map_fd, _In_opt_ const void* key, _Out_ void* value, uint64_t user_data)
+    NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+    ebpf_assert(ring);
+    ebpf_assert(value);
+    EBPF_RETURN_RESULT(
+        _ebpf_map_ring_queue(ring, map_fd, EBPF_MAP_RING_OPERATION_LOOKUP, key, nullptr, value, 0, user_data));
+}
+CATCH_NO_MEMORY_EBPF_RESULT
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_map_ring_queue_update(
+    _Inout_ ebpf_map_ring_t* ring,
+    fd_t map_fd,
+    _In_opt_ const void* key,
+    _In_ const void* value,
+    uint64_t flags,
+    uint64_t user_data) NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+    ebpf_assert(ring);
+    ebpf_assert(value);
+
+    switch (flags & ~BPF_F_LOCK) {
+    case EBPF_ANY:
+    case EBPF_NOEXIST:
+    case EBPF_EXIST:
+        break;
+    default:
+        EBPF_RETURN_RESULT(EBPF_INVALID_ARGUMENT);
+    }
+
+    EBPF_RETURN_RESULT(
+        _ebpf_map_ring_queue(ring, map_fd, EBPF_MAP_RING_OPERATION_UPDATE, key, value, nullptr, flags, user_data));
+}
+CATCH_NO_MEMORY_EBPF_RESULT
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_map_ring_queue_delete(_Inout_ ebpf_map_ring_t* ring, fd_t map_fd, _In_ const void* key, uint64_t user_data)
+    NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+    ebpf_assert(ring);
+    ebpf_assert(key);
+    EBPF_RETURN_RESULT(
+        _ebpf_map_ring_queue(ring, map_fd, EBPF_MAP_RING_OPERATION_DELETE, key, nullptr, nullptr, 0, user_data));
+}
+CATCH_NO_MEMORY_EBPF_RESULT
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_map_ring_submit(_Inout_ ebpf_map_ring_t* ring, _Out_opt_ uint32_t* count) NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+    ebpf_assert(ring);
+    if (count != nullptr) {
+        *count = 0;
+    }
+
+    std::unique_lock lock(ring->lock);
+    ebpf_map_ring_header_t* header = ring->header;
+    uint32_t mask = header->entry_count - 1;
+    uint32_t submission_head = header->submission_head;
+    uint32_t completion_tail = header->completion_tail;
+
+    ring->map_handle = ebpf_handle_invalid;
+    if (submission_head == header->submission_tail) {
+        EBPF_RETURN_RESULT(EBPF_SUCCESS);
+    }
+
+    ebpf_operation_map_ring_submit_request_t request{
+        sizeof(request),
+        ebpf_operation_id_t::EBPF_OPERATION_MAP_RING_SUBMIT,
+        {reinterpret_cast<uint64_t>(ring->memory.data()), ring->memory.size() * sizeof(uint64_t)}};
+    ebpf_operation_map_ring_submit_reply_t reply{};
+    ebpf_result_t result = win32_error_code_to_ebpf_result(invoke_ioctl(request, reply));
+    if (result != EBPF_SUCCESS) {
+        EBPF_RETURN_RESULT(result);
+    }
+
+    // Operations complete in submission order, so copy out the values of the lookups that were just processed.
+    for (; submission_head != header->submission_head; submission_head++, completion_tail++) {
+        void* lookup_value = ring->lookup_values[submission_head & mask];
+        const ebpf_map_ring_submission_t* submission = &ring->submissions[submission_head & mask];
+        if (lookup_value != nullptr && ring->completions[completion_tail & mask].result == EBPF_SUCCESS) {
+            memcpy(lookup_value, ring->data + submission->value_offset, submission->value_length);
+        }
+        ring->lookup_values[submission_head & mask] = nullptr;
+    }
+
+    if (header->submission_head == header->submission_tail) {
+        ring->data_used = 0;
+    }
+
+    if (count != nullptr) {
+        *count = reply.count_of_entries_processed;
+    }
+    EBPF_RETURN_RESULT(EBPF_SUCCESS);
+}
+CATCH_NO_MEMORY_EBPF_RESULT
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_map_ring_get_completion(_Inout_ ebpf_map_ring_t* ring, _Out_ uint64_t* user_data, _Out_ ebpf_result_t* result)
+    NO_EXCEPT_TRY
+{
+    EBPF_LOG_ENTRY();
+    ebpf_assert(ring);
+    ebpf_assert(user_data);
+    ebpf_assert(result);
+
+    std::unique_lock lock(ring->lock);
+    ebpf_map_ring_header_t* header = ring->header;
+    if (header->completion_head == header->completion_tail) {
+        EBPF_RETURN_RESULT(EBPF_NO_MORE_KEYS);
+    }
+
+    const ebpf_map_ring_completion_t* completion =
+        &ring->completions[header->completion_head & (header->entry_count - 1)];
+    *user_data = completion->user_data;
+    *result = static_cast<ebpf_result_t>(completion->result);
+    header->completion_head++;
+
+    EBPF_RETURN_RESULT(EBPF_SUCCESS);
+}
+CATCH_NO_MEMORY_EBPF_RESULT
+
 void
 ebpf_api_thread_local_cleanup() noexcept
 {
@@ -218,6 +218,21 @@ bpf_map__max_entries(const struct bpf_map* map)
     return map->map_definition.max_entries;
 }
 
+void*
+bpf_map__mmap(struct bpf_map* map)
+{
+    if (map == nullptr) {
+        return libbpf_err_ptr(-EINVAL);
+    }
+    if (map->mmaped == nullptr) {
+        ebpf_result_t result = ebpf_map_mmap(map->map_fd, &map->mmaped);
+        if (result != EBPF_SUCCESS) {
+            return libbpf_err_ptr(-ebpf_result_to_errno(result));
+        }
+    }
+    return map->mmaped;
+}
+
 bool
 bpf_map__is_pinned(const struct bpf_map* map)
 {
@@ -393,6 +408,102 @@ ring_buffer__free(struct ring_buffer* ring_buffer)
     delete ring_buffer;
 }
 
+static int
+_ring_buffer_poll(struct ring_buffer* rb, int timeout_ms)
+{
+    int total_count = 0;
+    for (auto subscription : rb->subscriptions) {
+        uint32_t count;
+        ebpf_result_t result = ebpf_ring_buffer_map_poll(subscription, timeout_ms, &count);
+        if (result != EBPF_SUCCESS) {
+            return libbpf_result_err(result);
+        }
+        total_count += (int)count;
+    }
+    return total_count;
+}
+
+int
+ring_buffer__poll(struct ring_buffer* rb, int timeout_ms)
+{
+    return _ring_buffer_poll(rb, timeout_ms);
+}
+
+int
+ring_buffer__consume(struct ring_buffer* rb)
+{
+    return _ring_buffer_poll(rb, 0);
+}
+
+typedef struct perf_buffer
+{
+    perf_buffer_subscription_t* subscription;
+} perf_buffer_t;
+
+struct perf_buffer*
+perf_buffer__new(
+    int map_fd,
+    size_t /* page_cnt */,
+    perf_buffer_sample_fn sample_cb,
+    perf_buffer_lost_fn lost_cb,
+    void* ctx,
+    const struct perf_buffer_opts* /* opts */)
+{
+    ebpf_result result = EBPF_SUCCESS;
+    perf_buffer_t* local_perf_buffer = nullptr;
+
+    // The size of each per-CPU buffer is set by max_entries when the map is created, so page_cnt is ignored.
+    try {
+        std::unique_ptr<perf_buffer_t> perf_buffer = std::make_unique<perf_buffer_t>();
+        result = ebpf_perf_event_array_map_subscribe(map_fd, ctx, sample_cb, lost_cb, &perf_buffer->subscription);
+        if (result != EBPF_SUCCESS) {
+            goto Exit;
+        }
+        local_perf_buffer = perf_buffer.release();
+    } catch (const std::bad_alloc&) {
+        result = EBPF_NO_MEMORY;
+        goto Exit;
+    }
+Exit:
+    if (result != EBPF_SUCCESS) {
+        EBPF_LOG_FUNCTION_ERROR(result);
+        libbpf_err_ptr(-ebpf_result_to_errno(result));
+    }
+    EBPF_RETURN_POINTER(perf_buffer_t*, local_perf_buffer);
+}
+
+void
+perf_buffer__free(struct perf_buffer* pb)
+{
+    if (pb == nullptr) {
+        return;
+    }
+    ebpf_perf_event_array_map_unsubscribe(pb->subscription);
+    delete pb;
+}
+
+int
+perf_buffer__poll(struct perf_buffer* pb, int timeout_ms)
+{
+    uint32_t count;
+    ebpf_result_t result = ebpf_perf_event_array_map_poll(pb->subscription, timeout_ms, &count);
+    if (result != EBPF_SUCCESS) {
+        return libbpf_result_err(result);
+    }
+    return (int)count;
+}
+
+int
+perf_buffer__consume(struct perf_buffer* pb)
+{
+    uint32_t count;
+    ebpf_result_t result = ebpf_perf_event_array_map_poll(pb->subscription, 0, &count);
+    if (result != EBPF_SUCCESS) {
+        return libbpf_result_err(result);
+    }
+    return (int)count;
+}
+
 const char*
 libbpf_bpf_map_type_str(enum bpf_map_type t)
 {
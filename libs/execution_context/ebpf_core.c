@@ -63,12 +63,19 @@ _ebpf_core_trace_printk5(
 static int
 _ebpf_core_ring_buffer_output(
     _Inout_ ebpf_map_t* map, _In_reads_bytes_(length) uint8_t* data, size_t length, uint64_t flags);
+static int
+_ebpf_core_perf_event_output(
+    _In_ const void* ctx,
+    _Inout_ ebpf_map_t* map,
+    uint64_t flags,
+    _In_reads_bytes_(length) uint8_t* data,
+    size_t length);
 static uint64_t
 _ebpf_core_map_push_elem(_Inout_ ebpf_map_t* map, _In_ const uint8_t* value, uint64_t flags);
 static uint64_t
 _ebpf_core_map_pop_elem(_Inout_ ebpf_map_t* map, _Out_ uint8_t* value);
 static uint64_t
-_ebpf_core_map_peek_elem(_Inout_ ebpf_map_t* map, _Out_ uint8_t* value);
+_ebpf_core_map_peek_elem(_Inout_ ebpf_map_t* map, _Inout_ uint8_t* value);
 static uint64_t
 _ebpf_core_get_pid_tgid();
 static uint64_t
@@ -101,6 +108,13 @@ _ebpf_core_memmove(
 
 #define EBPF_CORE_GLOBAL_HELPER_EXTENSION_VERSION 0
 
+// Size of the pool buffer that entries are staged in when a batch lookup writes to a buffer in the calling process.
+#define EBPF_CORE_BATCH_BUFFER_CHUNK_SIZE (64 * 1024)
+
+// Maximum number of map ring entries processed per submission, which bounds the time spent in a single request. The
+// remaining entries are left in the ring for the caller to submit again.
+#define EBPF_CORE_MAP_RING_MAXIMUM_ENTRIES_PER_SUBMIT 256
+
 static ebpf_program_type_descriptor_t _ebpf_global_helper_program_descriptor = {
     EBPF_PROGRAM_TYPE_DESCRIPTOR_HEADER, "global_helper", NULL, {0}, 0, 0};
 static ebpf_program_info_t _ebpf_global_helper_program_info = {
@@ -139,6 +153,8 @@ static const void* _ebpf_general_helpers[] = {
     (void*)&_ebpf_core_memmove,
     // No default implementation of bpf_get_socket_cookie
     (void*)NULL, // bpf_get_socket_cookie
+    // Perf event array output.
+    (void*)&_ebpf_core_perf_event_output,
 };
 
 static const ebpf_helper_function_addresses_t _ebpf_global_helper_function_dispatch_table = {
@@ -198,6 +214,25 @@ _ebpf_general_helper_function_provider_detach_client(_In_ void* provider_binding
     return STATUS_SUCCESS;
 }
 
+static void
+_ebpf_core_handle_cleanup(_Inout_ ebpf_base_object_t* object, _In_ const void* instance)
+{
+    if (!ebpf_object_is_core_object(object)) {
+        return;
+    }
+
+    ebpf_epoch_state_t epoch_state = {0};
+    ebpf_epoch_enter(&epoch_state);
+
+    // Remove the user mappings of the map created through this instance, so they don't outlive the process.
+    ebpf_core_object_t* core_object = (ebpf_core_object_t*)object;
+    if (ebpf_object_get_type(core_object) == EBPF_OBJECT_MAP) {
+        ebpf_map_release_user_mappings((ebpf_map_t*)core_object, instance);
+    }
+
+    ebpf_epoch_exit(&epoch_state);
+}
+
 _Must_inspect_result_ ebpf_result_t
 ebpf_core_initiate()
 {
@@ -245,6 +280,7 @@ ebpf_core_initiate()
     if (return_value != EBPF_SUCCESS) {
         goto Done;
     }
+    ebpf_handle_set_cleanup_callback(_ebpf_core_handle_cleanup);
 
     return_value = ebpf_program_initiate();
     if (return_value != EBPF_SUCCESS) {
@@ -290,6 +326,7 @@ ebpf_core_terminate()
     ebpf_program_terminate();
 
     ebpf_handle_table_terminate();
+    ebpf_handle_set_cleanup_callback(NULL);
 
     ebpf_async_terminate();
 
@@ -1096,6 +1133,7 @@ _ebpf_core_protocol_map_get_next_key_value_batch(
     ebpf_map_t* map = NULL;
     size_t previous_key_length;
     size_t reply_data_length = 0;
+    uint64_t cursor = 0;
 
     retval = EBPF_OBJECT_REFERENCE_BY_HANDLE(request->handle, EBPF_OBJECT_MAP, (ebpf_core_object_t**)&map);
     if (retval != EBPF_SUCCESS) {
@@ -1118,6 +1156,11 @@ _ebpf_core_protocol_map_get_next_key_value_batch(
         goto Done;
     }
 
+    if (request->use_cursor && previous_key_length != 0) {
+        retval = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
     retval = ebpf_safe_size_t_subtract(
         reply_length, EBPF_OFFSET_OF(ebpf_operation_map_get_next_key_value_batch_reply_t, data), &reply_data_length);
 
@@ -1125,10 +1168,12 @@ _ebpf_core_protocol_map_get_next_key_value_batch(
         goto Done;
     }
 
+    cursor = request->cursor;
     retval = ebpf_map_get_next_key_and_value_batch(
         map,
         previous_key_length,
         previous_key_length == 0 ? NULL : request->previous_key,
+        request->use_cursor ? &cursor : NULL,
         &reply_data_length,
         reply->data,
         request->find_and_delete ? EBPF_MAP_FIND_FLAG_DELETE : 0);
@@ -1137,6 +1182,7 @@ _ebpf_core_protocol_map_get_next_key_value_batch(
         goto Done;
     }
 
+    reply->cursor = cursor;
     reply->header.length =
         (uint16_t)(EBPF_OFFSET_OF(ebpf_operation_map_get_next_key_value_batch_reply_t, data) + reply_data_length);
 
@@ -1146,6 +1192,380 @@ Done:
     EBPF_RETURN_RESULT(retval);
 }
 
+static ebpf_result_t
+_ebpf_core_protocol_map_update_element_batch_buffer(
+    _In_ const ebpf_operation_map_update_element_batch_buffer_request_t* request,
+    _Inout_ ebpf_operation_map_update_element_batch_buffer_reply_t* reply)
+{
+    EBPF_LOG_ENTRY();
+    ebpf_result_t retval;
+    ebpf_map_t* map = NULL;
+    ebpf_locked_user_buffer_t* buffer = NULL;
+    uint8_t* entry = NULL;
+    size_t input_count = 0;
+    size_t output_count = 0;
+    size_t key_and_value_length;
+
+    retval = EBPF_OBJECT_REFERENCE_BY_HANDLE(request->handle, EBPF_OBJECT_MAP, (ebpf_core_object_t**)&map);
+    if (retval != EBPF_SUCCESS) {
+        goto Done;
+    }
+
+    const ebpf_map_definition_in_memory_t* map_definition = ebpf_map_get_definition(map);
+
+    key_and_value_length = (size_t)map_definition->key_size + (size_t)map_definition->value_size;
+
+    if (key_and_value_length == 0 || (request->data.length % key_and_value_length) != 0) {
+        retval = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
+    retval = ebpf_lock_user_buffer(
+        request->data.address, (size_t)request->data.length, EBPF_PAGE_PROTECT_READ_ONLY, &buffer);
+    if (retval != EBPF_SUCCESS) {
+        goto Done;
+    }
+
+    // Each entry is copied out of the caller's buffer before use, as the caller can still modify the buffer.
+    entry = ebpf_allocate_with_tag(key_and_value_length, EBPF_POOL_TAG_CORE);
+    if (!entry) {
+        retval = EBPF_NO_MEMORY;
+        goto Done;
+    }
+
+    const uint8_t* data = (const uint8_t*)ebpf_locked_user_buffer_get_address(buffer);
+    input_count = (size_t)request->data.length / key_and_value_length;
+
+    reply->result = EBPF_SUCCESS;
+    for (output_count = 0; output_count < input_count; output_count++) {
+        memcpy(entry, data + output_count * key_and_value_length, key_and_value_length);
+        reply->result = ebpf_map_update_entry(
+            map,
+            map_definition->key_size,
+            entry,
+            map_definition->value_size,
+            entry + map_definition->key_size,
+            request->option,
+            0);
+        if (reply->result != EBPF_SUCCESS) {
+            break;
+        }
+    }
+
+    // Report a failing element in the reply rather than failing the operation. The output buffer of a failed
+    // operation isn't returned to the caller, which then couldn't tell where the batch stopped.
+    reply->header.length = (uint16_t)sizeof(ebpf_operation_map_update_element_batch_buffer_reply_t);
+    reply->count_of_elements_processed = output_count;
+
+Done:
+    ebpf_free(entry);
+    ebpf_unlock_user_buffer(buffer);
+    EBPF_OBJECT_RELEASE_REFERENCE((ebpf_core_object_t*)map);
+    EBPF_RETURN_RESULT(retval);
+}
+
+static ebpf_result_t
+_ebpf_core_protocol_map_get_next_key_value_batch_buffer(
+    _In_ const ebpf_operation_map_get_next_key_value_batch_buffer_request_t* request,
+    _Inout_ ebpf_operation_map_get_next_key_value_batch_buffer_reply_t* reply)
+{
+    EBPF_LOG_ENTRY();
+    ebpf_result_t retval;
+    ebpf_map_t* map = NULL;
+    ebpf_locked_user_buffer_t* buffer = NULL;
+    uint8_t* chunk = NULL;
+    uint8_t* previous_key = NULL;
+    size_t previous_key_length;
+    size_t key_and_value_length;
+    size_t chunk_size;
+    size_t buffer_length = (size_t)request->data.length;
+    size_t data_length = 0;
+    uint64_t cursor = request->cursor;
+
+    retval = EBPF_OBJECT_REFERENCE_BY_HANDLE(request->handle, EBPF_OBJECT_MAP, (ebpf_core_object_t**)&map);
+    if (retval != EBPF_SUCCESS) {
+        goto Done;
+    }
+
+    const ebpf_map_definition_in_memory_t* map_definition = ebpf_map_get_definition(map);
+
+    retval = ebpf_safe_size_t_subtract(
+        request->header.length,
+        EBPF_OFFSET_OF(ebpf_operation_map_get_next_key_value_batch_buffer_request_t, previous_key),
+        &previous_key_length);
+    if (retval != EBPF_SUCCESS) {
+        goto Done;
+    }
+
+    if (previous_key_length != 0 && previous_key_length != map_definition->key_size) {
+        retval = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
+    if (request->use_cursor && previous_key_length != 0) {
+        retval = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
+    key_and_value_length = (size_t)map_definition->key_size + (size_t)map_definition->value_size;
+    if (key_and_value_length == 0) {
+        retval = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
+    retval = ebpf_lock_user_buffer(request->data.address, buffer_length, EBPF_PAGE_PROTECT_READ_WRITE, &buffer);
+    if (retval != EBPF_SUCCESS) {
+        goto Done;
+    }
+
+    // Entries are staged in pool memory and then copied to the caller's buffer, as a walk by key reads back the last
+    // key returned and the caller can still modify its buffer. The previous key is kept after the chunk.
+    chunk_size = min(buffer_length, max(key_and_value_length, EBPF_CORE_BATCH_BUFFER_CHUNK_SIZE));
+    chunk = ebpf_allocate_with_tag(chunk_size + map_definition->key_size, EBPF_POOL_TAG_CORE);
+    if (!chunk) {
+        retval = EBPF_NO_MEMORY;
+        goto Done;
+    }
+
+    if (previous_key_length != 0) {
+        previous_key = chunk + chunk_size;
+        memcpy(previous_key, request->previous_key, previous_key_length);
+    }
+
+    uint8_t* data = (uint8_t*)ebpf_locked_user_buffer_get_address(buffer);
+    while (buffer_length - data_length >= key_and_value_length) {
+        size_t length = min(buffer_length - data_length, chunk_size);
+        retval = ebpf_map_get_next_key_and_value_batch(
+            map,
+            previous_key ? map_definition->key_size : 0,
+            previous_key,
+            request->use_cursor ? &cursor : NULL,
+            &length,
+            chunk,
+            request->find_and_delete ? EBPF_MAP_FIND_FLAG_DELETE : 0);
+        if (retval != EBPF_SUCCESS) {
+            break;
+        }
+
+        memcpy(data + data_length, chunk, length);
+        data_length += length;
+
+        if (!request->use_cursor) {
+            previous_key = chunk + chunk_size;
+            memcpy(previous_key, chunk + length - key_and_value_length, map_definition->key_size);
+        }
+    }
+
+    if ((retval == EBPF_NO_MORE_KEYS || retval == EBPF_INSUFFICIENT_BUFFER) && data_length != 0) {
+        // Returned at least one key/value pair.
+        retval = EBPF_SUCCESS;
+    } else if (retval == EBPF_SUCCESS && data_length == 0) {
+        // The buffer can't hold a single key/value pair.
+        retval = EBPF_INSUFFICIENT_BUFFER;
+    }
+    if (retval != EBPF_SUCCESS) {
+        goto Done;
+    }
+
+    reply->header.length = (uint16_t)sizeof(ebpf_operation_map_get_next_key_value_batch_buffer_reply_t);
+    reply->cursor = cursor;
+    reply->data_length = data_length;
+
+Done:
+    ebpf_free(chunk);
+    ebpf_unlock_user_buffer(buffer);
+    EBPF_OBJECT_RELEASE_REFERENCE((ebpf_core_object_t*)map);
+    EBPF_RETURN_RESULT(retval);
+}
+
+// Map and scratch memory kept across the entries of a map ring submission, so consecutive entries for the same map
+// take a single reference.
+typedef struct _ebpf_core_map_ring_state
+{
+    ebpf_handle_t map_handle;
+    ebpf_map_t* map;
+    uint8_t* scratch;
+    size_t scratch_length;
+} ebpf_core_map_ring_state_t;
+
+/**
+ * @brief Process a single map ring submission.
+ *
+ * @param[in] submission Copy of the submission to process.
+ * @param[in, out] data Data area of the ring.
+ * @param[in] data_length Length of the data area.
+ * @param[in, out] state Map and scratch memory kept across submissions.
+ * @returns Result of the map operation.
+ */
+static ebpf_result_t
+_ebpf_core_map_ring_process_submission(
+    _In_ const ebpf_map_ring_submission_t* submission,
+    _Inout_updates_bytes_(data_length) uint8_t* data,
+    size_t data_length,
+    _Inout_ ebpf_core_map_ring_state_t* state)
+{
+    ebpf_result_t result;
+
+    if (state->map == NULL || state->map_handle != submission->map_handle) {
+        EBPF_OBJECT_RELEASE_REFERENCE((ebpf_core_object_t*)state->map);
+        state->map = NULL;
+        result = EBPF_OBJECT_REFERENCE_BY_HANDLE(
+            submission->map_handle, EBPF_OBJECT_MAP, (ebpf_core_object_t**)&state->map);
+        if (result != EBPF_SUCCESS) {
+            return result;
+        }
+        state->map_handle = submission->map_handle;
+    }
+
+    // Bloom filter lookups and updates of maps that hold object references need translation that is only done by the
+    // synchronous operations, so don't rely on the caller to have filtered them out.
+    const ebpf_map_definition_in_memory_t* map_definition = ebpf_map_get_definition(state->map);
+    ebpf_map_type_t type = map_definition->type;
+    if (type == BPF_MAP_TYPE_BLOOM_FILTER) {
+        return EBPF_OPERATION_NOT_SUPPORTED;
+    }
+    if (submission->operation == EBPF_MAP_RING_OPERATION_UPDATE &&
+        (type == BPF_MAP_TYPE_PROG_ARRAY || type == BPF_MAP_TYPE_HASH_OF_MAPS || type == BPF_MAP_TYPE_ARRAY_OF_MAPS)) {
+        return EBPF_OPERATION_NOT_SUPPORTED;
+    }
+
+    size_t key_length = map_definition->key_size;
+    size_t value_length = (submission->operation == EBPF_MAP_RING_OPERATION_DELETE) ? 0 : submission->value_length;
+
+    if (key_length + value_length == 0) {
+        return EBPF_INVALID_ARGUMENT;
+    }
+
+    if (key_length > data_length || submission->key_offset > data_length - key_length) {
+        return EBPF_INVALID_ARGUMENT;
+    }
+
+    if (value_length > data_length || submission->value_offset > data_length - value_length) {
+        return EBPF_INVALID_ARGUMENT;
+    }
+
+    // Keys and values are copied out of the ring before use, as the caller can still modify the ring.
+    if (state->scratch_length < key_length + value_length) {
+        ebpf_free(state->scratch);
+        state->scratch_length = 0;
+        state->scratch = ebpf_allocate_with_tag(key_length + value_length, EBPF_POOL_TAG_CORE);
+        if (!state->scratch) {
+            return EBPF_NO_MEMORY;
+        }
+        state->scratch_length = key_length + value_length;
+    }
+
+    uint8_t* key = state->scratch;
+    uint8_t* value = state->scratch + key_length;
+    memcpy(key, data + submission->key_offset, key_length);
+
+    switch (submission->operation) {
+    case EBPF_MAP_RING_OPERATION_LOOKUP:
+        result = ebpf_map_find_entry(state->map, key_length, key, value_length, value, 0);
+        if (result == EBPF_SUCCESS) {
+            memcpy(data + submission->value_offset, value, value_length);
+        }
+        break;
+    case EBPF_MAP_RING_OPERATION_UPDATE:
+        memcpy(value, data + submission->value_offset, value_length);
+        result = ebpf_map_update_entry(
+            state->map, key_length, key, value_length, value, (ebpf_map_option_t)submission->option, 0);
+        break;
+    case EBPF_MAP_RING_OPERATION_DELETE:
+        result = ebpf_map_delete_entry(state->map, key_length, key, 0);
+        break;
+    default:
+        result = EBPF_INVALID_ARGUMENT;
+        break;
+    }
+
+    return result;
+}
+
+static ebpf_result_t
+_ebpf_core_protocol_map_ring_submit(
+    _In_ const ebpf_operation_map_ring_submit_request_t* request,
+    _Inout_ ebpf_operation_map_ring_submit_reply_t* reply)
+{
+    EBPF_LOG_ENTRY();
+    ebpf_result_t retval;
+    ebpf_locked_user_buffer_t* buffer = NULL;
+    ebpf_core_map_ring_state_t state = {0};
+    ebpf_map_ring_header_t header;
+    size_t data_length;
+    uint32_t count = 0;
+
+    if (request->ring.length < sizeof(ebpf_map_ring_header_t)) {
+        retval = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
+    retval = ebpf_lock_user_buffer(
+        request->ring.address, (size_t)request->ring.length, EBPF_PAGE_PROTECT_READ_WRITE, &buffer);
+    if (retval != EBPF_SUCCESS) {
+        goto Done;
+    }
+
+    // The header is read once, as the caller can still modify the ring.
+    uint8_t* ring = (uint8_t*)ebpf_locked_user_buffer_get_address(buffer);
+    memcpy(&header, ring, sizeof(header));
+
+    if (header.entry_count == 0 || (header.entry_count & (header.entry_count - 1)) != 0) {
+        retval = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
+    retval = ebpf_safe_size_t_subtract(
+        (size_t)request->ring.length,
+        sizeof(ebpf_map_ring_header_t) +
+            (size_t)header.entry_count * (sizeof(ebpf_map_ring_submission_t) + sizeof(ebpf_map_ring_completion_t)),
+        &data_length);
+    if (retval != EBPF_SUCCESS) {
+        retval = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
+    if (header.submission_tail - header.submission_head > header.entry_count ||
+        header.completion_tail - header.completion_head > header.entry_count) {
+        retval = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
+    ebpf_map_ring_submission_t* submissions = (ebpf_map_ring_submission_t*)(ring + sizeof(ebpf_map_ring_header_t));
+    ebpf_map_ring_completion_t* completions = (ebpf_map_ring_completion_t*)(submissions + header.entry_count);
+    uint8_t* data = (uint8_t*)(completions + header.entry_count);
+    uint32_t mask = header.entry_count - 1;
+
+    // Stop early if the completion queue fills up or the per call limit is reached. The remaining submissions are
+    // left for the next call.
+    while (header.submission_head != header.submission_tail &&
+           header.completion_tail - header.completion_head < header.entry_count &&
+           count < EBPF_CORE_MAP_RING_MAXIMUM_ENTRIES_PER_SUBMIT) {
+        ebpf_map_ring_submission_t submission = submissions[header.submission_head & mask];
+        ebpf_map_ring_completion_t completion = {0};
+
+        completion.user_data = submission.user_data;
+        completion.result = _ebpf_core_map_ring_process_submission(&submission, data, data_length, &state);
+        completions[header.completion_tail & mask] = completion;
+
+        header.submission_head++;
+        header.completion_tail++;
+        count++;
+    }
+
+    ((ebpf_map_ring_header_t*)ring)->submission_head = header.submission_head;
+    ((ebpf_map_ring_header_t*)ring)->completion_tail = header.completion_tail;
+
+    reply->header.length = (uint16_t)sizeof(ebpf_operation_map_ring_submit_reply_t);
+    reply->count_of_entries_processed = count;
+
+Done:
+    ebpf_free(state.scratch);
+    EBPF_OBJECT_RELEASE_REFERENCE((ebpf_core_object_t*)state.map);
+    ebpf_unlock_user_buffer(buffer);
+    EBPF_RETURN_RESULT(retval);
+}
+
 /**
  * @brief Complete the test run of an eBPF program. This is called when a program test run has completed. This
  * function will build the reply message and send it to the client.
@@ -2026,6 +2446,14 @@ _ebpf_core_protocol_ring_buffer_map_query_buffer(
 
     result =
         ebpf_ring_buffer_map_query_buffer(map, (uint8_t**)(uintptr_t*)&reply->buffer_address, &reply->consumer_offset);
+    if (result != EBPF_SUCCESS) {
+        goto Exit;
+    }
+
+    result = ebpf_ring_buffer_map_query_offsets(
+        map,
+        (const ebpf_ring_buffer_producer_page_t**)(uintptr_t*)&reply->producer_page_address,
+        (ebpf_ring_buffer_consumer_page_t**)(uintptr_t*)&reply->consumer_page_address);
 
 Exit:
     EBPF_OBJECT_RELEASE_REFERENCE((ebpf_core_object_t*)map);
@@ -2073,6 +2501,109 @@ Exit:
     return result;
 }
 
+static ebpf_result_t
+_ebpf_core_protocol_perf_event_array_map_query_buffer(
+    _In_ const ebpf_operation_perf_event_array_map_query_buffer_request_t* request,
+    _Out_ ebpf_operation_perf_event_array_map_query_buffer_reply_t* reply)
+{
+    EBPF_LOG_ENTRY();
+
+    ebpf_map_t* map = NULL;
+    ebpf_result_t result =
+        EBPF_OBJECT_REFERENCE_BY_HANDLE(request->map_handle, EBPF_OBJECT_MAP, (ebpf_core_object_t**)&map);
+    if (result != EBPF_SUCCESS) {
+        goto Exit;
+    }
+
+    if (ebpf_map_get_definition(map)->type != BPF_MAP_TYPE_PERF_EVENT_ARRAY) {
+        result = EBPF_INVALID_ARGUMENT;
+        goto Exit;
+    }
+
+    result = ebpf_perf_event_array_map_query_buffer(
+        map, request->cpu_id, (uint8_t**)(uintptr_t*)&reply->buffer_address, &reply->consumer_offset);
+
+Exit:
+    EBPF_OBJECT_RELEASE_REFERENCE((ebpf_core_object_t*)map);
+    EBPF_RETURN_RESULT(result);
+}
+
+static ebpf_result_t
+_ebpf_core_protocol_perf_event_array_map_async_query(
+    _In_ const ebpf_operation_perf_event_array_map_async_query_request_t* request,
+    _Inout_ ebpf_operation_perf_event_array_map_async_query_reply_t* reply,
+    uint16_t reply_length,
+    _Inout_ void* async_context)
+{
+    UNREFERENCED_PARAMETER(reply_length);
+
+    ebpf_map_t* map = NULL;
+    bool reference_taken = FALSE;
+
+    ebpf_result_t result =
+        EBPF_OBJECT_REFERENCE_BY_HANDLE(request->map_handle, EBPF_OBJECT_MAP, (ebpf_core_object_t**)&map);
+    if (result != EBPF_SUCCESS) {
+        goto Exit;
+    }
+    reference_taken = TRUE;
+
+    if (ebpf_map_get_definition(map)->type != BPF_MAP_TYPE_PERF_EVENT_ARRAY) {
+        result = EBPF_INVALID_ARGUMENT;
+        goto Exit;
+    }
+
+    // Return buffer already consumed by caller in previous notification.
+    result = ebpf_perf_event_array_map_return_buffer(map, request->cpu_id, request->consumer_offset);
+    if (result != EBPF_SUCCESS) {
+        goto Exit;
+    }
+
+    reply->header.id = EBPF_OPERATION_PERF_EVENT_ARRAY_MAP_ASYNC_QUERY;
+    reply->header.length = sizeof(ebpf_operation_perf_event_array_map_async_query_reply_t);
+    result = ebpf_perf_event_array_map_async_query(map, request->cpu_id, &reply->async_query_result, async_context);
+
+Exit:
+    if (reference_taken) {
+        EBPF_OBJECT_RELEASE_REFERENCE((ebpf_core_object_t*)map);
+    }
+    return result;
+}
+
+static ebpf_result_t
+_ebpf_core_protocol_set_program_statistics(_In_ const ebpf_operation_set_program_statistics_request_t* request)
+{
+    EBPF_LOG_ENTRY();
+    ebpf_program_set_statistics_enabled(request->enabled != 0);
+    EBPF_RETURN_RESULT(EBPF_SUCCESS);
+}
+
+static ebpf_result_t
+_ebpf_core_protocol_map_mmap(
+    _In_ const ebpf_operation_map_mmap_request_t* request, _Out_ ebpf_operation_map_mmap_reply_t* reply)
+{
+    EBPF_LOG_ENTRY();
+
+    ebpf_map_t* map = NULL;
+    const void* instance = NULL;
+    ebpf_result_t result =
+        EBPF_OBJECT_REFERENCE_BY_HANDLE(request->map_handle, EBPF_OBJECT_MAP, (ebpf_core_object_t**)&map);
+    if (result != EBPF_SUCCESS) {
+        goto Exit;
+    }
+
+    // The mapping is removed when the last handle to this instance of the map is closed.
+    result = ebpf_handle_get_instance(request->map_handle, &instance);
+    if (result != EBPF_SUCCESS) {
+        goto Exit;
+    }
+
+    result = ebpf_map_mmap(map, instance, (uint8_t**)(uintptr_t*)&reply->address);
+
+Exit:
+    EBPF_OBJECT_RELEASE_REFERENCE((ebpf_core_object_t*)map);
+    EBPF_RETURN_RESULT(result);
+}
+
 static void*
 _ebpf_core_map_find_element(ebpf_map_t* map, const uint8_t* key)
 {
@@ -2348,6 +2879,19 @@ _ebpf_core_ring_buffer_output(
     return -ebpf_ring_buffer_map_output(map, data, length);
 }
 
+static int
+_ebpf_core_perf_event_output(
+    _In_ const void* ctx,
+    _Inout_ ebpf_map_t* map,
+    uint64_t flags,
+    _In_reads_bytes_(length) uint8_t* data,
+    size_t length)
+{
+    // This function implements bpf_perf_event_output helper function, which returns negative error in case of failure.
+    UNREFERENCED_PARAMETER(ctx);
+    return -ebpf_perf_event_array_map_output(map, flags, data, length);
+}
+
 static uint64_t
 _ebpf_core_map_push_elem(_Inout_ ebpf_map_t* map, _In_ const uint8_t* value, uint64_t flags)
 {
@@ -2361,7 +2905,7 @@ _ebpf_core_map_pop_elem(_Inout_ ebpf_map_t* map, _Out_ uint8_t* value)
 }
 
 static uint64_t
-_ebpf_core_map_peek_elem(_Inout_ ebpf_map_t* map, _Out_ uint8_t* value)
+_ebpf_core_map_peek_elem(_Inout_ ebpf_map_t* map, _Inout_ uint8_t* value)
 {
     return -ebpf_map_peek_entry(map, 0, value, EBPF_MAP_FLAG_HELPER);
 }
@@ -2615,6 +3159,14 @@ static ebpf_protocol_handler_t _ebpf_protocol_handlers[] = {
     DECLARE_PROTOCOL_HANDLER_VARIABLE_REQUEST_FIXED_REPLY(map_delete_element_batch, keys, PROTOCOL_ALL_MODES),
     DECLARE_PROTOCOL_HANDLER_VARIABLE_REQUEST_VARIABLE_REPLY(
         map_get_next_key_value_batch, previous_key, data, PROTOCOL_ALL_MODES),
+    DECLARE_PROTOCOL_HANDLER_FIXED_REQUEST_FIXED_REPLY(perf_event_array_map_query_buffer, PROTOCOL_ALL_MODES),
+    DECLARE_PROTOCOL_HANDLER_FIXED_REQUEST_FIXED_REPLY_ASYNC(perf_event_array_map_async_query, PROTOCOL_ALL_MODES),
+    DECLARE_PROTOCOL_HANDLER_FIXED_REQUEST_NO_REPLY(set_program_statistics, PROTOCOL_ALL_MODES),
+    DECLARE_PROTOCOL_HANDLER_FIXED_REQUEST_FIXED_REPLY(map_mmap, PROTOCOL_ALL_MODES),
+    DECLARE_PROTOCOL_HANDLER_FIXED_REQUEST_FIXED_REPLY(map_update_element_batch_buffer, PROTOCOL_ALL_MODES),
+    DECLARE_PROTOCOL_HANDLER_VARIABLE_REQUEST_FIXED_REPLY(
+        map_get_next_key_value_batch_buffer, previous_key, PROTOCOL_ALL_MODES),
+    DECLARE_PROTOCOL_HANDLER_FIXED_REQUEST_FIXED_REPLY(map_ring_submit, PROTOCOL_ALL_MODES),
 };
 
 _Must_inspect_result_ ebpf_result_t
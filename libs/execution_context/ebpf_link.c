@@ -88,6 +88,13 @@ _ebpf_link_instance_invoke_batch(
 static ebpf_result_t
 _ebpf_link_instance_invoke_batch_end(_Inout_ void* state);
 
+static ebpf_result_t
+_ebpf_link_instance_invoke_vector(
+    _In_ const void* extension_client_binding_context,
+    _Inout_updates_(count) void** program_contexts,
+    _Out_writes_(count) uint32_t* results,
+    size_t count);
+
 static const ebpf_extension_program_dispatch_table_t _ebpf_link_dispatch_table = {
     EBPF_LINK_DISPATCH_TABLE_VERSION_CURRENT,
     EBPF_LINK_DISPATCH_TABLE_FUNCTION_COUNT_CURRENT, // Count of functions. This should be updated when new functions
@@ -96,6 +103,7 @@ static const ebpf_extension_program_dispatch_table_t _ebpf_link_dispatch_table =
     _ebpf_link_instance_invoke_batch_begin,
     _ebpf_link_instance_invoke_batch,
     _ebpf_link_instance_invoke_batch_end,
+    _ebpf_link_instance_invoke_vector,
 };
 
 // Assert that the invoke function is aligned with ebpf_extension_dispatch_table_t->function.
@@ -528,6 +536,31 @@ _ebpf_link_instance_invoke_batch(
     EBPF_RETURN_RESULT(return_value);
 }
 
+static ebpf_result_t
+_ebpf_link_instance_invoke_vector(
+    _In_ const void* client_binding_context,
+    _Inout_updates_(count) void** program_contexts,
+    _Out_writes_(count) uint32_t* results,
+    size_t count)
+{
+    // No function entry exit traces as this is a high volume function.
+    ebpf_execution_context_state_t state = {0};
+    ebpf_link_t* link = (ebpf_link_t*)client_binding_context;
+    ebpf_result_t return_value;
+
+    return_value = _ebpf_link_instance_invoke_batch_begin(sizeof(ebpf_execution_context_state_t), &state);
+    if (return_value != EBPF_SUCCESS) {
+        memset(results, 0, count * sizeof(results[0]));
+        goto Done;
+    }
+
+    return_value = ebpf_program_invoke_vector(link->program, program_contexts, results, count, &state);
+    (void)_ebpf_link_instance_invoke_batch_end(&state);
+
+Done:
+    return return_value;
+}
+
 _Must_inspect_result_ ebpf_result_t
 ebpf_link_get_info(
     _In_ const ebpf_link_t* link, _Out_writes_to_(*info_size, *info_size) uint8_t* buffer, _Inout_ uint16_t* info_size)
@@ -4,23 +4,43 @@
 #define EBPF_FILE_ID EBPF_FILE_ID_MAPS
 
 #include "ebpf_async.h"
-#include "ebpf_bitmap.h"
 #include "ebpf_epoch.h"
 #include "ebpf_handle.h"
 #include "ebpf_hash_table.h"
+#include "ebpf_lpm_trie.h"
 #include "ebpf_maps.h"
 #include "ebpf_object.h"
 #include "ebpf_program.h"
+#include "ebpf_random.h"
 #include "ebpf_ring_buffer.h"
 #include "ebpf_tracelog.h"
 
+/**
+ * @brief Map creation flags accepted by ebpf_map_create.
+ */
+#define EBPF_MAP_SUPPORTED_FLAGS (BPF_F_NO_PREALLOC | BPF_F_MMAPABLE | BPF_F_PERCPU_CACHE_ALIGN)
+
+/**
+ * @brief Number of key and value pointers collected per bucket walk when copying a batch from a cursor.
+ */
+#define EBPF_MAP_BATCH_POINTER_COUNT 64
+
 typedef struct _ebpf_core_map
 {
     ebpf_core_object_t object;
     cxplat_utf8_string_t name;
     ebpf_map_definition_in_memory_t ebpf_map_definition;
     uint32_t original_value_size;
+    // Size of the storage for one value. For per-CPU maps this differs from the value size in the map definition,
+    // which describes the packed layout exchanged with user mode.
+    uint32_t value_storage_size;
+    // Distance between the slots of consecutive CPUs in the storage of a per-CPU value, 0 for other maps.
+    uint32_t per_cpu_value_stride;
     uint8_t* data;
+    // Pages holding data, for maps created with BPF_F_MMAPABLE.
+    MDL* data_memory;
+    // Set once the contents of the map are final. Updates and deletes are rejected from then on.
+    volatile bool frozen;
 } ebpf_core_map_t;
 
 typedef struct _ebpf_core_object_map
@@ -32,6 +52,25 @@ typedef struct _ebpf_core_object_map
     ebpf_program_type_t program_type;
 } ebpf_core_object_map_t;
 
+/**
+ * @brief Array map created with BPF_F_MMAPABLE. Mappings of the values into user mode are tracked per handle
+ * instance, each holding a reference on the map, so the pages outlive every mapping of them.
+ */
+typedef struct _ebpf_core_mmap_array_map
+{
+    ebpf_core_map_t core_map;
+    ebpf_lock_t lock;
+    _Guarded_by_(lock) ebpf_list_entry_t user_mappings; //< List of ebpf_map_user_mapping_t.
+    ebpf_epoch_work_item_t* free_data_memory_work_item;
+} ebpf_core_mmap_array_map_t;
+
+typedef struct _ebpf_map_user_mapping
+{
+    ebpf_list_entry_t list_entry;
+    const void* instance;
+    ebpf_user_mapping_t* mapping;
+} ebpf_map_user_mapping_t;
+
 // Generations:
 // 0: Uninitialized.
 // 1 to 2^64-2: Valid generations.
@@ -192,63 +231,133 @@ typedef enum _ebpf_lru_key_state
                          // will be freed when the current epoch is retired.
 } ebpf_lru_key_state_t;
 
-typedef struct _ebpf_core_lpm_map
+#pragma warning(disable : 4324) // Structure was padded due to alignment specifier.
+/**
+ * @brief A ring buffer and the async queries waiting for records to be
+ * written to it. Used for BPF_MAP_TYPE_RINGBUF and for each CPU of a
+ * BPF_MAP_TYPE_PERF_EVENT_ARRAY.
+ */
+__declspec(align(EBPF_CACHE_LINE_SIZE)) typedef struct _ebpf_core_ring
 {
-    ebpf_core_map_t core_map;
-    uint32_t max_prefix;
-    // Bitmap of prefix lengths inserted into the map.
-    uint64_t data[1];
-} ebpf_core_lpm_map_t;
+    ebpf_ring_buffer_t* ring_buffer;
+    ebpf_lock_t lock;
+    // Flag that is set the first time an async operation is queued to the ring.
+    // This flag only transitions from off -> on. When this flag is set and the
+    // async_contexts list is not empty, writes to the ring acquire the lock to
+    // complete the queued operations.
+    bool async_contexts_trip_wire;
+    ebpf_list_entry_t async_contexts;
+    volatile int64_t lost_count; //< Number of records dropped because the ring buffer was full.
+} ebpf_core_ring_t;
 
 typedef struct _ebpf_core_ring_buffer_map
 {
     ebpf_core_map_t core_map;
-    ebpf_lock_t lock;
-    // Flag that is set the first time an async operation is queued to the map.
-    // This flag only transitions from off -> on. When this flag is set,
-    // updates to the map acquire the lock and check the async_contexts list.
-    // Note that queueing an async operation thus causes a perf degradation
-    // for all subsequent updates, so should only be allowed to admin.
-    bool async_contexts_trip_wire;
-    ebpf_list_entry_t async_contexts;
+    ebpf_core_ring_t ring;
 } ebpf_core_ring_buffer_map_t;
 
-typedef struct _ebpf_core_ring_buffer_map_async_query_context
+/**
+ * @brief Core map structure for BPF_MAP_TYPE_PERF_EVENT_ARRAY. Each CPU writes
+ * to its own ring, so producers on different CPUs don't share cache lines.
+ */
+typedef struct _ebpf_core_perf_event_array_map
+{
+    ebpf_core_map_t core_map;
+    uint32_t ring_count;
+    ebpf_core_ring_t rings[1];
+} ebpf_core_perf_event_array_map_t;
+
+typedef struct _ebpf_core_ring_async_query_context
 {
     ebpf_list_entry_t entry;
-    ebpf_core_ring_buffer_map_t* ring_buffer_map;
+    ebpf_core_ring_t* ring;
     ebpf_ring_buffer_map_async_query_result_t* async_query_result;
+    uint64_t* lost_count;
+    size_t reply_length;
     void* async_context;
-} ebpf_core_ring_buffer_map_async_query_context_t;
+} ebpf_core_ring_async_query_context_t;
+
+/**
+ * @brief A slot of a queue or stack map. The sequence number is only used by queues.
+ */
+typedef struct _ebpf_core_circular_map_slot
+{
+    volatile int64_t sequence;
+    uint8_t value[1];
+} ebpf_core_circular_map_slot_t;
 
 /**
- * Core map structure for BPF_MAP_TYPE_QUEUE and BPF_MAP_TYPE_STACK
- * ebpf_core_circular_map_t stores an array of uint8_t* pointers. Each pointer
- * stores a version of a value that has been pushed to the queue or stack. The
- * structure can't store the map values directly as the caller expects items
- * returned from peek to remain unmodified. If items are stored directly in
- * the array, then a sequence of:
- * 1) push
- * 2) peek
- * 3) pop
- * 4) push
- * can result in aliasing the record, which would result in unexpected behavior.
+ * @brief Position in a queue, padded to a cache line so producers and consumers don't share one.
  */
+__declspec(align(EBPF_CACHE_LINE_SIZE)) typedef struct _ebpf_core_queue_position
+{
+    volatile int64_t value;
+} ebpf_core_queue_position_t;
 
+/**
+ * Core map structure for BPF_MAP_TYPE_QUEUE and BPF_MAP_TYPE_STACK.
+ * Values are stored inline in a ring of max_entries slots that is allocated
+ * with the map, so pushes don't allocate. Pop and peek copy the value out
+ * rather than returning a pointer to the slot, so a sequence of push, peek,
+ * pop, push can't alias the record returned by the peek.
+ *
+ * A queue is a bounded multi-producer multi-consumer ring. Each slot carries
+ * a sequence number that tells a producer at position N that the slot is free
+ * (N) and a consumer at position N that the slot holds its value (N + 1).
+ * Producers claim tail and consumers claim head with a compare-exchange, so
+ * neither takes a lock. A peek copies the value at the head and retries if
+ * the sequence number of the slot changed while copying.
+ *
+ * A stack pushes and pops at the same end, so positions move in both
+ * directions and sequence numbers can't tell the readers of a slot from its
+ * next writer. Stack operations are serialized by the lock.
+ */
 typedef struct _ebpf_core_circular_map
 {
     ebpf_core_map_t core_map;
-    ebpf_lock_t lock;
-    size_t begin;
-    size_t end;
     enum
     {
         EBPF_CORE_QUEUE = 1,
         EBPF_CORE_STACK = 2,
     } type;
-    uint8_t* slots[1];
+    size_t slot_size;
+    // Stack state.
+    ebpf_lock_t lock;
+    size_t begin;
+    size_t count;
+    // Queue state.
+    ebpf_core_queue_position_t head;
+    ebpf_core_queue_position_t tail;
 } ebpf_core_circular_map_t;
 
+#define EBPF_BLOOM_FILTER_DEFAULT_HASH_COUNT 5
+#define EBPF_BLOOM_FILTER_MAX_HASH_COUNT 15
+#define EBPF_BLOOM_FILTER_BITS_PER_BLOCK (EBPF_CACHE_LINE_SIZE * 8)
+
+/**
+ * @brief One cache line of a bloom filter bit array. All the bits for a value
+ * are in the same block, so testing a value reads a single cache line.
+ */
+__declspec(align(EBPF_CACHE_LINE_SIZE)) typedef struct _ebpf_bloom_filter_block
+{
+    volatile int64_t bits[EBPF_CACHE_LINE_SIZE / sizeof(int64_t)];
+} ebpf_bloom_filter_block_t;
+
+/**
+ * @brief Core map structure for BPF_MAP_TYPE_BLOOM_FILTER. The bit array is
+ * allocated with the map and bits are never cleared, so pushes set bits with
+ * interlocked operations and need neither a lock nor epoch allocations.
+ * core_map.data points at the first cache-aligned block in block_storage.
+ */
+typedef struct _ebpf_core_bloom_filter_map
+{
+    ebpf_core_map_t core_map;
+    uint32_t seed;
+    uint32_t hash_count;
+    uint32_t block_mask;
+    uint8_t block_storage[1];
+} ebpf_core_bloom_filter_map_t;
+
 static size_t
 _ebpf_core_circular_map_add(_In_ const ebpf_core_circular_map_t* map, size_t value, int delta)
 {
@@ -256,86 +365,176 @@ _ebpf_core_circular_map_add(_In_ const ebpf_core_circular_map_t* map, size_t val
            map->core_map.ebpf_map_definition.max_entries;
 }
 
-static uint8_t*
-_ebpf_core_circular_map_peek_or_pop(_Inout_ ebpf_core_circular_map_t* map, bool pop)
+static inline ebpf_core_circular_map_slot_t*
+_ebpf_core_circular_map_slot(_In_ const ebpf_core_circular_map_t* map, size_t index)
 {
-    uint8_t* return_value = NULL;
+    return (ebpf_core_circular_map_slot_t*)(map->core_map.data + index * map->slot_size);
+}
 
-    if (map->type == EBPF_CORE_QUEUE) {
-        // Remove from the beginning.
-        return_value = map->slots[map->begin];
-        if (return_value == NULL) {
-            ebpf_assert(map->begin == map->end);
-            goto Done;
-        }
-        if (pop) {
-            map->slots[map->begin] = NULL;
-            map->begin = _ebpf_core_circular_map_add(map, map->begin, 1);
-        }
-    } else {
-        // Remove from the end.
-        size_t new_end = _ebpf_core_circular_map_add(map, map->end, -1);
-        return_value = map->slots[new_end];
-        if (return_value == NULL) {
-            ebpf_assert(map->begin == map->end);
-            goto Done;
-        }
-        if (pop) {
-            map->slots[new_end] = NULL;
-            map->end = new_end;
+/**
+ * @brief Remove the value at the head of a queue.
+ *
+ * @param[in, out] map Queue to pop from.
+ * @param[out] value If not NULL, receives the value.
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_OBJECT_NOT_FOUND The queue is empty.
+ */
+static ebpf_result_t
+_ebpf_core_queue_pop(
+    _Inout_ ebpf_core_circular_map_t* map,
+    _Out_writes_bytes_opt_(map->core_map.ebpf_map_definition.value_size) uint8_t* value)
+{
+    int64_t capacity = map->core_map.ebpf_map_definition.max_entries;
+    for (;;) {
+        int64_t position = map->head.value;
+        ebpf_core_circular_map_slot_t* slot = _ebpf_core_circular_map_slot(map, (size_t)(position % capacity));
+        int64_t sequence = ReadAcquire64(&slot->sequence);
+        if (sequence == position + 1) {
+            if (ebpf_interlocked_compare_exchange_int64(&map->head.value, position + 1, position) == position) {
+                if (value) {
+                    memcpy(value, slot->value, map->core_map.ebpf_map_definition.value_size);
+                }
+                // Hand the slot to the producer of the next lap.
+                WriteRelease64(&slot->sequence, position + capacity);
+                return EBPF_SUCCESS;
+            }
+        } else if (sequence < position + 1) {
+            // The slot hasn't been filled for this position.
+            return EBPF_OBJECT_NOT_FOUND;
         }
+        // Another consumer took this position, try the next one.
     }
-    if (pop) {
-        // The return_value is not freed until the current epoch is retired.
-        ebpf_epoch_free(return_value);
-    }
-Done:
-#pragma warning(push)
-#pragma warning(disable : 6001) // Using uninitialized memory 'return_value'.
-    return return_value;
-#pragma warning(pop)
 }
 
+/**
+ * @brief Copy the value at the head of a queue without removing it.
+ *
+ * @param[in] map Queue to peek at.
+ * @param[out] value Receives the value.
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_OBJECT_NOT_FOUND The queue is empty.
+ */
 static ebpf_result_t
-_ebpf_core_circular_map_push(_Inout_ ebpf_core_circular_map_t* map, _In_ const uint8_t* data, bool replace)
-{
-    ebpf_result_t return_value;
-    uint8_t* new_data = NULL;
-    uint8_t* old_data = NULL;
-    new_data = ebpf_epoch_allocate_with_tag(map->core_map.ebpf_map_definition.value_size, EBPF_POOL_TAG_MAP);
-    if (new_data == NULL) {
-        return_value = EBPF_NO_MEMORY;
-        goto Done;
+_ebpf_core_queue_peek(
+    _In_ const ebpf_core_circular_map_t* map,
+    _Out_writes_bytes_(map->core_map.ebpf_map_definition.value_size) uint8_t* value)
+{
+    int64_t capacity = map->core_map.ebpf_map_definition.max_entries;
+    for (;;) {
+        int64_t position = map->head.value;
+        ebpf_core_circular_map_slot_t* slot = _ebpf_core_circular_map_slot(map, (size_t)(position % capacity));
+        int64_t sequence = ReadAcquire64(&slot->sequence);
+        if (sequence == position + 1) {
+            memcpy(value, slot->value, map->core_map.ebpf_map_definition.value_size);
+            // The value is only rewritten after a consumer moves the sequence number on, so an unchanged sequence
+            // number means the copy is intact.
+            MemoryBarrier();
+            if (slot->sequence == sequence) {
+                return EBPF_SUCCESS;
+            }
+        } else if (sequence < position + 1) {
+            return EBPF_OBJECT_NOT_FOUND;
+        }
     }
-    memcpy(new_data, data, map->core_map.ebpf_map_definition.value_size);
+}
 
-    if (map->slots[map->end] != NULL) {
-        ebpf_assert(map->begin == map->end);
-        if (replace) {
-            old_data = map->slots[map->end];
-            map->slots[map->end] = NULL;
-            map->begin = _ebpf_core_circular_map_add(map, map->begin, 1);
-        } else {
-            return_value = EBPF_OUT_OF_SPACE;
-            goto Done;
+/**
+ * @brief Add a value at the tail of a queue.
+ *
+ * @param[in, out] map Queue to push to.
+ * @param[in] data Value to push.
+ * @param[in] replace If the queue is full, replace the value at the head. At most one value is dropped.
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_OUT_OF_SPACE The queue is full and replace is false.
+ */
+static ebpf_result_t
+_ebpf_core_queue_push(_Inout_ ebpf_core_circular_map_t* map, _In_ const uint8_t* data, bool replace)
+{
+    int64_t capacity = map->core_map.ebpf_map_definition.max_entries;
+    for (;;) {
+        int64_t position = map->tail.value;
+        ebpf_core_circular_map_slot_t* slot = _ebpf_core_circular_map_slot(map, (size_t)(position % capacity));
+        int64_t sequence = ReadAcquire64(&slot->sequence);
+        if (sequence == position) {
+            if (ebpf_interlocked_compare_exchange_int64(&map->tail.value, position + 1, position) == position) {
+                memcpy(slot->value, data, map->core_map.ebpf_map_definition.value_size);
+                // Publish the value to the consumer of this position.
+                WriteRelease64(&slot->sequence, position + 1);
+                return EBPF_SUCCESS;
+            }
+        } else if (sequence < position) {
+            // The slot still holds the value from the previous lap, so the queue is full.
+            if (!replace) {
+                return EBPF_OUT_OF_SPACE;
+            }
+            // Only drop the value if it is still the oldest one in the queue. If a consumer has already claimed
+            // it, the slot is about to be released, so don't drop another value.
+            int64_t head = map->head.value;
+            if (head == position - capacity && sequence == head + 1 &&
+                ebpf_interlocked_compare_exchange_int64(&map->head.value, head + 1, head) == head) {
+                // The slot was never released, so no other producer can have claimed this position. Move the
+                // sequence number on before rewriting the value so that a concurrent peek retries.
+                (void)ebpf_interlocked_compare_exchange_int64(&map->tail.value, position + 1, position);
+                WriteRelease64(&slot->sequence, position);
+                MemoryBarrier();
+                memcpy(slot->value, data, map->core_map.ebpf_map_definition.value_size);
+                WriteRelease64(&slot->sequence, position + 1);
+                return EBPF_SUCCESS;
+            }
         }
+        // Another producer took this position, or a consumer is releasing the slot, try again.
     }
+}
 
-    // Insert at the end.
-    map->slots[map->end] = new_data;
-    new_data = NULL;
-    map->end = _ebpf_core_circular_map_add(map, map->end, 1);
-
-    return_value = EBPF_SUCCESS;
-
-Done:
-    if (new_data) {
-        ebpf_epoch_free(new_data);
+/**
+ * @brief Copy the value at the top of a stack and optionally remove it. Caller must hold the map lock.
+ *
+ * @param[in, out] map Stack to peek at or pop from.
+ * @param[in] pop Remove the value.
+ * @param[out] value Receives the value.
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_OBJECT_NOT_FOUND The stack is empty.
+ */
+static ebpf_result_t
+_ebpf_core_stack_peek_or_pop(
+    _Inout_ ebpf_core_circular_map_t* map,
+    bool pop,
+    _Out_writes_bytes_(map->core_map.ebpf_map_definition.value_size) uint8_t* value)
+{
+    if (map->count == 0) {
+        return EBPF_OBJECT_NOT_FOUND;
     }
-    if (old_data) {
-        ebpf_epoch_free(old_data);
+    size_t top = (map->begin + map->count - 1) % map->core_map.ebpf_map_definition.max_entries;
+    memcpy(value, _ebpf_core_circular_map_slot(map, top)->value, map->core_map.ebpf_map_definition.value_size);
+    if (pop) {
+        map->count--;
+    }
+    return EBPF_SUCCESS;
+}
+
+/**
+ * @brief Add a value at the top of a stack. Caller must hold the map lock.
+ *
+ * @param[in, out] map Stack to push to.
+ * @param[in] data Value to push.
+ * @param[in] replace If the stack is full, remove the value at the bottom to make room.
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_OUT_OF_SPACE The stack is full and replace is false.
+ */
+static ebpf_result_t
+_ebpf_core_stack_push(_Inout_ ebpf_core_circular_map_t* map, _In_ const uint8_t* data, bool replace)
+{
+    if (map->count == map->core_map.ebpf_map_definition.max_entries) {
+        if (!replace) {
+            return EBPF_OUT_OF_SPACE;
+        }
+        map->begin = _ebpf_core_circular_map_add(map, map->begin, 1);
+        map->count--;
     }
-    return return_value;
+    size_t top = (map->begin + map->count) % map->core_map.ebpf_map_definition.max_entries;
+    memcpy(_ebpf_core_circular_map_slot(map, top)->value, data, map->core_map.ebpf_map_definition.value_size);
+    map->count++;
+    return EBPF_SUCCESS;
 }
 
 static ebpf_program_type_t
@@ -364,15 +563,24 @@ typedef struct _ebpf_map_metadata_table
     ebpf_result_t (*update_entry_per_cpu)(
         _Inout_ ebpf_core_map_t* map, _In_ const uint8_t* key, _In_ const uint8_t* value, ebpf_map_option_t option);
     ebpf_result_t (*delete_entry)(_Inout_ ebpf_core_map_t* map, _In_ const uint8_t* key);
+    ebpf_result_t (*peek_or_pop_entry)(
+        _Inout_ ebpf_core_map_t* map, bool pop, _Out_writes_bytes_(map->ebpf_map_definition.value_size) uint8_t* value);
     ebpf_result_t (*next_key_and_value)(
         _Inout_ ebpf_core_map_t* map,
         _In_ const uint8_t* previous_key,
         _Out_ uint8_t* next_key,
         _Inout_opt_ uint8_t** next_value);
+    ebpf_result_t (*iterate_entries)(
+        _In_ const ebpf_core_map_t* map,
+        _Inout_ uint64_t* cursor,
+        _Inout_ size_t* count,
+        _Out_writes_(*count) const uint8_t** keys,
+        _Out_writes_(*count) const uint8_t** values);
     int zero_length_key : 1;
     int zero_length_value : 1;
     int per_cpu : 1;
     int key_history : 1;
+    int update_in_place : 1; // The update_entry function honors BPF_F_LOCK.
 } ebpf_map_metadata_table_t;
 
 const ebpf_map_metadata_table_t ebpf_map_metadata_tables[];
@@ -383,6 +591,15 @@ ebpf_map_get_definition(_In_ const ebpf_map_t* map)
     return &map->ebpf_map_definition;
 }
 
+_Ret_maybenull_ uint8_t*
+ebpf_map_get_array_data(_In_ const ebpf_map_t* map)
+{
+    if (map->ebpf_map_definition.type != BPF_MAP_TYPE_ARRAY) {
+        return NULL;
+    }
+    return map->data;
+}
+
 uint32_t
 ebpf_map_get_effective_value_size(_In_ const ebpf_map_t* map)
 {
@@ -404,10 +621,16 @@ _create_array_map_with_map_struct_size(
         goto Done;
     }
 
-    size_t full_map_size;
-    retval = ebpf_safe_size_t_add(EBPF_PAD_CACHE(map_struct_size), map_data_size, &full_map_size);
-    if (retval != EBPF_SUCCESS) {
-        goto Done;
+    // Values of mmapable maps live in their own pages, so that the pages can be mapped into user mode without
+    // exposing the map structure.
+    bool mmapable = (map_definition->map_flags & BPF_F_MMAPABLE) != 0;
+
+    size_t full_map_size = EBPF_PAD_CACHE(map_struct_size);
+    if (!mmapable) {
+        retval = ebpf_safe_size_t_add(full_map_size, map_data_size, &full_map_size);
+        if (retval != EBPF_SUCCESS) {
+            goto Done;
+        }
     }
 
     local_map = ebpf_epoch_allocate_with_tag(full_map_size, EBPF_POOL_TAG_MAP);
@@ -418,7 +641,18 @@ _create_array_map_with_map_struct_size(
     memset(local_map, 0, full_map_size);
 
     local_map->ebpf_map_definition = *map_definition;
-    local_map->data = ((uint8_t*)local_map) + EBPF_PAD_CACHE(map_struct_size);
+    if (mmapable) {
+        local_map->data_memory = ebpf_map_memory(map_data_size);
+        if (local_map->data_memory == NULL) {
+            ebpf_epoch_free(local_map);
+            retval = EBPF_NO_MEMORY;
+            goto Done;
+        }
+        local_map->data = ebpf_memory_descriptor_get_base_address(local_map->data_memory);
+        memset(local_map->data, 0, map_data_size);
+    } else {
+        local_map->data = ((uint8_t*)local_map) + EBPF_PAD_CACHE(map_struct_size);
+    }
 
     *map = local_map;
 
@@ -426,21 +660,63 @@ Done:
     return retval;
 }
 
+static void
+_ebpf_map_free_data_memory(_Inout_ void* context)
+{
+    ebpf_unmap_memory((MDL*)context);
+}
+
 static ebpf_result_t
 _create_array_map(
     _In_ const ebpf_map_definition_in_memory_t* map_definition,
     ebpf_handle_t inner_map_handle,
     _Outptr_ ebpf_core_map_t** map)
 {
+    ebpf_result_t result;
+    ebpf_core_map_t* local_map = NULL;
+
     if (inner_map_handle != ebpf_handle_invalid) {
         return EBPF_INVALID_ARGUMENT;
     }
-    return _create_array_map_with_map_struct_size(sizeof(ebpf_core_map_t), map_definition, map);
+
+    if (!(map_definition->map_flags & BPF_F_MMAPABLE)) {
+        return _create_array_map_with_map_struct_size(sizeof(ebpf_core_map_t), map_definition, map);
+    }
+
+    result = _create_array_map_with_map_struct_size(sizeof(ebpf_core_mmap_array_map_t), map_definition, &local_map);
+    if (result != EBPF_SUCCESS) {
+        return result;
+    }
+
+    // Preallocate the work item that releases the pages, so that deleting the map can't fail.
+    ebpf_core_mmap_array_map_t* mmap_map = EBPF_FROM_FIELD(ebpf_core_mmap_array_map_t, core_map, local_map);
+    mmap_map->free_data_memory_work_item =
+        ebpf_epoch_allocate_work_item(local_map->data_memory, _ebpf_map_free_data_memory);
+    if (!mmap_map->free_data_memory_work_item) {
+        ebpf_unmap_memory(local_map->data_memory);
+        ebpf_epoch_free(local_map);
+        return EBPF_NO_MEMORY;
+    }
+    ebpf_lock_create(&mmap_map->lock);
+    ebpf_list_initialize(&mmap_map->user_mappings);
+
+    *map = local_map;
+    return EBPF_SUCCESS;
 }
 
 static void
 _delete_array_map(_In_ _Post_invalid_ ebpf_core_map_t* map)
 {
+    if (map->data_memory) {
+        ebpf_core_mmap_array_map_t* mmap_map = EBPF_FROM_FIELD(ebpf_core_mmap_array_map_t, core_map, map);
+
+        // Each user mapping holds a reference on the map, so none can remain.
+        ebpf_assert(ebpf_list_is_empty(&mmap_map->user_mappings));
+        ebpf_lock_destroy(&mmap_map->lock);
+
+        // Programs may still be accessing the values in the current epoch, so release the pages with the map.
+        ebpf_epoch_schedule_work_item(mmap_map->free_data_memory_work_item);
+    }
     ebpf_epoch_free(map);
 }
 
@@ -459,7 +735,7 @@ _find_array_map_entry(
         return EBPF_INVALID_ARGUMENT;
     }
 
-    *data = &map->data[key_value * map->ebpf_map_definition.value_size];
+    *data = &map->data[key_value * map->value_storage_size];
 
     return EBPF_SUCCESS;
 }
@@ -470,7 +746,8 @@ _update_array_map_entry(
 {
     uint32_t key_value;
 
-    if (!map || !key || (option == EBPF_NOEXIST)) {
+    // Array values are always updated in place, so BPF_F_LOCK doesn't change the behavior.
+    if (!map || !key || ((option & ~BPF_F_LOCK) == EBPF_NOEXIST)) {
         return EBPF_INVALID_ARGUMENT;
     }
 
@@ -480,11 +757,11 @@ _update_array_map_entry(
         return EBPF_INVALID_ARGUMENT;
     }
 
-    uint8_t* entry = &map->data[key_value * map->ebpf_map_definition.value_size];
+    uint8_t* entry = &map->data[key_value * map->value_storage_size];
     if (data) {
-        memcpy(entry, data, map->ebpf_map_definition.value_size);
+        memcpy(entry, data, map->value_storage_size);
     } else {
-        memset(entry, 0, map->ebpf_map_definition.value_size);
+        memset(entry, 0, map->value_storage_size);
     }
     return EBPF_SUCCESS;
 }
@@ -503,9 +780,9 @@ _delete_array_map_entry(_Inout_ ebpf_core_map_t* map, _In_ const uint8_t* key)
         return EBPF_INVALID_ARGUMENT;
     }
 
-    uint8_t* entry = &map->data[key_value * map->ebpf_map_definition.value_size];
+    uint8_t* entry = &map->data[key_value * map->value_storage_size];
 
-    memset(entry, 0, map->ebpf_map_definition.value_size);
+    memset(entry, 0, map->value_storage_size);
     return EBPF_SUCCESS;
 }
 
@@ -536,7 +813,7 @@ _next_array_map_key_and_value(
 
     // Copy the value of requested.
     if (value) {
-        *value = &map->data[key_value * map->ebpf_map_definition.value_size];
+        *value = &map->data[key_value * map->value_storage_size];
     }
 
     return EBPF_SUCCESS;
@@ -922,6 +1199,7 @@ _create_hash_map_internal(
     _In_ const ebpf_map_definition_in_memory_t* map_definition,
     size_t supplemental_value_size,
     bool fixed_size_map,
+    bool preallocate,
     _In_opt_ void (*extract_function)(
         _In_ const uint8_t* value, _Outptr_ const uint8_t** data, _Out_ size_t* length_in_bits),
     _In_opt_ ebpf_hash_table_notification_function notification_callback,
@@ -940,15 +1218,21 @@ _create_hash_map_internal(
     local_map->ebpf_map_definition = *map_definition;
     local_map->data = NULL;
 
+    // Start small and let the table grow towards one bucket per entry as the map fills. Preallocated tables aren't
+    // resized, so they start with one bucket per entry.
     const ebpf_hash_table_creation_options_t options = {
         .key_size = local_map->ebpf_map_definition.key_size,
         .value_size = local_map->ebpf_map_definition.value_size,
-        .minimum_bucket_count = local_map->ebpf_map_definition.max_entries,
+        .minimum_bucket_count = preallocate ? local_map->ebpf_map_definition.max_entries
+                                            : min(local_map->ebpf_map_definition.max_entries,
+                                                  EBPF_HASH_TABLE_DEFAULT_BUCKET_COUNT),
+        .maximum_bucket_count = local_map->ebpf_map_definition.max_entries,
         .max_entries = fixed_size_map ? local_map->ebpf_map_definition.max_entries : EBPF_HASH_TABLE_NO_LIMIT,
         .extract_function = extract_function,
         .supplemental_value_size = supplemental_value_size,
         .notification_context = local_map,
         .notification_callback = notification_callback,
+        .preallocated_entries = preallocate ? local_map->ebpf_map_definition.max_entries : 0,
     };
 
     // Note:
@@ -984,7 +1268,9 @@ _create_hash_map(
     if (inner_map_handle != ebpf_handle_invalid) {
         return EBPF_INVALID_ARGUMENT;
     }
-    return _create_hash_map_internal(sizeof(ebpf_core_map_t), map_definition, 0, false, NULL, NULL, map);
+    // Hash maps reserve storage for max_entries entries up front unless the caller opts out.
+    bool preallocate = !(map_definition->map_flags & BPF_F_NO_PREALLOC);
+    return _create_hash_map_internal(sizeof(ebpf_core_map_t), map_definition, 0, false, preallocate, NULL, NULL, map);
 }
 
 static void
@@ -1033,8 +1319,8 @@ _create_object_hash_map(
 
     *map = NULL;
 
-    result =
-        _create_hash_map_internal(sizeof(ebpf_core_object_map_t), map_definition, 0, false, NULL, NULL, &local_map);
+    result = _create_hash_map_internal(
+        sizeof(ebpf_core_object_map_t), map_definition, 0, false, false, NULL, NULL, &local_map);
     if (result != EBPF_SUCCESS) {
         goto Exit;
     }
@@ -1067,7 +1353,7 @@ Exit:
 static uint8_t*
 _get_supplemental_value(_In_ const ebpf_core_map_t* map, _In_ uint8_t* value)
 {
-    return value + EBPF_PAD_8(map->ebpf_map_definition.value_size);
+    return value + EBPF_PAD_8(map->value_storage_size);
 }
 
 /**
@@ -1319,6 +1605,7 @@ _create_lru_hash_map(
         map_definition,
         supplemental_value_size,
         true,
+        false,
         NULL,
         _lru_hash_table_notification,
         (ebpf_core_map_t**)&lru_map);
@@ -1534,12 +1821,16 @@ _update_hash_map_entry(
         return EBPF_INVALID_ARGUMENT;
     }
 
-    switch (option) {
+    // BPF_F_LOCK overwrites the value of an existing key in place rather than replacing the bucket and value.
+    bool update_in_place = (option & BPF_F_LOCK) != 0;
+
+    switch (option & ~BPF_F_LOCK) {
     case EBPF_ANY:
         hash_table_operation = EBPF_HASH_TABLE_OPERATION_ANY;
         break;
     case EBPF_NOEXIST:
         hash_table_operation = EBPF_HASH_TABLE_OPERATION_INSERT;
+        update_in_place = false;
         break;
     case EBPF_EXIST:
         hash_table_operation = EBPF_HASH_TABLE_OPERATION_REPLACE;
@@ -1548,6 +1839,15 @@ _update_hash_map_entry(
         return EBPF_INVALID_ARGUMENT;
     }
 
+    if (update_in_place) {
+        result = ebpf_hash_table_update(
+            (ebpf_hash_table_t*)map->data, key, data, EBPF_HASH_TABLE_OPERATION_REPLACE_IN_PLACE);
+        // Fall back to inserting the key if it isn't present and the caller allows insertion.
+        if (result != EBPF_KEY_NOT_FOUND || hash_table_operation == EBPF_HASH_TABLE_OPERATION_REPLACE) {
+            return result;
+        }
+    }
+
     // If the map is full, try to delete the oldest entry and try again.
     // Repeat while the insert fails with EBPF_NO_MEMORY.
     for (;;) {
@@ -1719,21 +2019,109 @@ _next_hash_map_key_and_value(
     return result;
 }
 
+static ebpf_result_t
+_iterate_hash_map_entries(
+    _In_ const ebpf_core_map_t* map,
+    _Inout_ uint64_t* cursor,
+    _Inout_ size_t* count,
+    _Out_writes_(*count) const uint8_t** keys,
+    _Out_writes_(*count) const uint8_t** values)
+{
+    ebpf_result_t result;
+    size_t position = (size_t)*cursor;
+
+    result = ebpf_hash_table_iterate((ebpf_hash_table_t*)map->data, &position, count, keys, values);
+    if (result == EBPF_SUCCESS) {
+        *cursor = position;
+    }
+    return result;
+}
+
 static ebpf_result_t
 _ebpf_adjust_value_pointer(_In_ const ebpf_map_t* map, _Inout_ uint8_t** value)
 {
     uint32_t current_cpu;
 
-    if (!(ebpf_map_metadata_tables[map->ebpf_map_definition.type].per_cpu)) {
+    if (!map->per_cpu_value_stride) {
         return EBPF_SUCCESS;
     }
 
     current_cpu = ebpf_get_current_cpu();
 
-    (*value) += EBPF_PAD_8((size_t)map->original_value_size) * current_cpu;
+    (*value) += (size_t)map->per_cpu_value_stride * current_cpu;
     return EBPF_SUCCESS;
 }
 
+/**
+ * @brief Compute the distance between the slots of consecutive CPUs in the storage of a per-CPU value. Slots are
+ * packed 8 bytes apart unless the map was created with BPF_F_PERCPU_CACHE_ALIGN. Then values smaller than a cache
+ * line get a cache line per CPU, so CPUs updating their own slot don't contend for the same cache line. Larger values
+ * already span lines of their own and keep the packed layout.
+ *
+ * @param[in] value_size Size of the value of one CPU.
+ * @param[in] map_flags Flags the map was created with.
+ * @return Distance in bytes between the slots of consecutive CPUs.
+ */
+static uint32_t
+_ebpf_map_per_cpu_value_stride(uint32_t value_size, uint32_t map_flags)
+{
+    uint32_t packed_stride = EBPF_PAD_8(value_size);
+    if (!(map_flags & BPF_F_PERCPU_CACHE_ALIGN)) {
+        return packed_stride;
+    }
+    return (packed_stride < EBPF_CACHE_LINE_SIZE) ? EBPF_CACHE_LINE_SIZE : packed_stride;
+}
+
+/**
+ * @brief Copy a value from map storage into the layout exchanged with user mode. Per-CPU values are packed, with the
+ * slot of each CPU starting EBPF_PAD_8(value size) bytes after the slot of the previous CPU.
+ *
+ * @param[in] map Map the value belongs to.
+ * @param[out] destination Buffer to hold the value in the user mode layout.
+ * @param[in] source Value in map storage.
+ */
+static void
+_ebpf_map_copy_value_to_user(
+    _In_ const ebpf_core_map_t* map,
+    _Out_writes_bytes_(map->ebpf_map_definition.value_size) uint8_t* destination,
+    _In_reads_bytes_(map->value_storage_size) const uint8_t* source)
+{
+    size_t packed_stride = EBPF_PAD_8((size_t)map->original_value_size);
+    if (!map->per_cpu_value_stride || map->per_cpu_value_stride == packed_stride) {
+        memcpy(destination, source, map->ebpf_map_definition.value_size);
+        return;
+    }
+    uint32_t cpu_count = ebpf_get_cpu_count();
+    for (uint32_t cpu = 0; cpu < cpu_count; cpu++) {
+        memcpy(destination + cpu * packed_stride, source + (size_t)cpu * map->per_cpu_value_stride, packed_stride);
+    }
+}
+
+/**
+ * @brief Copy a value in the layout exchanged with user mode into the layout of map storage. Padding between the
+ * slots of a per-CPU value is left unchanged.
+ *
+ * @param[in] map Map the value belongs to.
+ * @param[in, out] destination Value in map storage.
+ * @param[in] source Value in the user mode layout.
+ */
+static void
+_ebpf_map_copy_value_from_user(
+    _In_ const ebpf_core_map_t* map,
+    _Inout_updates_bytes_(map->value_storage_size) uint8_t* destination,
+    _In_reads_bytes_(map->ebpf_map_definition.value_size) const uint8_t* source)
+{
+    size_t packed_stride = EBPF_PAD_8((size_t)map->original_value_size);
+    if (!map->per_cpu_value_stride || map->per_cpu_value_stride == packed_stride) {
+        memcpy(destination, source, map->ebpf_map_definition.value_size);
+        return;
+    }
+    uint32_t cpu_count = ebpf_get_cpu_count();
+    for (uint32_t cpu = 0; cpu < cpu_count; cpu++) {
+        memcpy(destination + (size_t)cpu * map->per_cpu_value_stride, source + cpu * packed_stride, packed_stride);
+    }
+}
+
 /**
  * @brief Insert the supplied value into the per-cpu value buffer of the map.
  * If the map doesn't contain an existing value, create a new all-zero value,
@@ -1773,14 +2161,6 @@ _update_entry_per_cpu(
     return EBPF_SUCCESS;
 }
 
-static void
-_lpm_extract(_In_ const uint8_t* value, _Outptr_ const uint8_t** data, _Out_ size_t* length_in_bits)
-{
-    uint32_t prefix_length = *(uint32_t*)value;
-    *data = value;
-    *length_in_bits = sizeof(uint32_t) * 8 + prefix_length;
-}
-
 static ebpf_result_t
 _create_lpm_map(
     _In_ const ebpf_map_definition_in_memory_t* map_definition,
@@ -1788,8 +2168,7 @@ _create_lpm_map(
     _Outptr_ ebpf_core_map_t** map)
 {
     ebpf_result_t result = EBPF_SUCCESS;
-    size_t max_prefix_length = (map_definition->key_size - sizeof(uint32_t)) * 8 + 1;
-    ebpf_core_lpm_map_t* lpm_map = NULL;
+    ebpf_core_map_t* lpm_map = NULL;
 
     EBPF_LOG_ENTRY();
 
@@ -1800,26 +2179,36 @@ _create_lpm_map(
         goto Exit;
     }
 
-    result = _create_hash_map_internal(
-        EBPF_OFFSET_OF(ebpf_core_lpm_map_t, data) + ebpf_bitmap_size(max_prefix_length),
-        map_definition,
-        0,
-        false,
-        _lpm_extract,
-        NULL,
-        (ebpf_core_map_t**)&lpm_map);
+    lpm_map = ebpf_epoch_allocate_with_tag(sizeof(ebpf_core_map_t), EBPF_POOL_TAG_MAP);
+    if (lpm_map == NULL) {
+        result = EBPF_NO_MEMORY;
+        goto Exit;
+    }
+
+    lpm_map->ebpf_map_definition = *map_definition;
+    lpm_map->data = NULL;
+
+    result = ebpf_lpm_trie_create(
+        (ebpf_lpm_trie_t**)&lpm_map->data, map_definition->key_size, map_definition->value_size);
     if (result != EBPF_SUCCESS) {
         goto Exit;
     }
-    lpm_map->max_prefix = (uint32_t)max_prefix_length;
-    ebpf_bitmap_initialize((ebpf_bitmap_t*)lpm_map->data, max_prefix_length);
 
-    *map = &lpm_map->core_map;
+    *map = lpm_map;
+    lpm_map = NULL;
 
 Exit:
+    ebpf_epoch_free(lpm_map);
     EBPF_RETURN_RESULT(result);
 }
 
+static void
+_delete_lpm_map(_In_ _Post_invalid_ ebpf_core_map_t* map)
+{
+    ebpf_lpm_trie_destroy((ebpf_lpm_trie_t*)map->data);
+    ebpf_epoch_free(map);
+}
+
 static ebpf_result_t
 _find_lpm_map_entry(
     _Inout_ ebpf_core_map_t* map, _In_opt_ const uint8_t* key, bool delete_on_success, _Outptr_ uint8_t** data)
@@ -1828,120 +2217,161 @@ _find_lpm_map_entry(
         return EBPF_INVALID_ARGUMENT;
     }
 
-    uint32_t* prefix_length = (uint32_t*)key;
-    uint32_t original_prefix_length = *prefix_length;
-    uint8_t* value = NULL;
-    ebpf_core_lpm_map_t* trie_map = EBPF_FROM_FIELD(ebpf_core_lpm_map_t, core_map, map);
-
-    ebpf_bitmap_cursor_t cursor;
-    ebpf_bitmap_start_reverse_search((ebpf_bitmap_t*)trie_map->data, &cursor);
-    while (*prefix_length != MAXUINT32) {
-        *prefix_length = (uint32_t)ebpf_bitmap_reverse_search_next_bit(&cursor);
-        if (_find_hash_map_entry(map, key, false, &value) == EBPF_SUCCESS) {
-            break;
-        }
-    }
-    *prefix_length = original_prefix_length;
-
-    if (!value) {
-        return EBPF_KEY_NOT_FOUND;
-    } else {
-        *data = value;
-        return EBPF_SUCCESS;
-    }
+    return ebpf_lpm_trie_find((ebpf_lpm_trie_t*)map->data, key, data);
 }
 
 static ebpf_result_t
-_delete_lpm_map_entry(_In_ ebpf_core_map_t* map, _Inout_ const uint8_t* key)
+_delete_lpm_map_entry(_Inout_ ebpf_core_map_t* map, _In_ const uint8_t* key)
 {
-    ebpf_core_lpm_map_t* trie_map = EBPF_FROM_FIELD(ebpf_core_lpm_map_t, core_map, map);
-    uint32_t prefix_length = *(uint32_t*)key;
-    if (prefix_length > trie_map->max_prefix) {
+    if (!map || !key) {
         return EBPF_INVALID_ARGUMENT;
     }
 
-    return _delete_hash_map_entry(map, key);
+    return ebpf_lpm_trie_delete((ebpf_lpm_trie_t*)map->data, key);
 }
 
 static ebpf_result_t
 _update_lpm_map_entry(
     _Inout_ ebpf_core_map_t* map, _In_opt_ const uint8_t* key, _In_opt_ const uint8_t* data, ebpf_map_option_t option)
 {
-    ebpf_core_lpm_map_t* trie_map = EBPF_FROM_FIELD(ebpf_core_lpm_map_t, core_map, map);
-    if (!key) {
+    ebpf_lpm_trie_operations_t trie_operation;
+
+    if (!map || !key) {
         return EBPF_INVALID_ARGUMENT;
     }
-    uint32_t prefix_length = *(uint32_t*)key;
-    if (prefix_length > trie_map->max_prefix) {
+
+    switch (option) {
+    case EBPF_ANY:
+        trie_operation = EBPF_LPM_TRIE_OPERATION_ANY;
+        break;
+    case EBPF_NOEXIST:
+        trie_operation = EBPF_LPM_TRIE_OPERATION_INSERT;
+        break;
+    case EBPF_EXIST:
+        trie_operation = EBPF_LPM_TRIE_OPERATION_REPLACE;
+        break;
+    default:
         return EBPF_INVALID_ARGUMENT;
     }
 
-    ebpf_result_t result = _update_hash_map_entry(map, key, data, option);
-    if (result == EBPF_SUCCESS) {
-        // Test if the bit is set before setting it. This avoids the overhead of a the interlocked operation.
-        if (!ebpf_bitmap_test_bit((ebpf_bitmap_t*)trie_map->data, prefix_length)) {
-            ebpf_bitmap_set_bit((ebpf_bitmap_t*)trie_map->data, prefix_length, true);
-        }
-    }
-    return result;
+    return ebpf_lpm_trie_update((ebpf_lpm_trie_t*)map->data, key, data, trie_operation);
 }
 
 static ebpf_result_t
-_create_queue_map(
-    _In_ const ebpf_map_definition_in_memory_t* map_definition,
-    ebpf_handle_t inner_map_handle,
-    _Outptr_ ebpf_core_map_t** map)
+_next_lpm_map_key_and_value(
+    _Inout_ ebpf_core_map_t* map,
+    _In_opt_ const uint8_t* previous_key,
+    _Out_ uint8_t* next_key,
+    _Inout_opt_ uint8_t** next_value)
 {
-    ebpf_result_t result;
-    if (inner_map_handle != ebpf_handle_invalid || map_definition->key_size != 0) {
+    if (!map || !next_key) {
         return EBPF_INVALID_ARGUMENT;
     }
-    size_t circular_map_size =
-        EBPF_OFFSET_OF(ebpf_core_circular_map_t, slots) + map_definition->max_entries * sizeof(uint8_t*);
-    result = _create_array_map_with_map_struct_size(circular_map_size, map_definition, map);
-    if (result == EBPF_SUCCESS) {
-        ebpf_core_circular_map_t* circular_map = EBPF_FROM_FIELD(ebpf_core_circular_map_t, core_map, *map);
-        circular_map->type = EBPF_CORE_QUEUE;
-    }
-    return result;
+
+    return ebpf_lpm_trie_next_key_and_value((ebpf_lpm_trie_t*)map->data, previous_key, next_key, next_value);
 }
 
 static ebpf_result_t
-_create_stack_map(
+_create_circular_map(
     _In_ const ebpf_map_definition_in_memory_t* map_definition,
     ebpf_handle_t inner_map_handle,
+    int type,
     _Outptr_ ebpf_core_map_t** map)
 {
     ebpf_result_t result;
-    if (inner_map_handle != ebpf_handle_invalid || map_definition->key_size != 0) {
+    size_t slot_size;
+    size_t slots_size;
+    size_t full_map_size;
+    ebpf_core_circular_map_t* circular_map = NULL;
+
+    *map = NULL;
+
+    if (inner_map_handle != ebpf_handle_invalid || map_definition->key_size != 0 || map_definition->max_entries == 0) {
         return EBPF_INVALID_ARGUMENT;
     }
-    size_t circular_map_size =
-        EBPF_OFFSET_OF(ebpf_core_circular_map_t, slots) + map_definition->max_entries * sizeof(uint8_t*);
-    result = _create_array_map_with_map_struct_size(circular_map_size, map_definition, map);
-    if (result == EBPF_SUCCESS) {
-        ebpf_core_circular_map_t* circular_map = EBPF_FROM_FIELD(ebpf_core_circular_map_t, core_map, *map);
-        circular_map->type = EBPF_CORE_STACK;
+
+    slot_size = EBPF_PAD_8(EBPF_OFFSET_OF(ebpf_core_circular_map_slot_t, value) + (size_t)map_definition->value_size);
+    result = ebpf_safe_size_t_multiply(map_definition->max_entries, slot_size, &slots_size);
+    if (result != EBPF_SUCCESS) {
+        return result;
     }
-    return result;
+    result = ebpf_safe_size_t_add(EBPF_PAD_CACHE(sizeof(ebpf_core_circular_map_t)), slots_size, &full_map_size);
+    if (result != EBPF_SUCCESS) {
+        return result;
+    }
+
+    circular_map = ebpf_epoch_allocate_with_tag(full_map_size, EBPF_POOL_TAG_MAP);
+    if (circular_map == NULL) {
+        return EBPF_NO_MEMORY;
+    }
+    memset(circular_map, 0, full_map_size);
+
+    circular_map->core_map.ebpf_map_definition = *map_definition;
+    circular_map->core_map.data = ((uint8_t*)circular_map) + EBPF_PAD_CACHE(sizeof(ebpf_core_circular_map_t));
+    circular_map->type = type;
+    circular_map->slot_size = slot_size;
+
+    // The slot at index N is free for the producer at position N.
+    for (size_t index = 0; index < map_definition->max_entries; index++) {
+        _ebpf_core_circular_map_slot(circular_map, index)->sequence = (int64_t)index;
+    }
+
+    *map = &circular_map->core_map;
+    return EBPF_SUCCESS;
+}
+
+static ebpf_result_t
+_create_queue_map(
+    _In_ const ebpf_map_definition_in_memory_t* map_definition,
+    ebpf_handle_t inner_map_handle,
+    _Outptr_ ebpf_core_map_t** map)
+{
+    return _create_circular_map(map_definition, inner_map_handle, EBPF_CORE_QUEUE, map);
+}
+
+static ebpf_result_t
+_create_stack_map(
+    _In_ const ebpf_map_definition_in_memory_t* map_definition,
+    ebpf_handle_t inner_map_handle,
+    _Outptr_ ebpf_core_map_t** map)
+{
+    return _create_circular_map(map_definition, inner_map_handle, EBPF_CORE_STACK, map);
 }
 
 static void
 _delete_circular_map(_In_ _Post_invalid_ ebpf_core_map_t* map)
 {
     ebpf_core_circular_map_t* circular_map = EBPF_FROM_FIELD(ebpf_core_circular_map_t, core_map, map);
-    // Free all the elements stored in the stack.
-    for (size_t i = 0; i < circular_map->core_map.ebpf_map_definition.max_entries; i++) {
-        ebpf_epoch_free(circular_map->slots[i]);
-    }
     ebpf_epoch_free(circular_map);
 }
 
 static ebpf_result_t
-_find_circular_map_entry(
-    _Inout_ ebpf_core_map_t* map, _In_opt_ const uint8_t* key, bool delete_on_success, _Outptr_ uint8_t** data)
+_peek_or_pop_circular_map_entry(
+    _Inout_ ebpf_core_map_t* map, bool pop, _Out_writes_bytes_(map->ebpf_map_definition.value_size) uint8_t* value)
+{
+    ebpf_result_t result;
+    ebpf_core_circular_map_t* circular_map = EBPF_FROM_FIELD(ebpf_core_circular_map_t, core_map, map);
+
+    if (circular_map->type == EBPF_CORE_QUEUE) {
+        // Stay on this CPU until the operation completes, so a consumer isn't preempted while it owns a slot.
+        uint8_t old_irql = ebpf_raise_irql(DISPATCH_LEVEL);
+        result = pop ? _ebpf_core_queue_pop(circular_map, value) : _ebpf_core_queue_peek(circular_map, value);
+        ebpf_lower_irql(old_irql);
+    } else {
+        ebpf_lock_state_t state = ebpf_lock_lock(&circular_map->lock);
+        result = _ebpf_core_stack_peek_or_pop(circular_map, pop, value);
+        ebpf_lock_unlock(&circular_map->lock, state);
+    }
+    return result;
+}
+
+static ebpf_result_t
+_update_circular_map_entry(
+    _Inout_ ebpf_core_map_t* map, _In_opt_ const uint8_t* key, _In_opt_ const uint8_t* data, ebpf_map_option_t option)
 {
-    if (!map) {
+    ebpf_result_t result;
+
+    if (!map || !data) {
         return EBPF_INVALID_ARGUMENT;
     }
 
@@ -1950,83 +2380,352 @@ _find_circular_map_entry(
     UNREFERENCED_PARAMETER(key);
 
     ebpf_core_circular_map_t* circular_map = EBPF_FROM_FIELD(ebpf_core_circular_map_t, core_map, map);
-    ebpf_lock_state_t state = ebpf_lock_lock(&circular_map->lock);
-    *data = _ebpf_core_circular_map_peek_or_pop(circular_map, delete_on_success);
-    ebpf_lock_unlock(&circular_map->lock, state);
-    return *data == NULL ? EBPF_OBJECT_NOT_FOUND : EBPF_SUCCESS;
+    if (circular_map->type == EBPF_CORE_QUEUE) {
+        // Stay on this CPU until the operation completes, so a producer isn't preempted while it owns a slot.
+        uint8_t old_irql = ebpf_raise_irql(DISPATCH_LEVEL);
+        result = _ebpf_core_queue_push(circular_map, data, option & BPF_EXIST);
+        ebpf_lower_irql(old_irql);
+    } else {
+        ebpf_lock_state_t state = ebpf_lock_lock(&circular_map->lock);
+        result = _ebpf_core_stack_push(circular_map, data, option & BPF_EXIST);
+        ebpf_lock_unlock(&circular_map->lock, state);
+    }
+    return result;
 }
 
 static ebpf_result_t
-_update_circular_map_entry(
-    _Inout_ ebpf_core_map_t* map, _In_opt_ const uint8_t* key, _In_opt_ const uint8_t* data, ebpf_map_option_t option)
+_create_bloom_filter_map(
+    _In_ const ebpf_map_definition_in_memory_t* map_definition,
+    ebpf_handle_t inner_map_handle,
+    _Outptr_ ebpf_core_map_t** map)
 {
     ebpf_result_t result;
+    ebpf_core_bloom_filter_map_t* bloom_filter_map = NULL;
+    uint64_t hash_count =
+        map_definition->map_extra ? map_definition->map_extra : EBPF_BLOOM_FILTER_DEFAULT_HASH_COUNT;
+    uint64_t bit_count;
+    size_t block_count = 1;
+    size_t map_size;
+
+    EBPF_LOG_ENTRY();
+
+    *map = NULL;
+
+    if (inner_map_handle != ebpf_handle_invalid || map_definition->key_size != 0) {
+        result = EBPF_INVALID_ARGUMENT;
+        goto Exit;
+    }
+    if (hash_count > EBPF_BLOOM_FILTER_MAX_HASH_COUNT) {
+        EBPF_LOG_MESSAGE_UINT64(
+            EBPF_TRACELOG_LEVEL_ERROR, EBPF_TRACELOG_KEYWORD_MAP, "Unsupported bloom filter hash count", hash_count);
+        result = EBPF_INVALID_ARGUMENT;
+        goto Exit;
+    }
 
+    // An optimal filter needs hash_count / ln(2) bits per value. Round up to a
+    // power of two blocks so a block is selected with a mask.
+    bit_count = ((uint64_t)map_definition->max_entries * hash_count * 10 + 6) / 7;
+    while ((uint64_t)block_count * EBPF_BLOOM_FILTER_BITS_PER_BLOCK < bit_count) {
+        block_count <<= 1;
+    }
+
+    result = ebpf_safe_size_t_multiply(block_count, sizeof(ebpf_bloom_filter_block_t), &map_size);
+    if (result != EBPF_SUCCESS) {
+        goto Exit;
+    }
+    // Leave room to align the first block to a cache line.
+    result = ebpf_safe_size_t_add(
+        EBPF_OFFSET_OF(ebpf_core_bloom_filter_map_t, block_storage) + EBPF_CACHE_LINE_SIZE, map_size, &map_size);
+    if (result != EBPF_SUCCESS) {
+        goto Exit;
+    }
+
+    bloom_filter_map = ebpf_epoch_allocate_with_tag(map_size, EBPF_POOL_TAG_MAP);
+    if (bloom_filter_map == NULL) {
+        result = EBPF_NO_MEMORY;
+        goto Exit;
+    }
+    memset(bloom_filter_map, 0, map_size);
+
+    bloom_filter_map->core_map.ebpf_map_definition = *map_definition;
+    bloom_filter_map->core_map.data = (uint8_t*)EBPF_PAD_CACHE((uintptr_t)bloom_filter_map->block_storage);
+    bloom_filter_map->seed = ebpf_random_uint32();
+    bloom_filter_map->hash_count = (uint32_t)hash_count;
+    bloom_filter_map->block_mask = (uint32_t)(block_count - 1);
+
+    *map = &bloom_filter_map->core_map;
+
+Exit:
+    EBPF_RETURN_RESULT(result);
+}
+
+static void
+_delete_bloom_filter_map(_In_ _Post_invalid_ ebpf_core_map_t* map)
+{
+    ebpf_epoch_free(EBPF_FROM_FIELD(ebpf_core_bloom_filter_map_t, core_map, map));
+}
+
+/**
+ * @brief Hash a value into the block that holds its bits and the seed for the
+ * bit positions within that block.
+ *
+ * @param[in] bloom_filter_map Bloom filter map the value belongs to.
+ * @param[in] value Value to hash.
+ * @param[out] bit_hash Hash used to derive the bit positions of the value.
+ * @return Block that holds the bits of the value.
+ */
+static ebpf_bloom_filter_block_t*
+_ebpf_bloom_filter_get_block(
+    _In_ const ebpf_core_bloom_filter_map_t* bloom_filter_map, _In_ const uint8_t* value, _Out_ uint32_t* bit_hash)
+{
+    const uint64_t multiplier = 0x9e3779b97f4a7c15ULL;
+    size_t length = bloom_filter_map->core_map.ebpf_map_definition.value_size;
+    uint64_t hash = bloom_filter_map->seed ^ (length * multiplier);
+    size_t index;
+
+    for (index = 0; index + sizeof(uint64_t) <= length; index += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, value + index, sizeof(word));
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+    }
+    if (index < length) {
+        uint64_t word = 0;
+        memcpy(&word, value + index, length - index);
+        hash = (hash ^ word) * multiplier;
+    }
+
+    // Finish with the murmur3 64-bit mixer so every input bit affects both halves.
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+
+    *bit_hash = (uint32_t)hash;
+    return (ebpf_bloom_filter_block_t*)bloom_filter_map->core_map.data +
+           ((uint32_t)(hash >> 32) & bloom_filter_map->block_mask);
+}
+
+/**
+ * @brief Get the position of the n-th bit of a value within its block. The
+ * positions are derived from one hash by double hashing with an odd step, so
+ * the positions of a value are distinct.
+ */
+#define EBPF_BLOOM_FILTER_BIT(bit_hash, n) \
+    (((bit_hash) + (n) * (((bit_hash) >> 9) | 1)) & (EBPF_BLOOM_FILTER_BITS_PER_BLOCK - 1))
+
+static ebpf_result_t
+_test_bloom_filter_map_entry(_In_ const ebpf_core_map_t* map, _In_ const uint8_t* value)
+{
+    const ebpf_core_bloom_filter_map_t* bloom_filter_map =
+        EBPF_FROM_FIELD(ebpf_core_bloom_filter_map_t, core_map, map);
+    uint32_t bit_hash;
+    const ebpf_bloom_filter_block_t* block = _ebpf_bloom_filter_get_block(bloom_filter_map, value, &bit_hash);
+
+    for (uint32_t i = 0; i < bloom_filter_map->hash_count; i++) {
+        uint32_t bit = EBPF_BLOOM_FILTER_BIT(bit_hash, i);
+        if (!(block->bits[bit / 64] & ((int64_t)1 << (bit % 64)))) {
+            return EBPF_KEY_NOT_FOUND;
+        }
+    }
+    return EBPF_SUCCESS;
+}
+
+static ebpf_result_t
+_update_bloom_filter_map_entry(
+    _Inout_ ebpf_core_map_t* map, _In_opt_ const uint8_t* key, _In_opt_ const uint8_t* data, ebpf_map_option_t option)
+{
     if (!map || !data) {
         return EBPF_INVALID_ARGUMENT;
     }
 
-    // Queue uses no key, but the caller always passes in a non-null pointer (with a 0 key size)
+    // Bloom filter uses no key, but the caller always passes in a non-null pointer (with a 0 key size)
     // so we cannot require key to be null.
     UNREFERENCED_PARAMETER(key);
 
-    ebpf_core_circular_map_t* circular_map = EBPF_FROM_FIELD(ebpf_core_circular_map_t, core_map, map);
-    ebpf_lock_state_t state = ebpf_lock_lock(&circular_map->lock);
-    result = _ebpf_core_circular_map_push(circular_map, data, option & BPF_EXIST);
-    ebpf_lock_unlock(&circular_map->lock, state);
-    return result;
+    if (option & (BPF_NOEXIST | BPF_EXIST)) {
+        return EBPF_INVALID_ARGUMENT;
+    }
+
+    ebpf_core_bloom_filter_map_t* bloom_filter_map = EBPF_FROM_FIELD(ebpf_core_bloom_filter_map_t, core_map, map);
+    uint32_t bit_hash;
+    ebpf_bloom_filter_block_t* block = _ebpf_bloom_filter_get_block(bloom_filter_map, data, &bit_hash);
+
+    for (uint32_t i = 0; i < bloom_filter_map->hash_count; i++) {
+        uint32_t bit = EBPF_BLOOM_FILTER_BIT(bit_hash, i);
+        int64_t mask = (int64_t)1 << (bit % 64);
+        // Only write bits that are clear, so pushing a value that is already
+        // present doesn't take the cache line exclusive.
+        if (!(block->bits[bit / 64] & mask)) {
+            ebpf_interlocked_or_int64(&block->bits[bit / 64], mask);
+        }
+    }
+    return EBPF_SUCCESS;
+}
+
+static _Must_inspect_result_ ebpf_result_t
+_ebpf_core_ring_initialize(_Out_ ebpf_core_ring_t* ring, size_t capacity)
+{
+    memset(ring, 0, sizeof(*ring));
+    ebpf_list_initialize(&ring->async_contexts);
+    return ebpf_ring_buffer_create(&ring->ring_buffer, capacity);
+}
+
+static void
+_ebpf_core_ring_uninitialize(_Inout_ ebpf_core_ring_t* ring)
+{
+    // Free the ring buffer.
+    ebpf_ring_buffer_destroy(ring->ring_buffer);
+    ring->ring_buffer = NULL;
+
+    // Snap the async context list.
+    ebpf_list_entry_t temp_list;
+    ebpf_list_initialize(&temp_list);
+    ebpf_lock_state_t state = ebpf_lock_lock(&ring->lock);
+    ebpf_list_entry_t* first_entry = ring->async_contexts.Flink;
+    if (!ebpf_list_is_empty(&ring->async_contexts)) {
+        ebpf_list_remove_entry(&ring->async_contexts);
+        ebpf_list_append_tail_list(&temp_list, first_entry);
+    }
+    ebpf_lock_unlock(&ring->lock, state);
+    // Cancel all pending async query operations.
+    for (ebpf_list_entry_t* temp_entry = temp_list.Flink; temp_entry != &temp_list; temp_entry = temp_entry->Flink) {
+        ebpf_core_ring_async_query_context_t* context =
+            EBPF_FROM_FIELD(ebpf_core_ring_async_query_context_t, entry, temp_entry);
+        ebpf_async_complete(context->async_context, 0, EBPF_CANCELED);
+    }
 }
 
-static _Requires_lock_held_(ring_buffer_map->lock) void _ebpf_ring_buffer_map_signal_async_query_complete(
-    _Inout_ ebpf_core_ring_buffer_map_t* ring_buffer_map)
+static _Requires_lock_held_(ring->lock) void _ebpf_core_ring_signal_async_query_complete(
+    _Inout_ ebpf_core_ring_t* ring)
 {
     EBPF_LOG_ENTRY();
     // Skip if no async_contexts have ever been queued.
-    if (!ring_buffer_map->async_contexts_trip_wire) {
+    if (!ring->async_contexts_trip_wire) {
         return;
     }
 
-    ebpf_core_map_t* map = &ring_buffer_map->core_map;
-    while (!ebpf_list_is_empty(&ring_buffer_map->async_contexts)) {
-        ebpf_core_ring_buffer_map_async_query_context_t* context = EBPF_FROM_FIELD(
-            ebpf_core_ring_buffer_map_async_query_context_t, entry, ring_buffer_map->async_contexts.Flink);
+    while (!ebpf_list_is_empty(&ring->async_contexts)) {
+        ebpf_core_ring_async_query_context_t* context =
+            EBPF_FROM_FIELD(ebpf_core_ring_async_query_context_t, entry, ring->async_contexts.Flink);
         ebpf_ring_buffer_map_async_query_result_t* async_query_result = context->async_query_result;
-        ebpf_ring_buffer_query(
-            (ebpf_ring_buffer_t*)map->data, &async_query_result->consumer, &async_query_result->producer);
+        ebpf_ring_buffer_query(ring->ring_buffer, &async_query_result->consumer, &async_query_result->producer);
+        if (context->lost_count) {
+            *context->lost_count = (uint64_t)ring->lost_count;
+        }
         ebpf_list_remove_entry(&context->entry);
-        ebpf_operation_ring_buffer_map_async_query_reply_t* reply =
-            EBPF_FROM_FIELD(ebpf_operation_ring_buffer_map_async_query_reply_t, async_query_result, async_query_result);
-        ebpf_async_complete(context->async_context, sizeof(*reply), EBPF_SUCCESS);
+        ebpf_async_complete(context->async_context, context->reply_length, EBPF_SUCCESS);
         ebpf_free(context);
         context = NULL;
     }
 }
 
+static _Must_inspect_result_ ebpf_result_t
+_ebpf_core_ring_output(_Inout_ ebpf_core_ring_t* ring, _In_reads_bytes_(length) uint8_t* data, size_t length)
+{
+    ebpf_result_t result = ebpf_ring_buffer_output(ring->ring_buffer, data, length);
+    if (result != EBPF_SUCCESS) {
+        if (result == EBPF_OUT_OF_SPACE) {
+            ebpf_interlocked_increment_int64(&ring->lost_count);
+        }
+        return result;
+    }
+
+    // Space for the record was claimed with an interlocked operation, so an async query queued after this check
+    // observes the new producer offset and completes on its own. Only take the lock if a query is waiting.
+    if (ring->async_contexts_trip_wire && !ebpf_list_is_empty(&ring->async_contexts)) {
+        ebpf_lock_state_t state = ebpf_lock_lock(&ring->lock);
+        _ebpf_core_ring_signal_async_query_complete(ring);
+        ebpf_lock_unlock(&ring->lock, state);
+    }
+    return EBPF_SUCCESS;
+}
+
 static void
-_delete_ring_buffer_map(_In_ _Post_invalid_ ebpf_core_map_t* map)
+_ebpf_core_ring_cancel_async_query(_In_ _Frees_ptr_ void* cancel_context)
 {
     EBPF_LOG_ENTRY();
-    // Free the ring buffer.
-    ebpf_ring_buffer_destroy((ebpf_ring_buffer_t*)map->data);
+    ebpf_core_ring_async_query_context_t* context = (ebpf_core_ring_async_query_context_t*)cancel_context;
+    ebpf_core_ring_t* ring = context->ring;
+    ebpf_lock_state_t state = ebpf_lock_lock(&ring->lock);
+    ebpf_list_remove_entry(&context->entry);
+    ebpf_lock_unlock(&ring->lock, state);
+    ebpf_async_complete(context->async_context, 0, EBPF_CANCELED);
+    ebpf_free(context);
+    EBPF_LOG_EXIT();
+}
 
-    ebpf_core_ring_buffer_map_t* ring_buffer_map = EBPF_FROM_FIELD(ebpf_core_ring_buffer_map_t, core_map, map);
-    // Snap the async context list.
-    ebpf_list_entry_t temp_list;
-    ebpf_list_initialize(&temp_list);
-    ebpf_lock_state_t state = ebpf_lock_lock(&ring_buffer_map->lock);
-    ebpf_list_entry_t* first_entry = ring_buffer_map->async_contexts.Flink;
-    if (!ebpf_list_is_empty(&ring_buffer_map->async_contexts)) {
-        ebpf_list_remove_entry(&ring_buffer_map->async_contexts);
-        ebpf_list_append_tail_list(&temp_list, first_entry);
+static _Must_inspect_result_ ebpf_result_t
+_ebpf_core_ring_return_buffer(_Inout_ ebpf_core_ring_t* ring, size_t consumer_offset)
+{
+    size_t producer_offset;
+    size_t old_consumer_offset;
+    size_t consumed_data_length;
+    ebpf_ring_buffer_query(ring->ring_buffer, &old_consumer_offset, &producer_offset);
+    ebpf_result_t result = ebpf_safe_size_t_subtract(consumer_offset, old_consumer_offset, &consumed_data_length);
+    if (result != EBPF_SUCCESS) {
+        return result;
     }
-    ebpf_lock_unlock(&ring_buffer_map->lock, state);
-    // Cancel all pending async query operations.
-    for (ebpf_list_entry_t* temp_entry = temp_list.Flink; temp_entry != &temp_list; temp_entry = temp_entry->Flink) {
-        ebpf_core_ring_buffer_map_async_query_context_t* context =
-            EBPF_FROM_FIELD(ebpf_core_ring_buffer_map_async_query_context_t, entry, temp_entry);
-        ebpf_async_complete(context->async_context, 0, EBPF_CANCELED);
+    return ebpf_ring_buffer_return(ring->ring_buffer, consumed_data_length);
+}
+
+static _Must_inspect_result_ ebpf_result_t
+_ebpf_core_ring_async_query(
+    _Inout_ ebpf_core_ring_t* ring,
+    _Inout_ ebpf_ring_buffer_map_async_query_result_t* async_query_result,
+    _Out_opt_ uint64_t* lost_count,
+    size_t reply_length,
+    _Inout_ void* async_context)
+{
+    ebpf_result_t result = EBPF_PENDING;
+    ebpf_lock_state_t state = ebpf_lock_lock(&ring->lock);
+
+    // Fail the async query as there is already another async query operation queued.
+    if (!ebpf_list_is_empty(&ring->async_contexts)) {
+        result = EBPF_INVALID_ARGUMENT;
+        goto Exit;
+    }
+
+    // Allocate and initialize the async query context and queue it up.
+    ebpf_core_ring_async_query_context_t* context =
+        ebpf_allocate_with_tag(sizeof(ebpf_core_ring_async_query_context_t), EBPF_POOL_TAG_ASYNC);
+    if (!context) {
+        result = EBPF_NO_MEMORY;
+        goto Exit;
+    }
+    ebpf_list_initialize(&context->entry);
+    context->ring = ring;
+    context->async_query_result = async_query_result;
+    context->lost_count = lost_count;
+    context->reply_length = reply_length;
+    context->async_context = async_context;
+
+    ebpf_assert_success(ebpf_async_set_cancel_callback(async_context, context, _ebpf_core_ring_cancel_async_query));
+
+    ebpf_list_insert_tail(&ring->async_contexts, &context->entry);
+    ring->async_contexts_trip_wire = true;
+
+    // If there is already some data available in the ring buffer, indicate the results right away.
+    ebpf_ring_buffer_query(ring->ring_buffer, &async_query_result->consumer, &async_query_result->producer);
+
+    if (async_query_result->producer != async_query_result->consumer) {
+        _ebpf_core_ring_signal_async_query_complete(ring);
     }
+
+Exit:
+    ebpf_lock_unlock(&ring->lock, state);
+    return result;
+}
+
+static void
+_delete_ring_buffer_map(_In_ _Post_invalid_ ebpf_core_map_t* map)
+{
+    EBPF_LOG_ENTRY();
+    ebpf_core_ring_buffer_map_t* ring_buffer_map = EBPF_FROM_FIELD(ebpf_core_ring_buffer_map_t, core_map, map);
+    _ebpf_core_ring_uninitialize(&ring_buffer_map->ring);
     ebpf_epoch_free(ring_buffer_map);
+    EBPF_LOG_EXIT();
 }
 
 static ebpf_result_t
@@ -2037,7 +2736,6 @@ _create_ring_buffer_map(
 {
     ebpf_result_t result;
     ebpf_core_ring_buffer_map_t* ring_buffer_map = NULL;
-    ebpf_ring_buffer_t* ring_buffer = NULL;
 
     EBPF_LOG_ENTRY();
 
@@ -2056,22 +2754,20 @@ _create_ring_buffer_map(
     memset(ring_buffer_map, 0, sizeof(ebpf_core_ring_buffer_map_t));
 
     ring_buffer_map->core_map.ebpf_map_definition = *map_definition;
-    result =
-        ebpf_ring_buffer_create((ebpf_ring_buffer_t**)&ring_buffer_map->core_map.data, map_definition->max_entries);
+    result = _ebpf_core_ring_initialize(&ring_buffer_map->ring, map_definition->max_entries);
     if (result != EBPF_SUCCESS) {
         goto Exit;
     }
-    ring_buffer = (ebpf_ring_buffer_t*)ring_buffer_map->core_map.data;
-
-    ebpf_list_initialize(&ring_buffer_map->async_contexts);
+    ring_buffer_map->core_map.data = (uint8_t*)ring_buffer_map->ring.ring_buffer;
 
     *map = &ring_buffer_map->core_map;
-    ring_buffer = NULL;
     ring_buffer_map = NULL;
 
 Exit:
-    ebpf_ring_buffer_destroy(ring_buffer);
-    ebpf_epoch_free(ring_buffer_map);
+    if (ring_buffer_map) {
+        ebpf_ring_buffer_destroy(ring_buffer_map->ring.ring_buffer);
+        ebpf_epoch_free(ring_buffer_map);
+    }
 
     EBPF_RETURN_RESULT(result);
 }
@@ -2083,109 +2779,218 @@ ebpf_ring_buffer_map_output(_Inout_ ebpf_core_map_t* map, _In_reads_bytes_(lengt
 
     EBPF_LOG_ENTRY();
 
-    result = ebpf_ring_buffer_output((ebpf_ring_buffer_t*)map->data, data, length);
+    ebpf_core_ring_buffer_map_t* ring_buffer_map = EBPF_FROM_FIELD(ebpf_core_ring_buffer_map_t, core_map, map);
+    result = _ebpf_core_ring_output(&ring_buffer_map->ring, data, length);
+
+    EBPF_RETURN_RESULT(result);
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_ring_buffer_map_query_buffer(_In_ const ebpf_map_t* map, _Outptr_ uint8_t** buffer, _Out_ size_t* consumer_offset)
+{
+    size_t producer_offset;
+    ebpf_ring_buffer_query((ebpf_ring_buffer_t*)map->data, consumer_offset, &producer_offset);
+    return ebpf_ring_buffer_map_buffer((ebpf_ring_buffer_t*)map->data, buffer);
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_ring_buffer_map_query_offsets(
+    _In_ const ebpf_map_t* map,
+    _Outptr_ const ebpf_ring_buffer_producer_page_t** producer_page,
+    _Outptr_ ebpf_ring_buffer_consumer_page_t** consumer_page)
+{
+    return ebpf_ring_buffer_map_offsets((ebpf_ring_buffer_t*)map->data, producer_page, consumer_page);
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_ring_buffer_map_return_buffer(_In_ const ebpf_map_t* map, size_t consumer_offset)
+{
+    EBPF_LOG_ENTRY();
+    ebpf_core_ring_buffer_map_t* ring_buffer_map = EBPF_FROM_FIELD(ebpf_core_ring_buffer_map_t, core_map, map);
+    ebpf_result_t result = _ebpf_core_ring_return_buffer(&ring_buffer_map->ring, consumer_offset);
+    EBPF_RETURN_RESULT(result);
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_ring_buffer_map_async_query(
+    _Inout_ ebpf_map_t* map,
+    _Inout_ ebpf_ring_buffer_map_async_query_result_t* async_query_result,
+    _Inout_ void* async_context)
+{
+    EBPF_LOG_ENTRY();
+
+    ebpf_core_ring_buffer_map_t* ring_buffer_map = EBPF_FROM_FIELD(ebpf_core_ring_buffer_map_t, core_map, map);
+    ebpf_result_t result = _ebpf_core_ring_async_query(
+        &ring_buffer_map->ring,
+        async_query_result,
+        NULL,
+        sizeof(ebpf_operation_ring_buffer_map_async_query_reply_t),
+        async_context);
+
+    EBPF_RETURN_RESULT(result);
+}
+
+static void
+_delete_perf_event_array_map(_In_ _Post_invalid_ ebpf_core_map_t* map)
+{
+    EBPF_LOG_ENTRY();
+    ebpf_core_perf_event_array_map_t* perf_event_array_map =
+        EBPF_FROM_FIELD(ebpf_core_perf_event_array_map_t, core_map, map);
+    for (uint32_t i = 0; i < perf_event_array_map->ring_count; i++) {
+        _ebpf_core_ring_uninitialize(&perf_event_array_map->rings[i]);
+    }
+    ebpf_epoch_free(perf_event_array_map);
+    EBPF_LOG_EXIT();
+}
+
+static ebpf_result_t
+_create_perf_event_array_map(
+    _In_ const ebpf_map_definition_in_memory_t* map_definition,
+    ebpf_handle_t inner_map_handle,
+    _Outptr_ ebpf_core_map_t** map)
+{
+    ebpf_result_t result;
+    ebpf_core_perf_event_array_map_t* perf_event_array_map = NULL;
+    uint32_t cpu_count = ebpf_get_cpu_count();
+    size_t map_size;
+
+    EBPF_LOG_ENTRY();
+
+    *map = NULL;
+
+    if (inner_map_handle != ebpf_handle_invalid || map_definition->key_size != 0) {
+        result = EBPF_INVALID_ARGUMENT;
+        goto Exit;
+    }
+
+    result = ebpf_safe_size_t_multiply(sizeof(ebpf_core_ring_t), cpu_count, &map_size);
+    if (result != EBPF_SUCCESS) {
+        goto Exit;
+    }
+    result = ebpf_safe_size_t_add(EBPF_OFFSET_OF(ebpf_core_perf_event_array_map_t, rings), map_size, &map_size);
     if (result != EBPF_SUCCESS) {
         goto Exit;
     }
 
-    ebpf_core_ring_buffer_map_t* ring_buffer_map = EBPF_FROM_FIELD(ebpf_core_ring_buffer_map_t, core_map, map);
+    perf_event_array_map = ebpf_epoch_allocate_with_tag(map_size, EBPF_POOL_TAG_MAP);
+    if (perf_event_array_map == NULL) {
+        result = EBPF_NO_MEMORY;
+        goto Exit;
+    }
+    memset(perf_event_array_map, 0, map_size);
+
+    perf_event_array_map->core_map.ebpf_map_definition = *map_definition;
+
+    // Each CPU gets a ring buffer of max_entries bytes.
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        result = _ebpf_core_ring_initialize(&perf_event_array_map->rings[i], map_definition->max_entries);
+        if (result != EBPF_SUCCESS) {
+            goto Exit;
+        }
+        perf_event_array_map->ring_count++;
+    }
+
+    *map = &perf_event_array_map->core_map;
+    perf_event_array_map = NULL;
+
+Exit:
+    if (perf_event_array_map) {
+        _delete_perf_event_array_map(&perf_event_array_map->core_map);
+    }
+
+    EBPF_RETURN_RESULT(result);
+}
+
+static _Ret_maybenull_ ebpf_core_ring_t*
+_ebpf_perf_event_array_map_get_ring(_In_ const ebpf_map_t* map, uint32_t cpu_id)
+{
+    ebpf_core_perf_event_array_map_t* perf_event_array_map =
+        EBPF_FROM_FIELD(ebpf_core_perf_event_array_map_t, core_map, map);
+    if (cpu_id >= perf_event_array_map->ring_count) {
+        return NULL;
+    }
+    return &perf_event_array_map->rings[cpu_id];
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_perf_event_array_map_output(
+    _Inout_ ebpf_map_t* map, uint64_t flags, _In_reads_bytes_(length) uint8_t* data, size_t length)
+{
+    ebpf_result_t result;
+    uint32_t cpu_id = ebpf_get_current_cpu();
+    uint64_t index = flags & BPF_F_INDEX_MASK;
+
+    if (map->ebpf_map_definition.type != BPF_MAP_TYPE_PERF_EVENT_ARRAY) {
+        return EBPF_INVALID_ARGUMENT;
+    }
 
-    ebpf_lock_state_t state = ebpf_lock_lock(&ring_buffer_map->lock);
-    _ebpf_ring_buffer_map_signal_async_query_complete(ring_buffer_map);
-    ebpf_lock_unlock(&ring_buffer_map->lock, state);
+    // Programs can only write to the buffer of the CPU they are running on.
+    if ((flags & ~BPF_F_INDEX_MASK) || (index != BPF_F_CURRENT_CPU && index != cpu_id)) {
+        return EBPF_INVALID_ARGUMENT;
+    }
 
-Exit:
-    EBPF_RETURN_RESULT(result);
-}
+    ebpf_core_ring_t* ring = _ebpf_perf_event_array_map_get_ring(map, cpu_id);
+    if (!ring) {
+        return EBPF_INVALID_ARGUMENT;
+    }
 
-static void
-_ebpf_ring_buffer_map_cancel_async_query(_In_ _Frees_ptr_ void* cancel_context)
-{
-    EBPF_LOG_ENTRY();
-    ebpf_core_ring_buffer_map_async_query_context_t* context =
-        (ebpf_core_ring_buffer_map_async_query_context_t*)cancel_context;
-    ebpf_core_ring_buffer_map_t* ring_buffer_map = context->ring_buffer_map;
-    ebpf_lock_state_t state = ebpf_lock_lock(&ring_buffer_map->lock);
-    ebpf_list_remove_entry(&context->entry);
-    ebpf_lock_unlock(&ring_buffer_map->lock, state);
-    ebpf_async_complete(context->async_context, 0, EBPF_CANCELED);
-    ebpf_free(context);
-    EBPF_LOG_EXIT();
+    // The program may be preempted and resume on another CPU before the record is written. The ring buffer allows
+    // concurrent producers, so the record is still written safely to the ring of the CPU it started on.
+    result = _ebpf_core_ring_output(ring, data, length);
+    return result;
 }
 
 _Must_inspect_result_ ebpf_result_t
-ebpf_ring_buffer_map_query_buffer(_In_ const ebpf_map_t* map, _Outptr_ uint8_t** buffer, _Out_ size_t* consumer_offset)
+ebpf_perf_event_array_map_query_buffer(
+    _In_ const ebpf_map_t* map, uint32_t cpu_id, _Outptr_ uint8_t** buffer, _Out_ size_t* consumer_offset)
 {
     size_t producer_offset;
-    ebpf_ring_buffer_query((ebpf_ring_buffer_t*)map->data, consumer_offset, &producer_offset);
-    return ebpf_ring_buffer_map_buffer((ebpf_ring_buffer_t*)map->data, buffer);
+    ebpf_core_ring_t* ring = _ebpf_perf_event_array_map_get_ring(map, cpu_id);
+    if (!ring) {
+        *buffer = NULL;
+        *consumer_offset = 0;
+        return EBPF_INVALID_ARGUMENT;
+    }
+    ebpf_ring_buffer_query(ring->ring_buffer, consumer_offset, &producer_offset);
+    return ebpf_ring_buffer_map_buffer(ring->ring_buffer, buffer);
 }
 
 _Must_inspect_result_ ebpf_result_t
-ebpf_ring_buffer_map_return_buffer(_In_ const ebpf_map_t* map, size_t consumer_offset)
+ebpf_perf_event_array_map_return_buffer(_In_ const ebpf_map_t* map, uint32_t cpu_id, size_t consumer_offset)
 {
-    size_t producer_offset;
-    size_t old_consumer_offset;
-    size_t consumed_data_length;
     EBPF_LOG_ENTRY();
-    ebpf_ring_buffer_query((ebpf_ring_buffer_t*)map->data, &old_consumer_offset, &producer_offset);
-    ebpf_result_t result = ebpf_safe_size_t_subtract(consumer_offset, old_consumer_offset, &consumed_data_length);
-    if (result != EBPF_SUCCESS) {
+    ebpf_result_t result;
+    ebpf_core_ring_t* ring = _ebpf_perf_event_array_map_get_ring(map, cpu_id);
+    if (!ring) {
+        result = EBPF_INVALID_ARGUMENT;
         goto Exit;
     }
-    result = ebpf_ring_buffer_return((ebpf_ring_buffer_t*)map->data, consumed_data_length);
+    result = _ebpf_core_ring_return_buffer(ring, consumer_offset);
 Exit:
     EBPF_RETURN_RESULT(result);
 }
 
 _Must_inspect_result_ ebpf_result_t
-ebpf_ring_buffer_map_async_query(
+ebpf_perf_event_array_map_async_query(
     _Inout_ ebpf_map_t* map,
-    _Inout_ ebpf_ring_buffer_map_async_query_result_t* async_query_result,
+    uint32_t cpu_id,
+    _Inout_ ebpf_perf_event_array_map_async_query_result_t* async_query_result,
     _Inout_ void* async_context)
 {
-    ebpf_result_t result = EBPF_PENDING;
     EBPF_LOG_ENTRY();
-
-    ebpf_core_ring_buffer_map_t* ring_buffer_map = EBPF_FROM_FIELD(ebpf_core_ring_buffer_map_t, core_map, map);
-
-    ebpf_lock_state_t state = ebpf_lock_lock(&ring_buffer_map->lock);
-
-    // Fail the async query as there is already another async query operation queued.
-    if (!ebpf_list_is_empty(&ring_buffer_map->async_contexts)) {
+    ebpf_result_t result;
+    ebpf_core_ring_t* ring = _ebpf_perf_event_array_map_get_ring(map, cpu_id);
+    if (!ring) {
         result = EBPF_INVALID_ARGUMENT;
         goto Exit;
     }
-
-    // Allocate and initialize the async query context and queue it up.
-    ebpf_core_ring_buffer_map_async_query_context_t* context =
-        ebpf_allocate_with_tag(sizeof(ebpf_core_ring_buffer_map_async_query_context_t), EBPF_POOL_TAG_ASYNC);
-    if (!context) {
-        result = EBPF_NO_MEMORY;
-        goto Exit;
-    }
-    ebpf_list_initialize(&context->entry);
-    context->ring_buffer_map = ring_buffer_map;
-    context->async_query_result = async_query_result;
-    context->async_context = async_context;
-
-    ebpf_assert_success(
-        ebpf_async_set_cancel_callback(async_context, context, _ebpf_ring_buffer_map_cancel_async_query));
-
-    ebpf_list_insert_tail(&ring_buffer_map->async_contexts, &context->entry);
-    ring_buffer_map->async_contexts_trip_wire = true;
-
-    // If there is already some data available in the ring buffer, indicate the results right away.
-    ebpf_ring_buffer_query(
-        (ebpf_ring_buffer_t*)map->data, &async_query_result->consumer, &async_query_result->producer);
-
-    if (async_query_result->producer != async_query_result->consumer) {
-        _ebpf_ring_buffer_map_signal_async_query_complete(ring_buffer_map);
-    }
-
+    result = _ebpf_core_ring_async_query(
+        ring,
+        &async_query_result->ring_buffer,
+        &async_query_result->lost_count,
+        sizeof(ebpf_operation_perf_event_array_map_async_query_reply_t),
+        async_context);
 Exit:
-    ebpf_lock_unlock(&ring_buffer_map->lock, state);
-
     EBPF_RETURN_RESULT(result);
 }
 
@@ -2202,6 +3007,8 @@ const ebpf_map_metadata_table_t ebpf_map_metadata_tables[] = {
         .update_entry = _update_hash_map_entry,
         .delete_entry = _delete_hash_map_entry,
         .next_key_and_value = _next_hash_map_key_and_value,
+        .iterate_entries = _iterate_hash_map_entries,
+        .update_in_place = true,
     },
     {
         .map_type = BPF_MAP_TYPE_ARRAY,
@@ -2211,6 +3018,7 @@ const ebpf_map_metadata_table_t ebpf_map_metadata_tables[] = {
         .update_entry = _update_array_map_entry,
         .delete_entry = _delete_array_map_entry,
         .next_key_and_value = _next_array_map_key_and_value,
+        .update_in_place = true,
     },
     {
         .map_type = BPF_MAP_TYPE_PROG_ARRAY,
@@ -2232,7 +3040,9 @@ const ebpf_map_metadata_table_t ebpf_map_metadata_tables[] = {
         .update_entry_per_cpu = _update_entry_per_cpu,
         .delete_entry = _delete_hash_map_entry,
         .next_key_and_value = _next_hash_map_key_and_value,
+        .iterate_entries = _iterate_hash_map_entries,
         .per_cpu = true,
+        .update_in_place = true,
     },
     {
         .map_type = BPF_MAP_TYPE_PERCPU_ARRAY,
@@ -2244,6 +3054,7 @@ const ebpf_map_metadata_table_t ebpf_map_metadata_tables[] = {
         .delete_entry = _delete_array_map_entry,
         .next_key_and_value = _next_array_map_key_and_value,
         .per_cpu = true,
+        .update_in_place = true,
     },
     {
         .map_type = BPF_MAP_TYPE_HASH_OF_MAPS,
@@ -2254,6 +3065,7 @@ const ebpf_map_metadata_table_t ebpf_map_metadata_tables[] = {
         .update_entry_with_handle = _update_map_hash_map_entry_with_handle,
         .delete_entry = _delete_map_hash_map_entry,
         .next_key_and_value = _next_hash_map_key_and_value,
+        .iterate_entries = _iterate_hash_map_entries,
     },
     {
         .map_type = BPF_MAP_TYPE_ARRAY_OF_MAPS,
@@ -2273,24 +3085,25 @@ const ebpf_map_metadata_table_t ebpf_map_metadata_tables[] = {
         .update_entry = _update_hash_map_entry,
         .delete_entry = _delete_hash_map_entry,
         .next_key_and_value = _next_hash_map_key_and_value,
+        .iterate_entries = _iterate_hash_map_entries,
         .key_history = true,
+        .update_in_place = true,
     },
-    // LPM_TRIE is currently a hash-map with special behavior for find.
     {
         .map_type = BPF_MAP_TYPE_LPM_TRIE,
         .create_map = _create_lpm_map,
-        .delete_map = _delete_hash_map,
+        .delete_map = _delete_lpm_map,
         .find_entry = _find_lpm_map_entry,
         .update_entry = _update_lpm_map_entry,
         .delete_entry = _delete_lpm_map_entry,
-        .next_key_and_value = _next_hash_map_key_and_value,
+        .next_key_and_value = _next_lpm_map_key_and_value,
     },
     {
         .map_type = BPF_MAP_TYPE_QUEUE,
         .create_map = _create_queue_map,
         .delete_map = _delete_circular_map,
-        .find_entry = _find_circular_map_entry,
         .update_entry = _update_circular_map_entry,
+        .peek_or_pop_entry = _peek_or_pop_circular_map_entry,
         .zero_length_key = true,
     },
     {
@@ -2302,15 +3115,17 @@ const ebpf_map_metadata_table_t ebpf_map_metadata_tables[] = {
         .update_entry_per_cpu = _update_entry_per_cpu,
         .delete_entry = _delete_hash_map_entry,
         .next_key_and_value = _next_hash_map_key_and_value,
+        .iterate_entries = _iterate_hash_map_entries,
         .per_cpu = true,
         .key_history = true,
+        .update_in_place = true,
     },
     {
         .map_type = BPF_MAP_TYPE_STACK,
         .create_map = _create_stack_map,
         .delete_map = _delete_circular_map,
-        .find_entry = _find_circular_map_entry,
         .update_entry = _update_circular_map_entry,
+        .peek_or_pop_entry = _peek_or_pop_circular_map_entry,
         .zero_length_key = true,
     },
     {
@@ -2320,6 +3135,21 @@ const ebpf_map_metadata_table_t ebpf_map_metadata_tables[] = {
         .zero_length_key = true,
         .zero_length_value = true,
     },
+    {
+        BPF_MAP_TYPE_PERF_EVENT_ARRAY,
+        .create_map = _create_perf_event_array_map,
+        .delete_map = _delete_perf_event_array_map,
+        .zero_length_key = true,
+        .zero_length_value = true,
+    },
+    {
+        // Bloom filter values are tested by ebpf_map_peek_entry and ebpf_map_find_entry directly.
+        .map_type = BPF_MAP_TYPE_BLOOM_FILTER,
+        .create_map = _create_bloom_filter_map,
+        .delete_map = _delete_bloom_filter_map,
+        .update_entry = _update_bloom_filter_map_entry,
+        .zero_length_key = true,
+    },
 };
 
 static void
@@ -2369,9 +3199,45 @@ ebpf_map_create(
         result = EBPF_INVALID_ARGUMENT;
         goto Exit;
     }
+    if (ebpf_map_definition->map_flags & ~EBPF_MAP_SUPPORTED_FLAGS) {
+        EBPF_LOG_MESSAGE_UINT64(
+            EBPF_TRACELOG_LEVEL_ERROR,
+            EBPF_TRACELOG_KEYWORD_MAP,
+            "Unsupported map flags",
+            ebpf_map_definition->map_flags);
+        result = EBPF_INVALID_ARGUMENT;
+        goto Exit;
+    }
+    if ((ebpf_map_definition->map_flags & BPF_F_MMAPABLE) && type != BPF_MAP_TYPE_ARRAY) {
+        EBPF_LOG_MESSAGE_UINT64(
+            EBPF_TRACELOG_LEVEL_ERROR, EBPF_TRACELOG_KEYWORD_MAP, "BPF_F_MMAPABLE not supported on map", type);
+        result = EBPF_INVALID_ARGUMENT;
+        goto Exit;
+    }
+    if ((ebpf_map_definition->map_flags & BPF_F_PERCPU_CACHE_ALIGN) && !ebpf_map_metadata_tables[type].per_cpu) {
+        EBPF_LOG_MESSAGE_UINT64(
+            EBPF_TRACELOG_LEVEL_ERROR,
+            EBPF_TRACELOG_KEYWORD_MAP,
+            "BPF_F_PERCPU_CACHE_ALIGN not supported on map",
+            type);
+        result = EBPF_INVALID_ARGUMENT;
+        goto Exit;
+    }
+    if (ebpf_map_definition->map_extra != 0 && type != BPF_MAP_TYPE_BLOOM_FILTER) {
+        EBPF_LOG_MESSAGE_UINT64(
+            EBPF_TRACELOG_LEVEL_ERROR,
+            EBPF_TRACELOG_KEYWORD_MAP,
+            "Unsupported map extra",
+            ebpf_map_definition->map_extra);
+        result = EBPF_INVALID_ARGUMENT;
+        goto Exit;
+    }
 
+    // Per-CPU maps are created with room for the value of every CPU. User mode exchanges the values packed, which
+    // is the value size recorded in the map definition, but map storage may space the values further apart.
     if (ebpf_map_metadata_tables[type].per_cpu) {
-        local_map_definition.value_size = cpu_count * EBPF_PAD_8(local_map_definition.value_size);
+        local_map_definition.value_size =
+            cpu_count * _ebpf_map_per_cpu_value_stride(local_map_definition.value_size, local_map_definition.map_flags);
     }
 
     if (map_name->length >= BPF_OBJ_NAME_LEN) {
@@ -2393,6 +3259,12 @@ ebpf_map_create(
     }
 
     local_map->original_value_size = ebpf_map_definition->value_size;
+    local_map->value_storage_size = local_map_definition.value_size;
+    if (ebpf_map_metadata_tables[type].per_cpu) {
+        local_map->per_cpu_value_stride =
+            _ebpf_map_per_cpu_value_stride(ebpf_map_definition->value_size, ebpf_map_definition->map_flags);
+        local_map->ebpf_map_definition.value_size = cpu_count * EBPF_PAD_8(ebpf_map_definition->value_size);
+    }
 
     result = ebpf_duplicate_utf8_string(&local_map->name, map_name);
     if (result != EBPF_SUCCESS) {
@@ -2417,6 +3289,30 @@ Exit:
     EBPF_RETURN_RESULT(result);
 }
 
+/**
+ * @brief Check that the contents of a map can be changed.
+ *
+ * @param[in] map Map to check.
+ * @retval EBPF_SUCCESS The map can be changed.
+ * @retval EBPF_ACCESS_DENIED The map is frozen.
+ */
+static inline ebpf_result_t
+_ebpf_map_check_not_frozen(_In_ const ebpf_core_map_t* map)
+{
+    if (map->frozen) {
+        EBPF_LOG_MESSAGE_UINT64(
+            EBPF_TRACELOG_LEVEL_ERROR, EBPF_TRACELOG_KEYWORD_MAP, "Map is frozen", map->ebpf_map_definition.type);
+        return EBPF_ACCESS_DENIED;
+    }
+    return EBPF_SUCCESS;
+}
+
+void
+ebpf_map_freeze(_Inout_ ebpf_map_t* map)
+{
+    map->frozen = true;
+}
+
 _Must_inspect_result_ ebpf_result_t
 ebpf_map_find_entry(
     _Inout_ ebpf_map_t* map,
@@ -2428,6 +3324,35 @@ ebpf_map_find_entry(
 {
     // High volume call - Skip entry/exit logging.
     uint8_t* return_value = NULL;
+    if ((flags & EBPF_MAP_FIND_FLAG_DELETE) && map->frozen) {
+        return _ebpf_map_check_not_frozen(map);
+    }
+    if (map->ebpf_map_definition.type == BPF_MAP_TYPE_BLOOM_FILTER) {
+        // A bloom filter has no keys. User mode passes the value to test in the key.
+        if (flags & (EBPF_MAP_FLAG_HELPER | EBPF_MAP_FIND_FLAG_DELETE)) {
+            return EBPF_OPERATION_NOT_SUPPORTED;
+        }
+        if (key_size != map->ebpf_map_definition.value_size || value_size != key_size) {
+            return EBPF_INVALID_ARGUMENT;
+        }
+        ebpf_result_t result = _test_bloom_filter_map_entry(map, key);
+        if (result == EBPF_SUCCESS) {
+            // The key and value buffers can be the same buffer.
+            memmove(value, key, value_size);
+        }
+        return result;
+    }
+    if (ebpf_map_metadata_tables[map->ebpf_map_definition.type].peek_or_pop_entry) {
+        // Queues and stacks copy values out, as a slot can be reused as soon as its value is popped.
+        if (flags & EBPF_MAP_FLAG_HELPER) {
+            return EBPF_OPERATION_NOT_SUPPORTED;
+        }
+        if (value_size != map->ebpf_map_definition.value_size) {
+            return EBPF_INVALID_ARGUMENT;
+        }
+        return ebpf_map_metadata_tables[map->ebpf_map_definition.type].peek_or_pop_entry(
+            map, flags & EBPF_MAP_FIND_FLAG_DELETE ? true : false, value);
+    }
     if (!(flags & EBPF_MAP_FLAG_HELPER) && (key_size != map->ebpf_map_definition.key_size)) {
         EBPF_LOG_MESSAGE_UINT64_UINT64(
             EBPF_TRACELOG_LEVEL_ERROR,
@@ -2489,7 +3414,7 @@ ebpf_map_find_entry(
 
         *(uint8_t**)value = return_value;
     } else {
-        memcpy(value, return_value, map->ebpf_map_definition.value_size);
+        _ebpf_map_copy_value_to_user(map, value, return_value);
     }
     return EBPF_SUCCESS;
 }
@@ -2583,9 +3508,35 @@ ebpf_map_update_entry(
         return EBPF_OPERATION_NOT_SUPPORTED;
     }
 
+    if ((option & BPF_F_LOCK) && !ebpf_map_metadata_tables[map->ebpf_map_definition.type].update_in_place) {
+        EBPF_LOG_MESSAGE_UINT64(
+            EBPF_TRACELOG_LEVEL_ERROR,
+            EBPF_TRACELOG_KEYWORD_MAP,
+            "BPF_F_LOCK not supported on map",
+            map->ebpf_map_definition.type);
+        return EBPF_INVALID_ARGUMENT;
+    }
+
+    result = _ebpf_map_check_not_frozen(map);
+    if (result != EBPF_SUCCESS) {
+        return result;
+    }
+
     if ((flags & EBPF_MAP_FLAG_HELPER) &&
         ebpf_map_metadata_tables[map->ebpf_map_definition.type].update_entry_per_cpu) {
         result = ebpf_map_metadata_tables[map->ebpf_map_definition.type].update_entry_per_cpu(map, key, value, option);
+    } else if (!(flags & EBPF_MAP_FLAG_HELPER) && map->value_storage_size != map->ebpf_map_definition.value_size) {
+        // Insert a zeroed value, then copy the slot of each CPU from the packed user mode layout into it.
+        uint8_t* target;
+        result = ebpf_map_metadata_tables[map->ebpf_map_definition.type].update_entry(map, key, NULL, option);
+        if (result != EBPF_SUCCESS) {
+            return result;
+        }
+        if (ebpf_map_metadata_tables[map->ebpf_map_definition.type].find_entry(map, key, false, &target) !=
+            EBPF_SUCCESS) {
+            return EBPF_NO_MEMORY;
+        }
+        _ebpf_map_copy_value_from_user(map, target, value);
     } else {
         result = ebpf_map_metadata_tables[map->ebpf_map_definition.type].update_entry(map, key, value, option);
     }
@@ -2619,6 +3570,21 @@ ebpf_map_update_entry_with_handle(
             map->ebpf_map_definition.type);
         return EBPF_OPERATION_NOT_SUPPORTED;
     }
+
+    // Maps of object references are never updated in place.
+    if (option & BPF_F_LOCK) {
+        EBPF_LOG_MESSAGE_UINT64(
+            EBPF_TRACELOG_LEVEL_ERROR,
+            EBPF_TRACELOG_KEYWORD_MAP,
+            "BPF_F_LOCK not supported on map",
+            map->ebpf_map_definition.type);
+        return EBPF_INVALID_ARGUMENT;
+    }
+
+    ebpf_result_t result = _ebpf_map_check_not_frozen(map);
+    if (result != EBPF_SUCCESS) {
+        return result;
+    }
     return ebpf_map_metadata_tables[map->ebpf_map_definition.type].update_entry_with_handle(
         map, key, value_handle, option);
 }
@@ -2646,7 +3612,12 @@ ebpf_map_delete_entry(_In_ ebpf_map_t* map, size_t key_size, _In_reads_(key_size
         return EBPF_OPERATION_NOT_SUPPORTED;
     }
 
-    ebpf_result_t result = ebpf_map_metadata_tables[map->ebpf_map_definition.type].delete_entry(map, key);
+    ebpf_result_t result = _ebpf_map_check_not_frozen(map);
+    if (result != EBPF_SUCCESS) {
+        return result;
+    }
+
+    result = ebpf_map_metadata_tables[map->ebpf_map_definition.type].delete_entry(map, key);
     return result;
 }
 
@@ -2701,7 +3672,8 @@ ebpf_map_get_info(
     info->key_size = map->ebpf_map_definition.key_size;
     info->value_size = map->original_value_size;
     info->max_entries = map->ebpf_map_definition.max_entries;
-    info->map_flags = 0;
+    info->map_flags = map->ebpf_map_definition.map_flags;
+    info->map_extra = map->ebpf_map_definition.map_extra;
     if (info->type == BPF_MAP_TYPE_ARRAY_OF_MAPS || info->type == BPF_MAP_TYPE_HASH_OF_MAPS) {
         ebpf_core_object_map_t* object_map = EBPF_FROM_FIELD(ebpf_core_object_map_t, core_map, map);
         info->inner_map_id = object_map->core_map.ebpf_map_definition.inner_map_id
@@ -2717,6 +3689,84 @@ ebpf_map_get_info(
     return EBPF_SUCCESS;
 }
 
+_Must_inspect_result_ ebpf_result_t
+ebpf_map_mmap(_Inout_ ebpf_map_t* map, _In_ const void* instance, _Outptr_ uint8_t** address)
+{
+    ebpf_result_t result;
+    ebpf_map_user_mapping_t* user_mapping = NULL;
+    ebpf_lock_state_t state;
+
+    if (map->data_memory == NULL) {
+        EBPF_LOG_MESSAGE_UINT64(
+            EBPF_TRACELOG_LEVEL_ERROR,
+            EBPF_TRACELOG_KEYWORD_MAP,
+            "ebpf_map_mmap not supported on map",
+            map->ebpf_map_definition.type);
+        return EBPF_OPERATION_NOT_SUPPORTED;
+    }
+
+    ebpf_core_mmap_array_map_t* mmap_map = EBPF_FROM_FIELD(ebpf_core_mmap_array_map_t, core_map, map);
+
+    user_mapping = ebpf_allocate_with_tag(sizeof(ebpf_map_user_mapping_t), EBPF_POOL_TAG_MAP);
+    if (!user_mapping) {
+        result = EBPF_NO_MEMORY;
+        goto Done;
+    }
+
+    // Creating the mapping can't be done at the IRQL the lock raises to.
+    result = ebpf_create_user_mapping(map->data_memory, EBPF_PAGE_PROTECT_READ_WRITE, &user_mapping->mapping);
+    if (result != EBPF_SUCCESS) {
+        goto Done;
+    }
+    user_mapping->instance = instance;
+    *address = ebpf_user_mapping_get_address(user_mapping->mapping);
+
+    EBPF_OBJECT_ACQUIRE_REFERENCE(&map->object);
+    state = ebpf_lock_lock(&mmap_map->lock);
+    ebpf_list_insert_tail(&mmap_map->user_mappings, &user_mapping->list_entry);
+    ebpf_lock_unlock(&mmap_map->lock, state);
+    user_mapping = NULL;
+
+Done:
+    ebpf_free(user_mapping);
+    return result;
+}
+
+void
+ebpf_map_release_user_mappings(_Inout_ ebpf_map_t* map, _In_ const void* instance)
+{
+    ebpf_list_entry_t released_mappings;
+
+    if (map->data_memory == NULL) {
+        return;
+    }
+
+    ebpf_core_mmap_array_map_t* mmap_map = EBPF_FROM_FIELD(ebpf_core_mmap_array_map_t, core_map, map);
+    ebpf_list_initialize(&released_mappings);
+
+    ebpf_lock_state_t state = ebpf_lock_lock(&mmap_map->lock);
+    ebpf_list_entry_t* entry = mmap_map->user_mappings.Flink;
+    while (entry != &mmap_map->user_mappings) {
+        ebpf_list_entry_t* next_entry = entry->Flink;
+        ebpf_map_user_mapping_t* user_mapping = EBPF_FROM_FIELD(ebpf_map_user_mapping_t, list_entry, entry);
+        if (user_mapping->instance == instance) {
+            ebpf_list_remove_entry(entry);
+            ebpf_list_insert_tail(&released_mappings, entry);
+        }
+        entry = next_entry;
+    }
+    ebpf_lock_unlock(&mmap_map->lock, state);
+
+    // Removing the mappings can't be done at the IRQL the lock raises to.
+    while (!ebpf_list_is_empty(&released_mappings)) {
+        entry = ebpf_list_remove_head_entry(&released_mappings);
+        ebpf_map_user_mapping_t* user_mapping = EBPF_FROM_FIELD(ebpf_map_user_mapping_t, list_entry, entry);
+        ebpf_delete_user_mapping(user_mapping->mapping);
+        ebpf_free(user_mapping);
+        EBPF_OBJECT_RELEASE_REFERENCE(&map->object);
+    }
+}
+
 _Must_inspect_result_ ebpf_result_t
 ebpf_map_push_entry(_Inout_ ebpf_map_t* map, size_t value_size, _In_reads_(value_size) const uint8_t* value, int flags)
 {
@@ -2733,18 +3783,22 @@ ebpf_map_push_entry(_Inout_ ebpf_map_t* map, size_t value_size, _In_reads_(value
         return EBPF_OPERATION_NOT_SUPPORTED;
     }
 
+    ebpf_result_t result = _ebpf_map_check_not_frozen(map);
+    if (result != EBPF_SUCCESS) {
+        return result;
+    }
+
     return ebpf_map_metadata_tables[map->ebpf_map_definition.type].update_entry(map, NULL, value, flags);
 }
 
 _Must_inspect_result_ ebpf_result_t
 ebpf_map_pop_entry(_Inout_ ebpf_map_t* map, size_t value_size, _Out_writes_(value_size) uint8_t* value, int flags)
 {
-    uint8_t* return_value;
     if (!(flags & EBPF_MAP_FLAG_HELPER) && (value_size != map->ebpf_map_definition.value_size)) {
         return EBPF_INVALID_ARGUMENT;
     }
 
-    if (ebpf_map_metadata_tables[map->ebpf_map_definition.type].find_entry == NULL) {
+    if (ebpf_map_metadata_tables[map->ebpf_map_definition.type].peek_or_pop_entry == NULL) {
         EBPF_LOG_MESSAGE_UINT64(
             EBPF_TRACELOG_LEVEL_ERROR,
             EBPF_TRACELOG_KEYWORD_MAP,
@@ -2753,25 +3807,27 @@ ebpf_map_pop_entry(_Inout_ ebpf_map_t* map, size_t value_size, _Out_writes_(valu
         return EBPF_OPERATION_NOT_SUPPORTED;
     }
 
-    ebpf_result_t result =
-        ebpf_map_metadata_tables[map->ebpf_map_definition.type].find_entry(map, NULL, true, &return_value);
+    ebpf_result_t result = _ebpf_map_check_not_frozen(map);
     if (result != EBPF_SUCCESS) {
         return result;
     }
 
-    memcpy(value, return_value, map->ebpf_map_definition.value_size);
-    return EBPF_SUCCESS;
+    return ebpf_map_metadata_tables[map->ebpf_map_definition.type].peek_or_pop_entry(map, true, value);
 }
 
 _Must_inspect_result_ ebpf_result_t
-ebpf_map_peek_entry(_Inout_ ebpf_map_t* map, size_t value_size, _Out_writes_(value_size) uint8_t* value, int flags)
+ebpf_map_peek_entry(_Inout_ ebpf_map_t* map, size_t value_size, _Inout_updates_(value_size) uint8_t* value, int flags)
 {
-    uint8_t* return_value;
     if (!(flags & EBPF_MAP_FLAG_HELPER) && (value_size != map->ebpf_map_definition.value_size)) {
         return EBPF_INVALID_ARGUMENT;
     }
 
-    if (ebpf_map_metadata_tables[map->ebpf_map_definition.type].find_entry == NULL) {
+    if (map->ebpf_map_definition.type == BPF_MAP_TYPE_BLOOM_FILTER) {
+        // Peeking a bloom filter tests for the value passed in rather than returning one.
+        return _test_bloom_filter_map_entry(map, value);
+    }
+
+    if (ebpf_map_metadata_tables[map->ebpf_map_definition.type].peek_or_pop_entry == NULL) {
         EBPF_LOG_MESSAGE_UINT64(
             EBPF_TRACELOG_LEVEL_ERROR,
             EBPF_TRACELOG_KEYWORD_MAP,
@@ -2780,14 +3836,7 @@ ebpf_map_peek_entry(_Inout_ ebpf_map_t* map, size_t value_size, _Out_writes_(val
         return EBPF_OPERATION_NOT_SUPPORTED;
     }
 
-    ebpf_result_t result =
-        ebpf_map_metadata_tables[map->ebpf_map_definition.type].find_entry(map, NULL, false, &return_value);
-    if (result != EBPF_SUCCESS) {
-        return result;
-    }
-
-    memcpy(value, return_value, map->ebpf_map_definition.value_size);
-    return EBPF_SUCCESS;
+    return ebpf_map_metadata_tables[map->ebpf_map_definition.type].peek_or_pop_entry(map, false, value);
 }
 
 ebpf_id_t
@@ -2796,11 +3845,104 @@ ebpf_map_get_id(_In_ const ebpf_map_t* map)
     return map->object.id;
 }
 
+/**
+ * @brief Copy whole buckets of keys and values from a map that supports iterate_entries, starting at a cursor. Keys
+ * and values are collected a chunk of pointers at a time, so the cost of a walk is linear in the size of the map.
+ *
+ * @param[in, out] map Map to copy from.
+ * @param[in, out] cursor Position to start from. Updated to the position following the last bucket copied.
+ * @param[in, out] key_and_value_length Length of the buffer on input. On output, the number of bytes written.
+ * @param[out] key_and_value Buffer to write the keys and values into.
+ * @param[in] flags Flags to control the behavior of the function.
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_NO_MORE_KEYS There are no entries at or after the cursor.
+ * @retval EBPF_INSUFFICIENT_BUFFER The next bucket doesn't fit in the buffer.
+ * @retval EBPF_NO_MEMORY Unable to allocate resources for this operation.
+ */
+static ebpf_result_t
+_ebpf_map_get_next_key_and_value_batch_from_cursor(
+    _Inout_ ebpf_map_t* map,
+    _Inout_ uint64_t* cursor,
+    _Inout_ size_t* key_and_value_length,
+    _Out_writes_bytes_to_(*key_and_value_length, *key_and_value_length) uint8_t* key_and_value,
+    int flags)
+{
+    ebpf_result_t result = EBPF_SUCCESS;
+    const ebpf_map_metadata_table_t* table = &ebpf_map_metadata_tables[map->ebpf_map_definition.type];
+    size_t key_size = map->ebpf_map_definition.key_size;
+    size_t entry_size = key_size + map->ebpf_map_definition.value_size;
+    size_t maximum_entry_count = *key_and_value_length / entry_size;
+    size_t entry_count = 0;
+    size_t pointer_count = min(maximum_entry_count, EBPF_MAP_BATCH_POINTER_COUNT);
+    const uint8_t** pointers = NULL;
+
+    while (entry_count < maximum_entry_count) {
+        if (pointers == NULL) {
+            pointers = ebpf_allocate_with_tag(2 * pointer_count * sizeof(*pointers), EBPF_POOL_TAG_MAP);
+            if (pointers == NULL) {
+                result = EBPF_NO_MEMORY;
+                break;
+            }
+        }
+
+        const uint8_t** keys = pointers;
+        const uint8_t** values = pointers + pointer_count;
+        size_t count = min(maximum_entry_count - entry_count, pointer_count);
+        result = table->iterate_entries(map, cursor, &count, keys, values);
+        if (result == EBPF_INSUFFICIENT_BUFFER && count <= maximum_entry_count - entry_count) {
+            // The next bucket fits in the buffer but not in the pointer arrays.
+            ebpf_free(pointers);
+            pointers = NULL;
+            pointer_count = count;
+            continue;
+        }
+        if (result != EBPF_SUCCESS) {
+            break;
+        }
+
+        for (size_t index = 0; index < count; index++) {
+            uint8_t* entry = key_and_value + (entry_count + index) * entry_size;
+            memcpy(entry, keys[index], key_size);
+            _ebpf_map_copy_value_to_user(map, entry + key_size, values[index]);
+        }
+
+        // Delete the entries only after copying the bucket, as deleting invalidates the pointers.
+        if (flags & EBPF_MAP_FIND_FLAG_DELETE) {
+            for (size_t index = 0; index < count; index++) {
+                result = table->delete_entry(map, key_and_value + (entry_count + index) * entry_size);
+                if (result != EBPF_SUCCESS) {
+                    break;
+                }
+            }
+            if (result != EBPF_SUCCESS) {
+                break;
+            }
+        }
+
+        entry_count += count;
+    }
+
+    ebpf_free(pointers);
+
+    // Running out of entries or space after copying at least one bucket ends the batch.
+    if ((result == EBPF_NO_MORE_KEYS || result == EBPF_INSUFFICIENT_BUFFER) && entry_count != 0) {
+        result = EBPF_SUCCESS;
+    } else if (result == EBPF_SUCCESS && entry_count == 0) {
+        // Either the rest of the map is empty or the buffer can't hold a single entry.
+        result = (*cursor > UINT32_MAX) ? EBPF_NO_MORE_KEYS : EBPF_INSUFFICIENT_BUFFER;
+    }
+
+    *key_and_value_length = entry_count * entry_size;
+
+    return result;
+}
+
 _Must_inspect_result_ ebpf_result_t
 ebpf_map_get_next_key_and_value_batch(
     _Inout_ ebpf_map_t* map,
     size_t previous_key_length,
     _In_reads_bytes_opt_(previous_key_length) const uint8_t* previous_key,
+    _Inout_opt_ uint64_t* cursor,
     _Inout_ size_t* key_and_value_length,
     _Out_writes_bytes_to_(*key_and_value_length, *key_and_value_length) uint8_t* key_and_value,
     int flags)
@@ -2839,6 +3981,29 @@ ebpf_map_get_next_key_and_value_batch(
         return EBPF_INVALID_ARGUMENT;
     }
 
+    if (flags & EBPF_MAP_FIND_FLAG_DELETE) {
+        result = _ebpf_map_check_not_frozen(map);
+        if (result != EBPF_SUCCESS) {
+            return result;
+        }
+    }
+
+    if (cursor) {
+        if (ebpf_map_metadata_tables[map->ebpf_map_definition.type].iterate_entries == NULL) {
+            EBPF_LOG_MESSAGE_UINT64(
+                EBPF_TRACELOG_LEVEL_ERROR,
+                EBPF_TRACELOG_KEYWORD_MAP,
+                "ebpf_map_get_next_key_and_value_batch cursor not supported on map",
+                map->ebpf_map_definition.type);
+            return EBPF_OPERATION_NOT_SUPPORTED;
+        }
+        if (previous_key) {
+            return EBPF_INVALID_ARGUMENT;
+        }
+        return _ebpf_map_get_next_key_and_value_batch_from_cursor(
+            map, cursor, key_and_value_length, key_and_value, flags);
+    }
+
     // Copy as many key/value pairs as we can fit in the output buffer.
     for (;;) {
         // Check if we have enough space to write the next key and value.
@@ -2857,7 +4022,7 @@ ebpf_map_get_next_key_and_value_batch(
             break;
         }
 
-        memcpy(key_and_value + output_length + key_size, next_value, value_size);
+        _ebpf_map_copy_value_to_user(map, key_and_value + output_length + key_size, next_value);
 
         if (flags & EBPF_MAP_FIND_FLAG_DELETE) {
             // If the caller requested deletion, delete the entry.
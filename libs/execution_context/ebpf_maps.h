@@ -7,6 +7,7 @@
 #include "cxplat.h"
 #include "ebpf_core_structs.h"
 #include "ebpf_platform.h"
+#include "ebpf_ring_buffer_record.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -45,6 +46,17 @@ extern "C"
     const ebpf_map_definition_in_memory_t*
     ebpf_map_get_definition(_In_ const ebpf_map_t* map);
 
+    /**
+     * @brief Get a pointer to the values of an array map. The value of key N
+     * is stored at offset N * value_size and the pointer is valid for the
+     * lifetime of the map.
+     *
+     * @param[in] map Map to get the values of.
+     * @return Pointer to the values or NULL if the map is not a BPF_MAP_TYPE_ARRAY.
+     */
+    _Ret_maybenull_ uint8_t*
+    ebpf_map_get_array_data(_In_ const ebpf_map_t* map);
+
     /**
      * @brief Get the map value size specified when the map was originally
      * created. For per-cpu maps this will be different from the value in the
@@ -83,6 +95,7 @@ extern "C"
      * @param[in] flags EBPF_MAP_FLAG_HELPER if called from helper function.
      * @retval EBPF_SUCCESS The operation was successful.
      * @retval EBPF_NO_MEMORY Unable to allocate resources for this entry.
+     * @retval EBPF_ACCESS_DENIED The map is frozen.
      */
     _Must_inspect_result_ ebpf_result_t
     ebpf_map_update_entry(
@@ -121,6 +134,7 @@ extern "C"
      * @retval EBPF_SUCCESS The operation was successful.
      * @retval EBPF_INVALID_ARGUMENT One or more parameters are
      *  invalid.
+     * @retval EBPF_ACCESS_DENIED The map is frozen.
      */
     _Must_inspect_result_ ebpf_result_t
     ebpf_map_delete_entry(_In_ ebpf_map_t* map, size_t key_size, _In_reads_(key_size) const uint8_t* key, int flags);
@@ -201,6 +215,23 @@ extern "C"
     ebpf_ring_buffer_map_query_buffer(
         _In_ const ebpf_map_t* map, _Outptr_ uint8_t** buffer, _Out_ size_t* consumer_offset);
 
+    /**
+     * @brief Map the pages holding the producer and consumer offsets of the
+     * ring buffer map into the calling process, so that records can be read
+     * and returned without a round trip to the execution context.
+     *
+     * @param[in] map Ring buffer map to query.
+     * @param[out] producer_page Pointer to the read-only producer page.
+     * @param[out] consumer_page Pointer to the consumer page.
+     * @retval EBPF_SUCCESS Successfully mapped the pages.
+     * @retval EBPF_INVALID_ARGUMENT Unable to map the pages.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_ring_buffer_map_query_offsets(
+        _In_ const ebpf_map_t* map,
+        _Outptr_ const ebpf_ring_buffer_producer_page_t** producer_page,
+        _Outptr_ ebpf_ring_buffer_consumer_page_t** consumer_page);
+
     /**
      * @brief Return consumed buffer back to the ring buffer map.
      *
@@ -239,6 +270,100 @@ extern "C"
     _Must_inspect_result_ ebpf_result_t
     ebpf_ring_buffer_map_output(_Inout_ ebpf_map_t* map, _In_reads_bytes_(length) uint8_t* data, size_t length);
 
+    /**
+     * @brief Get the buffer of one CPU of a perf event array map.
+     *
+     * @param[in] map Perf event array map to query.
+     * @param[in] cpu_id Index of the CPU whose buffer to query.
+     * @param[out] buffer Pointer to ring buffer data.
+     * @param[out] consumer_offset Offset of consumer in ring buffer data.
+     * @retval EBPF_SUCCESS Successfully mapped the ring buffer.
+     * @retval EBPF_INVALID_ARGUMENT The CPU index is out of range or the ring buffer can't be mapped.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_perf_event_array_map_query_buffer(
+        _In_ const ebpf_map_t* map, uint32_t cpu_id, _Outptr_ uint8_t** buffer, _Out_ size_t* consumer_offset);
+
+    /**
+     * @brief Return consumed records back to the buffer of one CPU of a perf event array map.
+     *
+     * @param[in] map Perf event array map.
+     * @param[in] cpu_id Index of the CPU whose buffer to return records to.
+     * @param[in] consumer_offset New offset of consumer in ring buffer data.
+     * @retval EBPF_SUCCESS Successfully returned records to the ring buffer.
+     * @retval EBPF_INVALID_ARGUMENT The CPU index is out of range or the offset is invalid.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_perf_event_array_map_return_buffer(_In_ const ebpf_map_t* map, uint32_t cpu_id, size_t consumer_offset);
+
+    /**
+     * @brief Issue an asynchronous query to the buffer of one CPU of a perf event array map.
+     *
+     * @param[in, out] map Perf event array map to issue the async query on.
+     * @param[in] cpu_id Index of the CPU whose buffer to query.
+     * @param[in, out] async_query_result Pointer to structure for storing result of the async query.
+     * @param[in, out] async_context Async context associated with the query.
+     * @retval EBPF_PENDING The query was queued.
+     * @retval EBPF_INVALID_ARGUMENT The CPU index is out of range or a query is already queued.
+     * @retval EBPF_NO_MEMORY Insufficient memory to complete this operation.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_perf_event_array_map_async_query(
+        _Inout_ ebpf_map_t* map,
+        uint32_t cpu_id,
+        _Inout_ ebpf_perf_event_array_map_async_query_result_t* async_query_result,
+        _Inout_ void* async_context);
+
+    /**
+     * @brief Write out a variable sized record to the buffer of the current CPU
+     * of a perf event array map. Records that don't fit are counted as lost.
+     *
+     * @param[in, out] map Pointer to map of type BPF_MAP_TYPE_PERF_EVENT_ARRAY.
+     * @param[in] flags CPU index, which must be BPF_F_CURRENT_CPU or the current CPU.
+     * @param[in] data Data of record to write into the buffer.
+     * @param[in] length Length of data.
+     * @retval EBPF_SUCCESS Successfully wrote record into the buffer.
+     * @retval EBPF_INVALID_ARGUMENT The map type or flags are invalid.
+     * @retval EBPF_OUT_OF_SPACE Unable to output to the buffer due to inadequate space.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_perf_event_array_map_output(
+        _Inout_ ebpf_map_t* map, uint64_t flags, _In_reads_bytes_(length) uint8_t* data, size_t length);
+
+    /**
+     * @brief Map the values of a map created with BPF_F_MMAPABLE read/write
+     * into the calling process. The mapping holds a reference on the map until
+     * it is removed via ebpf_map_release_user_mappings.
+     *
+     * @param[in, out] map Map to map into the calling process.
+     * @param[in] instance Handle instance the mapping belongs to.
+     * @param[out] address Address of the values in the calling process.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_OPERATION_NOT_SUPPORTED The map was not created with BPF_F_MMAPABLE.
+     * @retval EBPF_NO_MEMORY Unable to map the values into the calling process.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_map_mmap(_Inout_ ebpf_map_t* map, _In_ const void* instance, _Outptr_ uint8_t** address);
+
+    /**
+     * @brief Freeze the contents of a map. Updates and deletes of a frozen
+     * map fail with EBPF_ACCESS_DENIED. Lookups are unaffected.
+     *
+     * @param[in, out] map Map to freeze.
+     */
+    void
+    ebpf_map_freeze(_Inout_ ebpf_map_t* map);
+
+    /**
+     * @brief Remove the mappings created via ebpf_map_mmap for a handle
+     * instance and release their references on the map.
+     *
+     * @param[in, out] map Map whose mappings to remove.
+     * @param[in] instance Handle instance the mappings belong to.
+     */
+    void
+    ebpf_map_release_user_mappings(_Inout_ ebpf_map_t* map, _In_ const void* instance);
+
     /**
      * @brief Insert an element at the end of the map (only valid for stack and queue).
      *
@@ -270,18 +395,21 @@ extern "C"
     ebpf_map_pop_entry(_Inout_ ebpf_map_t* map, size_t value_size, _Out_writes_(value_size) uint8_t* value, int flags);
 
     /**
-     * @brief Copy an entry from the map (only valid for stack and queue).
+     * @brief Copy an entry from the map (only valid for stack, queue and bloom filter).
      * Queue peeks at the beginning of the map.
      * Stack peeks at the end of the map.
+     * Bloom filter tests whether the value passed in may have been pushed.
      *
      * @param[in, out] map Map to search and update metadata on.
      * @param[in] value_size Size of the value buffer to copy value from map into.
-     * @param[out] value Value buffer to copy value from map into.
+     * @param[in, out] value Value buffer to copy value from map into, or the value to test for a bloom filter.
      * @retval EBPF_SUCCESS The operation was successful.
      * @retval EBPF_OBJECT_NOT_FOUND The map is empty.
+     * @retval EBPF_KEY_NOT_FOUND The value is not in the bloom filter.
      */
     _Must_inspect_result_ ebpf_result_t
-    ebpf_map_peek_entry(_Inout_ ebpf_map_t* map, size_t value_size, _Out_writes_(value_size) uint8_t* value, int flags);
+    ebpf_map_peek_entry(
+        _Inout_ ebpf_map_t* map, size_t value_size, _Inout_updates_(value_size) uint8_t* value, int flags);
 
     /**
      * @brief Get the ID of a given map.
@@ -293,11 +421,16 @@ extern "C"
     ebpf_map_get_id(_In_ const ebpf_map_t* map);
 
     /**
-     * @brief Copy keys and values from the map to the caller provided buffer.
+     * @brief Copy keys and values from the map to the caller provided buffer. Maps backed by a hash table can be
+     * walked with a cursor instead of a previous key, in which case whole buckets are copied at a time and the walk
+     * never rescans a bucket.
      *
      * @param[in, out] map Map to search and update metadata on.
      * @param[in] previous_key_length The length of the previous key.
      * @param[in] previous_key The previous key need not be present. This is the key to start the search from.
+     * @param[in,out] cursor If not NULL, the position to start from, which is 0 for the start of the map or the value
+     * returned by the previous call. Updated to the position following the last entry returned. Must be NULL if
+     * previous_key is present.
      * @param[in,out] key_and_value_length Length of the key and value buffer on input. On output, the number of bytes
      * actually written.
      * @param[out] key_and_value Buffer to write the keys and values into.
@@ -305,12 +438,15 @@ extern "C"
      * @retval EBPF_SUCCESS The operation was successful.
      * @retval EBPF_KEY_NOT_FOUND The specified previous key was not found.
      * @retval EBPF_NO_MORE_KEYS There is no key following the specified key.
+     * @retval EBPF_INSUFFICIENT_BUFFER The buffer can't hold the next bucket of a cursor walk.
+     * @retval EBPF_OPERATION_NOT_SUPPORTED The map doesn't support this walk.
      */
     _Must_inspect_result_ ebpf_result_t
     ebpf_map_get_next_key_and_value_batch(
         _Inout_ ebpf_map_t* map,
         size_t previous_key_length,
         _In_reads_bytes_opt_(previous_key_length) const uint8_t* previous_key,
+        _Inout_opt_ uint64_t* cursor,
         _Inout_ size_t* key_and_value_length,
         _Out_writes_bytes_to_(*key_and_value_length, *key_and_value_length) uint8_t* key_and_value,
         int flags);
@@ -6,6 +6,7 @@
 #include "ebpf_core.h"
 #include "ebpf_handle.h"
 #include "ebpf_hash_table.h"
+#include "ebpf_maps.h"
 #include "ebpf_native.h"
 #include "ebpf_object.h"
 #include "ebpf_program.h"
@@ -448,6 +449,23 @@ _ebpf_native_map_initial_values_fallback(
     *count = 0;
 }
 
+static void
+_ebpf_native_map_data_fallback(
+    _Outptr_result_buffer_maybenull_(*count) map_data_entry_t** map_data, _Out_ size_t* count)
+{
+    *map_data = NULL;
+    *count = 0;
+}
+
+static void
+_ebpf_native_global_variable_sections_fallback(
+    _Outptr_result_buffer_maybenull_(*count) global_variable_section_info_t** global_variable_sections,
+    _Out_ size_t* count)
+{
+    *global_variable_sections = NULL;
+    *count = 0;
+}
+
 static NTSTATUS
 _ebpf_native_provider_attach_client_callback(
     _In_ HANDLE nmr_binding_handle,
@@ -515,6 +533,16 @@ _ebpf_native_provider_attach_client_callback(
         client_context->table.map_initial_values = _ebpf_native_map_initial_values_fallback;
     }
 
+    // Initialize the map data function pointer if it is not present.
+    if (!client_context->table.map_data) {
+        client_context->table.map_data = _ebpf_native_map_data_fallback;
+    }
+
+    // Initialize the global variable sections function pointer if it is not present.
+    if (!client_context->table.global_variable_sections) {
+        client_context->table.global_variable_sections = _ebpf_native_global_variable_sections_fallback;
+    }
+
     ebpf_lock_create(&client_context->lock);
     client_context->base.marker = _ebpf_native_marker;
     client_context->base.acquire_reference = _ebpf_native_acquire_reference_internal;
@@ -962,6 +990,71 @@ _ebpf_native_set_initial_map_values(_Inout_ ebpf_native_module_t* module)
     EBPF_RETURN_RESULT(result);
 }
 
+static ebpf_result_t
+_ebpf_native_set_global_variable_values(_Inout_ ebpf_native_module_t* module)
+{
+    EBPF_LOG_ENTRY();
+    ebpf_result_t result = EBPF_SUCCESS;
+    global_variable_section_info_t* sections = NULL;
+    size_t section_count = 0;
+
+    module->table.global_variable_sections(&sections, &section_count);
+
+    for (size_t i = 0; i < section_count; i++) {
+        ebpf_native_map_t* native_map = _ebpf_native_find_map_by_name(module, sections[i].name);
+        if (native_map == NULL || native_map->entry->definition.type != BPF_MAP_TYPE_ARRAY ||
+            native_map->entry->definition.value_size != sections[i].size) {
+            result = EBPF_INVALID_ARGUMENT;
+            EBPF_LOG_MESSAGE_GUID(
+                EBPF_TRACELOG_LEVEL_ERROR,
+                EBPF_TRACELOG_KEYWORD_NATIVE,
+                "_ebpf_native_set_global_variable_values: invalid global variable section",
+                &module->client_module_id);
+            break;
+        }
+
+        if (native_map->reused) {
+            // Map is reused. Skip updating initial values.
+            continue;
+        }
+
+        // Zero filled sections need no initialization as array maps start out zeroed.
+        if (sections[i].initial_data == NULL && !sections[i].read_only) {
+            continue;
+        }
+
+        ebpf_map_t* map = NULL;
+        result = EBPF_OBJECT_REFERENCE_BY_HANDLE(native_map->handle, EBPF_OBJECT_MAP, (ebpf_core_object_t**)&map);
+        if (result != EBPF_SUCCESS) {
+            break;
+        }
+
+        if (sections[i].initial_data != NULL) {
+            uint32_t key = 0;
+            result = ebpf_map_update_entry(
+                map,
+                sizeof(key),
+                (uint8_t*)&key,
+                native_map->entry->definition.value_size,
+                (const uint8_t*)sections[i].initial_data,
+                EBPF_ANY,
+                0);
+        }
+
+        // The generated code may have folded loads from read-only sections into constants, so their contents must
+        // not change.
+        if (result == EBPF_SUCCESS && sections[i].read_only) {
+            ebpf_map_freeze(map);
+        }
+        EBPF_OBJECT_RELEASE_REFERENCE((ebpf_core_object_t*)map);
+        if (result != EBPF_SUCCESS) {
+            break;
+        }
+    }
+
+    EBPF_RETURN_RESULT(result);
+}
+
 static ebpf_result_t
 _ebpf_native_create_maps(_Inout_ ebpf_native_module_t* module)
 {
@@ -1086,6 +1179,8 @@ _ebpf_native_resolve_maps_for_program(_In_ ebpf_native_module_t* module, _In_ co
     uint16_t* map_indices = program->entry->referenced_map_indices;
     uint16_t map_count = program->entry->referenced_map_count;
     ebpf_native_map_t* native_maps = module->maps;
+    map_data_entry_t* map_data = NULL;
+    size_t map_data_count = 0;
 
     if (map_count == 0) {
         // No maps associated with this program.
@@ -1143,6 +1238,14 @@ _ebpf_native_resolve_maps_for_program(_In_ ebpf_native_module_t* module, _In_ co
         native_maps[map_indices[i]].entry->address = (void*)map_addresses[i];
     }
 
+    // Publish the value storage of array maps so that generated code can look up values without a helper call.
+    module->table.map_data(&map_data, &map_data_count);
+    for (uint16_t i = 0; i < map_count; i++) {
+        if (map_indices[i] < map_data_count) {
+            map_data[map_indices[i]].address = ebpf_map_get_array_data((ebpf_map_t*)map_addresses[i]);
+        }
+    }
+
 Done:
     ebpf_free(map_handles);
     ebpf_free(map_addresses);
@@ -1789,6 +1892,17 @@ ebpf_native_load_programs(
         goto Done;
     }
 
+    // Set initial values of global variables.
+    result = _ebpf_native_set_global_variable_values(module);
+    if (result != EBPF_SUCCESS) {
+        EBPF_LOG_MESSAGE_GUID(
+            EBPF_TRACELOG_LEVEL_VERBOSE,
+            EBPF_TRACELOG_KEYWORD_NATIVE,
+            "ebpf_native_load_programs: set global variable values failed",
+            module_id);
+        goto Done;
+    }
+
     module_state = ebpf_lock_lock(&module->lock);
     native_lock_acquired = true;
 
@@ -28,6 +28,23 @@ static size_t _ebpf_program_state_index = MAXUINT64;
 // Global flag to disable invoking programs. This is used when fuzzing the IOCTL interface.
 bool ebpf_program_disable_invoke = false;
 
+// Global flag to collect per-program runtime statistics on each invocation.
+static volatile bool _ebpf_program_statistics_enabled = false;
+
+#pragma warning(disable : 4324) // Structure was padded due to alignment specifier.
+
+/**
+ * @brief Per-CPU runtime statistics of a program. Each CPU only updates its
+ * own entry at DISPATCH_LEVEL, so the counters are updated without interlocked
+ * operations and are summed when queried.
+ */
+typedef __declspec(align(EBPF_CACHE_LINE_SIZE)) struct _ebpf_program_cpu_statistics
+{
+    uint64_t run_count;       ///< Number of times the program was invoked.
+    uint64_t run_time;        ///< Time spent in the program and its tail calls, in performance counter ticks.
+    uint64_t tail_call_count; ///< Number of tail calls made from the program.
+} ebpf_program_cpu_statistics_t;
+
 typedef struct _ebpf_program
 {
     ebpf_core_object_t object;
@@ -76,6 +93,9 @@ typedef struct _ebpf_program
 
     ebpf_trampoline_table_t* trampoline_table;
 
+    // Per-CPU runtime statistics, indexed by CPU.
+    ebpf_program_cpu_statistics_t* cpu_statistics;
+
     // Array of helper function ids referred by this program.
     size_t helper_function_count;
     uint32_t* helper_function_ids;
@@ -700,6 +720,13 @@ _IRQL_requires_max_(PASSIVE_LEVEL) static void _ebpf_program_free(_In_opt_ _Post
 
     ebpf_free(program->helper_function_ids);
 
+    if (program->cpu_statistics) {
+        cxplat_free(
+            program->cpu_statistics,
+            CXPLAT_POOL_FLAG_NON_PAGED | CXPLAT_POOL_FLAG_CACHE_ALIGNED,
+            EBPF_POOL_TAG_PROGRAM);
+    }
+
     ebpf_free(program);
     EBPF_RETURN_VOID();
 }
@@ -754,6 +781,15 @@ ebpf_program_create(_In_ const ebpf_program_parameters_t* program_parameters, _O
     ebpf_list_initialize(&local_program->links);
     ebpf_lock_create(&local_program->lock);
 
+    local_program->cpu_statistics = (ebpf_program_cpu_statistics_t*)cxplat_allocate(
+        CXPLAT_POOL_FLAG_NON_PAGED | CXPLAT_POOL_FLAG_CACHE_ALIGNED,
+        ebpf_get_cpu_count() * sizeof(ebpf_program_cpu_statistics_t),
+        EBPF_POOL_TAG_PROGRAM);
+    if (!local_program->cpu_statistics) {
+        retval = EBPF_NO_MEMORY;
+        goto Done;
+    }
+
     local_program->bpf_prog_type = BPF_PROG_TYPE_UNSPEC;
 
     if (program_parameters->program_name.length >= BPF_OBJ_NAME_LEN) {
@@ -1462,37 +1498,26 @@ ebpf_program_dereference_providers(_Inout_ ebpf_program_t* program)
     ExReleaseRundownProtection(&program->program_information_rundown_reference);
 }
 
-_Must_inspect_result_ ebpf_result_t
-ebpf_program_invoke(
+/**
+ * @brief Run a program and the chain of programs it tail calls, starting at
+ * the position in the chain recorded in the execution state.
+ *
+ * @param[in] program Program to run.
+ * @param[in, out] context Pointer to eBPF context for this program.
+ * @param[out] result Output from the last program in the chain.
+ * @param[in, out] execution_state Execution context state.
+ */
+__forceinline static void
+_ebpf_program_run_chain(
     _In_ const ebpf_program_t* program,
     _Inout_ void* context,
     _Out_ uint32_t* result,
     _Inout_ ebpf_execution_context_state_t* execution_state)
 {
-    if (ebpf_program_disable_invoke) {
-        *result = 0;
-        return EBPF_EXTENSION_FAILED_TO_LOAD;
-    }
-
-    // If the pointer is null, then the extension has been unloaded and the program should not be invoked.
-    // If the pointer is not null, then the extension is loaded and will remain loaded until at least after
-    // the current epoch ends.
-    // Note: The call to ebpf_epoch_enter is a full memory barrier, so any values read after that
-    // point will be synchronized with the start of the epoch, so it is safe to call ReadPointerNoFence
-    // after the call to ebpf_epoch_enter.
-    // Note: The invoke path doesn't explicitly use the program->extension_program_data, but
-    // instead uses pointers that have been previously read from the extension_program_data.
-    if (ReadPointerNoFence((void* const volatile*)(&program->extension_program_data)) == NULL) {
-        *result = 0;
-        return EBPF_EXTENSION_FAILED_TO_LOAD;
-    }
-
-    // High volume call - Skip entry/exit logging.
     const ebpf_program_t* current_program = program;
 
     // Top-level tail caller(1) + tail callees(33).
-    for (execution_state->tail_call_state.count = 0; execution_state->tail_call_state.count < MAX_TAIL_CALL_CNT + 1;
-         execution_state->tail_call_state.count++) {
+    for (; execution_state->tail_call_state.count < MAX_TAIL_CALL_CNT + 1; execution_state->tail_call_state.count++) {
 
         if (current_program->parameters.code_type == EBPF_CODE_JIT ||
             current_program->parameters.code_type == EBPF_CODE_NATIVE) {
@@ -1520,9 +1545,149 @@ ebpf_program_invoke(
             execution_state->tail_call_state.next_program = NULL;
         }
     }
+}
+
+/**
+ * @brief Run a program and the chain of programs it tail calls.
+ *
+ * @param[in] program Program to run.
+ * @param[in, out] context Pointer to eBPF context for this program.
+ * @param[out] result Output from the last program in the chain.
+ * @param[in, out] execution_state Execution context state.
+ */
+__forceinline static void
+_ebpf_program_run(
+    _In_ const ebpf_program_t* program,
+    _Inout_ void* context,
+    _Out_ uint32_t* result,
+    _Inout_ ebpf_execution_context_state_t* execution_state)
+{
+    execution_state->tail_call_state.count = 0;
+    _ebpf_program_run_chain(program, context, result, execution_state);
+}
+
+/**
+ * @brief Run a program and record its runtime in the statistics of the
+ * current CPU. Kept out of line so that the invoke path only pays for a
+ * branch while statistics are disabled.
+ *
+ * @param[in] program Program to run.
+ * @param[in, out] context Pointer to eBPF context for this program.
+ * @param[out] result Output from the last program in the chain.
+ * @param[in, out] execution_state Execution context state.
+ */
+__declspec(noinline) static void
+_ebpf_program_run_with_statistics(
+    _In_ const ebpf_program_t* program,
+    _Inout_ void* context,
+    _Out_ uint32_t* result,
+    _Inout_ ebpf_execution_context_state_t* execution_state)
+{
+    // Use the performance counter, as short programs often run for less than the 100 ns interrupt time unit.
+    uint64_t start_time = ebpf_query_performance_counter();
+    _ebpf_program_run(program, context, result, execution_state);
+    uint64_t end_time = ebpf_query_performance_counter();
+
+    // Raise to DISPATCH_LEVEL so that this CPU's entry is not updated concurrently.
+    bool is_preemptible = ebpf_is_preemptible();
+    uint8_t old_irql = 0;
+    if (is_preemptible) {
+        old_irql = ebpf_raise_irql(DISPATCH_LEVEL);
+    }
+
+    ebpf_program_cpu_statistics_t* statistics = &program->cpu_statistics[ebpf_get_current_cpu()];
+    statistics->run_count++;
+    statistics->run_time += end_time - start_time;
+    // The count is the index of the last program that ran in the chain.
+    statistics->tail_call_count += min(execution_state->tail_call_state.count, MAX_TAIL_CALL_CNT);
+
+    if (is_preemptible) {
+        ebpf_lower_irql(old_irql);
+    }
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_program_invoke(
+    _In_ const ebpf_program_t* program,
+    _Inout_ void* context,
+    _Out_ uint32_t* result,
+    _Inout_ ebpf_execution_context_state_t* execution_state)
+{
+    if (ebpf_program_disable_invoke) {
+        *result = 0;
+        return EBPF_EXTENSION_FAILED_TO_LOAD;
+    }
+
+    // If the pointer is null, then the extension has been unloaded and the program should not be invoked.
+    // If the pointer is not null, then the extension is loaded and will remain loaded until at least after
+    // the current epoch ends.
+    // Note: The call to ebpf_epoch_enter is a full memory barrier, so any values read after that
+    // point will be synchronized with the start of the epoch, so it is safe to call ReadPointerNoFence
+    // after the call to ebpf_epoch_enter.
+    // Note: The invoke path doesn't explicitly use the program->extension_program_data, but
+    // instead uses pointers that have been previously read from the extension_program_data.
+    if (ReadPointerNoFence((void* const volatile*)(&program->extension_program_data)) == NULL) {
+        *result = 0;
+        return EBPF_EXTENSION_FAILED_TO_LOAD;
+    }
+
+    // High volume call - Skip entry/exit logging.
+    if (!_ebpf_program_statistics_enabled) {
+        _ebpf_program_run(program, context, result, execution_state);
+    } else {
+        _ebpf_program_run_with_statistics(program, context, result, execution_state);
+    }
+    return EBPF_SUCCESS;
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_program_invoke_vector(
+    _In_ const ebpf_program_t* program,
+    _Inout_updates_(count) void** contexts,
+    _Out_writes_(count) uint32_t* results,
+    size_t count,
+    _Inout_ ebpf_execution_context_state_t* execution_state)
+{
+    // See ebpf_program_invoke for why the extension program data can be read without a fence.
+    if (ebpf_program_disable_invoke ||
+        ReadPointerNoFence((void* const volatile*)(&program->extension_program_data)) == NULL) {
+        memset(results, 0, count * sizeof(results[0]));
+        return EBPF_EXTENSION_FAILED_TO_LOAD;
+    }
+
+    // High volume call - Skip entry/exit logging.
+    if (_ebpf_program_statistics_enabled) {
+        for (size_t index = 0; index < count; index++) {
+            _ebpf_program_run_with_statistics(program, contexts[index], &results[index], execution_state);
+        }
+    } else if (program->parameters.code_type == EBPF_CODE_JIT || program->parameters.code_type == EBPF_CODE_NATIVE) {
+        // Resolve the entry point once and only fall back to the chain walk when the program tail calls.
+        ebpf_program_entry_point_t function_pointer =
+            (ebpf_program_entry_point_t)(program->code_or_vm.code.code_pointer);
+        for (size_t index = 0; index < count; index++) {
+            execution_state->tail_call_state.count = 0;
+            results[index] = (function_pointer)(contexts[index]);
+            const ebpf_program_t* next_program = execution_state->tail_call_state.next_program;
+            if (next_program != NULL) {
+                execution_state->tail_call_state.next_program = NULL;
+                execution_state->tail_call_state.count++;
+                _ebpf_program_run_chain(next_program, contexts[index], &results[index], execution_state);
+            }
+        }
+    } else {
+        for (size_t index = 0; index < count; index++) {
+            _ebpf_program_run(program, contexts[index], &results[index], execution_state);
+        }
+    }
     return EBPF_SUCCESS;
 }
 
+void
+ebpf_program_set_statistics_enabled(bool enabled)
+{
+    _ebpf_program_statistics_enabled = enabled;
+}
+
 _Requires_lock_held_(program->lock) static ebpf_result_t _ebpf_program_get_helper_function_address(
     _In_ const ebpf_program_t* program, const uint32_t helper_function_id, _Out_ uint64_t* address)
 {
@@ -2011,6 +2176,16 @@ ebpf_program_get_info(
     output_info->pinned_path_count = program->object.pinned_path_count;
     output_info->link_count = program->link_count;
 
+    uint64_t run_time = 0;
+    uint32_t cpu_count = ebpf_get_cpu_count();
+    for (uint32_t cpu_id = 0; cpu_id < cpu_count; cpu_id++) {
+        const ebpf_program_cpu_statistics_t* statistics = &program->cpu_statistics[cpu_id];
+        output_info->run_cnt += statistics->run_count;
+        run_time += statistics->run_time;
+        output_info->tail_call_cnt += statistics->tail_call_count;
+    }
+    output_info->run_time_ns = ebpf_performance_counter_to_nanoseconds(run_time);
+
     *info_size = sizeof(*output_info);
     EBPF_RETURN_RESULT(result);
 }
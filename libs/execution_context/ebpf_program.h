@@ -199,6 +199,37 @@ extern "C"
         _Out_ uint32_t* result,
         _Inout_ ebpf_execution_context_state_t* execution_state);
 
+    /**
+     * @brief Invoke an ebpf_program_t instance on each context in a vector. The
+     * program state is checked once for the whole vector and the caller must
+     * be in an epoch for the duration of the call.
+     *
+     * @param[in] program Program to invoke.
+     * @param[in,out] contexts Pointers to the eBPF context for each invocation.
+     * @param[out] results Output from the program for each context.
+     * @param[in] count Number of contexts.
+     * @param[in] execution_state Execution context state.
+     * @retval EBPF_SUCCESS The program was successfully invoked.
+     * @retval EBPF_EXTENSION_FAILED_TO_LOAD The program information provider is not available.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_program_invoke_vector(
+        _In_ const ebpf_program_t* program,
+        _Inout_updates_(count) void** contexts,
+        _Out_writes_(count) uint32_t* results,
+        size_t count,
+        _Inout_ ebpf_execution_context_state_t* execution_state);
+
+    /**
+     * @brief Enable or disable the collection of runtime statistics for all
+     * programs. While enabled, each invocation records its run count, run time
+     * and tail call count in per-CPU counters of the invoked program.
+     *
+     * @param[in] enabled True to collect statistics on each invocation.
+     */
+    void
+    ebpf_program_set_statistics_enabled(bool enabled);
+
     /**
      * @brief Store the helper function IDs that are used by the eBPF program in an array
      *  inside the program object. The array index is the helper function ID to be used by
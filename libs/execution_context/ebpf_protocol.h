@@ -45,6 +45,13 @@ typedef enum _ebpf_operation_id
     EBPF_OPERATION_MAP_UPDATE_ELEMENT_BATCH,
     EBPF_OPERATION_MAP_DELETE_ELEMENT_BATCH,
     EBPF_OPERATION_MAP_GET_NEXT_KEY_VALUE_BATCH,
+    EBPF_OPERATION_PERF_EVENT_ARRAY_MAP_QUERY_BUFFER,
+    EBPF_OPERATION_PERF_EVENT_ARRAY_MAP_ASYNC_QUERY,
+    EBPF_OPERATION_SET_PROGRAM_STATISTICS,
+    EBPF_OPERATION_MAP_MMAP,
+    EBPF_OPERATION_MAP_UPDATE_ELEMENT_BATCH_BUFFER,
+    EBPF_OPERATION_MAP_GET_NEXT_KEY_VALUE_BATCH_BUFFER,
+    EBPF_OPERATION_MAP_RING_SUBMIT,
 } ebpf_operation_id_t;
 
 typedef enum _ebpf_code_type
@@ -374,6 +381,10 @@ typedef struct _ebpf_operation_ring_buffer_map_query_buffer_reply
     uint64_t buffer_address;
     // The current consumer offset, so that subsequent reads can start from here.
     size_t consumer_offset;
+    // Address to user-space read-only page holding the producer offset.
+    uint64_t producer_page_address;
+    // Address to user-space page the consumer publishes its consumer offset to.
+    uint64_t consumer_page_address;
 } ebpf_operation_ring_buffer_map_query_buffer_reply_t;
 
 typedef struct _ebpf_operation_ring_buffer_map_async_query_request
@@ -390,6 +401,37 @@ typedef struct _ebpf_operation_ring_buffer_map_async_query_reply
     ebpf_ring_buffer_map_async_query_result_t async_query_result;
 } ebpf_operation_ring_buffer_map_async_query_reply_t;
 
+typedef struct _ebpf_operation_perf_event_array_map_query_buffer_request
+{
+    struct _ebpf_operation_header header;
+    ebpf_handle_t map_handle;
+    uint32_t cpu_id;
+} ebpf_operation_perf_event_array_map_query_buffer_request_t;
+
+typedef struct _ebpf_operation_perf_event_array_map_query_buffer_reply
+{
+    struct _ebpf_operation_header header;
+    // Address to user-space read-only buffer for the records of this CPU.
+    uint64_t buffer_address;
+    // The current consumer offset, so that subsequent reads can start from here.
+    size_t consumer_offset;
+} ebpf_operation_perf_event_array_map_query_buffer_reply_t;
+
+typedef struct _ebpf_operation_perf_event_array_map_async_query_request
+{
+    struct _ebpf_operation_header header;
+    ebpf_handle_t map_handle;
+    uint32_t cpu_id;
+    // Offset till which the consumer has read data so far.
+    size_t consumer_offset;
+} ebpf_operation_perf_event_array_map_async_query_request_t;
+
+typedef struct _ebpf_operation_perf_event_array_map_async_query_reply
+{
+    struct _ebpf_operation_header header;
+    ebpf_perf_event_array_map_async_query_result_t async_query_result;
+} ebpf_operation_perf_event_array_map_async_query_reply_t;
+
 typedef struct _ebpf_operation_load_native_module_request
 {
     struct _ebpf_operation_header header;
@@ -500,13 +542,141 @@ typedef struct _ebpf_operation_map_get_next_key_value_batch_request
     struct _ebpf_operation_header header;
     ebpf_handle_t handle;
     bool find_and_delete;
+    // Resume from cursor instead of previous_key. Only supported by maps backed by a hash table.
+    bool use_cursor;
+    // Opaque cursor from the previous reply, or 0 to start from the beginning of the map.
+    uint64_t cursor;
     uint8_t previous_key[1];
 } ebpf_operation_map_get_next_key_value_batch_request_t;
 
 typedef struct _ebpf_operation_map_get_next_key_value_batch_reply
 {
     struct _ebpf_operation_header header;
+    // Cursor to pass in the next request if the request used a cursor. It is never 0 and never exceeds 2^32.
+    uint64_t cursor;
     // Count of elements is derived from the length of the reply.
     // Data is a concatenation of key+value.
     uint8_t data[1];
 } ebpf_operation_map_get_next_key_value_batch_reply_t;
+
+// A buffer in the calling process. The buffer is locked and accessed in place rather than copied into the request or
+// reply, so its length isn't limited by the 16-bit length of a request or reply.
+typedef struct _ebpf_operation_buffer_descriptor
+{
+    uint64_t address;
+    uint64_t length;
+} ebpf_operation_buffer_descriptor_t;
+
+typedef struct _ebpf_operation_map_update_element_batch_buffer_request
+{
+    struct _ebpf_operation_header header;
+    ebpf_handle_t handle;
+    ebpf_map_option_t option;
+    // Count of elements is derived from the length of the buffer.
+    // Data is a concatenation of key+value.
+    ebpf_operation_buffer_descriptor_t data;
+} ebpf_operation_map_update_element_batch_buffer_request_t;
+
+typedef struct _ebpf_operation_map_update_element_batch_buffer_reply
+{
+    struct _ebpf_operation_header header;
+    uint64_t count_of_elements_processed;
+    // An ebpf_result_t. Result of the element after the processed ones, EBPF_SUCCESS if every element was processed.
+    // A failing element completes the operation successfully, so the reply reaches the caller.
+    uint32_t result;
+} ebpf_operation_map_update_element_batch_buffer_reply_t;
+
+typedef struct _ebpf_operation_map_get_next_key_value_batch_buffer_request
+{
+    struct _ebpf_operation_header header;
+    ebpf_handle_t handle;
+    bool find_and_delete;
+    // Resume from cursor instead of previous_key. Only supported by maps backed by a hash table.
+    bool use_cursor;
+    // Opaque cursor from the previous reply, or 0 to start from the beginning of the map.
+    uint64_t cursor;
+    // Buffer that receives a concatenation of key+value.
+    ebpf_operation_buffer_descriptor_t data;
+    uint8_t previous_key[1];
+} ebpf_operation_map_get_next_key_value_batch_buffer_request_t;
+
+typedef struct _ebpf_operation_map_get_next_key_value_batch_buffer_reply
+{
+    struct _ebpf_operation_header header;
+    // Cursor to pass in the next request if the request used a cursor. It is never 0 and never exceeds 2^32.
+    uint64_t cursor;
+    // Count of elements is derived from the number of bytes written to the buffer.
+    uint64_t data_length;
+} ebpf_operation_map_get_next_key_value_batch_buffer_reply_t;
+
+typedef enum _ebpf_map_ring_operation
+{
+    EBPF_MAP_RING_OPERATION_LOOKUP,
+    EBPF_MAP_RING_OPERATION_UPDATE,
+    EBPF_MAP_RING_OPERATION_DELETE,
+} ebpf_map_ring_operation_t;
+
+// A map operation queued in a map ring. Keys and values are stored in the data area of the ring.
+typedef struct _ebpf_map_ring_submission
+{
+    uint64_t user_data;
+    ebpf_handle_t map_handle;
+    uint32_t operation; // An ebpf_map_ring_operation_t.
+    uint32_t option;    // An ebpf_map_option_t, used by updates.
+    uint32_t key_offset;
+    uint32_t value_offset; // Offset of the value of an update or of the buffer that receives the value of a lookup.
+    uint32_t value_length; // Zero for deletes.
+    uint32_t reserved;
+} ebpf_map_ring_submission_t;
+
+typedef struct _ebpf_map_ring_completion
+{
+    uint64_t user_data;
+    uint32_t result; // An ebpf_result_t.
+    uint32_t reserved;
+} ebpf_map_ring_completion_t;
+
+// A map ring lives in the calling process and is laid out as this header, entry_count submissions, entry_count
+// completions and then the data area. entry_count is a power of two and the indices increase freely, being reduced
+// modulo entry_count when used. The caller advances submission_tail and completion_head, the execution context
+// advances submission_head and completion_tail.
+typedef struct _ebpf_map_ring_header
+{
+    uint32_t entry_count;
+    uint32_t submission_head;
+    uint32_t submission_tail;
+    uint32_t completion_head;
+    uint32_t completion_tail;
+    uint32_t reserved[3];
+} ebpf_map_ring_header_t;
+
+typedef struct _ebpf_operation_map_ring_submit_request
+{
+    struct _ebpf_operation_header header;
+    ebpf_operation_buffer_descriptor_t ring;
+} ebpf_operation_map_ring_submit_request_t;
+
+typedef struct _ebpf_operation_map_ring_submit_reply
+{
+    struct _ebpf_operation_header header;
+    uint32_t count_of_entries_processed;
+} ebpf_operation_map_ring_submit_reply_t;
+
+typedef struct _ebpf_operation_set_program_statistics_request
+{
+    struct _ebpf_operation_header header;
+    uint32_t enabled;
+} ebpf_operation_set_program_statistics_request_t;
+
+typedef struct _ebpf_operation_map_mmap_request
+{
+    struct _ebpf_operation_header header;
+    ebpf_handle_t map_handle;
+} ebpf_operation_map_mmap_request_t;
+
+typedef struct _ebpf_operation_map_mmap_reply
+{
+    struct _ebpf_operation_header header;
+    // Address of the map values in the calling process.
+    uint64_t address;
+} ebpf_operation_map_mmap_reply_t;
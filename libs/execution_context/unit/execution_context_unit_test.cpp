@@ -6,6 +6,7 @@
 #include "catch_wrapper.hpp"
 #include "ebpf_async.h"
 #include "ebpf_core.h"
+#include "ebpf_handle.h"
 #include "ebpf_maps.h"
 #include "ebpf_object.h"
 #include "ebpf_program.h"
@@ -13,8 +14,11 @@
 #include "helpers.h"
 #include "test_helper.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <optional>
 #include <set>
+#include <thread>
 
 typedef struct _free_trampoline_table
 {
@@ -293,6 +297,7 @@ _test_crud_operations(ebpf_map_type_t map_type)
                 map.get(),
                 sizeof(previous_key),
                 index == 0 ? nullptr : reinterpret_cast<uint8_t*>(&previous_key),
+                nullptr,
                 &batch_data_size,
                 batch_data.data(),
                 0);
@@ -389,6 +394,189 @@ MAP_TEST(BPF_MAP_TYPE_PERCPU_ARRAY);
 MAP_TEST(BPF_MAP_TYPE_LRU_HASH);
 MAP_TEST(BPF_MAP_TYPE_LRU_PERCPU_HASH);
 
+TEST_CASE("map_update_in_place", "[execution_context]")
+{
+    _ebpf_core_initializer core;
+    core.initialize();
+
+    ebpf_map_definition_in_memory_t map_definition{BPF_MAP_TYPE_HASH, sizeof(uint32_t), sizeof(uint64_t), 10};
+    map_ptr map;
+    {
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        REQUIRE(
+            ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) == EBPF_SUCCESS);
+        map.reset(local_map);
+    }
+
+    uint32_t key = 1;
+    uint64_t value = 10;
+
+    // BPF_F_LOCK with BPF_EXIST requires the key to be present.
+    REQUIRE(
+        ebpf_map_update_entry(
+            map.get(),
+            sizeof(key),
+            reinterpret_cast<uint8_t*>(&key),
+            sizeof(value),
+            reinterpret_cast<uint8_t*>(&value),
+            static_cast<ebpf_map_option_t>(EBPF_EXIST | BPF_F_LOCK),
+            0) == EBPF_KEY_NOT_FOUND);
+
+    // BPF_F_LOCK with BPF_ANY inserts the key if it is missing.
+    REQUIRE(
+        ebpf_map_update_entry(
+            map.get(),
+            sizeof(key),
+            reinterpret_cast<uint8_t*>(&key),
+            sizeof(value),
+            reinterpret_cast<uint8_t*>(&value),
+            static_cast<ebpf_map_option_t>(EBPF_ANY | BPF_F_LOCK),
+            0) == EBPF_SUCCESS);
+
+    uint64_t* original_value = nullptr;
+    REQUIRE(
+        ebpf_map_find_entry(
+            map.get(),
+            sizeof(key),
+            reinterpret_cast<uint8_t*>(&key),
+            sizeof(original_value),
+            reinterpret_cast<uint8_t*>(&original_value),
+            EBPF_MAP_FLAG_HELPER) == EBPF_SUCCESS);
+    REQUIRE(*original_value == 10);
+
+    // Updating an existing key reuses the value storage.
+    value = 20;
+    REQUIRE(
+        ebpf_map_update_entry(
+            map.get(),
+            sizeof(key),
+            reinterpret_cast<uint8_t*>(&key),
+            sizeof(value),
+            reinterpret_cast<uint8_t*>(&value),
+            static_cast<ebpf_map_option_t>(EBPF_EXIST | BPF_F_LOCK),
+            0) == EBPF_SUCCESS);
+
+    uint64_t* updated_value = nullptr;
+    REQUIRE(
+        ebpf_map_find_entry(
+            map.get(),
+            sizeof(key),
+            reinterpret_cast<uint8_t*>(&key),
+            sizeof(updated_value),
+            reinterpret_cast<uint8_t*>(&updated_value),
+            EBPF_MAP_FLAG_HELPER) == EBPF_SUCCESS);
+    REQUIRE(updated_value == original_value);
+    REQUIRE(*updated_value == 20);
+
+    // Arrays are always updated in place, so BPF_F_LOCK doesn't change which options are valid.
+    map_definition.type = BPF_MAP_TYPE_ARRAY;
+    map_ptr array_map;
+    {
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        REQUIRE(
+            ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) == EBPF_SUCCESS);
+        array_map.reset(local_map);
+    }
+    REQUIRE(
+        ebpf_map_update_entry(
+            array_map.get(),
+            sizeof(key),
+            reinterpret_cast<uint8_t*>(&key),
+            sizeof(value),
+            reinterpret_cast<uint8_t*>(&value),
+            static_cast<ebpf_map_option_t>(EBPF_NOEXIST | BPF_F_LOCK),
+            0) == EBPF_INVALID_ARGUMENT);
+    REQUIRE(
+        ebpf_map_update_entry(
+            array_map.get(),
+            sizeof(key),
+            reinterpret_cast<uint8_t*>(&key),
+            sizeof(value),
+            reinterpret_cast<uint8_t*>(&value),
+            static_cast<ebpf_map_option_t>(EBPF_ANY | BPF_F_LOCK),
+            0) == EBPF_SUCCESS);
+
+    // Other maps reject BPF_F_LOCK rather than ignoring it.
+    ebpf_map_definition_in_memory_t queue_map_definition{BPF_MAP_TYPE_QUEUE, 0, sizeof(uint64_t), 10};
+    map_ptr queue_map;
+    {
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        REQUIRE(
+            ebpf_map_create(&map_name, &queue_map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) ==
+            EBPF_SUCCESS);
+        queue_map.reset(local_map);
+    }
+    REQUIRE(
+        ebpf_map_update_entry(
+            queue_map.get(),
+            0,
+            nullptr,
+            sizeof(value),
+            reinterpret_cast<uint8_t*>(&value),
+            static_cast<ebpf_map_option_t>(EBPF_ANY | BPF_F_LOCK),
+            0) == EBPF_INVALID_ARGUMENT);
+}
+
+TEST_CASE("map_freeze", "[execution_context]")
+{
+    _ebpf_core_initializer core;
+    core.initialize();
+
+    ebpf_map_definition_in_memory_t map_definition{BPF_MAP_TYPE_ARRAY, sizeof(uint32_t), sizeof(uint64_t), 1};
+    map_ptr map;
+    {
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        REQUIRE(
+            ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) == EBPF_SUCCESS);
+        map.reset(local_map);
+    }
+
+    uint32_t key = 0;
+    uint64_t value = 10;
+    REQUIRE(
+        ebpf_map_update_entry(
+            map.get(),
+            sizeof(key),
+            reinterpret_cast<uint8_t*>(&key),
+            sizeof(value),
+            reinterpret_cast<uint8_t*>(&value),
+            EBPF_ANY,
+            0) == EBPF_SUCCESS);
+
+    ebpf_map_freeze(map.get());
+
+    // Updates and deletes from user mode and from helpers are rejected.
+    uint64_t new_value = 20;
+    for (int flags : {0, EBPF_MAP_FLAG_HELPER}) {
+        REQUIRE(
+            ebpf_map_update_entry(
+                map.get(),
+                sizeof(key),
+                reinterpret_cast<uint8_t*>(&key),
+                sizeof(new_value),
+                reinterpret_cast<uint8_t*>(&new_value),
+                EBPF_ANY,
+                flags) == EBPF_ACCESS_DENIED);
+    }
+    REQUIRE(ebpf_map_delete_entry(map.get(), sizeof(key), reinterpret_cast<uint8_t*>(&key), 0) == EBPF_ACCESS_DENIED);
+
+    // Lookups still return the value the map was frozen with.
+    uint64_t found_value = 0;
+    REQUIRE(
+        ebpf_map_find_entry(
+            map.get(),
+            sizeof(key),
+            reinterpret_cast<uint8_t*>(&key),
+            sizeof(found_value),
+            reinterpret_cast<uint8_t*>(&found_value),
+            0) == EBPF_SUCCESS);
+    REQUIRE(found_value == value);
+}
+
 TEST_CASE("map_crud_operations_lpm_trie_32", "[execution_context]")
 {
     _ebpf_core_initializer core;
@@ -694,6 +882,142 @@ TEST_CASE("map_crud_operations_queue", "[execution_context]")
         EBPF_INVALID_ARGUMENT);
 }
 
+TEST_CASE("map_queue_multiple_producers_consumers", "[execution_context]")
+{
+    _ebpf_core_initializer core;
+    core.initialize();
+    const uint32_t thread_count = 4;
+    const uint32_t values_per_producer = 10000;
+    ebpf_map_definition_in_memory_t map_definition{BPF_MAP_TYPE_QUEUE, 0, sizeof(uint32_t), 16};
+    map_ptr map;
+    {
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        REQUIRE(
+            ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) == EBPF_SUCCESS);
+        map.reset(local_map);
+    }
+
+    // Producers push distinct values into a small queue while consumers drain it. Every value must be popped once.
+    std::atomic<uint32_t> popped_count = 0;
+    std::vector<std::vector<uint32_t>> popped_values(thread_count);
+    std::vector<std::thread> threads;
+    for (uint32_t thread_index = 0; thread_index < thread_count; thread_index++) {
+        threads.emplace_back([&, thread_index]() {
+            for (uint32_t index = 0; index < values_per_producer; index++) {
+                uint32_t value = thread_index * values_per_producer + index;
+                while (ebpf_map_push_entry(map.get(), sizeof(value), reinterpret_cast<uint8_t*>(&value), 0) ==
+                       EBPF_OUT_OF_SPACE) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&, thread_index]() {
+            while (popped_count < thread_count * values_per_producer) {
+                uint32_t value;
+                if (ebpf_map_pop_entry(map.get(), sizeof(value), reinterpret_cast<uint8_t*>(&value), 0) ==
+                    EBPF_SUCCESS) {
+                    popped_values[thread_index].push_back(value);
+                    popped_count++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<bool> seen(thread_count * values_per_producer);
+    for (const auto& values : popped_values) {
+        // Values from one producer are popped in the order they were pushed.
+        std::vector<uint32_t> last_value(thread_count, UINT32_MAX);
+        for (uint32_t value : values) {
+            REQUIRE(value < seen.size());
+            REQUIRE(!seen[value]);
+            seen[value] = true;
+            uint32_t producer = value / values_per_producer;
+            REQUIRE((last_value[producer] == UINT32_MAX || last_value[producer] < value));
+            last_value[producer] = value;
+        }
+    }
+    REQUIRE(std::all_of(seen.begin(), seen.end(), [](bool value) { return value; }));
+
+    uint32_t value;
+    REQUIRE(
+        ebpf_map_pop_entry(map.get(), sizeof(value), reinterpret_cast<uint8_t*>(&value), 0) == EBPF_OBJECT_NOT_FOUND);
+}
+
+TEST_CASE("map_queue_replace_with_consumers", "[execution_context]")
+{
+    _ebpf_core_initializer core;
+    core.initialize();
+    const uint32_t consumer_count = 2;
+    const uint32_t value_count = 100000;
+    const uint32_t capacity = 4;
+    ebpf_map_definition_in_memory_t map_definition{BPF_MAP_TYPE_QUEUE, 0, sizeof(uint32_t), capacity};
+    map_ptr map;
+    {
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        REQUIRE(
+            ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) == EBPF_SUCCESS);
+        map.reset(local_map);
+    }
+
+    // A single producer replaces the oldest value while consumers drain the queue. The push of value N can only
+    // drop value N - capacity, so no value pushed in the last lap may be lost.
+    std::atomic<bool> producer_done = false;
+    std::atomic<uint32_t> failed_push_count = 0;
+    std::vector<std::vector<uint32_t>> popped_values(consumer_count + 1);
+    std::vector<std::thread> threads;
+    threads.emplace_back([&]() {
+        for (uint32_t value = 0; value < value_count; value++) {
+            if (ebpf_map_push_entry(map.get(), sizeof(value), reinterpret_cast<uint8_t*>(&value), BPF_EXIST) !=
+                EBPF_SUCCESS) {
+                failed_push_count++;
+            }
+        }
+        producer_done = true;
+    });
+    for (uint32_t thread_index = 0; thread_index < consumer_count; thread_index++) {
+        threads.emplace_back([&, thread_index]() {
+            while (!producer_done) {
+                uint32_t value;
+                if (ebpf_map_pop_entry(map.get(), sizeof(value), reinterpret_cast<uint8_t*>(&value), 0) ==
+                    EBPF_SUCCESS) {
+                    popped_values[thread_index].push_back(value);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(failed_push_count == 0);
+
+    uint32_t value;
+    while (ebpf_map_pop_entry(map.get(), sizeof(value), reinterpret_cast<uint8_t*>(&value), 0) == EBPF_SUCCESS) {
+        popped_values[consumer_count].push_back(value);
+    }
+
+    std::vector<bool> seen(value_count);
+    for (const auto& values : popped_values) {
+        uint32_t last_value = UINT32_MAX;
+        for (uint32_t popped_value : values) {
+            REQUIRE(popped_value < seen.size());
+            REQUIRE(!seen[popped_value]);
+            seen[popped_value] = true;
+            REQUIRE((last_value == UINT32_MAX || last_value < popped_value));
+            last_value = popped_value;
+        }
+    }
+    for (uint32_t index = value_count - capacity; index < value_count; index++) {
+        REQUIRE(seen[index]);
+    }
+}
+
 TEST_CASE("map_crud_operations_stack", "[execution_context]")
 {
     _ebpf_core_initializer core;
@@ -746,6 +1070,443 @@ TEST_CASE("map_crud_operations_stack", "[execution_context]")
         EBPF_OBJECT_NOT_FOUND);
 }
 
+TEST_CASE("map_crud_operations_bloom_filter", "[execution_context]")
+{
+    _ebpf_core_initializer core;
+    core.initialize();
+    ebpf_map_definition_in_memory_t map_definition{BPF_MAP_TYPE_BLOOM_FILTER, 0, sizeof(uint32_t), 100};
+    map_ptr map;
+    {
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        REQUIRE(
+            ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) == EBPF_SUCCESS);
+        map.reset(local_map);
+    }
+    uint32_t value = 0;
+
+    // Should be empty.
+    REQUIRE(
+        ebpf_map_peek_entry(map.get(), sizeof(value), reinterpret_cast<uint8_t*>(&value), 0) == EBPF_KEY_NOT_FOUND);
+
+    for (value = 0; value < 100; value++) {
+        REQUIRE(ebpf_map_push_entry(map.get(), sizeof(value), reinterpret_cast<uint8_t*>(&value), 0) == EBPF_SUCCESS);
+    }
+
+    // Every pushed value is found and the peek leaves the value unchanged.
+    for (uint32_t pushed_value = 0; pushed_value < 100; pushed_value++) {
+        value = pushed_value;
+        REQUIRE(
+            ebpf_map_peek_entry(map.get(), sizeof(value), reinterpret_cast<uint8_t*>(&value), 0) == EBPF_SUCCESS);
+        REQUIRE(value == pushed_value);
+    }
+
+    // User mode lookups pass the value to test as the key.
+    uint32_t key = 42;
+    value = 0;
+    REQUIRE(
+        ebpf_map_find_entry(
+            map.get(),
+            sizeof(key),
+            reinterpret_cast<uint8_t*>(&key),
+            sizeof(value),
+            reinterpret_cast<uint8_t*>(&value),
+            0) == EBPF_SUCCESS);
+    REQUIRE(value == key);
+
+    // The default of 5 hash functions gives a false positive rate of about 1%.
+    size_t false_positives = 0;
+    for (value = 1000; value < 11000; value++) {
+        if (ebpf_map_peek_entry(map.get(), sizeof(value), reinterpret_cast<uint8_t*>(&value), 0) == EBPF_SUCCESS) {
+            false_positives++;
+        }
+    }
+    REQUIRE(false_positives < 500);
+
+    // Negative tests.
+    REQUIRE(
+        ebpf_map_push_entry(map.get(), sizeof(value), reinterpret_cast<uint8_t*>(&value), BPF_EXIST) ==
+        EBPF_INVALID_ARGUMENT);
+
+    REQUIRE(
+        ebpf_map_push_entry(map.get(), sizeof(value) - 1, reinterpret_cast<uint8_t*>(&value), 0) ==
+        EBPF_INVALID_ARGUMENT);
+
+    REQUIRE(
+        ebpf_map_pop_entry(map.get(), sizeof(value), reinterpret_cast<uint8_t*>(&value), 0) ==
+        EBPF_OPERATION_NOT_SUPPORTED);
+
+    REQUIRE(
+        ebpf_map_find_entry(
+            map.get(),
+            sizeof(key),
+            reinterpret_cast<uint8_t*>(&key),
+            sizeof(value),
+            reinterpret_cast<uint8_t*>(&value),
+            EBPF_MAP_FIND_FLAG_DELETE) == EBPF_OPERATION_NOT_SUPPORTED);
+
+    REQUIRE(
+        ebpf_map_delete_entry(map.get(), sizeof(key), reinterpret_cast<uint8_t*>(&key), 0) == EBPF_INVALID_ARGUMENT);
+
+    // The hash count is limited to 15.
+    {
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        map_definition.map_extra = 16;
+        REQUIRE(
+            ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) ==
+            EBPF_INVALID_ARGUMENT);
+
+        map_definition.map_extra = 1;
+        REQUIRE(
+            ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) == EBPF_SUCCESS);
+        map_ptr single_hash_map(local_map);
+
+        // Only bloom filters take map_extra.
+        ebpf_map_definition_in_memory_t hash_map_definition{BPF_MAP_TYPE_HASH, sizeof(uint32_t), sizeof(uint32_t), 10};
+        hash_map_definition.map_extra = 1;
+        REQUIRE(
+            ebpf_map_create(&map_name, &hash_map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) ==
+            EBPF_INVALID_ARGUMENT);
+    }
+}
+
+TEST_CASE("map_mmap_array", "[execution_context]")
+{
+    _ebpf_core_initializer core;
+    core.initialize();
+    ebpf_map_definition_in_memory_t map_definition{BPF_MAP_TYPE_ARRAY, sizeof(uint32_t), sizeof(uint64_t), 10};
+    map_definition.map_flags = BPF_F_MMAPABLE;
+    map_ptr map;
+    {
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        REQUIRE(
+            ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) == EBPF_SUCCESS);
+        map.reset(local_map);
+    }
+
+    // Any value identifies the handle instance the mappings belong to.
+    const void* instance = &map;
+    uint64_t* values = nullptr;
+    REQUIRE(ebpf_map_mmap(map.get(), instance, reinterpret_cast<uint8_t**>(&values)) == EBPF_SUCCESS);
+    REQUIRE(values != nullptr);
+
+    // Writes through the mapping are visible to lookups and updates are visible through the mapping.
+    for (uint32_t key = 0; key < 10; key++) {
+        REQUIRE(values[key] == 0);
+        values[key] = key * 2;
+    }
+    for (uint32_t key = 0; key < 10; key++) {
+        uint64_t value = 0;
+        REQUIRE(
+            ebpf_map_find_entry(
+                map.get(),
+                sizeof(key),
+                reinterpret_cast<uint8_t*>(&key),
+                sizeof(value),
+                reinterpret_cast<uint8_t*>(&value),
+                0) == EBPF_SUCCESS);
+        REQUIRE(value == key * 2);
+
+        value = key * 3;
+        REQUIRE(
+            ebpf_map_update_entry(
+                map.get(),
+                sizeof(key),
+                reinterpret_cast<uint8_t*>(&key),
+                sizeof(value),
+                reinterpret_cast<uint8_t*>(&value),
+                EBPF_ANY,
+                0) == EBPF_SUCCESS);
+        REQUIRE(values[key] == key * 3);
+    }
+    ebpf_map_release_user_mappings(map.get(), instance);
+
+    // Arrays created without the flag can't be mapped.
+    map_definition.map_flags = 0;
+    map_ptr unmapped_map;
+    {
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        REQUIRE(
+            ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) == EBPF_SUCCESS);
+        unmapped_map.reset(local_map);
+    }
+    REQUIRE(
+        ebpf_map_mmap(unmapped_map.get(), instance, reinterpret_cast<uint8_t**>(&values)) ==
+        EBPF_OPERATION_NOT_SUPPORTED);
+
+    // Only arrays can be created with the flag.
+    map_definition.type = BPF_MAP_TYPE_HASH;
+    map_definition.map_flags = BPF_F_MMAPABLE;
+    ebpf_map_t* hash_map;
+    cxplat_utf8_string_t map_name = {0};
+    REQUIRE(
+        ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &hash_map) ==
+        EBPF_INVALID_ARGUMENT);
+}
+
+TEST_CASE("map_mmap_array_handle_close", "[execution_context]")
+{
+    _ebpf_core_initializer core;
+    core.initialize();
+    ebpf_map_definition_in_memory_t map_definition{BPF_MAP_TYPE_ARRAY, sizeof(uint32_t), sizeof(uint64_t), 10};
+    map_definition.map_flags = BPF_F_MMAPABLE;
+    map_ptr map;
+    {
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        REQUIRE(
+            ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) == EBPF_SUCCESS);
+        map.reset(local_map);
+    }
+
+    bpf_map_info info = {};
+    uint16_t info_size = sizeof(info);
+    REQUIRE(ebpf_map_get_info(map.get(), reinterpret_cast<uint8_t*>(&info), &info_size) == EBPF_SUCCESS);
+
+    ebpf_handle_t handle;
+    REQUIRE(ebpf_handle_create(&handle, reinterpret_cast<ebpf_base_object_t*>(map.get())) == EBPF_SUCCESS);
+    const void* instance = nullptr;
+    REQUIRE(ebpf_handle_get_instance(handle, &instance) == EBPF_SUCCESS);
+
+    // Each mapping holds a reference on the map.
+    uint64_t* values = nullptr;
+    REQUIRE(ebpf_map_mmap(map.get(), instance, reinterpret_cast<uint8_t**>(&values)) == EBPF_SUCCESS);
+    REQUIRE(ebpf_map_mmap(map.get(), instance, reinterpret_cast<uint8_t**>(&values)) == EBPF_SUCCESS);
+    values[0] = 1;
+
+    // Closing the last handle to the instance removes its mappings, after which the map is freed with its last
+    // reference.
+    REQUIRE(ebpf_handle_close(handle) == EBPF_SUCCESS);
+    REQUIRE(ebpf_handle_get_instance(handle, &instance) == EBPF_INVALID_OBJECT);
+    map.reset();
+
+    ebpf_core_object_t* object = nullptr;
+    REQUIRE(EBPF_OBJECT_REFERENCE_BY_ID(info.id, EBPF_OBJECT_MAP, &object) != EBPF_SUCCESS);
+}
+
+TEST_CASE("map_per_cpu_value_layout", "[execution_context]")
+{
+    _ebpf_core_initializer core;
+    core.initialize();
+    uint32_t cpu_count = ebpf_get_cpu_count();
+    // Per-CPU slots in user mode are packed 8 bytes apart, even when map storage gives each CPU a cache line.
+    const size_t packed_stride = EBPF_PAD_8(sizeof(uint32_t));
+
+    for (auto [map_type, map_flags] : std::vector<std::pair<ebpf_map_type_t, uint32_t>>{
+             {BPF_MAP_TYPE_PERCPU_ARRAY, 0},
+             {BPF_MAP_TYPE_PERCPU_HASH, 0},
+             {BPF_MAP_TYPE_PERCPU_ARRAY, BPF_F_PERCPU_CACHE_ALIGN},
+             {BPF_MAP_TYPE_PERCPU_HASH, BPF_F_PERCPU_CACHE_ALIGN}}) {
+        ebpf_map_definition_in_memory_t map_definition{map_type, sizeof(uint32_t), sizeof(uint32_t), 10};
+        map_definition.map_flags = map_flags;
+        map_ptr map;
+        {
+            ebpf_map_t* local_map;
+            cxplat_utf8_string_t map_name = {0};
+            REQUIRE(
+                ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) ==
+                EBPF_SUCCESS);
+            map.reset(local_map);
+        }
+        REQUIRE(ebpf_map_get_definition(map.get())->value_size == cpu_count * packed_stride);
+
+        // Values written by each CPU are returned packed to user mode.
+        uint32_t key = 0;
+        for (uint32_t cpu = 0; cpu < cpu_count; cpu++) {
+            emulate_dpc_t dpc(cpu);
+            uint32_t value = cpu + 1;
+            REQUIRE(
+                ebpf_map_update_entry(
+                    map.get(),
+                    0,
+                    reinterpret_cast<uint8_t*>(&key),
+                    0,
+                    reinterpret_cast<uint8_t*>(&value),
+                    EBPF_ANY,
+                    EBPF_MAP_FLAG_HELPER) == EBPF_SUCCESS);
+        }
+        std::vector<uint8_t> packed_value(cpu_count * packed_stride);
+        REQUIRE(
+            ebpf_map_find_entry(
+                map.get(),
+                sizeof(key),
+                reinterpret_cast<uint8_t*>(&key),
+                packed_value.size(),
+                packed_value.data(),
+                0) == EBPF_SUCCESS);
+        for (uint32_t cpu = 0; cpu < cpu_count; cpu++) {
+            REQUIRE(*reinterpret_cast<uint32_t*>(packed_value.data() + cpu * packed_stride) == cpu + 1);
+        }
+
+        // Packed values from user mode are visible to each CPU.
+        for (uint32_t cpu = 0; cpu < cpu_count; cpu++) {
+            *reinterpret_cast<uint32_t*>(packed_value.data() + cpu * packed_stride) = (cpu + 1) * 10;
+        }
+        REQUIRE(
+            ebpf_map_update_entry(
+                map.get(),
+                sizeof(key),
+                reinterpret_cast<uint8_t*>(&key),
+                packed_value.size(),
+                packed_value.data(),
+                EBPF_ANY,
+                0) == EBPF_SUCCESS);
+        for (uint32_t cpu = 0; cpu < cpu_count; cpu++) {
+            emulate_dpc_t dpc(cpu);
+            uint32_t* value = nullptr;
+            REQUIRE(
+                ebpf_map_find_entry(
+                    map.get(),
+                    0,
+                    reinterpret_cast<uint8_t*>(&key),
+                    0,
+                    reinterpret_cast<uint8_t*>(&value),
+                    EBPF_MAP_FLAG_HELPER) == EBPF_SUCCESS);
+            REQUIRE(*value == (cpu + 1) * 10);
+        }
+    }
+
+    // Only per-CPU maps can space their values a cache line apart.
+    ebpf_map_definition_in_memory_t map_definition{BPF_MAP_TYPE_ARRAY, sizeof(uint32_t), sizeof(uint32_t), 10};
+    map_definition.map_flags = BPF_F_PERCPU_CACHE_ALIGN;
+    ebpf_map_t* local_map;
+    cxplat_utf8_string_t map_name = {0};
+    REQUIRE(
+        ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) ==
+        EBPF_INVALID_ARGUMENT);
+}
+
+TEST_CASE("map_batch_cursor", "[execution_context]")
+{
+    _ebpf_core_initializer core;
+    core.initialize();
+    const uint32_t entry_count = 1000;
+    const size_t entry_size = sizeof(uint32_t) + sizeof(uint64_t);
+
+    ebpf_map_definition_in_memory_t map_definition{BPF_MAP_TYPE_HASH, sizeof(uint32_t), sizeof(uint64_t), entry_count};
+    map_ptr map;
+    {
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        REQUIRE(
+            ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) == EBPF_SUCCESS);
+        map.reset(local_map);
+    }
+    for (uint32_t key = 0; key < entry_count; key++) {
+        uint64_t value = static_cast<uint64_t>(key) * key;
+        REQUIRE(
+            ebpf_map_update_entry(
+                map.get(),
+                sizeof(key),
+                reinterpret_cast<uint8_t*>(&key),
+                sizeof(value),
+                reinterpret_cast<uint8_t*>(&value),
+                EBPF_ANY,
+                0) == EBPF_SUCCESS);
+    }
+
+    // Each key is returned exactly once, whatever the size of the batch.
+    for (size_t batch_count : {size_t{17}, size_t{100}, size_t{entry_count * 2}}) {
+        std::vector<uint8_t> batch_data(batch_count * entry_size);
+        std::set<uint32_t> keys;
+        uint64_t cursor = 0;
+        for (;;) {
+            size_t batch_data_size = batch_data.size();
+            ebpf_result_t result = ebpf_map_get_next_key_and_value_batch(
+                map.get(), 0, nullptr, &cursor, &batch_data_size, batch_data.data(), 0);
+            if (result == EBPF_NO_MORE_KEYS) {
+                break;
+            }
+            REQUIRE(result == EBPF_SUCCESS);
+            REQUIRE(batch_data_size != 0);
+            REQUIRE(batch_data_size <= batch_data.size());
+            REQUIRE(cursor != 0);
+
+            for (size_t offset = 0; offset < batch_data_size; offset += entry_size) {
+                uint32_t key = *reinterpret_cast<uint32_t*>(&batch_data[offset]);
+                uint64_t value = *reinterpret_cast<uint64_t*>(&batch_data[offset + sizeof(uint32_t)]);
+                REQUIRE(value == static_cast<uint64_t>(key) * key);
+                REQUIRE(keys.insert(key).second);
+            }
+        }
+        REQUIRE(keys.size() == entry_count);
+    }
+
+    // A buffer that can't hold a single entry is rejected.
+    {
+        uint64_t cursor = 0;
+        std::vector<uint8_t> batch_data(entry_size - 1);
+        size_t batch_data_size = batch_data.size();
+        REQUIRE(
+            ebpf_map_get_next_key_and_value_batch(
+                map.get(), 0, nullptr, &cursor, &batch_data_size, batch_data.data(), 0) == EBPF_INSUFFICIENT_BUFFER);
+        REQUIRE(cursor == 0);
+    }
+
+    // A cursor can't be combined with a previous key.
+    {
+        uint64_t cursor = 0;
+        uint32_t previous_key = 0;
+        std::vector<uint8_t> batch_data(entry_size);
+        size_t batch_data_size = batch_data.size();
+        REQUIRE(
+            ebpf_map_get_next_key_and_value_batch(
+                map.get(),
+                sizeof(previous_key),
+                reinterpret_cast<uint8_t*>(&previous_key),
+                &cursor,
+                &batch_data_size,
+                batch_data.data(),
+                0) == EBPF_INVALID_ARGUMENT);
+    }
+
+    // Find and delete empties the map.
+    {
+        std::vector<uint8_t> batch_data(100 * entry_size);
+        uint64_t cursor = 0;
+        size_t returned_count = 0;
+        for (;;) {
+            size_t batch_data_size = batch_data.size();
+            ebpf_result_t result = ebpf_map_get_next_key_and_value_batch(
+                map.get(), 0, nullptr, &cursor, &batch_data_size, batch_data.data(), EBPF_MAP_FIND_FLAG_DELETE);
+            if (result == EBPF_NO_MORE_KEYS) {
+                break;
+            }
+            REQUIRE(result == EBPF_SUCCESS);
+            returned_count += batch_data_size / entry_size;
+        }
+        REQUIRE(returned_count == entry_count);
+
+        uint32_t next_key;
+        REQUIRE(
+            ebpf_map_next_key(map.get(), sizeof(next_key), nullptr, reinterpret_cast<uint8_t*>(&next_key)) ==
+            EBPF_NO_MORE_KEYS);
+    }
+
+    // Maps not backed by a hash table are walked by key.
+    {
+        ebpf_map_definition_in_memory_t array_definition{BPF_MAP_TYPE_ARRAY, sizeof(uint32_t), sizeof(uint64_t), 10};
+        map_ptr array_map;
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        REQUIRE(
+            ebpf_map_create(&map_name, &array_definition, (uintptr_t)ebpf_handle_invalid, &local_map) ==
+            EBPF_SUCCESS);
+        array_map.reset(local_map);
+
+        uint64_t cursor = 0;
+        std::vector<uint8_t> batch_data(entry_size);
+        size_t batch_data_size = batch_data.size();
+        REQUIRE(
+            ebpf_map_get_next_key_and_value_batch(
+                array_map.get(), 0, nullptr, &cursor, &batch_data_size, batch_data.data(), 0) ==
+            EBPF_OPERATION_NOT_SUPPORTED);
+    }
+}
+
 #define TEST_FUNCTION_RETURN 42
 #define TOTAL_HELPER_COUNT 3
 
@@ -1057,6 +1818,95 @@ TEST_CASE("ring_buffer_async_query", "[execution_context]")
     }
 }
 
+TEST_CASE("perf_event_array_async_query", "[execution_context]")
+{
+    _ebpf_core_initializer core;
+    core.initialize();
+    ebpf_map_definition_in_memory_t map_definition{BPF_MAP_TYPE_PERF_EVENT_ARRAY, 0, 0, 64 * 1024};
+    map_ptr map;
+    {
+        ebpf_map_t* local_map;
+        cxplat_utf8_string_t map_name = {0};
+        REQUIRE(
+            ebpf_map_create(&map_name, &map_definition, (uintptr_t)ebpf_handle_invalid, &local_map) == EBPF_SUCCESS);
+        map.reset(local_map);
+    }
+
+    // Run on CPU 0 so that records written to the current CPU land in its buffer.
+    uintptr_t old_thread_affinity;
+    REQUIRE(ebpf_set_current_thread_affinity(1, &old_thread_affinity) == EBPF_SUCCESS);
+
+    struct _completion
+    {
+        uint8_t* buffer = nullptr;
+        size_t consumer_offset = 0;
+        ebpf_perf_event_array_map_async_query_result_t async_query_result = {};
+        uint64_t value{};
+    } completion;
+
+    REQUIRE(
+        ebpf_perf_event_array_map_query_buffer(map.get(), 0, &completion.buffer, &completion.consumer_offset) ==
+        EBPF_SUCCESS);
+
+    REQUIRE(
+        ebpf_async_set_completion_callback(
+            &completion, [](_Inout_ void* context, size_t output_buffer_length, ebpf_result_t result) {
+                UNREFERENCED_PARAMETER(output_buffer_length);
+                auto completion = reinterpret_cast<_completion*>(context);
+                auto async_query_result = &completion->async_query_result.ring_buffer;
+                auto record = ebpf_ring_buffer_next_record(
+                    completion->buffer, 64 * 1024, async_query_result->consumer, async_query_result->producer);
+                completion->value = *(uint64_t*)(record->data);
+                REQUIRE(result == EBPF_SUCCESS);
+            }) == EBPF_SUCCESS);
+
+    ebpf_result_t result =
+        ebpf_perf_event_array_map_async_query(map.get(), 0, &completion.async_query_result, &completion);
+    if (result != EBPF_PENDING) {
+        REQUIRE(ebpf_async_reset_completion_callback(&completion) == EBPF_SUCCESS);
+    }
+    REQUIRE(result == EBPF_PENDING);
+
+    uint64_t value = 1;
+    REQUIRE(
+        ebpf_perf_event_array_map_output(
+            map.get(), BPF_F_CURRENT_CPU, reinterpret_cast<uint8_t*>(&value), sizeof(value)) == EBPF_SUCCESS);
+    REQUIRE(completion.value == value);
+    REQUIRE(completion.async_query_result.lost_count == 0);
+
+    // The index of the current CPU is also accepted.
+    REQUIRE(
+        ebpf_perf_event_array_map_output(map.get(), 0, reinterpret_cast<uint8_t*>(&value), sizeof(value)) ==
+        EBPF_SUCCESS);
+
+    // Records that don't fit are counted as lost.
+    std::vector<uint8_t> large_record(64 * 1024);
+    REQUIRE(
+        ebpf_perf_event_array_map_output(map.get(), BPF_F_CURRENT_CPU, large_record.data(), large_record.size()) ==
+        EBPF_OUT_OF_SPACE);
+
+    ebpf_restore_current_thread_affinity(old_thread_affinity);
+
+    // Negative test cases.
+    uint32_t cpu_count = ebpf_get_cpu_count();
+    uint8_t* buffer;
+    size_t consumer_offset;
+    REQUIRE(
+        ebpf_perf_event_array_map_query_buffer(map.get(), cpu_count, &buffer, &consumer_offset) ==
+        EBPF_INVALID_ARGUMENT);
+    REQUIRE(ebpf_perf_event_array_map_return_buffer(map.get(), cpu_count, 0) == EBPF_INVALID_ARGUMENT);
+    REQUIRE(
+        ebpf_perf_event_array_map_output(
+            map.get(), BPF_F_CURRENT_CPU | (1ull << 32), reinterpret_cast<uint8_t*>(&value), sizeof(value)) ==
+        EBPF_INVALID_ARGUMENT);
+    if (cpu_count > 1) {
+        REQUIRE(
+            ebpf_perf_event_array_map_output(
+                map.get(), cpu_count, reinterpret_cast<uint8_t*>(&value), sizeof(value)) == EBPF_INVALID_ARGUMENT);
+    }
+    REQUIRE(ebpf_map_find_entry(map.get(), 0, nullptr, 0, nullptr, 0) == EBPF_OPERATION_NOT_SUPPORTED);
+}
+
 std::vector<GUID> _program_types = {
     EBPF_PROGRAM_TYPE_XDP,
     EBPF_PROGRAM_TYPE_BIND,
@@ -1899,6 +2749,84 @@ TEST_CASE("EBPF_OPERATION_RING_BUFFER_MAP_ASYNC_QUERY", "[execution_context][neg
         invoke_protocol(EBPF_OPERATION_RING_BUFFER_MAP_ASYNC_QUERY, request, reply, &async) == EBPF_INVALID_ARGUMENT);
 }
 
+TEST_CASE("EBPF_OPERATION_PERF_EVENT_ARRAY_MAP_QUERY_BUFFER", "[execution_context][negative]")
+{
+    NEGATIVE_TEST_PROLOG();
+    ebpf_operation_perf_event_array_map_query_buffer_request_t request{};
+    ebpf_operation_perf_event_array_map_query_buffer_reply_t reply;
+
+    request.map_handle = ebpf_handle_invalid - 1;
+    REQUIRE(
+        invoke_protocol(EBPF_OPERATION_PERF_EVENT_ARRAY_MAP_QUERY_BUFFER, request, reply) == EBPF_INVALID_OBJECT);
+
+    request.map_handle = map_handles["BPF_MAP_TYPE_HASH"];
+    REQUIRE(
+        invoke_protocol(EBPF_OPERATION_PERF_EVENT_ARRAY_MAP_QUERY_BUFFER, request, reply) == EBPF_INVALID_ARGUMENT);
+}
+
+TEST_CASE("EBPF_OPERATION_PERF_EVENT_ARRAY_MAP_ASYNC_QUERY", "[execution_context][negative]")
+{
+    NEGATIVE_TEST_PROLOG();
+    ebpf_operation_perf_event_array_map_async_query_request_t request{};
+    ebpf_operation_perf_event_array_map_async_query_reply_t reply;
+    int async = 1;
+
+    request.map_handle = ebpf_handle_invalid - 1;
+    REQUIRE(
+        invoke_protocol(EBPF_OPERATION_PERF_EVENT_ARRAY_MAP_ASYNC_QUERY, request, reply, &async) ==
+        EBPF_INVALID_OBJECT);
+
+    request.map_handle = map_handles["BPF_MAP_TYPE_HASH"];
+    REQUIRE(
+        invoke_protocol(EBPF_OPERATION_PERF_EVENT_ARRAY_MAP_ASYNC_QUERY, request, reply, &async) ==
+        EBPF_INVALID_ARGUMENT);
+}
+
+TEST_CASE("EBPF_OPERATION_MAP_RING_SUBMIT", "[execution_context][negative]")
+{
+    NEGATIVE_TEST_PROLOG();
+    const uint32_t entry_count = 512;
+    const size_t data_length = 64;
+    std::vector<uint8_t> ring(
+        sizeof(ebpf_map_ring_header_t) +
+        entry_count * (sizeof(ebpf_map_ring_submission_t) + sizeof(ebpf_map_ring_completion_t)) + data_length);
+    auto header = reinterpret_cast<ebpf_map_ring_header_t*>(ring.data());
+    auto submissions = reinterpret_cast<ebpf_map_ring_submission_t*>(header + 1);
+    auto completions = reinterpret_cast<ebpf_map_ring_completion_t*>(submissions + entry_count);
+    header->entry_count = entry_count;
+
+    ebpf_operation_map_ring_submit_request_t request{};
+    ebpf_operation_map_ring_submit_reply_t reply{};
+    request.ring.address = reinterpret_cast<uint64_t>(ring.data());
+    request.ring.length = ring.size();
+
+    // Updates of maps that hold object references are rejected by the execution context, even if the caller queues
+    // them directly.
+    submissions[0].map_handle = map_handles["BPF_MAP_TYPE_PROG_ARRAY"];
+    submissions[0].operation = EBPF_MAP_RING_OPERATION_UPDATE;
+    submissions[0].value_offset = sizeof(uint64_t);
+    submissions[0].value_length = _map_definitions["BPF_MAP_TYPE_PROG_ARRAY"].value_size;
+    header->submission_tail = 1;
+    REQUIRE(invoke_protocol(EBPF_OPERATION_MAP_RING_SUBMIT, request, reply) == EBPF_SUCCESS);
+    REQUIRE(reply.count_of_entries_processed == 1);
+    REQUIRE(completions[0].result == EBPF_OPERATION_NOT_SUPPORTED);
+
+    // A single call processes a bounded number of entries and leaves the rest queued.
+    for (uint32_t index = 1; index <= entry_count - 1; index++) {
+        submissions[index].map_handle = map_handles["BPF_MAP_TYPE_HASH"];
+        submissions[index].operation = EBPF_MAP_RING_OPERATION_DELETE;
+        submissions[index].user_data = index;
+    }
+    header->completion_head = 1;
+    header->submission_tail = entry_count;
+    REQUIRE(invoke_protocol(EBPF_OPERATION_MAP_RING_SUBMIT, request, reply) == EBPF_SUCCESS);
+    REQUIRE(reply.count_of_entries_processed < entry_count - 1);
+    REQUIRE(header->submission_head == 1 + reply.count_of_entries_processed);
+    REQUIRE(invoke_protocol(EBPF_OPERATION_MAP_RING_SUBMIT, request, reply) == EBPF_SUCCESS);
+    REQUIRE(header->submission_head == header->submission_tail);
+    REQUIRE(completions[entry_count - 1].user_data == entry_count - 1);
+}
+
 TEST_CASE("EBPF_OPERATION_LOAD_NATIVE_MODULE short header", "[execution_context][negative]")
 {
     _ebpf_core_initializer core;
@@ -12,12 +12,14 @@
  * Each CPU maintains a list of threads that are currently in an epoch. When a thread enters an epoch, it is added to
  * the per-CPU list. When a thread exits an epoch, it is removed from the per-CPU list and the CPU checks if the per-CPU
  * list is empty. If it is empty, then the CPU checks if the timer is armed. If the timer is not armed, then the CPU
- * arms the timer. When the timer expires, the release epoch computation is initiated. The release epoch computation is
- * a three-phase process.
- * 1) Each CPU determines the minimum epoch of all threads on the CPU.
+ * arms the timer. When the timer expires, or when a CPU's free list grows past EBPF_EPOCH_FREE_LIST_PRESSURE_THRESHOLD
+ * entries, CPU 0 initiates the release epoch computation. The release epoch computation is a three-phase process and
+ * each phase runs on all CPUs in parallel.
+ * 1) Each CPU adopts the new current epoch, determines the minimum epoch of all threads on the CPU and folds it into
+ * the proposed release epoch. The last CPU to finish starts the next phase.
  * 2) The minimum epoch is committed as the release epoch and any memory that is older than the release epoch is
- * released.
- * 3) The epoch_computation_in_progress flag is cleared which allows the epoch computation to be initiated  again.
+ * released. The last CPU to finish notifies CPU 0.
+ * 3) The epoch_computation_in_progress flag is cleared which allows the epoch computation to be initiated again.
  */
 
 /**
@@ -30,57 +32,64 @@
  */
 #define EBPF_NANO_SECONDS_PER_FILETIME_TICK 100
 
+/**
+ * @brief Number of entries a CPU adds to its free list before it requests a release epoch computation without waiting
+ * for the timer.
+ */
+#define EBPF_EPOCH_FREE_LIST_PRESSURE_THRESHOLD 1024
+
 #define EBPF_EPOCH_FAIL_FAST(REASON, ASSERTION) \
     if (!(ASSERTION)) {                         \
         ebpf_assert(!#ASSERTION);               \
         __fastfail(REASON);                     \
     }
 
-#pragma warning(disable : 4324) // Structure was padded due to alignment specifier.
 /**
- * @brief Per-CPU state.
- * Each entry is only accessed by the CPU that owns it and only at IRQL >= DISPATCH_LEVEL.
- * This ensures that no locks are required to access the per CPU state.
+ * @brief Size in bytes, including the allocation header, of the smallest slab cache size class.
  */
-typedef __declspec(align(EBPF_CACHE_LINE_SIZE)) struct _ebpf_epoch_cpu_entry
-{
-    LIST_ENTRY epoch_state_list;           ///< Per-CPU list of thread entries.
-    ebpf_list_entry_t free_list;           ///< Per-CPU free list.
-    int64_t current_epoch;                 ///< The current epoch for this CPU.
-    int64_t released_epoch;                ///< The newest epoch that can be released.
-    int timer_armed : 1;                   ///< Set if the flush timer is armed.
-    int rundown_in_progress : 1;           ///< Set if rundown is in progress.
-    int epoch_computation_in_progress : 1; ///< Set if epoch computation is in progress.
-    ebpf_timed_work_queue_t* work_queue;   ///< Work queue used to schedule work items.
-} ebpf_epoch_cpu_entry_t;
+#define EBPF_EPOCH_SLAB_MINIMUM_SIZE 64
 
 /**
- * @brief Table of per-CPU state.
+ * @brief Number of slab cache size classes between two powers of 2. Allocations are rounded up to the next class, so
+ * at most a quarter of each cached block is unused.
  */
-static _Writable_elements_(_ebpf_epoch_cpu_count) ebpf_epoch_cpu_entry_t* _ebpf_epoch_cpu_table = NULL;
+#define EBPF_EPOCH_SLAB_CLASSES_PER_DOUBLING 4
 
 /**
- * @brief Number of CPUs in the system as determined at initialization time.
+ * @brief Number of slab cache size classes, covering 64 to 1024 bytes. Larger allocations always go to the memory
+ * pool.
  */
-static uint32_t _ebpf_epoch_cpu_count = 0;
+#define EBPF_EPOCH_SLAB_CLASS_COUNT (4 * EBPF_EPOCH_SLAB_CLASSES_PER_DOUBLING + 1)
+
+/**
+ * @brief Maximum number of blocks each CPU caches per size class.
+ */
+#define EBPF_EPOCH_SLAB_CACHE_DEPTH 32
+
+/**
+ * @brief Per-CPU magazine of blocks of one size class whose epoch has ended.
+ */
+typedef struct _ebpf_epoch_slab_cache
+{
+    ebpf_list_entry_t free_list; ///< Blocks available for reuse.
+    uint32_t count;              ///< Number of blocks in free_list.
+} ebpf_epoch_slab_cache_t;
 
 /**
  * @brief Enum of messages sent between CPUs.
  */
 typedef enum _ebpf_epoch_cpu_message_type
 {
-    EBPF_EPOCH_CPU_MESSAGE_TYPE_PROPOSE_RELEASE_EPOCH, ///< This message is sent to CPU 0 to propose a new release
-                                                       ///< epoch.
-                                                       ///< CPU 0 declares the new current epoch and proposes it as the
-                                                       ///< release epoch. Each CPU then queries the epoch for each
-                                                       ///< thread linked to this CPU and sets the proposed release
-                                                       ///< epoch in the message to the minimum of the local minima and
-                                                       ///< the minima in the message. The message is then forwarded to
-                                                       ///< the next CPU. The last CPU then sends an epoch commit
-                                                       ///< message to CPU 0 with the final proposed release epoch.
-
-    EBPF_EPOCH_CPU_MESSAGE_TYPE_COMMIT_RELEASE_EPOCH, ///< This message is sent to CPU 0 to commit the proposed release
-                                                      ///< epoch.
+    EBPF_EPOCH_CPU_MESSAGE_TYPE_PROPOSE_RELEASE_EPOCH, ///< This message is sent by CPU 0 to every CPU to propose a new
+                                                       ///< release epoch.
+                                                       ///< Each CPU adopts the new current epoch, queries the epoch for
+                                                       ///< each thread linked to this CPU and folds the minimum into
+                                                       ///< the proposed release epoch. The last CPU to finish then
+                                                       ///< sends an epoch commit message to every CPU with the final
+                                                       ///< proposed release epoch.
+
+    EBPF_EPOCH_CPU_MESSAGE_TYPE_COMMIT_RELEASE_EPOCH, ///< This message is sent to every CPU to commit the proposed
+                                                      ///< release epoch.
                                                       ///< Each CPU then:
                                                       ///< 1. Clears the timer-armed flag.
                                                       ///< 2. Sets the released epoch to the proposed release epoch
@@ -88,9 +97,8 @@ typedef enum _ebpf_epoch_cpu_message_type
                                                       ///< 3. Releases any items in the free list that are eligible for
                                                       ///< reclamation.
                                                       ///< 4. Rearms the timer if need.
-                                                      ///< 5. Forwards the message to the next CPU.
-                                                      ///< The last CPU then sends an epoch computation complete message
-                                                      ///< to CPU 0.
+                                                      ///< The last CPU to finish then sends an epoch computation
+                                                      ///< complete message to CPU 0.
     EBPF_EPOCH_CPU_MESSAGE_TYPE_PROPOSE_EPOCH_COMPLETE, ///< This message is sent only to CPU 0 to signal that epoch
                                                         ///< computation is complete.
     EBPF_EPOCH_CPU_MESSAGE_TYPE_EXIT_EPOCH, ///< This message is used when a thread running with IRQL < DISPATCH calls
@@ -102,6 +110,9 @@ typedef enum _ebpf_epoch_cpu_message_type
                                                      ///< future messages should be ignored.
     EBPF_EPOCH_CPU_MESSAGE_TYPE_IS_FREE_LIST_EMPTY,  ///< This message is sent to each CPU to query if its local free
                                                      ///< list is empty.
+    EBPF_EPOCH_CPU_MESSAGE_TYPE_REQUEST_RELEASE_EPOCH, ///< This message is sent to CPU 0 to start a release epoch
+                                                       ///< computation now. If one is already in progress, another one
+                                                       ///< is started once it completes.
 } ebpf_epoch_cpu_message_type_t;
 
 /**
@@ -114,11 +125,6 @@ typedef struct _ebpf_epoch_cpu_message
     ebpf_work_queue_wakeup_behavior_t wake_behavior;
     union
     {
-        struct
-        {
-            uint64_t current_epoch;          ///< The new current epoch.
-            uint64_t proposed_release_epoch; ///< Minimum epoch of all threads on the CPU.
-        } propose_epoch;
         struct
         {
             uint64_t released_epoch; ///< The newest epoch that can be released.
@@ -135,20 +141,72 @@ typedef struct _ebpf_epoch_cpu_message
         {
             bool is_empty; ///< True if the free list is empty.
         } is_free_list_empty;
+        struct
+        {
+            volatile int32_t in_queue; ///< Set while a free list pressure request is queued, 0 for a synchronous one.
+        } request_release_epoch;
     } message;
     KEVENT completion_event; ///< Event to signal when the operation is complete.
 } ebpf_epoch_cpu_message_t;
 
+#pragma warning(disable : 4324) // Structure was padded due to alignment specifier.
+/**
+ * @brief Per-CPU state.
+ * Each entry is only accessed by the CPU that owns it and only at IRQL >= DISPATCH_LEVEL.
+ * This ensures that no locks are required to access the per CPU state. The exceptions are the messages, which are
+ * queued by other CPUs, and request_message.message.request_release_epoch.in_queue, which is cleared by CPU 0.
+ */
+typedef __declspec(align(EBPF_CACHE_LINE_SIZE)) struct _ebpf_epoch_cpu_entry
+{
+    LIST_ENTRY epoch_state_list;           ///< Per-CPU list of thread entries.
+    ebpf_list_entry_t free_list;           ///< Per-CPU free list.
+    int64_t current_epoch;                 ///< The current epoch for this CPU.
+    int64_t released_epoch;                ///< The newest epoch that can be released.
+    int timer_armed : 1;                   ///< Set if the flush timer is armed.
+    int rundown_in_progress : 1;           ///< Set if rundown is in progress.
+    int epoch_computation_in_progress : 1; ///< Set if epoch computation is in progress.
+    ebpf_timed_work_queue_t* work_queue;   ///< Work queue used to schedule work items.
+    ebpf_epoch_slab_cache_t slab_cache[EBPF_EPOCH_SLAB_CLASS_COUNT]; ///< Recycled blocks by size class.
+    uint64_t slab_cache_hits;                                        ///< Allocations served from slab_cache.
+    uint64_t slab_cache_misses;                                      ///< Allocations that missed slab_cache.
+    size_t free_list_count;                                          ///< Number of entries in free_list.
+    size_t free_list_request_threshold;                              ///< free_list_count that requests a release epoch.
+    ebpf_epoch_cpu_message_t release_epoch_message;                  ///< Runs the release epoch phases on this CPU.
+    ebpf_epoch_cpu_message_t request_message;                        ///< Requests a release epoch from CPU 0.
+} ebpf_epoch_cpu_entry_t;
+
+/**
+ * @brief Table of per-CPU state.
+ */
+static _Writable_elements_(_ebpf_epoch_cpu_count) ebpf_epoch_cpu_entry_t* _ebpf_epoch_cpu_table = NULL;
+
+/**
+ * @brief Number of CPUs in the system as determined at initialization time.
+ */
+static uint32_t _ebpf_epoch_cpu_count = 0;
+
 /**
  * @brief Timer used to schedule epoch computation.
  */
 static KTIMER _ebpf_epoch_compute_release_epoch_timer;
 
 /**
- * @brief Message used to compute the release epoch.
+ * @brief Message used to signal CPU 0 that the release epoch computation is complete.
  */
 static ebpf_epoch_cpu_message_t _ebpf_epoch_compute_release_epoch_message = {0};
 
+/**
+ * @brief State of the release epoch computation that is in progress. Only one computation runs at a time.
+ */
+static struct
+{
+    int64_t current_epoch;                           ///< The current epoch declared by the computation.
+    volatile int64_t proposed_release_epoch;         ///< Minimum epoch of the CPUs that finished.
+    volatile int64_t pending_cpu_count;              ///< CPUs that have not finished the current phase.
+    ebpf_work_queue_wakeup_behavior_t wake_behavior; ///< Wake behavior of the computation's messages.
+    bool rerun_requested;                            ///< Set if a computation was requested during this one.
+} _ebpf_epoch_computation;
+
 /**
  * @brief DPC used to process timer expiration.
  */
@@ -159,12 +217,14 @@ static KDPC _ebpf_epoch_timer_dpc;
  * There are two types of entries in the free list:
  * 1. Memory allocation. This is a block of memory that is returned to the memory pool.
  * 2. Work item. This is a work item that is invoked at the end of the epoch.
+ * 3. Pool block. This is a block of memory that is returned to the ebpf_epoch_pool_t that owns it.
  */
 typedef enum _ebpf_epoch_allocation_type
 {
     EBPF_EPOCH_ALLOCATION_MEMORY,          ///< Memory allocation.
     EBPF_EPOCH_ALLOCATION_WORK_ITEM,       ///< Work item.
     EBPF_EPOCH_ALLOCATION_SYNCHRONIZATION, ///< Synchronization object.
+    EBPF_EPOCH_ALLOCATION_POOL,            ///< Block owned by an epoch pool.
 } ebpf_epoch_allocation_type_t;
 
 /**
@@ -175,8 +235,33 @@ typedef struct _ebpf_epoch_allocation_header
     ebpf_list_entry_t list_entry; ///< List entry used to insert the item into the free list.
     int64_t freed_epoch;          ///< Epoch when the item was freed. Used to determine when the item can be released.
     ebpf_epoch_allocation_type_t entry_type; ///< Type of entry.
+    uint32_t size_class;                     ///< Slab cache size class or EBPF_EPOCH_SLAB_CLASS_COUNT if uncached.
+    ebpf_epoch_pool_t* pool;                 ///< Pool that owns this block or NULL if allocated from the memory pool.
 } ebpf_epoch_allocation_header_t;
 
+/**
+ * @brief Per-CPU free list of an epoch pool.
+ */
+typedef __declspec(align(EBPF_CACHE_LINE_SIZE)) struct _ebpf_epoch_pool_cpu_entry
+{
+    ebpf_lock_t lock;            ///< Lock protecting the free list.
+    ebpf_list_entry_t free_list; ///< Blocks available for allocation.
+} ebpf_epoch_pool_cpu_entry_t;
+
+/**
+ * @brief Pool of fixed size blocks. Each block is preceded by an ebpf_epoch_allocation_header_t so that it can be
+ * passed to ebpf_epoch_free. Blocks that pass their epoch are pushed to the free list of the CPU that releases them.
+ */
+typedef struct _ebpf_epoch_pool
+{
+    volatile int64_t reference_count; ///< One reference for the owner plus one per block waiting for its epoch to end.
+    size_t block_size;                ///< Usable size of each block.
+    uint32_t tag;                     ///< Pool tag used for the pool's storage.
+    uint32_t cpu_count;               ///< Number of entries in cpu_table.
+    _Field_size_(cpu_count) ebpf_epoch_pool_cpu_entry_t* cpu_table; ///< Per-CPU free lists.
+    uint8_t* blocks;                                                 ///< Storage for all blocks.
+} ebpf_epoch_pool_t;
+
 /**
  * @brief This structure is used as a place holder when a custom action needs
  * to be performed on epoch end. Typically this is releasing memory that can't
@@ -221,9 +306,22 @@ _ebpf_epoch_insert_in_free_list(_In_ ebpf_epoch_allocation_header_t* header);
 
 static _IRQL_requires_(DISPATCH_LEVEL) void _ebpf_epoch_arm_timer_if_needed(ebpf_epoch_cpu_entry_t* cpu_entry);
 
+static _IRQL_requires_(DISPATCH_LEVEL) void _ebpf_epoch_start_release_epoch_computation(
+    ebpf_work_queue_wakeup_behavior_t wake_behavior);
+
 static void
 _ebpf_epoch_work_item_callback(_In_ cxplat_preemptible_work_item_t* preemptible_work_item, void* context);
 
+static void
+_ebpf_epoch_pool_return_block(_Inout_ ebpf_epoch_allocation_header_t* header);
+
+static void
+_ebpf_epoch_slab_cache_free(
+    _Inout_ ebpf_epoch_cpu_entry_t* cpu_entry, _Frees_ptr_ ebpf_epoch_allocation_header_t* header);
+
+static void
+_ebpf_epoch_slab_cache_drain(_Inout_ ebpf_epoch_cpu_entry_t* cpu_entry);
+
 /**
  * @brief Raise the CPU's IRQL to DISPATCH_LEVEL if it is below DISPATCH_LEVEL.
  * First check if the IRQL is below DISPATCH_LEVEL to avoid the overhead of
@@ -284,10 +382,17 @@ ebpf_epoch_initiate()
     for (uint32_t cpu_id = 0; cpu_id < _ebpf_epoch_cpu_count; cpu_id++) {
         ebpf_epoch_cpu_entry_t* cpu_entry = &_ebpf_epoch_cpu_table[cpu_id];
         cpu_entry->current_epoch = 1;
+        cpu_entry->free_list_request_threshold = EBPF_EPOCH_FREE_LIST_PRESSURE_THRESHOLD;
         ebpf_list_initialize(&cpu_entry->epoch_state_list);
         ebpf_list_initialize(&cpu_entry->free_list);
+        for (uint32_t size_class = 0; size_class < EBPF_EPOCH_SLAB_CLASS_COUNT; size_class++) {
+            ebpf_list_initialize(&cpu_entry->slab_cache[size_class].free_list);
+        }
     }
 
+    memset(&_ebpf_epoch_computation, 0, sizeof(_ebpf_epoch_computation));
+    _ebpf_epoch_computation.current_epoch = 1;
+
     // Initialize the message queue.
     for (uint32_t cpu_id = 0; cpu_id < _ebpf_epoch_cpu_count; cpu_id++) {
         ebpf_epoch_cpu_entry_t* cpu_entry = &_ebpf_epoch_cpu_table[cpu_id];
@@ -347,6 +452,7 @@ ebpf_epoch_terminate()
         // Release all memory that is still in the free list.
         _ebpf_epoch_release_free_list(cpu_entry, MAXINT64);
         ebpf_assert(ebpf_list_is_empty(&cpu_entry->free_list));
+        _ebpf_epoch_slab_cache_drain(cpu_entry);
         ebpf_timed_work_queue_destroy(cpu_entry->work_queue);
     }
 
@@ -434,15 +540,79 @@ ebpf_epoch_exit(_In_ ebpf_epoch_state_t* epoch_state)
 }
 #pragma warning(pop)
 
+/**
+ * @brief Get the size in bytes, including the allocation header, of a slab cache size class.
+ *
+ * @param[in] size_class Size class.
+ * @return Size of the blocks in the size class.
+ */
+static inline size_t
+_ebpf_epoch_slab_class_size(uint32_t size_class)
+{
+    size_t base_size = (size_t)EBPF_EPOCH_SLAB_MINIMUM_SIZE << (size_class / EBPF_EPOCH_SLAB_CLASSES_PER_DOUBLING);
+    size_t step = base_size / EBPF_EPOCH_SLAB_CLASSES_PER_DOUBLING;
+    return base_size + (size_class % EBPF_EPOCH_SLAB_CLASSES_PER_DOUBLING) * step;
+}
+
+/**
+ * @brief Get the slab cache size class of an allocation.
+ *
+ * @param[in] size Size of the allocation including its header.
+ * @return Size class or EBPF_EPOCH_SLAB_CLASS_COUNT if the allocation is too large to be cached.
+ */
+static inline uint32_t
+_ebpf_epoch_slab_size_class(size_t size)
+{
+    uint32_t size_class = 0;
+    while (size_class < EBPF_EPOCH_SLAB_CLASS_COUNT && _ebpf_epoch_slab_class_size(size_class) < size) {
+        size_class++;
+    }
+    return size_class;
+}
+
 __drv_allocatesMem(Mem) _Must_inspect_result_
     _Ret_writes_maybenull_(size) void* ebpf_epoch_allocate_with_tag(size_t size, uint32_t tag)
 {
     ebpf_assert(size);
-    ebpf_epoch_allocation_header_t* header;
+    ebpf_epoch_allocation_header_t* header = NULL;
 
     size += sizeof(ebpf_epoch_allocation_header_t);
-    header = (ebpf_epoch_allocation_header_t*)ebpf_allocate_with_tag(size, tag);
+
+    // Cached blocks keep the tag they were allocated with, so only allocations with the default tag are cached. While
+    // fault injection is enabled, every allocation goes to the memory pool so that it can be failed.
+    uint32_t size_class = EBPF_EPOCH_SLAB_CLASS_COUNT;
+    if (_ebpf_epoch_cpu_table && tag == EBPF_POOL_TAG_EPOCH && !ebpf_fault_injection_is_enabled()) {
+        size_class = _ebpf_epoch_slab_size_class(size);
+    }
+    if (size_class < EBPF_EPOCH_SLAB_CLASS_COUNT) {
+        // Reuse a block of this size class whose epoch has ended on the current CPU.
+        KIRQL old_irql = _ebpf_epoch_raise_to_dispatch_if_needed();
+        ebpf_epoch_cpu_entry_t* cpu_entry = &_ebpf_epoch_cpu_table[ebpf_get_current_cpu()];
+        ebpf_epoch_slab_cache_t* slab_cache = &cpu_entry->slab_cache[size_class];
+        if (!ebpf_list_is_empty(&slab_cache->free_list)) {
+            header = CONTAINING_RECORD(
+                ebpf_list_remove_head_entry(&slab_cache->free_list), ebpf_epoch_allocation_header_t, list_entry);
+            slab_cache->count--;
+            cpu_entry->slab_cache_hits++;
+        } else {
+            cpu_entry->slab_cache_misses++;
+        }
+        _ebpf_epoch_lower_to_previous_irql(old_irql);
+
+        if (header) {
+            // Cached blocks are handed out zeroed, like blocks from the memory pool.
+            memset(header, 0, size);
+        } else {
+            // Allocate the whole size class so that the block can be reused for any allocation in it.
+            size = _ebpf_epoch_slab_class_size(size_class);
+        }
+    }
+
+    if (!header) {
+        header = (ebpf_epoch_allocation_header_t*)ebpf_allocate_with_tag(size, tag);
+    }
     if (header) {
+        header->size_class = size_class;
         header++;
     }
 
@@ -467,11 +637,246 @@ ebpf_epoch_free(_Frees_ptr_opt_ void* memory)
 
     // Pool corruption or double free.
     EBPF_EPOCH_FAIL_FAST(FAST_FAIL_HEAP_METADATA_CORRUPTION, header->freed_epoch == 0);
-    header->entry_type = EBPF_EPOCH_ALLOCATION_MEMORY;
+    if (header->pool) {
+        // The block holds a reference on its pool until it has been returned.
+        ebpf_interlocked_increment_int64(&header->pool->reference_count);
+        header->entry_type = EBPF_EPOCH_ALLOCATION_POOL;
+    } else {
+        header->entry_type = EBPF_EPOCH_ALLOCATION_MEMORY;
+    }
 
     _ebpf_epoch_insert_in_free_list(header);
 }
 
+/**
+ * @brief Return a memory allocation whose epoch has ended to the slab cache of the current CPU, or to the memory pool
+ * if it can't be cached.
+ *
+ * @param[in, out] cpu_entry CPU entry of the current CPU.
+ * @param[in] header Header of the allocation to free.
+ */
+static void
+_ebpf_epoch_slab_cache_free(
+    _Inout_ ebpf_epoch_cpu_entry_t* cpu_entry, _Frees_ptr_ ebpf_epoch_allocation_header_t* header)
+{
+    if (header->size_class < EBPF_EPOCH_SLAB_CLASS_COUNT && !cpu_entry->rundown_in_progress) {
+        ebpf_epoch_slab_cache_t* slab_cache = &cpu_entry->slab_cache[header->size_class];
+        if (slab_cache->count < EBPF_EPOCH_SLAB_CACHE_DEPTH) {
+            ebpf_list_insert_head(&slab_cache->free_list, &header->list_entry);
+            slab_cache->count++;
+            return;
+        }
+    }
+    ebpf_free(header);
+}
+
+/**
+ * @brief Return all blocks in the slab caches of a CPU to the memory pool.
+ *
+ * @param[in, out] cpu_entry CPU entry to drain.
+ */
+static void
+_ebpf_epoch_slab_cache_drain(_Inout_ ebpf_epoch_cpu_entry_t* cpu_entry)
+{
+    for (uint32_t size_class = 0; size_class < EBPF_EPOCH_SLAB_CLASS_COUNT; size_class++) {
+        ebpf_epoch_slab_cache_t* slab_cache = &cpu_entry->slab_cache[size_class];
+        while (!ebpf_list_is_empty(&slab_cache->free_list)) {
+            ebpf_free(CONTAINING_RECORD(
+                ebpf_list_remove_head_entry(&slab_cache->free_list), ebpf_epoch_allocation_header_t, list_entry));
+        }
+        slab_cache->count = 0;
+    }
+}
+
+void
+ebpf_epoch_get_slab_cache_statistics(_Out_ uint64_t* hits, _Out_ uint64_t* misses)
+{
+    *hits = 0;
+    *misses = 0;
+
+    // The counters are only written by the owning CPU, so the totals are approximate while allocations are running.
+    for (uint32_t cpu_id = 0; cpu_id < _ebpf_epoch_cpu_count; cpu_id++) {
+        *hits += _ebpf_epoch_cpu_table[cpu_id].slab_cache_hits;
+        *misses += _ebpf_epoch_cpu_table[cpu_id].slab_cache_misses;
+    }
+}
+
+/**
+ * @brief Get the distance between consecutive blocks in a pool.
+ *
+ * @param[in] block_size Usable size of each block.
+ * @return Size of a block including its header.
+ */
+static inline size_t
+_ebpf_epoch_pool_block_stride(size_t block_size)
+{
+    return EBPF_PAD_8(sizeof(ebpf_epoch_allocation_header_t) + block_size);
+}
+
+/**
+ * @brief Release the storage backing a pool.
+ *
+ * @param[in] pool Pool to free.
+ */
+static void
+_ebpf_epoch_pool_free(_In_opt_ _Post_ptr_invalid_ ebpf_epoch_pool_t* pool)
+{
+    if (!pool) {
+        return;
+    }
+
+    if (pool->cpu_table) {
+        for (uint32_t cpu_id = 0; cpu_id < pool->cpu_count; cpu_id++) {
+            ebpf_lock_destroy(&pool->cpu_table[cpu_id].lock);
+        }
+        cxplat_free(pool->cpu_table, CXPLAT_POOL_FLAG_NON_PAGED | CXPLAT_POOL_FLAG_CACHE_ALIGNED, pool->tag);
+    }
+    ebpf_free(pool->blocks);
+    ebpf_free(pool);
+}
+
+/**
+ * @brief Drop a reference on a pool and free it if this was the last reference.
+ *
+ * @param[in] pool Pool to release.
+ */
+static void
+_ebpf_epoch_pool_release_reference(_Inout_ ebpf_epoch_pool_t* pool)
+{
+    if (ebpf_interlocked_decrement_int64(&pool->reference_count) == 0) {
+        _ebpf_epoch_pool_free(pool);
+    }
+}
+
+/**
+ * @brief Return a block whose epoch has ended to the free list of the current CPU.
+ *
+ * @param[in, out] header Header of the block to return.
+ */
+static void
+_ebpf_epoch_pool_return_block(_Inout_ ebpf_epoch_allocation_header_t* header)
+{
+    ebpf_epoch_pool_t* pool = header->pool;
+    ebpf_epoch_pool_cpu_entry_t* cpu_entry = &pool->cpu_table[ebpf_get_current_cpu() % pool->cpu_count];
+
+    // Clear the freed epoch so that the block passes the double free check once it is reused.
+    header->freed_epoch = 0;
+
+    ebpf_lock_state_t state = ebpf_lock_lock(&cpu_entry->lock);
+    ebpf_list_insert_tail(&cpu_entry->free_list, &header->list_entry);
+    ebpf_lock_unlock(&cpu_entry->lock, state);
+
+    _ebpf_epoch_pool_release_reference(pool);
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_epoch_pool_create(_Outptr_ ebpf_epoch_pool_t** pool, size_t block_size, size_t block_count, uint32_t tag)
+{
+    ebpf_result_t result;
+    ebpf_epoch_pool_t* local_pool = NULL;
+    size_t block_stride = _ebpf_epoch_pool_block_stride(block_size);
+    size_t storage_size;
+
+    ebpf_assert(block_size);
+
+    result = ebpf_safe_size_t_multiply(block_stride, block_count, &storage_size);
+    if (result != EBPF_SUCCESS) {
+        goto Done;
+    }
+
+    local_pool = ebpf_allocate_with_tag(sizeof(ebpf_epoch_pool_t), tag);
+    if (!local_pool) {
+        result = EBPF_NO_MEMORY;
+        goto Done;
+    }
+
+    local_pool->reference_count = 1;
+    local_pool->block_size = block_size;
+    local_pool->tag = tag;
+    local_pool->cpu_count = ebpf_get_cpu_count();
+
+    local_pool->cpu_table = cxplat_allocate(
+        CXPLAT_POOL_FLAG_NON_PAGED | CXPLAT_POOL_FLAG_CACHE_ALIGNED,
+        sizeof(ebpf_epoch_pool_cpu_entry_t) * local_pool->cpu_count,
+        tag);
+    if (!local_pool->cpu_table) {
+        result = EBPF_NO_MEMORY;
+        goto Done;
+    }
+
+    for (uint32_t cpu_id = 0; cpu_id < local_pool->cpu_count; cpu_id++) {
+        ebpf_lock_create(&local_pool->cpu_table[cpu_id].lock);
+        ebpf_list_initialize(&local_pool->cpu_table[cpu_id].free_list);
+    }
+
+    if (storage_size) {
+        local_pool->blocks = ebpf_allocate_with_tag(storage_size, tag);
+        if (!local_pool->blocks) {
+            result = EBPF_NO_MEMORY;
+            goto Done;
+        }
+    }
+
+    // Spread the blocks evenly across the per-CPU free lists.
+    for (size_t index = 0; index < block_count; index++) {
+        ebpf_epoch_allocation_header_t* header =
+            (ebpf_epoch_allocation_header_t*)(local_pool->blocks + index * block_stride);
+        header->pool = local_pool;
+        ebpf_list_insert_tail(&local_pool->cpu_table[index % local_pool->cpu_count].free_list, &header->list_entry);
+    }
+
+    *pool = local_pool;
+    local_pool = NULL;
+    result = EBPF_SUCCESS;
+
+Done:
+    _ebpf_epoch_pool_free(local_pool);
+    return result;
+}
+
+void
+ebpf_epoch_pool_destroy(_In_opt_ _Post_ptr_invalid_ ebpf_epoch_pool_t* pool)
+{
+    if (!pool) {
+        return;
+    }
+
+    // Blocks still waiting for their epoch to end hold a reference, so the pool outlives them.
+    _ebpf_epoch_pool_release_reference(pool);
+}
+
+_Must_inspect_result_ _Ret_maybenull_ void*
+ebpf_epoch_pool_allocate(_Inout_ ebpf_epoch_pool_t* pool)
+{
+    ebpf_list_entry_t* entry = NULL;
+    uint32_t current_cpu = ebpf_get_current_cpu();
+
+    // Prefer the current CPU's free list, then steal from the other CPUs.
+    for (uint32_t offset = 0; offset < pool->cpu_count; offset++) {
+        ebpf_epoch_pool_cpu_entry_t* cpu_entry = &pool->cpu_table[(current_cpu + offset) % pool->cpu_count];
+        if (ebpf_list_is_empty(&cpu_entry->free_list)) {
+            continue;
+        }
+        ebpf_lock_state_t state = ebpf_lock_lock(&cpu_entry->lock);
+        if (!ebpf_list_is_empty(&cpu_entry->free_list)) {
+            entry = ebpf_list_remove_head_entry(&cpu_entry->free_list);
+        }
+        ebpf_lock_unlock(&cpu_entry->lock, state);
+        if (entry) {
+            break;
+        }
+    }
+
+    if (!entry) {
+        return NULL;
+    }
+
+    ebpf_epoch_allocation_header_t* header = CONTAINING_RECORD(entry, ebpf_epoch_allocation_header_t, list_entry);
+    header++;
+    memset(header, 0, pool->block_size);
+    return header;
+}
+
 ebpf_epoch_work_item_t*
 ebpf_epoch_allocate_work_item(_In_ void* callback_context, _In_ const void (*callback)(_Inout_ void* context))
 {
@@ -538,7 +943,7 @@ _IRQL_requires_max_(PASSIVE_LEVEL) void ebpf_epoch_synchronize()
 
     // Trigger epoch computation.
     ebpf_epoch_cpu_message_t message = {0};
-    message.message_type = EBPF_EPOCH_CPU_MESSAGE_TYPE_PROPOSE_RELEASE_EPOCH;
+    message.message_type = EBPF_EPOCH_CPU_MESSAGE_TYPE_REQUEST_RELEASE_EPOCH;
     message.wake_behavior = EBPF_WORK_QUEUE_WAKEUP_ON_INSERT;
     _ebpf_epoch_send_message_and_wait(&message, 0);
 
@@ -575,9 +980,10 @@ _ebpf_epoch_release_free_list(_Inout_ ebpf_epoch_cpu_entry_t* cpu_entry, int64_t
         header = CONTAINING_RECORD(entry, ebpf_epoch_allocation_header_t, list_entry);
         if (header->freed_epoch <= released_epoch) {
             ebpf_list_remove_entry(entry);
+            cpu_entry->free_list_count--;
             switch (header->entry_type) {
             case EBPF_EPOCH_ALLOCATION_MEMORY:
-                ebpf_free(header);
+                _ebpf_epoch_slab_cache_free(cpu_entry, header);
                 break;
             case EBPF_EPOCH_ALLOCATION_WORK_ITEM: {
                 ebpf_epoch_work_item_t* work_item = CONTAINING_RECORD(header, ebpf_epoch_work_item_t, header);
@@ -590,6 +996,9 @@ _ebpf_epoch_release_free_list(_Inout_ ebpf_epoch_cpu_entry_t* cpu_entry, int64_t
                 KeSetEvent(&synchronization->event, 0, false);
                 break;
             }
+            case EBPF_EPOCH_ALLOCATION_POOL:
+                _ebpf_epoch_pool_return_block(header);
+                break;
             default:
                 // Pool corruption or internal error.
                 EBPF_EPOCH_FAIL_FAST(FAST_FAIL_CORRUPT_LIST_ENTRY, !"Invalid entry type");
@@ -599,6 +1008,9 @@ _ebpf_epoch_release_free_list(_Inout_ ebpf_epoch_cpu_entry_t* cpu_entry, int64_t
         }
     }
 
+    // Entries that are still waiting count towards the next request.
+    cpu_entry->free_list_request_threshold = cpu_entry->free_list_count + EBPF_EPOCH_FREE_LIST_PRESSURE_THRESHOLD;
+
     // Arm the timer if needed.
     _ebpf_epoch_arm_timer_if_needed(cpu_entry);
 }
@@ -666,6 +1078,9 @@ _ebpf_epoch_insert_in_free_list(_In_ ebpf_epoch_allocation_header_t* header)
             KeSetEvent(&synchronization->event, 0, false);
             break;
         }
+        case EBPF_EPOCH_ALLOCATION_POOL:
+            _ebpf_epoch_pool_return_block(header);
+            break;
         default:
             ebpf_assert(!"Invalid entry type");
         }
@@ -675,6 +1090,18 @@ _ebpf_epoch_insert_in_free_list(_In_ ebpf_epoch_allocation_header_t* header)
     header->freed_epoch = cpu_entry->current_epoch;
 
     ebpf_list_insert_tail(&cpu_entry->free_list, &header->list_entry);
+    cpu_entry->free_list_count++;
+
+    if (cpu_entry->free_list_count >= cpu_entry->free_list_request_threshold) {
+        // Reclaim memory now rather than letting the free list grow until the timer fires.
+        cpu_entry->free_list_request_threshold = cpu_entry->free_list_count + EBPF_EPOCH_FREE_LIST_PRESSURE_THRESHOLD;
+        ebpf_epoch_cpu_message_t* message = &cpu_entry->request_message;
+        if (ebpf_interlocked_compare_exchange_int32(&message->message.request_release_epoch.in_queue, 1, 0) == 0) {
+            message->message_type = EBPF_EPOCH_CPU_MESSAGE_TYPE_REQUEST_RELEASE_EPOCH;
+            message->wake_behavior = EBPF_WORK_QUEUE_WAKEUP_ON_INSERT;
+            _ebpf_epoch_send_message_async(message, 0);
+        }
+    }
 
     _ebpf_epoch_arm_timer_if_needed(cpu_entry);
 
@@ -707,13 +1134,8 @@ _Function_class_(KDEFERRED_ROUTINE) _IRQL_requires_(DISPATCH_LEVEL) static void
     }
 
     if (!_ebpf_epoch_cpu_table[0].epoch_computation_in_progress) {
-        _ebpf_epoch_cpu_table[0].epoch_computation_in_progress = true;
         _ebpf_epoch_skipped_timers = 0;
-        memset(&_ebpf_epoch_compute_release_epoch_message, 0, sizeof(_ebpf_epoch_compute_release_epoch_message));
-        _ebpf_epoch_compute_release_epoch_message.message_type = EBPF_EPOCH_CPU_MESSAGE_TYPE_PROPOSE_RELEASE_EPOCH;
-        _ebpf_epoch_compute_release_epoch_message.wake_behavior = EBPF_WORK_QUEUE_WAKEUP_ON_TIMER;
-        KeInitializeEvent(&_ebpf_epoch_compute_release_epoch_message.completion_event, NotificationEvent, false);
-        _ebpf_epoch_send_message_async(&_ebpf_epoch_compute_release_epoch_message, 0);
+        _ebpf_epoch_start_release_epoch_computation(EBPF_WORK_QUEUE_WAKEUP_ON_TIMER);
     } else {
         _ebpf_epoch_skipped_timers++;
         LARGE_INTEGER due_time;
@@ -729,14 +1151,48 @@ typedef void (*ebpf_epoch_messenger_worker_t)(
     _Inout_ ebpf_epoch_cpu_entry_t* cpu_entry, _Inout_ ebpf_epoch_cpu_message_t* message, uint32_t current_cpu);
 
 /**
- * @brief Compute the next proposed release epoch and send it to the next CPU.
- * Message first is sent to CPU 0.
- * CPU == 0 declares the new current epoch and proposes it as the release epoch.
- * CPU != 0 sets current epoch to the new current epoch.
- * Each CPU then queries the epoch for each thread queued on that CPU and sets the proposed release epoch in the message
- * to the minimum of the local minima and the minima in the message. The message is then forwarded to the next CPU. Non
- * last CPU forwards the message to the next CPU. The last CPU then sends an
- * EBPF_EPOCH_CPU_MESSAGE_TYPE_COMMIT_RELEASE_EPOCH message to CPU 0 with the final proposed release epoch.
+ * @brief Start a release epoch computation, or request another one once the computation in progress completes.
+ * Must be called on CPU 0, which owns the computation.
+ * CPU 0 declares the new current epoch and proposes it as the release epoch. It then sends an
+ * EBPF_EPOCH_CPU_MESSAGE_TYPE_PROPOSE_RELEASE_EPOCH message to every CPU, so that the CPUs compute their minima in
+ * parallel rather than one after another.
+ *
+ * @param[in] wake_behavior Wake behavior of the messages sent by the computation.
+ */
+static _IRQL_requires_(DISPATCH_LEVEL) void _ebpf_epoch_start_release_epoch_computation(
+    ebpf_work_queue_wakeup_behavior_t wake_behavior)
+{
+    ebpf_epoch_cpu_entry_t* cpu_entry = &_ebpf_epoch_cpu_table[0];
+
+    if (cpu_entry->rundown_in_progress) {
+        return;
+    }
+
+    if (cpu_entry->epoch_computation_in_progress) {
+        _ebpf_epoch_computation.rerun_requested = true;
+        return;
+    }
+
+    cpu_entry->epoch_computation_in_progress = true;
+    _ebpf_epoch_computation.current_epoch++;
+    _ebpf_epoch_computation.proposed_release_epoch = _ebpf_epoch_computation.current_epoch;
+    _ebpf_epoch_computation.pending_cpu_count = _ebpf_epoch_cpu_count;
+    _ebpf_epoch_computation.wake_behavior = wake_behavior;
+
+    for (uint32_t cpu_id = 0; cpu_id < _ebpf_epoch_cpu_count; cpu_id++) {
+        ebpf_epoch_cpu_message_t* message = &_ebpf_epoch_cpu_table[cpu_id].release_epoch_message;
+        message->message_type = EBPF_EPOCH_CPU_MESSAGE_TYPE_PROPOSE_RELEASE_EPOCH;
+        message->wake_behavior = wake_behavior;
+        _ebpf_epoch_send_message_async(message, cpu_id);
+    }
+}
+
+/**
+ * @brief Compute this CPU's minimum epoch and fold it into the proposed release epoch.
+ * Message is sent to every CPU.
+ * Each CPU sets its current epoch to the new current epoch, then queries the epoch for each thread queued on that CPU
+ * and folds the minimum into the proposed release epoch. The last CPU to finish sends an
+ * EBPF_EPOCH_CPU_MESSAGE_TYPE_COMMIT_RELEASE_EPOCH message to every CPU with the final proposed release epoch.
  *
  * @param[in] cpu_entry CPU entry to compute the epoch for.
  * @param[in] message Message to process.
@@ -746,27 +1202,19 @@ void
 _ebpf_epoch_messenger_propose_release_epoch(
     _Inout_ ebpf_epoch_cpu_entry_t* cpu_entry, _Inout_ ebpf_epoch_cpu_message_t* message, uint32_t current_cpu)
 {
+    UNREFERENCED_PARAMETER(message);
+    UNREFERENCED_PARAMETER(current_cpu);
+
     // Walk over each thread_entry in the epoch_state_list and compute the minimum epoch.
     ebpf_list_entry_t* entry = cpu_entry->epoch_state_list.Flink;
     ebpf_epoch_state_t* epoch_state;
-    uint32_t next_cpu;
 
-    // First CPU updates the current epoch and proposes the release epoch.
-    if (current_cpu == 0) {
-        cpu_entry->current_epoch++;
-        message->message.propose_epoch.current_epoch = cpu_entry->current_epoch;
-        message->message.propose_epoch.proposed_release_epoch = cpu_entry->current_epoch;
-    }
-    // Other CPUs update the current epoch.
-    else {
-        cpu_entry->current_epoch = message->message.propose_epoch.current_epoch;
-    }
+    cpu_entry->current_epoch = _ebpf_epoch_computation.current_epoch;
 
     // Put a memory barrier here to ensure that the write is not re-ordered.
     MemoryBarrier();
 
-    // Previous CPU's minimum epoch.
-    uint64_t minimum_epoch = message->message.propose_epoch.proposed_release_epoch;
+    int64_t minimum_epoch = cpu_entry->current_epoch;
 
     while (entry != &cpu_entry->epoch_state_list) {
         epoch_state = CONTAINING_RECORD(entry, ebpf_epoch_state_t, epoch_list_entry);
@@ -774,33 +1222,42 @@ _ebpf_epoch_messenger_propose_release_epoch(
         entry = entry->Flink;
     }
 
-    // Set the proposed release epoch to the minimum epoch seen so far.
-    message->message.propose_epoch.proposed_release_epoch = minimum_epoch;
+    // Fold the local minimum into the proposed release epoch.
+    int64_t proposed_release_epoch = _ebpf_epoch_computation.proposed_release_epoch;
+    while (minimum_epoch < proposed_release_epoch) {
+        int64_t previous_epoch = ebpf_interlocked_compare_exchange_int64(
+            &_ebpf_epoch_computation.proposed_release_epoch, minimum_epoch, proposed_release_epoch);
+        if (previous_epoch == proposed_release_epoch) {
+            break;
+        }
+        proposed_release_epoch = previous_epoch;
+    }
 
-    // If this is the last CPU, then send a message to the first CPU to commit the release epoch.
-    if (current_cpu == _ebpf_epoch_cpu_count - 1) {
-        message->message.commit_epoch.released_epoch = minimum_epoch;
-        message->message_type = EBPF_EPOCH_CPU_MESSAGE_TYPE_COMMIT_RELEASE_EPOCH;
-        next_cpu = 0;
-    } else {
-        // Send the message to the next CPU.
-        next_cpu = current_cpu + 1;
+    // Other CPUs may still be using their messages, so only the last CPU to finish moves to the next phase.
+    if (ebpf_interlocked_decrement_int64(&_ebpf_epoch_computation.pending_cpu_count) != 0) {
+        return;
     }
 
-    _ebpf_epoch_send_message_async(message, next_cpu);
+    int64_t released_epoch = _ebpf_epoch_computation.proposed_release_epoch;
+    _ebpf_epoch_computation.pending_cpu_count = _ebpf_epoch_cpu_count;
+    for (uint32_t cpu_id = 0; cpu_id < _ebpf_epoch_cpu_count; cpu_id++) {
+        ebpf_epoch_cpu_message_t* commit_message = &_ebpf_epoch_cpu_table[cpu_id].release_epoch_message;
+        commit_message->message_type = EBPF_EPOCH_CPU_MESSAGE_TYPE_COMMIT_RELEASE_EPOCH;
+        commit_message->wake_behavior = _ebpf_epoch_computation.wake_behavior;
+        commit_message->message.commit_epoch.released_epoch = released_epoch;
+        _ebpf_epoch_send_message_async(commit_message, cpu_id);
+    }
 }
 
 /**
- * @brief Commit the release epoch and send it to the next CPU.
- * Message is sent to CPU 0.
- * Each CPU sets its released epoch to the proposed release epoch minus 1.
+ * @brief Commit the release epoch.
+ * Message is sent to every CPU.
  * Each CPU then:
  * 1. Clears the timer-armed flag.
  * 2. Sets the released epoch to the proposed release epoch minus 1.
  * 3. Releases any items in the free list that are eligible for reclamation.
  * 4. Rearms the timer if need.
- * 5. Forwards the message to the next CPU.
- * The last CPU then sends a EBPF_EPOCH_CPU_MESSAGE_TYPE_PROPOSE_EPOCH_COMPLETE message to CPU 0.
+ * The last CPU to finish sends a EBPF_EPOCH_CPU_MESSAGE_TYPE_PROPOSE_EPOCH_COMPLETE message to CPU 0.
  *
  * @param[in] cpu_entry CPU entry to rearm the timer for.
  * @param[in] message Message to process.
@@ -810,23 +1267,19 @@ void
 _ebpf_epoch_messenger_commit_release_epoch(
     _Inout_ ebpf_epoch_cpu_entry_t* cpu_entry, _Inout_ ebpf_epoch_cpu_message_t* message, uint32_t current_cpu)
 {
-    uint32_t next_cpu;
+    UNREFERENCED_PARAMETER(current_cpu);
 
     cpu_entry->timer_armed = false;
     // Set the released_epoch to the value computed by the EBPF_EPOCH_CPU_MESSAGE_TYPE_PROPOSE_RELEASE_EPOCH message.
     cpu_entry->released_epoch = message->message.commit_epoch.released_epoch - 1;
 
-    // If this is the last CPU, send the message to the first CPU to complete the cycle.
-    if (current_cpu != _ebpf_epoch_cpu_count - 1) {
-        // Send the message to the next CPU.
-        next_cpu = current_cpu + 1;
-    } else {
-        message->message_type = EBPF_EPOCH_CPU_MESSAGE_TYPE_PROPOSE_EPOCH_COMPLETE;
-        next_cpu = 0;
+    // The message may be reused by the next computation as soon as the count drops, so it isn't touched after this.
+    if (ebpf_interlocked_decrement_int64(&_ebpf_epoch_computation.pending_cpu_count) == 0) {
+        _ebpf_epoch_compute_release_epoch_message.message_type = EBPF_EPOCH_CPU_MESSAGE_TYPE_PROPOSE_EPOCH_COMPLETE;
+        _ebpf_epoch_compute_release_epoch_message.wake_behavior = _ebpf_epoch_computation.wake_behavior;
+        _ebpf_epoch_send_message_async(&_ebpf_epoch_compute_release_epoch_message, 0);
     }
 
-    _ebpf_epoch_send_message_async(message, next_cpu);
-
     _ebpf_epoch_release_free_list(cpu_entry, cpu_entry->released_epoch);
 }
 
@@ -834,8 +1287,8 @@ _ebpf_epoch_messenger_commit_release_epoch(
  * @brief Complete the release epoch computation and allow the next epoch computation to start.
  * EBPF_EPOCH_CPU_MESSAGE_TYPE_PROPOSE_EPOCH_COMPLETE message:
  * Message is sent only to CPU 0.
- * CPU 0 clears the epoch computation in progress flag and signals the KEVENT associated with the message to signal any
- * waiting threads that the operation is completed.
+ * CPU 0 clears the epoch computation in progress flag and starts the next computation if one was requested while
+ * this one was in progress.
  *
  * @param[in] cpu_entry CPU entry to mark the computation as complete for.
  * @param[in] message Message to process.
@@ -845,13 +1298,13 @@ void
 _ebpf_epoch_messenger_compute_epoch_complete(
     _Inout_ ebpf_epoch_cpu_entry_t* cpu_entry, _Inout_ ebpf_epoch_cpu_message_t* message, uint32_t current_cpu)
 {
+    UNREFERENCED_PARAMETER(message);
     UNREFERENCED_PARAMETER(current_cpu);
-    // If this is the timer's DPC, then mark the computation as complete.
-    if (message == &_ebpf_epoch_compute_release_epoch_message) {
-        cpu_entry->epoch_computation_in_progress = false;
-    } else {
-        // This is an adhoc flush. Signal the caller that the flush is complete.
-        KeSetEvent(&message->completion_event, 0, FALSE);
+
+    cpu_entry->epoch_computation_in_progress = false;
+    if (_ebpf_epoch_computation.rerun_requested) {
+        _ebpf_epoch_computation.rerun_requested = false;
+        _ebpf_epoch_start_release_epoch_computation(EBPF_WORK_QUEUE_WAKEUP_ON_INSERT);
     }
 }
 
@@ -926,6 +1379,33 @@ _ebpf_epoch_messenger_is_free_list_empty(
     KeSetEvent(&message->completion_event, 0, FALSE);
 }
 
+/**
+ * @brief Message to start a release epoch computation.
+ * EBPF_EPOCH_CPU_MESSAGE_TYPE_REQUEST_RELEASE_EPOCH message:
+ * Message is sent to CPU 0 by ebpf_epoch_synchronize or by a CPU whose free list is growing. Synchronous requests are
+ * completed once the computation has been started or requested.
+ *
+ * @param[in] cpu_entry CPU entry of CPU 0.
+ * @param[in] message Message to process.
+ * @param[in] current_cpu Current CPU.
+ */
+void
+_ebpf_epoch_messenger_request_release_epoch(
+    _Inout_ ebpf_epoch_cpu_entry_t* cpu_entry, _Inout_ ebpf_epoch_cpu_message_t* message, uint32_t current_cpu)
+{
+    UNREFERENCED_PARAMETER(cpu_entry);
+    UNREFERENCED_PARAMETER(current_cpu);
+
+    _ebpf_epoch_start_release_epoch_computation(EBPF_WORK_QUEUE_WAKEUP_ON_INSERT);
+
+    if (message->message.request_release_epoch.in_queue) {
+        // Allow the requesting CPU to send the message again.
+        ebpf_interlocked_compare_exchange_int32(&message->message.request_release_epoch.in_queue, 0, 1);
+    } else {
+        KeSetEvent(&message->completion_event, 0, FALSE);
+    }
+}
+
 /**
  * @brief Array of worker functions for the ebpf epoch inter-CPU messaging system.
  */
@@ -935,7 +1415,8 @@ static ebpf_epoch_messenger_worker_t _ebpf_epoch_messenger_workers[] = {
     _ebpf_epoch_messenger_compute_epoch_complete,
     _ebpf_epoch_messenger_exit_epoch,
     _ebpf_epoch_messenger_rundown_in_progress,
-    _ebpf_epoch_messenger_is_free_list_empty};
+    _ebpf_epoch_messenger_is_free_list_empty,
+    _ebpf_epoch_messenger_request_release_epoch};
 
 /**
  * @brief Worker for the ebpf epoch inter-CPU messaging system.
@@ -11,6 +11,7 @@ extern "C"
 #endif
 
     typedef struct _ebpf_epoch_work_item ebpf_epoch_work_item_t;
+    typedef struct _ebpf_epoch_pool ebpf_epoch_pool_t;
     typedef struct _ebpf_epoch_state
     {
         LIST_ENTRY epoch_list_entry; /// List entry for the epoch list.
@@ -67,12 +68,60 @@ extern "C"
         _Ret_writes_maybenull_(size) void* ebpf_epoch_allocate_with_tag(size_t size, uint32_t tag);
 
     /**
-     * @brief Free memory under epoch control.
+     * @brief Free memory under epoch control. Once the epoch ends, small
+     * allocations made with the default tag are kept in a per-CPU slab cache
+     * and reused by later allocations of the same size class on that CPU.
      * @param[in] memory Allocation to be freed once epoch ends.
      */
     void
     ebpf_epoch_free(_Frees_ptr_opt_ void* memory);
 
+    /**
+     * @brief Get the number of epoch allocations that were served from the
+     * per-CPU slab caches and the number that had to go to the memory pool.
+     *
+     * @param[out] hits Number of allocations that reused a cached block.
+     * @param[out] misses Number of cacheable allocations that found no cached block.
+     */
+    void
+    ebpf_epoch_get_slab_cache_statistics(_Out_ uint64_t* hits, _Out_ uint64_t* misses);
+
+    /**
+     * @brief Create a pool of fixed size blocks under epoch control. Blocks are
+     * handed out from per-CPU free lists and are returned to the pool, rather
+     * than to the memory allocator, once the epoch in which they were freed via
+     * ebpf_epoch_free ends.
+     *
+     * @param[out] pool Pointer to memory that will contain the pool on success.
+     * @param[in] block_size Size of each block in bytes.
+     * @param[in] block_count Number of blocks to reserve.
+     * @param[in] tag Pool tag to use.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_NO_MEMORY Unable to allocate resources for this pool.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_epoch_pool_create(_Outptr_ ebpf_epoch_pool_t** pool, size_t block_size, size_t block_count, uint32_t tag);
+
+    /**
+     * @brief Release the caller's reference on a pool. The pool's storage is
+     * released once every block freed to it has passed its epoch. All blocks
+     * allocated from the pool must have been freed prior to this call.
+     *
+     * @param[in] pool Pool to destroy.
+     */
+    void
+    ebpf_epoch_pool_destroy(_In_opt_ _Post_ptr_invalid_ ebpf_epoch_pool_t* pool);
+
+    /**
+     * @brief Allocate a zero-initialized block from a pool. The block must be
+     * freed using ebpf_epoch_free.
+     *
+     * @param[in, out] pool Pool to allocate from.
+     * @returns Pointer to the block, or null if the pool is exhausted.
+     */
+    _Must_inspect_result_ _Ret_maybenull_ void*
+    ebpf_epoch_pool_allocate(_Inout_ ebpf_epoch_pool_t* pool);
+
     /**
      * @brief Wait for the current epoch to end.
      */
@@ -12,6 +12,7 @@ extern "C"
 {
 #endif
     typedef bool (*ebpf_compare_object_t)(_In_ const ebpf_base_object_t* object, _In_opt_ const void* context);
+    typedef void (*ebpf_handle_cleanup_t)(_Inout_ ebpf_base_object_t* object, _In_ const void* instance);
 
     /**
      * @brief Initialize the global handle table.
@@ -51,6 +52,39 @@ extern "C"
     _Must_inspect_result_ ebpf_result_t
     ebpf_handle_close(ebpf_handle_t handle);
 
+    /**
+     * @brief Set the function invoked when the last handle to an instance of
+     *  an object is closed, before the handle's reference on the object is
+     *  released.
+     *
+     * @param[in] cleanup_function Function to invoke or NULL to clear it.
+     */
+    void
+    ebpf_handle_set_cleanup_callback(_In_opt_ ebpf_handle_cleanup_t cleanup_function);
+
+    /**
+     * @brief Invoke the cleanup function for an instance of an object whose
+     *  last handle is being closed.
+     *
+     * @param[in, out] object Object the handle refers to.
+     * @param[in] instance Instance returned by ebpf_handle_get_instance.
+     */
+    void
+    ebpf_handle_cleanup(_Inout_opt_ ebpf_base_object_t* object, _In_ const void* instance);
+
+    /**
+     * @brief Get a value that identifies the instance of the object the handle
+     *  refers to. Duplicates of a handle share the same instance.
+     *
+     * @param[in] handle Handle to query.
+     * @param[out] instance Pointer to memory that contains the instance on
+     *  success.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_INVALID_OBJECT The provided handle is not valid.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_handle_get_instance(ebpf_handle_t handle, _Outptr_ const void** instance);
+
     /**
      * @brief Find the handle in the handle table, acquire a reference to
      *  the object and return it.
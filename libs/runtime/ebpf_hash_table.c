@@ -10,19 +10,30 @@
 // modified.
 
 // Layout is:
-// ebpf_hash_table_t.buckets->ebpf_hash_bucket_header_t.entries->data
+// ebpf_hash_table_t.bucket_array->ebpf_hash_bucket_array_t.buckets->ebpf_hash_bucket_header_t.entries->data
 // Keys are stored contiguously in ebpf_hash_bucket_header_t for fast
 // searching, data is stored separately to prevent read-copy-update semantics
 // from causing loss of updates.
 
+// Resizable tables grow and shrink by a factor of two. A resize allocates a
+// new bucket array and links it from the current one. Writers then move the
+// entries across one group of buckets at a time, publishing the new buckets
+// before replacing the old ones with EBPF_HASH_BUCKET_MIGRATED. Readers and
+// writers that find a migrated bucket follow the link to the new array. The
+// old buckets, and finally the old array, are released via the epoch so
+// lock-free readers never touch freed memory.
+
 /**
- * @brief Each bucket entry contains a pointer to the value, the key, and a pointer to pre-allocated memory that can be
- * used to replace the current bucket with a bucket one entry smaller.
+ * @brief Each bucket entry contains a pointer to the value, the key, a pointer to pre-allocated memory that can be
+ * used to replace the current bucket with a bucket one entry smaller, and the full hash of the key. The hash lets
+ * lookups skip most non-matching entries with a single integer compare and avoids rehashing keys on resize and
+ * iteration.
  */
 typedef struct _ebpf_hash_bucket_entry
 {
     uint8_t* data;
     struct _ebpf_hash_bucket_header* backup_bucket;
+    uint32_t hash;
     uint8_t key[1];
 } ebpf_hash_bucket_entry_t;
 
@@ -46,14 +57,36 @@ typedef struct _ebpf_hash_bucket_header_and_lock
 } ebpf_hash_bucket_header_and_lock_t;
 
 /**
- * @brief The ebpf_hash_table_t structure represents a hash table. It contains an array of pointers to buckets and a
- * a per bucket lock.
+ * @brief Value stored in place of a bucket header once the bucket's entries have been migrated to the next bucket
+ * array.
+ */
+#define EBPF_HASH_BUCKET_MIGRATED ((ebpf_hash_bucket_header_t*)(uintptr_t)1)
+
+/**
+ * @brief An array of pointers to buckets and a per bucket lock. A resizable hash table replaces its bucket array with
+ * one twice or half the size, migrating the buckets incrementally.
+ */
+typedef struct _ebpf_hash_bucket_array
+{
+    size_t bucket_count;                           // Count of buckets.
+    size_t bucket_count_mask;                      // Mask to use to get bucket index from hash.
+    uint32_t bucket_count_bits;                    // Log2 of the count of buckets.
+    struct _ebpf_hash_bucket_array* volatile next; // Bucket array being migrated to or NULL.
+    volatile int64_t migration_cursor;             // Next group of buckets to migrate.
+    volatile int64_t migrated_group_count;         // Count of groups of buckets already migrated.
+    _Field_size_(bucket_count) ebpf_hash_bucket_header_and_lock_t buckets[1]; // Array of buckets.
+} ebpf_hash_bucket_array_t;
+
+/**
+ * @brief The ebpf_hash_table_t structure represents a hash table. It contains a pointer to the current bucket array.
  */
 struct _ebpf_hash_table
 {
-    size_t bucket_count;            // Count of buckets.
-    size_t bucket_count_mask;       // Mask to use to get bucket index from hash.
-    volatile size_t entry_count;    // Count of entries in the hash table.
+    ebpf_hash_bucket_array_t* volatile bucket_array; // Current bucket array.
+    size_t minimum_bucket_count;                     // Smallest bucket count the table shrinks to.
+    size_t maximum_bucket_count; // Largest bucket count the table grows to. Equal to minimum_bucket_count if the table
+                                 // can't be resized.
+    volatile size_t entry_count; // Count of entries in the hash table.
     size_t max_entry_count;         // Maximum number of entries allowed or EBPF_HASH_TABLE_NO_LIMIT if no maximum.
     uint32_t seed;                  // Seed used for hashing.
     size_t key_size;                // Size of key.
@@ -68,9 +101,52 @@ struct _ebpf_hash_table
 
     void* notification_context; //< Context to pass to notification functions.
     ebpf_hash_table_notification_function notification_callback;
-    _Field_size_(bucket_count) ebpf_hash_bucket_header_and_lock_t buckets[1]; // Pointer to array of buckets.
+    ebpf_epoch_pool_t* value_pool;  // Preallocated value storage or NULL.
+    ebpf_epoch_pool_t* bucket_pool; // Preallocated bucket storage or NULL.
 };
 
+/**
+ * @brief The buckets that hold the entries of one bucket of a bucket array. Once a bucket has been migrated its entries
+ * live in the next bucket array: split across two buckets if the table grew, or merged with the entries of another
+ * bucket if the table shrank, in which case only entries whose hash maps to the original bucket belong to the view.
+ */
+typedef struct _ebpf_hash_bucket_view
+{
+    const ebpf_hash_bucket_header_t* headers[2]; // Buckets holding the entries. Entries may be NULL.
+    size_t header_count;                         // Count of buckets in headers.
+    bool filter;                                 // True if the buckets hold entries of other buckets.
+    size_t bucket_count_mask;                    // Mask of the bucket array the view is for.
+    size_t bucket_index;                         // Index of the bucket the view is for.
+    uint64_t start;                              // First position in hash order covered by the bucket.
+    uint64_t end;                                // Position in hash order following the bucket.
+} ebpf_hash_bucket_view_t;
+
+/**
+ * @brief Number of groups of buckets a writer migrates after each successful update while a resize is in progress.
+ */
+#define EBPF_HASH_TABLE_MIGRATION_BATCH_SIZE 4
+
+/**
+ * @brief A resizable table doubles its bucket count once it holds more entries than buckets and halves it once it
+ * holds fewer than one entry per EBPF_HASH_TABLE_SHRINK_RATIO buckets.
+ */
+#define EBPF_HASH_TABLE_SHRINK_RATIO 4
+
+/**
+ * @brief Largest bucket, in entries, that is carved from the preallocated bucket pool. Larger buckets fall back to the
+ * allocator. With at least one bucket per entry, longer chains are rare.
+ */
+#define EBPF_HASH_TABLE_PREALLOCATED_BUCKET_ENTRIES 4
+
+/**
+ * @brief Blocks reserved in each preallocated pool per preallocated entry. Each entry holds one value and, as either
+ * its bucket or the backup bucket of its successor, one bucket. Inserts and deletes build the replacement before the
+ * storage it replaces is freed, and freed storage only returns to the pool once its epoch ends, so the pools also hold
+ * one replacement per entry. Updates of existing keys overwrite the value in place and preallocated tables are never
+ * resized, so neither draws from the pools.
+ */
+#define EBPF_HASH_TABLE_PREALLOCATED_BLOCKS_PER_ENTRY 2
+
 typedef enum _ebpf_hash_bucket_operation
 {
     EBPF_HASH_BUCKET_OPERATION_INSERT_OR_UPDATE, // Insert or update a key-value pair.
@@ -208,16 +284,57 @@ _ebpf_hash_table_compare(_In_ const ebpf_hash_table_t* hash_table, _In_ const ui
     }
 }
 
+/**
+ * @brief Check if two keys are equal. Keys without an extract function and a size of 4, 8, or 16 bytes are compared
+ * as integers.
+ *
+ * @param[in] hash_table Hash table the keys belong to.
+ * @param[in] key_a First key.
+ * @param[in] key_b Second key.
+ * @retval true The keys are equal.
+ * @retval false The keys are not equal.
+ */
+static inline bool
+_ebpf_hash_table_keys_equal(
+    _In_ const ebpf_hash_table_t* hash_table, _In_ const uint8_t* key_a, _In_ const uint8_t* key_b)
+{
+    if (!hash_table->extract) {
+        // Keys in a bucket entry are not aligned, so load them with memcpy, which compiles to plain loads.
+        uint64_t value_a[2];
+        uint64_t value_b[2];
+        switch (hash_table->key_size) {
+        case sizeof(uint32_t): {
+            uint32_t small_a;
+            uint32_t small_b;
+            memcpy(&small_a, key_a, sizeof(small_a));
+            memcpy(&small_b, key_b, sizeof(small_b));
+            return small_a == small_b;
+        }
+        case sizeof(uint64_t):
+            memcpy(value_a, key_a, sizeof(uint64_t));
+            memcpy(value_b, key_b, sizeof(uint64_t));
+            return value_a[0] == value_b[0];
+        case 2 * sizeof(uint64_t):
+            memcpy(value_a, key_a, sizeof(value_a));
+            memcpy(value_b, key_b, sizeof(value_b));
+            return ((value_a[0] ^ value_b[0]) | (value_a[1] ^ value_b[1])) == 0;
+        default:
+            return memcmp(key_a, key_b, hash_table->key_size) == 0;
+        }
+    }
+    return _ebpf_hash_table_compare(hash_table, key_a, key_b) == 0;
+}
+
 /**
  * @brief Given a potentially non-comparable key value, extract the key and
- * compute the hash and convert it to a bucket index.
+ * compute the hash. The low bits of the hash select the bucket.
  *
  * @param[in] hash_table Hash table the keys belong to.
  * @param[in] key Key to hash.
- * @return Bucket index.
+ * @return Hash of the key.
  */
 static uint32_t
-_ebpf_hash_table_compute_bucket_index(_In_ const ebpf_hash_table_t* hash_table, _In_ const uint8_t* key)
+_ebpf_hash_table_compute_hash(_In_ const ebpf_hash_table_t* hash_table, _In_ const uint8_t* key)
 {
     size_t length;
     const uint8_t* data;
@@ -227,8 +344,74 @@ _ebpf_hash_table_compute_bucket_index(_In_ const ebpf_hash_table_t* hash_table,
         length = hash_table->key_size * 8;
         data = key;
     }
-    uint32_t hash_value = _ebpf_murmur3_32(data, length, hash_table->seed);
-    return hash_value & hash_table->bucket_count_mask;
+    return _ebpf_murmur3_32(data, length, hash_table->seed);
+}
+
+/**
+ * @brief Reverse the order of the bits in a value.
+ *
+ * @param[in] value Value to reverse.
+ * @return Value with bit 0 swapped with bit 31, bit 1 with bit 30, and so on.
+ */
+static inline uint32_t
+_ebpf_reverse_bits(uint32_t value)
+{
+    value = ((value >> 1) & 0x55555555) | ((value & 0x55555555) << 1);
+    value = ((value >> 2) & 0x33333333) | ((value & 0x33333333) << 2);
+    value = ((value >> 4) & 0x0F0F0F0F) | ((value & 0x0F0F0F0F) << 4);
+    value = ((value >> 8) & 0x00FF00FF) | ((value & 0x00FF00FF) << 8);
+    return (value >> 16) | (value << 16);
+}
+
+/**
+ * @brief Compare the position of two keys in hash order. Keys are ordered by their bit-reversed hash, then by key.
+ * Since the bucket index is the low bits of the hash, each bucket covers a contiguous range of hash order and splitting
+ * or merging buckets doesn't change the order of the keys.
+ *
+ * @param[in] hash_table Hash table the keys belong to.
+ * @param[in] hash_a Hash of the first key.
+ * @param[in] key_a First key.
+ * @param[in] hash_b Hash of the second key.
+ * @param[in] key_b Second key.
+ * @retval -1 if key_a is before key_b
+ * @retval 0 if key_a == key_b
+ * @retval 1 if key_a is after key_b
+ */
+static int
+_ebpf_hash_table_compare_hash_order(
+    _In_ const ebpf_hash_table_t* hash_table,
+    uint32_t hash_a,
+    _In_ const uint8_t* key_a,
+    uint32_t hash_b,
+    _In_ const uint8_t* key_b)
+{
+    uint32_t order_a = _ebpf_reverse_bits(hash_a);
+    uint32_t order_b = _ebpf_reverse_bits(hash_b);
+    if (order_a != order_b) {
+        return order_a < order_b ? -1 : 1;
+    }
+    return _ebpf_hash_table_compare(hash_table, key_a, key_b);
+}
+
+/**
+ * @brief Check if a bucket entry holds a key. The stored hash is compared first, so the keys are only compared when
+ * the hashes match.
+ *
+ * @param[in] hash_table Hash table the entry belongs to.
+ * @param[in] entry Entry to check.
+ * @param[in] hash Hash of the key.
+ * @param[in] key Key to look for.
+ * @retval true The entry holds the key.
+ * @retval false The entry holds another key.
+ */
+static inline bool
+_ebpf_hash_bucket_entry_matches(
+    _In_ const ebpf_hash_table_t* hash_table,
+    _In_ const ebpf_hash_bucket_entry_t* entry,
+    uint32_t hash,
+    _In_ const uint8_t* key)
+{
+    return entry->hash == hash && _ebpf_hash_table_keys_equal(hash_table, key, entry->key);
 }
 
 /**
@@ -248,6 +431,473 @@ _ebpf_hash_table_bucket_entry(size_t key_size, _In_ const ebpf_hash_bucket_heade
     return (ebpf_hash_bucket_entry_t*)(offset + (size_t)index * entry_size);
 }
 
+/**
+ * @brief Compute the size of a bucket with the given number of entries.
+ *
+ * @param[in] key_size Size of key.
+ * @param[in] count Number of entries in the bucket.
+ * @return Size of the bucket in bytes.
+ */
+static inline size_t
+_ebpf_hash_table_bucket_size(size_t key_size, size_t count)
+{
+    return (EBPF_OFFSET_OF(ebpf_hash_bucket_entry_t, key) + key_size) * count + sizeof(ebpf_hash_bucket_header_t);
+}
+
+/**
+ * @brief Allocate storage for a bucket. Buckets of a preallocated table that fit in a pool block are only taken from
+ * the bucket pool, so an exhausted pool fails the allocation rather than falling back to the allocator.
+ *
+ * @param[in] hash_table Hash table the bucket belongs to.
+ * @param[in] bucket_size Size of the bucket in bytes.
+ * @return Pointer to zero-initialized bucket storage, or NULL on failure.
+ */
+static ebpf_hash_bucket_header_t*
+_ebpf_hash_table_allocate_bucket(_In_ const ebpf_hash_table_t* hash_table, size_t bucket_size)
+{
+    size_t pool_block_size =
+        _ebpf_hash_table_bucket_size(hash_table->key_size, EBPF_HASH_TABLE_PREALLOCATED_BUCKET_ENTRIES);
+    if (hash_table->bucket_pool && bucket_size <= pool_block_size) {
+        return ebpf_epoch_pool_allocate(hash_table->bucket_pool);
+    }
+    return hash_table->allocate(bucket_size);
+}
+
+/**
+ * @brief Allocate storage for a value. Values of a preallocated table are only taken from the value pool.
+ *
+ * @param[in] hash_table Hash table the value belongs to.
+ * @return Pointer to zero-initialized value storage, or NULL on failure.
+ */
+static uint8_t*
+_ebpf_hash_table_allocate_value(_In_ const ebpf_hash_table_t* hash_table)
+{
+    if (hash_table->value_pool) {
+        return ebpf_epoch_pool_allocate(hash_table->value_pool);
+    }
+    return hash_table->allocate(hash_table->value_size + hash_table->supplemental_value_size);
+}
+
+/**
+ * @brief Check if the hash table can be resized.
+ *
+ * @param[in] hash_table Hash table to check.
+ * @retval true The table grows and shrinks with the count of entries.
+ * @retval false The bucket count is fixed.
+ */
+static inline bool
+_ebpf_hash_table_is_resizable(_In_ const ebpf_hash_table_t* hash_table)
+{
+    return hash_table->minimum_bucket_count != hash_table->maximum_bucket_count;
+}
+
+/**
+ * @brief Round a bucket count up to the next power of 2.
+ *
+ * @param[in] bucket_count Bucket count to round.
+ * @return Smallest power of 2 greater than or equal to bucket_count.
+ */
+static size_t
+_ebpf_hash_table_round_up_bucket_count(size_t bucket_count)
+{
+    unsigned long msb_index;
+    _BitScanReverse64(&msb_index, bucket_count);
+
+    if (bucket_count != (1ull << msb_index)) {
+        bucket_count = 1ull << (msb_index + 1ull);
+    }
+    return bucket_count;
+}
+
+/**
+ * @brief Allocate an empty bucket array.
+ *
+ * @param[in] hash_table Hash table the bucket array belongs to.
+ * @param[in] bucket_count Count of buckets, must be a power of 2.
+ * @return Pointer to the bucket array, or NULL on failure.
+ */
+static ebpf_hash_bucket_array_t*
+_ebpf_hash_table_allocate_bucket_array(_In_ const ebpf_hash_table_t* hash_table, size_t bucket_count)
+{
+    size_t bucket_array_size;
+    ebpf_hash_bucket_array_t* bucket_array;
+    unsigned long msb_index;
+
+    if (ebpf_safe_size_t_multiply(sizeof(ebpf_hash_bucket_header_and_lock_t), bucket_count, &bucket_array_size) !=
+        EBPF_SUCCESS) {
+        return NULL;
+    }
+    if (ebpf_safe_size_t_add(
+            bucket_array_size, EBPF_OFFSET_OF(ebpf_hash_bucket_array_t, buckets), &bucket_array_size) != EBPF_SUCCESS) {
+        return NULL;
+    }
+
+    bucket_array = hash_table->allocate(bucket_array_size);
+    if (!bucket_array) {
+        return NULL;
+    }
+
+    _BitScanReverse64(&msb_index, bucket_count);
+    bucket_array->bucket_count = bucket_count;
+    bucket_array->bucket_count_mask = bucket_count - 1;
+    bucket_array->bucket_count_bits = msb_index;
+    bucket_array->next = NULL;
+    bucket_array->migration_cursor = 0;
+    bucket_array->migrated_group_count = 0;
+    return bucket_array;
+}
+
+/**
+ * @brief Free a bucket and the backup buckets of its entries, but not the values they point to.
+ *
+ * @param[in] hash_table Hash table the bucket belongs to.
+ * @param[in] bucket Bucket to free or NULL.
+ */
+static void
+_ebpf_hash_table_free_bucket(_In_ const ebpf_hash_table_t* hash_table, _In_opt_ ebpf_hash_bucket_header_t* bucket)
+{
+    if (!bucket) {
+        return;
+    }
+    for (size_t index = 0; index < bucket->count; index++) {
+        hash_table->free(_ebpf_hash_table_bucket_entry(hash_table->key_size, bucket, index)->backup_bucket);
+    }
+    hash_table->free(bucket);
+}
+
+/**
+ * @brief Get the buckets holding the entries of a bucket, following the bucket to the next bucket array if it has been
+ * migrated.
+ *
+ * @param[in] bucket_array Bucket array the bucket belongs to.
+ * @param[in] bucket_index Index of the bucket.
+ * @param[out] view The buckets holding the entries.
+ * @retval true The view is valid.
+ * @retval false The entries have been migrated again since; the caller must restart from the current bucket array.
+ */
+static bool
+_ebpf_hash_table_get_bucket_view(
+    _In_ const ebpf_hash_bucket_array_t* bucket_array, size_t bucket_index, _Out_ ebpf_hash_bucket_view_t* view)
+{
+    const ebpf_hash_bucket_header_t* header = bucket_array->buckets[bucket_index].header;
+    const ebpf_hash_bucket_array_t* next = bucket_array->next;
+
+    view->bucket_count_mask = bucket_array->bucket_count_mask;
+    view->bucket_index = bucket_index;
+    view->start = _ebpf_reverse_bits((uint32_t)bucket_index);
+    view->end = view->start + (1ull << (32 - bucket_array->bucket_count_bits));
+
+    if (header != EBPF_HASH_BUCKET_MIGRATED) {
+        view->headers[0] = header;
+        view->header_count = 1;
+        view->filter = false;
+        return true;
+    }
+
+    if (next->bucket_count > bucket_array->bucket_count) {
+        // The table grew and the bucket was split in two.
+        view->headers[0] = next->buckets[bucket_index].header;
+        view->headers[1] = next->buckets[bucket_index + bucket_array->bucket_count].header;
+        view->header_count = 2;
+        view->filter = false;
+    } else {
+        // The table shrank and the bucket was merged with another.
+        view->headers[0] = next->buckets[bucket_index & next->bucket_count_mask].header;
+        view->header_count = 1;
+        view->filter = true;
+    }
+
+    for (size_t index = 0; index < view->header_count; index++) {
+        if (view->headers[index] == EBPF_HASH_BUCKET_MIGRATED) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Check if an entry seen through a bucket view belongs to the bucket and is at or after a position in hash
+ * order.
+ *
+ * @param[in] view View the entry was found through.
+ * @param[in] entry Entry to check.
+ * @param[in] position Position in hash order.
+ * @retval true The entry belongs to the bucket and is at or after the position.
+ * @retval false The entry belongs to another bucket or is before the position.
+ */
+static bool
+_ebpf_hash_bucket_view_includes(
+    _In_ const ebpf_hash_bucket_view_t* view, _In_ const ebpf_hash_bucket_entry_t* entry, uint64_t position)
+{
+    if (!view->filter && position <= view->start) {
+        return true;
+    }
+    if (view->filter && (entry->hash & view->bucket_count_mask) != view->bucket_index) {
+        return false;
+    }
+    return _ebpf_reverse_bits(entry->hash) >= position;
+}
+
+/**
+ * @brief Lock the bucket a key maps to. If the bucket has been migrated, lock the bucket the key maps to in the next
+ * bucket array instead.
+ *
+ * @param[in] hash_table Hash table to search.
+ * @param[in] hash Hash of the key.
+ * @param[out] state Lock state to pass to ebpf_lock_unlock.
+ * @return The locked bucket.
+ */
+static ebpf_hash_bucket_header_and_lock_t*
+_ebpf_hash_table_lock_bucket(_In_ const ebpf_hash_table_t* hash_table, uint32_t hash, _Out_ ebpf_lock_state_t* state)
+{
+    ebpf_hash_bucket_array_t* bucket_array = hash_table->bucket_array;
+    for (;;) {
+        ebpf_hash_bucket_header_and_lock_t* bucket = &bucket_array->buckets[hash & bucket_array->bucket_count_mask];
+        *state = ebpf_lock_lock(&bucket->lock);
+        if (bucket->header != EBPF_HASH_BUCKET_MIGRATED) {
+            return bucket;
+        }
+        ebpf_lock_unlock(&bucket->lock, *state);
+        bucket_array = bucket_array->next;
+    }
+}
+
+/**
+ * @brief Build a bucket containing the entries of the old buckets that map to a bucket of the next bucket array,
+ * along with the backup buckets needed to delete entries from it. The values are shared with the old buckets.
+ *
+ * @param[in] hash_table Hash table being resized.
+ * @param[in] old_buckets Buckets to copy entries from. Entries may be NULL.
+ * @param[in] old_bucket_count Count of buckets in old_buckets.
+ * @param[in] bucket_count_mask Mask of the next bucket array.
+ * @param[in] bucket_index Index of the bucket in the next bucket array.
+ * @param[out] new_bucket The new bucket, or NULL if no entries map to it. On success the caller owns this memory.
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_NO_MEMORY Unable to allocate resources for this operation.
+ */
+static ebpf_result_t
+_ebpf_hash_table_build_bucket(
+    _In_ const ebpf_hash_table_t* hash_table,
+    _In_reads_(old_bucket_count) ebpf_hash_bucket_header_t* const* old_buckets,
+    size_t old_bucket_count,
+    size_t bucket_count_mask,
+    size_t bucket_index,
+    _Outptr_result_maybenull_ ebpf_hash_bucket_header_t** new_bucket)
+{
+    ebpf_result_t result = EBPF_SUCCESS;
+    ebpf_hash_bucket_header_t* local_new_bucket = NULL;
+    size_t entry_count = 0;
+
+    *new_bucket = NULL;
+
+    for (size_t bucket = 0; bucket < old_bucket_count; bucket++) {
+        for (size_t index = 0; old_buckets[bucket] && index < old_buckets[bucket]->count; index++) {
+            ebpf_hash_bucket_entry_t* entry =
+                _ebpf_hash_table_bucket_entry(hash_table->key_size, old_buckets[bucket], index);
+            if ((entry->hash & bucket_count_mask) == bucket_index) {
+                entry_count++;
+            }
+        }
+    }
+
+    if (entry_count == 0) {
+        goto Done;
+    }
+
+    local_new_bucket =
+        _ebpf_hash_table_allocate_bucket(hash_table, _ebpf_hash_table_bucket_size(hash_table->key_size, entry_count));
+    if (!local_new_bucket) {
+        result = EBPF_NO_MEMORY;
+        goto Done;
+    }
+    local_new_bucket->count = 0;
+
+    for (size_t bucket = 0; bucket < old_bucket_count; bucket++) {
+        for (size_t index = 0; old_buckets[bucket] && index < old_buckets[bucket]->count; index++) {
+            ebpf_hash_bucket_entry_t* old_entry =
+                _ebpf_hash_table_bucket_entry(hash_table->key_size, old_buckets[bucket], index);
+            if ((old_entry->hash & bucket_count_mask) != bucket_index) {
+                continue;
+            }
+            ebpf_hash_bucket_entry_t* new_entry =
+                _ebpf_hash_table_bucket_entry(hash_table->key_size, local_new_bucket, local_new_bucket->count);
+
+            // Bucket at index N > 0 should have a backup bucket of size N.
+            new_entry->backup_bucket = NULL;
+            if (local_new_bucket->count > 0) {
+                new_entry->backup_bucket = _ebpf_hash_table_allocate_bucket(
+                    hash_table, _ebpf_hash_table_bucket_size(hash_table->key_size, local_new_bucket->count));
+                if (!new_entry->backup_bucket) {
+                    result = EBPF_NO_MEMORY;
+                    goto Done;
+                }
+                new_entry->backup_bucket->count = local_new_bucket->count;
+            }
+            new_entry->data = old_entry->data;
+            new_entry->hash = old_entry->hash;
+            memcpy(new_entry->key, old_entry->key, hash_table->key_size);
+            local_new_bucket->count++;
+        }
+    }
+
+    *new_bucket = local_new_bucket;
+    local_new_bucket = NULL;
+
+Done:
+    _ebpf_hash_table_free_bucket(hash_table, local_new_bucket);
+    return result;
+}
+
+/**
+ * @brief Migrate one group of buckets to the next bucket array. Group N holds the buckets whose index is N modulo the
+ * smaller of the two bucket counts: one bucket that is split in two when the table grows, or two buckets that are
+ * merged into one when it shrinks. The migration that completes the last group makes the next bucket array current.
+ *
+ * @param[in, out] hash_table Hash table being resized.
+ * @param[in, out] bucket_array Bucket array being migrated from.
+ * @param[in] group Group of buckets to migrate.
+ * @retval EBPF_SUCCESS The group has been migrated.
+ * @retval EBPF_NO_MEMORY Unable to allocate the new buckets, the group is left in place.
+ */
+static ebpf_result_t
+_ebpf_hash_table_migrate_group(
+    _Inout_ ebpf_hash_table_t* hash_table, _Inout_ ebpf_hash_bucket_array_t* bucket_array, size_t group)
+{
+    ebpf_result_t result = EBPF_SUCCESS;
+    ebpf_hash_bucket_array_t* next = bucket_array->next;
+    size_t group_count =
+        bucket_array->bucket_count < next->bucket_count ? bucket_array->bucket_count : next->bucket_count;
+    size_t old_bucket_count = bucket_array->bucket_count / group_count;
+    size_t new_bucket_count = next->bucket_count / group_count;
+    ebpf_hash_bucket_header_t* old_buckets[2] = {NULL, NULL};
+    ebpf_hash_bucket_header_t* new_buckets[2] = {NULL, NULL};
+    ebpf_lock_state_t state[2] = {0};
+    bool migrated = false;
+
+    // Lock the old buckets in index order.
+    for (size_t index = 0; index < old_bucket_count; index++) {
+        state[index] = ebpf_lock_lock(&bucket_array->buckets[group + index * group_count].lock);
+    }
+
+    // Another writer may have migrated this group already.
+    if (bucket_array->buckets[group].header == EBPF_HASH_BUCKET_MIGRATED) {
+        goto Unlock;
+    }
+
+    for (size_t index = 0; index < old_bucket_count; index++) {
+        old_buckets[index] = bucket_array->buckets[group + index * group_count].header;
+    }
+
+    for (size_t index = 0; index < new_bucket_count; index++) {
+        result = _ebpf_hash_table_build_bucket(
+            hash_table,
+            old_buckets,
+            old_bucket_count,
+            next->bucket_count_mask,
+            group + index * group_count,
+            &new_buckets[index]);
+        if (result != EBPF_SUCCESS) {
+            goto Unlock;
+        }
+    }
+
+    // Publish the new buckets before marking the old ones as migrated, so that anyone following a migrated bucket
+    // finds its entries.
+    for (size_t index = 0; index < new_bucket_count; index++) {
+        next->buckets[group + index * group_count].header = new_buckets[index];
+        new_buckets[index] = NULL;
+    }
+    for (size_t index = 0; index < old_bucket_count; index++) {
+        bucket_array->buckets[group + index * group_count].header = EBPF_HASH_BUCKET_MIGRATED;
+    }
+    migrated = true;
+
+Unlock:
+    for (size_t index = old_bucket_count; index > 0; index--) {
+        ebpf_lock_unlock(&bucket_array->buckets[group + (index - 1) * group_count].lock, state[index - 1]);
+    }
+
+    // Free the new buckets if the migration failed.
+    for (size_t index = 0; index < new_bucket_count; index++) {
+        _ebpf_hash_table_free_bucket(hash_table, new_buckets[index]);
+    }
+
+    if (migrated) {
+        // The values now belong to the new buckets.
+        for (size_t index = 0; index < old_bucket_count; index++) {
+            _ebpf_hash_table_free_bucket(hash_table, old_buckets[index]);
+        }
+
+        if (ebpf_interlocked_increment_int64(&bucket_array->migrated_group_count) == (int64_t)group_count) {
+            // Every bucket has been migrated. Readers still using the old bucket array are following the migrated
+            // buckets to the next one, so it is freed once the epoch ends.
+            hash_table->bucket_array = next;
+            hash_table->free(bucket_array);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Start resizing the hash table if the count of entries is out of proportion with the count of buckets, and
+ * migrate a batch of buckets if a resize is in progress. Called after each successful update so that the cost of a
+ * resize is spread across writers.
+ *
+ * @param[in, out] hash_table Hash table to resize.
+ */
+static void
+_ebpf_hash_table_resize(_Inout_ ebpf_hash_table_t* hash_table)
+{
+    if (!_ebpf_hash_table_is_resizable(hash_table)) {
+        return;
+    }
+
+    ebpf_hash_bucket_array_t* bucket_array = hash_table->bucket_array;
+    ebpf_hash_bucket_array_t* next = bucket_array->next;
+    if (!next) {
+        size_t entry_count = hash_table->entry_count;
+        size_t bucket_count = bucket_array->bucket_count;
+        size_t new_bucket_count;
+        if (entry_count > bucket_count && bucket_count < hash_table->maximum_bucket_count) {
+            new_bucket_count = bucket_count * 2;
+        } else if (
+            entry_count < bucket_count / EBPF_HASH_TABLE_SHRINK_RATIO &&
+            bucket_count > hash_table->minimum_bucket_count) {
+            new_bucket_count = bucket_count / 2;
+        } else {
+            return;
+        }
+
+        // On failure, the resize is retried on a later update.
+        next = _ebpf_hash_table_allocate_bucket_array(hash_table, new_bucket_count);
+        if (!next) {
+            return;
+        }
+
+        ebpf_hash_bucket_array_t* existing_next =
+            ebpf_interlocked_compare_exchange_pointer((void* volatile*)&bucket_array->next, next, NULL);
+        if (existing_next) {
+            // Another writer started the resize first.
+            hash_table->free(next);
+            next = existing_next;
+        }
+    }
+
+    int64_t group_count =
+        (int64_t)(bucket_array->bucket_count < next->bucket_count ? bucket_array->bucket_count : next->bucket_count);
+    for (size_t batch = 0; batch < EBPF_HASH_TABLE_MIGRATION_BATCH_SIZE; batch++) {
+        int64_t group = bucket_array->migration_cursor;
+        if (group >= group_count) {
+            break;
+        }
+        if (_ebpf_hash_table_migrate_group(hash_table, bucket_array, (size_t)group) != EBPF_SUCCESS) {
+            break;
+        }
+        ebpf_interlocked_compare_exchange_int64(&bucket_array->migration_cursor, group + 1, group);
+    }
+}
+
 /**
  * @brief Build a replacement bucket with the given entry inserted at the end.
  * Caller must free the old bucket.
@@ -255,6 +905,7 @@ _ebpf_hash_table_bucket_entry(size_t key_size, _In_ const ebpf_hash_bucket_heade
  *
  * @param[in] hash_table The hash table.
  * @param[in] old_bucket The immutable bucket to copy.
+ * @param[in] hash Hash of the key to insert.
  * @param[in] key The key to insert.
  * @param[in, out] data The copy of the value to insert. On success the new_bucket owns this memory.
  * @param[out] new_bucket The new bucket with the entry inserted. On success the caller owns this memory.
@@ -265,6 +916,7 @@ static ebpf_result_t
 _ebpf_hash_table_bucket_insert(
     _Inout_ ebpf_hash_table_t* hash_table,
     _In_opt_ const ebpf_hash_bucket_header_t* old_bucket,
+    uint32_t hash,
     _In_ const uint8_t* key,
     _Inout_opt_ uint8_t* data,
     _Outptr_ ebpf_hash_bucket_header_t** new_bucket)
@@ -284,7 +936,7 @@ _ebpf_hash_table_bucket_insert(
     }
 
     // Allocate new bucket.
-    local_new_bucket = hash_table->allocate(new_bucket_size);
+    local_new_bucket = _ebpf_hash_table_allocate_bucket(hash_table, new_bucket_size);
     if (!local_new_bucket) {
         result = EBPF_NO_MEMORY;
         goto Done;
@@ -292,7 +944,7 @@ _ebpf_hash_table_bucket_insert(
 
     // Allocate a new backup bucket.
     if (old_bucket_size) {
-        backup_bucket = hash_table->allocate(old_bucket_size);
+        backup_bucket = _ebpf_hash_table_allocate_bucket(hash_table, old_bucket_size);
         if (!backup_bucket) {
             result = EBPF_NO_MEMORY;
             goto Done;
@@ -310,6 +962,7 @@ _ebpf_hash_table_bucket_insert(
     entry->backup_bucket = backup_bucket;
     backup_bucket = NULL;
     entry->data = data;
+    entry->hash = hash;
     memcpy(entry->key, key, hash_table->key_size);
     local_new_bucket->count++;
 
@@ -373,6 +1026,7 @@ _ebpf_hash_table_bucket_delete(
             _ebpf_hash_table_bucket_entry(hash_table->key_size, backup_bucket, backup_bucket->count);
 
         new_entry->data = old_entry->data;
+        new_entry->hash = old_entry->hash;
         memcpy(new_entry->key, old_entry->key, hash_table->key_size);
         backup_bucket->count++;
     }
@@ -424,7 +1078,7 @@ _ebpf_hash_table_bucket_update(
     ebpf_hash_bucket_header_t* local_new_bucket = NULL;
 
     // Allocate new bucket.
-    local_new_bucket = hash_table->allocate(old_bucket_size);
+    local_new_bucket = _ebpf_hash_table_allocate_bucket(hash_table, old_bucket_size);
     if (!local_new_bucket) {
         result = EBPF_NO_MEMORY;
         goto Done;
@@ -468,20 +1122,19 @@ _ebpf_hash_table_replace_bucket(
 {
     ebpf_result_t result = EBPF_SUCCESS;
     size_t index;
-    uint32_t bucket_index;
     uint8_t* old_data = NULL;
     uint8_t* new_data = NULL;
     ebpf_hash_bucket_header_t* old_bucket = NULL;
     ebpf_hash_bucket_header_t* new_bucket = NULL;
-
-    bucket_index = _ebpf_hash_table_compute_bucket_index(hash_table, key);
+    ebpf_lock_state_t state;
+    uint32_t hash = _ebpf_hash_table_compute_hash(hash_table, key);
 
     // Lock the bucket.
-    ebpf_lock_state_t state = ebpf_lock_lock(&hash_table->buckets[bucket_index].lock);
+    ebpf_hash_bucket_header_and_lock_t* bucket = _ebpf_hash_table_lock_bucket(hash_table, hash, &state);
 
     // Make a copy of the value to insert.
     if (operation != EBPF_HASH_BUCKET_OPERATION_DELETE) {
-        new_data = hash_table->allocate(hash_table->value_size + hash_table->supplemental_value_size);
+        new_data = _ebpf_hash_table_allocate_value(hash_table);
         if (!new_data) {
             result = EBPF_NO_MEMORY;
             goto Done;
@@ -499,13 +1152,13 @@ _ebpf_hash_table_replace_bucket(
     }
 
     // Find the old bucket.
-    old_bucket = hash_table->buckets[bucket_index].header;
+    old_bucket = bucket->header;
     size_t old_bucket_count = old_bucket ? old_bucket->count : 0;
 
     // Find the entry in the bucket, if any.
     for (index = 0; index < old_bucket_count; index++) {
         ebpf_hash_bucket_entry_t* entry = _ebpf_hash_table_bucket_entry(hash_table->key_size, old_bucket, index);
-        if (_ebpf_hash_table_compare(hash_table, key, entry->key) == 0) {
+        if (_ebpf_hash_bucket_entry_matches(hash_table, entry, hash, key)) {
             old_data = entry->data;
             break;
         }
@@ -514,7 +1167,7 @@ _ebpf_hash_table_replace_bucket(
     switch (operation) {
     case EBPF_HASH_BUCKET_OPERATION_INSERT_OR_UPDATE:
         if (index == old_bucket_count) {
-            result = _ebpf_hash_table_bucket_insert(hash_table, old_bucket, key, new_data, &new_bucket);
+            result = _ebpf_hash_table_bucket_insert(hash_table, old_bucket, hash, key, new_data, &new_bucket);
         } else {
             result = _ebpf_hash_table_bucket_update(hash_table, old_bucket, index, new_data, &new_bucket);
         }
@@ -523,7 +1176,7 @@ _ebpf_hash_table_replace_bucket(
         if (index != old_bucket_count) {
             result = EBPF_OBJECT_ALREADY_EXISTS;
         } else {
-            result = _ebpf_hash_table_bucket_insert(hash_table, old_bucket, key, new_data, &new_bucket);
+            result = _ebpf_hash_table_bucket_insert(hash_table, old_bucket, hash, key, new_data, &new_bucket);
         }
         break;
     case EBPF_HASH_BUCKET_OPERATION_UPDATE:
@@ -555,12 +1208,12 @@ _ebpf_hash_table_replace_bucket(
 
     // Update the bucket in the hash table.
     // From this point on the new bucket is immutable.
-    hash_table->buckets[bucket_index].header = new_bucket;
+    bucket->header = new_bucket;
     new_data = NULL;
     new_bucket = NULL;
 
 Done:
-    ebpf_lock_unlock(&hash_table->buckets[bucket_index].lock, state);
+    ebpf_lock_unlock(&bucket->lock, state);
 
     if (hash_table->notification_callback) {
         if (new_data) {
@@ -581,6 +1234,62 @@ Done:
     ebpf_assert(new_bucket == NULL);
     // Free the old bucket if any. This occurs if a insert, delete, or update succeeded.
     hash_table->free(old_bucket);
+
+    if (result == EBPF_SUCCESS) {
+        _ebpf_hash_table_resize(hash_table);
+    }
+    return result;
+}
+
+/**
+ * @brief Overwrite the value of an existing entry without replacing the bucket or the value storage.
+ * Writers are serialized by the bucket lock. Readers that already hold a pointer to the value may observe a partially
+ * written value.
+ *
+ * @param[in] hash_table Hash table to update.
+ * @param[in] key Key to operate on.
+ * @param[in] value Value to copy into the entry or NULL to zero it.
+ * @retval EBPF_SUCCESS The operation succeeded.
+ * @retval EBPF_KEY_NOT_FOUND The specified key is not present in the hash table.
+ */
+static ebpf_result_t
+_ebpf_hash_table_update_in_place(
+    _Inout_ ebpf_hash_table_t* hash_table, _In_ const uint8_t* key, _In_opt_ const uint8_t* value)
+{
+    ebpf_result_t result = EBPF_KEY_NOT_FOUND;
+    uint8_t* data = NULL;
+    ebpf_lock_state_t state;
+    uint32_t hash = _ebpf_hash_table_compute_hash(hash_table, key);
+
+    // Lock the bucket to serialize with other writers.
+    ebpf_hash_bucket_header_and_lock_t* bucket = _ebpf_hash_table_lock_bucket(hash_table, hash, &state);
+
+    ebpf_hash_bucket_header_t* header = bucket->header;
+    size_t bucket_count = header ? header->count : 0;
+    for (size_t index = 0; index < bucket_count; index++) {
+        ebpf_hash_bucket_entry_t* entry = _ebpf_hash_table_bucket_entry(hash_table->key_size, header, index);
+        if (_ebpf_hash_bucket_entry_matches(hash_table, entry, hash, key)) {
+            data = entry->data;
+            break;
+        }
+    }
+
+    if (data) {
+        if (value) {
+            memcpy(data, value, hash_table->value_size);
+        } else {
+            memset(data, 0, hash_table->value_size);
+        }
+        result = EBPF_SUCCESS;
+    }
+
+    ebpf_lock_unlock(&bucket->lock, state);
+
+    if (data && hash_table->notification_callback) {
+        hash_table->notification_callback(
+            hash_table->notification_context, EBPF_HASH_TABLE_NOTIFICATION_TYPE_USE, key, data);
+    }
+
     return result;
 }
 
@@ -589,31 +1298,42 @@ ebpf_hash_table_create(_Out_ ebpf_hash_table_t** hash_table, _In_ const ebpf_has
 {
     ebpf_result_t retval;
     ebpf_hash_table_t* table = NULL;
-    size_t table_size = 0;
     // Select default values for the hash table.
     size_t bucket_count =
         options->minimum_bucket_count ? options->minimum_bucket_count : EBPF_HASH_TABLE_DEFAULT_BUCKET_COUNT;
+    size_t maximum_bucket_count = options->maximum_bucket_count;
     void* (*allocate)(size_t size) = options->allocate ? options->allocate : ebpf_epoch_allocate;
     void (*free)(void* memory) = options->free ? options->free : ebpf_epoch_free;
 
-    // Increase bucket_count to next power of 2.
-    unsigned long msb_index;
-    _BitScanReverse64(&msb_index, bucket_count);
-
-    if (bucket_count != (1ull << msb_index)) {
-        bucket_count = 1ull << (msb_index + 1ull);
+    // Preallocated storage is handed back to its pool by ebpf_epoch_free.
+    if (options->preallocated_entries && (options->allocate || options->free)) {
+        retval = EBPF_INVALID_ARGUMENT;
+        goto Done;
     }
 
-    retval = ebpf_safe_size_t_multiply(sizeof(ebpf_hash_bucket_header_and_lock_t), bucket_count, &table_size);
-    if (retval != EBPF_SUCCESS) {
+    // Buckets replaced by a resize must remain valid until lock-free readers are done with them.
+    if (options->maximum_bucket_count && (options->allocate || options->free)) {
+        retval = EBPF_INVALID_ARGUMENT;
         goto Done;
     }
-    retval = ebpf_safe_size_t_add(table_size, EBPF_OFFSET_OF(ebpf_hash_table_t, buckets), &table_size);
-    if (retval != EBPF_SUCCESS) {
-        goto Done;
+
+    // Increase bucket_count to next power of 2.
+    bucket_count = _ebpf_hash_table_round_up_bucket_count(bucket_count);
+
+    if (maximum_bucket_count > EBPF_HASH_TABLE_MAXIMUM_BUCKET_COUNT) {
+        maximum_bucket_count = EBPF_HASH_TABLE_MAXIMUM_BUCKET_COUNT;
+    }
+    maximum_bucket_count = maximum_bucket_count ? _ebpf_hash_table_round_up_bucket_count(maximum_bucket_count) : 0;
+    if (maximum_bucket_count < bucket_count) {
+        maximum_bucket_count = bucket_count;
     }
 
-    table = allocate(table_size);
+    // A resize builds a replacement for every bucket, more than the preallocated pools hold.
+    if (options->preallocated_entries) {
+        maximum_bucket_count = bucket_count;
+    }
+
+    table = allocate(sizeof(ebpf_hash_table_t));
     if (table == NULL) {
         retval = EBPF_NO_MEMORY;
         goto Done;
@@ -623,8 +1343,8 @@ ebpf_hash_table_create(_Out_ ebpf_hash_table_t** hash_table, _In_ const ebpf_has
     table->value_size = options->value_size;
     table->allocate = allocate;
     table->free = free;
-    table->bucket_count = bucket_count;
-    table->bucket_count_mask = bucket_count - 1;
+    table->minimum_bucket_count = bucket_count;
+    table->maximum_bucket_count = maximum_bucket_count;
     table->entry_count = 0;
     table->seed = ebpf_random_uint32();
     table->extract = options->extract_function;
@@ -633,23 +1353,64 @@ ebpf_hash_table_create(_Out_ ebpf_hash_table_t** hash_table, _In_ const ebpf_has
     table->notification_context = options->notification_context;
     table->notification_callback = options->notification_callback;
 
+    table->bucket_array = _ebpf_hash_table_allocate_bucket_array(table, bucket_count);
+    if (table->bucket_array == NULL) {
+        retval = EBPF_NO_MEMORY;
+        goto Done;
+    }
+
+    if (options->preallocated_entries) {
+        size_t block_count;
+        if (ebpf_safe_size_t_multiply(
+                options->preallocated_entries, EBPF_HASH_TABLE_PREALLOCATED_BLOCKS_PER_ENTRY, &block_count) !=
+            EBPF_SUCCESS) {
+            retval = EBPF_NO_MEMORY;
+            goto Done;
+        }
+
+        retval = ebpf_epoch_pool_create(
+            &table->value_pool, table->value_size + table->supplemental_value_size, block_count, EBPF_POOL_TAG_EPOCH);
+        if (retval != EBPF_SUCCESS) {
+            goto Done;
+        }
+
+        retval = ebpf_epoch_pool_create(
+            &table->bucket_pool,
+            _ebpf_hash_table_bucket_size(table->key_size, EBPF_HASH_TABLE_PREALLOCATED_BUCKET_ENTRIES),
+            block_count,
+            EBPF_POOL_TAG_EPOCH);
+        if (retval != EBPF_SUCCESS) {
+            goto Done;
+        }
+    }
+
     *hash_table = table;
+    table = NULL;
     retval = EBPF_SUCCESS;
 Done:
+    if (table) {
+        ebpf_epoch_pool_destroy(table->value_pool);
+        ebpf_epoch_pool_destroy(table->bucket_pool);
+        free(table->bucket_array);
+        free(table);
+    }
     return retval;
 }
 
-void
-ebpf_hash_table_destroy(_In_opt_ _Post_ptr_invalid_ ebpf_hash_table_t* hash_table)
+/**
+ * @brief Free the entries of a bucket array, skipping migrated buckets, and then the bucket array itself.
+ *
+ * @param[in] hash_table Hash table the bucket array belongs to.
+ * @param[in] bucket_array Bucket array to free.
+ */
+static void
+_ebpf_hash_table_destroy_bucket_array(
+    _In_ const ebpf_hash_table_t* hash_table, _In_ _Post_ptr_invalid_ ebpf_hash_bucket_array_t* bucket_array)
 {
     size_t index;
-    if (!hash_table) {
-        return;
-    }
-
-    for (index = 0; index < hash_table->bucket_count; index++) {
-        ebpf_hash_bucket_header_t* bucket = (ebpf_hash_bucket_header_t*)hash_table->buckets[index].header;
-        if (bucket) {
+    for (index = 0; index < bucket_array->bucket_count; index++) {
+        ebpf_hash_bucket_header_t* bucket = (ebpf_hash_bucket_header_t*)bucket_array->buckets[index].header;
+        if (bucket && bucket != EBPF_HASH_BUCKET_MIGRATED) {
             size_t inner_index;
             for (inner_index = 0; inner_index < bucket->count; inner_index++) {
                 ebpf_hash_bucket_entry_t* entry =
@@ -658,9 +1419,26 @@ ebpf_hash_table_destroy(_In_opt_ _Post_ptr_invalid_ ebpf_hash_table_t* hash_tabl
                 hash_table->free(entry->backup_bucket);
             }
             hash_table->free(bucket);
-            hash_table->buckets[index].header = NULL;
+            bucket_array->buckets[index].header = NULL;
         }
     }
+    hash_table->free(bucket_array);
+}
+
+void
+ebpf_hash_table_destroy(_In_opt_ _Post_ptr_invalid_ ebpf_hash_table_t* hash_table)
+{
+    if (!hash_table) {
+        return;
+    }
+
+    // A resize may be in progress, in which case entries are spread across both bucket arrays.
+    if (hash_table->bucket_array->next) {
+        _ebpf_hash_table_destroy_bucket_array(hash_table, hash_table->bucket_array->next);
+    }
+    _ebpf_hash_table_destroy_bucket_array(hash_table, hash_table->bucket_array);
+    ebpf_epoch_pool_destroy(hash_table->value_pool);
+    ebpf_epoch_pool_destroy(hash_table->bucket_pool);
     hash_table->free(hash_table);
 }
 
@@ -668,9 +1446,10 @@ _Must_inspect_result_ ebpf_result_t
 ebpf_hash_table_find(_In_ const ebpf_hash_table_t* hash_table, _In_ const uint8_t* key, _Outptr_ uint8_t** value)
 {
     ebpf_result_t retval;
-    uint32_t bucket_index;
+    uint32_t hash;
     uint8_t* data = NULL;
     size_t index;
+    const ebpf_hash_bucket_array_t* bucket_array;
     ebpf_hash_bucket_header_t* bucket;
 
     if (!hash_table || !key) {
@@ -678,8 +1457,14 @@ ebpf_hash_table_find(_In_ const ebpf_hash_table_t* hash_table, _In_ const uint8_
         goto Done;
     }
 
-    bucket_index = _ebpf_hash_table_compute_bucket_index(hash_table, key);
-    bucket = hash_table->buckets[bucket_index].header;
+    hash = _ebpf_hash_table_compute_hash(hash_table, key);
+    bucket_array = hash_table->bucket_array;
+    bucket = bucket_array->buckets[hash & bucket_array->bucket_count_mask].header;
+    // If the bucket has been migrated, the key is in the next bucket array.
+    while (bucket == EBPF_HASH_BUCKET_MIGRATED) {
+        bucket_array = bucket_array->next;
+        bucket = bucket_array->buckets[hash & bucket_array->bucket_count_mask].header;
+    }
     if (!bucket) {
         retval = EBPF_KEY_NOT_FOUND;
         goto Done;
@@ -687,7 +1472,7 @@ ebpf_hash_table_find(_In_ const ebpf_hash_table_t* hash_table, _In_ const uint8_
 
     for (index = 0; index < bucket->count; index++) {
         ebpf_hash_bucket_entry_t* entry = _ebpf_hash_table_bucket_entry(hash_table->key_size, bucket, index);
-        if (_ebpf_hash_table_compare(hash_table, key, entry->key) == 0) {
+        if (_ebpf_hash_bucket_entry_matches(hash_table, entry, hash, key)) {
             data = entry->data;
             break;
         }
@@ -723,16 +1508,32 @@ ebpf_hash_table_update(
         goto Done;
     }
 
+    // Preallocated tables overwrite the value of an existing key in place, as Linux reuses preallocated elements.
+    // Replacing it would take a value and a bucket from the pools that only return once their epoch ends, so a burst
+    // of updates would exhaust the pools.
     switch (operation) {
     case EBPF_HASH_TABLE_OPERATION_ANY:
+        if (hash_table->value_pool) {
+            retval = _ebpf_hash_table_update_in_place(hash_table, key, value);
+            if (retval != EBPF_KEY_NOT_FOUND) {
+                goto Done;
+            }
+        }
         bucket_operation = EBPF_HASH_BUCKET_OPERATION_INSERT_OR_UPDATE;
         break;
     case EBPF_HASH_TABLE_OPERATION_INSERT:
         bucket_operation = EBPF_HASH_BUCKET_OPERATION_INSERT;
         break;
     case EBPF_HASH_TABLE_OPERATION_REPLACE:
+        if (hash_table->value_pool) {
+            retval = _ebpf_hash_table_update_in_place(hash_table, key, value);
+            goto Done;
+        }
         bucket_operation = EBPF_HASH_BUCKET_OPERATION_UPDATE;
         break;
+    case EBPF_HASH_TABLE_OPERATION_REPLACE_IN_PLACE:
+        retval = _ebpf_hash_table_update_in_place(hash_table, key, value);
+        goto Done;
     default:
         retval = EBPF_INVALID_ARGUMENT;
         goto Done;
@@ -759,30 +1560,35 @@ Done:
     return retval;
 }
 
-_Must_inspect_result_ ebpf_result_t
-ebpf_hash_table_next_key_pointer_and_value(
+/**
+ * @brief Find the entry that follows a key in bucket order: buckets in index order and the entries of a bucket in the
+ * order they are stored. Only used for tables that can't be resized, whose bucket array never changes.
+ *
+ * @param[in] hash_table Hash table to search.
+ * @param[in] previous_key Previous key or NULL to find the first entry.
+ * @param[out] next_entry The entry that follows previous_key.
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_KEY_NOT_FOUND The previous key is not present in the hash table.
+ * @retval EBPF_NO_MORE_KEYS No more keys exist in the hash table.
+ */
+static ebpf_result_t
+_ebpf_hash_table_next_entry_in_bucket_order(
     _In_ const ebpf_hash_table_t* hash_table,
     _In_opt_ const uint8_t* previous_key,
-    _Outptr_ uint8_t** next_key_pointer,
-    _Outptr_opt_ uint8_t** value)
+    _Outptr_ ebpf_hash_bucket_entry_t** next_entry)
 {
-    ebpf_result_t result = EBPF_SUCCESS;
-    uint32_t starting_bucket_index;
-    ebpf_hash_bucket_entry_t* next_entry = NULL;
+    const ebpf_hash_bucket_array_t* bucket_array = hash_table->bucket_array;
+    ebpf_hash_bucket_entry_t* local_next_entry = NULL;
+    size_t starting_bucket_index;
     size_t bucket_index;
     size_t data_index;
     bool found_entry = false;
+    uint32_t previous_hash = previous_key ? _ebpf_hash_table_compute_hash(hash_table, previous_key) : 0;
 
-    if (!hash_table || !next_key_pointer) {
-        result = EBPF_INVALID_ARGUMENT;
-        goto Done;
-    }
-
-    starting_bucket_index =
-        (previous_key != NULL) ? _ebpf_hash_table_compute_bucket_index(hash_table, previous_key) : 0;
+    starting_bucket_index = (previous_key != NULL) ? previous_hash & bucket_array->bucket_count_mask : 0;
 
-    for (bucket_index = starting_bucket_index; bucket_index < hash_table->bucket_count; bucket_index++) {
-        ebpf_hash_bucket_header_t* bucket = hash_table->buckets[bucket_index].header;
+    for (bucket_index = starting_bucket_index; bucket_index < bucket_array->bucket_count; bucket_index++) {
+        ebpf_hash_bucket_header_t* bucket = bucket_array->buckets[bucket_index].header;
         // Skip empty buckets.
         if (!bucket) {
             continue;
@@ -790,31 +1596,27 @@ ebpf_hash_table_next_key_pointer_and_value(
 
         // Pick first entry if no previous key.
         if (!previous_key) {
-            next_entry = _ebpf_hash_table_bucket_entry(hash_table->key_size, bucket, 0);
+            local_next_entry = _ebpf_hash_table_bucket_entry(hash_table->key_size, bucket, 0);
             break;
         }
 
         for (data_index = 0; data_index < bucket->count; data_index++) {
             ebpf_hash_bucket_entry_t* entry = _ebpf_hash_table_bucket_entry(hash_table->key_size, bucket, data_index);
-            if (!entry) {
-                result = EBPF_INVALID_ARGUMENT;
-                goto Done;
-            }
             // Do we have the previous key?
             if (found_entry) {
                 // Yes, then this is the next key.
-                next_entry = entry;
+                local_next_entry = entry;
                 break;
             }
 
             // Is this the previous key?
-            if (_ebpf_hash_table_compare(hash_table, previous_key, entry->key) == 0) {
+            if (_ebpf_hash_bucket_entry_matches(hash_table, entry, previous_hash, previous_key)) {
                 // Yes, record its location.
                 found_entry = true;
             }
         }
 
-        if (next_entry) {
+        if (local_next_entry) {
             break;
         }
     }
@@ -823,16 +1625,127 @@ ebpf_hash_table_next_key_pointer_and_value(
     // EBPF_KEY_NOT_FOUND, so that the caller can detect that the key is missing, and return the first key (as per
     // 'bpf_map_get_next_key' specs).
     if (!found_entry && previous_key != NULL) {
-        result = EBPF_KEY_NOT_FOUND;
-        goto Done;
+        return EBPF_KEY_NOT_FOUND;
     }
 
-    if (!next_entry) {
+    if (!local_next_entry) {
+        return EBPF_NO_MORE_KEYS;
+    }
+
+    *next_entry = local_next_entry;
+    return EBPF_SUCCESS;
+}
+
+/**
+ * @brief Find the entry that follows a key in hash order. Hash order doesn't depend on the bucket count, so a walk over
+ * a resizable table neither skips nor repeats keys that are present throughout, even if the table is resized mid-walk.
+ *
+ * @param[in] hash_table Hash table to search.
+ * @param[in] previous_key Previous key or NULL to find the first entry.
+ * @param[out] next_entry The entry that follows previous_key.
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_KEY_NOT_FOUND The previous key is not present in the hash table.
+ * @retval EBPF_NO_MORE_KEYS No more keys exist in the hash table.
+ */
+static ebpf_result_t
+_ebpf_hash_table_next_entry_in_hash_order(
+    _In_ const ebpf_hash_table_t* hash_table,
+    _In_opt_ const uint8_t* previous_key,
+    _Outptr_ ebpf_hash_bucket_entry_t** next_entry)
+{
+    ebpf_result_t result;
+    uint32_t previous_hash = previous_key ? _ebpf_hash_table_compute_hash(hash_table, previous_key) : 0;
+    ebpf_hash_bucket_entry_t* local_next_entry;
+    uint32_t next_hash;
+    bool restart;
+
+    do {
+        const ebpf_hash_bucket_array_t* bucket_array = hash_table->bucket_array;
+        uint64_t position = _ebpf_reverse_bits(previous_hash);
+        bool found_entry = (previous_key == NULL);
+        local_next_entry = NULL;
+        next_hash = 0;
+        restart = false;
         result = EBPF_NO_MORE_KEYS;
+
+        // Visit buckets in hash order, starting with the bucket of the previous key.
+        while (position <= UINT32_MAX) {
+            ebpf_hash_bucket_view_t view;
+            size_t bucket_index = _ebpf_reverse_bits((uint32_t)position) & bucket_array->bucket_count_mask;
+            if (!_ebpf_hash_table_get_bucket_view(bucket_array, bucket_index, &view)) {
+                restart = true;
+                break;
+            }
+
+            for (size_t header_index = 0; header_index < view.header_count; header_index++) {
+                const ebpf_hash_bucket_header_t* header = view.headers[header_index];
+                for (size_t index = 0; header && index < header->count; index++) {
+                    ebpf_hash_bucket_entry_t* entry =
+                        _ebpf_hash_table_bucket_entry(hash_table->key_size, header, index);
+                    uint32_t hash = entry->hash;
+                    if (view.filter && (hash & view.bucket_count_mask) != view.bucket_index) {
+                        continue;
+                    }
+                    if (previous_key) {
+                        int order = _ebpf_hash_table_compare_hash_order(
+                            hash_table, hash, entry->key, previous_hash, previous_key);
+                        if (order == 0) {
+                            found_entry = true;
+                        }
+                        if (order <= 0) {
+                            continue;
+                        }
+                    }
+                    if (!local_next_entry || _ebpf_hash_table_compare_hash_order(
+                                                 hash_table, hash, entry->key, next_hash, local_next_entry->key) < 0) {
+                        local_next_entry = entry;
+                        next_hash = hash;
+                    }
+                }
+            }
+
+            // The previous key, if present, is in the first bucket visited.
+            if (!found_entry) {
+                result = EBPF_KEY_NOT_FOUND;
+                break;
+            }
+            if (local_next_entry) {
+                result = EBPF_SUCCESS;
+                break;
+            }
+            position = view.end;
+        }
+    } while (restart);
+
+    if (result == EBPF_SUCCESS) {
+        *next_entry = local_next_entry;
+    }
+    return result;
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_hash_table_next_key_pointer_and_value(
+    _In_ const ebpf_hash_table_t* hash_table,
+    _In_opt_ const uint8_t* previous_key,
+    _Outptr_ uint8_t** next_key_pointer,
+    _Outptr_opt_ uint8_t** value)
+{
+    ebpf_result_t result = EBPF_SUCCESS;
+    ebpf_hash_bucket_entry_t* next_entry = NULL;
+
+    if (!hash_table || !next_key_pointer) {
+        result = EBPF_INVALID_ARGUMENT;
         goto Done;
     }
 
-    result = EBPF_SUCCESS;
+    if (_ebpf_hash_table_is_resizable(hash_table)) {
+        result = _ebpf_hash_table_next_entry_in_hash_order(hash_table, previous_key, &next_entry);
+    } else {
+        result = _ebpf_hash_table_next_entry_in_bucket_order(hash_table, previous_key, &next_entry);
+    }
+    if (result != EBPF_SUCCESS) {
+        goto Done;
+    }
 
     if (value) {
         *value = next_entry->data;
@@ -882,50 +1795,71 @@ ebpf_hash_table_iterate(
     _Out_writes_(*count) const uint8_t** keys,
     _Out_writes_(*count) const uint8_t** values)
 {
-    size_t bucket_index = *bucket;
+    // The cookie is a position in hash order, which remains valid if the table is resized between calls.
+    uint64_t position = *bucket;
     size_t index = 0;
-    size_t remaining_space = *count;
     size_t next_bucket_count = 0;
-    if (bucket_index >= hash_table->bucket_count) {
+    bool restart;
+    if (position > UINT32_MAX) {
         return EBPF_NO_MORE_KEYS;
     }
 
-    while (remaining_space > 0) {
-        if (bucket_index >= hash_table->bucket_count) {
-            break;
-        }
-        ebpf_hash_bucket_header_t* bucket_header = hash_table->buckets[bucket_index].header;
-        // Check if the bucket is empty.
-        if (!bucket_header) {
-            bucket_index++;
-            continue;
-        }
-        // Check if the next bucket will fit in the remaining space.
-        next_bucket_count = bucket_header->count;
-        if (remaining_space < next_bucket_count) {
-            break;
-        }
-        // Copy the keys and values.
-        for (size_t i = 0; i < next_bucket_count; i++) {
-            ebpf_hash_bucket_entry_t* entry = _ebpf_hash_table_bucket_entry(hash_table->key_size, bucket_header, i);
-            if (!entry) {
-                return EBPF_INVALID_ARGUMENT;
+    do {
+        const ebpf_hash_bucket_array_t* bucket_array = hash_table->bucket_array;
+        size_t remaining_space = *count;
+        position = *bucket;
+        index = 0;
+        next_bucket_count = 0;
+        restart = false;
+
+        while (remaining_space > 0 && position <= UINT32_MAX) {
+            ebpf_hash_bucket_view_t view;
+            size_t bucket_index = _ebpf_reverse_bits((uint32_t)position) & bucket_array->bucket_count_mask;
+            if (!_ebpf_hash_table_get_bucket_view(bucket_array, bucket_index, &view)) {
+                restart = true;
+                break;
+            }
+
+            // Check if the next bucket will fit in the remaining space.
+            next_bucket_count = 0;
+            for (size_t header_index = 0; header_index < view.header_count; header_index++) {
+                const ebpf_hash_bucket_header_t* header = view.headers[header_index];
+                for (size_t i = 0; header && i < header->count; i++) {
+                    ebpf_hash_bucket_entry_t* entry = _ebpf_hash_table_bucket_entry(hash_table->key_size, header, i);
+                    if (_ebpf_hash_bucket_view_includes(&view, entry, position)) {
+                        next_bucket_count++;
+                    }
+                }
+            }
+            if (remaining_space < next_bucket_count) {
+                break;
+            }
+
+            // Copy the keys and values.
+            for (size_t header_index = 0; header_index < view.header_count; header_index++) {
+                const ebpf_hash_bucket_header_t* header = view.headers[header_index];
+                for (size_t i = 0; header && i < header->count; i++) {
+                    ebpf_hash_bucket_entry_t* entry = _ebpf_hash_table_bucket_entry(hash_table->key_size, header, i);
+                    if (!_ebpf_hash_bucket_view_includes(&view, entry, position)) {
+                        continue;
+                    }
+                    keys[index] = entry->key;
+                    values[index] = entry->data;
+                    index++;
+                    remaining_space--;
+                }
             }
-            keys[index] = entry->key;
-            values[index] = entry->data;
-            index++;
-            remaining_space--;
+            position = view.end;
         }
-        bucket_index++;
-    }
+    } while (restart);
 
-    // If the bucket_index did not change, then there wasn't enough space to copy the next bucket.
-    if (*bucket == bucket_index) {
+    // If the position did not change, then there wasn't enough space to copy the next bucket.
+    if (*bucket == position) {
         *count = next_bucket_count;
         return EBPF_INSUFFICIENT_BUFFER;
     }
 
-    *bucket = bucket_index;
+    *bucket = (size_t)position;
     *count = index;
     return EBPF_SUCCESS;
 }
@@ -942,26 +1876,38 @@ ebpf_hash_table_next_key_and_value_sorted(
 {
     uint8_t* next_key_pointer = NULL;
     uint8_t* next_value_pointer = NULL;
-    for (size_t bucket_index = 0; bucket_index < hash_table->bucket_count; bucket_index++) {
-        ebpf_hash_bucket_header_t* bucket_header = hash_table->buckets[bucket_index].header;
-        if (!bucket_header) {
-            continue;
-        }
-        for (size_t i = 0; i < bucket_header->count; i++) {
-            ebpf_hash_bucket_entry_t* entry = _ebpf_hash_table_bucket_entry(hash_table->key_size, bucket_header, i);
-            if (!entry) {
-                return EBPF_INVALID_ARGUMENT;
+    bool restart;
+    do {
+        const ebpf_hash_bucket_array_t* bucket_array = hash_table->bucket_array;
+        next_key_pointer = NULL;
+        next_value_pointer = NULL;
+        restart = false;
+        for (size_t bucket_index = 0; bucket_index < bucket_array->bucket_count; bucket_index++) {
+            ebpf_hash_bucket_view_t view;
+            if (!_ebpf_hash_table_get_bucket_view(bucket_array, bucket_index, &view)) {
+                restart = true;
+                break;
             }
-            if (previous_key == NULL || compare(previous_key, entry->key) < 0) {
-                if (next_key_pointer == NULL || compare(next_key_pointer, entry->key) > 0) {
-                    if (filter(filter_context, entry->key, entry->data)) {
-                        next_key_pointer = entry->key;
-                        next_value_pointer = entry->data;
+            for (size_t header_index = 0; header_index < view.header_count; header_index++) {
+                const ebpf_hash_bucket_header_t* bucket_header = view.headers[header_index];
+                for (size_t i = 0; bucket_header && i < bucket_header->count; i++) {
+                    ebpf_hash_bucket_entry_t* entry =
+                        _ebpf_hash_table_bucket_entry(hash_table->key_size, bucket_header, i);
+                    if (!_ebpf_hash_bucket_view_includes(&view, entry, 0)) {
+                        continue;
+                    }
+                    if (previous_key == NULL || compare(previous_key, entry->key) < 0) {
+                        if (next_key_pointer == NULL || compare(next_key_pointer, entry->key) > 0) {
+                            if (filter(filter_context, entry->key, entry->data)) {
+                                next_key_pointer = entry->key;
+                                next_value_pointer = entry->data;
+                            }
+                        }
                     }
                 }
             }
         }
-    }
+    } while (restart);
     if (next_key_pointer == NULL) {
         return EBPF_NO_MORE_KEYS;
     }
@@ -11,12 +11,14 @@ extern "C"
 
 #define EBPF_HASH_TABLE_NO_LIMIT 0
 #define EBPF_HASH_TABLE_DEFAULT_BUCKET_COUNT 64
+#define EBPF_HASH_TABLE_MAXIMUM_BUCKET_COUNT ((size_t)1 << 31)
 
     typedef enum _ebpf_hash_table_operations
     {
         EBPF_HASH_TABLE_OPERATION_ANY = 0,
         EBPF_HASH_TABLE_OPERATION_INSERT = 1,
         EBPF_HASH_TABLE_OPERATION_REPLACE = 2,
+        EBPF_HASH_TABLE_OPERATION_REPLACE_IN_PLACE = 3, //< Overwrite an existing value under the bucket lock.
     } ebpf_hash_table_operations_t;
 
     typedef struct _ebpf_hash_table ebpf_hash_table_t;
@@ -65,6 +67,15 @@ extern "C"
         void* notification_context;     //< Context to pass to notification functions.
         ebpf_hash_table_notification_function
             notification_callback; //< Function to call when value storage is allocated or freed.
+        size_t preallocated_entries; //< Number of entries to reserve value and bucket storage for at creation -
+                                     // defaults to 0. Updates of existing keys overwrite the value in place, and
+                                     // the bucket count is fixed at minimum_bucket_count. Once the reserved storage
+                                     // is in use, inserts fail with EBPF_NO_MEMORY. Requires the default allocate
+                                     // and free functions.
+        size_t maximum_bucket_count; //< Maximum number of buckets the table grows to as entries are added - defaults
+                                     // to 0, which fixes the bucket count at minimum_bucket_count. The table shrinks
+                                     // back towards minimum_bucket_count as entries are removed. Requires the default
+                                     // allocate and free functions.
     } ebpf_hash_table_creation_options_t;
 
     /**
@@ -76,6 +87,8 @@ extern "C"
      * @retval EBPF_SUCCESS The operation was successful.
      * @retval EBPF_NO_MEMORY Unable to allocate resources for this
      *  hash table.
+     * @retval EBPF_INVALID_ARGUMENT Preallocation or resizing was requested
+     *  with a custom allocator.
      */
     _Must_inspect_result_ ebpf_result_t
     ebpf_hash_table_create(
@@ -112,6 +125,7 @@ extern "C"
      * @retval EBPF_NO_MEMORY Unable to allocate memory for this
      *  entry in the hash table.
      * @retval EBPF_OUT_OF_SPACE Unable to insert this entry in the hash table.
+     * @retval EBPF_KEY_NOT_FOUND The operation requires an existing entry and the key was not found.
      */
     _Must_inspect_result_ ebpf_result_t
     ebpf_hash_table_update(
@@ -134,7 +148,8 @@ extern "C"
     /**
      * @brief Fetch pointers to keys and values from one or more buckets in the hash table. Whole buckets worth of keys
      * and values are returned at a time, with *count being the number of keys and values returned. If *count is too
-     * small to hold all the keys and values in the next bucket, EBPF_INSUFFICIENT_BUFFER is returned.
+     * small to hold all the keys and values in the next bucket, EBPF_INSUFFICIENT_BUFFER is returned. The cookie
+     * remains valid if the table is resized between calls.
      *
      * @param[in] hash_table Hash-table to iterate.
      * @param[in,out] cookie Cookie to pass to the iterator or NULL to restart. Updated on return.
@@ -0,0 +1,464 @@
+// Copyright (c) eBPF for Windows contributors
+// SPDX-License-Identifier: MIT
+
+#include "ebpf_epoch.h"
+#include "ebpf_lpm_trie.h"
+
+// The trie is a path-compressed binary trie. Each node holds a prefix and the
+// node's children hold longer prefixes that start with it, selected by the
+// first bit that follows the node's prefix. Chains of single-child branch
+// points are never stored, so a lookup visits at most one node per distinct
+// prefix on the path to the longest match rather than one node per key bit.
+//
+// Nodes are immutable once published except for their child pointers and the
+// intermediate flag. Writers serialize on the trie lock, build any new nodes
+// off to the side and then publish them with a single pointer store. Readers
+// take no locks and rely on the epoch to keep nodes they are visiting alive.
+//
+// Intermediate nodes are branch points that do not hold an entry. They are
+// created when two prefixes diverge and always have two children.
+
+#define EBPF_LPM_TRIE_NODE_FLAG_INTERMEDIATE 0x1
+
+typedef struct _ebpf_lpm_trie_node
+{
+    struct _ebpf_lpm_trie_node* volatile children[2]; // Longer prefixes, indexed by the bit following this prefix.
+    uint32_t prefix_length;                           // Length of the prefix in bits.
+    volatile uint32_t flags;                          // EBPF_LPM_TRIE_NODE_FLAG_* values.
+    uint8_t data[1];                                  // Prefix data followed by the value.
+} ebpf_lpm_trie_node_t;
+
+struct _ebpf_lpm_trie
+{
+    ebpf_lpm_trie_node_t* volatile root; // Root of the trie or NULL if empty.
+    ebpf_lock_t lock;                    // Lock held by writers.
+    size_t data_size;                    // Size of the prefix data in bytes.
+    size_t value_size;                   // Size of the value in bytes.
+    size_t value_offset;                 // Offset of the value from the start of a node.
+    uint32_t max_prefix_length;          // Maximum prefix length in bits.
+};
+
+static inline uint32_t
+_ebpf_lpm_trie_extract_bit(_In_ const uint8_t* data, uint32_t index)
+{
+    return (data[index / 8] >> (7 - (index % 8))) & 1;
+}
+
+static inline uint8_t*
+_ebpf_lpm_trie_node_value(_In_ const ebpf_lpm_trie_t* trie, _In_ const ebpf_lpm_trie_node_t* node)
+{
+    return (uint8_t*)node + trie->value_offset;
+}
+
+/**
+ * @brief Count the leading bits two prefixes have in common.
+ *
+ * @param[in] left First prefix.
+ * @param[in] right Second prefix.
+ * @param[in] start Count of leading bits already known to match.
+ * @param[in] limit Maximum number of bits to compare.
+ * @return Number of leading bits in common, at most limit.
+ */
+static uint32_t
+_ebpf_lpm_trie_match_length(_In_ const uint8_t* left, _In_ const uint8_t* right, uint32_t start, uint32_t limit)
+{
+    size_t index = start / 8;
+    uint32_t length = (uint32_t)index * 8;
+
+    // Skip over whole words that match before looking for the first differing bit.
+    while (length + 64 <= limit) {
+        uint64_t left_word;
+        uint64_t right_word;
+        memcpy(&left_word, left + index, sizeof(left_word));
+        memcpy(&right_word, right + index, sizeof(right_word));
+        if (left_word != right_word) {
+            break;
+        }
+        index += sizeof(uint64_t);
+        length += 64;
+    }
+
+    while (length < limit) {
+        uint8_t difference = left[index] ^ right[index];
+        if (difference != 0) {
+            while (!(difference & 0x80)) {
+                difference <<= 1;
+                length++;
+            }
+            break;
+        }
+        index++;
+        length += 8;
+    }
+
+    return length < limit ? length : limit;
+}
+
+static _Must_inspect_result_ _Ret_maybenull_ ebpf_lpm_trie_node_t*
+_ebpf_lpm_trie_allocate_node(
+    _In_ const ebpf_lpm_trie_t* trie, uint32_t prefix_length, _In_ const uint8_t* data, uint32_t flags)
+{
+    // Intermediate nodes never expose a value, so they don't reserve space for one.
+    size_t node_size = trie->value_offset;
+    if (!(flags & EBPF_LPM_TRIE_NODE_FLAG_INTERMEDIATE)) {
+        node_size += trie->value_size;
+    }
+
+    ebpf_lpm_trie_node_t* node = (ebpf_lpm_trie_node_t*)ebpf_epoch_allocate(node_size);
+    if (node == NULL) {
+        return NULL;
+    }
+
+    node->prefix_length = prefix_length;
+    node->flags = flags;
+    memcpy(node->data, data, trie->data_size);
+
+    // Clear the bits past the prefix, so keys that only differ there are stored and returned identically.
+    size_t prefix_bytes = prefix_length / 8;
+    if (prefix_length % 8) {
+        node->data[prefix_bytes] &= (uint8_t)(0xFF << (8 - (prefix_length % 8)));
+        prefix_bytes++;
+    }
+    memset(node->data + prefix_bytes, 0, trie->data_size - prefix_bytes);
+    return node;
+}
+
+/**
+ * @brief Find the first entry in a subtree.
+ *
+ * @param[in] node Root of the subtree.
+ * @return The first entry or NULL if the subtree is empty.
+ */
+static _Ret_maybenull_ const ebpf_lpm_trie_node_t*
+_ebpf_lpm_trie_first_entry(_In_opt_ const ebpf_lpm_trie_node_t* node)
+{
+    while (node && (node->flags & EBPF_LPM_TRIE_NODE_FLAG_INTERMEDIATE)) {
+        const ebpf_lpm_trie_node_t* left = node->children[0];
+        node = left ? left : node->children[1];
+    }
+    return node;
+}
+
+/**
+ * @brief Find the subtree whose first entry follows a prefix. The prefix
+ * doesn't need to be present in the trie.
+ *
+ * @param[in] trie Trie to search.
+ * @param[in] prefix_length Length of the prefix in bits.
+ * @param[in] data Prefix data.
+ * @return Root of the subtree or NULL if no entries follow the prefix.
+ */
+static _Ret_maybenull_ const ebpf_lpm_trie_node_t*
+_ebpf_lpm_trie_find_successor(_In_ const ebpf_lpm_trie_t* trie, uint32_t prefix_length, _In_ const uint8_t* data)
+{
+    // Closest subtree seen so far that sorts after the prefix.
+    const ebpf_lpm_trie_node_t* candidate = NULL;
+    const ebpf_lpm_trie_node_t* node = trie->root;
+
+    while (node) {
+        const ebpf_lpm_trie_node_t* left = node->children[0];
+        const ebpf_lpm_trie_node_t* right = node->children[1];
+        uint32_t limit = node->prefix_length < prefix_length ? node->prefix_length : prefix_length;
+        uint32_t match_length = _ebpf_lpm_trie_match_length(node->data, data, 0, limit);
+
+        if (match_length < limit) {
+            // The prefix sorts before this subtree if it diverges with a 0 bit and after it otherwise.
+            return _ebpf_lpm_trie_extract_bit(data, match_length) ? candidate : node;
+        }
+        if (node->prefix_length > prefix_length) {
+            // The prefix covers this node, so it sorts before the whole subtree.
+            return node;
+        }
+        if (node->prefix_length == prefix_length) {
+            return left ? left : (right ? right : candidate);
+        }
+        if (_ebpf_lpm_trie_extract_bit(data, node->prefix_length)) {
+            node = right;
+        } else {
+            if (right) {
+                candidate = right;
+            }
+            node = left;
+        }
+    }
+    return candidate;
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_lpm_trie_create(_Outptr_ ebpf_lpm_trie_t** trie, size_t key_size, size_t value_size)
+{
+    ebpf_result_t result;
+    ebpf_lpm_trie_t* local_trie = NULL;
+
+    if (key_size <= sizeof(uint32_t) || (key_size - sizeof(uint32_t)) > (UINT32_MAX / 8)) {
+        result = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
+    local_trie = (ebpf_lpm_trie_t*)ebpf_epoch_allocate(sizeof(ebpf_lpm_trie_t));
+    if (local_trie == NULL) {
+        result = EBPF_NO_MEMORY;
+        goto Done;
+    }
+
+    local_trie->data_size = key_size - sizeof(uint32_t);
+    local_trie->value_size = value_size;
+    local_trie->value_offset = EBPF_PAD_8(EBPF_OFFSET_OF(ebpf_lpm_trie_node_t, data) + local_trie->data_size);
+    local_trie->max_prefix_length = (uint32_t)(local_trie->data_size * 8);
+    ebpf_lock_create(&local_trie->lock);
+
+    *trie = local_trie;
+    result = EBPF_SUCCESS;
+
+Done:
+    return result;
+}
+
+void
+ebpf_lpm_trie_destroy(_In_opt_ _Post_ptr_invalid_ ebpf_lpm_trie_t* trie)
+{
+    if (!trie) {
+        return;
+    }
+
+    // Free the nodes without recursing by rotating left children up until the node being visited has none.
+    ebpf_lpm_trie_node_t* node = trie->root;
+    while (node) {
+        ebpf_lpm_trie_node_t* left = node->children[0];
+        if (left) {
+            node->children[0] = left->children[1];
+            left->children[1] = node;
+            node = left;
+        } else {
+            ebpf_lpm_trie_node_t* right = node->children[1];
+            ebpf_epoch_free(node);
+            node = right;
+        }
+    }
+
+    ebpf_lock_destroy(&trie->lock);
+    ebpf_epoch_free(trie);
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_lpm_trie_find(_In_ const ebpf_lpm_trie_t* trie, _In_ const uint8_t* key, _Outptr_ uint8_t** value)
+{
+    const uint8_t* data = key + sizeof(uint32_t);
+    const ebpf_lpm_trie_node_t* match = NULL;
+    const ebpf_lpm_trie_node_t* node = trie->root;
+    uint32_t match_length = 0;
+
+    // Every node below a node starts with that node's prefix, so only the bits past it need to be compared.
+    while (node) {
+        uint32_t prefix_length = node->prefix_length;
+        match_length = _ebpf_lpm_trie_match_length(node->data, data, match_length, prefix_length);
+        if (match_length < prefix_length) {
+            break;
+        }
+        if (!(node->flags & EBPF_LPM_TRIE_NODE_FLAG_INTERMEDIATE)) {
+            match = node;
+        }
+        if (prefix_length == trie->max_prefix_length) {
+            break;
+        }
+        node = node->children[_ebpf_lpm_trie_extract_bit(data, prefix_length)];
+    }
+
+    if (match == NULL) {
+        return EBPF_KEY_NOT_FOUND;
+    }
+
+    *value = _ebpf_lpm_trie_node_value(trie, match);
+    return EBPF_SUCCESS;
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_lpm_trie_update(
+    _Inout_ ebpf_lpm_trie_t* trie,
+    _In_ const uint8_t* key,
+    _In_opt_ const uint8_t* value,
+    ebpf_lpm_trie_operations_t operation)
+{
+    ebpf_result_t result;
+    uint32_t prefix_length = *(const uint32_t*)key;
+    const uint8_t* data = key + sizeof(uint32_t);
+    ebpf_lpm_trie_node_t* new_node = NULL;
+    ebpf_lpm_trie_node_t* glue_node = NULL;
+    ebpf_lpm_trie_node_t* old_node = NULL;
+    ebpf_lock_state_t state = 0;
+    bool locked = false;
+
+    if (prefix_length > trie->max_prefix_length) {
+        result = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
+    new_node = _ebpf_lpm_trie_allocate_node(trie, prefix_length, data, 0);
+    if (new_node == NULL) {
+        result = EBPF_NO_MEMORY;
+        goto Done;
+    }
+    if (value) {
+        memcpy(_ebpf_lpm_trie_node_value(trie, new_node), value, trie->value_size);
+    }
+
+    state = ebpf_lock_lock(&trie->lock);
+    locked = true;
+
+    // Find the slot where the prefix belongs.
+    ebpf_lpm_trie_node_t* volatile* slot = &trie->root;
+    ebpf_lpm_trie_node_t* node;
+    uint32_t match_length = 0;
+    while ((node = *slot) != NULL) {
+        uint32_t limit = node->prefix_length < prefix_length ? node->prefix_length : prefix_length;
+        match_length = _ebpf_lpm_trie_match_length(node->data, data, 0, limit);
+        if (match_length != node->prefix_length || node->prefix_length == prefix_length) {
+            break;
+        }
+        slot = &node->children[_ebpf_lpm_trie_extract_bit(data, node->prefix_length)];
+    }
+
+    if (node == NULL) {
+        if (operation == EBPF_LPM_TRIE_OPERATION_REPLACE) {
+            result = EBPF_KEY_NOT_FOUND;
+            goto Done;
+        }
+    } else if (match_length == prefix_length && node->prefix_length == prefix_length) {
+        // The prefix has a node already, either an entry or a branch point. Replace it with a copy holding the value.
+        bool entry_exists = !(node->flags & EBPF_LPM_TRIE_NODE_FLAG_INTERMEDIATE);
+        if (entry_exists && operation == EBPF_LPM_TRIE_OPERATION_INSERT) {
+            result = EBPF_OBJECT_ALREADY_EXISTS;
+            goto Done;
+        }
+        if (!entry_exists && operation == EBPF_LPM_TRIE_OPERATION_REPLACE) {
+            result = EBPF_KEY_NOT_FOUND;
+            goto Done;
+        }
+        new_node->children[0] = node->children[0];
+        new_node->children[1] = node->children[1];
+        old_node = node;
+    } else if (operation == EBPF_LPM_TRIE_OPERATION_REPLACE) {
+        result = EBPF_KEY_NOT_FOUND;
+        goto Done;
+    } else if (match_length == prefix_length) {
+        // The new prefix covers the existing node, so it becomes its parent.
+        new_node->children[_ebpf_lpm_trie_extract_bit(node->data, prefix_length)] = node;
+    } else {
+        // The prefixes diverge, so join them under a branch point at the first differing bit.
+        glue_node = _ebpf_lpm_trie_allocate_node(trie, match_length, data, EBPF_LPM_TRIE_NODE_FLAG_INTERMEDIATE);
+        if (glue_node == NULL) {
+            result = EBPF_NO_MEMORY;
+            goto Done;
+        }
+        uint32_t bit = _ebpf_lpm_trie_extract_bit(data, match_length);
+        glue_node->children[bit] = new_node;
+        glue_node->children[!bit] = node;
+    }
+
+    // Publish the new subtree. Readers see either the old or the new node, never a partially built one.
+    *slot = glue_node ? glue_node : new_node;
+    glue_node = NULL;
+    new_node = NULL;
+    result = EBPF_SUCCESS;
+
+Done:
+    if (locked) {
+        ebpf_lock_unlock(&trie->lock, state);
+    }
+    ebpf_epoch_free(new_node);
+    ebpf_epoch_free(glue_node);
+    ebpf_epoch_free(old_node);
+    return result;
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_lpm_trie_delete(_Inout_ ebpf_lpm_trie_t* trie, _In_ const uint8_t* key)
+{
+    ebpf_result_t result;
+    uint32_t prefix_length = *(const uint32_t*)key;
+    const uint8_t* data = key + sizeof(uint32_t);
+    ebpf_lpm_trie_node_t* old_node = NULL;
+    ebpf_lpm_trie_node_t* old_parent = NULL;
+
+    if (prefix_length > trie->max_prefix_length) {
+        return EBPF_INVALID_ARGUMENT;
+    }
+
+    ebpf_lock_state_t state = ebpf_lock_lock(&trie->lock);
+
+    // Only the bits within the prefix are compared, so bits past it in the key don't affect which entry is removed.
+    ebpf_lpm_trie_node_t* volatile* slot = &trie->root;
+    ebpf_lpm_trie_node_t* volatile* parent_slot = NULL;
+    ebpf_lpm_trie_node_t* parent = NULL;
+    ebpf_lpm_trie_node_t* node;
+    uint32_t match_length = 0;
+    while ((node = *slot) != NULL) {
+        uint32_t limit = node->prefix_length < prefix_length ? node->prefix_length : prefix_length;
+        match_length = _ebpf_lpm_trie_match_length(node->data, data, 0, limit);
+        if (match_length != node->prefix_length || node->prefix_length == prefix_length) {
+            break;
+        }
+        parent = node;
+        parent_slot = slot;
+        slot = &node->children[_ebpf_lpm_trie_extract_bit(data, node->prefix_length)];
+    }
+
+    if (node == NULL || node->prefix_length != prefix_length || match_length != prefix_length ||
+        (node->flags & EBPF_LPM_TRIE_NODE_FLAG_INTERMEDIATE)) {
+        result = EBPF_KEY_NOT_FOUND;
+        goto Done;
+    }
+
+    if (node->children[0] && node->children[1]) {
+        // The node is still needed as a branch point. Readers that already found it keep a valid value.
+        node->flags |= EBPF_LPM_TRIE_NODE_FLAG_INTERMEDIATE;
+    } else if (
+        parent && (parent->flags & EBPF_LPM_TRIE_NODE_FLAG_INTERMEDIATE) && !node->children[0] &&
+        !node->children[1]) {
+        // Removing a leaf leaves its branch point with one child, so replace the branch point with the sibling.
+        _Analysis_assume_(parent_slot != NULL);
+        *parent_slot = parent->children[parent->children[0] == node ? 1 : 0];
+        old_node = node;
+        old_parent = parent;
+    } else {
+        *slot = node->children[0] ? node->children[0] : node->children[1];
+        old_node = node;
+    }
+    result = EBPF_SUCCESS;
+
+Done:
+    ebpf_lock_unlock(&trie->lock, state);
+    ebpf_epoch_free(old_node);
+    ebpf_epoch_free(old_parent);
+    return result;
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_lpm_trie_next_key_and_value(
+    _In_ const ebpf_lpm_trie_t* trie,
+    _In_opt_ const uint8_t* previous_key,
+    _Out_ uint8_t* next_key,
+    _Inout_opt_ uint8_t** next_value)
+{
+    const ebpf_lpm_trie_node_t* subtree = trie->root;
+
+    if (previous_key) {
+        uint32_t prefix_length = *(const uint32_t*)previous_key;
+        if (prefix_length > trie->max_prefix_length) {
+            return EBPF_INVALID_ARGUMENT;
+        }
+        subtree = _ebpf_lpm_trie_find_successor(trie, prefix_length, previous_key + sizeof(uint32_t));
+    }
+
+    const ebpf_lpm_trie_node_t* next = _ebpf_lpm_trie_first_entry(subtree);
+    if (next == NULL) {
+        return EBPF_NO_MORE_KEYS;
+    }
+
+    memcpy(next_key, &next->prefix_length, sizeof(uint32_t));
+    memcpy(next_key + sizeof(uint32_t), next->data, trie->data_size);
+    if (next_value) {
+        *next_value = _ebpf_lpm_trie_node_value(trie, next);
+    }
+    return EBPF_SUCCESS;
+}
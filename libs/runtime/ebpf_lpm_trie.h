@@ -0,0 +1,113 @@
+// Copyright (c) eBPF for Windows contributors
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "ebpf_platform.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef enum _ebpf_lpm_trie_operations
+    {
+        EBPF_LPM_TRIE_OPERATION_ANY = 0,
+        EBPF_LPM_TRIE_OPERATION_INSERT = 1,
+        EBPF_LPM_TRIE_OPERATION_REPLACE = 2,
+    } ebpf_lpm_trie_operations_t;
+
+    typedef struct _ebpf_lpm_trie ebpf_lpm_trie_t;
+
+    /**
+     * @brief Allocate and initialize a longest prefix match trie. Keys are a
+     * uint32_t prefix length in bits followed by key_size - sizeof(uint32_t)
+     * bytes of prefix data in network order. Lookups do not take a lock and
+     * must be performed within an epoch.
+     *
+     * @param[out] trie Pointer to memory that will contain the trie on success.
+     * @param[in] key_size Size of key in bytes, including the prefix length.
+     * @param[in] value_size Size of value in bytes.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_NO_MEMORY Unable to allocate resources for this trie.
+     * @retval EBPF_INVALID_ARGUMENT The key holds no prefix data.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_lpm_trie_create(_Outptr_ ebpf_lpm_trie_t** trie, size_t key_size, size_t value_size);
+
+    /**
+     * @brief Remove all entries from the trie and release memory.
+     *
+     * @param[in] trie Trie to release.
+     */
+    void
+    ebpf_lpm_trie_destroy(_In_opt_ _Post_ptr_invalid_ ebpf_lpm_trie_t* trie);
+
+    /**
+     * @brief Find the entry with the longest prefix that matches the key. The
+     * prefix length in the key is ignored and all prefix data bits are matched.
+     *
+     * @param[in] trie Trie to search.
+     * @param[in] key Key to match.
+     * @param[out] value Pointer to value of the matching entry.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_KEY_NOT_FOUND No entry matches the key.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_lpm_trie_find(_In_ const ebpf_lpm_trie_t* trie, _In_ const uint8_t* key, _Outptr_ uint8_t** value);
+
+    /**
+     * @brief Insert or update the entry for a prefix. Updates publish a new
+     * copy of the entry, so values returned by earlier finds are left intact.
+     *
+     * @param[in, out] trie Trie to update.
+     * @param[in] key Prefix to insert or update.
+     * @param[in] value Value to store or NULL to store a zero value.
+     * @param[in] operation One of ebpf_lpm_trie_operations_t operations.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_NO_MEMORY Unable to allocate memory for this entry.
+     * @retval EBPF_INVALID_ARGUMENT The prefix length is larger than the key.
+     * @retval EBPF_OBJECT_ALREADY_EXISTS The operation requires a new entry and the prefix is present.
+     * @retval EBPF_KEY_NOT_FOUND The operation requires an existing entry and the prefix was not found.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_lpm_trie_update(
+        _Inout_ ebpf_lpm_trie_t* trie,
+        _In_ const uint8_t* key,
+        _In_opt_ const uint8_t* value,
+        ebpf_lpm_trie_operations_t operation);
+
+    /**
+     * @brief Remove the entry for a prefix.
+     *
+     * @param[in, out] trie Trie to update.
+     * @param[in] key Prefix to remove.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_INVALID_ARGUMENT The prefix length is larger than the key.
+     * @retval EBPF_KEY_NOT_FOUND The prefix was not found.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_lpm_trie_delete(_Inout_ ebpf_lpm_trie_t* trie, _In_ const uint8_t* key);
+
+    /**
+     * @brief Fetch the key and value of the entry that follows a prefix. Entries
+     * are ordered by prefix data with shorter prefixes first, so a walk
+     * continues correctly even if the previous prefix was removed.
+     *
+     * @param[in] trie Trie to search.
+     * @param[in] previous_key Prefix to start from or NULL to fetch the first entry.
+     * @param[out] next_key Key of the next entry.
+     * @param[out] next_value If not NULL, set to the value of the next entry.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_INVALID_ARGUMENT The prefix length is larger than the key.
+     * @retval EBPF_NO_MORE_KEYS No entries follow the previous prefix.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_lpm_trie_next_key_and_value(
+        _In_ const ebpf_lpm_trie_t* trie,
+        _In_opt_ const uint8_t* previous_key,
+        _Out_ uint8_t* next_key,
+        _Inout_opt_ uint8_t** next_value);
+
+#ifdef __cplusplus
+}
+#endif
@@ -153,6 +153,7 @@ ebpf_object_tracking_initiate()
         .value_size = sizeof(ebpf_id_entry_t),
         .max_entries = EBPF_HASH_TABLE_NO_LIMIT,
         .minimum_bucket_count = 1024,
+        .maximum_bucket_count = EBPF_HASH_TABLE_MAXIMUM_BUCKET_COUNT,
     };
 
     memset(_ebpf_object_reference_history, 0, sizeof(_ebpf_object_reference_history));
@@ -343,6 +344,12 @@ ebpf_object_get_type(_In_ const ebpf_core_object_t* object)
     return object->type;
 }
 
+bool
+ebpf_object_is_core_object(_In_ const ebpf_base_object_t* object)
+{
+    return object->marker == _ebpf_object_marker;
+}
+
 _Must_inspect_result_ ebpf_result_t
 ebpf_duplicate_utf8_string(_Out_ cxplat_utf8_string_t* destination, _In_ const cxplat_utf8_string_t* source)
 {
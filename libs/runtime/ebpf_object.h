@@ -223,6 +223,16 @@ extern "C"
     ebpf_object_type_t
     ebpf_object_get_type(_In_ const ebpf_core_object_t* object);
 
+    /**
+     * @brief Check if a base object is an ebpf_core_object_t.
+     *
+     * @param[in] object Object to be queried.
+     * @retval true The object is an ebpf_core_object_t.
+     * @retval false The object is some other kind of object.
+     */
+    bool
+    ebpf_object_is_core_object(_In_ const ebpf_base_object_t* object);
+
     /**
      * @brief Find the next object that is of this type and acquire reference
      *  on it.
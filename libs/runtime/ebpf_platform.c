@@ -227,6 +227,23 @@ ebpf_query_time_since_boot(bool include_suspended_time)
     }
 }
 
+uint64_t
+ebpf_query_performance_counter()
+{
+    return (uint64_t)KeQueryPerformanceCounter(NULL).QuadPart;
+}
+
+uint64_t
+ebpf_performance_counter_to_nanoseconds(uint64_t ticks)
+{
+    LARGE_INTEGER frequency;
+    KeQueryPerformanceCounter(&frequency);
+    uint64_t ticks_per_second = (uint64_t)frequency.QuadPart;
+
+    // Split the conversion so that large tick counts don't overflow.
+    return (ticks / ticks_per_second) * 1000000000 + ((ticks % ticks_per_second) * 1000000000) / ticks_per_second;
+}
+
 MDL*
 ebpf_map_memory(size_t length)
 {
@@ -73,6 +73,8 @@ extern "C"
     } ebpf_page_protection_t;
 
     typedef struct _ebpf_ring_descriptor ebpf_ring_descriptor_t;
+    typedef struct _ebpf_locked_user_buffer ebpf_locked_user_buffer_t;
+    typedef struct _ebpf_user_mapping ebpf_user_mapping_t;
 
     /**
      * @brief Allocate pages from physical memory and create a mapping into the
@@ -158,6 +160,97 @@ extern "C"
     _Ret_maybenull_ void*
     ebpf_ring_map_readonly_user(_In_ const ebpf_ring_descriptor_t* ring);
 
+    /**
+     * @brief Create a mapping in the calling process of memory allocated via
+     * ebpf_map_memory.
+     *
+     * @param[in] memory_descriptor Pointer to an ebpf_memory_descriptor_t
+     * describing allocated pages.
+     * @param[in] protection EBPF_PAGE_PROTECT_READ_ONLY or EBPF_PAGE_PROTECT_READ_WRITE.
+     * @return Pointer to the base of the mapping or NULL on failure.
+     */
+    _Ret_maybenull_ void*
+    ebpf_map_memory_user(_In_ MDL* memory_descriptor, ebpf_page_protection_t protection);
+
+    /**
+     * @brief Create a tracked mapping in the calling process of memory
+     * allocated via ebpf_map_memory. Unlike ebpf_map_memory_user, the mapping
+     * can be removed later, even from the context of another process.
+     *
+     * @param[in] memory_descriptor Pointer to an ebpf_memory_descriptor_t
+     * describing allocated pages.
+     * @param[in] protection EBPF_PAGE_PROTECT_READ_ONLY or EBPF_PAGE_PROTECT_READ_WRITE.
+     * @param[out] mapping Pointer to memory that will contain the mapping on
+     * success. Release it with ebpf_delete_user_mapping.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_INVALID_ARGUMENT The protection is invalid.
+     * @retval EBPF_NO_MEMORY Unable to allocate resources for this operation.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_create_user_mapping(
+        _In_ MDL* memory_descriptor, ebpf_page_protection_t protection, _Outptr_ ebpf_user_mapping_t** mapping);
+
+    /**
+     * @brief Remove a mapping created via ebpf_create_user_mapping from the
+     * process that created it.
+     *
+     * @param[in] mapping Mapping to remove.
+     */
+    void
+    ebpf_delete_user_mapping(_Frees_ptr_opt_ ebpf_user_mapping_t* mapping);
+
+    /**
+     * @brief Get the address of a mapping created via ebpf_create_user_mapping
+     * in the process that created it.
+     *
+     * @param[in] mapping Mapping.
+     * @return Address of the mapping.
+     */
+    _Ret_notnull_ void*
+    ebpf_user_mapping_get_address(_In_ const ebpf_user_mapping_t* mapping);
+
+    /**
+     * @brief Lock the pages of a buffer in the calling process and map them
+     * into the system address space, so the buffer can be accessed in place
+     * without faulting, even while locks are held.
+     *
+     * @param[in] address Address of the buffer in the calling process.
+     * @param[in] length Length of the buffer in bytes, at most 4 GB.
+     * @param[in] protection EBPF_PAGE_PROTECT_READ_ONLY if the buffer is only
+     * read or EBPF_PAGE_PROTECT_READ_WRITE if it is written to.
+     * @param[out] buffer Pointer to memory that will contain the locked buffer
+     * on success. Release it with ebpf_unlock_user_buffer.
+     * @retval EBPF_SUCCESS The operation was successful.
+     * @retval EBPF_INVALID_ARGUMENT The length or protection is invalid.
+     * @retval EBPF_INVALID_POINTER The buffer isn't accessible to the calling
+     * process.
+     * @retval EBPF_NO_MEMORY Unable to allocate resources for this operation.
+     */
+    _Must_inspect_result_ ebpf_result_t
+    ebpf_lock_user_buffer(
+        uint64_t address,
+        size_t length,
+        ebpf_page_protection_t protection,
+        _Outptr_ ebpf_locked_user_buffer_t** buffer);
+
+    /**
+     * @brief Unlock and unmap a buffer locked via ebpf_lock_user_buffer.
+     *
+     * @param[in] buffer Locked buffer to release.
+     */
+    void
+    ebpf_unlock_user_buffer(_Frees_ptr_opt_ ebpf_locked_user_buffer_t* buffer);
+
+    /**
+     * @brief Get the address of a buffer locked via ebpf_lock_user_buffer in
+     * the system address space.
+     *
+     * @param[in] buffer Locked buffer.
+     * @return Address of the buffer in the system address space.
+     */
+    _Ret_notnull_ void*
+    ebpf_locked_user_buffer_get_address(_In_ const ebpf_locked_user_buffer_t* buffer);
+
     /**
      * @brief Allocate and copy a UTF-8 string.
      *
@@ -611,6 +704,23 @@ extern "C"
     uint64_t
     ebpf_query_time_since_boot(bool include_suspended_time);
 
+    /**
+     * @brief Return the current value of the high resolution performance counter.
+     *
+     * @return Current performance counter value, in ticks.
+     */
+    uint64_t
+    ebpf_query_performance_counter();
+
+    /**
+     * @brief Convert a number of performance counter ticks to nanoseconds.
+     *
+     * @param[in] ticks Number of performance counter ticks.
+     * @return The number of nanoseconds the ticks represent.
+     */
+    uint64_t
+    ebpf_performance_counter_to_nanoseconds(uint64_t ticks);
+
     _Must_inspect_result_ ebpf_result_t
     ebpf_set_current_thread_affinity(uintptr_t new_thread_affinity_mask, _Out_ uintptr_t* old_thread_affinity_mask);
 
@@ -6,12 +6,19 @@
 #include "ebpf_ring_buffer_record.h"
 #include "ebpf_tracelog.h"
 
+// Free space in the ring is filled with this byte so that the header of a record whose space has been claimed
+// by a producer, but not yet written, reads as locked.
+#define EBPF_RING_BUFFER_FREE_SPACE_FILL 0x01
+
 typedef struct _ebpf_ring_buffer
 {
-    ebpf_lock_t lock;
+    ebpf_lock_t lock; ///< Serializes consumers. Producers only acquire the lock to reclaim consumed space.
     size_t length;
-    size_t consumer_offset;
-    size_t producer_offset;
+    volatile size_t consumer_offset; ///< Space before this offset has been returned to producers.
+    ebpf_ring_buffer_producer_page_t* producer_page;
+    ebpf_ring_buffer_consumer_page_t* consumer_page;
+    MDL* producer_page_memory;
+    MDL* consumer_page_memory;
     uint8_t* shared_buffer;
     ebpf_ring_descriptor_t* ring_descriptor;
 } ebpf_ring_buffer_t;
@@ -22,12 +29,6 @@ _ring_get_length(_In_ const ebpf_ring_buffer_t* ring)
     return ring->length;
 }
 
-inline static size_t
-_ring_get_producer_offset(_In_ const ebpf_ring_buffer_t* ring)
-{
-    return ring->producer_offset % ring->length;
-}
-
 inline static size_t
 _ring_get_consumer_offset(_In_ const ebpf_ring_buffer_t* ring)
 {
@@ -37,14 +38,8 @@ _ring_get_consumer_offset(_In_ const ebpf_ring_buffer_t* ring)
 inline static size_t
 _ring_get_used_capacity(_In_ const ebpf_ring_buffer_t* ring)
 {
-    ebpf_assert(ring->producer_offset >= ring->consumer_offset);
-    return ring->producer_offset - ring->consumer_offset;
-}
-
-inline static void
-_ring_advance_producer_offset(_Inout_ ebpf_ring_buffer_t* ring, size_t length)
-{
-    ring->producer_offset += length;
+    ebpf_assert(ring->producer_page->producer_offset >= ring->consumer_offset);
+    return ring->producer_page->producer_offset - ring->consumer_offset;
 }
 
 inline static void
@@ -65,20 +60,140 @@ _ring_next_consumer_record(_In_ const ebpf_ring_buffer_t* ring)
     return _ring_record_at_offset(ring, _ring_get_consumer_offset(ring));
 }
 
+/**
+ * @brief Return space at the consumer offset to producers. Every record in the
+ * space must have been submitted or discarded.
+ *
+ * @param[in, out] ring Ring buffer to update.
+ * @param[in] length Length of bytes to return to the ring buffer.
+ * @retval EBPF_SUCCESS Successfully returned records to the ring buffer.
+ * @retval EBPF_INVALID_ARGUMENT The length doesn't end on the boundary of an unlocked record.
+ */
+static _Requires_lock_held_(ring->lock) ebpf_result_t
+    _ring_return_space(_Inout_ ebpf_ring_buffer_t* ring, size_t length)
+{
+    size_t local_length = length;
+    size_t offset = _ring_get_consumer_offset(ring);
+
+    if ((length > _ring_get_length(ring)) || length > _ring_get_used_capacity(ring)) {
+        EBPF_LOG_MESSAGE_UINT64_UINT64(
+            EBPF_TRACELOG_LEVEL_ERROR,
+            EBPF_TRACELOG_KEYWORD_MAP,
+            "ebpf_ring_buffer_return: Buffer too large",
+            ring->producer_page->producer_offset,
+            ring->consumer_offset);
+        return EBPF_INVALID_ARGUMENT;
+    }
+
+    // Verify count.
+    while (local_length != 0) {
+        ebpf_ring_buffer_record_t* record = _ring_record_at_offset(ring, offset);
+        // A locked record may still be written to by its producer.
+        if (ebpf_ring_buffer_record_is_locked(record)) {
+            break;
+        }
+        if (local_length < record->header.length) {
+            break;
+        }
+        offset += record->header.length;
+        local_length -= record->header.length;
+    }
+    // Did it end on a record boundary?
+    if (local_length != 0) {
+        EBPF_LOG_MESSAGE_UINT64(
+            EBPF_TRACELOG_LEVEL_ERROR,
+            EBPF_TRACELOG_KEYWORD_MAP,
+            "ebpf_ring_buffer_return: Invalid buffer length",
+            local_length);
+        return EBPF_INVALID_ARGUMENT;
+    }
+
+    // Refill the returned space before handing it back to producers, so that records acquired in it read as
+    // locked until they are submitted. The ring is double mapped, so the fill may run past the end of the buffer.
+    memset(_ring_next_consumer_record(ring), EBPF_RING_BUFFER_FREE_SPACE_FILL, length);
+    MemoryBarrier();
+    _ring_advance_consumer_offset(ring, length);
+    return EBPF_SUCCESS;
+}
+
+/**
+ * @brief Return the space before the offset published in the consumer page.
+ * The page is writable by the consumer, so the offset is validated like an
+ * offset passed to ebpf_ring_buffer_return and ignored if it is invalid.
+ *
+ * @param[in, out] ring Ring buffer to update.
+ */
+static _Requires_lock_held_(ring->lock) void _ring_reclaim_consumed_space_under_lock(
+    _Inout_ ebpf_ring_buffer_t* ring)
+{
+    size_t consumer_offset = ring->consumer_page->consumer_offset;
+    if (consumer_offset > ring->consumer_offset) {
+        (void)_ring_return_space(ring, consumer_offset - ring->consumer_offset);
+    }
+}
+
+static void
+_ring_reclaim_consumed_space(_Inout_ ebpf_ring_buffer_t* ring)
+{
+    if (ring->consumer_page->consumer_offset == ring->consumer_offset) {
+        return;
+    }
+    ebpf_lock_state_t state = ebpf_lock_lock(&ring->lock);
+    _ring_reclaim_consumed_space_under_lock(ring);
+    ebpf_lock_unlock(&ring->lock, state);
+}
+
+/**
+ * @brief Claim space for a record and mark it as locked. Space is claimed by
+ * advancing the producer offset with a compare exchange, so any number of
+ * producers can acquire records concurrently without taking the ring lock.
+ * The record is left locked until ebpf_ring_buffer_submit or
+ * ebpf_ring_buffer_discard is called on it.
+ *
+ * @param[in, out] ring Ring buffer to acquire the record from.
+ * @param[in] requested_length Length of the record data.
+ * @return Pointer to the locked record or NULL if the ring is full.
+ */
 inline static _Ret_maybenull_ ebpf_ring_buffer_record_t*
 _ring_buffer_acquire_record(_Inout_ ebpf_ring_buffer_t* ring, size_t requested_length)
 {
-    ebpf_ring_buffer_record_t* record = NULL;
     requested_length += EBPF_OFFSET_OF(ebpf_ring_buffer_record_t, data);
-    size_t remaining_space = ring->length - (ring->producer_offset - ring->consumer_offset);
-
-    if (remaining_space > requested_length) {
-        record = _ring_record_at_offset(ring, _ring_get_producer_offset(ring));
-        _ring_advance_producer_offset(ring, requested_length);
-        record->header.length = (uint32_t)requested_length;
-        record->header.locked = 1;
-        record->header.discarded = 0;
+    size_t producer_offset = ring->producer_page->producer_offset;
+    bool reclaimed = false;
+
+    for (;;) {
+        // The consumer offset only moves forward, so a stale read can only under report the remaining space. An
+        // unconditional fetch-add could move the producer offset past the consumer, so the offset is advanced with a
+        // compare exchange once there is room for the record.
+        size_t remaining_space = ring->length - (producer_offset - ring->consumer_offset);
+        if (remaining_space <= requested_length) {
+            // The consumer may have read records without calling into the kernel. Take back the space it has
+            // published once before failing.
+            if (reclaimed) {
+                return NULL;
+            }
+            _ring_reclaim_consumed_space(ring);
+            reclaimed = true;
+            producer_offset = ring->producer_page->producer_offset;
+            continue;
+        }
+
+        size_t observed_offset = (size_t)ebpf_interlocked_compare_exchange_int64(
+            (volatile int64_t*)&ring->producer_page->producer_offset,
+            (int64_t)(producer_offset + requested_length),
+            (int64_t)producer_offset);
+        if (observed_offset == producer_offset) {
+            break;
+        }
+        producer_offset = observed_offset;
     }
+
+    // The space was filled with EBPF_RING_BUFFER_FREE_SPACE_FILL when it was returned, so the consumer sees the
+    // record as locked until it is submitted or discarded.
+    ebpf_ring_buffer_record_t* record = _ring_record_at_offset(ring, producer_offset);
+    record->header.length = (uint32_t)requested_length;
+    record->header.discarded = 0;
+    record->header.locked = 1;
     return record;
 }
 
@@ -107,6 +222,24 @@ ebpf_ring_buffer_create(_Outptr_ ebpf_ring_buffer_t** ring, size_t capacity)
         goto Error;
     }
     local_ring_buffer->shared_buffer = ebpf_ring_descriptor_get_base_address(local_ring_buffer->ring_descriptor);
+    memset(local_ring_buffer->shared_buffer, EBPF_RING_BUFFER_FREE_SPACE_FILL, capacity);
+
+    local_ring_buffer->producer_page_memory = ebpf_map_memory(sizeof(ebpf_ring_buffer_producer_page_t));
+    local_ring_buffer->consumer_page_memory = ebpf_map_memory(sizeof(ebpf_ring_buffer_consumer_page_t));
+    if (!local_ring_buffer->producer_page_memory || !local_ring_buffer->consumer_page_memory) {
+        result = EBPF_NO_MEMORY;
+        goto Error;
+    }
+    local_ring_buffer->producer_page =
+        ebpf_memory_descriptor_get_base_address(local_ring_buffer->producer_page_memory);
+    local_ring_buffer->consumer_page =
+        ebpf_memory_descriptor_get_base_address(local_ring_buffer->consumer_page_memory);
+    if (!local_ring_buffer->producer_page || !local_ring_buffer->consumer_page) {
+        result = EBPF_NO_MEMORY;
+        goto Error;
+    }
+    local_ring_buffer->producer_page->producer_offset = 0;
+    local_ring_buffer->consumer_page->consumer_offset = 0;
 
     *ring = local_ring_buffer;
     local_ring_buffer = NULL;
@@ -124,6 +257,8 @@ ebpf_ring_buffer_destroy(_Frees_ptr_opt_ ebpf_ring_buffer_t* ring)
     if (ring) {
         EBPF_LOG_ENTRY();
 
+        ebpf_unmap_memory(ring->consumer_page_memory);
+        ebpf_unmap_memory(ring->producer_page_memory);
         ebpf_free_ring_buffer_memory(ring->ring_descriptor);
         ebpf_epoch_free(ring);
 
@@ -134,30 +269,23 @@ ebpf_ring_buffer_destroy(_Frees_ptr_opt_ ebpf_ring_buffer_t* ring)
 _Must_inspect_result_ ebpf_result_t
 ebpf_ring_buffer_output(_Inout_ ebpf_ring_buffer_t* ring, _In_reads_bytes_(length) uint8_t* data, size_t length)
 {
-    ebpf_result_t result;
-    ebpf_lock_state_t state = ebpf_lock_lock(&ring->lock);
     ebpf_ring_buffer_record_t* record = _ring_buffer_acquire_record(ring, length);
 
     if (record == NULL) {
-        result = EBPF_OUT_OF_SPACE;
-        goto Done;
+        return EBPF_OUT_OF_SPACE;
     }
 
-    record->header.discarded = 0;
-    record->header.locked = 0;
     memcpy(record->data, data, length);
-    result = EBPF_SUCCESS;
-Done:
-    ebpf_lock_unlock(&ring->lock, state);
-    return result;
+    return ebpf_ring_buffer_submit(record->data);
 }
 
 void
 ebpf_ring_buffer_query(_In_ ebpf_ring_buffer_t* ring, _Out_ size_t* consumer, _Out_ size_t* producer)
 {
     ebpf_lock_state_t state = ebpf_lock_lock(&ring->lock);
+    _ring_reclaim_consumed_space_under_lock(ring);
     *consumer = ring->consumer_offset;
-    *producer = ring->producer_offset;
+    *producer = ring->producer_page->producer_offset;
     ebpf_lock_unlock(&ring->lock, state);
 }
 
@@ -165,46 +293,8 @@ _Must_inspect_result_ ebpf_result_t
 ebpf_ring_buffer_return(_Inout_ ebpf_ring_buffer_t* ring, size_t length)
 {
     EBPF_LOG_ENTRY();
-    ebpf_result_t result;
     ebpf_lock_state_t state = ebpf_lock_lock(&ring->lock);
-    size_t local_length = length;
-    size_t offset = _ring_get_consumer_offset(ring);
-
-    if ((length > _ring_get_length(ring)) || length > _ring_get_used_capacity(ring)) {
-        EBPF_LOG_MESSAGE_UINT64_UINT64(
-            EBPF_TRACELOG_LEVEL_ERROR,
-            EBPF_TRACELOG_KEYWORD_MAP,
-            "ebpf_ring_buffer_return: Buffer too large",
-            ring->producer_offset,
-            ring->consumer_offset);
-        result = EBPF_INVALID_ARGUMENT;
-        goto Done;
-    }
-
-    // Verify count.
-    while (local_length != 0) {
-        ebpf_ring_buffer_record_t* record = _ring_record_at_offset(ring, offset);
-        if (local_length < record->header.length) {
-            break;
-        }
-        offset += record->header.length;
-        local_length -= record->header.length;
-    }
-    // Did it end on a record boundary?
-    if (local_length != 0) {
-        EBPF_LOG_MESSAGE_UINT64(
-            EBPF_TRACELOG_LEVEL_ERROR,
-            EBPF_TRACELOG_KEYWORD_MAP,
-            "ebpf_ring_buffer_return: Invalid buffer length",
-            local_length);
-        result = EBPF_INVALID_ARGUMENT;
-        goto Done;
-    }
-
-    _ring_advance_consumer_offset(ring, length);
-    result = EBPF_SUCCESS;
-
-Done:
+    ebpf_result_t result = _ring_return_space(ring, length);
     ebpf_lock_unlock(&ring->lock, state);
     EBPF_RETURN_RESULT(result);
 }
@@ -220,26 +310,32 @@ ebpf_ring_buffer_map_buffer(_In_ const ebpf_ring_buffer_t* ring, _Outptr_ uint8_
     }
 }
 
+_Must_inspect_result_ ebpf_result_t
+ebpf_ring_buffer_map_offsets(
+    _In_ const ebpf_ring_buffer_t* ring,
+    _Outptr_ const ebpf_ring_buffer_producer_page_t** producer_page,
+    _Outptr_ ebpf_ring_buffer_consumer_page_t** consumer_page)
+{
+    *producer_page = ebpf_map_memory_user(ring->producer_page_memory, EBPF_PAGE_PROTECT_READ_ONLY);
+    *consumer_page = ebpf_map_memory_user(ring->consumer_page_memory, EBPF_PAGE_PROTECT_READ_WRITE);
+    if (!*producer_page || !*consumer_page) {
+        return EBPF_INVALID_ARGUMENT;
+    } else {
+        return EBPF_SUCCESS;
+    }
+}
+
 _Must_inspect_result_ ebpf_result_t
 ebpf_ring_buffer_reserve(
     _Inout_ ebpf_ring_buffer_t* ring, _Outptr_result_bytebuffer_(length) uint8_t** data, size_t length)
 {
-    ebpf_result_t result;
-    ebpf_lock_state_t state = ebpf_lock_lock(&ring->lock);
     ebpf_ring_buffer_record_t* record = _ring_buffer_acquire_record(ring, length);
     if (record == NULL) {
-        result = EBPF_INVALID_ARGUMENT;
-        goto Done;
+        return EBPF_INVALID_ARGUMENT;
     }
 
-    record->header.locked = 1;
-    MemoryBarrier();
-
     *data = record->data;
-    result = EBPF_SUCCESS;
-Done:
-    ebpf_lock_unlock(&ring->lock, state);
-    return result;
+    return EBPF_SUCCESS;
 }
 
 _Must_inspect_result_ ebpf_result_t
@@ -30,7 +30,8 @@ void
 ebpf_ring_buffer_destroy(_Frees_ptr_opt_ ebpf_ring_buffer_t* ring_buffer);
 
 /**
- * @brief Write out a variable sized record to the ring buffer.
+ * @brief Write out a variable sized record to the ring buffer. Producers don't
+ * acquire a lock, so this can be called concurrently from any number of CPUs.
  *
  * @param[in, out] ring_buffer Ring buffer to write to.
  * @param[in] data Data to copy into record.
@@ -42,7 +43,9 @@ _Must_inspect_result_ ebpf_result_t
 ebpf_ring_buffer_output(_Inout_ ebpf_ring_buffer_t* ring_buffer, _In_reads_bytes_(length) uint8_t* data, size_t length);
 
 /**
- * @brief Query the current ready and free offsets from the ring buffer.
+ * @brief Query the current ready and free offsets from the ring buffer. Records
+ * between the offsets may still be locked by their producer. Space the
+ * consumer has released through the consumer page is returned first.
  *
  * @param[in] ring_buffer Ring buffer to query.
  * @param[out] consumer Offset of the first buffer that can be consumed.
@@ -53,6 +56,7 @@ ebpf_ring_buffer_query(_In_ ebpf_ring_buffer_t* ring_buffer, _Out_ size_t* consu
 
 /**
  * @brief Mark one or more records in the ring buffer as returned to the ring.
+ * Records that are still locked by their producer can't be returned.
  *
  * @param[in, out] ring_buffer Ring buffer to update.
  * @param[in] length Length of bytes to return to the ring buffer.
@@ -73,6 +77,25 @@ ebpf_ring_buffer_return(_Inout_ ebpf_ring_buffer_t* ring_buffer, size_t length);
 _Must_inspect_result_ ebpf_result_t
 ebpf_ring_buffer_map_buffer(_In_ const ebpf_ring_buffer_t* ring_buffer, _Outptr_ uint8_t** buffer);
 
+/**
+ * @brief Map the pages holding the producer and consumer offsets into the
+ * calling process. The producer page is read-only. The consumer writes the
+ * offset of the first record it has not read to the consumer page, and the
+ * space before it is returned when producers run out of space or the ring
+ * buffer is queried.
+ *
+ * @param[in] ring_buffer Ring buffer to map.
+ * @param[out] producer_page Pointer to the producer page.
+ * @param[out] consumer_page Pointer to the consumer page.
+ * @retval EBPF_SUCCESS Successfully mapped the pages.
+ * @retval EBPF_INVALID_ARGUMENT Unable to map the pages.
+ */
+_Must_inspect_result_ ebpf_result_t
+ebpf_ring_buffer_map_offsets(
+    _In_ const ebpf_ring_buffer_t* ring_buffer,
+    _Outptr_ const ebpf_ring_buffer_producer_page_t** producer_page,
+    _Outptr_ ebpf_ring_buffer_consumer_page_t** consumer_page);
+
 /**
  * @brief Reserve a buffer in the ring buffer. Buffer is valid until either ebpf_ring_buffer_submit,
  * ebpf_ring_buffer_discard, or the end of the current epoch.
@@ -7,9 +7,7 @@
 #include "ebpf_tracelog.h"
 
 #define EBPF_MAX_STATE_ENTRIES 64
-
-// Table to track what state for each thread.
-static ebpf_hash_table_t* _ebpf_state_thread_table = NULL;
+#define EBPF_STATE_THREAD_SLOTS_PER_CPU 4
 
 static int64_t _ebpf_state_next_index;
 
@@ -22,6 +20,24 @@ typedef struct _ebpf_state_entry
 static _Writable_elements_(_ebpf_state_cpu_table_size) ebpf_state_entry_t* _ebpf_state_cpu_table = NULL;
 static uint32_t _ebpf_state_cpu_table_size = 0;
 
+// State of a thread that runs below DISPATCH_LEVEL. Only the owning thread reads or writes the entry, and the entry
+// is released as soon as the thread clears its last non-zero value, so state of threads that exit is not retained.
+typedef struct _ebpf_state_thread_entry
+{
+    volatile int64_t thread_id; ///< Owning thread or 0 if the slot is free.
+    uint32_t in_use_count;      ///< Number of non-zero values in the entry.
+    ebpf_state_entry_t entry;
+} ebpf_state_thread_entry_t;
+
+// Thread slots indexed by a hash of the thread id. A thread claims its home slot while it holds state, so finding
+// the state of the current thread is a single compare.
+static _Writable_elements_(_ebpf_state_thread_slot_count) ebpf_state_thread_entry_t* _ebpf_state_thread_slots = NULL;
+static uint32_t _ebpf_state_thread_slot_count = 0;
+
+// Table to track state for threads whose home slot is held by another thread.
+static ebpf_hash_table_t* _ebpf_state_thread_table = NULL;
+static volatile int64_t _ebpf_state_thread_table_count = 0;
+
 _Must_inspect_result_ ebpf_result_t
 ebpf_state_initiate()
 {
@@ -42,10 +58,26 @@ ebpf_state_initiate()
         goto Error;
     }
 
+    // Round the slot count up to a power of two so the home slot is found with a mask.
+    _ebpf_state_thread_slot_count = 1;
+    while (_ebpf_state_thread_slot_count < _ebpf_state_cpu_table_size * EBPF_STATE_THREAD_SLOTS_PER_CPU) {
+        _ebpf_state_thread_slot_count <<= 1;
+    }
+
+    _ebpf_state_thread_slots = cxplat_allocate(
+        CXPLAT_POOL_FLAG_NON_PAGED | CXPLAT_POOL_FLAG_CACHE_ALIGNED,
+        sizeof(ebpf_state_thread_entry_t) * _ebpf_state_thread_slot_count,
+        EBPF_POOL_TAG_STATE);
+    if (!_ebpf_state_thread_slots) {
+        return_value = EBPF_NO_MEMORY;
+        goto Error;
+    }
+
     const ebpf_hash_table_creation_options_t options = {
         .key_size = sizeof(uint64_t),
-        .value_size = sizeof(ebpf_state_entry_t),
+        .value_size = sizeof(ebpf_state_thread_entry_t),
         .minimum_bucket_count = ebpf_get_cpu_count(),
+        .maximum_bucket_count = EBPF_HASH_TABLE_MAXIMUM_BUCKET_COUNT,
     };
 
     return_value = ebpf_hash_table_create(&_ebpf_state_thread_table, &options);
@@ -70,6 +102,11 @@ ebpf_state_terminate()
     EBPF_LOG_ENTRY();
     ebpf_hash_table_destroy(_ebpf_state_thread_table);
     _ebpf_state_thread_table = NULL;
+    _ebpf_state_thread_table_count = 0;
+    cxplat_free(
+        _ebpf_state_thread_slots, CXPLAT_POOL_FLAG_NON_PAGED | CXPLAT_POOL_FLAG_CACHE_ALIGNED, EBPF_POOL_TAG_STATE);
+    _ebpf_state_thread_slots = NULL;
+    _ebpf_state_thread_slot_count = 0;
     cxplat_free(
         _ebpf_state_cpu_table, CXPLAT_POOL_FLAG_NON_PAGED | CXPLAT_POOL_FLAG_CACHE_ALIGNED, EBPF_POOL_TAG_STATE);
     _ebpf_state_cpu_table = NULL;
@@ -88,73 +125,150 @@ ebpf_state_allocate_index(_Out_ size_t* new_index)
     EBPF_RETURN_RESULT(EBPF_SUCCESS);
 }
 
+/**
+ * @brief Get the home slot of a thread.
+ *
+ * @param[in] thread_id Thread to get the slot of.
+ * @return Pointer to the slot.
+ */
+static inline ebpf_state_thread_entry_t*
+_ebpf_state_get_thread_slot(uint64_t thread_id)
+{
+    // Thread ids are multiples of 4, so drop the low bits before mixing.
+    uint64_t hash = (thread_id >> 2) * 0x9E3779B97F4A7C15ull;
+    return _ebpf_state_thread_slots + ((uint32_t)(hash >> 32) & (_ebpf_state_thread_slot_count - 1));
+}
+
+/**
+ * @brief Find the state of the current thread.
+ *
+ * @param[in] thread_id Current thread.
+ * @param[in] create Claim a slot or insert an entry if the thread has no state.
+ * @param[out] entry Pointer to the state of the thread, or NULL if the thread has no state and create is false.
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_NO_MEMORY Unable to allocate resources for this operation.
+ */
 static _Must_inspect_result_ ebpf_result_t
-_ebpf_state_get_entry(
-    _In_ const ebpf_execution_context_state_t* execution_context_state, _Outptr_ ebpf_state_entry_t** entry)
+_ebpf_state_find_thread_entry(
+    uint64_t thread_id, bool create, _Outptr_result_maybenull_ ebpf_state_thread_entry_t** entry)
 {
-    // High frequency call, don't log entry/exit.
-    ebpf_state_entry_t* local_entry = NULL;
+    ebpf_result_t return_value;
+    ebpf_state_thread_entry_t* slot = _ebpf_state_get_thread_slot(thread_id);
 
-    if (execution_context_state->current_irql < DISPATCH_LEVEL) {
-        ebpf_result_t return_value;
-        uint64_t current_thread_id = execution_context_state->id.thread;
+    // Common case: the thread holds its home slot. Only the owner writes its id into a slot, so a match is stable.
+    if ((uint64_t)slot->thread_id == thread_id) {
+        *entry = slot;
+        return EBPF_SUCCESS;
+    }
 
-        return_value =
-            ebpf_hash_table_find(_ebpf_state_thread_table, (const uint8_t*)&current_thread_id, (uint8_t**)&local_entry);
+    // The thread may hold state in the overflow table from a time when its home slot was taken.
+    if (_ebpf_state_thread_table_count != 0) {
+        return_value = ebpf_hash_table_find(_ebpf_state_thread_table, (const uint8_t*)&thread_id, (uint8_t**)entry);
+        if (return_value == EBPF_SUCCESS) {
+            return EBPF_SUCCESS;
+        }
+    }
 
-        if (return_value == EBPF_KEY_NOT_FOUND) {
-            ebpf_state_entry_t new_entry = {0};
+    *entry = NULL;
+    if (!create) {
+        return EBPF_SUCCESS;
+    }
 
-            return_value = ebpf_hash_table_update(
-                _ebpf_state_thread_table,
-                (const uint8_t*)&current_thread_id,
-                (const uint8_t*)&new_entry,
-                EBPF_HASH_TABLE_OPERATION_INSERT);
+    if (ebpf_interlocked_compare_exchange_int64(&slot->thread_id, (int64_t)thread_id, 0) == 0) {
+        *entry = slot;
+        return EBPF_SUCCESS;
+    }
 
-            if (return_value != EBPF_SUCCESS) {
-                return return_value;
-            }
+    // The home slot is held by another thread.
+    ebpf_state_thread_entry_t new_entry = {0};
+    new_entry.thread_id = (int64_t)thread_id;
+    return_value = ebpf_hash_table_update(
+        _ebpf_state_thread_table,
+        (const uint8_t*)&thread_id,
+        (const uint8_t*)&new_entry,
+        EBPF_HASH_TABLE_OPERATION_INSERT);
+    if (return_value != EBPF_SUCCESS) {
+        return return_value;
+    }
+    ebpf_interlocked_increment_int64(&_ebpf_state_thread_table_count);
 
-            ebpf_assert_success(ebpf_hash_table_find(
-                _ebpf_state_thread_table, (const uint8_t*)&current_thread_id, (uint8_t**)&local_entry));
-        }
+    ebpf_assert_success(ebpf_hash_table_find(_ebpf_state_thread_table, (const uint8_t*)&thread_id, (uint8_t**)entry));
+    return EBPF_SUCCESS;
+}
+
+/**
+ * @brief Release the state of a thread once it holds no values.
+ *
+ * @param[in, out] entry State of the thread.
+ */
+static void
+_ebpf_state_release_thread_entry(_Inout_ ebpf_state_thread_entry_t* entry)
+{
+    uint64_t thread_id = (uint64_t)entry->thread_id;
+    if (entry == _ebpf_state_get_thread_slot(thread_id)) {
+        ebpf_interlocked_compare_exchange_int64(&entry->thread_id, 0, (int64_t)thread_id);
     } else {
-        uint32_t current_cpu = execution_context_state->id.cpu;
-        if (current_cpu >= _ebpf_state_cpu_table_size) {
-            return EBPF_OPERATION_NOT_SUPPORTED;
-        }
-        local_entry = _ebpf_state_cpu_table + current_cpu;
+        ebpf_assert_success(ebpf_hash_table_delete(_ebpf_state_thread_table, (const uint8_t*)&thread_id));
+        ebpf_interlocked_decrement_int64(&_ebpf_state_thread_table_count);
     }
-    *entry = local_entry;
-    return EBPF_SUCCESS;
 }
 
 _Must_inspect_result_ ebpf_result_t
 ebpf_state_store(size_t index, uintptr_t value, _In_ const ebpf_execution_context_state_t* execution_context_state)
 {
     // High frequency call, don't log entry/exit.
-    ebpf_state_entry_t* entry = NULL;
     ebpf_result_t return_value;
 
-    return_value = _ebpf_state_get_entry(execution_context_state, &entry);
-    if (return_value == EBPF_SUCCESS) {
-        entry->state[index] = value;
+    if (execution_context_state->current_irql >= DISPATCH_LEVEL) {
+        uint32_t current_cpu = execution_context_state->id.cpu;
+        if (current_cpu >= _ebpf_state_cpu_table_size) {
+            return EBPF_OPERATION_NOT_SUPPORTED;
+        }
+        _ebpf_state_cpu_table[current_cpu].state[index] = value;
+        return EBPF_SUCCESS;
+    }
+
+    ebpf_state_thread_entry_t* entry;
+    return_value = _ebpf_state_find_thread_entry(execution_context_state->id.thread, value != 0, &entry);
+    if (return_value != EBPF_SUCCESS || entry == NULL) {
+        return return_value;
+    }
+
+    if (entry->entry.state[index] == 0 && value != 0) {
+        entry->in_use_count++;
+    } else if (entry->entry.state[index] != 0 && value == 0) {
+        entry->in_use_count--;
+    }
+    entry->entry.state[index] = value;
+
+    if (entry->in_use_count == 0) {
+        _ebpf_state_release_thread_entry(entry);
     }
-    return return_value;
+    return EBPF_SUCCESS;
 }
 
 _Must_inspect_result_ ebpf_result_t
 ebpf_state_load(size_t index, _Out_ uintptr_t* value)
 {
     // High frequency call, don't log entry/exit.
-    ebpf_state_entry_t* entry = NULL;
     ebpf_result_t return_value;
     ebpf_execution_context_state_t execution_context_state = {0};
     ebpf_get_execution_context_state(&execution_context_state);
 
-    return_value = _ebpf_state_get_entry(&execution_context_state, &entry);
-    if (return_value == EBPF_SUCCESS) {
-        *value = entry->state[index];
+    if (execution_context_state.current_irql >= DISPATCH_LEVEL) {
+        uint32_t current_cpu = execution_context_state.id.cpu;
+        if (current_cpu >= _ebpf_state_cpu_table_size) {
+            return EBPF_OPERATION_NOT_SUPPORTED;
+        }
+        *value = _ebpf_state_cpu_table[current_cpu].state[index];
+        return EBPF_SUCCESS;
+    }
+
+    ebpf_state_thread_entry_t* entry;
+    return_value = _ebpf_state_find_thread_entry(execution_context_state.id.thread, false, &entry);
+    if (return_value != EBPF_SUCCESS) {
+        return return_value;
     }
-    return return_value;
+    *value = (entry != NULL) ? entry->entry.state[index] : 0;
+    return EBPF_SUCCESS;
 }
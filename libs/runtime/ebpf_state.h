@@ -39,7 +39,9 @@ extern "C"
     ebpf_state_allocate_index(_Out_ size_t* new_index);
 
     /**
-     * @brief Store a value in the state tracker.
+     * @brief Store a value in the state tracker. Below DISPATCH_LEVEL the
+     * state of a thread is released once all of its values are zero, so
+     * callers clear the values they store when they are done with them.
      *
      * @param[in] index Assigned for storing state.
      * @param[in] value Value to be stored.
@@ -52,7 +54,8 @@ extern "C"
     ebpf_state_store(size_t index, uintptr_t value, _In_ const ebpf_execution_context_state_t* execution_context_state);
 
     /**
-     * @brief Load a value in the state tracker.
+     * @brief Load a value in the state tracker. Values that were never
+     * stored by the current thread or CPU load as zero.
      *
      * @param[in] index Assigned for storing state.
      * @param[out] value Value to be loaded.
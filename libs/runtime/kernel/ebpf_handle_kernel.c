@@ -10,6 +10,8 @@
 extern _Ret_notnull_ DEVICE_OBJECT*
 ebpf_driver_get_device_object();
 
+static ebpf_handle_cleanup_t _ebpf_handle_cleanup_function = NULL;
+
 _Must_inspect_result_ ebpf_result_t
 ebpf_handle_table_initiate()
 {
@@ -101,6 +103,51 @@ ebpf_handle_close(ebpf_handle_t handle)
     }
 }
 
+void
+ebpf_handle_set_cleanup_callback(_In_opt_ ebpf_handle_cleanup_t cleanup_function)
+{
+    _ebpf_handle_cleanup_function = cleanup_function;
+}
+
+void
+ebpf_handle_cleanup(_Inout_opt_ ebpf_base_object_t* object, _In_ const void* instance)
+{
+    ebpf_handle_cleanup_t cleanup_function = _ebpf_handle_cleanup_function;
+    if (object && cleanup_function) {
+        cleanup_function(object, instance);
+    }
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_handle_get_instance(ebpf_handle_t handle, _Outptr_ const void** instance)
+{
+    ebpf_result_t return_value;
+    NTSTATUS status;
+    FILE_OBJECT* file_object = NULL;
+
+    status = ObReferenceObjectByHandle((HANDLE)handle, 0, NULL, UserMode, &file_object, NULL);
+    if (!NT_SUCCESS(status)) {
+        EBPF_LOG_NTSTATUS_API_FAILURE(EBPF_TRACELOG_KEYWORD_BASE, ObReferenceObjectByHandle, status);
+        return_value = EBPF_INVALID_OBJECT;
+        goto Done;
+    }
+
+    if (file_object->DeviceObject != ebpf_driver_get_device_object() || file_object->FsContext2 == NULL) {
+        return_value = EBPF_INVALID_OBJECT;
+        goto Done;
+    }
+
+    // Each handle refers to its own file object, which is cleaned up when its last handle is closed.
+    *instance = file_object;
+    return_value = EBPF_SUCCESS;
+
+Done:
+    if (file_object) {
+        ObDereferenceObject(file_object);
+    }
+    return return_value;
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL) ebpf_result_t ebpf_reference_base_object_by_handle(
     ebpf_handle_t handle,
     _In_opt_ ebpf_compare_object_t compare_function,
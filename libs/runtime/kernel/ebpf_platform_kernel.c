@@ -15,6 +15,19 @@ struct _ebpf_ring_descriptor
 };
 typedef struct _ebpf_ring_descriptor ebpf_ring_descriptor_t;
 
+struct _ebpf_locked_user_buffer
+{
+    MDL* memory_descriptor_list;
+    void* system_address;
+};
+
+struct _ebpf_user_mapping
+{
+    MDL* memory_descriptor_list;
+    void* address;
+    PEPROCESS process;
+};
+
 static KDEFERRED_ROUTINE _ebpf_deferred_routine;
 static KDEFERRED_ROUTINE _ebpf_timer_routine;
 
@@ -135,6 +148,203 @@ ebpf_ring_map_readonly_user(_In_ const ebpf_ring_descriptor_t* ring)
         return NULL;
     }
 }
+_Ret_maybenull_ void*
+ebpf_map_memory_user(_In_ MDL* memory_descriptor, ebpf_page_protection_t protection)
+{
+    unsigned long priority = NormalPagePriority | MdlMappingNoExecute;
+    switch (protection) {
+    case EBPF_PAGE_PROTECT_READ_ONLY:
+        priority |= MdlMappingNoWrite;
+        break;
+    case EBPF_PAGE_PROTECT_READ_WRITE:
+        break;
+    default:
+        return NULL;
+    }
+
+    __try {
+        return MmMapLockedPagesSpecifyCache(memory_descriptor, UserMode, MmCached, NULL, FALSE, priority);
+    } __except (EXCEPTION_EXECUTE_HANDLER) {
+        EBPF_LOG_NTSTATUS_API_FAILURE(EBPF_TRACELOG_KEYWORD_BASE, MmMapLockedPagesSpecifyCache, STATUS_NO_MEMORY);
+        return NULL;
+    }
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_create_user_mapping(
+    _In_ MDL* memory_descriptor, ebpf_page_protection_t protection, _Outptr_ ebpf_user_mapping_t** mapping)
+{
+    EBPF_LOG_ENTRY();
+    ebpf_result_t result;
+    ebpf_user_mapping_t* local_mapping = NULL;
+
+    if (protection != EBPF_PAGE_PROTECT_READ_ONLY && protection != EBPF_PAGE_PROTECT_READ_WRITE) {
+        result = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
+    local_mapping = ebpf_allocate(sizeof(ebpf_user_mapping_t));
+    if (!local_mapping) {
+        result = EBPF_NO_MEMORY;
+        goto Done;
+    }
+
+    local_mapping->address = ebpf_map_memory_user(memory_descriptor, protection);
+    if (!local_mapping->address) {
+        result = EBPF_NO_MEMORY;
+        goto Done;
+    }
+
+    // Hold the process so the mapping can be removed from its address space later.
+    local_mapping->memory_descriptor_list = memory_descriptor;
+    local_mapping->process = PsGetCurrentProcess();
+    ObReferenceObject(local_mapping->process);
+
+    *mapping = local_mapping;
+    local_mapping = NULL;
+    result = EBPF_SUCCESS;
+
+Done:
+    ebpf_free(local_mapping);
+    EBPF_RETURN_RESULT(result);
+}
+
+void
+ebpf_delete_user_mapping(_Frees_ptr_opt_ ebpf_user_mapping_t* mapping)
+{
+    EBPF_LOG_ENTRY();
+    KAPC_STATE apc_state;
+    bool attached = false;
+
+    if (!mapping) {
+        EBPF_RETURN_VOID();
+    }
+
+    // User mappings can only be removed from the context of the process that owns them.
+    if (PsGetCurrentProcess() != mapping->process) {
+        KeStackAttachProcess(mapping->process, &apc_state);
+        attached = true;
+    }
+
+    MmUnmapLockedPages(mapping->address, mapping->memory_descriptor_list);
+
+    if (attached) {
+        KeUnstackDetachProcess(&apc_state);
+    }
+
+    ObDereferenceObject(mapping->process);
+    ebpf_free(mapping);
+    EBPF_RETURN_VOID();
+}
+
+_Ret_notnull_ void*
+ebpf_user_mapping_get_address(_In_ const ebpf_user_mapping_t* mapping)
+{
+    return mapping->address;
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_lock_user_buffer(
+    uint64_t address, size_t length, ebpf_page_protection_t protection, _Outptr_ ebpf_locked_user_buffer_t** buffer)
+{
+    EBPF_LOG_ENTRY();
+    ebpf_result_t result;
+    NTSTATUS status = STATUS_SUCCESS;
+    LOCK_OPERATION operation;
+    ebpf_locked_user_buffer_t* locked_buffer = NULL;
+    bool pages_locked = false;
+
+    switch (protection) {
+    case EBPF_PAGE_PROTECT_READ_ONLY:
+        operation = IoReadAccess;
+        break;
+    case EBPF_PAGE_PROTECT_READ_WRITE:
+        operation = IoWriteAccess;
+        break;
+    default:
+        result = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
+    // The length of an MDL is 32 bits.
+    if (length == 0 || length > MAXUINT32) {
+        result = EBPF_INVALID_ARGUMENT;
+        goto Done;
+    }
+
+    locked_buffer = ebpf_allocate(sizeof(ebpf_locked_user_buffer_t));
+    if (!locked_buffer) {
+        result = EBPF_NO_MEMORY;
+        goto Done;
+    }
+
+    locked_buffer->memory_descriptor_list =
+        IoAllocateMdl((void*)(uintptr_t)address, (unsigned long)length, FALSE, FALSE, NULL);
+    if (!locked_buffer->memory_descriptor_list) {
+        EBPF_LOG_NTSTATUS_API_FAILURE(EBPF_TRACELOG_KEYWORD_BASE, IoAllocateMdl, STATUS_NO_MEMORY);
+        result = EBPF_NO_MEMORY;
+        goto Done;
+    }
+
+    __try {
+        MmProbeAndLockPages(locked_buffer->memory_descriptor_list, UserMode, operation);
+    } __except (EXCEPTION_EXECUTE_HANDLER) {
+        status = GetExceptionCode();
+    }
+    if (!NT_SUCCESS(status)) {
+        EBPF_LOG_NTSTATUS_API_FAILURE(EBPF_TRACELOG_KEYWORD_BASE, MmProbeAndLockPages, status);
+        result = EBPF_INVALID_POINTER;
+        goto Done;
+    }
+    pages_locked = true;
+
+    locked_buffer->system_address = MmGetSystemAddressForMdlSafe(
+        locked_buffer->memory_descriptor_list, NormalPagePriority | MdlMappingNoExecute);
+    if (!locked_buffer->system_address) {
+        EBPF_LOG_NTSTATUS_API_FAILURE(EBPF_TRACELOG_KEYWORD_BASE, MmGetSystemAddressForMdlSafe, STATUS_NO_MEMORY);
+        result = EBPF_NO_MEMORY;
+        goto Done;
+    }
+
+    *buffer = locked_buffer;
+    locked_buffer = NULL;
+    result = EBPF_SUCCESS;
+
+Done:
+    if (locked_buffer) {
+        if (pages_locked) {
+            MmUnlockPages(locked_buffer->memory_descriptor_list);
+        }
+        if (locked_buffer->memory_descriptor_list) {
+            IoFreeMdl(locked_buffer->memory_descriptor_list);
+        }
+        ebpf_free(locked_buffer);
+    }
+
+    EBPF_RETURN_RESULT(result);
+}
+
+void
+ebpf_unlock_user_buffer(_Frees_ptr_opt_ ebpf_locked_user_buffer_t* buffer)
+{
+    EBPF_LOG_ENTRY();
+    if (!buffer) {
+        EBPF_RETURN_VOID();
+    }
+
+    // Unlocking the pages also releases the system address space mapping.
+    MmUnlockPages(buffer->memory_descriptor_list);
+    IoFreeMdl(buffer->memory_descriptor_list);
+    ebpf_free(buffer);
+    EBPF_RETURN_VOID();
+}
+
+_Ret_notnull_ void*
+ebpf_locked_user_buffer_get_address(_In_ const ebpf_locked_user_buffer_t* buffer)
+{
+    return buffer->system_address;
+}
+
 // There isn't an official API to query this information from kernel.
 // Use NtQuerySystemInformation with struct + header from winternl.h.
 
@@ -9,6 +9,7 @@
 #include "ebpf_bitmap.h"
 #include "ebpf_epoch.h"
 #include "ebpf_hash_table.h"
+#include "ebpf_lpm_trie.h"
 #include "ebpf_nethooks.h"
 #include "ebpf_pinning_table.h"
 #include "ebpf_platform.h"
@@ -24,6 +25,7 @@
 #include <winsock2.h>
 #include <Windows.h>
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
 #include <complex>
@@ -550,6 +552,552 @@ TEST_CASE("epoch_test_two_threads", "[platform]")
     thread_2.join();
 }
 
+TEST_CASE("epoch_test_pool", "[platform]")
+{
+    _test_helper test_helper;
+    test_helper.initialize();
+
+    ebpf_epoch_pool_t* pool = nullptr;
+    REQUIRE(ebpf_epoch_pool_create(&pool, 16, 2, EBPF_POOL_TAG_DEFAULT) == EBPF_SUCCESS);
+
+    ebpf_epoch_scope_t epoch_scope;
+    uint8_t* block_1 = reinterpret_cast<uint8_t*>(ebpf_epoch_pool_allocate(pool));
+    uint8_t* block_2 = reinterpret_cast<uint8_t*>(ebpf_epoch_pool_allocate(pool));
+    REQUIRE(block_1 != nullptr);
+    REQUIRE(block_2 != nullptr);
+    REQUIRE(block_1 != block_2);
+
+    // The pool is exhausted.
+    REQUIRE(ebpf_epoch_pool_allocate(pool) == nullptr);
+
+    memset(block_1, 0xcc, 16);
+    ebpf_epoch_free(block_1);
+
+    // The freed block isn't reused until the epoch ends.
+    REQUIRE(ebpf_epoch_pool_allocate(pool) == nullptr);
+    epoch_scope.exit();
+    ebpf_epoch_synchronize();
+
+    // The block is back in the pool and is zeroed on reuse.
+    uint8_t* block_3 = reinterpret_cast<uint8_t*>(ebpf_epoch_pool_allocate(pool));
+    REQUIRE(block_3 == block_1);
+    for (size_t index = 0; index < 16; index++) {
+        REQUIRE(block_3[index] == 0);
+    }
+
+    ebpf_epoch_free(block_2);
+    ebpf_epoch_free(block_3);
+
+    // The pool outlives the blocks that are still waiting for their epoch to end.
+    ebpf_epoch_pool_destroy(pool);
+    ebpf_epoch_synchronize();
+}
+
+TEST_CASE("epoch_test_slab_cache", "[platform]")
+{
+    _test_helper test_helper;
+    test_helper.initialize();
+
+    // Stay on one CPU so that the freed block is cached where the next allocation looks for it.
+    uintptr_t old_thread_mask = SetThreadAffinityMask(GetCurrentThread(), 1);
+    uint64_t hits_before;
+    uint64_t misses_before;
+    ebpf_epoch_get_slab_cache_statistics(&hits_before, &misses_before);
+
+    ebpf_epoch_scope_t epoch_scope;
+    uint8_t* memory = reinterpret_cast<uint8_t*>(ebpf_epoch_allocate(16));
+    REQUIRE(memory != nullptr);
+    memset(memory, 0xcc, 16);
+    ebpf_epoch_free(memory);
+    epoch_scope.exit();
+    ebpf_epoch_synchronize();
+
+    // The block is reused from the slab cache once its epoch has ended and is zeroed on reuse.
+    uint8_t* reused_memory = reinterpret_cast<uint8_t*>(ebpf_epoch_allocate(20));
+    REQUIRE(reused_memory == memory);
+    for (size_t index = 0; index < 20; index++) {
+        REQUIRE(reused_memory[index] == 0);
+    }
+    uint64_t hits;
+    uint64_t misses;
+    ebpf_epoch_get_slab_cache_statistics(&hits, &misses);
+    REQUIRE(hits == hits_before + 1);
+    REQUIRE(misses == misses_before + 1);
+
+    // Allocations larger than the largest size class are never cached.
+    void* large_memory = ebpf_epoch_allocate(64 * 1024);
+    REQUIRE(large_memory != nullptr);
+    ebpf_epoch_get_slab_cache_statistics(&hits, &misses);
+    REQUIRE(misses == misses_before + 1);
+
+    // Allocations with a tag other than the default are never cached, so their blocks keep the right tag.
+    void* tagged_memory = ebpf_epoch_allocate_with_tag(16, EBPF_POOL_TAG_MAP);
+    REQUIRE(tagged_memory != nullptr);
+    REQUIRE(tagged_memory != reused_memory);
+    ebpf_epoch_get_slab_cache_statistics(&hits, &misses);
+    REQUIRE(hits == hits_before + 1);
+    REQUIRE(misses == misses_before + 1);
+
+    ebpf_epoch_free(tagged_memory);
+    ebpf_epoch_free(reused_memory);
+    ebpf_epoch_free(large_memory);
+    ebpf_epoch_synchronize();
+    SetThreadAffinityMask(GetCurrentThread(), old_thread_mask);
+}
+
+TEST_CASE("hash_table_test_preallocated", "[platform]")
+{
+    _test_helper test_helper;
+    test_helper.initialize();
+
+    // Use more buckets than entries, so that every bucket fits in a block of the preallocated bucket pool.
+    const size_t entry_count = 16;
+    ebpf_hash_table_t* table = nullptr;
+    ebpf_hash_table_creation_options_t options = {
+        .key_size = sizeof(uint32_t),
+        .value_size = sizeof(uint64_t),
+        .minimum_bucket_count = entry_count * 4,
+        .max_entries = entry_count,
+        .preallocated_entries = entry_count,
+    };
+    REQUIRE(ebpf_hash_table_create(&table, &options) == EBPF_SUCCESS);
+
+    // Preallocation requires the default allocator.
+    ebpf_hash_table_t* custom_allocator_table = nullptr;
+    ebpf_hash_table_creation_options_t custom_allocator_options = options;
+    custom_allocator_options.allocate = ebpf_allocate;
+    custom_allocator_options.free = ebpf_free;
+    REQUIRE(ebpf_hash_table_create(&custom_allocator_table, &custom_allocator_options) == EBPF_INVALID_ARGUMENT);
+
+    auto update = [&](uint32_t key, uint64_t value, ebpf_hash_table_operations_t operation) {
+        return ebpf_hash_table_update(
+            table, reinterpret_cast<const uint8_t*>(&key), reinterpret_cast<const uint8_t*>(&value), operation);
+    };
+
+    // Allocations that don't come from the pools go through the epoch allocator and show up in its statistics.
+    uint64_t hits_before;
+    uint64_t misses_before;
+    ebpf_epoch_get_slab_cache_statistics(&hits_before, &misses_before);
+
+    // Fill the table, then repeatedly update, delete and reinsert its entries. Replaced storage returns to the pools
+    // once its epoch ends, and the pools hold one replacement per entry in the meantime.
+    for (uint32_t iteration = 0; iteration < 4; iteration++) {
+        ebpf_epoch_scope_t epoch_scope;
+        for (uint32_t key = 0; key < entry_count; key++) {
+            REQUIRE(update(key, static_cast<uint64_t>(key) + iteration, EBPF_HASH_TABLE_OPERATION_ANY) == EBPF_SUCCESS);
+        }
+        REQUIRE(ebpf_hash_table_key_count(table) == entry_count);
+        REQUIRE(update(entry_count, 0, EBPF_HASH_TABLE_OPERATION_ANY) == EBPF_OUT_OF_SPACE);
+        for (uint32_t key = 0; key < entry_count; key++) {
+            uint64_t* value = nullptr;
+            REQUIRE(
+                ebpf_hash_table_find(
+                    table, reinterpret_cast<const uint8_t*>(&key), reinterpret_cast<uint8_t**>(&value)) ==
+                EBPF_SUCCESS);
+            REQUIRE(*value == static_cast<uint64_t>(key) + iteration);
+        }
+        epoch_scope.exit();
+        ebpf_epoch_synchronize();
+
+        epoch_scope.enter();
+        for (uint32_t key = 0; key < entry_count / 2; key++) {
+            REQUIRE(ebpf_hash_table_delete(table, reinterpret_cast<const uint8_t*>(&key)) == EBPF_SUCCESS);
+            REQUIRE(update(key, key, EBPF_HASH_TABLE_OPERATION_INSERT) == EBPF_SUCCESS);
+        }
+        epoch_scope.exit();
+        ebpf_epoch_synchronize();
+    }
+
+    // Updates of existing keys overwrite their values in place, so many more than max_entries updates within one
+    // epoch don't exhaust the pools.
+    {
+        ebpf_epoch_scope_t epoch_scope;
+        const uint32_t update_rounds = 8;
+        for (uint32_t iteration = 0; iteration < update_rounds; iteration++) {
+            for (uint32_t key = 0; key < entry_count; key++) {
+                REQUIRE(update(key, iteration, EBPF_HASH_TABLE_OPERATION_ANY) == EBPF_SUCCESS);
+                REQUIRE(update(key, iteration + 1, EBPF_HASH_TABLE_OPERATION_REPLACE) == EBPF_SUCCESS);
+            }
+        }
+        for (uint32_t key = 0; key < entry_count; key++) {
+            uint64_t* value = nullptr;
+            REQUIRE(
+                ebpf_hash_table_find(
+                    table, reinterpret_cast<const uint8_t*>(&key), reinterpret_cast<uint8_t**>(&value)) ==
+                EBPF_SUCCESS);
+            REQUIRE(*value == update_rounds);
+        }
+        REQUIRE(update(entry_count, 0, EBPF_HASH_TABLE_OPERATION_REPLACE) == EBPF_KEY_NOT_FOUND);
+        REQUIRE(ebpf_hash_table_key_count(table) == entry_count);
+        epoch_scope.exit();
+    }
+
+    // A full preallocated table never calls the allocator.
+    uint64_t hits;
+    uint64_t misses;
+    ebpf_epoch_get_slab_cache_statistics(&hits, &misses);
+    REQUIRE(hits == hits_before);
+    REQUIRE(misses == misses_before);
+    ebpf_hash_table_destroy(table);
+
+    // Without an entry limit, inserts fail once the pools are exhausted rather than falling back to the allocator.
+    options.max_entries = EBPF_HASH_TABLE_NO_LIMIT;
+    REQUIRE(ebpf_hash_table_create(&table, &options) == EBPF_SUCCESS);
+    {
+        ebpf_epoch_scope_t epoch_scope;
+        ebpf_result_t result = EBPF_SUCCESS;
+        uint32_t key = 0;
+        for (; result == EBPF_SUCCESS && key < entry_count * 4; key++) {
+            result = update(key, key, EBPF_HASH_TABLE_OPERATION_ANY);
+        }
+        REQUIRE(result == EBPF_NO_MEMORY);
+        REQUIRE(key > entry_count);
+        epoch_scope.exit();
+    }
+    ebpf_epoch_get_slab_cache_statistics(&hits, &misses);
+    REQUIRE(hits == hits_before);
+    REQUIRE(misses == misses_before);
+
+    ebpf_hash_table_destroy(table);
+}
+
+TEST_CASE("hash_table_test_key_sizes", "[platform]")
+{
+    _test_helper test_helper;
+    test_helper.initialize();
+
+    // Cover the integer compare paths for 4, 8, and 16 byte keys and the memcmp path for other sizes. A single bucket
+    // puts every entry in the same bucket, and keys that differ only in the last byte exercise every word of the key.
+    const uint8_t entry_count = 64;
+    for (size_t key_size : {sizeof(uint32_t), sizeof(uint64_t), 3 * sizeof(uint32_t), 2 * sizeof(uint64_t)}) {
+        ebpf_hash_table_t* table = nullptr;
+        const ebpf_hash_table_creation_options_t options = {
+            .key_size = key_size,
+            .value_size = sizeof(uint64_t),
+            .minimum_bucket_count = 1,
+        };
+        REQUIRE(ebpf_hash_table_create(&table, &options) == EBPF_SUCCESS);
+
+        ebpf_epoch_scope_t epoch_scope;
+        std::vector<uint8_t> key(key_size, 0xAA);
+        for (uint8_t index = 0; index < entry_count; index++) {
+            uint64_t value = index;
+            key.back() = index;
+            REQUIRE(
+                ebpf_hash_table_update(
+                    table, key.data(), reinterpret_cast<const uint8_t*>(&value), EBPF_HASH_TABLE_OPERATION_INSERT) ==
+                EBPF_SUCCESS);
+        }
+        for (uint8_t index = 0; index < entry_count; index++) {
+            uint64_t* value = nullptr;
+            key.back() = index;
+            REQUIRE(ebpf_hash_table_find(table, key.data(), reinterpret_cast<uint8_t**>(&value)) == EBPF_SUCCESS);
+            REQUIRE(*value == index);
+        }
+
+        // Keys that match every byte but one are not found.
+        uint8_t* missing_value = nullptr;
+        key.back() = entry_count;
+        REQUIRE(ebpf_hash_table_find(table, key.data(), &missing_value) == EBPF_KEY_NOT_FOUND);
+        key.back() = 0;
+        key.front() = 0x55;
+        REQUIRE(ebpf_hash_table_find(table, key.data(), &missing_value) == EBPF_KEY_NOT_FOUND);
+        key.front() = 0xAA;
+
+        // Delete the odd keys and check that only the even keys remain.
+        for (uint8_t index = 1; index < entry_count; index += 2) {
+            key.back() = index;
+            REQUIRE(ebpf_hash_table_delete(table, key.data()) == EBPF_SUCCESS);
+        }
+        REQUIRE(ebpf_hash_table_key_count(table) == entry_count / 2);
+        for (uint8_t index = 0; index < entry_count; index++) {
+            uint64_t* value = nullptr;
+            key.back() = index;
+            ebpf_result_t expected_result = (index % 2) ? EBPF_KEY_NOT_FOUND : EBPF_SUCCESS;
+            REQUIRE(ebpf_hash_table_find(table, key.data(), reinterpret_cast<uint8_t**>(&value)) == expected_result);
+        }
+        epoch_scope.exit();
+
+        ebpf_hash_table_destroy(table);
+    }
+}
+
+TEST_CASE("hash_table_test_resize", "[platform]")
+{
+    _test_helper test_helper;
+    test_helper.initialize();
+
+    const uint32_t entry_count = 4096;
+    ebpf_hash_table_t* table = nullptr;
+    const ebpf_hash_table_creation_options_t options = {
+        .key_size = sizeof(uint32_t),
+        .value_size = sizeof(uint64_t),
+        .minimum_bucket_count = 1,
+        .maximum_bucket_count = entry_count,
+    };
+    REQUIRE(ebpf_hash_table_create(&table, &options) == EBPF_SUCCESS);
+
+    // Resizing requires the default allocator.
+    ebpf_hash_table_t* custom_allocator_table = nullptr;
+    ebpf_hash_table_creation_options_t custom_allocator_options = options;
+    custom_allocator_options.allocate = ebpf_allocate;
+    custom_allocator_options.free = ebpf_free;
+    REQUIRE(ebpf_hash_table_create(&custom_allocator_table, &custom_allocator_options) == EBPF_INVALID_ARGUMENT);
+
+    auto verify_keys = [&](uint32_t key_count) {
+        for (uint32_t key = 0; key < key_count; key++) {
+            uint64_t* value = nullptr;
+            REQUIRE(
+                ebpf_hash_table_find(
+                    table, reinterpret_cast<const uint8_t*>(&key), reinterpret_cast<uint8_t**>(&value)) ==
+                EBPF_SUCCESS);
+            REQUIRE(*value == key);
+        }
+        REQUIRE(ebpf_hash_table_key_count(table) == key_count);
+
+        // Each key is returned exactly once.
+        std::vector<bool> keys_found(key_count);
+        uint32_t key;
+        size_t keys_returned = 0;
+        ebpf_result_t result = ebpf_hash_table_next_key(table, nullptr, reinterpret_cast<uint8_t*>(&key));
+        while (result == EBPF_SUCCESS) {
+            REQUIRE(key < key_count);
+            REQUIRE(!keys_found[key]);
+            keys_found[key] = true;
+            keys_returned++;
+            result = ebpf_hash_table_next_key(
+                table, reinterpret_cast<const uint8_t*>(&key), reinterpret_cast<uint8_t*>(&key));
+        }
+        REQUIRE(result == EBPF_NO_MORE_KEYS);
+        REQUIRE(keys_returned == key_count);
+    };
+
+    ebpf_epoch_scope_t epoch_scope;
+
+    // Grow well past the initial bucket count.
+    for (uint32_t key = 0; key < entry_count; key++) {
+        uint64_t value = key;
+        REQUIRE(
+            ebpf_hash_table_update(
+                table,
+                reinterpret_cast<const uint8_t*>(&key),
+                reinterpret_cast<const uint8_t*>(&value),
+                EBPF_HASH_TABLE_OPERATION_INSERT) == EBPF_SUCCESS);
+    }
+    verify_keys(entry_count);
+
+    // Walk the keys while inserting more, forcing the table to resize mid-walk.
+    uint32_t key;
+    uint32_t next_new_key = entry_count;
+    size_t original_keys_returned = 0;
+    ebpf_result_t result = ebpf_hash_table_next_key(table, nullptr, reinterpret_cast<uint8_t*>(&key));
+    while (result == EBPF_SUCCESS) {
+        if (key < entry_count) {
+            original_keys_returned++;
+        }
+        if (next_new_key < entry_count * 4) {
+            uint64_t value = next_new_key;
+            REQUIRE(
+                ebpf_hash_table_update(
+                    table,
+                    reinterpret_cast<const uint8_t*>(&next_new_key),
+                    reinterpret_cast<const uint8_t*>(&value),
+                    EBPF_HASH_TABLE_OPERATION_INSERT) == EBPF_SUCCESS);
+            next_new_key++;
+        }
+        result =
+            ebpf_hash_table_next_key(table, reinterpret_cast<const uint8_t*>(&key), reinterpret_cast<uint8_t*>(&key));
+    }
+    REQUIRE(result == EBPF_NO_MORE_KEYS);
+    REQUIRE(original_keys_returned == entry_count);
+    verify_keys(next_new_key);
+
+    // Shrink back down.
+    for (uint32_t key_to_delete = 16; key_to_delete < next_new_key; key_to_delete++) {
+        REQUIRE(ebpf_hash_table_delete(table, reinterpret_cast<const uint8_t*>(&key_to_delete)) == EBPF_SUCCESS);
+    }
+    verify_keys(16);
+
+    epoch_scope.exit();
+    ebpf_hash_table_destroy(table);
+}
+
+TEST_CASE("lpm_trie_test", "[platform]")
+{
+    _test_helper test_helper;
+    test_helper.initialize();
+
+    typedef struct _lpm_trie_key
+    {
+        uint32_t prefix_length;
+        uint8_t prefix[4];
+    } lpm_trie_key_t;
+
+    // Keys must hold at least one byte of prefix data.
+    ebpf_lpm_trie_t* trie = nullptr;
+    REQUIRE(ebpf_lpm_trie_create(&trie, sizeof(uint32_t), sizeof(uint64_t)) == EBPF_INVALID_ARGUMENT);
+    REQUIRE(ebpf_lpm_trie_create(&trie, sizeof(lpm_trie_key_t), sizeof(uint64_t)) == EBPF_SUCCESS);
+
+    ebpf_epoch_scope_t epoch_scope;
+
+    // Prefixes in the order a walk returns them.
+    std::vector<lpm_trie_key_t> routes{
+        {0, {0, 0, 0, 0}},
+        {8, {10, 0, 0, 0}},
+        {16, {10, 10, 0, 0}},
+        {16, {192, 168, 0, 0}},
+        {29, {192, 168, 14, 0}},
+        {30, {192, 168, 14, 0}},
+        {31, {192, 168, 14, 0}},
+        {24, {192, 168, 15, 0}},
+        {24, {192, 168, 16, 0}},
+    };
+
+    // Insert out of order to exercise splitting and re-parenting of nodes.
+    for (size_t index = routes.size(); index-- > 0;) {
+        uint64_t value = index;
+        REQUIRE(
+            ebpf_lpm_trie_update(
+                trie,
+                reinterpret_cast<const uint8_t*>(&routes[index]),
+                reinterpret_cast<const uint8_t*>(&value),
+                EBPF_LPM_TRIE_OPERATION_INSERT) == EBPF_SUCCESS);
+    }
+
+    uint64_t value = 0;
+    REQUIRE(
+        ebpf_lpm_trie_update(
+            trie,
+            reinterpret_cast<const uint8_t*>(&routes[1]),
+            reinterpret_cast<const uint8_t*>(&value),
+            EBPF_LPM_TRIE_OPERATION_INSERT) == EBPF_OBJECT_ALREADY_EXISTS);
+    lpm_trie_key_t missing_route = {12, {10, 16, 0, 0}};
+    REQUIRE(
+        ebpf_lpm_trie_update(
+            trie,
+            reinterpret_cast<const uint8_t*>(&missing_route),
+            reinterpret_cast<const uint8_t*>(&value),
+            EBPF_LPM_TRIE_OPERATION_REPLACE) == EBPF_KEY_NOT_FOUND);
+    lpm_trie_key_t invalid_route = {33, {10, 0, 0, 0}};
+    REQUIRE(
+        ebpf_lpm_trie_update(
+            trie,
+            reinterpret_cast<const uint8_t*>(&invalid_route),
+            reinterpret_cast<const uint8_t*>(&value),
+            EBPF_LPM_TRIE_OPERATION_ANY) == EBPF_INVALID_ARGUMENT);
+
+    auto find_route = [&](std::array<uint8_t, 4> address) -> int {
+        lpm_trie_key_t key = {32, {address[0], address[1], address[2], address[3]}};
+        uint64_t* found_value = nullptr;
+        if (ebpf_lpm_trie_find(
+                trie, reinterpret_cast<const uint8_t*>(&key), reinterpret_cast<uint8_t**>(&found_value)) !=
+            EBPF_SUCCESS) {
+            return -1;
+        }
+        return static_cast<int>(*found_value);
+    };
+
+    REQUIRE(find_route({192, 168, 15, 1}) == 7);
+    REQUIRE(find_route({192, 168, 16, 25}) == 8);
+    REQUIRE(find_route({192, 168, 14, 1}) == 6);
+    REQUIRE(find_route({192, 168, 14, 2}) == 5);
+    REQUIRE(find_route({192, 168, 14, 4}) == 4);
+    REQUIRE(find_route({192, 168, 14, 9}) == 3);
+    REQUIRE(find_route({10, 10, 10, 10}) == 2);
+    REQUIRE(find_route({10, 11, 10, 10}) == 1);
+    REQUIRE(find_route({11, 0, 0, 0}) == 0);
+
+    // Walk the trie, deleting each prefix after it is returned.
+    lpm_trie_key_t key;
+    uint64_t* next_value = nullptr;
+    size_t route_index = 0;
+    ebpf_result_t result = ebpf_lpm_trie_next_key_and_value(
+        trie, nullptr, reinterpret_cast<uint8_t*>(&key), reinterpret_cast<uint8_t**>(&next_value));
+    while (result == EBPF_SUCCESS) {
+        REQUIRE(route_index < routes.size());
+        REQUIRE(memcmp(&key, &routes[route_index], sizeof(key)) == 0);
+        REQUIRE(*next_value == route_index);
+        route_index++;
+        if (route_index % 2 == 0) {
+            REQUIRE(ebpf_lpm_trie_delete(trie, reinterpret_cast<const uint8_t*>(&key)) == EBPF_SUCCESS);
+            REQUIRE(ebpf_lpm_trie_delete(trie, reinterpret_cast<const uint8_t*>(&key)) == EBPF_KEY_NOT_FOUND);
+        }
+        result = ebpf_lpm_trie_next_key_and_value(
+            trie,
+            reinterpret_cast<const uint8_t*>(&key),
+            reinterpret_cast<uint8_t*>(&key),
+            reinterpret_cast<uint8_t**>(&next_value));
+    }
+    REQUIRE(result == EBPF_NO_MORE_KEYS);
+    REQUIRE(route_index == routes.size());
+
+    // Lookups fall back to the remaining shorter prefixes.
+    REQUIRE(find_route({192, 168, 15, 1}) == 0);
+    REQUIRE(find_route({192, 168, 16, 25}) == 8);
+    REQUIRE(find_route({192, 168, 14, 1}) == 6);
+    REQUIRE(find_route({192, 168, 14, 2}) == 4);
+    REQUIRE(find_route({10, 10, 10, 10}) == 2);
+    REQUIRE(find_route({10, 11, 10, 10}) == 0);
+
+    // Replacing a value publishes a new copy and leaves the old one intact.
+    uint64_t* original_value = nullptr;
+    REQUIRE(
+        ebpf_lpm_trie_find(
+            trie, reinterpret_cast<const uint8_t*>(&routes[0]), reinterpret_cast<uint8_t**>(&original_value)) ==
+        EBPF_SUCCESS);
+    value = 100;
+    REQUIRE(
+        ebpf_lpm_trie_update(
+            trie,
+            reinterpret_cast<const uint8_t*>(&routes[0]),
+            reinterpret_cast<const uint8_t*>(&value),
+            EBPF_LPM_TRIE_OPERATION_REPLACE) == EBPF_SUCCESS);
+    REQUIRE(*original_value == 0);
+    REQUIRE(find_route({11, 0, 0, 0}) == 100);
+
+    // Bits past the prefix length don't create distinct entries and are cleared in the keys a walk returns.
+    lpm_trie_key_t unmasked_route = {20, {172, 16, 255, 255}};
+    lpm_trie_key_t other_unmasked_route = {20, {172, 16, 243, 7}};
+    value = 200;
+    REQUIRE(
+        ebpf_lpm_trie_update(
+            trie,
+            reinterpret_cast<const uint8_t*>(&unmasked_route),
+            reinterpret_cast<const uint8_t*>(&value),
+            EBPF_LPM_TRIE_OPERATION_INSERT) == EBPF_SUCCESS);
+    REQUIRE(
+        ebpf_lpm_trie_update(
+            trie,
+            reinterpret_cast<const uint8_t*>(&other_unmasked_route),
+            reinterpret_cast<const uint8_t*>(&value),
+            EBPF_LPM_TRIE_OPERATION_INSERT) == EBPF_OBJECT_ALREADY_EXISTS);
+    REQUIRE(find_route({172, 16, 240, 1}) == 200);
+
+    bool found = false;
+    result = ebpf_lpm_trie_next_key_and_value(
+        trie, nullptr, reinterpret_cast<uint8_t*>(&key), reinterpret_cast<uint8_t**>(&next_value));
+    while (result == EBPF_SUCCESS) {
+        if (*next_value == 200) {
+            lpm_trie_key_t masked_route = {20, {172, 16, 240, 0}};
+            REQUIRE(memcmp(&key, &masked_route, sizeof(key)) == 0);
+            found = true;
+        }
+        result = ebpf_lpm_trie_next_key_and_value(
+            trie,
+            reinterpret_cast<const uint8_t*>(&key),
+            reinterpret_cast<uint8_t*>(&key),
+            reinterpret_cast<uint8_t**>(&next_value));
+    }
+    REQUIRE(found);
+
+    REQUIRE(ebpf_lpm_trie_delete(trie, reinterpret_cast<const uint8_t*>(&other_unmasked_route)) == EBPF_SUCCESS);
+    REQUIRE(ebpf_lpm_trie_delete(trie, reinterpret_cast<const uint8_t*>(&unmasked_route)) == EBPF_KEY_NOT_FOUND);
+    REQUIRE(find_route({172, 16, 240, 1}) == 100);
+
+    epoch_scope.exit();
+    ebpf_lpm_trie_destroy(trie);
+}
+
 /**
  * @brief Verify that the stale item worker runs.
  * Epoch free can leave items on a CPU's free list until the next epoch exit.
@@ -906,6 +1454,19 @@ TEST_CASE("state_test", "[state]")
     REQUIRE(ebpf_state_store(allocated_index_1, reinterpret_cast<uintptr_t>(&foo), &state) == EBPF_SUCCESS);
     REQUIRE(ebpf_state_load(allocated_index_1, &retrieved_value) == EBPF_SUCCESS);
     REQUIRE(retrieved_value == reinterpret_cast<uintptr_t>(&foo));
+
+    // Clearing one value keeps the others.
+    REQUIRE(ebpf_state_store(allocated_index_2, reinterpret_cast<uintptr_t>(&foo), &state) == EBPF_SUCCESS);
+    REQUIRE(ebpf_state_store(allocated_index_1, 0, &state) == EBPF_SUCCESS);
+    REQUIRE(ebpf_state_load(allocated_index_2, &retrieved_value) == EBPF_SUCCESS);
+    REQUIRE(retrieved_value == reinterpret_cast<uintptr_t>(&foo));
+
+    // Clearing the last value releases the state of the thread.
+    REQUIRE(ebpf_state_store(allocated_index_2, 0, &state) == EBPF_SUCCESS);
+    REQUIRE(ebpf_state_load(allocated_index_1, &retrieved_value) == EBPF_SUCCESS);
+    REQUIRE(retrieved_value == 0);
+    REQUIRE(ebpf_state_load(allocated_index_2, &retrieved_value) == EBPF_SUCCESS);
+    REQUIRE(retrieved_value == 0);
 }
 
 template <size_t bit_count, bool interlocked>
@@ -1065,6 +1626,61 @@ TEST_CASE("ring_buffer_output", "[platform]")
     ring_buffer = nullptr;
 }
 
+TEST_CASE("ring_buffer_consumer_page", "[platform]")
+{
+    _test_helper test_helper;
+    test_helper.initialize();
+    size_t consumer;
+    size_t producer;
+    ebpf_ring_buffer_t* ring_buffer;
+    const ebpf_ring_buffer_producer_page_t* producer_page;
+    ebpf_ring_buffer_consumer_page_t* consumer_page;
+
+    uint8_t* buffer;
+    std::vector<uint8_t> data(1023);
+    size_t size = 64 * 1024;
+
+    REQUIRE(ebpf_ring_buffer_create(&ring_buffer, size) == EBPF_SUCCESS);
+    REQUIRE(ebpf_ring_buffer_map_buffer(ring_buffer, &buffer) == EBPF_SUCCESS);
+    REQUIRE(ebpf_ring_buffer_map_offsets(ring_buffer, &producer_page, &consumer_page) == EBPF_SUCCESS);
+    REQUIRE(producer_page->producer_offset == 0);
+    REQUIRE(consumer_page->consumer_offset == 0);
+
+    // Fill the ring.
+    while (ebpf_ring_buffer_output(ring_buffer, data.data(), data.size()) == EBPF_SUCCESS) {
+    }
+    ebpf_ring_buffer_query(ring_buffer, &consumer, &producer);
+    REQUIRE(consumer == 0);
+    REQUIRE(producer_page->producer_offset == producer);
+
+    // An offset past the producer is ignored.
+    consumer_page->consumer_offset = producer + 1;
+    REQUIRE(ebpf_ring_buffer_output(ring_buffer, data.data(), data.size()) == EBPF_OUT_OF_SPACE);
+    ebpf_ring_buffer_query(ring_buffer, &consumer, &producer);
+    REQUIRE(consumer == 0);
+
+    // Publish the first record as consumed without returning it.
+    auto record = ebpf_ring_buffer_next_record(buffer, size, consumer, producer);
+    REQUIRE(record != nullptr);
+    consumer_page->consumer_offset = record->header.length;
+
+    // The producer reclaims the space when the ring is full.
+    REQUIRE(ebpf_ring_buffer_output(ring_buffer, data.data(), data.size()) == EBPF_SUCCESS);
+    ebpf_ring_buffer_query(ring_buffer, &consumer, &producer);
+    REQUIRE(consumer == record->header.length);
+    REQUIRE(producer_page->producer_offset == producer);
+
+    // Querying the ring also reclaims the published space.
+    record = ebpf_ring_buffer_next_record(buffer, size, consumer, producer);
+    REQUIRE(record != nullptr);
+    consumer_page->consumer_offset = consumer + record->header.length;
+    ebpf_ring_buffer_query(ring_buffer, &consumer, &producer);
+    REQUIRE(consumer == consumer_page->consumer_offset);
+
+    ebpf_ring_buffer_destroy(ring_buffer);
+    ring_buffer = nullptr;
+}
+
 TEST_CASE("ring_buffer_reserve_submit_discard", "[platform]")
 {
     _test_helper test_helper;
@@ -1123,6 +1739,135 @@ TEST_CASE("ring_buffer_reserve_submit_discard", "[platform]")
     ring_buffer = nullptr;
 }
 
+TEST_CASE("ring_buffer_locked_record", "[platform]")
+{
+    _test_helper test_helper;
+    test_helper.initialize();
+    size_t consumer;
+    size_t producer;
+    ebpf_ring_buffer_t* ring_buffer;
+
+    uint8_t* buffer;
+    std::vector<uint8_t> data(10);
+    size_t size = 64 * 1024;
+    size_t record_length = data.size() + EBPF_OFFSET_OF(ebpf_ring_buffer_record_t, data);
+
+    REQUIRE(ebpf_ring_buffer_create(&ring_buffer, size) == EBPF_SUCCESS);
+    REQUIRE(ebpf_ring_buffer_map_buffer(ring_buffer, &buffer) == EBPF_SUCCESS);
+
+    // Reserve a record and output another one after it.
+    uint8_t* mem1 = nullptr;
+    REQUIRE(ebpf_ring_buffer_reserve(ring_buffer, &mem1, data.size()) == EBPF_SUCCESS);
+    REQUIRE(mem1 != nullptr);
+    REQUIRE(ebpf_ring_buffer_output(ring_buffer, data.data(), data.size()) == EBPF_SUCCESS);
+
+    ebpf_ring_buffer_query(ring_buffer, &consumer, &producer);
+    REQUIRE(producer == 2 * record_length);
+
+    // The reserved record is locked, so neither record can be consumed.
+    auto record = ebpf_ring_buffer_next_record(buffer, size, consumer, producer);
+    REQUIRE(record != nullptr);
+    REQUIRE(ebpf_ring_buffer_record_is_locked(record));
+    REQUIRE(ebpf_ring_buffer_return(ring_buffer, record_length) == EBPF_INVALID_ARGUMENT);
+
+    // Discarding the record unlocks it.
+    ebpf_result_t result = ebpf_ring_buffer_discard(mem1);
+    if (result != EBPF_SUCCESS) {
+        REQUIRE(result == EBPF_SUCCESS);
+    }
+    REQUIRE(!ebpf_ring_buffer_record_is_locked(record));
+    REQUIRE(record->header.discarded);
+    REQUIRE(record->header.length == record_length);
+
+    record = ebpf_ring_buffer_next_record(buffer, size, consumer + record_length, producer);
+    REQUIRE(record != nullptr);
+    REQUIRE(!ebpf_ring_buffer_record_is_locked(record));
+    REQUIRE(!record->header.discarded);
+
+    REQUIRE(ebpf_ring_buffer_return(ring_buffer, 2 * record_length) == EBPF_SUCCESS);
+    ebpf_ring_buffer_query(ring_buffer, &consumer, &producer);
+    REQUIRE(consumer == producer);
+
+    // Space that has been returned reads as locked until a record is written to it.
+    record = ebpf_ring_buffer_next_record(buffer, size, 0, 1);
+    REQUIRE(ebpf_ring_buffer_record_is_locked(record));
+
+    ebpf_ring_buffer_destroy(ring_buffer);
+    ring_buffer = nullptr;
+}
+
+TEST_CASE("ring_buffer_concurrent_output", "[platform]")
+{
+    _test_helper test_helper;
+    test_helper.initialize();
+    ebpf_ring_buffer_t* ring_buffer;
+
+    uint8_t* buffer;
+    size_t size = 64 * 1024;
+    const uint64_t records_per_producer = 10000;
+    uint32_t producer_count = ebpf_get_cpu_count();
+
+    REQUIRE(ebpf_ring_buffer_create(&ring_buffer, size) == EBPF_SUCCESS);
+    REQUIRE(ebpf_ring_buffer_map_buffer(ring_buffer, &buffer) == EBPF_SUCCESS);
+
+    // Each producer writes its index and a sequence number. Records that don't fit are retried.
+    volatile bool stop = false;
+    auto producer = [&](uint32_t producer_index) {
+        uint64_t data[2] = {producer_index, 0};
+        while (!stop && data[1] < records_per_producer) {
+            if (ebpf_ring_buffer_output(ring_buffer, reinterpret_cast<uint8_t*>(data), sizeof(data)) == EBPF_SUCCESS) {
+                data[1]++;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < producer_count; i++) {
+        threads.emplace_back(std::thread(producer, i));
+    }
+
+    // Consume records until every producer has written all of its records. Each producer's records must be seen
+    // in order, with no gaps.
+    std::vector<uint64_t> next_sequence(producer_count);
+    uint64_t records_consumed = 0;
+    bool records_valid = true;
+    while (records_valid && records_consumed < records_per_producer * producer_count) {
+        size_t consumer;
+        size_t producer_offset;
+        size_t consumed_length = 0;
+        ebpf_ring_buffer_query(ring_buffer, &consumer, &producer_offset);
+        for (;;) {
+            auto record = ebpf_ring_buffer_next_record(buffer, size, consumer + consumed_length, producer_offset);
+            if (record == nullptr || ebpf_ring_buffer_record_is_locked(record)) {
+                break;
+            }
+            const uint64_t* data = reinterpret_cast<const uint64_t*>(record->data);
+            if (record->header.length != EBPF_OFFSET_OF(ebpf_ring_buffer_record_t, data) + 2 * sizeof(uint64_t) ||
+                data[0] >= producer_count || data[1] != next_sequence[data[0]]) {
+                records_valid = false;
+                break;
+            }
+            next_sequence[data[0]]++;
+            records_consumed++;
+            consumed_length += record->header.length;
+        }
+        if (consumed_length != 0 && ebpf_ring_buffer_return(ring_buffer, consumed_length) != EBPF_SUCCESS) {
+            records_valid = false;
+        }
+    }
+
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(records_valid);
+    REQUIRE(records_consumed == records_per_producer * producer_count);
+
+    ebpf_ring_buffer_destroy(ring_buffer);
+    ring_buffer = nullptr;
+}
+
 TEST_CASE("error codes", "[platform]")
 {
     for (ebpf_result_t result = EBPF_SUCCESS; result < EBPF_RESULT_COUNT; result = (ebpf_result_t)(result + 1)) {
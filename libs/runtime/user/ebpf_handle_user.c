@@ -14,6 +14,7 @@ static ebpf_lock_t _ebpf_handle_table_lock = {0};
 static _Guarded_by_(_ebpf_handle_table_lock) ebpf_handle_entry_t _ebpf_handle_table[1024];
 
 static bool _ebpf_handle_table_initiated = false;
+static ebpf_handle_cleanup_t _ebpf_handle_cleanup_function = NULL;
 
 _Must_inspect_result_ ebpf_result_t
 ebpf_handle_table_initiate()
@@ -77,12 +78,53 @@ ebpf_handle_close(ebpf_handle_t handle)
 {
     // High volume call - Skip entry/exit logging.
     ebpf_lock_state_t state;
-    ebpf_result_t return_value;
+    ebpf_base_object_t* object = NULL;
 
     state = ebpf_lock_lock(&_ebpf_handle_table_lock);
     if (((size_t)handle < EBPF_COUNT_OF(_ebpf_handle_table)) && _ebpf_handle_table[handle] != NULL) {
-        EBPF_OBJECT_RELEASE_REFERENCE_INDIRECT(_ebpf_handle_table[handle]);
+        object = _ebpf_handle_table[handle];
         _ebpf_handle_table[handle] = NULL;
+    }
+    ebpf_lock_unlock(&_ebpf_handle_table_lock, state);
+
+    if (object == NULL) {
+        return EBPF_INVALID_OBJECT;
+    }
+
+    // Each handle is its own instance, so closing it is also the last close of the instance.
+    ebpf_handle_cleanup(object, (const void*)(uintptr_t)handle);
+    EBPF_OBJECT_RELEASE_REFERENCE_INDIRECT(object);
+    return EBPF_SUCCESS;
+}
+
+void
+ebpf_handle_set_cleanup_callback(_In_opt_ ebpf_handle_cleanup_t cleanup_function)
+{
+    _ebpf_handle_cleanup_function = cleanup_function;
+}
+
+void
+ebpf_handle_cleanup(_Inout_opt_ ebpf_base_object_t* object, _In_ const void* instance)
+{
+    ebpf_handle_cleanup_t cleanup_function = _ebpf_handle_cleanup_function;
+    if (object && cleanup_function) {
+        cleanup_function(object, instance);
+    }
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_handle_get_instance(ebpf_handle_t handle, _Outptr_ const void** instance)
+{
+    ebpf_lock_state_t state;
+    ebpf_result_t return_value;
+
+    if (handle >= EBPF_COUNT_OF(_ebpf_handle_table)) {
+        return EBPF_INVALID_OBJECT;
+    }
+
+    state = ebpf_lock_lock(&_ebpf_handle_table_lock);
+    if (_ebpf_handle_table[handle] != NULL) {
+        *instance = (const void*)(uintptr_t)handle;
         return_value = EBPF_SUCCESS;
     } else {
         return_value = EBPF_INVALID_OBJECT;
@@ -47,6 +47,16 @@ struct _ebpf_ring_descriptor
 };
 typedef struct _ebpf_ring_descriptor ebpf_ring_descriptor_t;
 
+struct _ebpf_locked_user_buffer
+{
+    void* address;
+};
+
+struct _ebpf_user_mapping
+{
+    void* address;
+};
+
 // This code is derived from the sample at:
 // https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-virtualalloc2
 
@@ -215,6 +225,86 @@ ebpf_ring_map_readonly_user(_In_ const ebpf_ring_descriptor_t* ring)
     EBPF_RETURN_POINTER(void*, ebpf_ring_descriptor_get_base_address(ring));
 }
 
+_Ret_maybenull_ void*
+ebpf_map_memory_user(_In_ MDL* memory_descriptor, ebpf_page_protection_t protection)
+{
+    EBPF_LOG_ENTRY();
+    UNREFERENCED_PARAMETER(protection);
+    EBPF_RETURN_POINTER(void*, ebpf_memory_descriptor_get_base_address(memory_descriptor));
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_create_user_mapping(
+    _In_ MDL* memory_descriptor, ebpf_page_protection_t protection, _Outptr_ ebpf_user_mapping_t** mapping)
+{
+    EBPF_LOG_ENTRY();
+    // The caller shares the address space of the execution context, so the mapping is the memory itself.
+    if (protection != EBPF_PAGE_PROTECT_READ_ONLY && protection != EBPF_PAGE_PROTECT_READ_WRITE) {
+        EBPF_RETURN_RESULT(EBPF_INVALID_ARGUMENT);
+    }
+
+    auto local_mapping = reinterpret_cast<ebpf_user_mapping_t*>(ebpf_allocate(sizeof(ebpf_user_mapping_t)));
+    if (!local_mapping) {
+        EBPF_RETURN_RESULT(EBPF_NO_MEMORY);
+    }
+    local_mapping->address = ebpf_map_memory_user(memory_descriptor, protection);
+    *mapping = local_mapping;
+    EBPF_RETURN_RESULT(EBPF_SUCCESS);
+}
+
+void
+ebpf_delete_user_mapping(_Frees_ptr_opt_ ebpf_user_mapping_t* mapping)
+{
+    EBPF_LOG_ENTRY();
+    ebpf_free(mapping);
+    EBPF_RETURN_VOID();
+}
+
+_Ret_notnull_ void*
+ebpf_user_mapping_get_address(_In_ const ebpf_user_mapping_t* mapping)
+{
+    return mapping->address;
+}
+
+_Must_inspect_result_ ebpf_result_t
+ebpf_lock_user_buffer(
+    uint64_t address, size_t length, ebpf_page_protection_t protection, _Outptr_ ebpf_locked_user_buffer_t** buffer)
+{
+    EBPF_LOG_ENTRY();
+    // The caller shares the address space of the execution context, so the buffer is used in place.
+    if (protection != EBPF_PAGE_PROTECT_READ_ONLY && protection != EBPF_PAGE_PROTECT_READ_WRITE) {
+        EBPF_RETURN_RESULT(EBPF_INVALID_ARGUMENT);
+    }
+    if (length == 0 || length > MAXUINT32) {
+        EBPF_RETURN_RESULT(EBPF_INVALID_ARGUMENT);
+    }
+    if (address == 0) {
+        EBPF_RETURN_RESULT(EBPF_INVALID_POINTER);
+    }
+
+    auto locked_buffer = reinterpret_cast<ebpf_locked_user_buffer_t*>(ebpf_allocate(sizeof(ebpf_locked_user_buffer_t)));
+    if (!locked_buffer) {
+        EBPF_RETURN_RESULT(EBPF_NO_MEMORY);
+    }
+    locked_buffer->address = reinterpret_cast<void*>(static_cast<uintptr_t>(address));
+    *buffer = locked_buffer;
+    EBPF_RETURN_RESULT(EBPF_SUCCESS);
+}
+
+void
+ebpf_unlock_user_buffer(_Frees_ptr_opt_ ebpf_locked_user_buffer_t* buffer)
+{
+    EBPF_LOG_ENTRY();
+    ebpf_free(buffer);
+    EBPF_RETURN_VOID();
+}
+
+_Ret_notnull_ void*
+ebpf_locked_user_buffer_get_address(_In_ const ebpf_locked_user_buffer_t* buffer)
+{
+    return buffer->address;
+}
+
 static uint32_t
 _ntstatus_to_win32_error_code(NTSTATUS status)
 {
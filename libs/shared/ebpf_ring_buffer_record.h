@@ -16,6 +16,26 @@ typedef struct _ebpf_ring_buffer_record
     uint8_t data[1];
 } ebpf_ring_buffer_record_t;
 
+/**
+ * @brief Page holding the producer offset of a ring buffer. It is mapped
+ * read-only into consumers, so they can find new records without calling
+ * into the kernel.
+ */
+typedef struct _ebpf_ring_buffer_producer_page
+{
+    volatile size_t producer_offset;
+} ebpf_ring_buffer_producer_page_t;
+
+/**
+ * @brief Page a consumer writes its consumer offset to. Space before the
+ * offset is handed back to producers the next time they run out of space, so
+ * consumers can return records without calling into the kernel.
+ */
+typedef struct _ebpf_ring_buffer_consumer_page
+{
+    volatile size_t consumer_offset;
+} ebpf_ring_buffer_consumer_page_t;
+
 /**
  * @brief Locate the next record in the ring buffer's data buffer and
  * advance consumer offset.
@@ -36,4 +56,22 @@ ebpf_ring_buffer_next_record(_In_ const uint8_t* buffer, size_t buffer_length, s
     return (ebpf_ring_buffer_record_t*)(buffer + consumer % buffer_length);
 }
 
+/**
+ * @brief Check whether a record is still being written by its producer. A
+ * record that is locked must not be consumed, and neither must any record that
+ * follows it. Records that are not locked are safe to read once this returns.
+ *
+ * @param[in] record Record to check.
+ * @retval true The record is locked.
+ * @retval false The record has been submitted or discarded.
+ */
+inline bool
+ebpf_ring_buffer_record_is_locked(_In_ const ebpf_ring_buffer_record_t* record)
+{
+    bool locked = ((const volatile ebpf_ring_buffer_record_t*)record)->header.locked;
+    // Order the read of the header before any reads of the record data.
+    MemoryBarrier();
+    return locked;
+}
+
 CXPLAT_EXTERN_C_END
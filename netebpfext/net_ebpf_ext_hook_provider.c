@@ -24,6 +24,7 @@ typedef struct _net_ebpf_extension_hook_client
     const void* client_binding_context;            ///< Client supplied context to be passed when invoking eBPF program.
     const ebpf_extension_data_t* client_data;      ///< Client supplied attach parameters.
     ebpf_program_invoke_function_t invoke_program; ///< Pointer to function to invoke eBPF program.
+    ebpf_program_invoke_vector_function_t invoke_programs; ///< Pointer to vector invoke function, if provided.
     void* provider_data; ///< Opaque pointer to hook specific data associated with this client.
     struct _net_ebpf_extension_hook_provider* provider_context; ///< Pointer to the hook NPI provider context.
     PIO_WORKITEM detach_work_item;              ///< Pointer to IO work item that is invoked to detach the client.
@@ -212,6 +213,31 @@ net_ebpf_extension_hook_invoke_program(
     NET_EBPF_EXT_RETURN_RESULT(invoke_result);
 }
 
+_Must_inspect_result_ ebpf_result_t
+net_ebpf_extension_hook_invoke_programs(
+    _In_ const net_ebpf_extension_hook_client_t* client,
+    _Inout_updates_(count) void** contexts,
+    _Out_writes_(count) uint32_t* results,
+    size_t count)
+{
+    ebpf_program_invoke_vector_function_t invoke_programs = client->invoke_programs;
+    const void* client_binding_context = client->client_binding_context;
+    ebpf_result_t invoke_result = EBPF_SUCCESS;
+
+    if (invoke_programs != NULL) {
+        invoke_result = invoke_programs(client_binding_context, contexts, results, count);
+    } else {
+        for (size_t index = 0; index < count; index++) {
+            invoke_result = client->invoke_program(client_binding_context, contexts[index], &results[index]);
+            if (invoke_result != EBPF_SUCCESS) {
+                memset(&results[index], 0, (count - index) * sizeof(results[0]));
+                break;
+            }
+        }
+    }
+    NET_EBPF_EXT_RETURN_RESULT(invoke_result);
+}
+
 _Must_inspect_result_ ebpf_result_t
 net_ebpf_extension_hook_check_attach_parameter(
     size_t attach_parameter_size,
@@ -354,6 +380,10 @@ _net_ebpf_extension_hook_provider_attach_client(
         goto Exit;
     }
     hook_client->invoke_program = client_dispatch_table->ebpf_program_invoke_function;
+    if ((client_dispatch_table->version >= EBPF_LINK_DISPATCH_TABLE_VERSION_2) &&
+        (client_dispatch_table->count >= EBPF_LINK_DISPATCH_TABLE_FUNCTION_COUNT_2)) {
+        hook_client->invoke_programs = client_dispatch_table->ebpf_program_invoke_vector_function;
+    }
     hook_client->provider_context = local_provider_context;
 
     status = _ebpf_ext_attach_init_rundown(hook_client);
@@ -151,6 +151,27 @@ _Must_inspect_result_ ebpf_result_t
 net_ebpf_extension_hook_invoke_program(
     _In_ const net_ebpf_extension_hook_client_t* client, _Inout_ void* context, _Out_ uint32_t* result);
 
+/**
+ * @brief Invoke the eBPF program attached to this hook on a vector of contexts, entering
+ * the epoch once for the whole vector. Clients that do not provide vector invocation are
+ * invoked once per context. This must be called inside a
+ * net_ebpf_extension_hook_client_enter_rundown/net_ebpf_extension_hook_client_leave_rundown block.
+ *
+ * @param[in] client Pointer to Hook NPI Client (a.k.a. eBPF Link object).
+ * @param[in, out] contexts Contexts to pass to eBPF program.
+ * @param[out] results Return value from the eBPF program for each context.
+ * @param[in] count Number of contexts.
+ * @retval EBPF_SUCCESS The operation was successful.
+ * @retval EBPF_NO_MEMORY Unable to allocate resources for this
+ * operation.
+ */
+_Must_inspect_result_ ebpf_result_t
+net_ebpf_extension_hook_invoke_programs(
+    _In_ const net_ebpf_extension_hook_client_t* client,
+    _Inout_updates_(count) void** contexts,
+    _Out_writes_(count) uint32_t* results,
+    size_t count);
+
 /**
  * @brief Return client attached to the hook NPI provider.
  * @param[in, out] provider_context Provider module's context.
@@ -52,12 +52,57 @@ const net_ebpf_extension_wfp_filter_parameters_t _net_ebpf_extension_xdp_wfp_fil
 
 #define NET_EBPF_XDP_FILTER_COUNT EBPF_COUNT_OF(_net_ebpf_extension_xdp_wfp_filter_parameters)
 
+// Maximum number of packets in an NBL chain passed to the program in one invocation.
+#define NET_EBPF_XDP_BATCH_SIZE 16
+
+// Largest header length a program can declare. Headers up to this size are copied
+// instead of linearizing the whole packet.
+#define NET_EBPF_XDP_MAX_HEADER_LENGTH 512
+
+/**
+ *  @brief This is the internal data structure for XDP context.
+ */
+typedef struct _net_ebpf_xdp_md
+{
+    xdp_md_t base;
+    NET_BUFFER_LIST* original_nbl;
+    NET_BUFFER_LIST* cloned_nbl;
+    uint8_t* header_copy; ///< Copy of the headers of a non-contiguous original NBL that base.data points to.
+} net_ebpf_xdp_md_t;
+
+/**
+ * @brief Scratch state for one batch of an NBL chain. Each CPU has its own batch in the
+ * filter context, so classify does not keep the contexts on the stack or allocate per call.
+ */
+typedef struct _net_ebpf_xdp_batch
+{
+    bool in_use; ///< Set while a classify on this CPU owns the batch.
+    net_ebpf_xdp_md_t net_xdp_contexts[NET_EBPF_XDP_BATCH_SIZE];
+    void* program_contexts[NET_EBPF_XDP_BATCH_SIZE];
+    uint32_t results[NET_EBPF_XDP_BATCH_SIZE];
+    uint8_t* header_storage; ///< NET_EBPF_XDP_BATCH_SIZE header copies, stored after the batch.
+} net_ebpf_xdp_batch_t;
+
+// Bytes of a batch including its header storage, padded to keep batches on separate cache lines.
+#define NET_EBPF_XDP_BATCH_ALLOCATION_SIZE(max_header_length) \
+    EBPF_PAD_CACHE(sizeof(net_ebpf_xdp_batch_t) + (size_t)NET_EBPF_XDP_BATCH_SIZE * (max_header_length))
+
 typedef struct _net_ebpf_extension_xdp_wfp_filter_context
 {
     net_ebpf_extension_wfp_filter_context_t base;
     uint32_t if_index;
+    uint32_t max_header_length; ///< Bytes of each packet the program reads, 0 for the whole packet.
+    uint32_t batch_count;       ///< Number of per-CPU batches.
+    uint8_t* batches;           ///< Per-CPU batches, allocated inline after the filter context.
 } net_ebpf_extension_xdp_wfp_filter_context_t;
 
+__forceinline static net_ebpf_xdp_batch_t*
+_net_ebpf_ext_xdp_get_batch(_In_ const net_ebpf_extension_xdp_wfp_filter_context_t* filter_context, uint32_t cpu)
+{
+    return (net_ebpf_xdp_batch_t*)(filter_context->batches +
+                                   cpu * NET_EBPF_XDP_BATCH_ALLOCATION_SIZE(filter_context->max_header_length));
+}
+
 //
 // XDP Program Information NPI Provider.
 //
@@ -127,6 +172,8 @@ net_ebpf_extension_xdp_on_client_attach(
     const ebpf_extension_data_t* client_data = net_ebpf_extension_hook_client_get_client_data(attaching_client);
     uint32_t if_index;
     uint32_t wild_card_if_index = 0;
+    uint32_t max_header_length = 0;
+    uint32_t batch_count;
     uint32_t filter_count;
     FWPM_FILTER_CONDITION condition = {0};
     net_ebpf_extension_xdp_wfp_filter_context_t* filter_context = NULL;
@@ -144,7 +191,9 @@ net_ebpf_extension_xdp_on_client_attach(
     }
 
     if (client_data->header.size > 0) {
-        if ((client_data->header.size != sizeof(uint32_t)) || (client_data->data == NULL)) {
+        if (((client_data->header.size != sizeof(uint32_t)) &&
+             (client_data->header.size != sizeof(xdp_attach_parameters_t))) ||
+            (client_data->data == NULL)) {
             result = EBPF_INVALID_ARGUMENT;
             NET_EBPF_EXT_LOG_MESSAGE(
                 NET_EBPF_EXT_TRACELOG_LEVEL_ERROR,
@@ -153,6 +202,18 @@ net_ebpf_extension_xdp_on_client_attach(
             goto Exit;
         }
         if_index = *(uint32_t*)client_data->data;
+        if (client_data->header.size == sizeof(xdp_attach_parameters_t)) {
+            max_header_length = ((const xdp_attach_parameters_t*)client_data->data)->max_header_length;
+            if (max_header_length > NET_EBPF_XDP_MAX_HEADER_LENGTH) {
+                result = EBPF_INVALID_ARGUMENT;
+                NET_EBPF_EXT_LOG_MESSAGE_UINT32(
+                    NET_EBPF_EXT_TRACELOG_LEVEL_ERROR,
+                    NET_EBPF_EXT_TRACELOG_KEYWORD_XDP,
+                    "Attach attempt rejected. Invalid max header length.",
+                    max_header_length);
+                goto Exit;
+            }
+        }
     } else {
         // If the client did not specify any attach parameters, we treat that as a wildcard interface index.
         if_index = wild_card_if_index;
@@ -181,8 +242,11 @@ net_ebpf_extension_xdp_on_client_attach(
         condition.conditionValue.uint32 = if_index;
     }
 
+    // Preallocate a batch for each CPU with the filter context. The extra cache line leaves room to align them.
+    batch_count = KeQueryMaximumProcessorCountEx(ALL_PROCESSOR_GROUPS);
     result = net_ebpf_extension_wfp_filter_context_create(
-        sizeof(net_ebpf_extension_xdp_wfp_filter_context_t),
+        sizeof(net_ebpf_extension_xdp_wfp_filter_context_t) + EBPF_CACHE_LINE_SIZE +
+            batch_count * NET_EBPF_XDP_BATCH_ALLOCATION_SIZE(max_header_length),
         attaching_client,
         (net_ebpf_extension_wfp_filter_context_t**)&filter_context);
     if (result != EBPF_SUCCESS) {
@@ -194,6 +258,13 @@ net_ebpf_extension_xdp_on_client_attach(
         goto Exit;
     }
     filter_context->if_index = if_index;
+    filter_context->max_header_length = max_header_length;
+    filter_context->batch_count = batch_count;
+    filter_context->batches = (uint8_t*)EBPF_CACHE_ALIGN_POINTER(filter_context + 1);
+    for (uint32_t cpu = 0; cpu < batch_count; cpu++) {
+        net_ebpf_xdp_batch_t* batch = _net_ebpf_ext_xdp_get_batch(filter_context, cpu);
+        batch->header_storage = (uint8_t*)(batch + 1);
+    }
     filter_context->base.filter_ids_count = NET_EBPF_XDP_FILTER_COUNT;
 
     // Add WFP filters at appropriate layers and set the hook NPI client as the filter's raw context.
@@ -302,16 +373,6 @@ net_ebpf_ext_xdp_unregister_providers()
     }
 }
 
-/**
- *  @brief This is the internal data structure for XDP context.
- */
-typedef struct _net_ebpf_xdp_md
-{
-    xdp_md_t base;
-    NET_BUFFER_LIST* original_nbl;
-    NET_BUFFER_LIST* cloned_nbl;
-} net_ebpf_xdp_md_t;
-
 //
 // NBL Clone Functions.
 //
@@ -432,6 +493,45 @@ _net_ebpf_ext_free_nbl(_Inout_ NET_BUFFER_LIST* nbl, BOOLEAN free_data)
     FwpsFreeNetBufferList0(nbl);
 }
 
+/**
+ * @brief Copy the headers that the program saw back into the original NBL.
+ *
+ * @param[in, out] net_xdp_ctx XDP context with a header copy.
+ * @retval STATUS_SUCCESS The headers were written back.
+ * @retval STATUS_INSUFFICIENT_RESOURCES A buffer of the NBL could not be mapped.
+ */
+static NTSTATUS
+_net_ebpf_ext_write_back_header_copy(_Inout_ net_ebpf_xdp_md_t* net_xdp_ctx)
+{
+    NTSTATUS status = STATUS_SUCCESS;
+    NET_BUFFER* net_buffer = NET_BUFFER_LIST_FIRST_NB(net_xdp_ctx->original_nbl);
+    MDL* mdl = NET_BUFFER_CURRENT_MDL(net_buffer);
+    size_t offset = NET_BUFFER_CURRENT_MDL_OFFSET(net_buffer);
+    const uint8_t* source = net_xdp_ctx->header_copy;
+    size_t remaining = (uint8_t*)net_xdp_ctx->base.data_end - net_xdp_ctx->header_copy;
+
+    while (remaining > 0 && mdl != NULL) {
+        uint8_t* buffer = (uint8_t*)MmGetSystemAddressForMdlSafe(mdl, NormalPagePriority);
+        if (buffer == NULL) {
+            status = STATUS_INSUFFICIENT_RESOURCES;
+            NET_EBPF_EXT_LOG_NTSTATUS_API_FAILURE(
+                NET_EBPF_EXT_TRACELOG_KEYWORD_XDP, "MmGetSystemAddressForMdlSafe", status);
+            goto Exit;
+        }
+        size_t length = min(remaining, MmGetMdlByteCount(mdl) - offset);
+        memcpy(buffer + offset, source, length);
+        source += length;
+        remaining -= length;
+        offset = 0;
+        mdl = mdl->Next;
+    }
+
+    net_xdp_ctx->header_copy = NULL;
+
+Exit:
+    return status;
+}
+
 //
 // XDP Helper Functions.
 //
@@ -452,14 +552,34 @@ _net_ebpf_xdp_adjust_head(_Inout_ xdp_md_t* ctx, int delta)
         goto Exit;
     }
 
-    nbl = (net_xdp_ctx->cloned_nbl != NULL) ? net_xdp_ctx->cloned_nbl : net_xdp_ctx->original_nbl;
-    ASSERT(nbl != NULL);
-    net_buffer = NET_BUFFER_LIST_FIRST_NB(nbl);
-
     if (delta == 0) {
         // Nothing to do.
         goto Exit;
     }
+
+    if (net_xdp_ctx->cloned_nbl == NULL) {
+        net_buffer = NET_BUFFER_LIST_FIRST_NB(net_xdp_ctx->original_nbl);
+        if ((size_t)((uint8_t*)net_xdp_ctx->base.data_end - (uint8_t*)net_xdp_ctx->base.data) <
+            net_buffer->DataLength) {
+            // The program only sees the headers of a packet that is not contiguous. Linearize the whole packet,
+            // since moving the start of the data can expose bytes outside the headers.
+            if (net_xdp_ctx->header_copy != NULL) {
+                if (!NT_SUCCESS(_net_ebpf_ext_write_back_header_copy(net_xdp_ctx))) {
+                    return_value = -1;
+                    goto Exit;
+                }
+            }
+            net_xdp_ctx->base.data = NULL;
+            if (!NT_SUCCESS(_net_ebpf_ext_allocate_cloned_nbl(net_xdp_ctx, 0))) {
+                return_value = -1;
+                goto Exit;
+            }
+        }
+    }
+
+    nbl = (net_xdp_ctx->cloned_nbl != NULL) ? net_xdp_ctx->cloned_nbl : net_xdp_ctx->original_nbl;
+    ASSERT(nbl != NULL);
+    net_buffer = NET_BUFFER_LIST_FIRST_NB(nbl);
     if (delta < 0) {
         uint32_t absolute_delta = -delta;
         ndis_status = NdisRetreatNetBufferDataStart(net_buffer, absolute_delta, 0, NULL);
@@ -500,17 +620,25 @@ Exit:
 //
 
 static void
-_net_ebpf_ext_l2_receive_inject_complete(_In_ const void* context, _Inout_ NET_BUFFER_LIST* nbl, BOOLEAN dispatch_level)
+_net_ebpf_ext_l2_receive_inject_complete(
+    _In_opt_ const void* context, _Inout_ NET_BUFFER_LIST* nbl, BOOLEAN dispatch_level)
 {
-    UNREFERENCED_PARAMETER(context);
     UNREFERENCED_PARAMETER(dispatch_level);
-    // Free clone allocated using _net_ebpf_ext_allocate_cloned_nbl.
-    _net_ebpf_ext_free_nbl(nbl, TRUE);
+
+    if ((BOOLEAN)(uintptr_t)context == FALSE) {
+        // Free clone allocated using _net_ebpf_ext_allocate_cloned_nbl.
+        _net_ebpf_ext_free_nbl(nbl, TRUE);
+    } else {
+        // Free clone allocated using FwpsAllocateCloneNetBufferList.
+        FwpsFreeCloneNetBufferList(nbl, 0);
+    }
 }
 
 static NTSTATUS
 _net_ebpf_ext_receive_inject_cloned_nbl(
-    _In_ const NET_BUFFER_LIST* cloned_nbl, _In_ const FWPS_INCOMING_VALUES* incoming_fixed_values)
+    _In_ const NET_BUFFER_LIST* cloned_nbl,
+    BOOLEAN reference_clone,
+    _In_ const FWPS_INCOMING_VALUES* incoming_fixed_values)
 {
     uint32_t interface_index =
         incoming_fixed_values->incomingValue[FWPS_FIELD_INBOUND_MAC_FRAME_NATIVE_INTERFACE_INDEX].value.uint32;
@@ -526,10 +654,12 @@ _net_ebpf_ext_receive_inject_cloned_nbl(
         ndis_port,
         (NET_BUFFER_LIST*)cloned_nbl,
         (FWPS_INJECT_COMPLETE)_net_ebpf_ext_l2_receive_inject_complete,
-        NULL);
+        (void*)(uintptr_t)reference_clone);
 
     if (!NT_SUCCESS(status)) {
         NET_EBPF_EXT_LOG_NTSTATUS_API_FAILURE(NET_EBPF_EXT_TRACELOG_KEYWORD_XDP, "FwpsInjectMacReceiveAsync", status);
+        _net_ebpf_ext_l2_receive_inject_complete(
+            (void*)(uintptr_t)reference_clone, (NET_BUFFER_LIST*)cloned_nbl, KeGetCurrentIrql() == DISPATCH_LEVEL);
         goto Exit;
     }
 
@@ -612,6 +742,160 @@ Exit:
 // WFP Classify callback.
 //
 
+/**
+ * @brief Point an XDP context at the data of its original NBL. Only the bytes the program
+ * reads need to be contiguous. When they are not, a program that declared a header length
+ * gets a copy of its headers and any other program gets a linearized clone of the packet.
+ *
+ * @param[in, out] net_xdp_ctx XDP context for the original NBL.
+ * @param[in] max_header_length Bytes of the packet the program reads, 0 for the whole packet.
+ * @param[in] header_copy Storage of max_header_length bytes for a copy of the headers.
+ * @retval STATUS_SUCCESS The operation was successful.
+ * @retval STATUS_INVALID_PARAMETER The NBL has no net buffer.
+ * @retval STATUS_INSUFFICIENT_RESOURCES Unable to allocate resources for this operation.
+ */
+static NTSTATUS
+_net_ebpf_ext_xdp_prepare_context(
+    _Inout_ net_ebpf_xdp_md_t* net_xdp_ctx,
+    uint32_t max_header_length,
+    _Out_writes_bytes_(max_header_length) uint8_t* header_copy)
+{
+    NTSTATUS status = STATUS_SUCCESS;
+    NET_BUFFER* net_buffer = NET_BUFFER_LIST_FIRST_NB(net_xdp_ctx->original_nbl);
+    uint8_t* packet_buffer;
+    uint32_t data_length;
+
+    if (net_buffer == NULL) {
+        status = STATUS_INVALID_PARAMETER;
+        NET_EBPF_EXT_LOG_MESSAGE(
+            NET_EBPF_EXT_TRACELOG_LEVEL_ERROR, NET_EBPF_EXT_TRACELOG_KEYWORD_XDP, "net_buffer not present");
+        goto Exit;
+    }
+
+    data_length = net_buffer->DataLength;
+    if ((max_header_length != 0) && (max_header_length < data_length)) {
+        data_length = max_header_length;
+    }
+
+    packet_buffer = (uint8_t*)NdisGetDataBuffer(net_buffer, data_length, NULL, sizeof(uint16_t), 0);
+    if ((packet_buffer == NULL) && (max_header_length != 0)) {
+        // Data in net_buffer not contiguous. Copy the headers instead of the whole packet.
+        packet_buffer = (uint8_t*)NdisGetDataBuffer(net_buffer, data_length, header_copy, 1, 0);
+        if (packet_buffer == NULL) {
+            status = STATUS_INSUFFICIENT_RESOURCES;
+            NET_EBPF_EXT_LOG_NTSTATUS_API_FAILURE(NET_EBPF_EXT_TRACELOG_KEYWORD_XDP, "NdisGetDataBuffer", status);
+            goto Exit;
+        }
+        if (packet_buffer == header_copy) {
+            net_xdp_ctx->header_copy = header_copy;
+        }
+    }
+
+    if (packet_buffer == NULL) {
+        // Data in net_buffer not contiguous.
+        // Allocate a cloned NBL with contiguous data.
+        status = _net_ebpf_ext_allocate_cloned_nbl(net_xdp_ctx, 0);
+        if (!NT_SUCCESS(status)) {
+            NET_EBPF_EXT_LOG_MESSAGE_NTSTATUS(
+                NET_EBPF_EXT_TRACELOG_LEVEL_ERROR,
+                NET_EBPF_EXT_TRACELOG_KEYWORD_XDP,
+                "_net_ebpf_ext_allocate_cloned_nbl failed.",
+                status);
+            goto Exit;
+        }
+    } else {
+        net_xdp_ctx->base.data = packet_buffer;
+        net_xdp_ctx->base.data_end = packet_buffer + data_length;
+    }
+
+Exit:
+    return status;
+}
+
+static void
+_net_ebpf_ext_receive_inject_original_nbl(
+    _In_ NET_BUFFER_LIST* nbl, _In_ const FWPS_INCOMING_VALUES* incoming_fixed_values)
+{
+    NET_BUFFER_LIST* cloned_nbl = NULL;
+    NTSTATUS status = FwpsAllocateCloneNetBufferList(nbl, NULL, NULL, 0, &cloned_nbl);
+    if (!NT_SUCCESS(status)) {
+        NET_EBPF_EXT_LOG_NTSTATUS_API_FAILURE(
+            NET_EBPF_EXT_TRACELOG_KEYWORD_XDP, "FwpsAllocateCloneNetBufferList", status);
+        return;
+    }
+
+    (void)_net_ebpf_ext_receive_inject_cloned_nbl(cloned_nbl, TRUE, incoming_fixed_values);
+}
+
+/**
+ * @brief Act on the verdict of the program for one NBL of the indication. WFP takes a single
+ * action for the whole indication, so once any NBL is not passed unmodified the indication is
+ * absorbed and every NBL that passes is injected back into the receive path.
+ *
+ * @param[in, out] nbl NBL the verdict is for.
+ * @param[in, out] net_xdp_ctx XDP context of the NBL, or NULL if the program did not run on it.
+ * @param[in] result Verdict of the program.
+ * @param[in] first_nbl First NBL of the indication.
+ * @param[in, out] absorb_indication Set once the indication is absorbed.
+ * @param[in] incoming_fixed_values Incoming values of the indication.
+ */
+static void
+_net_ebpf_ext_xdp_handle_verdict(
+    _Inout_ NET_BUFFER_LIST* nbl,
+    _Inout_opt_ net_ebpf_xdp_md_t* net_xdp_ctx,
+    uint32_t result,
+    _In_ NET_BUFFER_LIST* first_nbl,
+    _Inout_ bool* absorb_indication,
+    _In_ const FWPS_INCOMING_VALUES* incoming_fixed_values)
+{
+    bool cloned = (net_xdp_ctx != NULL) && (net_xdp_ctx->cloned_nbl != NULL);
+
+    if ((net_xdp_ctx != NULL) && (net_xdp_ctx->header_copy != NULL) && (result == XDP_PASS || result == XDP_TX)) {
+        if (!NT_SUCCESS(_net_ebpf_ext_write_back_header_copy(net_xdp_ctx))) {
+            // The packet no longer matches what the program saw.
+            result = XDP_DROP;
+        }
+    }
+
+    if ((result == XDP_PASS) && !cloned && !*absorb_indication) {
+        // No special processing required. The original NBL will be allowed to proceed in the ingress path.
+        return;
+    }
+
+    if (!*absorb_indication) {
+        // All earlier NBLs were passed unmodified. Inject them, since the indication is now absorbed.
+        for (NET_BUFFER_LIST* passed_nbl = first_nbl; passed_nbl != nbl;
+             passed_nbl = NET_BUFFER_LIST_NEXT_NBL(passed_nbl)) {
+            _net_ebpf_ext_receive_inject_original_nbl(passed_nbl, incoming_fixed_values);
+        }
+        *absorb_indication = TRUE;
+    }
+
+    switch (result) {
+    case XDP_PASS:
+        if (cloned) {
+            // Inject the cloned NBL in receive path.
+            (void)_net_ebpf_ext_receive_inject_cloned_nbl(net_xdp_ctx->cloned_nbl, FALSE, incoming_fixed_values);
+        } else {
+            _net_ebpf_ext_receive_inject_original_nbl(nbl, incoming_fixed_values);
+        }
+        break;
+    case XDP_TX:
+        ASSERT(net_xdp_ctx != NULL);
+        _net_ebpf_ext_handle_xdp_tx(net_xdp_ctx, incoming_fixed_values);
+        break;
+    default:
+        ASSERT(FALSE);
+        __fallthrough;
+    case XDP_DROP:
+        // Free cloned NBL, if any.
+        if (cloned) {
+            _net_ebpf_ext_free_nbl(net_xdp_ctx->cloned_nbl, TRUE);
+        }
+        break;
+    }
+}
+
 void
 net_ebpf_ext_layer_2_classify(
     _In_ const FWPS_INCOMING_VALUES* incoming_fixed_values,
@@ -624,12 +908,18 @@ net_ebpf_ext_layer_2_classify(
 {
     NTSTATUS status = STATUS_SUCCESS;
     NET_BUFFER_LIST* nbl = (NET_BUFFER_LIST*)layer_data;
-    NET_BUFFER* net_buffer = NULL;
-    uint8_t* packet_buffer;
-    uint32_t result = 0;
-    net_ebpf_xdp_md_t net_xdp_ctx = {0};
+    NET_BUFFER_LIST* batch_nbl;
+    net_ebpf_xdp_batch_t* batch = NULL;
+    bool batch_allocated = FALSE;
+    KIRQL old_irql = PASSIVE_LEVEL;
+    bool irql_raised = FALSE;
+    uint32_t cpu;
+    size_t count;
+    size_t index;
+    bool absorb_indication = FALSE;
     net_ebpf_extension_xdp_wfp_filter_context_t* filter_context = NULL;
     net_ebpf_extension_hook_client_t* attached_client = NULL;
+    uint32_t ingress_ifindex;
     uint32_t client_if_index;
 
     UNREFERENCED_PARAMETER(incoming_metadata_values);
@@ -651,6 +941,16 @@ net_ebpf_ext_layer_2_classify(
         goto Exit;
     }
 
+    // Packets injected back into the receive path by this extension were already processed by the program.
+    if (nbl != NULL) {
+        FWPS_PACKET_INJECTION_STATE injection_state =
+            FwpsQueryPacketInjectionState(_net_ebpf_ext_l2_injection_handle, nbl, NULL);
+        if ((injection_state == FWPS_PACKET_INJECTED_BY_SELF) ||
+            (injection_state == FWPS_PACKET_PREVIOUSLY_INJECTED_BY_SELF)) {
+            goto Exit;
+        }
+    }
+
     filter_context = (net_ebpf_extension_xdp_wfp_filter_context_t*)filter->context;
     ASSERT(filter_context != NULL);
     if (filter_context == NULL) {
@@ -682,95 +982,109 @@ net_ebpf_ext_layer_2_classify(
         goto Exit;
     }
 
-    net_xdp_ctx.base.ingress_ifindex =
+    ingress_ifindex =
         incoming_fixed_values->incomingValue[FWPS_FIELD_INBOUND_MAC_FRAME_NATIVE_INTERFACE_INDEX].value.uint32;
 
     client_if_index = filter_context->if_index;
-    ASSERT((client_if_index == 0) || (client_if_index == net_xdp_ctx.base.ingress_ifindex));
-    if (client_if_index != 0 && client_if_index != net_xdp_ctx.base.ingress_ifindex) {
+    ASSERT((client_if_index == 0) || (client_if_index == ingress_ifindex));
+    if (client_if_index != 0 && client_if_index != ingress_ifindex) {
         // The client is not interested in this ingress ifindex.
         goto Exit;
     }
 
-    net_xdp_ctx.original_nbl = nbl;
-
-    net_buffer = NET_BUFFER_LIST_FIRST_NB(nbl);
-    if (net_buffer == NULL) {
-        NET_EBPF_EXT_LOG_MESSAGE(
-            NET_EBPF_EXT_TRACELOG_LEVEL_ERROR, NET_EBPF_EXT_TRACELOG_KEYWORD_XDP, "net_buffer not present");
-        goto Exit;
+    // Stay on this CPU while its batch is in use.
+    old_irql = KeRaiseIrqlToDpcLevel();
+    irql_raised = TRUE;
+    cpu = KeGetCurrentProcessorNumberEx(NULL);
+    if (cpu < filter_context->batch_count) {
+        batch = _net_ebpf_ext_xdp_get_batch(filter_context, cpu);
     }
-
-    packet_buffer = (uint8_t*)NdisGetDataBuffer(net_buffer, net_buffer->DataLength, NULL, sizeof(uint16_t), 0);
-    if (!packet_buffer) {
-        // Data in net_buffer not contiguous.
-        // Allocate a cloned NBL with contiguous data.
-        status = _net_ebpf_ext_allocate_cloned_nbl(&net_xdp_ctx, 0);
-        if (!NT_SUCCESS(status)) {
-            NET_EBPF_EXT_LOG_MESSAGE_NTSTATUS(
-                NET_EBPF_EXT_TRACELOG_LEVEL_ERROR,
-                NET_EBPF_EXT_TRACELOG_KEYWORD_XDP,
-                "_net_ebpf_ext_allocate_cloned_nbl failed.",
-                status);
+    if ((batch == NULL) || batch->in_use) {
+        // A classify nested in an injection on this CPU owns its batch. Fall back to a pool allocation.
+        batch = (net_ebpf_xdp_batch_t*)ExAllocatePoolUninitialized(
+            NonPagedPoolNx,
+            NET_EBPF_XDP_BATCH_ALLOCATION_SIZE(filter_context->max_header_length),
+            NET_EBPF_EXTENSION_POOL_TAG);
+        if (batch == NULL) {
+            NET_EBPF_EXT_LOG_MESSAGE(
+                NET_EBPF_EXT_TRACELOG_LEVEL_ERROR, NET_EBPF_EXT_TRACELOG_KEYWORD_XDP, "Failed to allocate batch");
             goto Exit;
         }
-    } else {
-        net_xdp_ctx.base.data = packet_buffer;
-        net_xdp_ctx.base.data_end = packet_buffer + net_buffer->DataLength;
-    }
-
-    if (net_ebpf_extension_hook_invoke_program(attached_client, &net_xdp_ctx, &result) != EBPF_SUCCESS) {
-        // Perform a default action if the program fails.
-        result = XDP_DROP;
+        batch->header_storage = (uint8_t*)(batch + 1);
+        batch_allocated = TRUE;
     }
+    batch->in_use = TRUE;
+
+    // Walk the NBL chain and invoke the program once for each batch of packets.
+    while (nbl != NULL) {
+        batch_nbl = nbl;
+        count = 0;
+        for (; (nbl != NULL) && (count < NET_EBPF_XDP_BATCH_SIZE); nbl = NET_BUFFER_LIST_NEXT_NBL(nbl)) {
+            net_ebpf_xdp_md_t* net_xdp_ctx = &batch->net_xdp_contexts[count];
+            memset(net_xdp_ctx, 0, sizeof(net_ebpf_xdp_md_t));
+            net_xdp_ctx->base.ingress_ifindex = ingress_ifindex;
+            net_xdp_ctx->original_nbl = nbl;
+
+            status = _net_ebpf_ext_xdp_prepare_context(
+                net_xdp_ctx,
+                filter_context->max_header_length,
+                batch->header_storage + count * filter_context->max_header_length);
+            if (!NT_SUCCESS(status)) {
+                // The packet is permitted without running the program.
+                continue;
+            }
+            batch->program_contexts[count] = net_xdp_ctx;
+            count++;
+        }
 
-    switch (result) {
-    case XDP_PASS:
-        if (net_xdp_ctx.cloned_nbl != NULL) {
-            // Drop the original NBL.
-            classify_output->actionType = FWP_ACTION_BLOCK;
-            classify_output->rights &= ~FWPS_RIGHT_ACTION_WRITE;
+        if ((count > 0) &&
+            (net_ebpf_extension_hook_invoke_programs(
+                 attached_client, batch->program_contexts, batch->results, count) != EBPF_SUCCESS)) {
+            // Perform a default action if the program fails.
+            for (index = 0; index < count; index++) {
+                batch->results[index] = XDP_DROP;
+            }
+        }
 
-            // Inject the cloned NBL in receive path.
-            status = _net_ebpf_ext_receive_inject_cloned_nbl(net_xdp_ctx.cloned_nbl, incoming_fixed_values);
-            if (NT_SUCCESS(status)) {
-                // If cloned packet could be successfully injected, no need to audit for dropping the original.
-                // So absorb the original packet.
-                classify_output->flags |= FWPS_CLASSIFY_OUT_FLAG_ABSORB;
+        index = 0;
+        for (; batch_nbl != nbl; batch_nbl = NET_BUFFER_LIST_NEXT_NBL(batch_nbl)) {
+            if ((index < count) && (batch->net_xdp_contexts[index].original_nbl == batch_nbl)) {
+                _net_ebpf_ext_xdp_handle_verdict(
+                    batch_nbl,
+                    &batch->net_xdp_contexts[index],
+                    batch->results[index],
+                    (NET_BUFFER_LIST*)layer_data,
+                    &absorb_indication,
+                    incoming_fixed_values);
+                index++;
             } else {
-                NET_EBPF_EXT_LOG_MESSAGE_NTSTATUS(
-                    NET_EBPF_EXT_TRACELOG_LEVEL_ERROR,
-                    NET_EBPF_EXT_TRACELOG_KEYWORD_XDP,
-                    "_net_ebpf_ext_receive_inject_cloned_nbl failed.",
-                    status);
+                _net_ebpf_ext_xdp_handle_verdict(
+                    batch_nbl,
+                    NULL,
+                    XDP_PASS,
+                    (NET_BUFFER_LIST*)layer_data,
+                    &absorb_indication,
+                    incoming_fixed_values);
             }
         }
-        // No special processing required in the non-clone case.
-        // The inbound original NBL will be allowed to proceed in the ingress path.
-        break;
-    case XDP_TX:
-        _net_ebpf_ext_handle_xdp_tx(&net_xdp_ctx, incoming_fixed_values);
-        // Absorb the original NBL.
-        classify_output->actionType = FWP_ACTION_BLOCK;
-        classify_output->rights &= ~FWPS_RIGHT_ACTION_WRITE;
-        classify_output->flags |= FWPS_CLASSIFY_OUT_FLAG_ABSORB;
-        break;
-    default:
-        ASSERT(FALSE);
-        __fallthrough;
-    case XDP_DROP:
+    }
+
+    if (absorb_indication) {
         classify_output->actionType = FWP_ACTION_BLOCK;
         classify_output->rights &= ~FWPS_RIGHT_ACTION_WRITE;
-        // Do not audit XDP drops.
+        // The packets were injected, sent or dropped, so do not audit the indication.
         classify_output->flags |= FWPS_CLASSIFY_OUT_FLAG_ABSORB;
-        // Free cloned NBL, if any.
-        if (net_xdp_ctx.cloned_nbl != NULL) {
-            _net_ebpf_ext_free_nbl(net_xdp_ctx.cloned_nbl, TRUE);
-        }
-        break;
     }
 
 Exit:
+    if (batch_allocated) {
+        ExFreePool(batch);
+    } else if (batch != NULL) {
+        batch->in_use = FALSE;
+    }
+    if (irql_raised) {
+        KeLowerIrql(old_irql);
+    }
     if (attached_client) {
         net_ebpf_extension_hook_client_leave_rundown(attached_client);
     }
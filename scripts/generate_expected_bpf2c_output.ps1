@@ -110,6 +110,22 @@ function Update-ExpectedOutput
         $RawCommand = $Bpf2cCommand + " --bpf " + $ObjectFileWithPath + " --hash none" + " " + $additional_options
         $Output = Invoke-Expression $RawCommand
         TrimAndExport-Output -InputBuffer $Output -OutputFile $ExpectedRawFileWithPath
+
+        # test_sample_ebpf is also used to check the output with array map lookups inlined.
+        if ($FileName -eq "test_sample_ebpf")
+        {
+            $InlineOptions = " --hash none --inline-map-lookups " + $additional_options
+            $InlineFileWithPath = $ExpectedOutputPath + "\" + $FileName + "_inline"
+
+            $Output = Invoke-Expression ($Bpf2cCommand + " --bpf " + $ObjectFileWithPath + " --sys" + $InlineOptions)
+            TrimAndExport-Output -InputBuffer $Output -OutputFile ($InlineFileWithPath + "_sys.c")
+
+            $Output = Invoke-Expression ($Bpf2cCommand + " --bpf " + $ObjectFileWithPath + " --dll" + $InlineOptions)
+            TrimAndExport-Output -InputBuffer $Output -OutputFile ($InlineFileWithPath + "_dll.c")
+
+            $Output = Invoke-Expression ($Bpf2cCommand + " --bpf " + $ObjectFileWithPath + $InlineOptions)
+            TrimAndExport-Output -InputBuffer $Output -OutputFile ($InlineFileWithPath + "_raw.c")
+        }
     }
     Set-Location $CurrentLocation
 }
@@ -93,6 +93,7 @@ enum class _test_mode
     UseHashX,
     FileNotFound,
     FileOutput,
+    InlineMapLookups,
 };
 
 void
@@ -104,6 +105,9 @@ run_test_elf(const std::string& elf_file, _test_mode test_mode, const std::optio
     if (test_mode == _test_mode::NoVerify) {
         argv.push_back("--no-verify");
     }
+    if (test_mode == _test_mode::InlineMapLookups) {
+        argv.push_back("--inline-map-lookups");
+    }
     argv.push_back("--bpf");
     argv.push_back(elf_file.c_str());
     if (test_mode == _test_mode::UseHash) {
@@ -138,9 +142,11 @@ run_test_elf(const std::string& elf_file, _test_mode test_mode, const std::optio
         switch (test_mode) {
         case _test_mode::FileOutput:
         case _test_mode::Verify:
-        case _test_mode::NoVerify: {
+        case _test_mode::NoVerify:
+        case _test_mode::InlineMapLookups: {
+            std::string expected_name = (test_mode == _test_mode::InlineMapLookups) ? name + "_inline" : name;
             std::vector<std::string> expected_output = read_contents<std::ifstream>(
-                std::string("expected\\") + name + suffix,
+                std::string("expected\\") + expected_name + suffix,
                 {transform_line_directives<'\\'>, transform_line_directives<'/'>, transform_fix_opcode_comment});
             std::vector<std::string> actual_output;
             if (test_mode == _test_mode::FileOutput) {
@@ -219,6 +225,7 @@ DECLARE_TEST("droppacket", _test_mode::Verify)
 DECLARE_TEST("droppacket_unsafe", _test_mode::NoVerify)
 DECLARE_TEST("empty", _test_mode::NoVerify)
 DECLARE_TEST("encap_reflect_packet", _test_mode::Verify)
+DECLARE_TEST("global_vars", _test_mode::NoVerify)
 DECLARE_TEST("hash_of_map", _test_mode::Verify)
 DECLARE_TEST("inner_map", _test_mode::Verify)
 DECLARE_TEST("invalid_helpers", _test_mode::NoVerify);
@@ -231,6 +238,7 @@ DECLARE_TEST("map_in_map_legacy_id", _test_mode::Verify)
 DECLARE_TEST("map_in_map_legacy_idx", _test_mode::Verify)
 DECLARE_TEST("map_reuse", _test_mode::Verify)
 DECLARE_TEST("map_reuse_2", _test_mode::Verify)
+DECLARE_TEST("multiple_subprograms", _test_mode::NoVerify)
 DECLARE_TEST("pidtgid", _test_mode::Verify)
 DECLARE_TEST("printk", _test_mode::Verify)
 DECLARE_TEST("printk_legacy", _test_mode::Verify)
@@ -245,6 +253,7 @@ DECLARE_TEST("tail_call_multiple", _test_mode::Verify)
 DECLARE_TEST("tail_call_recursive", _test_mode::Verify)
 DECLARE_TEST("tail_call_sequential", _test_mode::Verify)
 DECLARE_TEST("test_sample_ebpf", _test_mode::Verify)
+DECLARE_TEST("test_sample_ebpf", _test_mode::InlineMapLookups)
 DECLARE_TEST("test_utility_helpers", _test_mode::Verify)
 DECLARE_TEST("cgroup_sock_addr", _test_mode::UseHashSHA512)
 DECLARE_TEST("cgroup_sock_addr2", _test_mode::UseHashX)
@@ -263,7 +272,8 @@ TEST_CASE("help", "[bpf2c_cli]")
 
     auto [out, err, result_value] = run_test_main(argv);
     REQUIRE(result_value != 0);
-    std::vector<std::string> options = {"--sys", "--dll", "--no-verify", "--bpf", "--hash", "--help"};
+    std::vector<std::string> options = {
+        "--sys", "--dll", "--no-verify", "--bpf", "--hash", "--inline-map-lookups", "--help"};
     for (const auto& option : options) {
         REQUIRE(err.find(option) != std::string::npos);
     }
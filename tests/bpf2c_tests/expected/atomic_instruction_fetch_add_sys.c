@@ -215,7 +215,7 @@ func(void* context)
 #line 25 "sample/undocked/atomic_instruction_fetch_add.c"
     // Prologue
 #line 25 "sample/undocked/atomic_instruction_fetch_add.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 25 "sample/undocked/atomic_instruction_fetch_add.c"
     register uint64_t r0 = 0;
 #line 25 "sample/undocked/atomic_instruction_fetch_add.c"
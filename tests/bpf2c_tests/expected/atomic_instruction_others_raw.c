@@ -26,7 +26,7 @@ static uint64_t
 test(void* context)
 {
     // Prologue
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[7];
     register uint64_t r0 = 0;
     register uint64_t r1 = 0;
     register uint64_t r2 = 0;
@@ -80,7 +80,7 @@ lookup(void* context)
 #line 25 "sample/undocked/bad_map_name.c"
     // Prologue
 #line 25 "sample/undocked/bad_map_name.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 25 "sample/undocked/bad_map_name.c"
     register uint64_t r0 = 0;
 #line 25 "sample/undocked/bad_map_name.c"
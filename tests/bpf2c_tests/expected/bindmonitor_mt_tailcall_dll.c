@@ -83,7 +83,7 @@ BindMonitor_Callee0(void* context)
 #line 53 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 53 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 53 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 53 "sample/bindmonitor_mt_tailcall.c"
@@ -256,7 +256,7 @@ BindMonitor_Callee1(void* context)
 #line 54 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 54 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 54 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 54 "sample/bindmonitor_mt_tailcall.c"
@@ -429,7 +429,7 @@ BindMonitor_Callee10(void* context)
 #line 63 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 63 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 63 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 63 "sample/bindmonitor_mt_tailcall.c"
@@ -602,7 +602,7 @@ BindMonitor_Callee11(void* context)
 #line 64 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 64 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 64 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 64 "sample/bindmonitor_mt_tailcall.c"
@@ -775,7 +775,7 @@ BindMonitor_Callee12(void* context)
 #line 65 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 65 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 65 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 65 "sample/bindmonitor_mt_tailcall.c"
@@ -948,7 +948,7 @@ BindMonitor_Callee13(void* context)
 #line 66 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 66 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 66 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 66 "sample/bindmonitor_mt_tailcall.c"
@@ -1121,7 +1121,7 @@ BindMonitor_Callee14(void* context)
 #line 67 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 67 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 67 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 67 "sample/bindmonitor_mt_tailcall.c"
@@ -1294,7 +1294,7 @@ BindMonitor_Callee15(void* context)
 #line 68 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 68 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 68 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 68 "sample/bindmonitor_mt_tailcall.c"
@@ -1467,7 +1467,7 @@ BindMonitor_Callee16(void* context)
 #line 69 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 69 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 69 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 69 "sample/bindmonitor_mt_tailcall.c"
@@ -1640,7 +1640,7 @@ BindMonitor_Callee17(void* context)
 #line 70 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 70 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 70 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 70 "sample/bindmonitor_mt_tailcall.c"
@@ -1813,7 +1813,7 @@ BindMonitor_Callee18(void* context)
 #line 71 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 71 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 71 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 71 "sample/bindmonitor_mt_tailcall.c"
@@ -1986,7 +1986,7 @@ BindMonitor_Callee19(void* context)
 #line 72 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 72 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 72 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 72 "sample/bindmonitor_mt_tailcall.c"
@@ -2159,7 +2159,7 @@ BindMonitor_Callee2(void* context)
 #line 55 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 55 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 55 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 55 "sample/bindmonitor_mt_tailcall.c"
@@ -2332,7 +2332,7 @@ BindMonitor_Callee20(void* context)
 #line 73 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 73 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 73 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 73 "sample/bindmonitor_mt_tailcall.c"
@@ -2505,7 +2505,7 @@ BindMonitor_Callee21(void* context)
 #line 74 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 74 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 74 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 74 "sample/bindmonitor_mt_tailcall.c"
@@ -2678,7 +2678,7 @@ BindMonitor_Callee22(void* context)
 #line 75 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 75 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 75 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 75 "sample/bindmonitor_mt_tailcall.c"
@@ -2851,7 +2851,7 @@ BindMonitor_Callee23(void* context)
 #line 76 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 76 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 76 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 76 "sample/bindmonitor_mt_tailcall.c"
@@ -3024,7 +3024,7 @@ BindMonitor_Callee24(void* context)
 #line 77 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 77 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 77 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 77 "sample/bindmonitor_mt_tailcall.c"
@@ -3197,7 +3197,7 @@ BindMonitor_Callee25(void* context)
 #line 78 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 78 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 78 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 78 "sample/bindmonitor_mt_tailcall.c"
@@ -3370,7 +3370,7 @@ BindMonitor_Callee26(void* context)
 #line 79 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 79 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 79 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 79 "sample/bindmonitor_mt_tailcall.c"
@@ -3543,7 +3543,7 @@ BindMonitor_Callee27(void* context)
 #line 80 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 80 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 80 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 80 "sample/bindmonitor_mt_tailcall.c"
@@ -3716,7 +3716,7 @@ BindMonitor_Callee28(void* context)
 #line 81 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 81 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 81 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 81 "sample/bindmonitor_mt_tailcall.c"
@@ -3889,7 +3889,7 @@ BindMonitor_Callee29(void* context)
 #line 82 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 82 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 82 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 82 "sample/bindmonitor_mt_tailcall.c"
@@ -4062,7 +4062,7 @@ BindMonitor_Callee3(void* context)
 #line 56 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 56 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 56 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 56 "sample/bindmonitor_mt_tailcall.c"
@@ -4235,7 +4235,7 @@ BindMonitor_Callee30(void* context)
 #line 83 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 83 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 83 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 83 "sample/bindmonitor_mt_tailcall.c"
@@ -4408,7 +4408,7 @@ BindMonitor_Callee31(void* context)
 #line 84 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 84 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 84 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 84 "sample/bindmonitor_mt_tailcall.c"
@@ -4572,7 +4572,7 @@ BindMonitor_Callee32(void* context)
 #line 97 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 97 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 97 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 97 "sample/bindmonitor_mt_tailcall.c"
@@ -4617,7 +4617,7 @@ BindMonitor_Callee4(void* context)
 #line 57 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 57 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 57 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 57 "sample/bindmonitor_mt_tailcall.c"
@@ -4790,7 +4790,7 @@ BindMonitor_Callee5(void* context)
 #line 58 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 58 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 58 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 58 "sample/bindmonitor_mt_tailcall.c"
@@ -4963,7 +4963,7 @@ BindMonitor_Callee6(void* context)
 #line 59 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 59 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 59 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 59 "sample/bindmonitor_mt_tailcall.c"
@@ -5136,7 +5136,7 @@ BindMonitor_Callee7(void* context)
 #line 60 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 60 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 60 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 60 "sample/bindmonitor_mt_tailcall.c"
@@ -5309,7 +5309,7 @@ BindMonitor_Callee8(void* context)
 #line 61 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 61 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 61 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 61 "sample/bindmonitor_mt_tailcall.c"
@@ -5482,7 +5482,7 @@ BindMonitor_Callee9(void* context)
 #line 62 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 62 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 62 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 62 "sample/bindmonitor_mt_tailcall.c"
@@ -5657,7 +5657,7 @@ BindMonitor_Caller(void* context)
 #line 31 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 31 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[5];
 #line 31 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 31 "sample/bindmonitor_mt_tailcall.c"
@@ -57,7 +57,7 @@ BindMonitor_Callee0(void* context)
 #line 53 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 53 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 53 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 53 "sample/bindmonitor_mt_tailcall.c"
@@ -230,7 +230,7 @@ BindMonitor_Callee1(void* context)
 #line 54 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 54 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 54 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 54 "sample/bindmonitor_mt_tailcall.c"
@@ -403,7 +403,7 @@ BindMonitor_Callee10(void* context)
 #line 63 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 63 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 63 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 63 "sample/bindmonitor_mt_tailcall.c"
@@ -576,7 +576,7 @@ BindMonitor_Callee11(void* context)
 #line 64 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 64 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 64 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 64 "sample/bindmonitor_mt_tailcall.c"
@@ -749,7 +749,7 @@ BindMonitor_Callee12(void* context)
 #line 65 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 65 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 65 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 65 "sample/bindmonitor_mt_tailcall.c"
@@ -922,7 +922,7 @@ BindMonitor_Callee13(void* context)
 #line 66 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 66 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 66 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 66 "sample/bindmonitor_mt_tailcall.c"
@@ -1095,7 +1095,7 @@ BindMonitor_Callee14(void* context)
 #line 67 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 67 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 67 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 67 "sample/bindmonitor_mt_tailcall.c"
@@ -1268,7 +1268,7 @@ BindMonitor_Callee15(void* context)
 #line 68 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 68 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 68 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 68 "sample/bindmonitor_mt_tailcall.c"
@@ -1441,7 +1441,7 @@ BindMonitor_Callee16(void* context)
 #line 69 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 69 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 69 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 69 "sample/bindmonitor_mt_tailcall.c"
@@ -1614,7 +1614,7 @@ BindMonitor_Callee17(void* context)
 #line 70 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 70 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 70 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 70 "sample/bindmonitor_mt_tailcall.c"
@@ -1787,7 +1787,7 @@ BindMonitor_Callee18(void* context)
 #line 71 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 71 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 71 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 71 "sample/bindmonitor_mt_tailcall.c"
@@ -1960,7 +1960,7 @@ BindMonitor_Callee19(void* context)
 #line 72 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 72 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 72 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 72 "sample/bindmonitor_mt_tailcall.c"
@@ -2133,7 +2133,7 @@ BindMonitor_Callee2(void* context)
 #line 55 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 55 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 55 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 55 "sample/bindmonitor_mt_tailcall.c"
@@ -2306,7 +2306,7 @@ BindMonitor_Callee20(void* context)
 #line 73 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 73 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 73 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 73 "sample/bindmonitor_mt_tailcall.c"
@@ -2479,7 +2479,7 @@ BindMonitor_Callee21(void* context)
 #line 74 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 74 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 74 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 74 "sample/bindmonitor_mt_tailcall.c"
@@ -2652,7 +2652,7 @@ BindMonitor_Callee22(void* context)
 #line 75 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 75 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 75 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 75 "sample/bindmonitor_mt_tailcall.c"
@@ -2825,7 +2825,7 @@ BindMonitor_Callee23(void* context)
 #line 76 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 76 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 76 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 76 "sample/bindmonitor_mt_tailcall.c"
@@ -2998,7 +2998,7 @@ BindMonitor_Callee24(void* context)
 #line 77 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 77 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 77 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 77 "sample/bindmonitor_mt_tailcall.c"
@@ -3171,7 +3171,7 @@ BindMonitor_Callee25(void* context)
 #line 78 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 78 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 78 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 78 "sample/bindmonitor_mt_tailcall.c"
@@ -3344,7 +3344,7 @@ BindMonitor_Callee26(void* context)
 #line 79 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 79 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 79 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 79 "sample/bindmonitor_mt_tailcall.c"
@@ -3517,7 +3517,7 @@ BindMonitor_Callee27(void* context)
 #line 80 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 80 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 80 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 80 "sample/bindmonitor_mt_tailcall.c"
@@ -3690,7 +3690,7 @@ BindMonitor_Callee28(void* context)
 #line 81 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 81 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 81 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 81 "sample/bindmonitor_mt_tailcall.c"
@@ -3863,7 +3863,7 @@ BindMonitor_Callee29(void* context)
 #line 82 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 82 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 82 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 82 "sample/bindmonitor_mt_tailcall.c"
@@ -4036,7 +4036,7 @@ BindMonitor_Callee3(void* context)
 #line 56 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 56 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 56 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 56 "sample/bindmonitor_mt_tailcall.c"
@@ -4209,7 +4209,7 @@ BindMonitor_Callee30(void* context)
 #line 83 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 83 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 83 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 83 "sample/bindmonitor_mt_tailcall.c"
@@ -4382,7 +4382,7 @@ BindMonitor_Callee31(void* context)
 #line 84 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 84 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 84 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 84 "sample/bindmonitor_mt_tailcall.c"
@@ -4546,7 +4546,7 @@ BindMonitor_Callee32(void* context)
 #line 97 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 97 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 97 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 97 "sample/bindmonitor_mt_tailcall.c"
@@ -4591,7 +4591,7 @@ BindMonitor_Callee4(void* context)
 #line 57 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 57 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 57 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 57 "sample/bindmonitor_mt_tailcall.c"
@@ -4764,7 +4764,7 @@ BindMonitor_Callee5(void* context)
 #line 58 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 58 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 58 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 58 "sample/bindmonitor_mt_tailcall.c"
@@ -4937,7 +4937,7 @@ BindMonitor_Callee6(void* context)
 #line 59 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 59 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 59 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 59 "sample/bindmonitor_mt_tailcall.c"
@@ -5110,7 +5110,7 @@ BindMonitor_Callee7(void* context)
 #line 60 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 60 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 60 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 60 "sample/bindmonitor_mt_tailcall.c"
@@ -5283,7 +5283,7 @@ BindMonitor_Callee8(void* context)
 #line 61 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 61 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 61 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 61 "sample/bindmonitor_mt_tailcall.c"
@@ -5456,7 +5456,7 @@ BindMonitor_Callee9(void* context)
 #line 62 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 62 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 62 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 62 "sample/bindmonitor_mt_tailcall.c"
@@ -5631,7 +5631,7 @@ BindMonitor_Caller(void* context)
 #line 31 "sample/bindmonitor_mt_tailcall.c"
     // Prologue
 #line 31 "sample/bindmonitor_mt_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[5];
 #line 31 "sample/bindmonitor_mt_tailcall.c"
     register uint64_t r0 = 0;
 #line 31 "sample/bindmonitor_mt_tailcall.c"
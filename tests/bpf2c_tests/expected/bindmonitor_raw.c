@@ -88,7 +88,7 @@ BindMonitor(void* context)
 #line 112 "sample/bindmonitor.c"
     // Prologue
 #line 112 "sample/bindmonitor.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[11];
 #line 112 "sample/bindmonitor.c"
     register uint64_t r0 = 0;
 #line 112 "sample/bindmonitor.c"
@@ -56,7 +56,7 @@ bind_monitor(void* context)
 #line 26 "sample/bindmonitor_ringbuf.c"
     // Prologue
 #line 26 "sample/bindmonitor_ringbuf.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 26 "sample/bindmonitor_ringbuf.c"
     register uint64_t r0 = 0;
 #line 26 "sample/bindmonitor_ringbuf.c"
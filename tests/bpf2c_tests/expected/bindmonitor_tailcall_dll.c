@@ -156,7 +156,7 @@ BindMonitor(void* context)
 #line 120 "sample/bindmonitor_tailcall.c"
     // Prologue
 #line 120 "sample/bindmonitor_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 120 "sample/bindmonitor_tailcall.c"
     register uint64_t r0 = 0;
 #line 120 "sample/bindmonitor_tailcall.c"
@@ -265,7 +265,7 @@ BindMonitor_Callee0(void* context)
 #line 136 "sample/bindmonitor_tailcall.c"
     // Prologue
 #line 136 "sample/bindmonitor_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 136 "sample/bindmonitor_tailcall.c"
     register uint64_t r0 = 0;
 #line 136 "sample/bindmonitor_tailcall.c"
@@ -376,7 +376,7 @@ BindMonitor_Callee1(void* context)
 #line 152 "sample/bindmonitor_tailcall.c"
     // Prologue
 #line 152 "sample/bindmonitor_tailcall.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[11];
 #line 152 "sample/bindmonitor_tailcall.c"
     register uint64_t r0 = 0;
 #line 152 "sample/bindmonitor_tailcall.c"
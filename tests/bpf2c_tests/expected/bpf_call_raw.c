@@ -54,7 +54,7 @@ func(void* context)
 #line 25 "sample/undocked/bpf_call.c"
     // Prologue
 #line 25 "sample/undocked/bpf_call.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 25 "sample/undocked/bpf_call.c"
     register uint64_t r0 = 0;
 #line 25 "sample/undocked/bpf_call.c"
@@ -55,7 +55,7 @@ func(void* context)
 #line 17 "sample/custom_program_type/bpf.c"
     // Prologue
 #line 17 "sample/custom_program_type/bpf.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 17 "sample/custom_program_type/bpf.c"
     register uint64_t r0 = 0;
 #line 17 "sample/custom_program_type/bpf.c"
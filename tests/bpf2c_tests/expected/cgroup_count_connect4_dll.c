@@ -83,7 +83,7 @@ count_tcp_connect4(void* context)
 #line 31 "sample/cgroup_count_connect4.c"
     // Prologue
 #line 31 "sample/cgroup_count_connect4.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[2];
 #line 31 "sample/cgroup_count_connect4.c"
     register uint64_t r0 = 0;
 #line 31 "sample/cgroup_count_connect4.c"
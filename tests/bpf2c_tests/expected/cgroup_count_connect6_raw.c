@@ -57,7 +57,7 @@ count_tcp_connect6(void* context)
 #line 31 "sample/cgroup_count_connect6.c"
     // Prologue
 #line 31 "sample/cgroup_count_connect6.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[2];
 #line 31 "sample/cgroup_count_connect6.c"
     register uint64_t r0 = 0;
 #line 31 "sample/cgroup_count_connect6.c"
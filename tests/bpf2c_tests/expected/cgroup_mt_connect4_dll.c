@@ -57,7 +57,7 @@ tcp_mt_connect4(void* context)
 #line 27 "sample/cgroup_mt_connect4.c"
     // Prologue
 #line 27 "sample/cgroup_mt_connect4.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 27 "sample/cgroup_mt_connect4.c"
     register uint64_t r0 = 0;
 #line 27 "sample/cgroup_mt_connect4.c"
@@ -102,7 +102,7 @@ connect_redirect4(void* context)
 #line 140 "sample/cgroup_sock_addr2.c"
     // Prologue
 #line 140 "sample/cgroup_sock_addr2.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[13];
 #line 140 "sample/cgroup_sock_addr2.c"
     register uint64_t r0 = 0;
 #line 140 "sample/cgroup_sock_addr2.c"
@@ -519,7 +519,7 @@ connect_redirect6(void* context)
 #line 147 "sample/cgroup_sock_addr2.c"
     // Prologue
 #line 147 "sample/cgroup_sock_addr2.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[12];
 #line 147 "sample/cgroup_sock_addr2.c"
     register uint64_t r0 = 0;
 #line 147 "sample/cgroup_sock_addr2.c"
@@ -244,7 +244,7 @@ authorize_connect4(void* context)
 #line 83 "sample/cgroup_sock_addr.c"
     // Prologue
 #line 83 "sample/cgroup_sock_addr.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[8];
 #line 83 "sample/cgroup_sock_addr.c"
     register uint64_t r0 = 0;
 #line 83 "sample/cgroup_sock_addr.c"
@@ -414,7 +414,7 @@ authorize_connect6(void* context)
 #line 90 "sample/cgroup_sock_addr.c"
     // Prologue
 #line 90 "sample/cgroup_sock_addr.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[8];
 #line 90 "sample/cgroup_sock_addr.c"
     register uint64_t r0 = 0;
 #line 90 "sample/cgroup_sock_addr.c"
@@ -602,7 +602,7 @@ authorize_recv_accept4(void* context)
 #line 97 "sample/cgroup_sock_addr.c"
     // Prologue
 #line 97 "sample/cgroup_sock_addr.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[8];
 #line 97 "sample/cgroup_sock_addr.c"
     register uint64_t r0 = 0;
 #line 97 "sample/cgroup_sock_addr.c"
@@ -772,7 +772,7 @@ authorize_recv_accept6(void* context)
 #line 104 "sample/cgroup_sock_addr.c"
     // Prologue
 #line 104 "sample/cgroup_sock_addr.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[8];
 #line 104 "sample/cgroup_sock_addr.c"
     register uint64_t r0 = 0;
 #line 104 "sample/cgroup_sock_addr.c"
@@ -196,7 +196,7 @@ decapsulate_permit_packet(void* context)
 #line 88 "sample/decap_permit_packet.c"
     // Prologue
 #line 88 "sample/decap_permit_packet.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 88 "sample/decap_permit_packet.c"
     register uint64_t r0 = 0;
 #line 88 "sample/decap_permit_packet.c"
@@ -95,7 +95,7 @@ DropPacket(void* context)
 #line 43 "sample/droppacket.c"
     // Prologue
 #line 43 "sample/droppacket.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 43 "sample/droppacket.c"
     register uint64_t r0 = 0;
 #line 43 "sample/droppacket.c"
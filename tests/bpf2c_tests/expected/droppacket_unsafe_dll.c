@@ -82,7 +82,7 @@ DropPacket(void* context)
 #line 34 "sample/unsafe/droppacket_unsafe.c"
     // Prologue
 #line 34 "sample/unsafe/droppacket_unsafe.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 34 "sample/unsafe/droppacket_unsafe.c"
     register uint64_t r0 = 0;
 #line 34 "sample/unsafe/droppacket_unsafe.c"
@@ -62,7 +62,7 @@ encap_reflect_packet(void* context)
 #line 167 "sample/encap_reflect_packet.c"
     // Prologue
 #line 167 "sample/encap_reflect_packet.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[2];
 #line 167 "sample/encap_reflect_packet.c"
     register uint64_t r0 = 0;
 #line 167 "sample/encap_reflect_packet.c"
@@ -0,0 +1,237 @@
+// Copyright (c) eBPF for Windows contributors
+// SPDX-License-Identifier: MIT
+
+// Do not alter this generated file.
+// This file was generated from global_vars.o
+
+#include "bpf2c.h"
+
+#include <stdio.h>
+#define WIN32_LEAN_AND_MEAN // Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+
+#define metadata_table global_vars##_metadata_table
+extern metadata_table_t metadata_table;
+
+bool APIENTRY
+DllMain(_In_ HMODULE hModule, unsigned int ul_reason_for_call, _In_ void* lpReserved)
+{
+    UNREFERENCED_PARAMETER(hModule);
+    UNREFERENCED_PARAMETER(lpReserved);
+    switch (ul_reason_for_call) {
+    case DLL_PROCESS_ATTACH:
+    case DLL_THREAD_ATTACH:
+    case DLL_THREAD_DETACH:
+    case DLL_PROCESS_DETACH:
+        break;
+    }
+    return TRUE;
+}
+
+__declspec(dllexport) metadata_table_t* get_metadata_table() { return &metadata_table; }
+
+#include "bpf2c.h"
+
+static void
+_get_hash(_Outptr_result_buffer_maybenull_(*size) const uint8_t** hash, _Out_ size_t* size)
+{
+    *hash = NULL;
+    *size = 0;
+}
+#pragma data_seg(push, "maps")
+static map_entry_t _maps[] = {
+    {NULL,
+     {
+         BPF_MAP_TYPE_ARRAY, // Type of map.
+         4,                  // Size in bytes of a map key.
+         4,                  // Size in bytes of a map value.
+         1,                  // Maximum number of entries allowed in the map.
+         0,                  // Inner map index.
+         LIBBPF_PIN_NONE,    // Pinning type for the map.
+         0,                  // Identifier for a map template.
+         0,                  // The id of the inner map template.
+     },
+     ".rodata"},
+    {NULL,
+     {
+         BPF_MAP_TYPE_ARRAY, // Type of map.
+         4,                  // Size in bytes of a map key.
+         8,                  // Size in bytes of a map value.
+         1,                  // Maximum number of entries allowed in the map.
+         0,                  // Inner map index.
+         LIBBPF_PIN_NONE,    // Pinning type for the map.
+         0,                  // Identifier for a map template.
+         0,                  // The id of the inner map template.
+     },
+     ".bss"},
+    {NULL,
+     {
+         BPF_MAP_TYPE_ARRAY, // Type of map.
+         4,                  // Size in bytes of a map key.
+         4,                  // Size in bytes of a map value.
+         1,                  // Maximum number of entries allowed in the map.
+         0,                  // Inner map index.
+         LIBBPF_PIN_NONE,    // Pinning type for the map.
+         0,                  // Identifier for a map template.
+         0,                  // The id of the inner map template.
+     },
+     ".data"},
+};
+#pragma data_seg(pop)
+
+static void
+_get_maps(_Outptr_result_buffer_maybenull_(*count) map_entry_t** maps, _Out_ size_t* count)
+{
+    *maps = _maps;
+    *count = 3;
+}
+
+#pragma data_seg(push, "maps")
+static map_data_entry_t _map_data[3] = {{NULL}};
+#pragma data_seg(pop)
+
+static void
+_get_map_data(_Outptr_result_buffer_maybenull_(*count) map_data_entry_t** map_data, _Out_ size_t* count)
+{
+    *map_data = _map_data;
+    *count = 3;
+}
+
+static GUID global_vars_program_type_guid = {
+    0xf788ef4a, 0x207d, 0x4dc3, {0x85, 0xcf, 0x0f, 0x2e, 0xa1, 0x07, 0x21, 0x3c}};
+static GUID global_vars_attach_type_guid = {
+    0xf788ef4b, 0x207d, 0x4dc3, {0x85, 0xcf, 0x0f, 0x2e, 0xa1, 0x07, 0x21, 0x3c}};
+static uint16_t global_vars_maps[] = {
+    0,
+    1,
+    2,
+};
+
+#pragma code_seg(push, "sample~1")
+static uint64_t
+global_vars(void* context)
+{
+    // Prologue
+    uint64_t stack[1];
+    register uint64_t r0 = 0;
+    register uint64_t r1 = 0;
+    register uint64_t r2 = 0;
+    register uint64_t r3 = 0;
+    register uint64_t r4 = 0;
+    register uint64_t r10 = 0;
+
+    r1 = (uintptr_t)context;
+    r10 = (uintptr_t)((uint8_t*)stack + sizeof(stack));
+
+    // EBPF_OP_LDXW pc=0 dst=r1 src=r1 offset=16 imm=0
+    r1 = *(uint32_t*)(uintptr_t)(r1 + OFFSET(16));
+    // EBPF_OP_LDDW pc=1 dst=r2 src=r0 offset=0 imm=0
+    r2 = POINTER((uint8_t*)_map_data[0].address + 0);
+    // EBPF_OP_LDXW pc=3 dst=r3 src=r2 offset=0 imm=0
+    r3 = (uint64_t)10;
+    // EBPF_OP_JGE_REG pc=4 dst=r3 src=r1 offset=5 imm=0
+    if (r3 >= r1) {
+        goto label_1;
+    }
+    // EBPF_OP_LDDW pc=5 dst=r3 src=r0 offset=0 imm=0
+    r3 = POINTER((uint8_t*)_map_data[1].address + 0);
+    // EBPF_OP_LDXDW pc=7 dst=r4 src=r3 offset=0 imm=0
+    r4 = *(uint64_t*)(uintptr_t)(r3 + OFFSET(0));
+    // EBPF_OP_ADD64_IMM pc=8 dst=r4 src=r0 offset=0 imm=1
+    r4 += IMMEDIATE(1);
+    // EBPF_OP_STXDW pc=9 dst=r3 src=r4 offset=0 imm=0
+    *(uint64_t*)(uintptr_t)(r3 + OFFSET(0)) = (uint64_t)r4;
+label_1:
+    // EBPF_OP_LDDW pc=10 dst=r3 src=r0 offset=0 imm=0
+    r3 = POINTER((uint8_t*)_map_data[2].address + 0);
+    // EBPF_OP_STXW pc=12 dst=r3 src=r1 offset=0 imm=0
+    *(uint32_t*)(uintptr_t)(r3 + OFFSET(0)) = (uint32_t)r1;
+    // EBPF_OP_LDXW pc=13 dst=r0 src=r2 offset=0 imm=0
+    r0 = *(uint32_t*)(uintptr_t)(r2 + OFFSET(0));
+    // EBPF_OP_EXIT pc=14 dst=r0 src=r0 offset=0 imm=0
+    return r0;
+}
+#pragma code_seg(pop)
+#line __LINE__ __FILE__
+
+#pragma data_seg(push, "programs")
+static program_entry_t _programs[] = {
+    {
+        0,
+        global_vars,
+        "sample~1",
+        "sample_ext",
+        "global_vars",
+        global_vars_maps,
+        3,
+        NULL,
+        0,
+        15,
+        &global_vars_program_type_guid,
+        &global_vars_attach_type_guid,
+    },
+};
+#pragma data_seg(pop)
+
+static void
+_get_programs(_Outptr_result_buffer_(*count) program_entry_t** programs, _Out_ size_t* count)
+{
+    *programs = _programs;
+    *count = 1;
+}
+
+static void
+_get_version(_Out_ bpf2c_version_t* version)
+{
+    version->major = 0;
+    version->minor = 17;
+    version->revision = 0;
+}
+
+static void
+_get_map_initial_values(_Outptr_result_buffer_(*count) map_initial_values_t** map_initial_values, _Out_ size_t* count)
+{
+    *map_initial_values = NULL;
+    *count = 0;
+}
+
+static const uint8_t _global_variable_section_1_initial_data[] = {
+    1, 0, 0, 0,
+};
+
+static const uint8_t _global_variable_section_2_initial_data[] = {
+    10, 0, 0, 0,
+};
+
+static global_variable_section_info_t _global_variable_sections[] = {
+    {
+        .name = ".bss",
+        .size = 8,
+        .initial_data = NULL,
+        .read_only = false,
+    },
+    {
+        .name = ".data",
+        .size = 4,
+        .initial_data = _global_variable_section_1_initial_data,
+        .read_only = false,
+    },
+    {
+        .name = ".rodata",
+        .size = 4,
+        .initial_data = _global_variable_section_2_initial_data,
+        .read_only = true,
+    },
+};
+
+static void
+_get_global_variable_sections(
+    _Outptr_result_buffer_maybenull_(*count) global_variable_section_info_t** global_variable_sections,
+    _Out_ size_t* count)
+{
+    *global_variable_sections = _global_variable_sections;
+    *count = 3;
+}
+
+metadata_table_t global_vars_metadata_table = {
+    sizeof(metadata_table_t), _get_programs, _get_maps, _get_hash, _get_version, _get_map_initial_values, _get_map_data, _get_global_variable_sections};
@@ -93,7 +93,7 @@ lookup_update(void* context)
 #line 52 "sample/undocked/inner_map.c"
     // Prologue
 #line 52 "sample/undocked/inner_map.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[2];
 #line 52 "sample/undocked/inner_map.c"
     register uint64_t r0 = 0;
 #line 52 "sample/undocked/inner_map.c"
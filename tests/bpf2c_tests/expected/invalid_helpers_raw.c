@@ -130,7 +130,7 @@ BindMonitor(void* context)
 #line 128 "sample/unsafe/invalid_helpers.c"
     // Prologue
 #line 128 "sample/unsafe/invalid_helpers.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 128 "sample/unsafe/invalid_helpers.c"
     register uint64_t r0 = 0;
 #line 128 "sample/unsafe/invalid_helpers.c"
@@ -239,7 +239,7 @@ BindMonitor_Callee0(void* context)
 #line 144 "sample/unsafe/invalid_helpers.c"
     // Prologue
 #line 144 "sample/unsafe/invalid_helpers.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 144 "sample/unsafe/invalid_helpers.c"
     register uint64_t r0 = 0;
 #line 144 "sample/unsafe/invalid_helpers.c"
@@ -350,7 +350,7 @@ BindMonitor_Callee1(void* context)
 #line 160 "sample/unsafe/invalid_helpers.c"
     // Prologue
 #line 160 "sample/unsafe/invalid_helpers.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[11];
 #line 160 "sample/unsafe/invalid_helpers.c"
     register uint64_t r0 = 0;
 #line 160 "sample/unsafe/invalid_helpers.c"
@@ -74,7 +74,7 @@ BindMonitor(void* context)
 #line 52 "sample/unsafe/invalid_maps3.c"
     // Prologue
 #line 52 "sample/unsafe/invalid_maps3.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 52 "sample/unsafe/invalid_maps3.c"
     register uint64_t r0 = 0;
 #line 52 "sample/unsafe/invalid_maps3.c"
@@ -227,7 +227,7 @@ lookup(void* context)
 #line 36 "sample/undocked/map_in_map_btf.c"
     // Prologue
 #line 36 "sample/undocked/map_in_map_btf.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 36 "sample/undocked/map_in_map_btf.c"
     register uint64_t r0 = 0;
 #line 36 "sample/undocked/map_in_map_btf.c"
@@ -66,7 +66,7 @@ lookup(void* context)
 #line 30 "sample/undocked/map_in_map_legacy_idx.c"
     // Prologue
 #line 30 "sample/undocked/map_in_map_legacy_idx.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 30 "sample/undocked/map_in_map_legacy_idx.c"
     register uint64_t r0 = 0;
 #line 30 "sample/undocked/map_in_map_legacy_idx.c"
@@ -156,7 +156,7 @@ test_maps(void* context)
 #line 290 "sample/undocked/map.c"
     // Prologue
 #line 290 "sample/undocked/map.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[9];
 #line 290 "sample/undocked/map.c"
     register uint64_t r0 = 0;
 #line 290 "sample/undocked/map.c"
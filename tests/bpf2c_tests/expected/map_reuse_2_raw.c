@@ -82,7 +82,7 @@ lookup_update(void* context)
 #line 50 "sample/undocked/map_reuse_2.c"
     // Prologue
 #line 50 "sample/undocked/map_reuse_2.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[2];
 #line 50 "sample/undocked/map_reuse_2.c"
     register uint64_t r0 = 0;
 #line 50 "sample/undocked/map_reuse_2.c"
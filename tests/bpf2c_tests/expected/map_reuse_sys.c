@@ -243,7 +243,7 @@ lookup_update(void* context)
 #line 49 "sample/undocked/map_reuse.c"
     // Prologue
 #line 49 "sample/undocked/map_reuse.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[2];
 #line 49 "sample/undocked/map_reuse.c"
     register uint64_t r0 = 0;
 #line 49 "sample/undocked/map_reuse.c"
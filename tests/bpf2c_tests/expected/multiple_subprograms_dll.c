@@ -0,0 +1,190 @@
+// Copyright (c) eBPF for Windows contributors
+// SPDX-License-Identifier: MIT
+
+// Do not alter this generated file.
+// This file was generated from multiple_subprograms.o
+
+#include "bpf2c.h"
+
+#include <stdio.h>
+#define WIN32_LEAN_AND_MEAN // Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+
+#define metadata_table multiple_subprograms##_metadata_table
+extern metadata_table_t metadata_table;
+
+bool APIENTRY
+DllMain(_In_ HMODULE hModule, unsigned int ul_reason_for_call, _In_ void* lpReserved)
+{
+    UNREFERENCED_PARAMETER(hModule);
+    UNREFERENCED_PARAMETER(lpReserved);
+    switch (ul_reason_for_call) {
+    case DLL_PROCESS_ATTACH:
+    case DLL_THREAD_ATTACH:
+    case DLL_THREAD_DETACH:
+    case DLL_PROCESS_DETACH:
+        break;
+    }
+    return TRUE;
+}
+
+__declspec(dllexport) metadata_table_t* get_metadata_table() { return &metadata_table; }
+
+#include "bpf2c.h"
+
+static void
+_get_hash(_Outptr_result_buffer_maybenull_(*size) const uint8_t** hash, _Out_ size_t* size)
+{
+    *hash = NULL;
+    *size = 0;
+}
+static void
+_get_maps(_Outptr_result_buffer_maybenull_(*count) map_entry_t** maps, _Out_ size_t* count)
+{
+    *maps = NULL;
+    *count = 0;
+}
+
+static GUID multiple_subprograms_program_type_guid = {
+    0xf788ef4a, 0x207d, 0x4dc3, {0x85, 0xcf, 0x0f, 0x2e, 0xa1, 0x07, 0x21, 0x3c}};
+static GUID multiple_subprograms_attach_type_guid = {
+    0xf788ef4b, 0x207d, 0x4dc3, {0x85, 0xcf, 0x0f, 0x2e, 0xa1, 0x07, 0x21, 0x3c}};
+#pragma code_seg(push, "sample~1")
+static uint64_t
+multiple_subprograms_subprogram_8(uint64_t r1, uint64_t r2, uint64_t r3, uint64_t r4, uint64_t r5);
+static uint64_t
+multiple_subprograms_subprogram_17(uint64_t r1, uint64_t r2, uint64_t r3, uint64_t r4, uint64_t r5);
+
+static uint64_t
+multiple_subprograms(void* context)
+{
+    // Prologue
+    uint64_t stack[1];
+    register uint64_t r0 = 0;
+    register uint64_t r1 = 0;
+    register uint64_t r2 = 0;
+    register uint64_t r3 = 0;
+    register uint64_t r4 = 0;
+    register uint64_t r5 = 0;
+    register uint64_t r6 = 0;
+    register uint64_t r10 = 0;
+
+    r1 = (uintptr_t)context;
+    r10 = (uintptr_t)((uint8_t*)stack + sizeof(stack));
+
+    // EBPF_OP_LDXH pc=0 dst=r2 src=r1 offset=20 imm=0
+    r2 = *(uint16_t*)(uintptr_t)(r1 + OFFSET(20));
+    // EBPF_OP_LDXW pc=1 dst=r1 src=r1 offset=16 imm=0
+    r1 = *(uint32_t*)(uintptr_t)(r1 + OFFSET(16));
+    // EBPF_OP_CALL pc=2 dst=r0 src=r1 offset=0 imm=5
+    r0 = multiple_subprograms_subprogram_8(r1, r2, r3, r4, r5);
+    // EBPF_OP_MOV64_REG pc=3 dst=r6 src=r0 offset=0 imm=0
+    r6 = r0;
+    // EBPF_OP_MOV64_IMM pc=4 dst=r1 src=r0 offset=0 imm=3
+    r1 = IMMEDIATE(3);
+    // EBPF_OP_CALL pc=5 dst=r0 src=r1 offset=0 imm=11
+    r0 = multiple_subprograms_subprogram_17(r1, r2, r3, r4, r5);
+    // EBPF_OP_ADD64_REG pc=6 dst=r0 src=r6 offset=0 imm=0
+    r0 += r6;
+    // EBPF_OP_EXIT pc=7 dst=r0 src=r0 offset=0 imm=0
+    return r0;
+}
+
+static uint64_t
+multiple_subprograms_subprogram_8(uint64_t r1, uint64_t r2, uint64_t r3, uint64_t r4, uint64_t r5)
+{
+    // Prologue
+    uint64_t stack[1];
+    register uint64_t r0 = 0;
+    register uint64_t r6 = 0;
+    register uint64_t r10 = 0;
+
+    r10 = (uintptr_t)((uint8_t*)stack + sizeof(stack));
+
+    // EBPF_OP_STXW pc=8 dst=r10 src=r1 offset=-8 imm=0
+    *(uint32_t*)(uintptr_t)(r10 + OFFSET(-8)) = (uint32_t)r1;
+    // EBPF_OP_STXW pc=9 dst=r10 src=r2 offset=-4 imm=0
+    *(uint32_t*)(uintptr_t)(r10 + OFFSET(-4)) = (uint32_t)r2;
+    // EBPF_OP_LDXW pc=10 dst=r1 src=r10 offset=-8 imm=0
+    r1 = *(uint32_t*)(uintptr_t)(r10 + OFFSET(-8));
+    // EBPF_OP_CALL pc=11 dst=r0 src=r1 offset=0 imm=5
+    r0 = multiple_subprograms_subprogram_17(r1, r2, r3, r4, r5);
+    // EBPF_OP_MOV64_REG pc=12 dst=r6 src=r0 offset=0 imm=0
+    r6 = r0;
+    // EBPF_OP_LDXW pc=13 dst=r1 src=r10 offset=-4 imm=0
+    r1 = *(uint32_t*)(uintptr_t)(r10 + OFFSET(-4));
+    // EBPF_OP_CALL pc=14 dst=r0 src=r1 offset=0 imm=2
+    r0 = multiple_subprograms_subprogram_17(r1, r2, r3, r4, r5);
+    // EBPF_OP_ADD64_REG pc=15 dst=r0 src=r6 offset=0 imm=0
+    r0 += r6;
+    // EBPF_OP_EXIT pc=16 dst=r0 src=r0 offset=0 imm=0
+    return r0;
+}
+
+static uint64_t
+multiple_subprograms_subprogram_17(uint64_t r1, uint64_t r2, uint64_t r3, uint64_t r4, uint64_t r5)
+{
+    // Prologue
+    uint64_t stack[1];
+    register uint64_t r0 = 0;
+    register uint64_t r10 = 0;
+
+    (void)r2;
+    (void)r3;
+    (void)r4;
+    (void)r5;
+    r10 = (uintptr_t)((uint8_t*)stack + sizeof(stack));
+
+    // EBPF_OP_MOV64_REG pc=17 dst=r0 src=r1 offset=0 imm=0
+    r0 = r1;
+    // EBPF_OP_MUL64_REG pc=18 dst=r0 src=r0 offset=0 imm=0
+    r0 *= r0;
+    // EBPF_OP_EXIT pc=19 dst=r0 src=r0 offset=0 imm=0
+    return r0;
+}
+#pragma code_seg(pop)
+#line __LINE__ __FILE__
+
+#pragma data_seg(push, "programs")
+static program_entry_t _programs[] = {
+    {
+        0,
+        multiple_subprograms,
+        "sample~1",
+        "sample_ext",
+        "multiple_subprograms",
+        NULL,
+        0,
+        NULL,
+        0,
+        20,
+        &multiple_subprograms_program_type_guid,
+        &multiple_subprograms_attach_type_guid,
+    },
+};
+#pragma data_seg(pop)
+
+static void
+_get_programs(_Outptr_result_buffer_(*count) program_entry_t** programs, _Out_ size_t* count)
+{
+    *programs = _programs;
+    *count = 1;
+}
+
+static void
+_get_version(_Out_ bpf2c_version_t* version)
+{
+    version->major = 0;
+    version->minor = 17;
+    version->revision = 0;
+}
+
+static void
+_get_map_initial_values(_Outptr_result_buffer_(*count) map_initial_values_t** map_initial_values, _Out_ size_t* count)
+{
+    *map_initial_values = NULL;
+    *count = 0;
+}
+
+metadata_table_t multiple_subprograms_metadata_table = {
+    sizeof(metadata_table_t), _get_programs, _get_maps, _get_hash, _get_version, _get_map_initial_values};
@@ -81,7 +81,7 @@ func(void* context)
 #line 34 "sample/pidtgid.c"
     // Prologue
 #line 34 "sample/pidtgid.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[3];
 #line 34 "sample/pidtgid.c"
     register uint64_t r0 = 0;
 #line 34 "sample/pidtgid.c"
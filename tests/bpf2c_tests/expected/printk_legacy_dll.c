@@ -62,7 +62,7 @@ func(void* context)
 #line 26 "sample/printk_legacy.c"
     // Prologue
 #line 26 "sample/printk_legacy.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 26 "sample/printk_legacy.c"
     register uint64_t r0 = 0;
 #line 26 "sample/printk_legacy.c"
@@ -198,7 +198,7 @@ func(void* context)
 #line 18 "sample/printk.c"
     // Prologue
 #line 18 "sample/printk.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 18 "sample/printk.c"
     register uint64_t r0 = 0;
 #line 18 "sample/printk.c"
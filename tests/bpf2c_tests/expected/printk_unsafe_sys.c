@@ -194,7 +194,7 @@ func(void* context)
 #line 18 "sample/unsafe/printk_unsafe.c"
     // Prologue
 #line 18 "sample/unsafe/printk_unsafe.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 18 "sample/unsafe/printk_unsafe.c"
     register uint64_t r0 = 0;
 #line 18 "sample/unsafe/printk_unsafe.c"
@@ -57,7 +57,7 @@ reflect_packet(void* context)
 #line 23 "sample/reflect_packet.c"
     // Prologue
 #line 23 "sample/reflect_packet.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[2];
 #line 23 "sample/reflect_packet.c"
     register uint64_t r0 = 0;
 #line 23 "sample/reflect_packet.c"
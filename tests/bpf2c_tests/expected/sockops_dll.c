@@ -96,7 +96,7 @@ connection_monitor(void* context)
 #line 72 "sample/sockops.c"
     // Prologue
 #line 72 "sample/sockops.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[8];
 #line 72 "sample/sockops.c"
     register uint64_t r0 = 0;
 #line 72 "sample/sockops.c"
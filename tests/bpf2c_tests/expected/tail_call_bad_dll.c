@@ -84,7 +84,7 @@ callee(void* context)
 #line 49 "sample/undocked/tail_call_bad.c"
     // Prologue
 #line 49 "sample/undocked/tail_call_bad.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 49 "sample/undocked/tail_call_bad.c"
     register uint64_t r0 = 0;
 #line 49 "sample/undocked/tail_call_bad.c"
@@ -128,7 +128,7 @@ caller(void* context)
 #line 33 "sample/undocked/tail_call_bad.c"
     // Prologue
 #line 33 "sample/undocked/tail_call_bad.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 33 "sample/undocked/tail_call_bad.c"
     register uint64_t r0 = 0;
 #line 33 "sample/undocked/tail_call_bad.c"
@@ -58,7 +58,7 @@ callee(void* context)
 #line 17 "sample/undocked/tail_call_map.c"
     // Prologue
 #line 17 "sample/undocked/tail_call_map.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 17 "sample/undocked/tail_call_map.c"
     register uint64_t r0 = 0;
 #line 17 "sample/undocked/tail_call_map.c"
@@ -101,7 +101,7 @@ caller(void* context)
 #line 40 "sample/undocked/tail_call_map.c"
     // Prologue
 #line 40 "sample/undocked/tail_call_map.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 40 "sample/undocked/tail_call_map.c"
     register uint64_t r0 = 0;
 #line 40 "sample/undocked/tail_call_map.c"
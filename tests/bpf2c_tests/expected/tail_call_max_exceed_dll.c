@@ -84,7 +84,7 @@ bind_test_callee0(void* context)
 #line 85 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 85 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 85 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 85 "sample/tail_call_max_exceed.c"
@@ -285,7 +285,7 @@ bind_test_callee1(void* context)
 #line 86 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 86 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 86 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 86 "sample/tail_call_max_exceed.c"
@@ -486,7 +486,7 @@ bind_test_callee10(void* context)
 #line 95 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 95 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 95 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 95 "sample/tail_call_max_exceed.c"
@@ -687,7 +687,7 @@ bind_test_callee11(void* context)
 #line 96 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 96 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 96 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 96 "sample/tail_call_max_exceed.c"
@@ -888,7 +888,7 @@ bind_test_callee12(void* context)
 #line 97 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 97 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 97 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 97 "sample/tail_call_max_exceed.c"
@@ -1089,7 +1089,7 @@ bind_test_callee13(void* context)
 #line 98 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 98 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 98 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 98 "sample/tail_call_max_exceed.c"
@@ -1290,7 +1290,7 @@ bind_test_callee14(void* context)
 #line 99 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 99 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 99 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 99 "sample/tail_call_max_exceed.c"
@@ -1491,7 +1491,7 @@ bind_test_callee15(void* context)
 #line 100 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 100 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 100 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 100 "sample/tail_call_max_exceed.c"
@@ -1692,7 +1692,7 @@ bind_test_callee16(void* context)
 #line 101 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 101 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 101 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 101 "sample/tail_call_max_exceed.c"
@@ -1893,7 +1893,7 @@ bind_test_callee17(void* context)
 #line 102 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 102 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 102 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 102 "sample/tail_call_max_exceed.c"
@@ -2094,7 +2094,7 @@ bind_test_callee18(void* context)
 #line 103 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 103 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 103 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 103 "sample/tail_call_max_exceed.c"
@@ -2295,7 +2295,7 @@ bind_test_callee19(void* context)
 #line 104 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 104 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 104 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 104 "sample/tail_call_max_exceed.c"
@@ -2496,7 +2496,7 @@ bind_test_callee2(void* context)
 #line 87 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 87 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 87 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 87 "sample/tail_call_max_exceed.c"
@@ -2697,7 +2697,7 @@ bind_test_callee20(void* context)
 #line 105 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 105 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 105 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 105 "sample/tail_call_max_exceed.c"
@@ -2898,7 +2898,7 @@ bind_test_callee21(void* context)
 #line 106 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 106 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 106 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 106 "sample/tail_call_max_exceed.c"
@@ -3099,7 +3099,7 @@ bind_test_callee22(void* context)
 #line 107 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 107 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 107 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 107 "sample/tail_call_max_exceed.c"
@@ -3300,7 +3300,7 @@ bind_test_callee23(void* context)
 #line 108 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 108 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 108 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 108 "sample/tail_call_max_exceed.c"
@@ -3501,7 +3501,7 @@ bind_test_callee24(void* context)
 #line 109 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 109 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 109 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 109 "sample/tail_call_max_exceed.c"
@@ -3702,7 +3702,7 @@ bind_test_callee25(void* context)
 #line 110 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 110 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 110 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 110 "sample/tail_call_max_exceed.c"
@@ -3903,7 +3903,7 @@ bind_test_callee26(void* context)
 #line 111 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 111 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 111 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 111 "sample/tail_call_max_exceed.c"
@@ -4104,7 +4104,7 @@ bind_test_callee27(void* context)
 #line 112 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 112 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 112 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 112 "sample/tail_call_max_exceed.c"
@@ -4305,7 +4305,7 @@ bind_test_callee28(void* context)
 #line 113 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 113 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 113 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 113 "sample/tail_call_max_exceed.c"
@@ -4506,7 +4506,7 @@ bind_test_callee29(void* context)
 #line 114 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 114 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 114 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 114 "sample/tail_call_max_exceed.c"
@@ -4707,7 +4707,7 @@ bind_test_callee3(void* context)
 #line 88 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 88 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 88 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 88 "sample/tail_call_max_exceed.c"
@@ -4908,7 +4908,7 @@ bind_test_callee30(void* context)
 #line 115 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 115 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 115 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 115 "sample/tail_call_max_exceed.c"
@@ -5109,7 +5109,7 @@ bind_test_callee31(void* context)
 #line 116 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 116 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 116 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 116 "sample/tail_call_max_exceed.c"
@@ -5310,7 +5310,7 @@ bind_test_callee32(void* context)
 #line 117 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 117 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 117 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 117 "sample/tail_call_max_exceed.c"
@@ -5511,7 +5511,7 @@ bind_test_callee33(void* context)
 #line 118 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 118 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 118 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 118 "sample/tail_call_max_exceed.c"
@@ -5706,7 +5706,7 @@ bind_test_callee34(void* context)
 #line 136 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 136 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 136 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 136 "sample/tail_call_max_exceed.c"
@@ -5814,7 +5814,7 @@ bind_test_callee4(void* context)
 #line 89 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 89 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 89 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 89 "sample/tail_call_max_exceed.c"
@@ -6015,7 +6015,7 @@ bind_test_callee5(void* context)
 #line 90 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 90 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 90 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 90 "sample/tail_call_max_exceed.c"
@@ -6216,7 +6216,7 @@ bind_test_callee6(void* context)
 #line 91 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 91 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 91 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 91 "sample/tail_call_max_exceed.c"
@@ -6417,7 +6417,7 @@ bind_test_callee7(void* context)
 #line 92 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 92 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 92 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 92 "sample/tail_call_max_exceed.c"
@@ -6618,7 +6618,7 @@ bind_test_callee8(void* context)
 #line 93 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 93 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 93 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 93 "sample/tail_call_max_exceed.c"
@@ -6819,7 +6819,7 @@ bind_test_callee9(void* context)
 #line 94 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 94 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 94 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 94 "sample/tail_call_max_exceed.c"
@@ -7020,7 +7020,7 @@ bind_test_caller(void* context)
 #line 124 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 124 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[5];
 #line 124 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 124 "sample/tail_call_max_exceed.c"
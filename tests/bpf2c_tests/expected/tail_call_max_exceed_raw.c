@@ -58,7 +58,7 @@ bind_test_callee0(void* context)
 #line 85 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 85 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 85 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 85 "sample/tail_call_max_exceed.c"
@@ -259,7 +259,7 @@ bind_test_callee1(void* context)
 #line 86 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 86 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 86 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 86 "sample/tail_call_max_exceed.c"
@@ -460,7 +460,7 @@ bind_test_callee10(void* context)
 #line 95 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 95 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 95 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 95 "sample/tail_call_max_exceed.c"
@@ -661,7 +661,7 @@ bind_test_callee11(void* context)
 #line 96 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 96 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 96 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 96 "sample/tail_call_max_exceed.c"
@@ -862,7 +862,7 @@ bind_test_callee12(void* context)
 #line 97 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 97 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 97 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 97 "sample/tail_call_max_exceed.c"
@@ -1063,7 +1063,7 @@ bind_test_callee13(void* context)
 #line 98 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 98 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 98 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 98 "sample/tail_call_max_exceed.c"
@@ -1264,7 +1264,7 @@ bind_test_callee14(void* context)
 #line 99 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 99 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 99 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 99 "sample/tail_call_max_exceed.c"
@@ -1465,7 +1465,7 @@ bind_test_callee15(void* context)
 #line 100 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 100 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 100 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 100 "sample/tail_call_max_exceed.c"
@@ -1666,7 +1666,7 @@ bind_test_callee16(void* context)
 #line 101 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 101 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 101 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 101 "sample/tail_call_max_exceed.c"
@@ -1867,7 +1867,7 @@ bind_test_callee17(void* context)
 #line 102 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 102 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 102 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 102 "sample/tail_call_max_exceed.c"
@@ -2068,7 +2068,7 @@ bind_test_callee18(void* context)
 #line 103 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 103 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 103 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 103 "sample/tail_call_max_exceed.c"
@@ -2269,7 +2269,7 @@ bind_test_callee19(void* context)
 #line 104 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 104 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 104 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 104 "sample/tail_call_max_exceed.c"
@@ -2470,7 +2470,7 @@ bind_test_callee2(void* context)
 #line 87 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 87 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 87 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 87 "sample/tail_call_max_exceed.c"
@@ -2671,7 +2671,7 @@ bind_test_callee20(void* context)
 #line 105 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 105 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 105 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 105 "sample/tail_call_max_exceed.c"
@@ -2872,7 +2872,7 @@ bind_test_callee21(void* context)
 #line 106 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 106 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 106 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 106 "sample/tail_call_max_exceed.c"
@@ -3073,7 +3073,7 @@ bind_test_callee22(void* context)
 #line 107 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 107 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 107 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 107 "sample/tail_call_max_exceed.c"
@@ -3274,7 +3274,7 @@ bind_test_callee23(void* context)
 #line 108 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 108 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 108 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 108 "sample/tail_call_max_exceed.c"
@@ -3475,7 +3475,7 @@ bind_test_callee24(void* context)
 #line 109 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 109 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 109 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 109 "sample/tail_call_max_exceed.c"
@@ -3676,7 +3676,7 @@ bind_test_callee25(void* context)
 #line 110 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 110 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 110 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 110 "sample/tail_call_max_exceed.c"
@@ -3877,7 +3877,7 @@ bind_test_callee26(void* context)
 #line 111 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 111 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 111 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 111 "sample/tail_call_max_exceed.c"
@@ -4078,7 +4078,7 @@ bind_test_callee27(void* context)
 #line 112 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 112 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 112 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 112 "sample/tail_call_max_exceed.c"
@@ -4279,7 +4279,7 @@ bind_test_callee28(void* context)
 #line 113 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 113 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 113 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 113 "sample/tail_call_max_exceed.c"
@@ -4480,7 +4480,7 @@ bind_test_callee29(void* context)
 #line 114 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 114 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 114 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 114 "sample/tail_call_max_exceed.c"
@@ -4681,7 +4681,7 @@ bind_test_callee3(void* context)
 #line 88 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 88 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 88 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 88 "sample/tail_call_max_exceed.c"
@@ -4882,7 +4882,7 @@ bind_test_callee30(void* context)
 #line 115 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 115 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 115 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 115 "sample/tail_call_max_exceed.c"
@@ -5083,7 +5083,7 @@ bind_test_callee31(void* context)
 #line 116 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 116 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 116 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 116 "sample/tail_call_max_exceed.c"
@@ -5284,7 +5284,7 @@ bind_test_callee32(void* context)
 #line 117 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 117 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 117 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 117 "sample/tail_call_max_exceed.c"
@@ -5485,7 +5485,7 @@ bind_test_callee33(void* context)
 #line 118 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 118 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 118 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 118 "sample/tail_call_max_exceed.c"
@@ -5680,7 +5680,7 @@ bind_test_callee34(void* context)
 #line 136 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 136 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 136 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 136 "sample/tail_call_max_exceed.c"
@@ -5788,7 +5788,7 @@ bind_test_callee4(void* context)
 #line 89 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 89 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 89 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 89 "sample/tail_call_max_exceed.c"
@@ -5989,7 +5989,7 @@ bind_test_callee5(void* context)
 #line 90 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 90 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 90 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 90 "sample/tail_call_max_exceed.c"
@@ -6190,7 +6190,7 @@ bind_test_callee6(void* context)
 #line 91 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 91 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 91 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 91 "sample/tail_call_max_exceed.c"
@@ -6391,7 +6391,7 @@ bind_test_callee7(void* context)
 #line 92 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 92 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 92 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 92 "sample/tail_call_max_exceed.c"
@@ -6592,7 +6592,7 @@ bind_test_callee8(void* context)
 #line 93 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 93 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 93 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 93 "sample/tail_call_max_exceed.c"
@@ -6793,7 +6793,7 @@ bind_test_callee9(void* context)
 #line 94 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 94 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 94 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 94 "sample/tail_call_max_exceed.c"
@@ -6994,7 +6994,7 @@ bind_test_caller(void* context)
 #line 124 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 124 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[5];
 #line 124 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 124 "sample/tail_call_max_exceed.c"
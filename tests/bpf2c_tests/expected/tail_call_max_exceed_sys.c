@@ -219,7 +219,7 @@ bind_test_callee0(void* context)
 #line 85 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 85 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 85 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 85 "sample/tail_call_max_exceed.c"
@@ -420,7 +420,7 @@ bind_test_callee1(void* context)
 #line 86 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 86 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 86 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 86 "sample/tail_call_max_exceed.c"
@@ -621,7 +621,7 @@ bind_test_callee10(void* context)
 #line 95 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 95 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 95 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 95 "sample/tail_call_max_exceed.c"
@@ -822,7 +822,7 @@ bind_test_callee11(void* context)
 #line 96 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 96 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 96 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 96 "sample/tail_call_max_exceed.c"
@@ -1023,7 +1023,7 @@ bind_test_callee12(void* context)
 #line 97 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 97 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 97 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 97 "sample/tail_call_max_exceed.c"
@@ -1224,7 +1224,7 @@ bind_test_callee13(void* context)
 #line 98 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 98 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 98 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 98 "sample/tail_call_max_exceed.c"
@@ -1425,7 +1425,7 @@ bind_test_callee14(void* context)
 #line 99 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 99 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 99 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 99 "sample/tail_call_max_exceed.c"
@@ -1626,7 +1626,7 @@ bind_test_callee15(void* context)
 #line 100 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 100 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 100 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 100 "sample/tail_call_max_exceed.c"
@@ -1827,7 +1827,7 @@ bind_test_callee16(void* context)
 #line 101 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 101 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 101 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 101 "sample/tail_call_max_exceed.c"
@@ -2028,7 +2028,7 @@ bind_test_callee17(void* context)
 #line 102 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 102 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 102 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 102 "sample/tail_call_max_exceed.c"
@@ -2229,7 +2229,7 @@ bind_test_callee18(void* context)
 #line 103 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 103 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 103 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 103 "sample/tail_call_max_exceed.c"
@@ -2430,7 +2430,7 @@ bind_test_callee19(void* context)
 #line 104 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 104 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 104 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 104 "sample/tail_call_max_exceed.c"
@@ -2631,7 +2631,7 @@ bind_test_callee2(void* context)
 #line 87 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 87 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 87 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 87 "sample/tail_call_max_exceed.c"
@@ -2832,7 +2832,7 @@ bind_test_callee20(void* context)
 #line 105 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 105 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 105 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 105 "sample/tail_call_max_exceed.c"
@@ -3033,7 +3033,7 @@ bind_test_callee21(void* context)
 #line 106 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 106 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 106 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 106 "sample/tail_call_max_exceed.c"
@@ -3234,7 +3234,7 @@ bind_test_callee22(void* context)
 #line 107 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 107 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 107 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 107 "sample/tail_call_max_exceed.c"
@@ -3435,7 +3435,7 @@ bind_test_callee23(void* context)
 #line 108 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 108 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 108 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 108 "sample/tail_call_max_exceed.c"
@@ -3636,7 +3636,7 @@ bind_test_callee24(void* context)
 #line 109 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 109 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 109 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 109 "sample/tail_call_max_exceed.c"
@@ -3837,7 +3837,7 @@ bind_test_callee25(void* context)
 #line 110 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 110 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 110 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 110 "sample/tail_call_max_exceed.c"
@@ -4038,7 +4038,7 @@ bind_test_callee26(void* context)
 #line 111 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 111 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 111 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 111 "sample/tail_call_max_exceed.c"
@@ -4239,7 +4239,7 @@ bind_test_callee27(void* context)
 #line 112 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 112 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 112 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 112 "sample/tail_call_max_exceed.c"
@@ -4440,7 +4440,7 @@ bind_test_callee28(void* context)
 #line 113 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 113 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 113 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 113 "sample/tail_call_max_exceed.c"
@@ -4641,7 +4641,7 @@ bind_test_callee29(void* context)
 #line 114 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 114 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 114 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 114 "sample/tail_call_max_exceed.c"
@@ -4842,7 +4842,7 @@ bind_test_callee3(void* context)
 #line 88 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 88 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 88 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 88 "sample/tail_call_max_exceed.c"
@@ -5043,7 +5043,7 @@ bind_test_callee30(void* context)
 #line 115 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 115 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 115 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 115 "sample/tail_call_max_exceed.c"
@@ -5244,7 +5244,7 @@ bind_test_callee31(void* context)
 #line 116 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 116 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 116 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 116 "sample/tail_call_max_exceed.c"
@@ -5445,7 +5445,7 @@ bind_test_callee32(void* context)
 #line 117 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 117 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 117 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 117 "sample/tail_call_max_exceed.c"
@@ -5646,7 +5646,7 @@ bind_test_callee33(void* context)
 #line 118 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 118 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 118 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 118 "sample/tail_call_max_exceed.c"
@@ -5841,7 +5841,7 @@ bind_test_callee34(void* context)
 #line 136 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 136 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 136 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 136 "sample/tail_call_max_exceed.c"
@@ -5949,7 +5949,7 @@ bind_test_callee4(void* context)
 #line 89 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 89 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 89 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 89 "sample/tail_call_max_exceed.c"
@@ -6150,7 +6150,7 @@ bind_test_callee5(void* context)
 #line 90 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 90 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 90 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 90 "sample/tail_call_max_exceed.c"
@@ -6351,7 +6351,7 @@ bind_test_callee6(void* context)
 #line 91 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 91 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 91 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 91 "sample/tail_call_max_exceed.c"
@@ -6552,7 +6552,7 @@ bind_test_callee7(void* context)
 #line 92 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 92 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 92 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 92 "sample/tail_call_max_exceed.c"
@@ -6753,7 +6753,7 @@ bind_test_callee8(void* context)
 #line 93 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 93 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 93 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 93 "sample/tail_call_max_exceed.c"
@@ -6954,7 +6954,7 @@ bind_test_callee9(void* context)
 #line 94 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 94 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 94 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 94 "sample/tail_call_max_exceed.c"
@@ -7155,7 +7155,7 @@ bind_test_caller(void* context)
 #line 124 "sample/tail_call_max_exceed.c"
     // Prologue
 #line 124 "sample/tail_call_max_exceed.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[5];
 #line 124 "sample/tail_call_max_exceed.c"
     register uint64_t r0 = 0;
 #line 124 "sample/tail_call_max_exceed.c"
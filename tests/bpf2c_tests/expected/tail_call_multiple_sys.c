@@ -215,7 +215,7 @@ callee0(void* context)
 #line 41 "sample/undocked/tail_call_multiple.c"
     // Prologue
 #line 41 "sample/undocked/tail_call_multiple.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 41 "sample/undocked/tail_call_multiple.c"
     register uint64_t r0 = 0;
 #line 41 "sample/undocked/tail_call_multiple.c"
@@ -272,7 +272,7 @@ callee1(void* context)
 #line 47 "sample/undocked/tail_call_multiple.c"
     // Prologue
 #line 47 "sample/undocked/tail_call_multiple.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 47 "sample/undocked/tail_call_multiple.c"
     register uint64_t r0 = 0;
 #line 47 "sample/undocked/tail_call_multiple.c"
@@ -314,7 +314,7 @@ caller(void* context)
 #line 30 "sample/undocked/tail_call_multiple.c"
     // Prologue
 #line 30 "sample/undocked/tail_call_multiple.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 30 "sample/undocked/tail_call_multiple.c"
     register uint64_t r0 = 0;
 #line 30 "sample/undocked/tail_call_multiple.c"
@@ -69,7 +69,7 @@ recurse(void* context)
 #line 45 "sample/undocked/tail_call_recursive.c"
     // Prologue
 #line 45 "sample/undocked/tail_call_recursive.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[3];
 #line 45 "sample/undocked/tail_call_recursive.c"
     register uint64_t r0 = 0;
 #line 45 "sample/undocked/tail_call_recursive.c"
@@ -66,7 +66,7 @@ callee(void* context)
 #line 33 "sample/undocked/tail_call_same_section.c"
     // Prologue
 #line 33 "sample/undocked/tail_call_same_section.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 33 "sample/undocked/tail_call_same_section.c"
     register uint64_t r0 = 0;
 #line 33 "sample/undocked/tail_call_same_section.c"
@@ -156,7 +156,7 @@ caller(void* context)
 #line 33 "sample/undocked/tail_call_same_section.c"
     // Prologue
 #line 33 "sample/undocked/tail_call_same_section.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 33 "sample/undocked/tail_call_same_section.c"
     register uint64_t r0 = 0;
 #line 33 "sample/undocked/tail_call_same_section.c"
@@ -97,7 +97,7 @@ sequential0(void* context)
 #line 133 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 133 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 133 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 133 "sample/undocked/tail_call_sequential.c"
@@ -275,7 +275,7 @@ sequential1(void* context)
 #line 134 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 134 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 134 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 134 "sample/undocked/tail_call_sequential.c"
@@ -453,7 +453,7 @@ sequential10(void* context)
 #line 143 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 143 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 143 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 143 "sample/undocked/tail_call_sequential.c"
@@ -636,7 +636,7 @@ sequential11(void* context)
 #line 144 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 144 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 144 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 144 "sample/undocked/tail_call_sequential.c"
@@ -819,7 +819,7 @@ sequential12(void* context)
 #line 145 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 145 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 145 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 145 "sample/undocked/tail_call_sequential.c"
@@ -1002,7 +1002,7 @@ sequential13(void* context)
 #line 146 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 146 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 146 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 146 "sample/undocked/tail_call_sequential.c"
@@ -1185,7 +1185,7 @@ sequential14(void* context)
 #line 147 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 147 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 147 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 147 "sample/undocked/tail_call_sequential.c"
@@ -1368,7 +1368,7 @@ sequential15(void* context)
 #line 148 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 148 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 148 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 148 "sample/undocked/tail_call_sequential.c"
@@ -1551,7 +1551,7 @@ sequential16(void* context)
 #line 149 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 149 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 149 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 149 "sample/undocked/tail_call_sequential.c"
@@ -1734,7 +1734,7 @@ sequential17(void* context)
 #line 150 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 150 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 150 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 150 "sample/undocked/tail_call_sequential.c"
@@ -1917,7 +1917,7 @@ sequential18(void* context)
 #line 151 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 151 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 151 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 151 "sample/undocked/tail_call_sequential.c"
@@ -2100,7 +2100,7 @@ sequential19(void* context)
 #line 152 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 152 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 152 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 152 "sample/undocked/tail_call_sequential.c"
@@ -2283,7 +2283,7 @@ sequential2(void* context)
 #line 135 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 135 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 135 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 135 "sample/undocked/tail_call_sequential.c"
@@ -2461,7 +2461,7 @@ sequential20(void* context)
 #line 153 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 153 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 153 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 153 "sample/undocked/tail_call_sequential.c"
@@ -2644,7 +2644,7 @@ sequential21(void* context)
 #line 154 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 154 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 154 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 154 "sample/undocked/tail_call_sequential.c"
@@ -2827,7 +2827,7 @@ sequential22(void* context)
 #line 155 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 155 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 155 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 155 "sample/undocked/tail_call_sequential.c"
@@ -3010,7 +3010,7 @@ sequential23(void* context)
 #line 156 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 156 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 156 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 156 "sample/undocked/tail_call_sequential.c"
@@ -3193,7 +3193,7 @@ sequential24(void* context)
 #line 157 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 157 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 157 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 157 "sample/undocked/tail_call_sequential.c"
@@ -3376,7 +3376,7 @@ sequential25(void* context)
 #line 158 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 158 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 158 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 158 "sample/undocked/tail_call_sequential.c"
@@ -3559,7 +3559,7 @@ sequential26(void* context)
 #line 159 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 159 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 159 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 159 "sample/undocked/tail_call_sequential.c"
@@ -3742,7 +3742,7 @@ sequential27(void* context)
 #line 160 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 160 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 160 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 160 "sample/undocked/tail_call_sequential.c"
@@ -3925,7 +3925,7 @@ sequential28(void* context)
 #line 161 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 161 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 161 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 161 "sample/undocked/tail_call_sequential.c"
@@ -4108,7 +4108,7 @@ sequential29(void* context)
 #line 162 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 162 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 162 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 162 "sample/undocked/tail_call_sequential.c"
@@ -4291,7 +4291,7 @@ sequential3(void* context)
 #line 136 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 136 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 136 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 136 "sample/undocked/tail_call_sequential.c"
@@ -4469,7 +4469,7 @@ sequential30(void* context)
 #line 163 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 163 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 163 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 163 "sample/undocked/tail_call_sequential.c"
@@ -4652,7 +4652,7 @@ sequential31(void* context)
 #line 164 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 164 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 164 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 164 "sample/undocked/tail_call_sequential.c"
@@ -4835,7 +4835,7 @@ sequential32(void* context)
 #line 165 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 165 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 165 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 165 "sample/undocked/tail_call_sequential.c"
@@ -5018,7 +5018,7 @@ sequential33(void* context)
 #line 166 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 166 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 166 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 166 "sample/undocked/tail_call_sequential.c"
@@ -5201,7 +5201,7 @@ sequential34(void* context)
 #line 167 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 167 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 167 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 167 "sample/undocked/tail_call_sequential.c"
@@ -5384,7 +5384,7 @@ sequential4(void* context)
 #line 137 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 137 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 137 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 137 "sample/undocked/tail_call_sequential.c"
@@ -5562,7 +5562,7 @@ sequential5(void* context)
 #line 138 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 138 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 138 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 138 "sample/undocked/tail_call_sequential.c"
@@ -5740,7 +5740,7 @@ sequential6(void* context)
 #line 139 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 139 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 139 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 139 "sample/undocked/tail_call_sequential.c"
@@ -5918,7 +5918,7 @@ sequential7(void* context)
 #line 140 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 140 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 140 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 140 "sample/undocked/tail_call_sequential.c"
@@ -6096,7 +6096,7 @@ sequential8(void* context)
 #line 141 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 141 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 141 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 141 "sample/undocked/tail_call_sequential.c"
@@ -6274,7 +6274,7 @@ sequential9(void* context)
 #line 142 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 142 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 142 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 142 "sample/undocked/tail_call_sequential.c"
@@ -71,7 +71,7 @@ sequential0(void* context)
 #line 133 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 133 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 133 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 133 "sample/undocked/tail_call_sequential.c"
@@ -249,7 +249,7 @@ sequential1(void* context)
 #line 134 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 134 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 134 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 134 "sample/undocked/tail_call_sequential.c"
@@ -427,7 +427,7 @@ sequential10(void* context)
 #line 143 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 143 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 143 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 143 "sample/undocked/tail_call_sequential.c"
@@ -610,7 +610,7 @@ sequential11(void* context)
 #line 144 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 144 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 144 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 144 "sample/undocked/tail_call_sequential.c"
@@ -793,7 +793,7 @@ sequential12(void* context)
 #line 145 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 145 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 145 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 145 "sample/undocked/tail_call_sequential.c"
@@ -976,7 +976,7 @@ sequential13(void* context)
 #line 146 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 146 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 146 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 146 "sample/undocked/tail_call_sequential.c"
@@ -1159,7 +1159,7 @@ sequential14(void* context)
 #line 147 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 147 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 147 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 147 "sample/undocked/tail_call_sequential.c"
@@ -1342,7 +1342,7 @@ sequential15(void* context)
 #line 148 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 148 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 148 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 148 "sample/undocked/tail_call_sequential.c"
@@ -1525,7 +1525,7 @@ sequential16(void* context)
 #line 149 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 149 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 149 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 149 "sample/undocked/tail_call_sequential.c"
@@ -1708,7 +1708,7 @@ sequential17(void* context)
 #line 150 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 150 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 150 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 150 "sample/undocked/tail_call_sequential.c"
@@ -1891,7 +1891,7 @@ sequential18(void* context)
 #line 151 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 151 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 151 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 151 "sample/undocked/tail_call_sequential.c"
@@ -2074,7 +2074,7 @@ sequential19(void* context)
 #line 152 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 152 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 152 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 152 "sample/undocked/tail_call_sequential.c"
@@ -2257,7 +2257,7 @@ sequential2(void* context)
 #line 135 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 135 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 135 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 135 "sample/undocked/tail_call_sequential.c"
@@ -2435,7 +2435,7 @@ sequential20(void* context)
 #line 153 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 153 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 153 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 153 "sample/undocked/tail_call_sequential.c"
@@ -2618,7 +2618,7 @@ sequential21(void* context)
 #line 154 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 154 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 154 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 154 "sample/undocked/tail_call_sequential.c"
@@ -2801,7 +2801,7 @@ sequential22(void* context)
 #line 155 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 155 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 155 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 155 "sample/undocked/tail_call_sequential.c"
@@ -2984,7 +2984,7 @@ sequential23(void* context)
 #line 156 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 156 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 156 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 156 "sample/undocked/tail_call_sequential.c"
@@ -3167,7 +3167,7 @@ sequential24(void* context)
 #line 157 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 157 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 157 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 157 "sample/undocked/tail_call_sequential.c"
@@ -3350,7 +3350,7 @@ sequential25(void* context)
 #line 158 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 158 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 158 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 158 "sample/undocked/tail_call_sequential.c"
@@ -3533,7 +3533,7 @@ sequential26(void* context)
 #line 159 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 159 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 159 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 159 "sample/undocked/tail_call_sequential.c"
@@ -3716,7 +3716,7 @@ sequential27(void* context)
 #line 160 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 160 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 160 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 160 "sample/undocked/tail_call_sequential.c"
@@ -3899,7 +3899,7 @@ sequential28(void* context)
 #line 161 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 161 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 161 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 161 "sample/undocked/tail_call_sequential.c"
@@ -4082,7 +4082,7 @@ sequential29(void* context)
 #line 162 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 162 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 162 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 162 "sample/undocked/tail_call_sequential.c"
@@ -4265,7 +4265,7 @@ sequential3(void* context)
 #line 136 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 136 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 136 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 136 "sample/undocked/tail_call_sequential.c"
@@ -4443,7 +4443,7 @@ sequential30(void* context)
 #line 163 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 163 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 163 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 163 "sample/undocked/tail_call_sequential.c"
@@ -4626,7 +4626,7 @@ sequential31(void* context)
 #line 164 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 164 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 164 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 164 "sample/undocked/tail_call_sequential.c"
@@ -4809,7 +4809,7 @@ sequential32(void* context)
 #line 165 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 165 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 165 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 165 "sample/undocked/tail_call_sequential.c"
@@ -4992,7 +4992,7 @@ sequential33(void* context)
 #line 166 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 166 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 166 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 166 "sample/undocked/tail_call_sequential.c"
@@ -5175,7 +5175,7 @@ sequential34(void* context)
 #line 167 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 167 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 167 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 167 "sample/undocked/tail_call_sequential.c"
@@ -5358,7 +5358,7 @@ sequential4(void* context)
 #line 137 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 137 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 137 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 137 "sample/undocked/tail_call_sequential.c"
@@ -5536,7 +5536,7 @@ sequential5(void* context)
 #line 138 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 138 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 138 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 138 "sample/undocked/tail_call_sequential.c"
@@ -5714,7 +5714,7 @@ sequential6(void* context)
 #line 139 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 139 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 139 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 139 "sample/undocked/tail_call_sequential.c"
@@ -5892,7 +5892,7 @@ sequential7(void* context)
 #line 140 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 140 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 140 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 140 "sample/undocked/tail_call_sequential.c"
@@ -6070,7 +6070,7 @@ sequential8(void* context)
 #line 141 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 141 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 141 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 141 "sample/undocked/tail_call_sequential.c"
@@ -6248,7 +6248,7 @@ sequential9(void* context)
 #line 142 "sample/undocked/tail_call_sequential.c"
     // Prologue
 #line 142 "sample/undocked/tail_call_sequential.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 142 "sample/undocked/tail_call_sequential.c"
     register uint64_t r0 = 0;
 #line 142 "sample/undocked/tail_call_sequential.c"
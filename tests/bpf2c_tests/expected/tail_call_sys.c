@@ -219,7 +219,7 @@ callee(void* context)
 #line 49 "sample/undocked/tail_call.c"
     // Prologue
 #line 49 "sample/undocked/tail_call.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 49 "sample/undocked/tail_call.c"
     register uint64_t r0 = 0;
 #line 49 "sample/undocked/tail_call.c"
@@ -263,7 +263,7 @@ caller(void* context)
 #line 33 "sample/undocked/tail_call.c"
     // Prologue
 #line 33 "sample/undocked/tail_call.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 33 "sample/undocked/tail_call.c"
     register uint64_t r0 = 0;
 #line 33 "sample/undocked/tail_call.c"
@@ -85,7 +85,7 @@ test_program_entry(void* context)
 #line 33 "sample/undocked/test_sample_ebpf.c"
     // Prologue
 #line 33 "sample/undocked/test_sample_ebpf.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[1];
 #line 33 "sample/undocked/test_sample_ebpf.c"
     register uint64_t r0 = 0;
 #line 33 "sample/undocked/test_sample_ebpf.c"
@@ -87,7 +87,7 @@ test_utility_helpers(void* context)
 #line 33 "sample/undocked/test_utility_helpers.c"
     // Prologue
 #line 33 "sample/undocked/test_utility_helpers.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[6];
 #line 33 "sample/undocked/test_utility_helpers.c"
     register uint64_t r0 = 0;
 #line 33 "sample/undocked/test_utility_helpers.c"
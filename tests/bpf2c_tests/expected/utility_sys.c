@@ -199,7 +199,7 @@ UtilityTest(void* context)
 #line 24 "sample/utility.c"
     // Prologue
 #line 24 "sample/utility.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[4];
 #line 24 "sample/utility.c"
     register uint64_t r0 = 0;
 #line 24 "sample/utility.c"
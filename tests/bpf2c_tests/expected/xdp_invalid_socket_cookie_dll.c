@@ -62,7 +62,7 @@ xdp_invalid_socket_cookie(void* context)
 #line 20 "sample/xdp_invalid_socket_cookie.c"
     // Prologue
 #line 20 "sample/xdp_invalid_socket_cookie.c"
-    uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];
+    uint64_t stack[3];
 #line 20 "sample/xdp_invalid_socket_cookie.c"
     register uint64_t r0 = 0;
 #line 20 "sample/xdp_invalid_socket_cookie.c"
@@ -200,13 +200,15 @@ run_ubpf_interpret_test(const std::string& data_file)
 #endif
 
 void
-run_bpf_code_generator_test(const std::string& data_file)
+run_bpf_code_generator_instructions(
+    const std::string& prefix,
+    const std::string& mem,
+    const std::string& result,
+    const std::vector<ebpf_inst>& instructions)
 {
     std::string cc = env_or_default("CC", "cl.exe");
     std::string cxxflags = env_or_default("CXXFLAGS", "/EHsc /nologo");
 
-    auto [prefix, mem, result, instructions] = parse_test_file(data_file);
-
     std::ofstream c_file(std::string(prefix) + std::string(".c"));
     try {
 
@@ -229,6 +231,13 @@ run_bpf_code_generator_test(const std::string& data_file)
     REQUIRE(system(test_command.c_str()) == 0);
 }
 
+void
+run_bpf_code_generator_test(const std::string& data_file)
+{
+    auto [prefix, mem, result, instructions] = parse_test_file(data_file);
+    run_bpf_code_generator_instructions(prefix, mem, result, instructions);
+}
+
 #define DECLARE_NATIVE_TEST(FILE)                                                                       \
     TEST_CASE(FILE "_native", "[bpf_code_generator]")                                                   \
     {                                                                                                   \
@@ -472,6 +481,80 @@ TEST_CASE("EBPF_CLS_JMP invalid operation", "[raw_bpf_code_gen][negative]")
         {{(EBPF_CLS_JMP | 0xf0), 0, 0, 0, 0}, {EBPF_OP_EXIT, 0, 0, 0, 0}}, "invalid operand at offset 0");
 }
 
+TEST_CASE("EBPF_CLS_JMP target in another subprogram", "[raw_bpf_code_gen][negative]")
+{
+    // The call makes instructions 2 and 3 a subprogram, which the jump can't enter.
+    verify_invalid_opcode_sequence(
+        {{EBPF_OP_CALL, 0, 1, 0, 1},
+         {EBPF_OP_JA, 0, 0, 1, 0},
+         {EBPF_OP_MOV64_IMM, 0, 0, 0, 0},
+         {EBPF_OP_EXIT, 0, 0, 0, 0}},
+        "invalid jump target at offset 1");
+}
+
+TEST_CASE("local calls", "[raw_bpf_code_gen]")
+{
+    // Each subprogram is emitted as a C function with its own stack, so r6 and the caller's stack survive the calls.
+    std::vector<ebpf_inst> instructions = {
+        // Entry point: return subprogram_6(3, 4) + 10.
+        {EBPF_OP_MOV64_IMM, 1, 0, 0, 3},
+        {EBPF_OP_MOV64_IMM, 2, 0, 0, 4},
+        {EBPF_OP_MOV64_IMM, 6, 0, 0, 10},
+        {EBPF_OP_CALL, 0, 1, 0, 2},
+        {EBPF_OP_ADD64_REG, 0, 6, 0, 0},
+        {EBPF_OP_EXIT, 0, 0, 0, 0},
+        // subprogram_6: return subprogram_14(r1 * r2) + r1 * r2.
+        {EBPF_OP_MOV64_REG, 0, 1, 0, 0},
+        {EBPF_OP_MUL64_REG, 0, 2, 0, 0},
+        {EBPF_OP_STXDW, 10, 0, -8, 0},
+        {EBPF_OP_MOV64_REG, 1, 0, 0, 0},
+        {EBPF_OP_CALL, 0, 1, 0, 3},
+        {EBPF_OP_LDXDW, 2, 10, -8, 0},
+        {EBPF_OP_ADD64_REG, 0, 2, 0, 0},
+        {EBPF_OP_EXIT, 0, 0, 0, 0},
+        // subprogram_14: return r1 * 2.
+        {EBPF_OP_MOV64_REG, 0, 1, 0, 0},
+        {EBPF_OP_LSH64_IMM, 0, 0, 0, 1},
+        {EBPF_OP_EXIT, 0, 0, 0, 0},
+    };
+    run_bpf_code_generator_instructions("local-calls", "", "2e", instructions);
+}
+
+std::string
+generate_code(const std::vector<ebpf_inst>& instructions)
+{
+    std::stringstream output;
+    bpf_code_generator code("test", instructions);
+    code.generate("test", "test");
+    code.emit_c_code(output);
+    return output.str();
+}
+
+TEST_CASE("stack sizing", "[raw_bpf_code_gen]")
+{
+    // A stack pointer adjusted by constants is tracked, so the stack is sized to the 20 bytes below r10 it accesses.
+    std::string code = generate_code({
+        {EBPF_OP_MOV64_REG, 1, 10, 0, 0},
+        {EBPF_OP_ADD64_IMM, 1, 0, 0, -16},
+        {EBPF_OP_STW, 1, 0, -4, 1},
+        {EBPF_OP_LDXW, 0, 1, -4, 0},
+        {EBPF_OP_EXIT, 0, 0, 0, 0},
+    });
+    REQUIRE(code.find("uint64_t stack[3];") != std::string::npos);
+
+    // A program that doesn't touch the stack still gets a frame to point r10 at.
+    code = generate_code({{EBPF_OP_MOV64_IMM, 0, 0, 0, 0}, {EBPF_OP_EXIT, 0, 0, 0, 0}});
+    REQUIRE(code.find("uint64_t stack[1];") != std::string::npos);
+
+    // Spilling a stack pointer loses track of it, so the full stack is used.
+    code = generate_code({
+        {EBPF_OP_STXDW, 10, 10, -8, 0},
+        {EBPF_OP_MOV64_IMM, 0, 0, 0, 0},
+        {EBPF_OP_EXIT, 0, 0, 0, 0},
+    });
+    REQUIRE(code.find("uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];") != std::string::npos);
+}
+
 TEST_CASE("invalid register", "[raw_bpf_code_gen][negative]")
 {
     // 14 and 15 aren't valid registers.
@@ -496,6 +496,19 @@ droppacket_test(ebpf_execution_type_t execution_type)
     // Reset the count of dropped packets.
     REQUIRE(bpf_map_delete_elem(dropped_packet_map_fd, &key) == EBPF_SUCCESS);
 
+    // Fire a vector of 0-length and normal UDP packets, only the 0-length packets should be dropped.
+    void* contexts[] = {&ctx0, &ctx10, &ctx0};
+    uint32_t hook_results[_countof(contexts)] = {0};
+    REQUIRE(hook.invoke_vector(contexts, hook_results, _countof(contexts)) == EBPF_SUCCESS);
+    REQUIRE(hook_results[0] == XDP_DROP);
+    REQUIRE(hook_results[1] == XDP_PASS);
+    REQUIRE(hook_results[2] == XDP_DROP);
+    REQUIRE(bpf_map_lookup_elem(dropped_packet_map_fd, &key, &value) == EBPF_SUCCESS);
+    REQUIRE(value == 2);
+
+    // Reset the count of dropped packets.
+    REQUIRE(bpf_map_delete_elem(dropped_packet_map_fd, &key) == EBPF_SUCCESS);
+
     // Fire a 0-length packet on any interface that is not in the map, which should be allowed.
     xdp_md_t ctx4{packet0.data(), packet0.data() + packet0.size(), 0, if_index + 1};
     REQUIRE(hook.fire(&ctx4, &hook_result) == EBPF_SUCCESS);
@@ -259,6 +259,18 @@ typedef class _single_instance_hook : public _hook_helper
         return batch_end_function(state);
     }
 
+    _Must_inspect_result_ ebpf_result_t
+    invoke_vector(_Inout_updates_(count) void** program_contexts, _Out_writes_(count) uint32_t* results, size_t count)
+    {
+        if (client_binding_context == nullptr) {
+            return EBPF_EXTENSION_FAILED_TO_LOAD;
+        }
+
+        ebpf_program_invoke_vector_function_t invoke_vector_function;
+        invoke_vector_function = reinterpret_cast<decltype(invoke_vector_function)>(client_dispatch_table->function[4]);
+        return invoke_vector_function(client_binding_context, program_contexts, results, count);
+    }
+
   private:
     static NTSTATUS
     provider_attach_client_callback(
@@ -35,10 +35,11 @@ typedef enum _sock_addr_test_action
 
 typedef enum _xdp_test_action
 {
-    XDP_TEST_ACTION_PASS,   ///< Allow the packet to pass.
-    XDP_TEST_ACTION_DROP,   ///< Drop the packet.
-    XDP_TEST_ACTION_TX,     ///< Bounce the received packet back out the same NIC it arrived on.
-    XDP_TEST_ACTION_FAILURE ///< Failed to invoke the eBPF program.
+    XDP_TEST_ACTION_PASS,    ///< Allow the packet to pass.
+    XDP_TEST_ACTION_DROP,    ///< Drop the packet.
+    XDP_TEST_ACTION_TX,      ///< Bounce the received packet back out the same NIC it arrived on.
+    XDP_TEST_ACTION_FAILURE, ///< Failed to invoke the eBPF program.
+    XDP_TEST_ACTION_PACKET   ///< Use the verdict stored in the first byte of the packet and mark its last byte.
 } xdp_test_action_t;
 
 TEST_CASE("query program info", "[netebpfext]")
@@ -81,8 +82,22 @@ typedef struct _test_xdp_client_context
     netebpfext_helper_base_client_context_t base;
     void* provider_binding_context;
     xdp_test_action_t xdp_action;
+    size_t data_length;      ///< Bytes of the last packet that were visible to the program.
+    size_t invocation_count; ///< Number of times the program was invoked.
 } test_xdp_client_context_t;
 
+#define XDP_TEST_PACKET_MARKER 0xee
+
+// A packet whose data is split across two MDLs, so headers longer than the first MDL are not contiguous.
+typedef struct _test_xdp_packet
+{
+    uint8_t head[2];
+    uint8_t tail[8];
+    MDL* mdl_chain;
+    NET_BUFFER net_buffer;
+    NET_BUFFER_LIST nbl;
+} test_xdp_packet_t;
+
 // This callback occurs when netebpfext gets a packet and submits it to our dummy
 // eBPF program to handle.
 _Must_inspect_result_ ebpf_result_t
@@ -91,7 +106,9 @@ netebpfext_unit_invoke_xdp_program(
 {
     ebpf_result_t return_result = EBPF_SUCCESS;
     auto client_context = (test_xdp_client_context_t*)client_binding_context;
-    UNREFERENCED_PARAMETER(context);
+    auto xdp_context = (const xdp_md_t*)context;
+    client_context->data_length = (uint8_t*)xdp_context->data_end - (uint8_t*)xdp_context->data;
+    client_context->invocation_count++;
 
     switch (client_context->xdp_action) {
     case XDP_TEST_ACTION_PASS:
@@ -106,6 +123,10 @@ netebpfext_unit_invoke_xdp_program(
     case XDP_TEST_ACTION_FAILURE:
         return_result = EBPF_FAILED;
         break;
+    case XDP_TEST_ACTION_PACKET:
+        *result = ((uint8_t*)xdp_context->data)[0];
+        ((uint8_t*)xdp_context->data_end)[-1] = XDP_TEST_PACKET_MARKER;
+        break;
     default:
         *result = XDP_DROP;
         break;
@@ -149,6 +170,170 @@ TEST_CASE("classify_packet", "[netebpfext]")
     REQUIRE(result == FWP_ACTION_BLOCK);
 }
 
+TEST_CASE("classify_packet_max_header_length", "[netebpfext]")
+{
+    xdp_attach_parameters_t attach_parameters = {.if_index = 0, .max_header_length = 14};
+    ebpf_extension_data_t npi_specific_characteristics = {.data = &attach_parameters};
+    test_xdp_client_context_t client_context = {};
+    client_context.base.desired_attach_type = BPF_XDP_TEST;
+
+    npi_specific_characteristics.header.size = sizeof(attach_parameters);
+
+    netebpf_ext_helper_t helper(
+        &npi_specific_characteristics,
+        (_ebpf_extension_dispatch_function)netebpfext_unit_invoke_xdp_program,
+        (netebpfext_helper_base_client_context_t*)&client_context);
+
+    // The program only sees the headers it declared.
+    client_context.xdp_action = XDP_TEST_ACTION_DROP;
+    FWP_ACTION_TYPE result = helper.classify_test_packet(&FWPM_LAYER_INBOUND_MAC_FRAME_NATIVE, 0);
+    REQUIRE(result == FWP_ACTION_BLOCK);
+    REQUIRE(client_context.data_length > 0);
+    REQUIRE(client_context.data_length <= attach_parameters.max_header_length);
+
+    client_context.xdp_action = XDP_TEST_ACTION_PASS;
+    result = helper.classify_test_packet(&FWPM_LAYER_INBOUND_MAC_FRAME_NATIVE, 0);
+    REQUIRE(result == FWP_ACTION_PERMIT);
+}
+
+TEST_CASE("classify_packet_invalid_max_header_length", "[netebpfext]")
+{
+    xdp_attach_parameters_t attach_parameters = {.if_index = 0, .max_header_length = 64 * 1024};
+    ebpf_extension_data_t npi_specific_characteristics = {.data = &attach_parameters};
+    test_xdp_client_context_t client_context = {};
+    client_context.base.desired_attach_type = BPF_XDP_TEST;
+
+    npi_specific_characteristics.header.size = sizeof(attach_parameters);
+
+    netebpf_ext_helper_t helper(
+        &npi_specific_characteristics,
+        (_ebpf_extension_dispatch_function)netebpfext_unit_invoke_xdp_program,
+        (netebpfext_helper_base_client_context_t*)&client_context);
+
+    // The attach is rejected, so the packet is permitted without running the program.
+    client_context.xdp_action = XDP_TEST_ACTION_DROP;
+    FWP_ACTION_TYPE result = helper.classify_test_packet(&FWPM_LAYER_INBOUND_MAC_FRAME_NATIVE, 0);
+    REQUIRE(result == FWP_ACTION_PERMIT);
+}
+
+static void
+_test_xdp_packet_chain_initialize(_Inout_ std::vector<test_xdp_packet_t>& packets, _In_ const uint32_t* verdicts)
+{
+    for (size_t index = 0; index < packets.size(); index++) {
+        test_xdp_packet_t& packet = packets[index];
+        memset(&packet, 0, sizeof(packet));
+        packet.head[0] = (uint8_t)verdicts[index];
+
+        packet.mdl_chain = IoAllocateMdl(packet.head, sizeof(packet.head), FALSE, FALSE, nullptr);
+        REQUIRE(packet.mdl_chain != nullptr);
+        MmBuildMdlForNonPagedPool(packet.mdl_chain);
+        packet.mdl_chain->Next = IoAllocateMdl(packet.tail, sizeof(packet.tail), FALSE, FALSE, nullptr);
+        REQUIRE(packet.mdl_chain->Next != nullptr);
+        MmBuildMdlForNonPagedPool(packet.mdl_chain->Next);
+
+        NET_BUFFER_FIRST_MDL(&packet.net_buffer) = packet.mdl_chain;
+        NET_BUFFER_CURRENT_MDL(&packet.net_buffer) = packet.mdl_chain;
+        NET_BUFFER_DATA_LENGTH(&packet.net_buffer) = sizeof(packet.head) + sizeof(packet.tail);
+        NET_BUFFER_LIST_FIRST_NB(&packet.nbl) = &packet.net_buffer;
+        if (index > 0) {
+            NET_BUFFER_LIST_NEXT_NBL(&packets[index - 1].nbl) = &packet.nbl;
+        }
+    }
+}
+
+static void
+_test_xdp_packet_chain_cleanup(_Inout_ std::vector<test_xdp_packet_t>& packets)
+{
+    for (auto& packet : packets) {
+        IoFreeMdl(packet.mdl_chain->Next);
+        IoFreeMdl(packet.mdl_chain);
+    }
+}
+
+// The usersim fwp mock only indicates single packets, so call the classify callback with the chain directly.
+static void
+_test_xdp_classify_packet_chain(
+    _In_ const test_xdp_client_context_t& client_context,
+    _Inout_ std::vector<test_xdp_packet_t>& packets,
+    _Out_ FWPS_CLASSIFY_OUT* classify_output)
+{
+    FWPS_INCOMING_VALUE values[FWPS_FIELD_INBOUND_MAC_FRAME_NATIVE_MAX] = {};
+    FWPS_INCOMING_VALUES incoming_fixed_values = {};
+    FWPS_INCOMING_METADATA_VALUES incoming_metadata_values = {};
+    FWPS_FILTER filter = {};
+
+    incoming_fixed_values.layerId = FWPS_LAYER_INBOUND_MAC_FRAME_NATIVE;
+    incoming_fixed_values.valueCount = FWPS_FIELD_INBOUND_MAC_FRAME_NATIVE_MAX;
+    incoming_fixed_values.incomingValue = values;
+    filter.context = (uint64_t)(uintptr_t)net_ebpf_extension_hook_client_get_provider_data(
+        (const net_ebpf_extension_hook_client_t*)client_context.base.provider_binding_context);
+    REQUIRE(filter.context != 0);
+
+    memset(classify_output, 0, sizeof(*classify_output));
+    classify_output->rights = FWPS_RIGHT_ACTION_WRITE;
+    net_ebpf_ext_layer_2_classify(
+        &incoming_fixed_values, &incoming_metadata_values, &packets[0].nbl, nullptr, &filter, 0, classify_output);
+}
+
+TEST_CASE("classify_packet_chain", "[netebpfext]")
+{
+    // Declare headers longer than the first MDL of each packet, so the program gets a copy of them.
+    xdp_attach_parameters_t attach_parameters = {.if_index = 0, .max_header_length = 4};
+    ebpf_extension_data_t npi_specific_characteristics = {.data = &attach_parameters};
+    test_xdp_client_context_t client_context = {};
+    client_context.base.desired_attach_type = BPF_XDP_TEST;
+    client_context.xdp_action = XDP_TEST_ACTION_PACKET;
+
+    npi_specific_characteristics.header.size = sizeof(attach_parameters);
+
+    netebpf_ext_helper_t helper(
+        &npi_specific_characteristics,
+        (_ebpf_extension_dispatch_function)netebpfext_unit_invoke_xdp_program,
+        (netebpfext_helper_base_client_context_t*)&client_context);
+
+    // The chain spans more than one batch.
+    const uint32_t verdicts[] = {XDP_PASS, XDP_PASS, XDP_DROP, XDP_TX,   XDP_PASS, XDP_PASS, XDP_TX,
+                                 XDP_DROP, XDP_PASS, XDP_PASS, XDP_PASS, XDP_TX,   XDP_DROP, XDP_PASS,
+                                 XDP_PASS, XDP_PASS, XDP_TX,   XDP_PASS, XDP_DROP, XDP_PASS};
+    std::vector<test_xdp_packet_t> packets(EBPF_COUNT_OF(verdicts));
+    _test_xdp_packet_chain_initialize(packets, verdicts);
+
+    // Some packets are not passed, so the indication is absorbed and the passed packets are reinjected.
+    // The program does not run again on the reinjected packets.
+    FWPS_CLASSIFY_OUT classify_output;
+    client_context.invocation_count = 0;
+    _test_xdp_classify_packet_chain(client_context, packets, &classify_output);
+    REQUIRE(client_context.invocation_count == packets.size());
+    REQUIRE(classify_output.actionType == FWP_ACTION_BLOCK);
+    REQUIRE((classify_output.flags & FWPS_CLASSIFY_OUT_FLAG_ABSORB) != 0);
+    REQUIRE((classify_output.rights & FWPS_RIGHT_ACTION_WRITE) == 0);
+    REQUIRE(client_context.data_length == attach_parameters.max_header_length);
+
+    // Changes to the header copy are written back to the MDLs of packets that are passed or sent.
+    for (size_t index = 0; index < packets.size(); index++) {
+        uint8_t expected = (verdicts[index] == XDP_DROP) ? 0 : XDP_TEST_PACKET_MARKER;
+        REQUIRE(packets[index].tail[attach_parameters.max_header_length - sizeof(packets[index].head) - 1] == expected);
+    }
+
+    _test_xdp_packet_chain_cleanup(packets);
+
+    // A chain where every packet passes is permitted as it is.
+    std::vector<uint32_t> pass_verdicts(packets.size(), XDP_PASS);
+    _test_xdp_packet_chain_initialize(packets, pass_verdicts.data());
+
+    client_context.invocation_count = 0;
+    _test_xdp_classify_packet_chain(client_context, packets, &classify_output);
+    REQUIRE(client_context.invocation_count == packets.size());
+    REQUIRE(classify_output.actionType == FWP_ACTION_PERMIT);
+    REQUIRE((classify_output.flags & FWPS_CLASSIFY_OUT_FLAG_ABSORB) == 0);
+    REQUIRE((classify_output.rights & FWPS_RIGHT_ACTION_WRITE) != 0);
+    for (auto& packet : packets) {
+        REQUIRE(packet.tail[attach_parameters.max_header_length - sizeof(packet.head) - 1] == XDP_TEST_PACKET_MARKER);
+    }
+
+    _test_xdp_packet_chain_cleanup(packets);
+}
+
 TEST_CASE("xdp_context", "[netebpfext]")
 {
     netebpf_ext_helper_t helper;
@@ -87,6 +87,18 @@ typedef class _ebpf_program_test_state
         REQUIRE(result == EBPF_SUCCESS);
     }
 
+    void
+    test_vector(void** contexts, uint32_t* results, size_t count)
+    {
+        ebpf_execution_context_state_t state = {0};
+        ebpf_epoch_state_t epoch_state;
+        ebpf_epoch_enter(&epoch_state);
+        ebpf_get_execution_context_state(&state);
+        ebpf_result_t result = ebpf_program_invoke_vector(program, contexts, results, count, &state);
+        ebpf_epoch_exit(&epoch_state);
+        REQUIRE(result == EBPF_SUCCESS);
+    }
+
   private:
     ebpf_program_t* program;
     std::vector<ebpf_instruction_t> byte_code;
@@ -96,12 +108,18 @@ typedef class _ebpf_program_test_state
 typedef class _ebpf_map_test_state
 {
   public:
-    _ebpf_map_test_state(ebpf_map_type_t type, std::optional<uint32_t> map_size = {})
+    _ebpf_map_test_state(ebpf_map_type_t type, std::optional<uint32_t> map_size = {}, uint32_t map_flags = 0)
     {
         cxplat_utf8_string_t name{(uint8_t*)"test", 4};
         REQUIRE(ebpf_core_initiate() == EBPF_SUCCESS);
         ebpf_map_definition_in_memory_t definition{
-            type, sizeof(uint32_t), sizeof(uint64_t), map_size.has_value() ? map_size.value() : ebpf_get_cpu_count()};
+            type,
+            sizeof(uint32_t),
+            sizeof(uint64_t),
+            map_size.has_value() ? map_size.value() : ebpf_get_cpu_count(),
+            0,
+            LIBBPF_PIN_NONE,
+            map_flags};
 
         REQUIRE(ebpf_map_create(&name, &definition, ebpf_handle_invalid, &map) == EBPF_SUCCESS);
 
@@ -203,36 +221,71 @@ typedef class _ebpf_map_test_state
 typedef class _ebpf_map_lpm_trie_test_state
 {
   public:
-    _ebpf_map_lpm_trie_test_state() : map(nullptr) { REQUIRE(ebpf_core_initiate() == EBPF_SUCCESS); }
+    _ebpf_map_lpm_trie_test_state() : map(nullptr), prefix_size(0) { REQUIRE(ebpf_core_initiate() == EBPF_SUCCESS); }
 
     void
     populate_ipv4_routes(size_t route_count)
     {
-        cxplat_utf8_string_t name{(uint8_t*)"ipv4_route_table", 11};
-        ebpf_map_definition_in_memory_t definition{
-            BPF_MAP_TYPE_LPM_TRIE, sizeof(uint32_t) * 2, sizeof(uint64_t), static_cast<uint32_t>(route_count)};
-
-        REQUIRE(ebpf_map_create(&name, &definition, ebpf_handle_invalid, &map) == EBPF_SUCCESS);
-
         // Prefix Length Distributions from https://bgp.potaroo.net/as2.0/bgp-active.html
         std::vector<size_t> ipv4_prefix_length_distribution{
             0,    0,     0,     0,     0,     0,      0,     16,     13,   41, 102, 306, 596, 1215, 2090, 13647,
             8391, 14216, 25741, 43665, 53098, 109281, 97781, 523876, 1459, 0,  0,   1,   0,   1,    0,    1,
         };
+        populate_routes(sizeof(uint32_t), ipv4_prefix_length_distribution, route_count);
+    }
+
+    void
+    populate_ipv6_routes(size_t route_count)
+    {
+        // Approximate prefix length distribution from https://bgp.potaroo.net/v6/as2.0/index.html
+        std::vector<size_t> ipv6_prefix_length_distribution(128);
+        std::vector<std::pair<size_t, size_t>> ipv6_prefix_length_counts{
+            {16, 10},   {19, 20},    {20, 90},    {24, 30},     {28, 330},  {29, 4400}, {30, 1000},
+            {31, 560},  {32, 21000}, {33, 2300},  {34, 2300},   {35, 1200}, {36, 7700}, {37, 700},
+            {38, 1600}, {39, 800},   {40, 17000}, {41, 800},    {42, 2300}, {43, 700},  {44, 20000},
+            {45, 2000}, {46, 8300},  {47, 9300},  {48, 106000}, {56, 50},   {64, 150},
+        };
+        for (auto& [prefix_length, count] : ipv6_prefix_length_counts) {
+            ipv6_prefix_length_distribution[prefix_length - 1] = count;
+        }
+        populate_routes(sizeof(uint64_t) * 2, ipv6_prefix_length_distribution, route_count);
+    }
+
+    void
+    populate_mixed_routes(size_t route_prefix_size, size_t route_count)
+    {
+        // Spread the routes evenly over every prefix length, so each lookup could match at any length.
+        std::vector<size_t> uniform_prefix_length_distribution(route_prefix_size * 8, 1);
+        populate_routes(route_prefix_size, uniform_prefix_length_distribution, route_count);
+    }
+
+    void
+    populate_routes(size_t route_prefix_size, const std::vector<size_t>& prefix_length_distribution, size_t route_count)
+    {
+        prefix_size = route_prefix_size;
+        cxplat_utf8_string_t name{(uint8_t*)"lpm_route_table", 15};
+        ebpf_map_definition_in_memory_t definition{
+            BPF_MAP_TYPE_LPM_TRIE,
+            static_cast<uint32_t>(sizeof(uint32_t) + prefix_size),
+            sizeof(uint64_t),
+            static_cast<uint32_t>(route_count)};
+
+        REQUIRE(ebpf_map_create(&name, &definition, ebpf_handle_invalid, &map) == EBPF_SUCCESS);
 
+        // Index N of the distribution is the weight of prefix length N + 1.
         size_t total = 0;
-        total = std::accumulate(ipv4_prefix_length_distribution.begin(), ipv4_prefix_length_distribution.end(), total);
-        for (size_t prefix_length = 0; prefix_length < ipv4_prefix_length_distribution.size(); prefix_length++) {
-            size_t scaled_size = ipv4_prefix_length_distribution[prefix_length] * route_count / total;
+        total = std::accumulate(prefix_length_distribution.begin(), prefix_length_distribution.end(), total);
+        for (size_t prefix_length = 0; prefix_length < prefix_length_distribution.size(); prefix_length++) {
+            size_t scaled_size = prefix_length_distribution[prefix_length] * route_count / total;
             for (size_t count = 0; count < scaled_size; count++) {
-                ipv4_routes.push_back({static_cast<uint32_t>(prefix_length + 1), ebpf_random_uint32()});
+                std::vector<uint8_t> prefix(prefix_size);
+                for (auto& byte : prefix) {
+                    byte = static_cast<uint8_t>(ebpf_random_uint32());
+                }
+                routes.push_back(prefix);
+                populate_route(prefix, static_cast<uint32_t>(prefix_length + 1));
             }
         }
-        for (auto& [prefix_length, prefix] : ipv4_routes) {
-            std::vector<uint8_t> prefix_bytes(sizeof(uint32_t));
-            *reinterpret_cast<uint32_t*>(prefix_bytes.data()) = prefix;
-            populate_route(prefix_bytes, prefix_length);
-        }
     }
 
     void
@@ -251,18 +304,22 @@ typedef class _ebpf_map_lpm_trie_test_state
     }
 
     void
-    test_find_ipv4_route()
+    test_find_route()
     {
+        // Look up a full length address that falls within one of the routes.
         struct _key
         {
             uint32_t prefix_length;
-            uint32_t prefix;
-        } ipv4_key = {32, ipv4_routes[ebpf_random_uint32() % ipv4_routes.size()].second};
+            uint8_t prefix[sizeof(uint64_t) * 2];
+        } key = {static_cast<uint32_t>(prefix_size * 8)};
+        const std::vector<uint8_t>& route = routes[ebpf_random_uint32() % routes.size()];
+        memcpy(key.prefix, route.data(), prefix_size);
         volatile uint64_t* value = nullptr;
 
         ebpf_epoch_state_t epoch_state;
         ebpf_epoch_enter(&epoch_state);
-        (void)ebpf_map_find_entry(map, sizeof(ipv4_key), (uint8_t*)&ipv4_key, sizeof(value), (uint8_t*)&value, 0);
+        (void)ebpf_map_find_entry(
+            map, sizeof(uint32_t) + prefix_size, (uint8_t*)&key, sizeof(value), (uint8_t*)&value, 0);
         UNREFERENCED_PARAMETER(value);
         ebpf_epoch_exit(&epoch_state);
     }
@@ -275,12 +332,144 @@ typedef class _ebpf_map_lpm_trie_test_state
 
   private:
     ebpf_map_t* map;
-    std::vector<std::pair<uint32_t, uint32_t>> ipv4_routes;
+    size_t prefix_size;
+    std::vector<std::vector<uint8_t>> routes;
 } ebpf_map_lpm_trie_test_state_t;
 
+typedef class _ebpf_map_bloom_filter_test_state
+{
+  public:
+    _ebpf_map_bloom_filter_test_state(uint32_t max_entries) : max_entries(max_entries)
+    {
+        cxplat_utf8_string_t name{(uint8_t*)"bloom_filter", 12};
+        REQUIRE(ebpf_core_initiate() == EBPF_SUCCESS);
+        ebpf_map_definition_in_memory_t definition{BPF_MAP_TYPE_BLOOM_FILTER, 0, sizeof(uint64_t), max_entries};
+
+        REQUIRE(ebpf_map_create(&name, &definition, ebpf_handle_invalid, &map) == EBPF_SUCCESS);
+
+        // Fill the filter with the even values, so half of the peeks hit.
+        for (uint64_t value = 0; value < max_entries; value++) {
+            uint64_t even_value = value * 2;
+            REQUIRE(
+                ebpf_map_push_entry(map, sizeof(even_value), (uint8_t*)&even_value, EBPF_MAP_FLAG_HELPER) ==
+                EBPF_SUCCESS);
+        }
+    }
+    ~_ebpf_map_bloom_filter_test_state()
+    {
+        EBPF_OBJECT_RELEASE_REFERENCE((ebpf_core_object_t*)map);
+        ebpf_core_terminate();
+    }
+
+    void
+    test_push()
+    {
+        uint64_t value = ebpf_random_uint32() % (max_entries * 2);
+        (void)ebpf_map_push_entry(map, sizeof(value), (uint8_t*)&value, EBPF_MAP_FLAG_HELPER);
+    }
+
+    void
+    test_peek()
+    {
+        uint64_t value = ebpf_random_uint32() % (max_entries * 2);
+        (void)ebpf_map_peek_entry(map, sizeof(value), (uint8_t*)&value, EBPF_MAP_FLAG_HELPER);
+    }
+
+  private:
+    ebpf_map_t* map;
+    uint32_t max_entries;
+} ebpf_map_bloom_filter_test_state_t;
+
+/**
+ * @brief Every CPU increments its own counter in the value at key 0. A per-CPU map gives each CPU a slot of its own,
+ * packed 8 bytes apart unless the map is created with BPF_F_PERCPU_CACHE_ALIGN. An array map packs the counters of
+ * all CPUs into one value 8 bytes apart.
+ */
+typedef class _ebpf_map_counter_test_state
+{
+  public:
+    _ebpf_map_counter_test_state(ebpf_map_type_t type, uint32_t map_flags) : per_cpu(BPF_MAP_TYPE_PER_CPU(type))
+    {
+        cxplat_utf8_string_t name{(uint8_t*)"counter", 7};
+        REQUIRE(ebpf_core_initiate() == EBPF_SUCCESS);
+        uint32_t value_size = per_cpu ? sizeof(uint64_t) : sizeof(uint64_t) * ebpf_get_cpu_count();
+        ebpf_map_definition_in_memory_t definition{type, sizeof(uint32_t), value_size, 1};
+        definition.map_flags = map_flags;
+
+        REQUIRE(ebpf_map_create(&name, &definition, ebpf_handle_invalid, &map) == EBPF_SUCCESS);
+
+        uint32_t key = 0;
+        std::vector<uint8_t> value(ebpf_map_get_definition(map)->value_size);
+        REQUIRE(
+            ebpf_map_update_entry(map, sizeof(key), (uint8_t*)&key, value.size(), value.data(), EBPF_ANY, 0) ==
+            EBPF_SUCCESS);
+    }
+    ~_ebpf_map_counter_test_state()
+    {
+        EBPF_OBJECT_RELEASE_REFERENCE((ebpf_core_object_t*)map);
+        ebpf_core_terminate();
+    }
+
+    void
+    test_increment(uint32_t cpu_id)
+    {
+        uint32_t key = 0;
+        volatile uint64_t* value = nullptr;
+        ebpf_epoch_state_t epoch_state;
+        ebpf_epoch_enter(&epoch_state);
+        (void)ebpf_map_find_entry(map, 0, (uint8_t*)&key, 0, (uint8_t*)&value, EBPF_MAP_FLAG_HELPER);
+        value[per_cpu ? 0 : cpu_id]++;
+        ebpf_epoch_exit(&epoch_state);
+    }
+
+  private:
+    ebpf_map_t* map;
+    bool per_cpu;
+} ebpf_map_counter_test_state_t;
+
+/**
+ * @brief Every CPU pushes a value to a queue or stack map and pops one, so each CPU is both a producer and a consumer.
+ * The map starts half full, so pushes and pops rarely find it full or empty.
+ */
+typedef class _ebpf_map_circular_test_state
+{
+  public:
+    _ebpf_map_circular_test_state(ebpf_map_type_t type, uint32_t max_entries)
+    {
+        cxplat_utf8_string_t name{(uint8_t*)"circular", 8};
+        REQUIRE(ebpf_core_initiate() == EBPF_SUCCESS);
+        ebpf_map_definition_in_memory_t definition{type, 0, sizeof(uint64_t), max_entries};
+
+        REQUIRE(ebpf_map_create(&name, &definition, ebpf_handle_invalid, &map) == EBPF_SUCCESS);
+
+        for (uint64_t value = 0; value < max_entries / 2; value++) {
+            REQUIRE(ebpf_map_push_entry(map, sizeof(value), (uint8_t*)&value, EBPF_MAP_FLAG_HELPER) == EBPF_SUCCESS);
+        }
+    }
+    ~_ebpf_map_circular_test_state()
+    {
+        EBPF_OBJECT_RELEASE_REFERENCE((ebpf_core_object_t*)map);
+        ebpf_core_terminate();
+    }
+
+    void
+    test_push_pop(uint32_t cpu_id)
+    {
+        uint64_t value = cpu_id;
+        (void)ebpf_map_push_entry(map, sizeof(value), (uint8_t*)&value, EBPF_MAP_FLAG_HELPER);
+        (void)ebpf_map_pop_entry(map, sizeof(value), (uint8_t*)&value, EBPF_MAP_FLAG_HELPER);
+    }
+
+  private:
+    ebpf_map_t* map;
+} ebpf_map_circular_test_state_t;
+
 static ebpf_program_test_state_t* _ebpf_program_test_state_instance = nullptr;
 static ebpf_map_test_state_t* _ebpf_map_test_state_instance = nullptr;
 static ebpf_map_lpm_trie_test_state_t* _ebpf_map_lpm_trie_test_state_instance = nullptr;
+static ebpf_map_bloom_filter_test_state_t* _ebpf_map_bloom_filter_test_state_instance = nullptr;
+static ebpf_map_counter_test_state_t* _ebpf_map_counter_test_state_instance = nullptr;
+static ebpf_map_circular_test_state_t* _ebpf_map_circular_test_state_instance = nullptr;
 
 #if !defined(CONFIG_BPF_JIT_DISABLED) || !defined(CONFIG_BPF_INTERPRETER_DISABLED)
 static void
@@ -288,6 +477,17 @@ _ebpf_program_invoke()
 {
     _ebpf_program_test_state_instance->test(nullptr);
 }
+
+// Number of contexts in each vector, roughly the size of an NBL chain indicated by a NIC.
+#define PROGRAM_INVOKE_VECTOR_SIZE 64
+
+static void
+_ebpf_program_invoke_vector()
+{
+    void* contexts[PROGRAM_INVOKE_VECTOR_SIZE] = {0};
+    uint32_t results[PROGRAM_INVOKE_VECTOR_SIZE];
+    _ebpf_program_test_state_instance->test_vector(contexts, results, PROGRAM_INVOKE_VECTOR_SIZE);
+}
 #endif
 
 static void
@@ -321,9 +521,33 @@ _map_lookup_lru_test(uint32_t cpu_id)
 }
 
 static void
-_lpm_trie_ipv4_find()
+_map_counter_increment_test(uint32_t cpu_id)
+{
+    _ebpf_map_counter_test_state_instance->test_increment(cpu_id);
+}
+
+static void
+_map_push_pop_test(uint32_t cpu_id)
+{
+    _ebpf_map_circular_test_state_instance->test_push_pop(cpu_id);
+}
+
+static void
+_lpm_trie_find()
+{
+    _ebpf_map_lpm_trie_test_state_instance->test_find_route();
+}
+
+static void
+_bloom_filter_push()
+{
+    _ebpf_map_bloom_filter_test_state_instance->test_push();
+}
+
+static void
+_bloom_filter_peek()
 {
-    _ebpf_map_lpm_trie_test_state_instance->test_find_ipv4_route();
+    _ebpf_map_bloom_filter_test_state_instance->test_peek();
 }
 
 static const char*
@@ -350,6 +574,14 @@ _ebpf_map_type_t_to_string(ebpf_map_type_t type)
         return "BPF_MAP_TYPE_LRU_HASH";
     case BPF_MAP_TYPE_RINGBUF:
         return "BPF_MAP_TYPE_RINGBUF";
+    case BPF_MAP_TYPE_PERF_EVENT_ARRAY:
+        return "BPF_MAP_TYPE_PERF_EVENT_ARRAY";
+    case BPF_MAP_TYPE_QUEUE:
+        return "BPF_MAP_TYPE_QUEUE";
+    case BPF_MAP_TYPE_STACK:
+        return "BPF_MAP_TYPE_STACK";
+    case BPF_MAP_TYPE_BLOOM_FILTER:
+        return "BPF_MAP_TYPE_BLOOM_FILTER";
     default:
         return "Error";
     }
@@ -400,6 +632,99 @@ test_bpf_map_update_elem(bool preemptible)
     measure.run_test();
 }
 
+static void
+_test_bpf_map_update_elem_with_flags(
+    const char* function_name, ebpf_map_type_t map_type, uint32_t map_flags, bool preemptible)
+{
+    size_t iterations = PERFORMANCE_MEASURE_ITERATION_COUNT;
+    ebpf_map_test_state_t map_test_state(map_type, {}, map_flags);
+    _ebpf_map_test_state_instance = &map_test_state;
+    std::string name = function_name;
+    name += "<";
+    name += _ebpf_map_type_t_to_string(map_type);
+    name += ">";
+    _performance_measure measure(name.c_str(), preemptible, _map_update_test, iterations);
+    measure.run_test();
+}
+
+/**
+ * @brief Measure updates to a hash map that reserves its storage at creation (the default). Updates replace both the
+ * value and the bucket, which a preallocated map recycles from its per-CPU free lists.
+ */
+template <ebpf_map_type_t map_type>
+void
+test_bpf_map_update_elem_preallocated(bool preemptible)
+{
+    _test_bpf_map_update_elem_with_flags(__FUNCTION__, map_type, 0, preemptible);
+}
+
+/**
+ * @brief Measure updates to a hash map created with BPF_F_NO_PREALLOC, which allocates storage on each update.
+ */
+template <ebpf_map_type_t map_type>
+void
+test_bpf_map_update_elem_no_prealloc(bool preemptible)
+{
+    _test_bpf_map_update_elem_with_flags(__FUNCTION__, map_type, BPF_F_NO_PREALLOC, preemptible);
+}
+
+static void
+_test_bpf_map_counter_increment_with_flags(
+    const char* function_name, ebpf_map_type_t map_type, uint32_t map_flags, bool preemptible)
+{
+    size_t iterations = PERFORMANCE_MEASURE_ITERATION_COUNT;
+    ebpf_map_counter_test_state_t map_test_state(map_type, map_flags);
+    _ebpf_map_counter_test_state_instance = &map_test_state;
+    std::string name = function_name;
+    name += "<";
+    name += _ebpf_map_type_t_to_string(map_type);
+    name += ">";
+    _performance_measure measure(name.c_str(), preemptible, _map_counter_increment_test, iterations);
+    measure.run_test();
+}
+
+/**
+ * @brief Measure every CPU incrementing its own counter at the same key. Compare the per-CPU maps with
+ * BPF_MAP_TYPE_ARRAY, where the counters share cache lines.
+ */
+template <ebpf_map_type_t map_type>
+void
+test_bpf_map_counter_increment(bool preemptible)
+{
+    _test_bpf_map_counter_increment_with_flags(__FUNCTION__, map_type, 0, preemptible);
+}
+
+/**
+ * @brief Measure every CPU incrementing its own counter at the same key in a per-CPU map created with
+ * BPF_F_PERCPU_CACHE_ALIGN, which gives the counter of each CPU its own cache line.
+ */
+template <ebpf_map_type_t map_type>
+void
+test_bpf_map_counter_increment_cache_aligned(bool preemptible)
+{
+    _test_bpf_map_counter_increment_with_flags(__FUNCTION__, map_type, BPF_F_PERCPU_CACHE_ALIGN, preemptible);
+}
+
+#define CIRCULAR_MAP_SIZE 1024
+
+/**
+ * @brief Measure push and pop throughput with every CPU producing and consuming.
+ */
+template <ebpf_map_type_t map_type>
+void
+test_bpf_map_push_pop_elem(bool preemptible)
+{
+    size_t iterations = PERFORMANCE_MEASURE_ITERATION_COUNT;
+    ebpf_map_circular_test_state_t map_test_state(map_type, CIRCULAR_MAP_SIZE);
+    _ebpf_map_circular_test_state_instance = &map_test_state;
+    std::string name = __FUNCTION__;
+    name += "<";
+    name += _ebpf_map_type_t_to_string(map_type);
+    name += ">";
+    _performance_measure measure(name.c_str(), preemptible, _map_push_pop_test, iterations);
+    measure.run_test();
+}
+
 #define LRU_MAP_SIZE 8192
 
 template <ebpf_map_type_t map_type>
@@ -459,30 +784,137 @@ test_program_invoke_interpret(bool preemptible)
     _performance_measure measure(__FUNCTION__, preemptible, _ebpf_program_invoke, iterations);
     measure.run_test();
 }
-#endif
 
-template <size_t route_count>
+// Measures the cost per context of invoking a program on a vector of contexts.
+// Compare with test_program_invoke_jit and test_program_invoke_interpret.
 void
-test_lpm_trie_ipv4(bool preemptible)
+test_program_invoke_vector_jit(bool preemptible)
+{
+    size_t iterations = PERFORMANCE_MEASURE_ITERATION_COUNT * 10 / PROGRAM_INVOKE_VECTOR_SIZE;
+    std::vector<ebpf_instruction_t> byte_code = {{EBPF_OP_MOV_IMM, 0, 0, 0, 42}, {EBPF_OP_EXIT}};
+    _ebpf_program_test_state program_state(byte_code);
+    _ebpf_program_test_state_instance = &program_state;
+    program_state.prepare_jit_program();
+
+    _performance_measure measure(__FUNCTION__, preemptible, _ebpf_program_invoke_vector, iterations);
+    measure.run_test(PROGRAM_INVOKE_VECTOR_SIZE);
+}
+
+void
+test_program_invoke_vector_interpret(bool preemptible)
+{
+    size_t iterations = PERFORMANCE_MEASURE_ITERATION_COUNT * 10 / PROGRAM_INVOKE_VECTOR_SIZE;
+    std::vector<ebpf_instruction_t> byte_code = {{EBPF_OP_MOV_IMM, 0, 0, 0, 42}, {EBPF_OP_EXIT}};
+    _ebpf_program_test_state program_state(byte_code);
+    _ebpf_program_test_state_instance = &program_state;
+    program_state.prepare_interpret_program();
+
+    _performance_measure measure(__FUNCTION__, preemptible, _ebpf_program_invoke_vector, iterations);
+    measure.run_test(PROGRAM_INVOKE_VECTOR_SIZE);
+}
+#endif
+
+typedef enum _lpm_trie_route_table
+{
+    LPM_TRIE_ROUTE_TABLE_IPV4,
+    LPM_TRIE_ROUTE_TABLE_IPV6,
+    LPM_TRIE_ROUTE_TABLE_IPV4_MIXED,
+    LPM_TRIE_ROUTE_TABLE_IPV6_MIXED,
+} lpm_trie_route_table_t;
+
+static void
+_test_lpm_trie_find(const char* function_name, lpm_trie_route_table_t route_table, size_t route_count, bool preemptible)
 {
     size_t iterations = PERFORMANCE_MEASURE_ITERATION_COUNT;
     _ebpf_map_lpm_trie_test_state lpm_trie_state;
-    lpm_trie_state.populate_ipv4_routes(route_count);
+    switch (route_table) {
+    case LPM_TRIE_ROUTE_TABLE_IPV4:
+        lpm_trie_state.populate_ipv4_routes(route_count);
+        break;
+    case LPM_TRIE_ROUTE_TABLE_IPV6:
+        lpm_trie_state.populate_ipv6_routes(route_count);
+        break;
+    case LPM_TRIE_ROUTE_TABLE_IPV4_MIXED:
+        lpm_trie_state.populate_mixed_routes(sizeof(uint32_t), route_count);
+        break;
+    case LPM_TRIE_ROUTE_TABLE_IPV6_MIXED:
+        lpm_trie_state.populate_mixed_routes(sizeof(uint64_t) * 2, route_count);
+        break;
+    }
     _ebpf_map_lpm_trie_test_state_instance = &lpm_trie_state;
-    std::string name = __FUNCTION__;
+    std::string name = function_name;
     name += "<";
     name += std::to_string(route_count);
     name += ">";
 
-    _performance_measure measure(name.c_str(), preemptible, _lpm_trie_ipv4_find, iterations);
+    _performance_measure measure(name.c_str(), preemptible, _lpm_trie_find, iterations);
     measure.run_test();
 }
 
+template <size_t route_count>
+void
+test_lpm_trie_ipv4(bool preemptible)
+{
+    _test_lpm_trie_find(__FUNCTION__, LPM_TRIE_ROUTE_TABLE_IPV4, route_count, preemptible);
+}
+
+template <size_t route_count>
+void
+test_lpm_trie_ipv6(bool preemptible)
+{
+    _test_lpm_trie_find(__FUNCTION__, LPM_TRIE_ROUTE_TABLE_IPV6, route_count, preemptible);
+}
+
+template <size_t route_count>
+void
+test_lpm_trie_ipv4_mixed(bool preemptible)
+{
+    _test_lpm_trie_find(__FUNCTION__, LPM_TRIE_ROUTE_TABLE_IPV4_MIXED, route_count, preemptible);
+}
+
+template <size_t route_count>
+void
+test_lpm_trie_ipv6_mixed(bool preemptible)
+{
+    _test_lpm_trie_find(__FUNCTION__, LPM_TRIE_ROUTE_TABLE_IPV6_MIXED, route_count, preemptible);
+}
+
+static void
+_test_bloom_filter(const char* function_name, uint32_t max_entries, void (*test)(), bool preemptible)
+{
+    size_t iterations = PERFORMANCE_MEASURE_ITERATION_COUNT;
+    ebpf_map_bloom_filter_test_state_t bloom_filter_state(max_entries);
+    _ebpf_map_bloom_filter_test_state_instance = &bloom_filter_state;
+    std::string name = function_name;
+    name += "<";
+    name += std::to_string(max_entries);
+    name += ">";
+
+    _performance_measure measure(name.c_str(), preemptible, test, iterations);
+    measure.run_test();
+}
+
+template <uint32_t max_entries>
+void
+test_bloom_filter_push(bool preemptible)
+{
+    _test_bloom_filter(__FUNCTION__, max_entries, _bloom_filter_push, preemptible);
+}
+
+template <uint32_t max_entries>
+void
+test_bloom_filter_peek(bool preemptible)
+{
+    _test_bloom_filter(__FUNCTION__, max_entries, _bloom_filter_peek, preemptible);
+}
+
 #if !defined(CONFIG_BPF_JIT_DISABLED)
 PERF_TEST(test_program_invoke_jit);
+PERF_TEST(test_program_invoke_vector_jit);
 #endif
 #if !defined(CONFIG_BPF_INTERPRETER_DISABLED)
 PERF_TEST(test_program_invoke_interpret);
+PERF_TEST(test_program_invoke_vector_interpret);
 #endif
 PERF_TEST(test_bpf_map_lookup_elem_read<BPF_MAP_TYPE_HASH>);
 PERF_TEST(test_bpf_map_lookup_elem_read<BPF_MAP_TYPE_ARRAY>);
@@ -502,6 +934,20 @@ PERF_TEST(test_bpf_map_update_elem<BPF_MAP_TYPE_PERCPU_HASH>);
 PERF_TEST(test_bpf_map_update_elem<BPF_MAP_TYPE_PERCPU_ARRAY>);
 PERF_TEST(test_bpf_map_update_elem<BPF_MAP_TYPE_LRU_HASH>);
 
+PERF_TEST(test_bpf_map_update_elem_preallocated<BPF_MAP_TYPE_HASH>);
+PERF_TEST(test_bpf_map_update_elem_no_prealloc<BPF_MAP_TYPE_HASH>);
+PERF_TEST(test_bpf_map_update_elem_preallocated<BPF_MAP_TYPE_PERCPU_HASH>);
+PERF_TEST(test_bpf_map_update_elem_no_prealloc<BPF_MAP_TYPE_PERCPU_HASH>);
+
+PERF_TEST(test_bpf_map_counter_increment<BPF_MAP_TYPE_ARRAY>);
+PERF_TEST(test_bpf_map_counter_increment<BPF_MAP_TYPE_PERCPU_ARRAY>);
+PERF_TEST(test_bpf_map_counter_increment<BPF_MAP_TYPE_PERCPU_HASH>);
+PERF_TEST(test_bpf_map_counter_increment_cache_aligned<BPF_MAP_TYPE_PERCPU_ARRAY>);
+PERF_TEST(test_bpf_map_counter_increment_cache_aligned<BPF_MAP_TYPE_PERCPU_HASH>);
+
+PERF_TEST(test_bpf_map_push_pop_elem<BPF_MAP_TYPE_QUEUE>);
+PERF_TEST(test_bpf_map_push_pop_elem<BPF_MAP_TYPE_STACK>);
+
 PERF_TEST(test_bpf_map_update_lru_elem<BPF_MAP_TYPE_LRU_HASH>);
 PERF_TEST(test_bpf_map_lookup_lru_elem<BPF_MAP_TYPE_LRU_HASH>);
 
@@ -509,3 +955,18 @@ PERF_TEST(test_lpm_trie_ipv4<1024>);
 PERF_TEST(test_lpm_trie_ipv4<1024 * 16>);
 PERF_TEST(test_lpm_trie_ipv4<1024 * 256>);
 PERF_TEST(test_lpm_trie_ipv4<1024 * 1024>);
+
+PERF_TEST(test_lpm_trie_ipv6<1024>);
+PERF_TEST(test_lpm_trie_ipv6<1024 * 16>);
+PERF_TEST(test_lpm_trie_ipv6<1024 * 256>);
+PERF_TEST(test_lpm_trie_ipv6<1024 * 1024>);
+
+PERF_TEST(test_lpm_trie_ipv4_mixed<1024>);
+PERF_TEST(test_lpm_trie_ipv4_mixed<1024 * 256>);
+PERF_TEST(test_lpm_trie_ipv6_mixed<1024>);
+PERF_TEST(test_lpm_trie_ipv6_mixed<1024 * 256>);
+
+PERF_TEST(test_bloom_filter_push<1024>);
+PERF_TEST(test_bloom_filter_push<1024 * 1024>);
+PERF_TEST(test_bloom_filter_peek<1024>);
+PERF_TEST(test_bloom_filter_peek<1024 * 1024>);
@@ -3,6 +3,7 @@
 
 #define TEST_AREA "platform"
 #include "ebpf_hash_table.h"
+#include "ebpf_ring_buffer.h"
 #include "performance.h"
 
 static void
@@ -31,6 +32,19 @@ _perf_epoch_enter_alloc_free_exit()
     ebpf_epoch_exit(&epoch_state);
 }
 
+static void
+_perf_epoch_slab_cache_churn()
+{
+    // Replace a hash table sized entry, the way a map update does.
+    ebpf_epoch_state_t epoch_state;
+    ebpf_epoch_enter(&epoch_state);
+    void* p = ebpf_epoch_allocate(sizeof(uint64_t) * 8);
+    if (p != NULL) {
+        ebpf_epoch_free(p);
+    }
+    ebpf_epoch_exit(&epoch_state);
+}
+
 static void
 _perf_bpf_get_prandom_u32()
 {
@@ -228,6 +242,88 @@ _ebpf_hash_table_test_replace_value_overlap()
     _ebpf_hash_table_test_state_instance->test_replace_value_overlap();
 }
 
+/**
+ * @brief Helper class to set up a ring buffer shared by all CPUs for testing.
+ * Each CPU writes records to the ring buffer. When the ring buffer fills, the
+ * CPU that observed the full ring drains it, as a consumer would.
+ */
+typedef class _ebpf_ring_buffer_test_state
+{
+  public:
+    _ebpf_ring_buffer_test_state(size_t record_size) : record(record_size)
+    {
+        REQUIRE(ebpf_platform_initiate() == EBPF_SUCCESS);
+        platform_initiated = true;
+        REQUIRE(ebpf_epoch_initiate() == EBPF_SUCCESS);
+        epoch_initiated = true;
+
+        REQUIRE(ebpf_ring_buffer_create(&ring_buffer, ring_buffer_size) == EBPF_SUCCESS);
+        REQUIRE(ebpf_ring_buffer_map_buffer(ring_buffer, &buffer) == EBPF_SUCCESS);
+    }
+    ~_ebpf_ring_buffer_test_state()
+    {
+        ebpf_ring_buffer_destroy(ring_buffer);
+
+        if (epoch_initiated) {
+            ebpf_epoch_terminate();
+        }
+        if (platform_initiated) {
+            ebpf_platform_terminate();
+        }
+    }
+
+    void
+    test_output()
+    {
+        if (ebpf_ring_buffer_output(ring_buffer, record.data(), record.size()) == EBPF_OUT_OF_SPACE) {
+            drain();
+        }
+    }
+
+  private:
+    void
+    drain()
+    {
+        // Only one CPU consumes at a time, the rest continue producing.
+        if (ebpf_interlocked_compare_exchange_int32(&draining, 1, 0) != 0) {
+            return;
+        }
+        size_t consumer;
+        size_t producer;
+        size_t consumed_length = 0;
+        ebpf_ring_buffer_query(ring_buffer, &consumer, &producer);
+        for (;;) {
+            auto next_record =
+                ebpf_ring_buffer_next_record(buffer, ring_buffer_size, consumer + consumed_length, producer);
+            if (next_record == nullptr || ebpf_ring_buffer_record_is_locked(next_record)) {
+                break;
+            }
+            consumed_length += next_record->header.length;
+        }
+        if (consumed_length != 0) {
+            (void)ebpf_ring_buffer_return(ring_buffer, consumed_length);
+        }
+        draining = 0;
+    }
+
+    static const size_t ring_buffer_size = 1024 * 1024;
+    ebpf_ring_buffer_t* ring_buffer = nullptr;
+    uint8_t* buffer = nullptr;
+    std::vector<uint8_t> record;
+    volatile int32_t draining = 0;
+    bool platform_initiated = false;
+    bool epoch_initiated = false;
+
+} ebpf_ring_buffer_test_state_t;
+
+static ebpf_ring_buffer_test_state_t* _ebpf_ring_buffer_test_state_instance = nullptr;
+
+static void
+_ebpf_ring_buffer_test_output()
+{
+    _ebpf_ring_buffer_test_state_instance->test_output();
+}
+
 void
 test_bpf_get_prandom_u32(bool preemptible)
 {
@@ -288,6 +384,82 @@ test_epoch_enter_exit_alloc_free(bool preemptible)
     ebpf_core_terminate();
 }
 
+void
+test_epoch_slab_cache(bool preemptible)
+{
+    REQUIRE(ebpf_core_initiate() == EBPF_SUCCESS);
+    size_t iterations = PERFORMANCE_MEASURE_ITERATION_COUNT * 10;
+    uint64_t hits_before;
+    uint64_t misses_before;
+    ebpf_epoch_get_slab_cache_statistics(&hits_before, &misses_before);
+    _performance_measure measure(__FUNCTION__, preemptible, _perf_epoch_slab_cache_churn, iterations);
+    measure.run_test();
+    uint64_t hits;
+    uint64_t misses;
+    ebpf_epoch_get_slab_cache_statistics(&hits, &misses);
+    printf("%s_hits,%d,%llu\n", __FUNCTION__, preemptible, hits - hits_before);
+    printf("%s_misses,%d,%llu\n", __FUNCTION__, preemptible, misses - misses_before);
+    ebpf_core_terminate();
+}
+
+/**
+ * @brief Measure how long memory freed with ebpf_epoch_free waits to be reclaimed while CPUs churn epoch allocations.
+ * usersim can't change the number of CPUs, so each simulated CPU is a thread pinned round robin to the real CPUs.
+ */
+template <uint32_t simulated_cpu_count>
+void
+test_epoch_reclamation_latency(bool preemptible)
+{
+    REQUIRE(ebpf_core_initiate() == EBPF_SUCCESS);
+    const size_t rounds = 100;
+    volatile int32_t stop = 0;
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < simulated_cpu_count; i++) {
+        threads.emplace_back(std::thread([i, preemptible, &stop] {
+            uint32_t local_cpu_id = i % ebpf_get_cpu_count();
+            usersim_set_affinity_and_priority_override(local_cpu_id);
+            SetThreadAffinityMask(GetCurrentThread(), static_cast<uintptr_t>(1) << local_cpu_id);
+            while (!stop) {
+                KIRQL old_irql = PASSIVE_LEVEL;
+                if (!preemptible) {
+                    old_irql = KeRaiseIrqlToDpcLevel();
+                }
+                for (size_t k = 0; k < PERFORMANCE_MEASURE_BATCH_SIZE; k++) {
+                    _perf_epoch_slab_cache_churn();
+                }
+                if (!preemptible) {
+                    KeLowerIrql(old_irql);
+                }
+            }
+            usersim_clear_affinity_and_priority_override();
+        }));
+    }
+
+    // ebpf_epoch_synchronize returns once an item freed on entry has been reclaimed.
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER start_time;
+    LARGE_INTEGER end_time;
+    LARGE_INTEGER total_time{};
+    QueryPerformanceFrequency(&frequency);
+    for (size_t round = 0; round < rounds; round++) {
+        QueryPerformanceCounter(&start_time);
+        ebpf_epoch_synchronize();
+        QueryPerformanceCounter(&end_time);
+        total_time.QuadPart += end_time.QuadPart - start_time.QuadPart;
+    }
+    stop = 1;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double average_duration = static_cast<double>(total_time.QuadPart);
+    average_duration /= rounds;
+    average_duration *= 1e9;
+    average_duration /= static_cast<double>(frequency.QuadPart);
+    printf("%s<%u>,%d,%.0f\n", __FUNCTION__, simulated_cpu_count, preemptible, average_duration);
+    ebpf_core_terminate();
+}
+
 void
 test_ebpf_hash_table_find(bool preemptible)
 {
@@ -329,12 +501,36 @@ test_ebpf_hash_table_update_overlapping(bool preemptible)
     measure.run_test(instance.multiplier());
 }
 
+/**
+ * @brief Measure records written to a ring buffer that all CPUs write to at the same time.
+ */
+template <size_t record_size>
+void
+test_ebpf_ring_buffer_output(bool preemptible)
+{
+    _ebpf_ring_buffer_test_state instance(record_size);
+    _ebpf_ring_buffer_test_state_instance = &instance;
+    std::string name = __FUNCTION__;
+    name += "<";
+    name += std::to_string(record_size);
+    name += ">";
+    _performance_measure measure(name.c_str(), preemptible, _ebpf_ring_buffer_test_output);
+    measure.run_test();
+}
+
 PERF_TEST(test_epoch_enter_exit);
 PERF_TEST(test_epoch_enter_exit_alloc_free);
+PERF_TEST(test_epoch_slab_cache);
+PERF_TEST(test_epoch_reclamation_latency<1>);
+PERF_TEST(test_epoch_reclamation_latency<8>);
+PERF_TEST(test_epoch_reclamation_latency<64>);
+PERF_TEST(test_epoch_reclamation_latency<128>);
 PERF_TEST(test_ebpf_hash_table_find);
 PERF_TEST(test_ebpf_hash_table_next_key);
 PERF_TEST(test_ebpf_hash_table_update);
 PERF_TEST(test_ebpf_hash_table_update_overlapping);
+PERF_TEST(test_ebpf_ring_buffer_output<16>);
+PERF_TEST(test_ebpf_ring_buffer_output<256>);
 
 PERF_TEST(test_bpf_get_prandom_u32);
 PERF_TEST(test_bpf_ktime_get_boot_ns);
@@ -162,6 +162,52 @@ TEST_CASE("libbpf prog test run", "[libbpf][deprecated]")
 }
 #endif
 
+#if !defined(CONFIG_BPF_JIT_DISABLED)
+TEST_CASE("libbpf program statistics", "[libbpf]")
+{
+    _test_helper_libbpf test_helper;
+    test_helper.initialize();
+    struct bpf_object* object;
+    int program_fd;
+#pragma warning(suppress : 4996) // deprecated
+    int result = bpf_prog_load_deprecated("test_sample_ebpf.o", BPF_PROG_TYPE_SAMPLE, &object, &program_fd);
+    REQUIRE(result == 0);
+
+    bpf_test_run_opts opts = {};
+    sample_program_context_t in_ctx{0};
+    sample_program_context_t out_ctx{0};
+    opts.repeat = 10;
+    opts.ctx_in = reinterpret_cast<uint8_t*>(&in_ctx);
+    opts.ctx_size_in = sizeof(in_ctx);
+    opts.ctx_out = reinterpret_cast<uint8_t*>(&out_ctx);
+    opts.ctx_size_out = sizeof(out_ctx);
+
+    // Statistics are not collected by default.
+    REQUIRE(bpf_prog_test_run_opts(program_fd, &opts) == 0);
+    bpf_prog_info program_info = {};
+    uint32_t program_info_size = sizeof(program_info);
+    REQUIRE(bpf_obj_get_info_by_fd(program_fd, &program_info, &program_info_size) == 0);
+    REQUIRE(program_info.run_cnt == 0);
+    REQUIRE(program_info.run_time_ns == 0);
+    REQUIRE(program_info.tail_call_cnt == 0);
+
+    REQUIRE(ebpf_program_set_statistics(true) == EBPF_SUCCESS);
+    REQUIRE(bpf_prog_test_run_opts(program_fd, &opts) == 0);
+    REQUIRE(ebpf_program_set_statistics(false) == EBPF_SUCCESS);
+
+    REQUIRE(bpf_obj_get_info_by_fd(program_fd, &program_info, &program_info_size) == 0);
+    REQUIRE(program_info.run_cnt == opts.repeat);
+    REQUIRE(program_info.tail_call_cnt == 0);
+
+    // Statistics are kept but not updated once disabled.
+    REQUIRE(bpf_prog_test_run_opts(program_fd, &opts) == 0);
+    REQUIRE(bpf_obj_get_info_by_fd(program_fd, &program_info, &program_info_size) == 0);
+    REQUIRE(program_info.run_cnt == opts.repeat);
+
+    bpf_object__close(object);
+}
+#endif
+
 TEST_CASE("empty bpf_load_program", "[libbpf][deprecated]")
 {
     _test_helper_libbpf test_helper;
@@ -1048,6 +1094,108 @@ TEST_CASE("libbpf create queue", "[libbpf]")
     Platform::_close(map_fd);
 }
 
+TEST_CASE("libbpf create bloom filter", "[libbpf]")
+{
+    _test_helper_libbpf test_helper;
+    test_helper.initialize();
+
+    bpf_map_create_opts opts = {0};
+    opts.sz = sizeof(opts);
+    opts.map_extra = 3;
+    const uint32_t max_entries = 16;
+    const uint32_t value_size = sizeof(uint32_t);
+
+    // Bloom filters have no key.
+    int map_fd =
+        bpf_map_create(BPF_MAP_TYPE_BLOOM_FILTER, "MapName", sizeof(uint32_t), value_size, max_entries, &opts);
+    REQUIRE(map_fd < 0);
+
+    map_fd = bpf_map_create(BPF_MAP_TYPE_BLOOM_FILTER, "MapName", 0, value_size, max_entries, &opts);
+    REQUIRE(map_fd > 0);
+
+    bpf_map_info info;
+    uint32_t info_size = sizeof(info);
+    REQUIRE(bpf_obj_get_info_by_fd(map_fd, &info, &info_size) == 0);
+
+    REQUIRE(info.type == BPF_MAP_TYPE_BLOOM_FILTER);
+    REQUIRE(info.key_size == 0);
+    REQUIRE(info.value_size == value_size);
+    REQUIRE(info.max_entries == max_entries);
+    REQUIRE(info.map_extra == 3);
+
+    // Lookups test for the value passed in.
+    uint32_t value = 1;
+    REQUIRE(bpf_map_lookup_elem(map_fd, nullptr, &value) == -ENOENT);
+    REQUIRE(bpf_map_update_elem(map_fd, nullptr, &value, 0) == 0);
+    REQUIRE(bpf_map_lookup_elem(map_fd, nullptr, &value) == 0);
+    REQUIRE(value == 1);
+
+    // Values can't be removed.
+    REQUIRE(bpf_map_lookup_and_delete_elem(map_fd, nullptr, &value) == -EINVAL);
+
+    uint32_t next_key;
+    REQUIRE(bpf_map_get_next_key(map_fd, NULL, &next_key) == -ENOTSUP);
+
+    Platform::_close(map_fd);
+
+    // The hash count is limited to 15.
+    opts.map_extra = 16;
+    map_fd = bpf_map_create(BPF_MAP_TYPE_BLOOM_FILTER, "MapName", 0, value_size, max_entries, &opts);
+    REQUIRE(map_fd < 0);
+}
+
+TEST_CASE("libbpf mmap array", "[libbpf]")
+{
+    _test_helper_libbpf test_helper;
+    test_helper.initialize();
+
+    bpf_map_create_opts opts = {0};
+    opts.sz = sizeof(opts);
+    opts.map_flags = BPF_F_MMAPABLE;
+    const uint32_t max_entries = 4;
+
+    // Only arrays can be mapped.
+    int map_fd = bpf_map_create(BPF_MAP_TYPE_HASH, "MapName", sizeof(uint32_t), sizeof(uint64_t), max_entries, &opts);
+    REQUIRE(map_fd < 0);
+
+    map_fd = bpf_map_create(BPF_MAP_TYPE_ARRAY, "MapName", sizeof(uint32_t), sizeof(uint64_t), max_entries, &opts);
+    REQUIRE(map_fd > 0);
+
+    bpf_map_info info;
+    uint32_t info_size = sizeof(info);
+    REQUIRE(bpf_obj_get_info_by_fd(map_fd, &info, &info_size) == 0);
+    REQUIRE(info.map_flags == BPF_F_MMAPABLE);
+
+    void* address = nullptr;
+    REQUIRE(ebpf_map_mmap(map_fd, &address) == EBPF_SUCCESS);
+    REQUIRE(address != nullptr);
+    uint64_t* values = reinterpret_cast<uint64_t*>(address);
+
+    // Counters written through the mapping are seen by lookups without any further calls.
+    for (uint32_t key = 0; key < max_entries; key++) {
+        values[key] += key + 1;
+    }
+    for (uint32_t key = 0; key < max_entries; key++) {
+        uint64_t value = 0;
+        REQUIRE(bpf_map_lookup_elem(map_fd, &key, &value) == 0);
+        REQUIRE(value == key + 1);
+    }
+
+    uint32_t key = 1;
+    uint64_t value = 42;
+    REQUIRE(bpf_map_update_elem(map_fd, &key, &value, 0) == 0);
+    REQUIRE(values[key] == 42);
+
+    Platform::_close(map_fd);
+
+    // Arrays created without the flag can't be mapped.
+    map_fd = bpf_map_create(BPF_MAP_TYPE_ARRAY, "MapName", sizeof(uint32_t), sizeof(uint64_t), max_entries, nullptr);
+    REQUIRE(map_fd > 0);
+    REQUIRE(ebpf_map_mmap(map_fd, &address) == EBPF_OPERATION_NOT_SUPPORTED);
+    REQUIRE(address == nullptr);
+    Platform::_close(map_fd);
+}
+
 TEST_CASE("libbpf create ringbuf", "[libbpf]")
 {
     _test_helper_libbpf test_helper;
@@ -3565,6 +3713,178 @@ TEST_CASE("libbpf hash map batch", "[libbpf]") { _test_maps_batch(BPF_MAP_TYPE_H
 
 TEST_CASE("libbpf lru hash map batch", "[libbpf]") { _test_maps_batch(BPF_MAP_TYPE_LRU_HASH); }
 
+TEST_CASE("libbpf array map batch larger than a protocol message", "[libbpf]")
+{
+    _test_helper_end_to_end test_helper;
+    test_helper.initialize();
+
+    // Entries for the whole map don't fit in a single protocol message.
+    const uint32_t max_entries = 32 * 1024;
+    union bpf_attr attr = {};
+    attr.map_type = BPF_MAP_TYPE_ARRAY;
+    attr.key_size = sizeof(uint32_t);
+    attr.value_size = sizeof(uint64_t);
+    attr.max_entries = max_entries;
+
+    fd_t map_fd = bpf(BPF_MAP_CREATE, &attr, sizeof(attr));
+    REQUIRE(map_fd > 0);
+
+    std::vector<uint32_t> keys(max_entries);
+    std::vector<uint64_t> values(max_entries);
+    for (uint32_t i = 0; i < max_entries; i++) {
+        keys[i] = i;
+        values[i] = static_cast<uint64_t>(i) * 3ul;
+    }
+
+    bpf_map_batch_opts opts = {.elem_flags = BPF_ANY};
+    uint32_t count = max_entries;
+    REQUIRE(bpf_map_update_batch(map_fd, keys.data(), values.data(), &count, &opts) == 0);
+    REQUIRE(count == max_entries);
+
+    // Fetch every entry in a single call.
+    std::vector<uint32_t> fetched_keys(max_entries);
+    std::vector<uint64_t> fetched_values(max_entries);
+    uint32_t next_key = 0;
+    opts.elem_flags = 0;
+    count = max_entries;
+    REQUIRE(
+        bpf_map_lookup_batch(
+            map_fd, nullptr, &next_key, fetched_keys.data(), fetched_values.data(), &count, &opts) == 0);
+    REQUIRE(count == max_entries);
+    REQUIRE(fetched_keys == keys);
+    REQUIRE(fetched_values == values);
+    REQUIRE(next_key == max_entries - 1);
+
+    // Nothing follows the last key.
+    count = max_entries;
+    REQUIRE(
+        bpf_map_lookup_batch(
+            map_fd, &next_key, &next_key, fetched_keys.data(), fetched_values.data(), &count, &opts) == -ENOENT);
+
+    // An element failing mid-batch stops the batch and reports the elements updated before it.
+    const uint32_t failing_index = 1000;
+    keys[failing_index] = max_entries;
+    opts.elem_flags = BPF_ANY;
+    count = max_entries;
+    REQUIRE(bpf_map_update_batch(map_fd, keys.data(), values.data(), &count, &opts) == -EINVAL);
+    REQUIRE(count == failing_index);
+}
+
+TEST_CASE("libbpf map ring", "[libbpf]")
+{
+    _test_helper_end_to_end test_helper;
+    test_helper.initialize();
+
+    union bpf_attr attr = {};
+    attr.map_type = BPF_MAP_TYPE_HASH;
+    attr.key_size = sizeof(uint32_t);
+    attr.value_size = sizeof(uint64_t);
+    attr.max_entries = 1024;
+
+    fd_t map_fd = bpf(BPF_MAP_CREATE, &attr, sizeof(attr));
+    REQUIRE(map_fd > 0);
+
+    ebpf_map_ring_t* ring = nullptr;
+    REQUIRE(ebpf_map_ring_create(3, 4096, &ring) == EBPF_INVALID_ARGUMENT);
+    REQUIRE(ebpf_map_ring_create(64, 4096, &ring) == EBPF_SUCCESS);
+
+    const uint32_t count = 32;
+    uint64_t user_data;
+    ebpf_result_t result;
+    uint32_t processed;
+
+    // Nothing is pending until operations are submitted.
+    REQUIRE(ebpf_map_ring_get_completion(ring, &user_data, &result) == EBPF_NO_MORE_KEYS);
+
+    for (uint32_t key = 0; key < count; key++) {
+        uint64_t value = static_cast<uint64_t>(key) * 5;
+        REQUIRE(ebpf_map_ring_queue_update(ring, map_fd, &key, &value, BPF_NOEXIST, key) == EBPF_SUCCESS);
+    }
+    REQUIRE(ebpf_map_ring_get_completion(ring, &user_data, &result) == EBPF_NO_MORE_KEYS);
+    REQUIRE(ebpf_map_ring_submit(ring, &processed) == EBPF_SUCCESS);
+    REQUIRE(processed == count);
+
+    // Completions are posted in submission order.
+    for (uint32_t key = 0; key < count; key++) {
+        REQUIRE(ebpf_map_ring_get_completion(ring, &user_data, &result) == EBPF_SUCCESS);
+        REQUIRE(user_data == key);
+        REQUIRE(result == EBPF_SUCCESS);
+    }
+    REQUIRE(ebpf_map_ring_get_completion(ring, &user_data, &result) == EBPF_NO_MORE_KEYS);
+
+    for (uint32_t key = 0; key < count; key++) {
+        uint64_t value = 0;
+        REQUIRE(bpf_map_lookup_elem(map_fd, &key, &value) == 0);
+        REQUIRE(value == static_cast<uint64_t>(key) * 5);
+    }
+
+    // Look up every key and one that is missing.
+    std::vector<uint64_t> values(count + 1);
+    for (uint32_t key = 0; key <= count; key++) {
+        REQUIRE(ebpf_map_ring_queue_lookup(ring, map_fd, &key, &values[key], key) == EBPF_SUCCESS);
+    }
+    REQUIRE(ebpf_map_ring_submit(ring, &processed) == EBPF_SUCCESS);
+    REQUIRE(processed == count + 1);
+    for (uint32_t key = 0; key <= count; key++) {
+        REQUIRE(ebpf_map_ring_get_completion(ring, &user_data, &result) == EBPF_SUCCESS);
+        REQUIRE(user_data == key);
+        if (key < count) {
+            REQUIRE(result == EBPF_SUCCESS);
+            REQUIRE(values[key] == static_cast<uint64_t>(key) * 5);
+        } else {
+            REQUIRE(result == EBPF_KEY_NOT_FOUND);
+        }
+    }
+
+    // Delete every key.
+    for (uint32_t key = 0; key < count; key++) {
+        REQUIRE(ebpf_map_ring_queue_delete(ring, map_fd, &key, key) == EBPF_SUCCESS);
+    }
+    REQUIRE(ebpf_map_ring_submit(ring, &processed) == EBPF_SUCCESS);
+    REQUIRE(processed == count);
+    for (uint32_t key = 0; key < count; key++) {
+        REQUIRE(ebpf_map_ring_get_completion(ring, &user_data, &result) == EBPF_SUCCESS);
+        REQUIRE(result == EBPF_SUCCESS);
+        uint64_t value = 0;
+        REQUIRE(bpf_map_lookup_elem(map_fd, &key, &value) == -ENOENT);
+    }
+
+    // Invalid file descriptors and flags are rejected when queued.
+    uint32_t key = 0;
+    uint64_t value = 0;
+    REQUIRE(ebpf_map_ring_queue_update(ring, -1, &key, &value, BPF_ANY, 0) == EBPF_INVALID_ARGUMENT);
+    REQUIRE(ebpf_map_ring_queue_update(ring, map_fd, &key, &value, 0x100, 0) == EBPF_INVALID_ARGUMENT);
+
+    ebpf_map_ring_destroy(ring);
+
+    // A full ring rejects new operations, and submissions stop while the completion queue is full.
+    REQUIRE(ebpf_map_ring_create(4, 4096, &ring) == EBPF_SUCCESS);
+    for (key = 0; key < 4; key++) {
+        REQUIRE(ebpf_map_ring_queue_update(ring, map_fd, &key, &value, BPF_ANY, key) == EBPF_SUCCESS);
+    }
+    REQUIRE(ebpf_map_ring_queue_update(ring, map_fd, &key, &value, BPF_ANY, key) == EBPF_INSUFFICIENT_BUFFER);
+    REQUIRE(ebpf_map_ring_submit(ring, &processed) == EBPF_SUCCESS);
+    REQUIRE(processed == 4);
+
+    REQUIRE(ebpf_map_ring_queue_delete(ring, map_fd, &key, key) == EBPF_SUCCESS);
+    REQUIRE(ebpf_map_ring_submit(ring, &processed) == EBPF_SUCCESS);
+    REQUIRE(processed == 0);
+
+    for (uint32_t index = 0; index < 4; index++) {
+        REQUIRE(ebpf_map_ring_get_completion(ring, &user_data, &result) == EBPF_SUCCESS);
+        REQUIRE(user_data == index);
+        REQUIRE(result == EBPF_SUCCESS);
+    }
+    REQUIRE(ebpf_map_ring_submit(ring, &processed) == EBPF_SUCCESS);
+    REQUIRE(processed == 1);
+    REQUIRE(ebpf_map_ring_get_completion(ring, &user_data, &result) == EBPF_SUCCESS);
+    REQUIRE(user_data == 4);
+    REQUIRE(result == EBPF_KEY_NOT_FOUND);
+
+    ebpf_map_ring_destroy(ring);
+    Platform::_close(map_fd);
+}
+
 void
 _hash_of_map_initial_value_test(ebpf_execution_type_t execution_type)
 {
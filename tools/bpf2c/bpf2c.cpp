@@ -143,6 +143,7 @@ main(int argc, char** argv)
         std::string type_string = "";
         std::string hash_algorithm = EBPF_HASH_ALGORITHM;
         bool verify_programs = true;
+        bool inline_map_lookups = false;
         std::vector<std::string> parameters(argv + 1, argv + argc);
         auto iter = parameters.begin();
         auto iter_end = parameters.end();
@@ -177,6 +178,12 @@ main(int argc, char** argv)
                   }
                   return true;
               }}},
+            {"--inline-map-lookups",
+             {"Look up array map values in generated code instead of calling the helper function",
+              [&]() {
+                  inline_map_lookups = true;
+                  return true;
+              }}},
 #if defined(ENABLE_SKIP_VERIFY)
             {"--no-verify",
              {"Skip validating code using verifier",
@@ -279,6 +286,7 @@ main(int argc, char** argv)
         }
 
         bpf_code_generator generator(stream, c_name, {hash_value});
+        generator.set_inline_map_lookups(inline_map_lookups);
 
         // Parse global data.
         generator.parse();
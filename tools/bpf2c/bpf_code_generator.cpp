@@ -22,6 +22,7 @@
 #undef ebpf_inst
 
 #include <windows.h>
+#include <array>
 #include <cassert>
 #include <format>
 #include <iomanip>
@@ -37,6 +38,8 @@
 #define INDENT "    "
 #define LINE_BREAK_WIDTH 120
 
+#define EBPF_MODE_MASK 0xe0
+#define EBPF_MODE_MEM 0x60
 #define EBPF_MODE_ATOMIC 0xc0
 
 #define EBPF_ATOMIC_FETCH 0x01
@@ -53,6 +56,13 @@
 
 #define EBPF_OP_ATOMIC64 (INST_CLS_STX | EBPF_MODE_ATOMIC | INST_SIZE_DW)
 #define EBPF_OP_ATOMIC (INST_CLS_STX | EBPF_MODE_ATOMIC | INST_SIZE_W)
+
+// Source register value of a call instruction that calls a BPF subprogram instead of a helper function.
+#define EBPF_CALL_LOCAL 1
+
+// Size in bytes of the stack frame of each BPF function, matches UBPF_STACK_SIZE in bpf2c.h.
+#define BPF_STACK_SIZE 512
+
 static const std::string _register_names[11] = {
     "r0",
     "r1",
@@ -189,7 +199,11 @@ bpf_code_generator::get_register_name(uint8_t id)
     if (id >= _countof(_register_names)) {
         throw bpf_code_generator_exception("invalid register id");
     } else {
-        current_program->referenced_registers.insert(_register_names[id]);
+        if (current_function == 0) {
+            current_program->referenced_registers.insert(_register_names[id]);
+        } else {
+            current_program->subprograms[current_function].insert(_register_names[id]);
+        }
         return _register_names[id];
     }
 }
@@ -317,15 +331,27 @@ bpf_code_generator::set_program_hash_info(const std::optional<std::vector<uint8_
     current_program->program_info_hash = program_info_hash;
 }
 
+void
+bpf_code_generator::set_inline_map_lookups(bool enabled)
+{
+    inline_map_lookups = enabled;
+}
+
 void
 bpf_code_generator::generate(
     const bpf_code_generator::unsafe_string& section_name, const bpf_code_generator::unsafe_string& program_name)
 {
     current_program = &programs[program_name];
 
+    find_subprograms();
     generate_labels();
     build_function_table();
     encode_instructions(section_name);
+
+    current_program->stack_sizes.try_emplace(0, get_stack_size(0));
+    for (const auto& subprogram : current_program->subprograms) {
+        current_program->stack_sizes.try_emplace(subprogram.first, get_stack_size(subprogram.first));
+    }
 }
 
 std::vector<int32_t>
@@ -368,6 +394,18 @@ _is_legacy_map_section(const std::string& name)
     return name == "maps" || (name.length() > 5 && name.compare(0, maps_prefix.length(), maps_prefix) == 0);
 }
 
+// Global variables are placed in sections called ".data", ".bss" or ".rodata", or matching "<section>.<suffix>".
+static bool
+_is_global_data_section(const std::string& name)
+{
+    for (const std::string prefix : {".data", ".bss", ".rodata"}) {
+        if (name == prefix || name.compare(0, prefix.length() + 1, prefix + ".") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void
 bpf_code_generator::visit_symbols(symbol_visitor_t visitor, const unsafe_string& section_name)
 {
@@ -611,7 +649,7 @@ bpf_code_generator::parse_btf_maps_section(const unsafe_string& name)
     }
 }
 
-// Parse global data (currently map information) in the eBPF file.
+// Parse global data (map information and global variable sections) in the eBPF file.
 void
 bpf_code_generator::parse()
 {
@@ -623,6 +661,46 @@ bpf_code_generator::parse()
             parse_legacy_maps_section(name);
         }
     }
+
+    // Maps backing global variables follow the maps declared by the program.
+    for (auto& section : reader.sections) {
+        std::string name = section->get_name();
+        if (_is_global_data_section(name)) {
+            parse_global_data_section(name);
+        }
+    }
+}
+
+void
+bpf_code_generator::parse_global_data_section(const unsafe_string& name)
+{
+    auto section = get_required_section(name);
+    size_t size = section->get_size();
+    if (size == 0) {
+        return;
+    }
+    if (size > UINT32_MAX) {
+        throw bpf_code_generator_exception("global data section too large: " + name);
+    }
+
+    // Each section is a single array map entry holding all of its variables, as libbpf does.
+    ebpf_map_definition_in_file_t definition{};
+    definition.type = BPF_MAP_TYPE_ARRAY;
+    definition.key_size = sizeof(uint32_t);
+    definition.value_size = static_cast<uint32_t>(size);
+    definition.max_entries = 1;
+    definition.pinning = LIBBPF_PIN_NONE;
+
+    global_data_section_t global_data_section{};
+    global_data_section.section_index = section->get_index();
+    global_data_section.read_only = (section->get_flags() & ELFIO::SHF_WRITE) == 0;
+    if (section->get_type() != ELFIO::SHT_NOBITS && section->get_data() != nullptr) {
+        global_data_section.initial_data.assign(section->get_data(), section->get_data() + size);
+    }
+    global_data_sections[name] = std::move(global_data_section);
+
+    size_t index = map_definitions.size();
+    map_definitions[name] = {definition, index};
 }
 
 static std::tuple<std::string, ELFIO::Elf_Half>
@@ -757,8 +835,21 @@ bpf_code_generator::extract_relocations_and_maps(const bpf_code_generator::unsaf
                     // Relocation is for a different program.
                     continue;
                 }
-                current_program->output[(offset - current_program->offset_in_section) / sizeof(ebpf_inst)].relocation =
-                    unsafe_name;
+                size_t instruction_index = (offset - current_program->offset_in_section) / sizeof(ebpf_inst);
+                auto& output = current_program->output[instruction_index];
+                output.relocation = unsafe_name;
+                for (const auto& [global_data_name, global_data_section] : global_data_sections) {
+                    if (section_index != global_data_section.section_index) {
+                        continue;
+                    }
+                    // Loads of global variable addresses refer to the map backing the section. The offset of the
+                    // variable in the section is the symbol value plus the addend clang leaves in the instruction.
+                    if (output.instruction.opcode != INST_OP_LDDW_IMM) {
+                        throw bpf_code_generator_exception("Can't perform relocation at offset ", offset);
+                    }
+                    output.relocation = global_data_name;
+                    output.instruction.imm += static_cast<int32_t>(value);
+                }
                 if (map_section && section_index == map_section->get_index()) {
                     // Check that the map exists in the list of map definitions.
                     if (map_definitions.find(unsafe_name) == map_definitions.end()) {
@@ -802,6 +893,34 @@ bpf_code_generator::extract_btf_information()
         });
 }
 
+void
+bpf_code_generator::find_subprograms()
+{
+    std::vector<output_instruction_t>& program_output = current_program->output;
+
+    for (size_t i = 0; i < program_output.size(); i++) {
+        auto& output = program_output[i];
+        if (output.instruction.opcode != INST_OP_CALL || output.instruction.src != EBPF_CALL_LOCAL) {
+            continue;
+        }
+        size_t target = i + output.instruction.imm + 1;
+        if (target == 0 || target >= program_output.size()) {
+            throw bpf_code_generator_exception("invalid call target", i);
+        }
+        current_program->subprograms.try_emplace(target);
+    }
+}
+
+size_t
+bpf_code_generator::get_function_start(size_t offset)
+{
+    auto next = current_program->subprograms.upper_bound(offset);
+    if (next == current_program->subprograms.begin()) {
+        return 0;
+    }
+    return std::prev(next)->first;
+}
+
 void
 bpf_code_generator::generate_labels()
 {
@@ -824,6 +943,10 @@ bpf_code_generator::generate_labels()
         if ((i + offset + 1) >= program_output.size()) {
             throw bpf_code_generator_exception("invalid jump target", i);
         }
+        // Each subprogram is emitted as its own C function, so jumps can't leave it.
+        if (get_function_start(i) != get_function_start(i + offset + 1)) {
+            throw bpf_code_generator_exception("invalid jump target", i);
+        }
         program_output[i + offset + 1].jump_target = true;
     }
 
@@ -845,7 +968,7 @@ bpf_code_generator::build_function_table()
     // Gather helper_functions
     size_t index = 0;
     for (auto& output : program_output) {
-        if (output.instruction.opcode != INST_OP_CALL) {
+        if (output.instruction.opcode != INST_OP_CALL || output.instruction.src == EBPF_CALL_LOCAL) {
             continue;
         }
         bpf_code_generator::unsafe_string name;
@@ -862,6 +985,267 @@ bpf_code_generator::build_function_table()
     }
 }
 
+const bpf_code_generator::map_entry_t*
+bpf_code_generator::find_array_map_argument(size_t call_index)
+{
+    std::vector<output_instruction_t>& program_output = current_program->output;
+
+    // Walk back through the straight-line code preceding the call to the last instruction that sets r1.
+    for (size_t j = call_index; j-- > 0;) {
+        if (program_output[j + 1].jump_target) {
+            return nullptr;
+        }
+        const auto& previous = program_output[j];
+        uint8_t opcode_class = previous.instruction.opcode & INST_CLS_MASK;
+        if (opcode_class == INST_CLS_JMP || opcode_class == INST_CLS_JMP32) {
+            return nullptr;
+        }
+        if (opcode_class == INST_CLS_ST || opcode_class == INST_CLS_STX || previous.instruction.dst != 1) {
+            continue;
+        }
+        if (previous.instruction.opcode != INST_OP_LDDW_IMM || previous.relocation.empty()) {
+            return nullptr;
+        }
+        auto map_definition = map_definitions.find(previous.relocation);
+        if (map_definition == map_definitions.end() || global_data_sections.contains(previous.relocation) ||
+            map_definition->second.definition.type != BPF_MAP_TYPE_ARRAY ||
+            map_definition->second.definition.key_size != sizeof(uint32_t)) {
+            return nullptr;
+        }
+        return &map_definition->second;
+    }
+    return nullptr;
+}
+
+std::optional<uint64_t>
+bpf_code_generator::find_read_only_value(size_t load_index)
+{
+    std::vector<output_instruction_t>& program_output = current_program->output;
+    const ebpf_inst& load = program_output[load_index].instruction;
+    if ((load.opcode & EBPF_MODE_MASK) != EBPF_MODE_MEM) {
+        return {};
+    }
+    size_t size;
+    switch (load.opcode & INST_SIZE_DW) {
+    case INST_SIZE_B:
+        size = sizeof(uint8_t);
+        break;
+    case INST_SIZE_H:
+        size = sizeof(uint16_t);
+        break;
+    case INST_SIZE_W:
+        size = sizeof(uint32_t);
+        break;
+    default:
+        size = sizeof(uint64_t);
+        break;
+    }
+
+    // Walk back through the straight-line code preceding the load to the last instruction that sets the source.
+    for (size_t j = load_index; j-- > 0;) {
+        if (program_output[j + 1].jump_target) {
+            return {};
+        }
+        const auto& previous = program_output[j];
+        uint8_t opcode_class = previous.instruction.opcode & INST_CLS_MASK;
+        if (opcode_class == INST_CLS_JMP || opcode_class == INST_CLS_JMP32) {
+            return {};
+        }
+        if (j > 0 && program_output[j - 1].instruction.opcode == INST_OP_LDDW_IMM) {
+            // Second half of a 64-bit immediate load.
+            continue;
+        }
+        if (opcode_class == INST_CLS_STX && (previous.instruction.opcode & EBPF_MODE_MASK) == EBPF_MODE_ATOMIC) {
+            // Atomic operations may write a register.
+            return {};
+        }
+        if (opcode_class == INST_CLS_ST || opcode_class == INST_CLS_STX || previous.instruction.dst != load.src) {
+            continue;
+        }
+        if (previous.instruction.opcode != INST_OP_LDDW_IMM) {
+            return {};
+        }
+        auto global_data_section = global_data_sections.find(previous.relocation);
+        if (global_data_section == global_data_sections.end() || !global_data_section->second.read_only) {
+            return {};
+        }
+        const std::vector<uint8_t>& data = global_data_section->second.initial_data;
+        int64_t offset = static_cast<int64_t>(static_cast<uint32_t>(previous.instruction.imm)) + load.offset;
+        if (offset < 0 || static_cast<size_t>(offset) + size > data.size()) {
+            return {};
+        }
+        uint64_t value = 0;
+        memcpy(&value, data.data() + offset, size);
+        return value;
+    }
+    return {};
+}
+
+std::optional<size_t>
+bpf_code_generator::get_stack_size(size_t function_start)
+{
+    // Offsets from the frame pointer that each register may hold, an empty set means it doesn't point into the stack.
+    typedef std::array<std::set<int32_t>, 11> stack_pointers_t;
+    std::vector<output_instruction_t>& program_output = current_program->output;
+    auto next_function = current_program->subprograms.upper_bound(function_start);
+    size_t function_end =
+        (next_function != current_program->subprograms.end()) ? next_function->first : program_output.size();
+    std::vector<std::optional<stack_pointers_t>> states(function_end - function_start);
+    std::vector<size_t> worklist;
+    size_t stack_size = 0;
+
+    // Record a stack access, returning false if it is outside the stack frame.
+    auto record_access = [&](const std::set<int32_t>& base, int16_t offset) {
+        for (int32_t pointer : base) {
+            int32_t address = pointer + offset;
+            if (address < -BPF_STACK_SIZE || address > BPF_STACK_SIZE) {
+                return false;
+            }
+            if (address < 0) {
+                stack_size = std::max(stack_size, static_cast<size_t>(-address));
+            }
+        }
+        return true;
+    };
+
+    states[0].emplace();
+    (*states[0])[10].insert(0);
+    worklist.push_back(function_start);
+
+    while (!worklist.empty()) {
+        size_t i = worklist.back();
+        worklist.pop_back();
+        stack_pointers_t state = *states[i - function_start];
+        const auto& inst = program_output[i].instruction;
+        if (inst.dst >= state.size() || inst.src >= state.size()) {
+            return std::nullopt;
+        }
+        auto& destination = state[inst.dst];
+        const auto& source = state[inst.src];
+        bool source_is_register = (inst.opcode & INST_SRC_REG) != 0;
+        std::vector<size_t> successors;
+
+        switch (inst.opcode & INST_CLS_MASK) {
+        case INST_CLS_ALU64: {
+            AluOperations operation = static_cast<AluOperations>(inst.opcode >> 4);
+            if (operation == AluOperations::Mov) {
+                if (!source_is_register) {
+                    destination.clear();
+                } else if (inst.offset == 0) {
+                    destination = source;
+                } else if (!source.empty()) {
+                    // Sign extending move of a stack pointer.
+                    return std::nullopt;
+                } else {
+                    destination.clear();
+                }
+            } else if (!destination.empty()) {
+                // Only constant adjustments of a stack pointer are tracked.
+                if (source_is_register || (operation != AluOperations::Add && operation != AluOperations::Sub)) {
+                    return std::nullopt;
+                }
+                std::set<int32_t> adjusted;
+                for (int32_t pointer : destination) {
+                    adjusted.insert((operation == AluOperations::Add) ? pointer + inst.imm : pointer - inst.imm);
+                }
+                destination = std::move(adjusted);
+            } else if (source_is_register && !source.empty()) {
+                return std::nullopt;
+            }
+            successors.push_back(i + 1);
+            break;
+        }
+        case INST_CLS_ALU:
+            if (!destination.empty() || (source_is_register && !source.empty())) {
+                return std::nullopt;
+            }
+            successors.push_back(i + 1);
+            break;
+        case INST_CLS_LD:
+            destination.clear();
+            successors.push_back(i + ((inst.opcode == INST_OP_LDDW_IMM) ? 2 : 1));
+            break;
+        case INST_CLS_LDX:
+            if (!record_access(source, inst.offset)) {
+                return std::nullopt;
+            }
+            destination.clear();
+            successors.push_back(i + 1);
+            break;
+        case INST_CLS_ST:
+            if (!record_access(destination, inst.offset)) {
+                return std::nullopt;
+            }
+            successors.push_back(i + 1);
+            break;
+        case INST_CLS_STX:
+            // Stack pointers that are spilled to memory can't be followed.
+            if (!record_access(destination, inst.offset) || !source.empty()) {
+                return std::nullopt;
+            }
+            if ((inst.opcode & INST_MODE_MASK) == EBPF_MODE_ATOMIC && (inst.imm & EBPF_ATOMIC_FETCH)) {
+                state[(inst.imm == EBPF_ATOMIC_CMPXCHG) ? 0 : inst.src].clear();
+            }
+            successors.push_back(i + 1);
+            break;
+        case INST_CLS_JMP:
+        case INST_CLS_JMP32:
+            if (inst.opcode == INST_OP_EXIT) {
+                break;
+            }
+            if (inst.opcode == INST_OP_CALL) {
+                for (size_t r = 0; r <= 5; r++) {
+                    // Stack pointers passed to a subprogram are not followed into its frame.
+                    if (inst.src == EBPF_CALL_LOCAL && r >= 1 && !state[r].empty()) {
+                        return std::nullopt;
+                    }
+                    state[r].clear();
+                }
+                successors.push_back(i + 1);
+                break;
+            }
+            if (inst.opcode == INST_OP_JA16 || inst.opcode == INST_OP_JA32) {
+                successors.push_back(i + ((inst.opcode == INST_OP_JA32) ? inst.imm : inst.offset) + 1);
+                break;
+            }
+            successors.push_back(i + 1);
+            successors.push_back(i + inst.offset + 1);
+            break;
+        default:
+            return std::nullopt;
+        }
+
+        for (const auto& pointers : state) {
+            if (!record_access(pointers, 0)) {
+                return std::nullopt;
+            }
+        }
+
+        // Merge the state into each successor and revisit the successors that changed.
+        for (size_t successor : successors) {
+            if (successor < function_start || successor >= function_end) {
+                return std::nullopt;
+            }
+            auto& successor_state = states[successor - function_start];
+            bool changed = false;
+            if (!successor_state.has_value()) {
+                successor_state = state;
+                changed = true;
+            } else {
+                for (size_t r = 0; r < state.size(); r++) {
+                    for (int32_t pointer : state[r]) {
+                        changed |= (*successor_state)[r].insert(pointer).second;
+                    }
+                }
+            }
+            if (changed) {
+                worklist.push_back(successor);
+            }
+        }
+    }
+    return stack_size;
+}
+
 void
 bpf_code_generator::encode_instructions(const bpf_code_generator::unsafe_string& section_name)
 {
@@ -873,6 +1257,7 @@ bpf_code_generator::encode_instructions(const bpf_code_generator::unsafe_string&
     for (size_t i = 0; i < program_output.size(); i++) {
         auto& output = program_output[i];
         auto& inst = output.instruction;
+        current_function = get_function_start(i);
 
         switch (inst.opcode & INST_CLS_MASK) {
         case INST_CLS_ALU:
@@ -1113,7 +1498,16 @@ bpf_code_generator::encode_instructions(const bpf_code_generator::unsafe_string&
                     throw bpf_code_generator_exception(
                         "Map " + output.relocation + " doesn't exist", output.instruction_offset);
                 }
-                source = std::format("_maps[{}].address", std::to_string(map_definition->second.index));
+                if (global_data_sections.contains(output.relocation)) {
+                    // Global variables are addressed directly in the value of the map backing their section.
+                    uint32_t offset = static_cast<uint32_t>(output.instruction.imm);
+                    if (offset > map_definition->second.definition.value_size) {
+                        throw bpf_code_generator_exception("invalid global variable offset", output.instruction_offset);
+                    }
+                    source = std::format("(uint8_t*)_map_data[{}].address + {}", map_definition->second.index, offset);
+                } else {
+                    source = std::format("_maps[{}].address", std::to_string(map_definition->second.index));
+                }
                 output.lines.push_back(std::format("{} = POINTER({});", destination, source));
                 current_program->referenced_map_indices.insert(map_definitions[output.relocation].index);
             }
@@ -1139,8 +1533,16 @@ bpf_code_generator::encode_instructions(const bpf_code_generator::unsafe_string&
             default:
                 throw bpf_code_generator_exception("invalid operand", output.instruction_offset);
             }
-            output.lines.push_back(
-                std::format("{} = *({}*)(uintptr_t)({} + {});", destination, size_type, source, offset));
+            std::optional<uint64_t> read_only_value = find_read_only_value(i);
+            if (read_only_value.has_value()) {
+                // Fold loads of read-only global variables into constants, so that the compiler can remove the code
+                // they disable.
+                output.lines.push_back(
+                    std::format("{} = (uint64_t){};", destination, std::to_string(read_only_value.value())));
+            } else {
+                output.lines.push_back(
+                    std::format("{} = *({}*)(uintptr_t)({} + {});", destination, size_type, source, offset));
+            }
         } break;
         case INST_CLS_ST:
         case INST_CLS_STX: {
@@ -1290,27 +1692,72 @@ bpf_code_generator::encode_instructions(const bpf_code_generator::unsafe_string&
             } else if (inst.opcode == INST_OP_JA32) {
                 std::string target = program_output[i + inst.imm + 1].label;
                 output.lines.push_back("goto " + target + ";");
+            } else if (inst.opcode == INST_OP_CALL && inst.src == EBPF_CALL_LOCAL) {
+                output.lines.push_back(std::format(
+                    "{} = {}({}, {}, {}, {}, {});",
+                    get_register_name(0),
+                    get_subprogram_name(program_name, i + inst.imm + 1),
+                    get_register_name(1),
+                    get_register_name(2),
+                    get_register_name(3),
+                    get_register_name(4),
+                    get_register_name(5)));
             } else if (inst.opcode == INST_OP_CALL) {
                 std::string function_name;
+                int32_t helper_id;
                 if (output.relocation.empty()) {
-                    auto str = std::to_string(
-                        current_program->helper_functions["helper_id_" + std::to_string(output.instruction.imm)].index);
+                    auto& helper_function =
+                        current_program->helper_functions["helper_id_" + std::to_string(output.instruction.imm)];
+                    auto str = std::to_string(helper_function.index);
+                    helper_id = helper_function.id;
 
                     function_name = std::vformat(helper_array_prefix, make_format_args(str));
                 } else {
                     auto helper_function = current_program->helper_functions.find(output.relocation);
                     assert(helper_function != current_program->helper_functions.end());
                     auto str = std::to_string(current_program->helper_functions[output.relocation].index);
+                    helper_id = helper_function->second.id;
                     function_name = std::vformat(helper_array_prefix, make_format_args(str));
                 }
-                output.lines.push_back(
-                    get_register_name(0) + " = " + function_name + ".address(" + get_register_name(1) + ", " +
-                    get_register_name(2) + ", " + get_register_name(3) + ", " + get_register_name(4) + ", " +
-                    get_register_name(5) + ");");
-                output.lines.push_back(
-                    std::format("if (({}.tail_call) && ({} == 0)) {{", function_name, get_register_name(0)));
-                output.lines.push_back(INDENT "return 0;");
-                output.lines.push_back("}");
+                // A tail call replaces the whole call chain, which can't be expressed by returning from a C function
+                // called by the program's entry point.
+                if (helper_id == BPF_FUNC_tail_call && current_function != 0) {
+                    throw bpf_code_generator_exception("tail call from subprogram", output.instruction_offset);
+                }
+                std::string helper_call = get_register_name(0) + " = " + function_name + ".address(" +
+                                          get_register_name(1) + ", " + get_register_name(2) + ", " +
+                                          get_register_name(3) + ", " + get_register_name(4) + ", " +
+                                          get_register_name(5) + ");";
+                const map_entry_t* array_map = nullptr;
+                if (inline_map_lookups && helper_id == BPF_FUNC_map_lookup_elem) {
+                    array_map = find_array_map_argument(i);
+                }
+                if (array_map != nullptr) {
+                    // Look up the value directly in the array storage published by the runtime and fall back to
+                    // the helper function if the runtime didn't publish it.
+                    std::string map_data = std::format("_map_data[{}].address", array_map->index);
+                    std::string result = get_register_name(0);
+                    output.lines.push_back(std::format("if ({} != NULL) {{", map_data));
+                    output.lines.push_back(
+                        std::format(INDENT "{} = *(uint32_t*)(uintptr_t){};", result, get_register_name(2)));
+                    output.lines.push_back(std::format(
+                        INDENT "{} = ({} < {}) ? POINTER((uint8_t*){} + {} * {}) : 0;",
+                        result,
+                        result,
+                        array_map->definition.max_entries,
+                        map_data,
+                        result,
+                        array_map->definition.value_size));
+                    output.lines.push_back("} else {");
+                    output.lines.push_back(INDENT + helper_call);
+                    output.lines.push_back("}");
+                } else {
+                    output.lines.push_back(helper_call);
+                    output.lines.push_back(
+                        std::format("if (({}.tail_call) && ({} == 0)) {{", function_name, get_register_name(0)));
+                    output.lines.push_back(INDENT "return 0;");
+                    output.lines.push_back("}");
+                }
             } else if (inst.opcode == INST_OP_EXIT) {
                 output.lines.push_back("return " + get_register_name(0) + ";");
             } else {
@@ -1331,6 +1778,24 @@ bpf_code_generator::encode_instructions(const bpf_code_generator::unsafe_string&
             throw bpf_code_generator_exception("invalid operand", output.instruction_offset);
         }
     }
+    current_function = 0;
+}
+
+std::string
+bpf_code_generator::get_subprogram_name(const unsafe_string& program_name, size_t offset)
+{
+    return program_name.c_identifier() + "_subprogram_" + std::to_string(offset);
+}
+
+std::string
+bpf_code_generator::get_stack_declaration(const program_t& program, size_t function_start)
+{
+    auto stack_size = program.stack_sizes.find(function_start);
+    if (stack_size == program.stack_sizes.end() || !stack_size->second.has_value()) {
+        return "uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];";
+    }
+    // The verifier rejects reads of stack slots that haven't been written, so the stack is left uninitialized.
+    return std::format("uint64_t stack[{}];", std::max<size_t>(1, (stack_size->second.value() + 7) / 8));
 }
 
 void
@@ -1441,6 +1906,23 @@ bpf_code_generator::emit_c_code(std::ostream& output_stream)
         output_stream << INDENT "*count = " << std::to_string(map_definitions.size()) << ";" << std::endl;
         output_stream << "}" << std::endl;
         output_stream << std::endl;
+
+        if (inline_map_lookups || !global_data_sections.empty()) {
+            output_stream << "#pragma data_seg(push, \"maps\")" << std::endl;
+            output_stream << "static map_data_entry_t _map_data[" << std::to_string(map_definitions.size())
+                          << "] = {{NULL}};" << std::endl;
+            output_stream << "#pragma data_seg(pop)" << std::endl;
+            output_stream << std::endl;
+            output_stream << "static void" << std::endl
+                          << "_get_map_data(_Outptr_result_buffer_maybenull_(*count) map_data_entry_t** map_data, "
+                             "_Out_ size_t* count)"
+                          << std::endl;
+            output_stream << "{" << std::endl;
+            output_stream << INDENT "*map_data = _map_data;" << std::endl;
+            output_stream << INDENT "*count = " << std::to_string(map_definitions.size()) << ";" << std::endl;
+            output_stream << "}" << std::endl;
+            output_stream << std::endl;
+        }
     } else {
         output_stream << "static void" << std::endl
                       << "_get_maps(_Outptr_result_buffer_maybenull_(*count) map_entry_t** maps, _Out_ size_t* count)"
@@ -1450,6 +1932,18 @@ bpf_code_generator::emit_c_code(std::ostream& output_stream)
         output_stream << INDENT "*count = 0;" << std::endl;
         output_stream << "}" << std::endl;
         output_stream << std::endl;
+
+        if (inline_map_lookups) {
+            output_stream << "static void" << std::endl
+                          << "_get_map_data(_Outptr_result_buffer_maybenull_(*count) map_data_entry_t** map_data, "
+                             "_Out_ size_t* count)"
+                          << std::endl;
+            output_stream << "{" << std::endl;
+            output_stream << INDENT "*map_data = NULL;" << std::endl;
+            output_stream << INDENT "*count = 0;" << std::endl;
+            output_stream << "}" << std::endl;
+            output_stream << std::endl;
+        }
     }
 
     for (auto& [name, program] : programs) {
@@ -1545,12 +2039,25 @@ bpf_code_generator::emit_c_code(std::ostream& output_stream)
 
         // Emit entry point
         output_stream << "#pragma code_seg(push, " << program.pe_section_name.quoted() << ")" << std::endl;
+
+        // Declare the subprograms, which follow the entry point.
+        for (const auto& subprogram : program.subprograms) {
+            output_stream << std::format(
+                                 "static uint64_t\n{}(uint64_t r1, uint64_t r2, uint64_t r3, uint64_t r4, "
+                                 "uint64_t r5);",
+                                 get_subprogram_name(program_name, subprogram.first))
+                          << std::endl;
+        }
+        if (!program.subprograms.empty()) {
+            output_stream << std::endl;
+        }
+
         output_stream << std::format("static uint64_t\n{}(void* context)", program_name.c_identifier()) << std::endl;
         output_stream << prolog_line_info << "{" << std::endl;
 
         // Emit prologue.
         output_stream << prolog_line_info << INDENT "// Prologue" << std::endl;
-        output_stream << prolog_line_info << INDENT "uint64_t stack[(UBPF_STACK_SIZE + 7) / 8];" << std::endl;
+        output_stream << prolog_line_info << INDENT << get_stack_declaration(program, 0) << std::endl;
         for (const auto& r : _register_names) {
             // Skip unused registers.
             if (program.referenced_registers.find(r) == program.referenced_registers.end()) {
@@ -1565,7 +2072,43 @@ bpf_code_generator::emit_c_code(std::ostream& output_stream)
         output_stream << std::endl;
 
         // Emit encoded instructions.
-        for (const auto& output : program.output) {
+        for (size_t i = 0; i < program.output.size(); i++) {
+            const auto& output = program.output[i];
+            auto subprogram = program.subprograms.find(i);
+            if (subprogram != program.subprograms.end()) {
+                // Close the previous function and open the subprogram, which gets its own stack frame. Arguments are
+                // passed in r1-r5 and r6-r9 are preserved by being locals of the caller.
+                output_stream << prolog_line_info << "}" << std::endl;
+                output_stream << std::endl;
+                output_stream << std::format(
+                                     "static uint64_t\n{}(uint64_t r1, uint64_t r2, uint64_t r3, uint64_t r4, "
+                                     "uint64_t r5)",
+                                     get_subprogram_name(program_name, i))
+                              << std::endl;
+                output_stream << prolog_line_info << "{" << std::endl;
+                output_stream << prolog_line_info << INDENT "// Prologue" << std::endl;
+                output_stream << prolog_line_info << INDENT << get_stack_declaration(program, i) << std::endl;
+                const auto& registers = subprogram->second;
+                for (size_t r = 0; r < _countof(_register_names); r++) {
+                    // Skip arguments and unused registers. The frame pointer is always set.
+                    if ((r >= 1 && r <= 5) ||
+                        (r != 10 && registers.find(_register_names[r]) == registers.end())) {
+                        continue;
+                    }
+                    output_stream << prolog_line_info << INDENT "register uint64_t " << _register_names[r] << " = 0;"
+                                  << std::endl;
+                }
+                output_stream << std::endl;
+                for (size_t r = 1; r <= 5; r++) {
+                    if (registers.find(_register_names[r]) == registers.end()) {
+                        output_stream << prolog_line_info << INDENT "(void)" << _register_names[r] << ";"
+                                      << std::endl;
+                    }
+                }
+                output_stream << prolog_line_info << INDENT "" << _register_names[10]
+                              << " = (uintptr_t)((uint8_t*)stack + sizeof(stack));" << std::endl;
+                output_stream << std::endl;
+            }
             if (output.lines.empty()) {
                 continue;
             }
@@ -1722,9 +2265,74 @@ bpf_code_generator::emit_c_code(std::ostream& output_stream)
     output_stream << "}" << std::endl;
     output_stream << std::endl;
 
+    if (!global_data_sections.empty()) {
+        // Emit the initial contents of each global variable section that isn't zero filled.
+        size_t section_number = 0;
+        for (const auto& [name, section] : global_data_sections) {
+            if (!section.initial_data.empty()) {
+                output_stream << "static const uint8_t _global_variable_section_" << section_number
+                              << "_initial_data[] = {" << std::endl;
+                for (size_t i = 0; i < section.initial_data.size(); i++) {
+                    if (i % 16 == 0) {
+                        output_stream << INDENT "";
+                    }
+                    output_stream << std::to_string(section.initial_data[i]) << ",";
+                    if (i % 16 == 15 || i + 1 == section.initial_data.size()) {
+                        output_stream << std::endl;
+                    } else {
+                        output_stream << " ";
+                    }
+                }
+                output_stream << "};" << std::endl;
+                output_stream << std::endl;
+            }
+            section_number++;
+        }
+
+        output_stream << "static global_variable_section_info_t _global_variable_sections[] = {" << std::endl;
+        section_number = 0;
+        for (const auto& [name, section] : global_data_sections) {
+            output_stream << INDENT "{" << std::endl;
+            output_stream << INDENT INDENT << ".name = " << name.quoted() << "," << std::endl;
+            output_stream << INDENT INDENT << ".size = " << map_definitions[name].definition.value_size << ","
+                          << std::endl;
+            if (section.initial_data.empty()) {
+                output_stream << INDENT INDENT << ".initial_data = NULL," << std::endl;
+            } else {
+                output_stream << INDENT INDENT << ".initial_data = _global_variable_section_" << section_number
+                              << "_initial_data," << std::endl;
+            }
+            output_stream << INDENT INDENT << ".read_only = " << (section.read_only ? "true" : "false") << ","
+                          << std::endl;
+            output_stream << INDENT "}," << std::endl;
+            section_number++;
+        }
+        output_stream << "};" << std::endl;
+        output_stream << std::endl;
+
+        output_stream << "static void" << std::endl
+                      << "_get_global_variable_sections(" << std::endl
+                      << INDENT "_Outptr_result_buffer_maybenull_(*count) global_variable_section_info_t** "
+                         "global_variable_sections,"
+                      << std::endl
+                      << INDENT "_Out_ size_t* count)" << std::endl;
+        output_stream << "{" << std::endl;
+        output_stream << INDENT "*global_variable_sections = _global_variable_sections;" << std::endl;
+        output_stream << INDENT "*count = " << std::to_string(global_data_sections.size()) << ";" << std::endl;
+        output_stream << "}" << std::endl;
+        output_stream << std::endl;
+    }
+
     std::string meta_data_table = "metadata_table_t " + c_name.c_identifier() + "_metadata_table = {";
     meta_data_table +=
-        "sizeof(metadata_table_t), _get_programs, _get_maps, _get_hash, _get_version, _get_map_initial_values};\n";
+        "sizeof(metadata_table_t), _get_programs, _get_maps, _get_hash, _get_version, _get_map_initial_values";
+    if (inline_map_lookups || !global_data_sections.empty()) {
+        meta_data_table += ", _get_map_data";
+    }
+    if (!global_data_sections.empty()) {
+        meta_data_table += ", _get_global_variable_sections";
+    }
+    meta_data_table += "};\n";
 
     if ((meta_data_table.size() - 1) > LINE_BREAK_WIDTH) {
         meta_data_table.insert(meta_data_table.find_first_of("{") + 1, "\n" INDENT);
@@ -233,7 +233,7 @@ class bpf_code_generator
         const std::string& program_info_hash_type);
 
     /**
-     * @brief Parse global data (currently map information) in the eBPF file.
+     * @brief Parse global data (map information and global variable sections) in the eBPF file.
      *
      */
     void
@@ -255,6 +255,15 @@ class bpf_code_generator
     void
     parse_legacy_maps_section(const unsafe_string& name);
 
+    /**
+     * @brief Parse a global variable section (.data, .bss or .rodata) in the eBPF file and add the single entry
+     * array map that backs it.
+     *
+     * @param[in] name Section in the ELF file holding the global variables.
+     */
+    void
+    parse_global_data_section(const unsafe_string& name);
+
     /**
      * @brief Generate C code from the parsed eBPF file.
      *
@@ -288,6 +297,15 @@ class bpf_code_generator
     void
     set_program_hash_info(const std::optional<std::vector<uint8_t>>& program_info_hash);
 
+    /**
+     * @brief Look up values of array maps directly in the generated code instead of calling the
+     * bpf_map_lookup_elem helper function when the map is known at the call site.
+     *
+     * @param[in] enabled True to inline array map lookups.
+     */
+    void
+    set_inline_map_lookups(bool enabled);
+
   private:
     typedef struct _helper_function
     {
@@ -301,6 +319,14 @@ class bpf_code_generator
         size_t index;
     } map_entry_t;
 
+    typedef struct _global_data_section
+    {
+        ELFIO::Elf_Half section_index;
+        bool read_only;
+        // Initial contents of the section. Empty if the section is zero filled.
+        std::vector<uint8_t> initial_data;
+    } global_data_section_t;
+
     typedef struct _output_instruction
     {
         ebpf_inst instruction = {};
@@ -328,6 +354,10 @@ class bpf_code_generator
         std::map<unsafe_string, helper_function_t> helper_functions;
         std::string program_info_hash_type{};
         ebpf_program_info_t* program_info = nullptr;
+        // Registers used in each subprogram, keyed by the offset of its first instruction.
+        std::map<size_t, std::set<std::string>> subprograms;
+        // Bytes of stack used by each function, keyed like subprograms. No value if the depth couldn't be bounded.
+        std::map<size_t, std::optional<size_t>> stack_sizes;
     } program_t;
 
     typedef struct _line_info
@@ -379,6 +409,32 @@ class bpf_code_generator
     void
     extract_btf_information();
 
+    /**
+     * @brief Find the BPF subprograms called from the current program.
+     *
+     */
+    void
+    find_subprograms();
+
+    /**
+     * @brief Get the offset of the function containing an instruction.
+     *
+     * @param[in] offset Offset of the instruction.
+     * @return Offset of the first instruction of the subprogram or 0 for the program's entry point.
+     */
+    size_t
+    get_function_start(size_t offset);
+
+    /**
+     * @brief Get the name of the C function emitted for a subprogram.
+     *
+     * @param[in] program_name Name of the program containing the subprogram.
+     * @param[in] offset Offset of the first instruction of the subprogram.
+     * @return Name of the function.
+     */
+    std::string
+    get_subprogram_name(const unsafe_string& program_name, size_t offset);
+
     /**
      * @brief Assign a label to each jump target.
      *
@@ -393,6 +449,47 @@ class bpf_code_generator
     void
     build_function_table();
 
+    /**
+     * @brief Find the array map passed in r1 to the helper call at the given index.
+     *
+     * @param[in] call_index Index of the call instruction in the current program.
+     * @return Map entry if r1 is loaded with an array map with a 4 byte key in straight-line code before the call,
+     * nullptr otherwise.
+     */
+    const map_entry_t*
+    find_array_map_argument(size_t call_index);
+
+    /**
+     * @brief Find the value read by a load from a read-only global variable.
+     *
+     * @param[in] load_index Index of the load instruction in the current program.
+     * @return Value read if the source register is loaded with the address of a read-only global data section in
+     * straight-line code before the load and the load lies within the section, no value otherwise.
+     */
+    std::optional<uint64_t>
+    find_read_only_value(size_t load_index);
+
+    /**
+     * @brief Compute the stack depth of a function in the current program by tracking which registers hold
+     * constant offsets from the frame pointer.
+     *
+     * @param[in] function_start Offset of the first instruction of the function.
+     * @return Number of bytes below the frame pointer the function accesses, or no value if a stack pointer
+     * escapes the analysis.
+     */
+    std::optional<size_t>
+    get_stack_size(size_t function_start);
+
+    /**
+     * @brief Get the declaration of the stack array of a function, sized from its stack depth.
+     *
+     * @param[in] program Program containing the function.
+     * @param[in] function_start Offset of the first instruction of the function.
+     * @return C declaration of the stack array.
+     */
+    std::string
+    get_stack_declaration(const program_t& program, size_t function_start);
+
     /**
      * @brief Generate the C code for each eBPF instruction.
      *
@@ -456,4 +553,7 @@ class bpf_code_generator
     btf_section_to_instruction_to_line_info_t section_line_info;
     std::optional<std::vector<uint8_t>> elf_file_hash;
     std::map<unsafe_string, std::vector<unsafe_string>> map_initial_values;
+    std::map<unsafe_string, global_data_section_t> global_data_sections;
+    bool inline_map_lookups = false;
+    size_t current_function = 0;
 };